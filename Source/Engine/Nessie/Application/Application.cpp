@@ -9,6 +9,7 @@
 #include "Nessie/Application/ApplicationDesc.h"
 #include "Nessie/Asset/AssetManager.h"
 #include "Nessie/Core/ScopeExit.h"
+#include "Nessie/Core/CPUFeatures.h"
 #include "Nessie/Core/Time/ScopedTimer.h"
 
 namespace nes
@@ -215,6 +216,15 @@ namespace nes
 
     void Application::OnStartup(const WindowDesc& windowDesc, RendererDesc&& rendererDesc)
     {
+        // Make sure that the CPU supports the instruction sets that the math library was compiled with.
+        std::string missingFeatures;
+        if (!cpu::SupportsCompiledFeatures(missingFeatures))
+        {
+            NES_ERROR("CPU does not support the required instruction sets: {}", missingFeatures);
+            m_shouldQuit = true;
+            return;
+        }
+        
         // Initialize the Device Manager.
         m_pDeviceManager = std::make_unique<DeviceManager>();
         if (!m_pDeviceManager->Init())
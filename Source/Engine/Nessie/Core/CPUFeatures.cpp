@@ -0,0 +1,157 @@
+// CPUFeatures.cpp
+#include "CPUFeatures.h"
+
+#if defined(NES_CPU_X86)
+    #if defined(NES_COMPILER_MSVC)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+        #include <immintrin.h>
+    #endif
+#endif
+
+namespace nes
+{
+#if defined(NES_CPU_X86)
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Run the cpuid instruction for the given leaf and subleaf.
+    ///	@param outRegisters : Values of the EAX, EBX, ECX and EDX registers.
+    //----------------------------------------------------------------------------------------------------
+    static void CPUID(const int leaf, const int subLeaf, int outRegisters[4])
+    {
+    #if defined(NES_COMPILER_MSVC)
+        __cpuidex(outRegisters, leaf, subLeaf);
+    #else
+        unsigned int eax, ebx, ecx, edx;
+        __cpuid_count(leaf, subLeaf, eax, ebx, ecx, edx);
+        outRegisters[0] = static_cast<int>(eax);
+        outRegisters[1] = static_cast<int>(ebx);
+        outRegisters[2] = static_cast<int>(ecx);
+        outRegisters[3] = static_cast<int>(edx);
+    #endif
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Returns true if the OS saves and restores the XMM and YMM registers on a context switch.
+    //----------------------------------------------------------------------------------------------------
+    static bool OSSupportsAVXState()
+    {
+    #if defined(NES_COMPILER_MSVC)
+        const uint64 xcr0 = _xgetbv(0);
+    #else
+        uint32 eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        const uint64 xcr0 = (static_cast<uint64>(edx) << 32) | eax;
+    #endif
+        // Bit 1 = XMM state, Bit 2 = YMM state.
+        return (xcr0 & 0b110) == 0b110;
+    }
+
+    static CPUFeatures QueryFeatures()
+    {
+        CPUFeatures features;
+        int registers[4];
+
+        CPUID(0, 0, registers);
+        const int maxLeaf = registers[0];
+
+        CPUID(0x80000000, 0, registers);
+        const uint32 maxExtendedLeaf = static_cast<uint32>(registers[0]);
+
+        if (maxLeaf >= 1)
+        {
+            CPUID(1, 0, registers);
+            const uint32 ecx = static_cast<uint32>(registers[2]);
+            features.m_hasSSE4_1 = (ecx & (1u << 19)) != 0;
+            features.m_hasSSE4_2 = (ecx & (1u << 20)) != 0;
+            features.m_hasPOPCNT = (ecx & (1u << 23)) != 0;
+
+            const bool osSavesAVXState = (ecx & (1u << 27)) != 0 && OSSupportsAVXState();
+            features.m_hasAVX = osSavesAVXState && (ecx & (1u << 28)) != 0;
+            features.m_hasFMA = osSavesAVXState && (ecx & (1u << 12)) != 0;
+
+            if (maxLeaf >= 7)
+            {
+                CPUID(7, 0, registers);
+                const uint32 ebx = static_cast<uint32>(registers[1]);
+                features.m_hasAVX2 = features.m_hasAVX && (ebx & (1u << 5)) != 0;
+                features.m_hasTZCNT = (ebx & (1u << 3)) != 0; // BMI1
+            }
+        }
+
+        if (maxExtendedLeaf >= 0x80000001)
+        {
+            CPUID(0x80000001, 0, registers);
+            features.m_hasLZCNT = (static_cast<uint32>(registers[2]) & (1u << 5)) != 0; // ABM
+        }
+
+        return features;
+    }
+#endif
+
+    const CPUFeatures& cpu::GetFeatures()
+    {
+    #if defined(NES_CPU_X86)
+        static const CPUFeatures kFeatures = QueryFeatures();
+    #else
+        static const CPUFeatures kFeatures{};
+    #endif
+        return kFeatures;
+    }
+
+    CPUFeatures cpu::GetCompiledFeatures()
+    {
+        CPUFeatures features;
+    #ifdef NES_USE_SSE4_1
+        features.m_hasSSE4_1 = true;
+    #endif
+    #ifdef NES_USE_SSE4_2
+        features.m_hasSSE4_2 = true;
+        features.m_hasPOPCNT = true; // CountBits() uses _mm_popcnt_u32 with SSE4.2. It has its own CPUID bit.
+    #endif
+    #ifdef NES_USE_AVX
+        features.m_hasAVX = true;
+    #endif
+    #ifdef NES_USE_AVX2
+        features.m_hasAVX2 = true;
+    #endif
+    #ifdef NES_USE_FMADD
+        features.m_hasFMA = true;
+    #endif
+    #ifdef NES_USE_LZCNT
+        features.m_hasLZCNT = true;
+    #endif
+    #ifdef NES_USE_TZCNT
+        features.m_hasTZCNT = true;
+    #endif
+        return features;
+    }
+
+    bool cpu::SupportsCompiledFeatures(std::string& outMissing)
+    {
+        const CPUFeatures& supported = GetFeatures();
+        const CPUFeatures compiled = GetCompiledFeatures();
+        outMissing.clear();
+
+        auto checkFeature = [&outMissing](const bool isCompiled, const bool isSupported, const char* name)
+        {
+            if (isCompiled && !isSupported)
+            {
+                if (!outMissing.empty())
+                    outMissing += ", ";
+                outMissing += name;
+            }
+        };
+
+        checkFeature(compiled.m_hasSSE4_1, supported.m_hasSSE4_1, "SSE4.1");
+        checkFeature(compiled.m_hasSSE4_2, supported.m_hasSSE4_2, "SSE4.2");
+        checkFeature(compiled.m_hasPOPCNT, supported.m_hasPOPCNT, "POPCNT");
+        checkFeature(compiled.m_hasAVX, supported.m_hasAVX, "AVX");
+        checkFeature(compiled.m_hasAVX2, supported.m_hasAVX2, "AVX2");
+        checkFeature(compiled.m_hasFMA, supported.m_hasFMA, "FMA");
+        checkFeature(compiled.m_hasLZCNT, supported.m_hasLZCNT, "LZCNT");
+        checkFeature(compiled.m_hasTZCNT, supported.m_hasTZCNT, "TZCNT");
+
+        return outMissing.empty();
+    }
+}
@@ -0,0 +1,45 @@
+// CPUFeatures.h
+#pragma once
+#include "Nessie/Core/Config.h"
+#include <string>
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Instruction set extensions supported by the CPU that we are running on.
+    //----------------------------------------------------------------------------------------------------
+    struct CPUFeatures
+    {
+        bool            m_hasSSE4_1 = false;
+        bool            m_hasSSE4_2 = false;
+        bool            m_hasPOPCNT = false;
+        bool            m_hasAVX = false;       /// Only true if the OS also saves the YMM registers.
+        bool            m_hasAVX2 = false;      /// Only true if the OS also saves the YMM registers.
+        bool            m_hasFMA = false;       /// Only true if the OS also saves the YMM registers.
+        bool            m_hasLZCNT = false;
+        bool            m_hasTZCNT = false;
+    };
+
+    namespace cpu
+    {
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the instruction set extensions supported by this CPU. The CPU is queried the first time
+        ///     this is called.
+        //----------------------------------------------------------------------------------------------------
+        const CPUFeatures&  GetFeatures();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the instruction set extensions that the engine was compiled to use, based on the
+        ///     NES_USE_XXX defines in Config.h.
+        //----------------------------------------------------------------------------------------------------
+        CPUFeatures         GetCompiledFeatures();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check that this CPU supports every instruction set the engine was compiled to use. Running
+        ///     the math library on a CPU that doesn't will crash with an illegal instruction, so this should be
+        ///     checked as early as possible on startup.
+        ///	@param outMissing : On failure, this is set to a comma separated list of the missing instruction sets.
+        //----------------------------------------------------------------------------------------------------
+        bool                SupportsCompiledFeatures(std::string& outMissing);
+    }
+}
@@ -19,18 +19,36 @@
     #else
         #define NES_CPU_ADDRESS_BITS 32
     #endif
-    //#define NES_USE_SSE
     #define NES_VECTOR_ALIGNMENT 16
     #define NES_DVECTOR_ALIGNMENT 32
+
+    // Instruction set tiers. SSE4.2 is the minimum. AVX2 (and the FMA, LZCNT and TZCNT instructions that come
+    // with it) are enabled when the compiler targets it (MSVC: /arch:AVX2, which the generated solution uses).
+    // Define NES_NO_SSE4 to limit the build to SSE2.
+    // Define NES_NO_SSE to use the scalar implementation of the math types. This is only meant to compare the
+    // SIMD and scalar paths (see the EngineTests project), not to ship with. The scalar implementation returns the
+    // same bits as the SSE path: dot products sum as (x + y) + (z + w), negation subtracts from zero,
+    // Mat44::Inversed() uses the algorithm of the SSE path and UVec4Reg::ToFloat() converts signed ints.
+    #if !defined(NES_NO_SSE)
+        #define NES_USE_SSE
+        #if !defined(NES_NO_SSE4)
+            #define NES_USE_SSE4_1
+            #define NES_USE_SSE4_2
+        #endif
+        #if defined(__AVX2__)
+            #define NES_USE_AVX
+            #define NES_USE_AVX2
+            #define NES_USE_LZCNT   // Use "Leading Zero Count" instruction.
+            #define NES_USE_TZCNT   // Use "Trailing Zero Count" instruction.
+            #define NES_USE_FMADD   // Use "Fused Multiply Add" instructions.
+        #elif defined(__AVX__)
+            #define NES_USE_AVX
+        #endif
+    #endif
 #else
 #error "Nessie not setup for current Architecture!!!"
 #endif
 
-// Use "Trailing Zero Count" instruction.
-//#define NES_USE_TZCNT
-// Use "Leading Zero Count" instruction.
-//#define NES_USE_LZCNT
-
 // Macro to get the current function name.
 #if defined(NES_COMPILER_MSVC)
     #define NES_FUNCTION_NAME __FUNCTION__
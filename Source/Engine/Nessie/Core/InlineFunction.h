@@ -0,0 +1,161 @@
+// InlineFunction.h
+#pragma once
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Nessie/Debug/Assert.h"
+
+namespace nes
+{
+    template <typename Signature, size_t Capacity = 64>
+    class InlineFunction;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Move-only replacement for std::function that stores the callable in a fixed-size buffer
+    ///     inside the object, so it never allocates. Callables that don't fit in the buffer result in a
+    ///     compile error; capture a pointer or reference to a struct instead of capturing many values.
+    ///     Trivially copyable callables (e.g. lambdas that capture pointers, references and integers) are
+    ///     moved with a memcpy and need no destructor call.
+    /// @tparam Return : Return type of the function.
+    /// @tparam Args : Argument types of the function.
+    /// @tparam Capacity : Size of the inline buffer, in bytes.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Return, typename...Args, size_t Capacity>
+    class InlineFunction<Return(Args...), Capacity>
+    {
+        static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+    public:
+        InlineFunction() = default;
+        InlineFunction(std::nullptr_t) {}
+        InlineFunction(const InlineFunction&) = delete;
+        InlineFunction& operator=(const InlineFunction&) = delete;
+        InlineFunction(InlineFunction&& other) noexcept                 { MoveFrom(other); }
+        InlineFunction& operator=(InlineFunction&& other) noexcept;
+        InlineFunction& operator=(std::nullptr_t)                       { Reset(); return *this; }
+        ~InlineFunction()                                               { Reset(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Construct from a callable, which is moved or copied into the inline buffer.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Functor> requires (!std::is_same_v<std::decay_t<Functor>, InlineFunction> && std::is_invocable_r_v<Return, std::decay_t<Functor>&, Args...>)
+        InlineFunction(Functor&& functor);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Call the stored callable. Must not be empty.
+        //----------------------------------------------------------------------------------------------------
+        Return                  operator()(Args...args)                 { NES_ASSERT(m_pInvoke != nullptr); return m_pInvoke(m_storage, std::forward<Args>(args)...); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true if a callable is stored.
+        //----------------------------------------------------------------------------------------------------
+        explicit                operator bool() const                   { return m_pInvoke != nullptr; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Destroy the stored callable, leaving this function empty.
+        //----------------------------------------------------------------------------------------------------
+        void                    Reset();
+
+    private:
+        enum class EOperation : uint8
+        {
+            MoveConstruct,
+            Destroy,
+        };
+
+        using InvokeFunction = Return(*)(void* pStorage, Args&&...args);
+        using ManageFunction = void(*)(EOperation operation, void* pStorage, void* pOtherStorage);
+
+        template <typename Functor>
+        static Return           Invoke(void* pStorage, Args&&...args)   { return (*static_cast<Functor*>(pStorage))(std::forward<Args>(args)...); }
+
+        template <typename Functor>
+        static void             Manage(EOperation operation, void* pStorage, void* pOtherStorage);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Take the callable of another function, leaving the other function empty. This must be empty.
+        //----------------------------------------------------------------------------------------------------
+        void                    MoveFrom(InlineFunction& other);
+
+        alignas(kAlignment) std::byte m_storage[Capacity];
+        InvokeFunction          m_pInvoke = nullptr;                    /// Calls the stored callable. Null if empty.
+        ManageFunction          m_pManage = nullptr;                    /// Moves or destroys the stored callable. Null if it is trivially copyable.
+    };
+
+    template <typename Return, typename...Args, size_t Capacity>
+    template <typename Functor> requires (!std::is_same_v<std::decay_t<Functor>, InlineFunction<Return(Args...), Capacity>> && std::is_invocable_r_v<Return, std::decay_t<Functor>&, Args...>)
+    InlineFunction<Return(Args...), Capacity>::InlineFunction(Functor&& functor)
+    {
+        using StoredType = std::decay_t<Functor>;
+        static_assert(sizeof(StoredType) <= Capacity, "Callable does not fit in the InlineFunction! Capture a pointer to a struct instead of many values, or increase the Capacity.");
+        static_assert(alignof(StoredType) <= kAlignment, "Callable is over-aligned for the InlineFunction!");
+        static_assert(std::is_nothrow_move_constructible_v<StoredType>, "Callable stored in an InlineFunction must be nothrow move constructible!");
+
+        new (m_storage) StoredType(std::forward<Functor>(functor));
+        m_pInvoke = &Invoke<StoredType>;
+        if constexpr (!std::is_trivially_copyable_v<StoredType>)
+            m_pManage = &Manage<StoredType>;
+    }
+
+    template <typename Return, typename...Args, size_t Capacity>
+    InlineFunction<Return(Args...), Capacity>& InlineFunction<Return(Args...), Capacity>::operator=(InlineFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    template <typename Return, typename...Args, size_t Capacity>
+    void InlineFunction<Return(Args...), Capacity>::Reset()
+    {
+        if (m_pManage != nullptr)
+            m_pManage(EOperation::Destroy, m_storage, nullptr);
+
+        m_pInvoke = nullptr;
+        m_pManage = nullptr;
+    }
+
+    template <typename Return, typename...Args, size_t Capacity>
+    template <typename Functor>
+    void InlineFunction<Return(Args...), Capacity>::Manage(const EOperation operation, void* pStorage, void* pOtherStorage)
+    {
+        switch (operation)
+        {
+            case EOperation::MoveConstruct:
+            {
+                Functor* pOther = static_cast<Functor*>(pOtherStorage);
+                new (pStorage) Functor(std::move(*pOther));
+                pOther->~Functor();
+                break;
+            }
+
+            case EOperation::Destroy:
+            {
+                static_cast<Functor*>(pStorage)->~Functor();
+                break;
+            }
+        }
+    }
+
+    template <typename Return, typename...Args, size_t Capacity>
+    void InlineFunction<Return(Args...), Capacity>::MoveFrom(InlineFunction& other)
+    {
+        NES_ASSERT(m_pInvoke == nullptr);
+        if (other.m_pInvoke == nullptr)
+            return;
+
+        if (other.m_pManage != nullptr)
+            other.m_pManage(EOperation::MoveConstruct, m_storage, other.m_storage);
+        else
+            std::memcpy(m_storage, other.m_storage, Capacity);
+
+        m_pInvoke = other.m_pInvoke;
+        m_pManage = other.m_pManage;
+        other.m_pInvoke = nullptr;
+        other.m_pManage = nullptr;
+    }
+}
@@ -55,6 +55,7 @@ namespace nes
 
         void* pAddress = m_pBase + m_top;
         m_top = newTop;
+        m_highWaterMark = math::Max(m_highWaterMark, m_top);
         return pAddress;
     }
 
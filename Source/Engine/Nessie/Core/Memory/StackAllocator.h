@@ -86,9 +86,21 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         bool                    IsFull() const              { return m_top == m_capacity; }
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns the highest number of bytes that have been allocated at the same time since
+        ///     construction or the last call to ResetHighWaterMark().
+        //----------------------------------------------------------------------------------------------------
+        size_t                  HighWaterMark() const       { return m_highWaterMark; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Reset the high water mark to the number of bytes that are currently allocated.
+        //----------------------------------------------------------------------------------------------------
+        void                    ResetHighWaterMark()        { m_highWaterMark = m_top; }
+
     private:
         std::byte*              m_pBase = nullptr;  /// Base address of the memory block.
         size_t                  m_top = 0;          /// End of the current allocated area.
+        size_t                  m_highWaterMark = 0;/// Highest value of m_top since the last reset.
         size_t                  m_capacity;         /// Size of the memory block, in bytes.
     };
 
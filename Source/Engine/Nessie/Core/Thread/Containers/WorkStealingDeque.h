@@ -0,0 +1,189 @@
+// WorkStealingDeque.h
+#pragma once
+#include <atomic>
+#include <vector>
+#include "Nessie/Core/Memory/Memory.h"
+#include "Nessie/Debug/Assert.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    ///	@brief : Lock-free, growable double-ended queue of pointers that is owned by a single thread.
+    ///     The owner pushes and pops at the bottom (LIFO), while any other thread can steal from the top (FIFO).
+    ///     There is no fixed capacity: when the deque is full, the owner doubles the buffer. Old buffers
+    ///     are kept alive until destruction, because a stealing thread can still be reading from them.
+    ///
+    ///     Implements the Chase-Lev deque, with the memory orderings described in: "Correct and Efficient
+    ///     Work-Stealing for Weak Memory Models" by Lê et al.
+    /// @tparam Type : Type that is pointed to by the stored elements.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Type>
+    class WorkStealingDeque
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Create the deque.
+        ///	@param initialCapacity : Number of elements that can be stored before growing. MUST BE A POWER OF TWO.
+        //----------------------------------------------------------------------------------------------------
+        explicit                WorkStealingDeque(const int64_t initialCapacity = 256);
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+        ~WorkStealingDeque();
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Push an element to the bottom of the deque. Can only be called by the owning thread.
+        //----------------------------------------------------------------------------------------------------
+        void                    Push(Type* pValue);
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Pop the element at the bottom of the deque. Can only be called by the owning thread.
+        ///	@returns : Nullptr if the deque is empty, or if the last element was stolen by another thread.
+        //----------------------------------------------------------------------------------------------------
+        Type*                   Pop();
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Steal the element at the top of the deque. Can be called by any thread.
+        ///	@returns : Nullptr if the deque is empty, or if another thread took the element first.
+        //----------------------------------------------------------------------------------------------------
+        Type*                   Steal();
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Returns true if the deque appeared empty at the time of the call. Can be called by any thread.
+        //----------------------------------------------------------------------------------------------------
+        bool                    IsEmpty() const;
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Circular array of elements. Indices wrap around the capacity.
+        //----------------------------------------------------------------------------------------------------
+        struct Buffer
+        {
+            explicit            Buffer(const int64_t capacity) : m_capacity(capacity), m_pElements(NES_NEW_ARRAY(std::atomic<Type*>, capacity)) {}
+                                ~Buffer()                                       { NES_DELETE_ARRAY(m_pElements); }
+
+            Type*               Get(const int64_t index) const                  { return m_pElements[index & (m_capacity - 1)].load(std::memory_order_relaxed); }
+            void                Put(const int64_t index, Type* pValue)          { m_pElements[index & (m_capacity - 1)].store(pValue, std::memory_order_relaxed); }
+
+            int64_t             m_capacity;
+            std::atomic<Type*>* m_pElements;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Replace the buffer with one that has twice the capacity, copying the elements in [top, bottom).
+        //----------------------------------------------------------------------------------------------------
+        Buffer*                 Grow(Buffer* pBuffer, const int64_t top, const int64_t bottom);
+
+        alignas (NES_CACHE_LINE_SIZE) std::atomic<int64_t> m_top { 0 };        /// Index of the next element to steal.
+        alignas (NES_CACHE_LINE_SIZE) std::atomic<int64_t> m_bottom { 0 };     /// Index of the next element to push.
+        std::atomic<Buffer*>    m_pBuffer;                                          /// Current buffer.
+        std::vector<Buffer*>    m_retiredBuffers;                                   /// Buffers that were replaced, freed on destruction.
+    };
+
+    template <typename Type>
+    WorkStealingDeque<Type>::WorkStealingDeque(const int64_t initialCapacity)
+        : m_pBuffer(NES_NEW(Buffer(initialCapacity)))
+    {
+        NES_ASSERT(initialCapacity > 0 && (initialCapacity & (initialCapacity - 1)) == 0, "Capacity must be a power of two!");
+    }
+
+    template <typename Type>
+    WorkStealingDeque<Type>::~WorkStealingDeque()
+    {
+        NES_DELETE(m_pBuffer.load(std::memory_order_relaxed));
+        for (Buffer* pBuffer : m_retiredBuffers)
+        {
+            NES_DELETE(pBuffer);
+        }
+    }
+
+    template <typename Type>
+    void WorkStealingDeque<Type>::Push(Type* pValue)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        Buffer* pBuffer = m_pBuffer.load(std::memory_order_relaxed);
+
+        // Grow the buffer if it is full.
+        if (bottom - top > pBuffer->m_capacity - 1)
+            pBuffer = Grow(pBuffer, top, bottom);
+
+        pBuffer->Put(bottom, pValue);
+
+        // Make sure that the element is visible before publishing the new bottom.
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    template <typename Type>
+    Type* WorkStealingDeque<Type>::Pop()
+    {
+        // Reserve the bottom element before reading the top, so that stealing threads see the reservation.
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* pBuffer = m_pBuffer.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        // The deque was empty, restore the bottom.
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Type* pValue = pBuffer->Get(bottom);
+        if (top == bottom)
+        {
+            // This is the last element, race against stealing threads for it.
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                pValue = nullptr;
+
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return pValue;
+    }
+
+    template <typename Type>
+    Type* WorkStealingDeque<Type>::Steal()
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return nullptr;
+
+        // Read the element before claiming it. If the claim fails, another thread took it (or the buffer
+        // has grown), and the value must not be used.
+        Buffer* pBuffer = m_pBuffer.load(std::memory_order_acquire);
+        Type* pValue = pBuffer->Get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+
+        return pValue;
+    }
+
+    template <typename Type>
+    bool WorkStealingDeque<Type>::IsEmpty() const
+    {
+        const int64_t top = m_top.load(std::memory_order_relaxed);
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        return top >= bottom;
+    }
+
+    template <typename Type>
+    typename WorkStealingDeque<Type>::Buffer* WorkStealingDeque<Type>::Grow(Buffer* pBuffer, const int64_t top, const int64_t bottom)
+    {
+        Buffer* pNewBuffer = NES_NEW(Buffer(pBuffer->m_capacity * 2));
+        for (int64_t i = top; i < bottom; ++i)
+        {
+            pNewBuffer->Put(i, pBuffer->Get(i));
+        }
+
+        // The old buffer may still be read by a stealing thread, so it is only freed on destruction.
+        m_retiredBuffers.push_back(pBuffer);
+        m_pBuffer.store(pNewBuffer, std::memory_order_release);
+        return pNewBuffer;
+    }
+}
@@ -3,6 +3,7 @@
 #include "Plane.h"
 #include "Nessie/Math/Vec4.h"
 #include "Nessie/Math/Mat44.h"
+#include "Nessie/Math/DVec3.h"
 
 namespace nes
 {
@@ -114,6 +115,14 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         NES_INLINE void         Translate(const Vec3 translation);
 
+#ifdef NES_DOUBLE_PRECISION
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Translate the bounding box by a double precision translation. The result is rounded
+        ///     outwards, so that the box still contains everything it contained before the translation.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         Translate(const DVec3& translation);
+#endif
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Transform the bounding box by the given matrix.
         //----------------------------------------------------------------------------------------------------
@@ -81,6 +81,14 @@ namespace nes
         m_max += translation;
     }
 
+#ifdef NES_DOUBLE_PRECISION
+    void AABox::Translate(const DVec3& translation)
+    {
+        m_min = (translation + m_min).ToVec3RoundDown();
+        m_max = (translation + m_max).ToVec3RoundUp();
+    }
+#endif
+
     AABox AABox::Transformed(const Mat44& matrix) const
     {
         // Start with the translation
@@ -37,6 +37,58 @@ namespace nes::math
         return UVec4Reg::Not(UVec4Reg::Or(UVec4Reg::Or(noOverlapX, noOverlapY), noOverlapZ));
     }
 
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Test a single box against 8 boxes with dimensions split into arrays. With AVX, all 8 boxes
+    ///     are tested at once, otherwise this falls back to two 4-wide tests.
+    ///	@param box : Box to test against.
+    ///	@param pBox8MinX : The min X values of the 8 boxes. Must be 32 byte aligned.
+    ///	@param pBox8MinY : The min Y values of the 8 boxes. Must be 32 byte aligned.
+    ///	@param pBox8MinZ : The min Z values of the 8 boxes. Must be 32 byte aligned.
+    ///	@param pBox8MaxX : The max X values of the 8 boxes. Must be 32 byte aligned.
+    ///	@param pBox8MaxY : The max Y values of the 8 boxes. Must be 32 byte aligned.
+    ///	@param pBox8MaxZ : The max Z values of the 8 boxes. Must be 32 byte aligned.
+    ///	@param outOverlapLow : Overlap results for boxes [0, 3].
+    ///	@param outOverlapHigh : Overlap results for boxes [4, 7].
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE void AABox8VsAABox(const AABox& box, const float* pBox8MinX, const float* pBox8MinY, const float* pBox8MinZ, const float* pBox8MaxX, const float* pBox8MaxY, const float* pBox8MaxZ, UVec4Reg& outOverlapLow, UVec4Reg& outOverlapHigh)
+    {
+    #if defined(NES_USE_AVX)
+        // Splat the values of the single box
+        const __m256 boxMinX = _mm256_set1_ps(box.m_min.x);
+        const __m256 boxMinY = _mm256_set1_ps(box.m_min.y);
+        const __m256 boxMinZ = _mm256_set1_ps(box.m_min.z);
+        const __m256 boxMaxX = _mm256_set1_ps(box.m_max.x);
+        const __m256 boxMaxY = _mm256_set1_ps(box.m_max.y);
+        const __m256 boxMaxZ = _mm256_set1_ps(box.m_max.z);
+
+        // Test separation over each axis:
+        const __m256 noOverlapX = _mm256_or_ps(_mm256_cmp_ps(boxMinX, _mm256_load_ps(pBox8MaxX), _CMP_GT_OQ), _mm256_cmp_ps(_mm256_load_ps(pBox8MinX), boxMaxX, _CMP_GT_OQ));
+        const __m256 noOverlapY = _mm256_or_ps(_mm256_cmp_ps(boxMinY, _mm256_load_ps(pBox8MaxY), _CMP_GT_OQ), _mm256_cmp_ps(_mm256_load_ps(pBox8MinY), boxMaxY, _CMP_GT_OQ));
+        const __m256 noOverlapZ = _mm256_or_ps(_mm256_cmp_ps(boxMinZ, _mm256_load_ps(pBox8MaxZ), _CMP_GT_OQ), _mm256_cmp_ps(_mm256_load_ps(pBox8MinZ), boxMaxZ, _CMP_GT_OQ));
+        const __m256 noOverlap = _mm256_or_ps(_mm256_or_ps(noOverlapX, noOverlapY), noOverlapZ);
+
+        // Split the result into the two halves:
+        outOverlapLow = UVec4Reg::Not(UVec4Reg(_mm_castps_si128(_mm256_castps256_ps128(noOverlap))));
+        outOverlapHigh = UVec4Reg::Not(UVec4Reg(_mm_castps_si128(_mm256_extractf128_ps(noOverlap, 1))));
+    #else
+        outOverlapLow = AABox4VsAABox(box
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MinX))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MinY))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MinZ))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MaxX))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MaxY))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MaxZ)));
+
+        outOverlapHigh = AABox4VsAABox(box
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MinX + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MinY + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MinZ + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MaxX + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MaxY + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBox8MaxZ + 4)));
+    #endif
+    }
+
     //----------------------------------------------------------------------------------------------------
     /// @brief : Scale 4 axis aligned boxes. 
     //----------------------------------------------------------------------------------------------------
@@ -226,9 +226,10 @@ namespace nes::ClosestPoint
             {
                 const float c1 = c.Dot(v1);
                 const float c2 = c.Dot(v2);
-                outV = (d22 * c1 - d12 * c2) / denominator;
-                outW = (d11 * c2 - d12 * c1) / denominator;
-                outU = 1.0f - outV - outW;
+                // c - u * v1 - v * v2 = (u * a) + (v * b) + ((1 - u - v) * c)
+                outU = (d22 * c1 - d12 * c2) / denominator;
+                outV = (d11 * c2 - d12 * c1) / denominator;
+                outW = 1.0f - outU - outV;
             }
         }
 
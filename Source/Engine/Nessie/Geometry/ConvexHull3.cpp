@@ -0,0 +1,416 @@
+﻿// ConvexHull3.cpp
+#include "ConvexHull3.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace nes
+{
+    /// Triangles whose normals differ less than this (cosine of the angle) can be merged into a single face.
+    static constexpr float kCoplanarNormalDot = 0.999f;
+
+    ConvexHull3::EResult ConvexHull3::TrySolve(const std::vector<Vec3>& points, const int maxVertices, const float tolerance)
+    {
+        Clear();
+        m_pPoints = &points;
+        m_tolerance = tolerance;
+
+        const int numPoints = static_cast<int>(points.size());
+        if (numPoints < 4 || maxVertices < 4)
+            return EResult::TooFewPoints;
+
+        // Find the extreme points along each axis.
+        int extremes[6] = { 0, 0, 0, 0, 0, 0 };
+        for (int i = 1; i < numPoints; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (points[i][axis] < points[extremes[2 * axis]][axis])
+                    extremes[2 * axis] = i;
+                if (points[i][axis] > points[extremes[2 * axis + 1]][axis])
+                    extremes[2 * axis + 1] = i;
+            }
+        }
+
+        // The two extreme points that are furthest apart form the first edge.
+        int index0 = -1, index1 = -1;
+        float maxDistanceSqr = math::Squared(tolerance);
+        for (int a = 0; a < 6; ++a)
+        {
+            for (int b = a + 1; b < 6; ++b)
+            {
+                const float distanceSqr = (points[extremes[a]] - points[extremes[b]]).LengthSqr();
+                if (distanceSqr > maxDistanceSqr)
+                {
+                    maxDistanceSqr = distanceSqr;
+                    index0 = extremes[a];
+                    index1 = extremes[b];
+                }
+            }
+        }
+
+        if (index0 < 0)
+            return EResult::Degenerate;
+
+        // The point furthest from the line forms the first triangle.
+        const Vec3 lineDirection = (points[index1] - points[index0]).Normalized();
+        int index2 = -1;
+        maxDistanceSqr = math::Squared(tolerance);
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const float distanceSqr = (points[i] - points[index0]).Cross(lineDirection).LengthSqr();
+            if (distanceSqr > maxDistanceSqr)
+            {
+                maxDistanceSqr = distanceSqr;
+                index2 = i;
+            }
+        }
+
+        if (index2 < 0)
+            return EResult::Degenerate;
+
+        // The point furthest from the plane forms the initial tetrahedron.
+        const Vec3 planeNormal = (points[index1] - points[index0]).Cross(points[index2] - points[index0]).Normalized();
+        int index3 = -1;
+        float maxDistance = tolerance;
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const float distance = math::Abs(planeNormal.Dot(points[i] - points[index0]));
+            if (distance > maxDistance)
+            {
+                maxDistance = distance;
+                index3 = i;
+            }
+        }
+
+        if (index3 < 0)
+            return EResult::Degenerate;
+
+        // Make sure that the base triangle faces away from the last point.
+        if (planeNormal.Dot(points[index3] - points[index0]) > 0.f)
+            std::swap(index1, index2);
+
+        const int tetrahedron[4] =
+        {
+            CreateTriangle(index0, index1, index2),
+            CreateTriangle(index0, index3, index1),
+            CreateTriangle(index1, index3, index2),
+            CreateTriangle(index2, index3, index0),
+        };
+
+        // Connect the triangles of the tetrahedron by finding the edges that go in opposite directions.
+        for (int t1 = 0; t1 < 4; ++t1)
+        {
+            for (int e1 = 0; e1 < 3; ++e1)
+            {
+                const Triangle& triangle1 = m_triangles[tetrahedron[t1]];
+                const int start = triangle1.m_vertices[e1];
+                const int end = triangle1.m_vertices[(e1 + 1) % 3];
+                for (int t2 = t1 + 1; t2 < 4; ++t2)
+                {
+                    const Triangle& triangle2 = m_triangles[tetrahedron[t2]];
+                    for (int e2 = 0; e2 < 3; ++e2)
+                    {
+                        if (triangle2.m_vertices[e2] == end && triangle2.m_vertices[(e2 + 1) % 3] == start)
+                            LinkTriangles(tetrahedron[t1], e1, tetrahedron[t2], e2);
+                    }
+                }
+            }
+        }
+
+        // Assign all other points to the triangle they are furthest in front of.
+        for (int i = 0; i < numPoints; ++i)
+        {
+            if (i != index0 && i != index1 && i != index2 && i != index3)
+                AssignToConflictList(i, tetrahedron, 4);
+        }
+
+        // Keep adding the point that is furthest outside the hull.
+        EResult result = EResult::Success;
+        int numVertices = 4;
+        for (;;)
+        {
+            int bestTriangle = -1;
+            float bestDistance = 0.f;
+            for (size_t i = 0; i < m_triangles.size(); ++i)
+            {
+                const Triangle& triangle = m_triangles[i];
+                if (!triangle.m_isRemoved && triangle.m_furthestPoint >= 0 && triangle.m_furthestDistance > bestDistance)
+                {
+                    bestDistance = triangle.m_furthestDistance;
+                    bestTriangle = static_cast<int>(i);
+                }
+            }
+
+            if (bestTriangle < 0)
+                break;
+
+            if (numVertices >= maxVertices)
+            {
+                result = EResult::MaxVerticesReached;
+                break;
+            }
+
+            AddPoint(m_triangles[bestTriangle].m_furthestPoint, bestTriangle);
+            ++numVertices;
+        }
+
+        BuildFaces();
+        return result;
+    }
+
+    void ConvexHull3::Clear()
+    {
+        m_pPoints = nullptr;
+        m_triangles.clear();
+        m_faces.clear();
+        m_hullIndices.clear();
+    }
+
+    int ConvexHull3::CreateTriangle(const int index0, const int index1, const int index2)
+    {
+        const std::vector<Vec3>& points = *m_pPoints;
+        const Vec3& p0 = points[index0];
+        const Vec3& p1 = points[index1];
+        const Vec3& p2 = points[index2];
+
+        Triangle& triangle = m_triangles.emplace_back();
+        triangle.m_vertices[0] = index0;
+        triangle.m_vertices[1] = index1;
+        triangle.m_vertices[2] = index2;
+        triangle.m_normal = (p1 - p0).Cross(p2 - p0).NormalizedOr(Vec3::Zero());
+        triangle.m_constant = -triangle.m_normal.Dot((p0 + p1 + p2) / 3.f);
+        return static_cast<int>(m_triangles.size() - 1);
+    }
+
+    void ConvexHull3::LinkTriangles(const int triangle1, const int edge1, const int triangle2, const int edge2)
+    {
+        m_triangles[triangle1].m_neighborTriangles[edge1] = triangle2;
+        m_triangles[triangle1].m_neighborEdges[edge1] = edge2;
+        m_triangles[triangle2].m_neighborTriangles[edge2] = triangle1;
+        m_triangles[triangle2].m_neighborEdges[edge2] = edge1;
+    }
+
+    void ConvexHull3::AssignToConflictList(const int pointIndex, const int* pTriangles, const size_t numTriangles)
+    {
+        const Vec3& point = (*m_pPoints)[pointIndex];
+
+        int bestTriangle = -1;
+        float bestDistance = m_tolerance;
+        for (size_t i = 0; i < numTriangles; ++i)
+        {
+            const float distance = m_triangles[pTriangles[i]].SignedDistanceTo(point);
+            if (distance > bestDistance)
+            {
+                bestDistance = distance;
+                bestTriangle = pTriangles[i];
+            }
+        }
+
+        // The point is inside the hull.
+        if (bestTriangle < 0)
+            return;
+
+        Triangle& triangle = m_triangles[bestTriangle];
+        triangle.m_conflictList.push_back(pointIndex);
+        if (bestDistance > triangle.m_furthestDistance)
+        {
+            triangle.m_furthestDistance = bestDistance;
+            triangle.m_furthestPoint = pointIndex;
+        }
+    }
+
+    void ConvexHull3::CalculateHorizon(const Vec3& eye, const int triangle, const int enterEdge, std::vector<Edge>& outHorizon, std::vector<int>& outVisible)
+    {
+        m_triangles[triangle].m_isVisited = true;
+        outVisible.push_back(triangle);
+
+        // Walk the edges in order, starting after the edge that we came from. This makes sure that the
+        // horizon edges form a connected loop: the end of edge N is the start of edge N + 1.
+        const int firstEdge = enterEdge < 0? 0 : enterEdge + 1;
+        const int numEdges = enterEdge < 0? 3 : 2;
+        for (int i = 0; i < numEdges; ++i)
+        {
+            const int edge = (firstEdge + i) % 3;
+            const int neighbor = m_triangles[triangle].m_neighborTriangles[edge];
+            if (m_triangles[neighbor].m_isVisited)
+                continue;
+
+            if (m_triangles[neighbor].SignedDistanceTo(eye) > m_tolerance)
+                CalculateHorizon(eye, neighbor, m_triangles[triangle].m_neighborEdges[edge], outHorizon, outVisible);
+            else
+                outHorizon.push_back({ triangle, edge });
+        }
+    }
+
+    void ConvexHull3::AddPoint(const int pointIndex, const int triangleIndex)
+    {
+        const Vec3 eye = (*m_pPoints)[pointIndex];
+
+        // Find all triangles that can see the point and the loop of edges that separates them from the rest of the hull.
+        std::vector<Edge> horizon;
+        std::vector<int> visible;
+        CalculateHorizon(eye, triangleIndex, -1, horizon, visible);
+
+        // Remove the visible triangles, their conflicting points need to be reassigned.
+        std::vector<int> orphans;
+        for (const int index : visible)
+        {
+            Triangle& triangle = m_triangles[index];
+            triangle.m_isRemoved = true;
+            for (const int point : triangle.m_conflictList)
+            {
+                if (point != pointIndex)
+                    orphans.push_back(point);
+            }
+            triangle.m_conflictList.clear();
+            triangle.m_conflictList.shrink_to_fit();
+            triangle.m_furthestPoint = -1;
+        }
+
+        // Create a fan of new triangles between the horizon and the point.
+        const int firstNewTriangle = static_cast<int>(m_triangles.size());
+        const int numNewTriangles = static_cast<int>(horizon.size());
+        for (const Edge& edge : horizon)
+        {
+            const Triangle& removed = m_triangles[edge.m_triangle];
+            const int start = removed.m_vertices[edge.m_edge];
+            const int end = removed.m_vertices[(edge.m_edge + 1) % 3];
+            const int neighbor = removed.m_neighborTriangles[edge.m_edge];
+            const int neighborEdge = removed.m_neighborEdges[edge.m_edge];
+
+            const int newTriangle = CreateTriangle(start, end, pointIndex);
+            LinkTriangles(newTriangle, 0, neighbor, neighborEdge);
+        }
+
+        // Connect the new triangles to each other.
+        std::vector<int> newTriangles(numNewTriangles);
+        for (int i = 0; i < numNewTriangles; ++i)
+        {
+            NES_ASSERT(m_triangles[firstNewTriangle + i].m_vertices[1] == m_triangles[firstNewTriangle + (i + 1) % numNewTriangles].m_vertices[0], "Horizon is not a closed loop!");
+            LinkTriangles(firstNewTriangle + i, 1, firstNewTriangle + (i + 1) % numNewTriangles, 2);
+            newTriangles[i] = firstNewTriangle + i;
+        }
+
+        for (const int orphan : orphans)
+            AssignToConflictList(orphan, newTriangles.data(), newTriangles.size());
+    }
+
+    void ConvexHull3::BuildFaces()
+    {
+        const std::vector<Vec3>& points = *m_pPoints;
+
+        const auto addTriangleFace = [this](const Triangle& triangle)
+        {
+            Face& face = m_faces.emplace_back();
+            face.m_vertices.assign(std::begin(triangle.m_vertices), std::end(triangle.m_vertices));
+            face.m_normal = triangle.m_normal;
+            face.m_constant = triangle.m_constant;
+        };
+
+        // Flood fill groups of coplanar triangles and merge them into polygons.
+        std::vector<int> groups(m_triangles.size(), -1);
+        std::vector<int> members;
+        std::vector<int> stack;
+        std::unordered_map<int, int> nextVertex;
+        int numGroups = 0;
+        for (size_t seed = 0; seed < m_triangles.size(); ++seed)
+        {
+            const Triangle& seedTriangle = m_triangles[seed];
+            if (seedTriangle.m_isRemoved || groups[seed] >= 0)
+                continue;
+
+            const int group = numGroups++;
+            members.clear();
+            stack.clear();
+            stack.push_back(static_cast<int>(seed));
+            groups[seed] = group;
+            while (!stack.empty())
+            {
+                const int index = stack.back();
+                stack.pop_back();
+                members.push_back(index);
+
+                for (const int neighbor : m_triangles[index].m_neighborTriangles)
+                {
+                    if (groups[neighbor] >= 0)
+                        continue;
+
+                    const Triangle& triangle = m_triangles[neighbor];
+                    if (triangle.m_normal.Dot(seedTriangle.m_normal) < kCoplanarNormalDot)
+                        continue;
+
+                    bool isCoplanar = true;
+                    for (const int vertex : triangle.m_vertices)
+                        isCoplanar &= math::Abs(seedTriangle.SignedDistanceTo(points[vertex])) <= m_tolerance;
+
+                    if (isCoplanar)
+                    {
+                        groups[neighbor] = group;
+                        stack.push_back(neighbor);
+                    }
+                }
+            }
+
+            if (members.size() == 1)
+            {
+                addTriangleFace(seedTriangle);
+                continue;
+            }
+
+            // Find the edges on the boundary of the group, these form the polygon.
+            nextVertex.clear();
+            bool isSimple = true;
+            Vec3 normal = Vec3::Zero();
+            for (const int index : members)
+            {
+                const Triangle& triangle = m_triangles[index];
+                const Vec3& p0 = points[triangle.m_vertices[0]];
+                normal += (points[triangle.m_vertices[1]] - p0).Cross(points[triangle.m_vertices[2]] - p0);
+
+                for (int edge = 0; edge < 3; ++edge)
+                {
+                    if (groups[triangle.m_neighborTriangles[edge]] != group)
+                        isSimple &= nextVertex.emplace(triangle.m_vertices[edge], triangle.m_vertices[(edge + 1) % 3]).second;
+                }
+            }
+
+            // Walk the boundary.
+            Face face;
+            if (isSimple)
+            {
+                const int start = nextVertex.begin()->first;
+                int vertex = start;
+                do
+                {
+                    face.m_vertices.push_back(vertex);
+                    vertex = nextVertex[vertex];
+                } while (vertex != start && face.m_vertices.size() <= nextVertex.size());
+
+                isSimple = vertex == start && face.m_vertices.size() == nextVertex.size();
+            }
+
+            // The group does not form a simple polygon, keep the triangles.
+            if (!isSimple)
+            {
+                for (const int index : members)
+                    addTriangleFace(m_triangles[index]);
+                continue;
+            }
+
+            // Use the area weighted normal, and move the plane out so that all vertices are on or behind it.
+            face.m_normal = normal.Normalized();
+            face.m_constant = FLT_MAX;
+            for (const int vertex : face.m_vertices)
+                face.m_constant = math::Min(face.m_constant, -face.m_normal.Dot(points[vertex]));
+
+            m_faces.push_back(std::move(face));
+        }
+
+        // Collect the unique vertices.
+        for (const Face& face : m_faces)
+            m_hullIndices.insert(m_hullIndices.end(), face.m_vertices.begin(), face.m_vertices.end());
+
+        std::sort(m_hullIndices.begin(), m_hullIndices.end());
+        m_hullIndices.erase(std::unique(m_hullIndices.begin(), m_hullIndices.end()), m_hullIndices.end());
+    }
+}
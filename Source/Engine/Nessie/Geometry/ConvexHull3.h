@@ -0,0 +1,109 @@
+﻿// ConvexHull3.h
+#pragma once
+#include <vector>
+#include "Nessie/Math/Math.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A 3D Convex Hull built with the quickhull algorithm. Like ConvexHull2, this stores
+    ///   indices into the set of points it was built from. Triangles that are coplanar (within the
+    ///   tolerance) are merged into polygon faces.
+    /// @note : This is meant for cooking shapes offline or at load time, it allocates and is not
+    ///   optimized for use during simulation.
+    //----------------------------------------------------------------------------------------------------
+    class ConvexHull3
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Polygon face of the hull. 
+        //----------------------------------------------------------------------------------------------------
+        struct Face
+        {
+            std::vector<int>        m_vertices;         /// Indices into the points array, counter-clockwise when seen from the outside.
+            Vec3                    m_normal;           /// Outward facing normal of the face.
+            float                   m_constant = 0.f;   /// Plane constant, a point X is on the plane when X.Dot(m_normal) + m_constant = 0.
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Result of TrySolve(). 
+        //----------------------------------------------------------------------------------------------------
+        enum class EResult
+        {
+            Success,                /// The hull contains all points.
+            MaxVerticesReached,     /// The hull was built, but some points were left outside because the max number of vertices was reached.
+            TooFewPoints,           /// Need at least 4 points to build a hull.
+            Degenerate,             /// The points are (nearly) colinear or coplanar.
+        };
+
+    public:
+        ConvexHull3() = default;
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Attempt to create a Convex Hull from the set of points.
+        ///	@param points : Points to build the hull around. These must remain valid while using the results.
+        ///	@param maxVertices : Maximum number of vertices in the hull. When reached, the points that are
+        ///     furthest outside the hull will have been added first.
+        ///	@param tolerance : Points closer than this distance to the hull are considered inside.
+        //----------------------------------------------------------------------------------------------------
+        EResult                     TrySolve(const std::vector<Vec3>& points, const int maxVertices, const float tolerance);
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Clears the previously solved solution for a set of points. 
+        //----------------------------------------------------------------------------------------------------
+        void                        Clear();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the resulting polygon faces after calling TrySolve().
+        //----------------------------------------------------------------------------------------------------
+        const std::vector<Face>&    GetFaces() const            { return m_faces; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the indices of all points that are a vertex of the hull, sorted in increasing order. 
+        //----------------------------------------------------------------------------------------------------
+        const std::vector<int>&     GetHullIndices() const      { return m_hullIndices; }
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Triangle used while building the hull. Neighbor 'i' shares the edge from vertex i to vertex i + 1. 
+        //----------------------------------------------------------------------------------------------------
+        struct Triangle
+        {
+            int                     m_vertices[3];
+            int                     m_neighborTriangles[3] = { -1, -1, -1 };
+            int                     m_neighborEdges[3] = { -1, -1, -1 };
+            Vec3                    m_normal;
+            float                   m_constant = 0.f;
+            std::vector<int>        m_conflictList;             /// Points outside the hull that are closest to being 'above' this triangle.
+            int                     m_furthestPoint = -1;       /// The point in the conflict list that is furthest away from the triangle.
+            float                   m_furthestDistance = 0.f;   /// Distance of the furthest point to the triangle's plane.
+            bool                    m_isRemoved = false;
+            bool                    m_isVisited = false;
+
+            inline float            SignedDistanceTo(const Vec3& point) const { return m_normal.Dot(point) + m_constant; }
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Half edge of a triangle, used to describe the horizon. 
+        //----------------------------------------------------------------------------------------------------
+        struct Edge
+        {
+            int                     m_triangle;
+            int                     m_edge;
+        };
+
+        int                         CreateTriangle(const int index0, const int index1, const int index2);
+        void                        LinkTriangles(const int triangle1, const int edge1, const int triangle2, const int edge2);
+        void                        AssignToConflictList(const int pointIndex, const int* pTriangles, const size_t numTriangles);
+        void                        CalculateHorizon(const Vec3& eye, const int triangle, const int enterEdge, std::vector<Edge>& outHorizon, std::vector<int>& outVisible);
+        void                        AddPoint(const int pointIndex, const int triangleIndex);
+        void                        BuildFaces();
+
+    private:
+        const std::vector<Vec3>*    m_pPoints = nullptr;
+        std::vector<Triangle>       m_triangles{};
+        std::vector<Face>           m_faces{};
+        std::vector<int>            m_hullIndices{};
+        float                       m_tolerance = 0.f;
+    };
+}
@@ -360,7 +360,9 @@ namespace nes
         float lambda = 0.f;
         Vec3 x = rayOrigin;
         Vec3 v = x - inA.GetSupport(Vec3::Zero());
-        float vLengthSqr = v.LengthSqr();
+
+        // v is not on the simplex yet, so its length can't be used as an early out when GetClosest() returns false.
+        float vLengthSqr = FLT_MAX;
         bool allowRestart = false;
 
         for (;;)
@@ -493,7 +495,8 @@ namespace nes
         // See CastRay: v = x - inA.GetSupport(Vec3::Zero()) where inA is the Minkowski difference inB - transformedA (see CastShape above) and x is zero
         Vec3 v = -inB.GetSupport(Vec3::Zero()) + transformedA.GetSupport(Vec3::Zero());
 
-        float vLengthSqr = v.LengthSqr();
+        // v is not on the simplex yet, so its length can't be used as an early out when GetClosest() returns false.
+        float vLengthSqr = FLT_MAX;
         bool allowRestart = false;
 
         // Keeps track of the separating axis of the previous iteration
@@ -0,0 +1,48 @@
+// IndexedTriangle.h
+#pragma once
+#include "Nessie/Math/Math.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Triangle that references its vertices by index into a vertex list. 
+    //----------------------------------------------------------------------------------------------------
+    struct IndexedTriangle
+    {
+        uint32              m_indices[3]{};
+
+        constexpr           IndexedTriangle() = default;
+        constexpr           IndexedTriangle(const uint32 index0, const uint32 index1, const uint32 index2) : m_indices{ index0, index1, index2 } {}
+
+        uint32&             operator[](const size_t index)          { NES_ASSERT(index < 3); return m_indices[index]; }
+        uint32              operator[](const size_t index) const    { NES_ASSERT(index < 3); return m_indices[index]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if two triangles reference the same vertices in the same winding order.
+        //----------------------------------------------------------------------------------------------------
+        bool                IsEquivalent(const IndexedTriangle& other) const
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                if (m_indices[0] == other.m_indices[i] && m_indices[1] == other.m_indices[(i + 1) % 3] && m_indices[2] == other.m_indices[(i + 2) % 3])
+                    return true;
+            }
+            return false;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if the triangle has no area: either two indices are the same, or the vertices
+        ///     are (nearly) colinear.
+        //----------------------------------------------------------------------------------------------------
+        bool                IsDegenerate(const Float3* pVertices) const
+        {
+            if (m_indices[0] == m_indices[1] || m_indices[1] == m_indices[2] || m_indices[2] == m_indices[0])
+                return true;
+
+            const Vec3 v0(pVertices[m_indices[0]]);
+            const Vec3 v1(pVertices[m_indices[1]]);
+            const Vec3 v2(pVertices[m_indices[2]]);
+            return (v1 - v0).Cross(v2 - v0).IsNearZero();
+        }
+    };
+}
@@ -132,6 +132,106 @@ namespace nes
         return Vec4Reg::Select(tMin, fltMax, noIntersection);
     }
 
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Intersect 8 AABBs with a ray. Gives the minimal distance along the ray for each box, or FLT_MAX
+    ///     if no hit. With AVX, all 8 boxes are tested at once, otherwise this falls back to two RayAABox4 tests.
+    ///     The bounds arrays must be 32 byte aligned.
+    ///	@param outFractionLow : Results for boxes [0, 3].
+    ///	@param outFractionHigh : Results for boxes [4, 7].
+    /// @note : Can return negative value if the ray starts in the box.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE void RayAABox8(const Vec3 origin, const RayInvDirection& invDirection, const float* pBoundsMinX, const float* pBoundsMinY, const float* pBoundsMinZ, const float* pBoundsMaxX, const float* pBoundsMaxY, const float* pBoundsMaxZ, Vec4Reg& outFractionLow, Vec4Reg& outFractionHigh)
+    {
+    #if defined(NES_USE_AVX)
+        // Constants
+        const __m256 fltMin = _mm256_set1_ps(-FLT_MAX);
+        const __m256 fltMax = _mm256_set1_ps(FLT_MAX);
+
+        // Origin
+        const __m256 originX = _mm256_set1_ps(origin.x);
+        const __m256 originY = _mm256_set1_ps(origin.y);
+        const __m256 originZ = _mm256_set1_ps(origin.z);
+
+        // Parallel
+        const __m256 parallelX = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(invDirection.m_isParallel.GetX())));
+        const __m256 parallelY = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(invDirection.m_isParallel.GetY())));
+        const __m256 parallelZ = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(invDirection.m_isParallel.GetZ())));
+
+        // Inverse Direction
+        const __m256 invDirX = _mm256_set1_ps(invDirection.m_invDirection.x);
+        const __m256 invDirY = _mm256_set1_ps(invDirection.m_invDirection.y);
+        const __m256 invDirZ = _mm256_set1_ps(invDirection.m_invDirection.z);
+
+        // Bounds
+        const __m256 boundsMinX = _mm256_load_ps(pBoundsMinX);
+        const __m256 boundsMinY = _mm256_load_ps(pBoundsMinY);
+        const __m256 boundsMinZ = _mm256_load_ps(pBoundsMinZ);
+        const __m256 boundsMaxX = _mm256_load_ps(pBoundsMaxX);
+        const __m256 boundsMaxY = _mm256_load_ps(pBoundsMaxY);
+        const __m256 boundsMaxZ = _mm256_load_ps(pBoundsMaxZ);
+
+        // Test against all three axes simultaneously.
+        const __m256 t1X = _mm256_mul_ps(_mm256_sub_ps(boundsMinX, originX), invDirX);
+        const __m256 t1Y = _mm256_mul_ps(_mm256_sub_ps(boundsMinY, originY), invDirY);
+        const __m256 t1Z = _mm256_mul_ps(_mm256_sub_ps(boundsMinZ, originZ), invDirZ);
+        const __m256 t2X = _mm256_mul_ps(_mm256_sub_ps(boundsMaxX, originX), invDirX);
+        const __m256 t2Y = _mm256_mul_ps(_mm256_sub_ps(boundsMaxY, originY), invDirY);
+        const __m256 t2Z = _mm256_mul_ps(_mm256_sub_ps(boundsMaxZ, originZ), invDirZ);
+
+        // Compute the max of min(t1, t2) and the min of max (t1, t2) ensuring we don't
+        // use the results from any directions that are parallel to the slab.
+        const __m256 tMinX = _mm256_blendv_ps(_mm256_min_ps(t1X, t2X), fltMin, parallelX);
+        const __m256 tMinY = _mm256_blendv_ps(_mm256_min_ps(t1Y, t2Y), fltMin, parallelY);
+        const __m256 tMinZ = _mm256_blendv_ps(_mm256_min_ps(t1Z, t2Z), fltMin, parallelZ);
+        const __m256 tMaxX = _mm256_blendv_ps(_mm256_max_ps(t1X, t2X), fltMax, parallelX);
+        const __m256 tMaxY = _mm256_blendv_ps(_mm256_max_ps(t1Y, t2Y), fltMax, parallelY);
+        const __m256 tMaxZ = _mm256_blendv_ps(_mm256_max_ps(t1Z, t2Z), fltMax, parallelZ);
+
+        // tMin.xyz = max(tMin.x, tMin.y, tMin.z)
+        const __m256 tMin = _mm256_max_ps(_mm256_max_ps(tMinX, tMinY), tMinZ);
+
+        // tMax.xyz = min(tMax.x, tMax.y, tMax.z)
+        const __m256 tMax = _mm256_min_ps(_mm256_min_ps(tMaxX, tMaxY), tMaxZ);
+
+        // If (tMin > tMax) return FLT_MAX
+        __m256 noIntersection = _mm256_cmp_ps(tMin, tMax, _CMP_GT_OQ);
+
+        // If (tMax < 0.f) return FLT_MAX
+        noIntersection = _mm256_or_ps(noIntersection, _mm256_cmp_ps(tMax, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+        // If bounds are invalid, return FLT_MAX
+        const __m256 boundsInvalid = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(boundsMinX, boundsMaxX, _CMP_GT_OQ), _mm256_cmp_ps(boundsMinY, boundsMaxY, _CMP_GT_OQ)), _mm256_cmp_ps(boundsMinZ, boundsMaxZ, _CMP_GT_OQ));
+        noIntersection = _mm256_or_ps(noIntersection, boundsInvalid);
+
+        // If (invDirection.m_isParallel && !(min <= origin && origin <= max)) return FLT_MAX; else return tMin.
+        const __m256 noParallelOverlapX = _mm256_and_ps(parallelX, _mm256_or_ps(_mm256_cmp_ps(originX, boundsMinX, _CMP_LT_OQ), _mm256_cmp_ps(originX, boundsMaxX, _CMP_GT_OQ)));
+        const __m256 noParallelOverlapY = _mm256_and_ps(parallelY, _mm256_or_ps(_mm256_cmp_ps(originY, boundsMinY, _CMP_LT_OQ), _mm256_cmp_ps(originY, boundsMaxY, _CMP_GT_OQ)));
+        const __m256 noParallelOverlapZ = _mm256_and_ps(parallelZ, _mm256_or_ps(_mm256_cmp_ps(originZ, boundsMinZ, _CMP_LT_OQ), _mm256_cmp_ps(originZ, boundsMaxZ, _CMP_GT_OQ)));
+        noIntersection = _mm256_or_ps(noIntersection, _mm256_or_ps(_mm256_or_ps(noParallelOverlapX, noParallelOverlapY), noParallelOverlapZ));
+        const __m256 fraction = _mm256_blendv_ps(tMin, fltMax, noIntersection);
+
+        // Split the result into the two halves:
+        outFractionLow = Vec4Reg(_mm256_castps256_ps128(fraction));
+        outFractionHigh = Vec4Reg(_mm256_extractf128_ps(fraction, 1));
+    #else
+        outFractionLow = RayAABox4(origin, invDirection
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMinX))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMinY))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMinZ))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMaxX))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMaxY))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMaxZ)));
+
+        outFractionHigh = RayAABox4(origin, invDirection
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMinX + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMinY + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMinZ + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMaxX + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMaxY + 4))
+            , Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(pBoundsMaxZ + 4)));
+    #endif
+    }
+
     //----------------------------------------------------------------------------------------------------
     /// @brief : Intersect AABB with ray, returns minimal and maximal distance along ray or FLT_MAX, -FLT_MAX if no hit
     /// @note : Can return negative value for outMin if the ray starts in the box.
@@ -0,0 +1,55 @@
+// RayCapsule.h
+#pragma once
+#include "RaySphere.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Intersect a ray with an infinite cylinder centered around the origin with its axis along Y.
+    ///	@param origin : Origin of the ray.
+    ///	@param direction : Direction of the ray. Does not need to be normalized, fractions are relative to its length.
+    ///	@param cylinderRadius : Radius of the cylinder.
+    ///	@returns : FLT_MAX if there is no hit, otherwise the fraction along the ray where it enters the cylinder.
+    ///     Returns 0 if the ray starts inside the cylinder.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE float RayInfiniteCylinder(const Vec3& origin, const Vec3& direction, const float cylinderRadius)
+    {
+        // Remove the Y component, this reduces the problem to ray vs circle in the XZ plane.
+        const Vec3 origin2D(origin.x, 0.f, origin.z);
+        const Vec3 direction2D(direction.x, 0.f, direction.z);
+        return RaySphere(origin2D, direction2D, Vec3::Zero(), cylinderRadius);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Intersect a ray with a capsule centered around the origin with its axis along Y.
+    ///	@param origin : Origin of the ray.
+    ///	@param direction : Direction of the ray. Does not need to be normalized, fractions are relative to its length.
+    ///	@param halfHeightOfCylinder : Distance from the origin to the center of the top (or bottom) sphere.
+    ///	@param radius : Radius of the capsule.
+    ///	@returns : FLT_MAX if there is no hit, otherwise the fraction along the ray where it enters the capsule.
+    ///     Returns 0 if the ray starts inside the capsule.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE float RayCapsule(const Vec3& origin, const Vec3& direction, const float halfHeightOfCylinder, const float radius)
+    {
+        // Test if the origin is inside the capsule
+        const float radiusSqr = math::Squared(radius);
+        const float clampedY = math::Clamp(origin.y, -halfHeightOfCylinder, halfHeightOfCylinder);
+        if ((origin - Vec3(0.f, clampedY, 0.f)).LengthSqr() <= radiusSqr)
+            return 0.f;
+
+        // Test the cylinder part. If the hit is between the caps, no other hit can be closer.
+        const float cylinderFraction = RayInfiniteCylinder(origin, direction, radius);
+        if (cylinderFraction != FLT_MAX)
+        {
+            const float hitY = origin.y + cylinderFraction * direction.y;
+            if (math::Abs(hitY) <= halfHeightOfCylinder)
+                return cylinderFraction;
+        }
+
+        // Test the caps
+        const Vec3 upper(0.f, halfHeightOfCylinder, 0.f);
+        const float upperFraction = RaySphere(origin, direction, upper, radius);
+        const float lowerFraction = RaySphere(origin, direction, -upper, radius);
+        return math::Min(upperFraction, lowerFraction);
+    }
+}
@@ -0,0 +1,93 @@
+// RaySphere.h
+#pragma once
+#include "Nessie/Math/Math.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Solve a * x^2 + b * x + c = 0 in a numerically stable way.
+    ///	@param outX1 : The first solution.
+    ///	@param outX2 : The second solution.
+    ///	@returns : The number of solutions (0, 1 or 2). When there is 1 solution, both outputs are equal.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE int SolveQuadratic(const float a, const float b, const float c, float& outX1, float& outX2)
+    {
+        // Linear equation
+        if (a == 0.f)
+        {
+            if (b == 0.f)
+                return 0;
+
+            outX1 = outX2 = -c / b;
+            return 1;
+        }
+
+        const float determinant = math::Squared(b) - 4.f * a * c;
+        if (determinant < 0.f)
+            return 0;
+
+        // Avoid the catastrophic cancellation of (-b +/- sqrt(det)) by computing the
+        // root with the larger magnitude first and using Vieta's formula for the other.
+        const float q = (b + std::copysign(std::sqrt(determinant), b)) / -2.f;
+        outX1 = q / a;
+        outX2 = q == 0.f? outX1 : c / q;
+        return 2;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Intersect a ray with a sphere. The ray extends infinitely in the direction.
+    ///	@param origin : Origin of the ray.
+    ///	@param direction : Direction of the ray. Does not need to be normalized, fractions are relative to its length.
+    ///	@param center : Center of the sphere.
+    ///	@param radius : Radius of the sphere.
+    ///	@returns : FLT_MAX if there is no hit, otherwise the fraction along the ray where it enters the sphere.
+    ///     Returns 0 if the ray starts inside the sphere.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE float RaySphere(const Vec3& origin, const Vec3& direction, const Vec3& center, const float radius)
+    {
+        // Solve |origin + fraction * direction - center|^2 = radius^2 for fraction.
+        const Vec3 centerToOrigin = origin - center;
+        const float a = direction.LengthSqr();
+        const float b = 2.f * direction.Dot(centerToOrigin);
+        const float c = centerToOrigin.LengthSqr() - math::Squared(radius);
+        float fraction1, fraction2;
+        if (SolveQuadratic(a, b, c, fraction1, fraction2) == 0)
+            return c <= 0.f? 0.f : FLT_MAX; // Parallel ray, hit only if we start inside.
+
+        if (fraction1 > fraction2)
+            std::swap(fraction1, fraction2);
+
+        // The lowest fraction is where the ray enters the sphere
+        if (fraction1 >= 0.f)
+            return fraction1;
+
+        // The highest fraction is where the ray leaves the sphere, if it is positive we started inside.
+        if (fraction2 >= 0.f)
+            return 0.f;
+
+        return FLT_MAX;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Intersect a ray with a sphere, returning both the entry and exit fractions.
+    ///	@param origin : Origin of the ray.
+    ///	@param direction : Direction of the ray. Does not need to be normalized, fractions are relative to its length.
+    ///	@param center : Center of the sphere.
+    ///	@param radius : Radius of the sphere.
+    ///	@param outMinFraction : Fraction where the ray enters the sphere. Can be negative if the ray starts inside.
+    ///	@param outMaxFraction : Fraction where the ray exits the sphere.
+    ///	@returns : The number of intersections with the (infinite) line, 0 if there is no hit.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE int RaySphere(const Vec3& origin, const Vec3& direction, const Vec3& center, const float radius, float& outMinFraction, float& outMaxFraction)
+    {
+        const Vec3 centerToOrigin = origin - center;
+        const float a = direction.LengthSqr();
+        const float b = 2.f * direction.Dot(centerToOrigin);
+        const float c = centerToOrigin.LengthSqr() - math::Squared(radius);
+        const int numResults = SolveQuadratic(a, b, c, outMinFraction, outMaxFraction);
+        if (numResults == 2 && outMinFraction > outMaxFraction)
+            std::swap(outMinFraction, outMaxFraction);
+
+        return numResults;
+    }
+}
@@ -0,0 +1,122 @@
+// RayTriangle.h
+#pragma once
+#include "Nessie/Math/Math.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Intersect a ray with a triangle (Moller-Trumbore). Both sides of the triangle are hit.
+    ///	@param origin : Start of the ray.
+    ///	@param direction : Direction (and length) of the ray.
+    ///	@returns : The fraction along the ray of the hit, or FLT_MAX if there is no hit. A hit fraction
+    ///     is never negative.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE float RayTriangle(const Vec3& origin, const Vec3& direction, const Vec3& v0, const Vec3& v1, const Vec3& v2)
+    {
+        constexpr float kEpsilon = 1.0e-12f;
+
+        // Find the vectors for the two edges sharing v0
+        const Vec3 edge1 = v1 - v0;
+        const Vec3 edge2 = v2 - v0;
+
+        // If the determinant is near zero, the ray lies in the plane of the triangle.
+        const Vec3 p = direction.Cross(edge2);
+        float determinant = edge1.Dot(p);
+        if (math::Abs(determinant) < kEpsilon)
+            return FLT_MAX;
+
+        // Make the determinant positive, flipping the sign of the parameters instead.
+        const float sign = determinant < 0.f? -1.f : 1.f;
+        determinant *= sign;
+
+        // Calculate the u parameter and test the bounds.
+        const Vec3 s = sign * (origin - v0);
+        const float u = s.Dot(p);
+        if (u < 0.f || u > determinant)
+            return FLT_MAX;
+
+        // Calculate the v parameter and test the bounds.
+        const Vec3 q = s.Cross(edge1);
+        const float v = direction.Dot(q);
+        if (v < 0.f || u + v > determinant)
+            return FLT_MAX;
+
+        // Calculate the t parameter and make sure the triangle is in front of the ray.
+        const float t = edge2.Dot(q);
+        if (t < 0.f)
+            return FLT_MAX;
+
+        return t / determinant;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Intersect a ray with 4 triangles at the same time. The vertices of the triangles are
+    ///     split into registers: the X component of each register belongs to the first triangle, etc.
+    ///     Both sides of the triangles are hit.
+    ///	@returns : The fraction along the ray of the hit for each triangle, or FLT_MAX if there is no hit.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE Vec4Reg RayTriangle4(const Vec3& origin, const Vec3& direction, const Vec4Reg& v0X, const Vec4Reg& v0Y, const Vec4Reg& v0Z, const Vec4Reg& v1X, const Vec4Reg& v1Y, const Vec4Reg& v1Z, const Vec4Reg& v2X, const Vec4Reg& v2Y, const Vec4Reg& v2Z)
+    {
+        // Constants
+        const Vec4Reg epsilon = Vec4Reg::Replicate(1.0e-12f);
+        const Vec4Reg zero = Vec4Reg::Zero();
+        const Vec4Reg one = Vec4Reg::One();
+
+        // Find the vectors for the two edges sharing v0
+        const Vec4Reg edge1X = v1X - v0X;
+        const Vec4Reg edge1Y = v1Y - v0Y;
+        const Vec4Reg edge1Z = v1Z - v0Z;
+        const Vec4Reg edge2X = v2X - v0X;
+        const Vec4Reg edge2Y = v2Y - v0Y;
+        const Vec4Reg edge2Z = v2Z - v0Z;
+
+        // Splat the direction
+        const Vec4Reg dirX = Vec4Reg::Replicate(direction.x);
+        const Vec4Reg dirY = Vec4Reg::Replicate(direction.y);
+        const Vec4Reg dirZ = Vec4Reg::Replicate(direction.z);
+
+        // p = direction x edge2
+        const Vec4Reg pX = dirY * edge2Z - dirZ * edge2Y;
+        const Vec4Reg pY = dirZ * edge2X - dirX * edge2Z;
+        const Vec4Reg pZ = dirX * edge2Y - dirY * edge2X;
+
+        // If the determinant is near zero, the ray lies in the plane of the triangle.
+        Vec4Reg determinant = edge1X * pX + edge1Y * pY + edge1Z * pZ;
+
+        // Get the sign bit of the determinant and make it positive.
+        const Vec4Reg determinantSign = Vec4Reg::And(determinant, UVec4Reg::Replicate(0x80000000).ReinterpretAsFloat());
+        determinant = Vec4Reg::Xor(determinant, determinantSign);
+
+        // Set the determinants that are near zero to 1 to avoid dividing by zero.
+        const UVec4Reg determinantNearZero = Vec4Reg::Less(determinant, epsilon);
+        determinant = Vec4Reg::Select(determinant, one, determinantNearZero);
+
+        // s = origin - v0, with the sign of the determinant applied.
+        const Vec4Reg sX = Vec4Reg::Xor(Vec4Reg::Replicate(origin.x) - v0X, determinantSign);
+        const Vec4Reg sY = Vec4Reg::Xor(Vec4Reg::Replicate(origin.y) - v0Y, determinantSign);
+        const Vec4Reg sZ = Vec4Reg::Xor(Vec4Reg::Replicate(origin.z) - v0Z, determinantSign);
+
+        // Calculate the u parameter
+        const Vec4Reg u = sX * pX + sY * pY + sZ * pZ;
+
+        // q = s x edge1
+        const Vec4Reg qX = sY * edge1Z - sZ * edge1Y;
+        const Vec4Reg qY = sZ * edge1X - sX * edge1Z;
+        const Vec4Reg qZ = sX * edge1Y - sY * edge1X;
+
+        // Calculate the v and t parameters
+        const Vec4Reg v = dirX * qX + dirY * qY + dirZ * qZ;
+        Vec4Reg t = edge2X * qX + edge2Y * qY + edge2Z * qZ;
+
+        // Check if there is an intersection
+        const UVec4Reg noIntersection = UVec4Reg::Or
+        (
+            UVec4Reg::Or(UVec4Reg::Or(determinantNearZero, Vec4Reg::Less(u, zero)), UVec4Reg::Or(Vec4Reg::Less(v, zero), Vec4Reg::Greater(u + v, determinant))),
+            Vec4Reg::Less(t, zero)
+        );
+
+        // Divide by the determinant, and return FLT_MAX for no intersection.
+        t = t / determinant;
+        return Vec4Reg::Select(t, Vec4Reg::Replicate(FLT_MAX), noIntersection);
+    }
+}
@@ -126,7 +126,7 @@ namespace nes
     ///     start point (0) to the end (1) of segment B.  
     ///	@returns : The Squared Distance between the two closest points.
     //----------------------------------------------------------------------------------------------------
-    float ClosestPointsBetweenSegments(const Segment2& a, const Segment2& b, Vec2& closestOnA, Vec2& closestOnB, float tA, float tB);
+    float ClosestPointsBetweenSegments(const Segment2& a, const Segment2& b, Vec2& closestOnA, Vec2& closestOnB, float& tA, float& tB);
 
     //----------------------------------------------------------------------------------------------------
     ///	@brief : Computes the closest points "closestOnA" and "closestOnB" between the segments, the normalized
@@ -143,5 +143,5 @@ namespace nes
     ///     start point (0) to the end (1) of segment B.  
     ///	@returns : The Squared Distance between the two closest points.
     //----------------------------------------------------------------------------------------------------
-    float ClosestPointsBetweenSegments(const Segment& a, const Segment& b, Vec3& closestOnA, Vec3& closestOnB, float tA, float tB);
+    float ClosestPointsBetweenSegments(const Segment& a, const Segment& b, Vec3& closestOnA, Vec3& closestOnB, float& tA, float& tB);
 }
\ No newline at end of file
@@ -0,0 +1,324 @@
+// JobGraph.cpp
+#include "JobGraph.h"
+#include <fstream>
+#include <sstream>
+#include "Nessie/Debug/Log.h"
+#include "Nessie/Math/Generic.h"
+
+namespace nes
+{
+    JobGraph::NodeID JobGraph::AddNode(const char* pName, JobSystem::JobFunction&& function)
+    {
+        NES_ASSERT(!m_isRunning);
+        NES_ASSERT(function);
+
+        const NodeID id = static_cast<NodeID>(m_nodes.size());
+        Node& node = m_nodes.emplace_back();
+        node.m_pName = pName;
+        node.m_function = std::move(function);
+
+        m_isCompiled = false;
+        return id;
+    }
+
+    void JobGraph::AddDependency(const NodeID dependency, const NodeID node)
+    {
+        NES_ASSERT(!m_isRunning);
+        NES_ASSERT(dependency < m_nodes.size() && node < m_nodes.size());
+        NES_ASSERT(dependency != node, "A node can't depend on itself!");
+
+        m_edges.push_back({ dependency, node });
+        m_isCompiled = false;
+    }
+
+    bool JobGraph::Compile()
+    {
+        NES_ASSERT(!m_isRunning);
+
+        const uint32 numNodes = GetNumNodes();
+        m_isCompiled = false;
+        m_maxParallelism = 0;
+        m_rootNodes.clear();
+
+        // Count the dependencies and dependents of each node.
+        for (Node& node : m_nodes)
+        {
+            node.m_numDependencies = 0;
+            node.m_numDependents = 0;
+        }
+
+        for (const Edge& edge : m_edges)
+        {
+            ++m_nodes[edge.m_node].m_numDependencies;
+            ++m_nodes[edge.m_dependency].m_numDependents;
+        }
+
+        // Store the dependents of all nodes in a single array.
+        uint32 firstDependent = 0;
+        for (Node& node : m_nodes)
+        {
+            node.m_firstDependent = firstDependent;
+            firstDependent += node.m_numDependents;
+            node.m_numDependents = 0;
+        }
+
+        m_dependents.resize(m_edges.size());
+        for (const Edge& edge : m_edges)
+        {
+            Node& dependency = m_nodes[edge.m_dependency];
+            m_dependents[dependency.m_firstDependent + dependency.m_numDependents++] = edge.m_node;
+        }
+
+        // Visit the nodes in dependency order, to find cycles.
+        std::vector<uint32> numDependenciesLeft(numNodes);
+        std::vector<NodeID> visitOrder;
+        visitOrder.reserve(numNodes);
+
+        for (NodeID id = 0; id < numNodes; ++id)
+        {
+            numDependenciesLeft[id] = m_nodes[id].m_numDependencies;
+            if (numDependenciesLeft[id] == 0)
+            {
+                m_rootNodes.push_back(id);
+                visitOrder.push_back(id);
+            }
+        }
+
+        for (size_t i = 0; i < visitOrder.size(); ++i)
+        {
+            const Node& node = m_nodes[visitOrder[i]];
+            for (uint32 j = 0; j < node.m_numDependents; ++j)
+            {
+                const NodeID dependent = m_dependents[node.m_firstDependent + j];
+                if (--numDependenciesLeft[dependent] == 0)
+                    visitOrder.push_back(dependent);
+            }
+        }
+
+        if (visitOrder.size() != numNodes)
+        {
+            NES_ERROR("Failed to compile JobGraph! The dependencies contain a cycle.");
+            return false;
+        }
+
+        // Nodes on the same chain of dependencies never run at the same time, so the smallest number of chains that
+        // covers all nodes is an upper bound of the number of nodes that can run at the same time. Each node that can
+        // continue the chain of one of its dependencies saves a chain, so match as many nodes as possible with a dependency.
+        std::vector<NodeID> matchedDependencies(numNodes, kInvalidNodeID);
+        std::vector<uint32> visitedInMatch(numNodes, 0);
+        uint32 numMatches = 0;
+        for (NodeID id = 0; id < numNodes; ++id)
+        {
+            if (MatchDependent(id, id + 1, matchedDependencies, visitedInMatch))
+                ++numMatches;
+        }
+        m_maxParallelism = numNodes - numMatches;
+
+        // Allocate the state for running.
+        m_dependencyCounts = std::vector<std::atomic<uint32>>(numNodes);
+        m_readyNodes = std::vector<std::atomic<uint32>>(numNodes);
+
+        m_isCompiled = true;
+        return true;
+    }
+
+    void JobGraph::Run(JobSystem& jobSystem)
+    {
+        NES_ASSERT(m_isCompiled, "JobGraph must be compiled before it can be run!");
+        if (!m_isCompiled || m_nodes.empty())
+            return;
+
+        [[maybe_unused]] const bool wasRunning = m_isRunning.exchange(true, std::memory_order_acquire);
+        NES_ASSERT(!wasRunning, "JobGraph can only be run by one thread at a time!");
+
+        // Reset the state of the previous run.
+        const uint32 numNodes = GetNumNodes();
+        for (NodeID id = 0; id < numNodes; ++id)
+        {
+            m_dependencyCounts[id].store(m_nodes[id].m_numDependencies, std::memory_order_relaxed);
+            m_readyNodes[id].store(0, std::memory_order_relaxed);
+        }
+        m_readyReadIndex.store(0, std::memory_order_relaxed);
+        m_readyWriteIndex.store(0, std::memory_order_relaxed);
+        m_numNodesLeft.store(numNodes, std::memory_order_relaxed);
+
+        for (const NodeID root : m_rootNodes)
+            PushReadyNode(root);
+
+        // The calling thread always executes nodes. Without a Barrier, it executes all of them.
+        m_pJobSystem = &jobSystem;
+        m_maxThreads = math::Min(m_maxParallelism, static_cast<uint32>(math::Max(jobSystem.GetMaxConcurrency(), 1)));
+        m_pBarrier = m_maxThreads > 1? jobSystem.CreateBarrier() : nullptr;
+        if (m_pBarrier == nullptr)
+            m_maxThreads = 1;
+        m_numActiveThreads.store(1, std::memory_order_relaxed);
+
+        // Launching the Jobs publishes the state above to the threads that execute them.
+        LaunchHelpers(static_cast<uint32>(m_rootNodes.size()) - 1);
+        ExecuteNodes();
+
+        // Helpers launch more helpers while the calling thread waits, which the Barrier waits for as well.
+        if (m_pBarrier != nullptr)
+        {
+            jobSystem.WaitForJobs(m_pBarrier);
+            jobSystem.DestroyBarrier(m_pBarrier);
+            m_pBarrier = nullptr;
+        }
+        m_pJobSystem = nullptr;
+
+        NES_ASSERT(m_numNodesLeft.load(std::memory_order_acquire) == 0);
+        m_isRunning.store(false, std::memory_order_release);
+    }
+
+    void JobGraph::Clear()
+    {
+        NES_ASSERT(!m_isRunning);
+
+        m_nodes.clear();
+        m_edges.clear();
+        m_dependents.clear();
+        m_rootNodes.clear();
+        m_dependencyCounts.clear();
+        m_readyNodes.clear();
+        m_maxParallelism = 0;
+        m_isCompiled = false;
+    }
+
+    std::string JobGraph::ToDot() const
+    {
+        std::stringstream stream;
+        stream << "digraph JobGraph\n{\n";
+
+        for (NodeID id = 0; id < GetNumNodes(); ++id)
+        {
+            stream << "    node" << id << " [label=\"";
+            for (const char* pChar = m_nodes[id].m_pName; pChar != nullptr && *pChar != '\0'; ++pChar)
+            {
+                if (*pChar == '"' || *pChar == '\\')
+                    stream << '\\';
+                stream << *pChar;
+            }
+            stream << "\"];\n";
+        }
+
+        for (const Edge& edge : m_edges)
+            stream << "    node" << edge.m_dependency << " -> node" << edge.m_node << ";\n";
+
+        stream << "}\n";
+        return stream.str();
+    }
+
+    bool JobGraph::WriteDotFile(const std::filesystem::path& path) const
+    {
+        std::ofstream stream(path);
+        if (!stream.is_open())
+        {
+            NES_ERROR("Failed to write JobGraph DOT file! Failed to open filepath: {}", path.string());
+            return false;
+        }
+
+        stream << ToDot();
+        return true;
+    }
+
+    bool JobGraph::MatchDependent(const NodeID node, const uint32 visitStamp, std::vector<NodeID>& matchedDependencies, std::vector<uint32>& visitedInMatch) const
+    {
+        // Take a dependent that is not matched yet, or one whose current dependency can be matched with another dependent.
+        const Node& data = m_nodes[node];
+        for (uint32 i = 0; i < data.m_numDependents; ++i)
+        {
+            const NodeID dependent = m_dependents[data.m_firstDependent + i];
+            if (visitedInMatch[dependent] == visitStamp)
+                continue;
+            visitedInMatch[dependent] = visitStamp;
+
+            if (matchedDependencies[dependent] == kInvalidNodeID || MatchDependent(matchedDependencies[dependent], visitStamp, matchedDependencies, visitedInMatch))
+            {
+                matchedDependencies[dependent] = node;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void JobGraph::ExecuteNodes()
+    {
+        // When no node is ready, the remaining nodes are waiting for nodes that are executing on other threads. Those
+        // threads continue with one of the nodes that they release and launch helpers for the rest, so this thread stops
+        // instead of waiting.
+        NodeID id;
+        while (TryPopReadyNode(id))
+        {
+            Node& node = m_nodes[id];
+            node.m_function();
+
+            uint32 numReleased = 0;
+            for (uint32 i = 0; i < node.m_numDependents; ++i)
+            {
+                const NodeID dependent = m_dependents[node.m_firstDependent + i];
+                if (m_dependencyCounts[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    PushReadyNode(dependent);
+                    ++numReleased;
+                }
+            }
+
+            m_numNodesLeft.fetch_sub(1, std::memory_order_release);
+
+            if (numReleased > 1)
+                LaunchHelpers(numReleased - 1);
+        }
+
+        m_numActiveThreads.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void JobGraph::LaunchHelpers(uint32 count)
+    {
+        for (; count > 0; --count)
+        {
+            // Claim a thread, so that no more Jobs are launched than can run at the same time.
+            uint32 numActive = m_numActiveThreads.load(std::memory_order_relaxed);
+            do
+            {
+                if (numActive >= m_maxThreads)
+                    return;
+            } while (!m_numActiveThreads.compare_exchange_weak(numActive, numActive + 1, std::memory_order_relaxed));
+
+            const JobHandle handle = m_pJobSystem->CreateJob("JobGraph", [this]()
+            {
+                ExecuteNodes();
+            });
+            m_pBarrier->AddJob(handle);
+        }
+    }
+
+    void JobGraph::PushReadyNode(const NodeID node)
+    {
+        // Every node becomes ready exactly once per run, so there is always a free slot.
+        const uint32 slot = m_readyWriteIndex.fetch_add(1, std::memory_order_relaxed);
+        NES_ASSERT(slot < m_readyNodes.size());
+        m_readyNodes[slot].store(node + 1, std::memory_order_release);
+    }
+
+    bool JobGraph::TryPopReadyNode(NodeID& outNode)
+    {
+        uint32 slot = m_readyReadIndex.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (slot >= m_readyWriteIndex.load(std::memory_order_acquire))
+                return false;
+
+            // The slot is claimed, but the node has not been written yet.
+            const uint32 value = m_readyNodes[slot].load(std::memory_order_acquire);
+            if (value == 0)
+                return false;
+
+            if (m_readyReadIndex.compare_exchange_weak(slot, slot + 1, std::memory_order_relaxed))
+            {
+                outNode = value - 1;
+                return true;
+            }
+        }
+    }
+}
@@ -0,0 +1,166 @@
+// JobGraph.h
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Nessie/Jobs/JobSystem.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A graph of functions ("nodes") with dependencies between them, that is declared once and then
+    ///     run any number of times on a JobSystem. Unlike creating Jobs and adding dependencies every frame,
+    ///     running the graph only resets a counter per node. The calling thread and helper Jobs execute nodes as
+    ///     soon as all of their dependencies are done. A helper Job stops when no node is ready, and new helpers
+    ///     are launched when a node releases more than one node, so that no thread of the JobSystem waits idle.
+    ///
+    ///     Node functions are stored in the graph and are called on every run, so they should capture pointers
+    ///     to data that lives as long as the graph, and read the per-frame state from there.
+    ///
+    ///     Example Usage:
+    ///     <code>
+    ///         nes::JobGraph graph;
+    ///         const nes::JobGraph::NodeID physics = graph.AddNode("Physics", [pScene]() { pScene->Update(...); });
+    ///         const nes::JobGraph::NodeID transforms = graph.AddNode("Transforms", [pWorld]() { pWorld->UpdateTransforms(); });
+    ///         const nes::JobGraph::NodeID renderPrep = graph.AddNode("Render Prep", [pRenderer]() { pRenderer->Prepare(); });
+    ///         graph.AddDependency(physics, transforms);
+    ///         graph.AddDependency(transforms, renderPrep);
+    ///         graph.Compile();
+    ///
+    ///         // Every frame:
+    ///         graph.Run(jobSystem);
+    ///     </code>
+    //----------------------------------------------------------------------------------------------------
+    class JobGraph
+    {
+    public:
+        using NodeID = uint32;
+        static constexpr NodeID kInvalidNodeID = std::numeric_limits<NodeID>::max();
+
+        JobGraph() = default;
+        JobGraph(const JobGraph&) = delete;
+        JobGraph& operator=(const JobGraph&) = delete;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Add a node to the graph. Invalidates a previous Compile().
+        /// @param pName : Name of the node, used for the DOT output. Must outlive the graph.
+        /// @param function : Function that is called every time the graph is run.
+        //----------------------------------------------------------------------------------------------------
+        NodeID                  AddNode(const char* pName, JobSystem::JobFunction&& function);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Make 'node' wait for 'dependency' to be done. Invalidates a previous Compile().
+        //----------------------------------------------------------------------------------------------------
+        void                    AddDependency(const NodeID dependency, const NodeID node);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Prepare the graph for running: build the list of nodes that depend on each node, and check
+        ///     that there are no cycles. Must be called after the last node or dependency is added.
+        /// @returns : False if the dependencies contain a cycle. The graph can't be run in that case.
+        //----------------------------------------------------------------------------------------------------
+        bool                    Compile();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Execute all nodes, respecting their dependencies, and return when all of them are done.
+        ///     The calling thread executes nodes as well. The graph must be compiled, and can only be run by one
+        ///     thread at a time.
+        //----------------------------------------------------------------------------------------------------
+        void                    Run(JobSystem& jobSystem);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Remove all nodes and dependencies.
+        //----------------------------------------------------------------------------------------------------
+        void                    Clear();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true if the graph has been compiled since the last change.
+        //----------------------------------------------------------------------------------------------------
+        bool                    IsCompiled() const          { return m_isCompiled; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of nodes in the graph.
+        //----------------------------------------------------------------------------------------------------
+        uint32                  GetNumNodes() const         { return static_cast<uint32>(m_nodes.size()); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get an upper bound of the number of nodes that can run at the same time: the smallest number
+        ///     of dependency chains that cover all nodes. A run uses at most this many threads. Only valid after Compile().
+        //----------------------------------------------------------------------------------------------------
+        uint32                  GetMaxParallelism() const   { return m_maxParallelism; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the graph in the Graphviz DOT format, e.g. to render with "dot -Tsvg graph.dot".
+        //----------------------------------------------------------------------------------------------------
+        std::string             ToDot() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write the graph to a file in the Graphviz DOT format.
+        /// @returns : False if the file could not be opened.
+        //----------------------------------------------------------------------------------------------------
+        bool                    WriteDotFile(const std::filesystem::path& path) const;
+
+    private:
+        struct Node
+        {
+            const char*         m_pName = nullptr;
+            JobSystem::JobFunction m_function;
+            uint32              m_numDependencies = 0;      /// Number of nodes that must be done before this node can run.
+            uint32              m_firstDependent = 0;       /// Index of the first node that depends on this one, in m_dependents.
+            uint32              m_numDependents = 0;        /// Number of nodes that depend on this one.
+        };
+
+        struct Edge
+        {
+            NodeID              m_dependency;
+            NodeID              m_node;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Try to match 'node' with one of its dependents, so that the dependent continues the chain of
+        ///     'node'. Dependents that are already matched are rematched if possible. Used by Compile().
+        //----------------------------------------------------------------------------------------------------
+        bool                    MatchDependent(const NodeID node, const uint32 visitStamp, std::vector<NodeID>& matchedDependencies, std::vector<uint32>& visitedInMatch) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Execute ready nodes until no node is ready. Called by the calling thread and the helper Jobs
+        ///     of a run.
+        //----------------------------------------------------------------------------------------------------
+        void                    ExecuteNodes();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Launch up to 'count' helper Jobs, as long as fewer than m_maxThreads threads are executing nodes.
+        //----------------------------------------------------------------------------------------------------
+        void                    LaunchHelpers(uint32 count);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Mark a node as ready to be executed.
+        //----------------------------------------------------------------------------------------------------
+        void                    PushReadyNode(const NodeID node);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Take the next ready node. Returns false if no node is ready at the moment.
+        //----------------------------------------------------------------------------------------------------
+        bool                    TryPopReadyNode(NodeID& outNode);
+
+        std::vector<Node>       m_nodes;
+        std::vector<Edge>       m_edges;
+        std::vector<NodeID>     m_dependents;                           /// Nodes that depend on each node, see Node::m_firstDependent.
+        std::vector<NodeID>     m_rootNodes;                            /// Nodes without dependencies, which are ready at the start of a run.
+        uint32                  m_maxParallelism = 0;
+        bool                    m_isCompiled = false;
+
+        // State of the current run:
+        std::vector<std::atomic<uint32>> m_dependencyCounts;            /// Number of dependencies that each node is still waiting for.
+        std::vector<std::atomic<uint32>> m_readyNodes;                  /// Node index + 1 of nodes that are ready, in the order that they became ready. 0 while being written.
+        std::atomic<uint32>     m_readyReadIndex = 0;                   /// Next slot in m_readyNodes to execute.
+        std::atomic<uint32>     m_readyWriteIndex = 0;                  /// Next slot in m_readyNodes to fill.
+        std::atomic<uint32>     m_numNodesLeft = 0;                     /// Number of nodes that haven't finished executing yet.
+        std::atomic<uint32>     m_numActiveThreads = 0;                 /// Number of threads that are executing nodes, including helpers that haven't started yet.
+        uint32                  m_maxThreads = 0;                       /// Maximum number of threads that execute nodes at the same time.
+        JobSystem*              m_pJobSystem = nullptr;
+        JobSystem::Barrier*     m_pBarrier = nullptr;                   /// Barrier that the helper Jobs are added to. Null if the calling thread runs all nodes.
+        std::atomic<bool>       m_isRunning = false;
+    };
+}
@@ -1,6 +1,7 @@
 // JobSystem.h
 #pragma once
 #include <functional>
+#include "Nessie/Core/InlineFunction.h"
 #include "Nessie/Core/StaticArray.h"
 #include "Nessie/Core/Memory/StrongPtr.h"
 #include "Nessie/Debug/Assert.h"
@@ -12,6 +13,18 @@ namespace nes
 
 namespace nes
 {
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Scheduling priority of a Job. Job Systems that support priorities always start the queued
+    ///     Job with the highest priority first. Job Systems that don't support them ignore the priority.
+    //----------------------------------------------------------------------------------------------------
+    enum class EJobPriority : uint8
+    {
+        Critical,       /// Work that the current frame is waiting on, like physics and render preparation.
+        Normal,         /// Default priority.
+        Background,     /// Long running work that no frame is waiting on, like asset decoding.
+        Count,
+    };
+
     //----------------------------------------------------------------------------------------------------
     /// @brief : A Job System facilitates the execution of "Jobs" which are essentially functors. A JobSystem
     ///     is meant to execute Jobs on one or more threads. Jobs can have dependencies so that their order of
@@ -52,7 +65,11 @@ namespace nes
         class Job;
         
     public:
-        using JobFunction = std::function<void()>;
+        /// Maximum size of the captures of a Job's function, in bytes. The function is stored inside the Job, so
+        /// creating a Job never allocates. Larger captures are a compile error: capture a pointer to a struct instead.
+        static constexpr size_t kMaxJobFunctionSize = 64;
+        
+        using JobFunction = InlineFunction<void(), kMaxJobFunctionSize>;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : A Job Handle contains a reference to a job. The job will be deleted as soon as there are
@@ -169,7 +186,7 @@ namespace nes
             static constexpr intptr_t   kBarrierDoneState = ~static_cast<intptr_t>(0);
 
         public:
-            inline Job(const char* pName/*, const Color& color*/, JobSystem* pSystem, const JobFunction& function, const uint32 numDependencies);
+            inline Job(const char* pName/*, const Color& color*/, JobSystem* pSystem, JobFunction&& function, const uint32 numDependencies, const EJobPriority priority);
             
             //----------------------------------------------------------------------------------------------------
             /// @brief : Add a number of dependencies to this Job.
@@ -213,6 +230,14 @@ namespace nes
             //----------------------------------------------------------------------------------------------------
             inline JobSystem*       GetJobSystem() const    { return m_pJobSystem; }
             inline const char*      GetName() const         { return m_name; }
+            inline EJobPriority     GetPriority() const     { return m_priority; }
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Set or get the time that the Job was queued, in nanoseconds. Only used by Job Systems that
+            ///     track how long Jobs wait in their queue.
+            //----------------------------------------------------------------------------------------------------
+            inline void             SetQueueTime(const uint64 timeNs)  { m_queueTime = timeNs; }
+            inline uint64           GetQueueTime() const    { return m_queueTime; }
 
         private:
             //----------------------------------------------------------------------------------------------------
@@ -225,6 +250,8 @@ namespace nes
             JobSystem*              m_pJobSystem = nullptr;   /// The JobSystem that owns this Job.
             JobFunction             m_function = nullptr;     /// The functor to be executed.
             std::atomic<uint32>     m_numDependencies = 0;    /// The number of Jobs that must be executed before this one.
+            uint64                  m_queueTime = 0;          /// Time that the Job was queued, see SetQueueTime().
+            EJobPriority            m_priority = EJobPriority::Normal; /// Priority of the Job in Job Systems that support priorities.
             std::atomic<intptr_t>   m_barrier = 0;            /// Equal to the numerical value of the pointer to the Barrier (can be null), or kBarrierDoneState to denote that the Barrier is done.
         };
 
@@ -241,17 +268,24 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         inline virtual int          GetMaxConcurrency() = 0;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the index of the worker thread of a Job System that is calling this function, or -1 if
+        ///     the calling thread is not a worker thread, e.g. a thread that executes Jobs while waiting on a Barrier.
+        //----------------------------------------------------------------------------------------------------
+        static int                  GetCurrentWorkerIndex()         { return s_currentWorkerIndex; }
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Creates a new Job. The Job will be started immediately (when beginning execution with a JobBarrier)
         ///     if the number of dependencies == 0. Otherwise, it will start when RemoveDependency() causes the
         ///     Job's dependency counter to reach 0.
         ///	@param pName : Name of the Job.
-        ///	@param jobFunction : Function to execute.
+        ///	@param jobFunction : Function to execute. It is moved into the Job, see kMaxJobFunctionSize.
         ///	@param numDependencies : Number of dependencies that this Job is waiting on. Be sure that Jobs that this
         ///     Job depends on removes its dependency!
+        ///	@param priority : Scheduling priority of the Job. Ignored by Job Systems that don't support priorities.
         ///	@returns : Handle to the newly created Job. You can use this to set up dependencies among other Jobs.
         //----------------------------------------------------------------------------------------------------
-        virtual JobHandle           CreateJob(const char* pName/*, const Color& color*/, const JobFunction& jobFunction, const uint32 numDependencies = 0) = 0;
+        virtual JobHandle           CreateJob(const char* pName/*, const Color& color*/, JobFunction&& jobFunction, const uint32 numDependencies = 0, const EJobPriority priority = EJobPriority::Normal) = 0;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Create a Barrier used to wait until a set of Jobs is completed. This must be followed by
@@ -270,6 +304,12 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         virtual void                WaitForJobs(Barrier* pBarrier) = 0;
 
+    protected:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Called by the worker threads when they start (with their index) and when they stop (with -1).
+        //----------------------------------------------------------------------------------------------------
+        static void                 SetCurrentWorkerIndex(const int index) { s_currentWorkerIndex = index; }
+
     private:
         //----------------------------------------------------------------------------------------------------
         /// @brief : Add a Job to the Job queue to be executed immediately. 
@@ -285,6 +325,8 @@ namespace nes
         /// @brief : Free the Job object. 
         //----------------------------------------------------------------------------------------------------
         virtual void                FreeJob(Job* pJob) = 0;
+
+        static inline thread_local int s_currentWorkerIndex = -1;   /// See GetCurrentWorkerIndex().
     };
 
     using JobHandle = JobSystem::JobHandle;
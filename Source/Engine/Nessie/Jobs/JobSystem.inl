@@ -32,11 +32,12 @@ namespace nes
             pSystem->QueueJobs(pJobsToQueue, numJobsToQueue);
     }
 
-    inline JobSystem::Job::Job(const char* pName/*, const Color& color*/, JobSystem* pSystem, const JobFunction& function, const uint32 numDependencies)
+    inline JobSystem::Job::Job(const char* pName/*, const Color& color*/, JobSystem* pSystem, JobFunction&& function, const uint32 numDependencies, const EJobPriority priority)
         : m_name(pName)
         , m_pJobSystem(pSystem)
-        , m_function(function)
+        , m_function(std::move(function))
         , m_numDependencies(numDependencies)
+        , m_priority(priority)
         //, m_color(color)
     {
         //
@@ -8,10 +8,10 @@ namespace nes
         m_jobs.Init(maxJobs, maxJobs);
     }
 
-    JobHandle JobSystemSingleThreaded::CreateJob(const char* pName, const JobFunction& jobFunction, const uint32_t numDependencies)
+    JobHandle JobSystemSingleThreaded::CreateJob(const char* pName, JobFunction&& jobFunction, const uint32_t numDependencies, const EJobPriority priority)
     {
         // Construct the new Job
-        const uint32_t index = m_jobs.ConstructObject(pName, this, jobFunction, numDependencies);
+        const uint32_t index = m_jobs.ConstructObject(pName, this, std::move(jobFunction), numDependencies, priority);
         NES_ASSERT(index != JobArray::kInvalidObjectIndex);
         Job* pJob = &m_jobs.Get(index);
 
@@ -33,7 +33,7 @@ namespace nes
     public:
         void                Init(const uint32_t maxJobs);
         virtual int         GetMaxConcurrency() override { return 1; }
-        virtual JobHandle   CreateJob(const char* pName, const JobFunction& jobFunction, const uint32_t numDependencies) override;
+        virtual JobHandle   CreateJob(const char* pName, JobFunction&& jobFunction, const uint32_t numDependencies = 0, const EJobPriority priority = EJobPriority::Normal) override;
         virtual Barrier*    CreateBarrier() override;
         virtual void        DestroyBarrier(Barrier* pBarrier) override;
         virtual void        WaitForJobs(Barrier* pBarrier) override;
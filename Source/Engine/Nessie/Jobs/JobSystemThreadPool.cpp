@@ -1,11 +1,23 @@
 // JobSystemThreadPool.cpp
 #include "Nessie/Jobs/JobSystemThreadPool.h"
+#include <algorithm>
+#include "Nessie/Core/Thread/Atomics.h"
 
 namespace nes
 {
-    JobSystemThreadPool::JobSystemThreadPool(const uint32_t maxJobs, const uint32_t maxBarriers, const int numThreads)
+    static_assert(static_cast<uint32>(EJobPriority::Critical) == 0, "Priorities must be ordered from highest to lowest, see TakeNextJob()!");
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the current time for measuring how long Jobs wait in the queue, in nanoseconds.
+    //----------------------------------------------------------------------------------------------------
+    static uint64 GetQueueTimeNs()
+    {
+        return static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    JobSystemThreadPool::JobSystemThreadPool(const uint32_t maxJobs, const uint32_t maxBarriers, const int numThreads, const int numCriticalThreads)
     {
-        Init(maxJobs, maxBarriers, numThreads);
+        Init(maxJobs, maxBarriers, numThreads, numCriticalThreads);
     }
 
     JobSystemThreadPool::~JobSystemThreadPool()
@@ -13,30 +25,33 @@ namespace nes
         StopThreads();
     }
 
-    void JobSystemThreadPool::Init(const uint32_t maxJobs, const uint32_t maxBarriers, const int numThreads)
+    void JobSystemThreadPool::Init(const uint32_t maxJobs, const uint32_t maxBarriers, const int numThreads, const int numCriticalThreads)
     {
         JobSystemWithBarrier::Init(maxBarriers);
 
         // Init the Jobs free list.
         m_jobs.Init(maxJobs, maxJobs);
 
-        // Init the Queue
-        for (auto& job : m_jobQueue)
+        // Init the Queues
+        for (JobQueue& queue : m_queues)
         {
-            job = nullptr;
+            for (auto& job : queue.m_jobs)
+            {
+                job = nullptr;
+            }
         }
 
         // Start up the worker threads.
-        StartThreads(numThreads);
+        StartThreads(numThreads, numCriticalThreads);
     }
 
-    JobHandle JobSystemThreadPool::CreateJob(const char* pName, const JobFunction& jobFunction, const uint32_t numDependencies)
+    JobHandle JobSystemThreadPool::CreateJob(const char* pName, JobFunction&& jobFunction, const uint32_t numDependencies, const EJobPriority priority)
     {
         uint32_t index;
         // Loop until we have an available Job.
         for (;;)
         {
-            index = m_jobs.ConstructObject(pName, this, jobFunction, numDependencies);
+            index = m_jobs.ConstructObject(pName, this, std::move(jobFunction), numDependencies, priority);
             if (index != AvailableJobs::kInvalidObjectIndex)
                 break;
 
@@ -62,7 +77,7 @@ namespace nes
         
         // Queue the Job then wake up the thread.
         QueueJobInternal(pJob);
-        m_semaphore.Release();
+        WakeThreads(1, pJob->GetPriority() == EJobPriority::Critical? 1 : 0);
     }
 
     void JobSystemThreadPool::QueueJobs(Job** pJobs, const uint32_t numHandles)
@@ -72,13 +87,42 @@ namespace nes
 
         NES_ASSERT(pJobs != nullptr && numHandles > 0);
 
+        uint32 numCriticalJobs = 0;
         for (uint32_t i = 0; i < numHandles; ++i)
         {
             QueueJobInternal(pJobs[i]);
+            if (pJobs[i]->GetPriority() == EJobPriority::Critical)
+                ++numCriticalJobs;
         }
 
         // Wake up threads.
-        m_semaphore.Release(std::min(numHandles, static_cast<uint32_t>(m_threads.size())));
+        WakeThreads(numHandles, numCriticalJobs);
+    }
+
+    JobSystemThreadPool::PriorityStats JobSystemThreadPool::GetPriorityStats(const EJobPriority priority) const
+    {
+        NES_ASSERT(priority < EJobPriority::Count);
+        const PriorityCounters& counters = m_counters[static_cast<uint32>(priority)];
+
+        PriorityStats stats;
+        stats.m_queueDepth = counters.m_queueDepth.load(std::memory_order_relaxed);
+        stats.m_maxQueueDepth = counters.m_maxQueueDepth.load(std::memory_order_relaxed);
+        stats.m_numJobsStarted = counters.m_numJobsStarted.load(std::memory_order_relaxed);
+        stats.m_totalWaitTime = counters.m_totalWaitTime.load(std::memory_order_relaxed);
+        stats.m_maxWaitTime = counters.m_maxWaitTime.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void JobSystemThreadPool::ResetPriorityStats()
+    {
+        // The queue depth is the current state, so only the values that accumulate are reset.
+        for (PriorityCounters& counters : m_counters)
+        {
+            counters.m_maxQueueDepth.store(counters.m_queueDepth.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            counters.m_numJobsStarted.store(0, std::memory_order_relaxed);
+            counters.m_totalWaitTime.store(0, std::memory_order_relaxed);
+            counters.m_maxWaitTime.store(0, std::memory_order_relaxed);
+        }
     }
 
     void JobSystemThreadPool::FreeJob(Job* pJob)
@@ -91,26 +135,39 @@ namespace nes
         // Add a reference to the Job because we're adding it to the queue.
         pJob->AddRef();
 
+        const uint32 priority = static_cast<uint32>(pJob->GetPriority());
+        NES_ASSERT(priority < kNumPriorities);
+        JobQueue& queue = m_queues[priority];
+
+        // Store the time before the Job becomes visible to the threads. 0 means that the wait time is not measured.
+        pJob->SetQueueTime(m_waitTimeStatsEnabled.load(std::memory_order_relaxed)? GetQueueTimeNs() : 0);
+
+        // Count the Job before it becomes visible as well, so that taking it can't make the depth negative.
+        PriorityCounters& counters = m_counters[priority];
+        const uint32 queueDepth = counters.m_queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+        AtomicMax(counters.m_maxQueueDepth, queueDepth, std::memory_order_relaxed);
+
         // Need to read head first because otherwise the tail can already have passed the head.
         // We read the head outside the loop since it involves iterating over all threads, and we only need
         // to update it if there's not enough space.
-        uint32_t head = GetHead();
+        uint32_t head = GetHead(priority);
 
         for (;;)
         {
             // Check if there is space in the queue.
-            uint32_t oldValue = m_queueTail;
+            uint32_t oldValue = queue.m_tail;
             if (oldValue - head >= kQueueLength)
             {
                 // We calculated the head outside the loop, update the head and tail to prevent
                 // it from passing the head.
-                head = GetHead();
-                oldValue = m_queueTail;
+                head = GetHead(priority);
+                oldValue = queue.m_tail;
                 if (oldValue - head >= kQueueLength)
                 {
-                    // Wake up all threads in order to ensure that they can clear any nullptr jobs they
-                    // may not have processed yet.
-                    m_semaphore.Release(static_cast<uint32_t>(m_threads.size()));
+                    // Wake up all threads that serve this queue in order to ensure that they can clear any nullptr jobs
+                    // they may not have processed yet.
+                    const uint32 numThreads = static_cast<uint32>(m_threads.size());
+                    WakeThreads(numThreads, priority == static_cast<uint32>(EJobPriority::Critical)? numThreads : 0);
 
                     // Sleep a little to wait for the threads to update their head pointer.
                     std::this_thread::sleep_for(std::chrono::microseconds(100));
@@ -120,11 +177,11 @@ namespace nes
 
             // Try to claim a job slot:
             Job* pExpected = nullptr;
-            const bool success = m_jobQueue[oldValue & (kQueueLength - 1)].compare_exchange_strong(pExpected, pJob);
+            const bool success = queue.m_jobs[oldValue & (kQueueLength - 1)].compare_exchange_strong(pExpected, pJob);
 
             // Regardless of who got there first to claim the slot, update the tail. If the successful thread was
             // beaten to the punch, we still want to be able to continue.
-            m_queueTail.compare_exchange_strong(oldValue, oldValue + 1);
+            queue.m_tail.compare_exchange_strong(oldValue, oldValue + 1);
 
             // If we successfully claimed the slot in the queue, we're done.
             if (success)
@@ -132,7 +189,67 @@ namespace nes
         }
     }
 
-    void JobSystemThreadPool::StartThreads(int numThreads)
+    void JobSystemThreadPool::WakeThreads(const uint32 numJobs, const uint32 numCriticalJobs)
+    {
+        const uint32 numCriticalThreads = static_cast<uint32>(m_numCriticalThreads);
+        const uint32 numSharedThreads = static_cast<uint32>(m_threads.size()) - numCriticalThreads;
+
+        // Critical Jobs wake the reserved threads, as well as the other threads, because the reserved threads
+        // may be busy with other critical Jobs. Whoever takes a Job first executes it.
+        const uint32 numCriticalToWake = std::min(numCriticalJobs, numCriticalThreads);
+        if (numCriticalToWake > 0)
+            m_criticalSemaphore.Release(numCriticalToWake);
+
+        const uint32 numSharedToWake = std::min(numJobs, numSharedThreads);
+        if (numSharedToWake > 0)
+            m_semaphore.Release(numSharedToWake);
+    }
+
+    JobSystem::Job* JobSystemThreadPool::TakeNextJob(const int threadIndex)
+    {
+        // Always start looking at the highest priority. Because a thread takes a single Job at a time, a
+        // background Job never delays a critical Job that was queued before it finished.
+        const uint32 numPriorities = IsCriticalThread(threadIndex)? 1 : kNumPriorities;
+        for (uint32 priority = 0; priority < numPriorities; ++priority)
+        {
+            JobQueue& queue = m_queues[priority];
+            std::atomic<uint32>& head = GetThreadHead(threadIndex, priority);
+
+            while (head != queue.m_tail)
+            {
+                // Attempt to claim this Job for this Thread.
+                std::atomic<Job*>& job = queue.m_jobs[head & (kQueueLength - 1)];
+                Job* pJob = job.load() != nullptr? job.exchange(nullptr) : nullptr;
+                ++head;
+
+                if (pJob == nullptr)
+                    continue;
+
+                PriorityCounters& counters = m_counters[priority];
+                counters.m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+
+                // Jobs that a thread waiting on a Barrier already executed are only removed from the queue.
+                if (pJob->CanBeExecuted())
+                {
+                    counters.m_numJobsStarted.fetch_add(1, std::memory_order_relaxed);
+
+                    const uint64 queueTime = pJob->GetQueueTime();
+                    if (queueTime != 0)
+                    {
+                        const uint64 waitTime = GetQueueTimeNs() - queueTime;
+                        counters.m_totalWaitTime.fetch_add(waitTime, std::memory_order_relaxed);
+                        AtomicMax(counters.m_maxWaitTime, waitTime, std::memory_order_relaxed);
+                    }
+                }
+
+                return pJob;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void JobSystemThreadPool::StartThreads(int numThreads, const int numCriticalThreads)
     {
         // Assuming Thread support.
         // If less than zero, assume that we want all available - 1 (subtract 1 for main thread).
@@ -143,12 +260,17 @@ namespace nes
         if (numThreads == 0)
             return;
 
+        // At least one thread must execute the Jobs of the other priorities.
+        NES_ASSERT(numCriticalThreads >= 0 && numCriticalThreads < numThreads, "At least one thread must execute non-critical Jobs!");
+        m_numCriticalThreads = std::clamp(numCriticalThreads, 0, numThreads - 1);
+
         // Don't quit the threads.
         m_quit = false;
 
-        // Allocate the head for each thread.
-        m_queueHeads = static_cast<std::atomic<uint32_t>*>(NES_ALLOC(sizeof(std::atomic<uint32_t>) * numThreads));
-        for (int i = 0; i < numThreads; ++i)
+        // Allocate the heads for each thread.
+        const int numHeads = numThreads * static_cast<int>(kNumPriorities);
+        m_queueHeads = static_cast<std::atomic<uint32_t>*>(NES_ALLOC(sizeof(std::atomic<uint32_t>) * numHeads));
+        for (int i = 0; i < numHeads; ++i)
         {
             m_queueHeads[i] = 0;
         }
@@ -169,7 +291,9 @@ namespace nes
 
         // Signal threads that we want to quit.
         m_quit = true;
-        m_semaphore.Release(static_cast<unsigned>(m_threads.size()));
+        if (m_numCriticalThreads > 0)
+            m_criticalSemaphore.Release(static_cast<unsigned>(m_numCriticalThreads));
+        m_semaphore.Release(static_cast<unsigned>(m_threads.size()) - static_cast<unsigned>(m_numCriticalThreads));
 
         // Wait for all threads to finish
         for (auto& thread : m_threads)
@@ -180,29 +304,39 @@ namespace nes
         m_threads.clear();
 
         // Ensure that there are no lingering Jobs
-        for (uint32_t head = 0; head != m_queueTail; ++head)
+        for (JobQueue& queue : m_queues)
         {
-            Job* pJob = m_jobQueue[head & (kQueueLength - 1)].exchange(nullptr);
-            if (pJob != nullptr)
+            for (uint32_t head = 0; head != queue.m_tail; ++head)
             {
-                pJob->Execute();
-                pJob->RemoveRef();
+                Job* pJob = queue.m_jobs[head & (kQueueLength - 1)].exchange(nullptr);
+                if (pJob != nullptr)
+                {
+                    pJob->Execute();
+                    pJob->RemoveRef();
+                }
             }
+            queue.m_tail = 0;
+        }
+
+        for (PriorityCounters& counters : m_counters)
+        {
+            counters.m_queueDepth = 0;
         }
 
         // Destroy heads and reset.
         NES_FREE(m_queueHeads);
         m_queueHeads = nullptr;
-        m_queueTail = 0; 
+        m_numCriticalThreads = 0;
     }
 
-    uint32_t JobSystemThreadPool::GetHead() const
+    uint32_t JobSystemThreadPool::GetHead(const uint32 priority) const
     {
-        // Find the minimal value across all threads.
-        uint32_t head = m_queueTail;
-        for (size_t i = 0; i < m_threads.size(); ++i)
+        // Find the minimal value across all threads that take Jobs from this queue.
+        const int firstThread = priority == static_cast<uint32>(EJobPriority::Critical)? 0 : m_numCriticalThreads;
+        uint32_t head = m_queues[priority].m_tail;
+        for (int i = firstThread; i < static_cast<int>(m_threads.size()); ++i)
         {
-            head = std::min(head, m_queueHeads[i].load());
+            head = std::min(head, GetThreadHead(i, priority).load());
         }
         return head;
     }
@@ -211,38 +345,30 @@ namespace nes
     {
         // [TODO]: Name the thread:
 
+        SetCurrentWorkerIndex(threadIndex);
+
         // Call initialization function:
         m_threadInitFunction(threadIndex);
 
-        // Get the head index associated with this thread.
-        std::atomic<uint32_t>& head = m_queueHeads[threadIndex]; 
+        // Reserved threads are only woken up for critical Jobs.
+        Semaphore& semaphore = IsCriticalThread(threadIndex)? m_criticalSemaphore : m_semaphore;
         
         while (!m_quit)
         {
             // Wait for jobs
-            m_semaphore.Acquire();
+            semaphore.Acquire();
 
+            // [TODO]: Scoped Profile for Job Execution.
+            while (Job* pJob = TakeNextJob(threadIndex))
             {
-                // [TODO]: Scoped Profile for Job Execution.
-                while (head != m_queueTail)
-                {
-                    std::atomic<Job*>& job = m_jobQueue[head & (kQueueLength - 1)];
-                    if (job.load() != nullptr)
-                    {
-                        // Attempt to claim this Job for this Thread.
-                        Job* pJob = job.exchange(nullptr);
-                        if (pJob != nullptr)
-                        {
-                            pJob->Execute();
-                            pJob->RemoveRef();
-                        }
-                    }
-                    ++head;
-                }
+                pJob->Execute();
+                pJob->RemoveRef();
             }
         }
 
         // Call the exit function:
         m_threadExitFunction(threadIndex);
+
+        SetCurrentWorkerIndex(-1);
     }
 }
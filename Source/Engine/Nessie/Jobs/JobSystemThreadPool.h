@@ -5,19 +5,43 @@
 
 namespace nes
 {
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Job System that executes Jobs on a fixed set of worker threads. Each EJobPriority has its own
+    ///     queue. Workers take one Job at a time, from the highest priority queue that has Jobs, so a queued
+    ///     critical Job never waits for more than the Jobs that are already running. Optionally, a number of
+    ///     workers can be reserved for critical Jobs, so that they are never occupied by long background Jobs.
+    //----------------------------------------------------------------------------------------------------
     class JobSystemThreadPool final : public JobSystemWithBarrier
     {
     public:
         /// Function signature for both Initialization and Termination functors of the Worker Thread.
         using ThreadInitExitFunction = std::function<void(const int threadIndex)>;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Statistics of the queue of a single priority.
+        //----------------------------------------------------------------------------------------------------
+        struct PriorityStats
+        {
+            uint32          m_queueDepth = 0;           /// Number of Jobs in the queue at the moment.
+            uint32          m_maxQueueDepth = 0;        /// Highest number of Jobs in the queue since the last reset.
+            uint64          m_numJobsStarted = 0;       /// Number of Jobs that workers took from the queue since the last reset.
+            uint64          m_totalWaitTime = 0;        /// Total time that these Jobs waited in the queue, in nanoseconds. Only tracked while enabled.
+            uint64          m_maxWaitTime = 0;          /// Longest time that one of these Jobs waited in the queue, in nanoseconds. Only tracked while enabled.
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Get the average time that a Job waited in the queue, in milliseconds.
+            //----------------------------------------------------------------------------------------------------
+            float           GetAverageWaitTimeMs() const { return m_numJobsStarted > 0? static_cast<float>(static_cast<double>(m_totalWaitTime) / static_cast<double>(m_numJobsStarted) * 1.0e-6) : 0.f; }
+        };
+
     private:
         using ThreadArray       = std::vector<std::thread>;
         using AvailableJobs     = FixedSizeFreeList<Job>;
         static constexpr uint32 kQueueLength = 1024;
+        static constexpr uint32 kNumPriorities = static_cast<uint32>(EJobPriority::Count);
         
     public:
-                            JobSystemThreadPool(const uint32 maxJobs, const uint32_t maxBarriers, const int numThreads = -1);
+                            JobSystemThreadPool(const uint32 maxJobs, const uint32_t maxBarriers, const int numThreads = -1, const int numCriticalThreads = 0);
         virtual             ~JobSystemThreadPool() override;
 
         //----------------------------------------------------------------------------------------------------
@@ -39,11 +63,31 @@ namespace nes
         ///	@param numThreads : Number of threads to start (the number of concurrent jobs is 1 more because the
         ///     main thread will also run jobs while waiting for a barrier to complete. Use -1 to auto-detect
         ///     the amount of CPUs.
+        ///	@param numCriticalThreads : Number of the threads that only execute EJobPriority::Critical Jobs, so that
+        ///     critical Jobs can start even when all other threads are busy. Must be less than the number of threads.
         //----------------------------------------------------------------------------------------------------
-        void                Init(const uint32_t maxJobs, const uint32_t maxBarriers, const int numThreads = -1);
+        void                Init(const uint32_t maxJobs, const uint32_t maxBarriers, const int numThreads = -1, const int numCriticalThreads = 0);
         
         virtual int         GetMaxConcurrency() override { return static_cast<int>(m_threads.size()) + 1; }
-        virtual JobHandle   CreateJob(const char* pName, const JobFunction& jobFunction, const uint32_t numDependencies) override;
+        virtual JobHandle   CreateJob(const char* pName, JobFunction&& jobFunction, const uint32_t numDependencies = 0, const EJobPriority priority = EJobPriority::Normal) override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the statistics of the queue of a priority. The values are read one by one while the
+        ///     workers keep running, so they are not an exact snapshot.
+        //----------------------------------------------------------------------------------------------------
+        PriorityStats       GetPriorityStats(const EJobPriority priority) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Reset the maximum queue depths, Job counts and wait times of all priorities.
+        //----------------------------------------------------------------------------------------------------
+        void                ResetPriorityStats();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Enable or disable measuring how long Jobs wait in the queue. This reads the clock twice per
+        ///     Job, so it is disabled by default. The queue depths and Job counts are always tracked.
+        //----------------------------------------------------------------------------------------------------
+        void                SetWaitTimeStatsEnabled(const bool enabled) { m_waitTimeStatsEnabled.store(enabled, std::memory_order_relaxed); }
+        bool                IsWaitTimeStatsEnabled() const              { return m_waitTimeStatsEnabled.load(std::memory_order_relaxed); }
 
     private:
         virtual void        QueueJob(Job* pJob) override;
@@ -56,9 +100,9 @@ namespace nes
         void                QueueJobInternal(Job* pJob);
         
         //----------------------------------------------------------------------------------------------------
-        /// @brief : Start the Worker Threads. 
+        /// @brief : Start the Worker Threads. The first numCriticalThreads threads only execute critical Jobs.
         //----------------------------------------------------------------------------------------------------
-        void                StartThreads(int numThreads);
+        void                StartThreads(int numThreads, const int numCriticalThreads);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Stop the Worker Threads. 
@@ -66,9 +110,31 @@ namespace nes
         void                StopThreads();
 
         //----------------------------------------------------------------------------------------------------
-        /// @brief : Get the Head of the Thread that has processed the least amount of jobs. 
+        /// @brief : Wake up the threads that can execute the given number of queued Jobs.
         //----------------------------------------------------------------------------------------------------
-        inline uint32_t     GetHead() const;
+        void                WakeThreads(const uint32 numJobs, const uint32 numCriticalJobs);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Take the next Job from the highest priority queue that has Jobs. Reserved threads only look
+        ///     at the critical queue. Returns nullptr if all queues that the thread serves are empty.
+        //----------------------------------------------------------------------------------------------------
+        Job*                TakeNextJob(const int threadIndex);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the Head of the Thread that has processed the least amount of jobs of a priority. Only
+        ///     threads that serve the priority are considered.
+        //----------------------------------------------------------------------------------------------------
+        inline uint32_t     GetHead(const uint32 priority) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the head of a thread in the queue of a priority.
+        //----------------------------------------------------------------------------------------------------
+        std::atomic<uint32>& GetThreadHead(const int threadIndex, const uint32 priority) const { return m_queueHeads[threadIndex * kNumPriorities + priority]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true if the thread only executes critical Jobs.
+        //----------------------------------------------------------------------------------------------------
+        bool                IsCriticalThread(const int threadIndex) const { return threadIndex < m_numCriticalThreads; }
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Entry point for a worker thread. 
@@ -76,12 +142,32 @@ namespace nes
         void                ThreadMain(int threadIndex);
 
     private:
+        /// Ring buffer of the Jobs of a single priority.
+        struct JobQueue
+        {
+            std::atomic<Job*>   m_jobs[kQueueLength];
+            alignas (NES_CACHE_LINE_SIZE) std::atomic<uint32> m_tail = 0;
+        };
+
+        /// Counters behind PriorityStats. Each priority has its own cache line, as they are updated for every Job.
+        struct alignas (NES_CACHE_LINE_SIZE) PriorityCounters
+        {
+            std::atomic<uint32> m_queueDepth = 0;
+            std::atomic<uint32> m_maxQueueDepth = 0;
+            std::atomic<uint64> m_numJobsStarted = 0;
+            std::atomic<uint64> m_totalWaitTime = 0;
+            std::atomic<uint64> m_maxWaitTime = 0;
+        };
+
         AvailableJobs           m_jobs;
         ThreadArray             m_threads;
-        std::atomic<Job*>       m_jobQueue[kQueueLength];
-        std::atomic<uint32>*    m_queueHeads = nullptr;
-        std::atomic<uint32>     m_queueTail;
-        Semaphore               m_semaphore;
+        JobQueue                m_queues[kNumPriorities];
+        PriorityCounters        m_counters[kNumPriorities];
+        std::atomic<uint32>*    m_queueHeads = nullptr;     /// Head of each thread in each queue, see GetThreadHead().
+        int                     m_numCriticalThreads = 0;   /// The first m_numCriticalThreads threads only execute critical Jobs.
+        Semaphore               m_semaphore;                /// Wakes the threads that execute Jobs of all priorities.
+        Semaphore               m_criticalSemaphore;        /// Wakes the threads that only execute critical Jobs.
+        std::atomic_bool        m_waitTimeStatsEnabled = false;
         std::atomic_bool        m_quit = false;
         ThreadInitExitFunction  m_threadInitFunction = [](int){ };
         ThreadInitExitFunction  m_threadExitFunction = [](int){ };
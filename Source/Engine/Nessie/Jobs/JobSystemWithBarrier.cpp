@@ -117,7 +117,7 @@ namespace nes
                     {
                         std::atomic<Job*>& pJob = m_jobs[i & (kMaxJobs - 1)];
                         Job* pPtr = pJob.load();
-                        if (pPtr != nullptr || pPtr->CanBeExecuted())
+                        if (pPtr != nullptr && pPtr->CanBeExecuted())
                         {
                             // This will only execute the job if it has not already executed
                             pPtr->Execute();
@@ -0,0 +1,304 @@
+// JobSystemWorkStealing.cpp
+#include "Nessie/Jobs/JobSystemWorkStealing.h"
+
+namespace nes
+{
+    /// The Job System that the calling thread is a worker of. The index of the worker is GetCurrentWorkerIndex().
+    static thread_local const JobSystemWorkStealing* s_pWorkerJobSystem = nullptr;
+
+    JobSystemWorkStealing::JobSystemWorkStealing(const uint32 maxJobs, const uint32 maxBarriers, const int numThreads)
+    {
+        Init(maxJobs, maxBarriers, numThreads);
+    }
+
+    JobSystemWorkStealing::~JobSystemWorkStealing()
+    {
+        StopThreads();
+    }
+
+    void JobSystemWorkStealing::Init(const uint32 maxJobs, const uint32 maxBarriers, const int numThreads)
+    {
+        JobSystemWithBarrier::Init(maxBarriers);
+
+        // Init the Jobs free list.
+        m_jobs.Init(maxJobs, maxJobs);
+
+        // Start up the worker threads.
+        StartThreads(numThreads);
+    }
+
+    JobHandle JobSystemWorkStealing::CreateJob(const char* pName, JobFunction&& jobFunction, const uint32 numDependencies, const EJobPriority priority)
+    {
+        uint32 index;
+        // Loop until we have an available Job.
+        for (;;)
+        {
+            index = m_jobs.ConstructObject(pName, this, std::move(jobFunction), numDependencies, priority);
+            if (index != AvailableJobs::kInvalidObjectIndex)
+                break;
+
+            NES_ASSERT(false, "No jobs available!");
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        Job* pJob = &m_jobs.Get(index);
+
+        // Construct the handle to keep a reference.
+        JobHandle handle(pJob);
+
+        // If there are no dependencies, queue the job now.
+        if (numDependencies == 0)
+            QueueJob(pJob);
+
+        return handle;
+    }
+
+    void JobSystemWorkStealing::QueueJob(Job* pJob)
+    {
+        if (m_threads.empty())
+            return;
+
+        QueueJobInternal(pJob);
+        WakeWorkers(1);
+    }
+
+    void JobSystemWorkStealing::QueueJobs(Job** pJobs, const uint32 numHandles)
+    {
+        if (m_threads.empty())
+            return;
+
+        NES_ASSERT(pJobs != nullptr && numHandles > 0);
+
+        for (uint32 i = 0; i < numHandles; ++i)
+        {
+            QueueJobInternal(pJobs[i]);
+        }
+
+        WakeWorkers(numHandles);
+    }
+
+    void JobSystemWorkStealing::FreeJob(Job* pJob)
+    {
+        m_jobs.DestructObject(pJob);
+    }
+
+    void JobSystemWorkStealing::QueueJobInternal(Job* pJob)
+    {
+        // Add a reference to the Job because we're adding it to a queue.
+        pJob->AddRef();
+
+        // Workers push to their own deque. Nobody else can push to it, so other threads use the shared queue.
+        if (s_pWorkerJobSystem == this)
+        {
+            m_workerDeques[GetCurrentWorkerIndex()].Push(pJob);
+        }
+        else
+        {
+            m_sharedQueue.EnqueueLocked(pJob);
+            m_numSharedJobs.fetch_add(1, std::memory_order_seq_cst);
+        }
+    }
+
+    void JobSystemWorkStealing::WakeWorkers(const uint32 count)
+    {
+        // Claim up to 'count' sleeping workers, so that concurrent calls don't release the semaphore for the same worker.
+        // Note: The Job was pushed before this load, and a worker rechecks the queues after announcing that it goes to sleep.
+        // The deque push is not a seq_cst store, so the fence orders it before the load. Together with the fence after
+        // the announcement in ThreadMain(), either we see the worker as asleep, or the worker sees the Job.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32 numSleeping = m_numSleepingWorkers.load(std::memory_order_seq_cst);
+        uint32 numToWake;
+        do
+        {
+            numToWake = std::min(count, numSleeping);
+            if (numToWake == 0)
+                return;
+        } while (!m_numSleepingWorkers.compare_exchange_weak(numSleeping, numSleeping - numToWake, std::memory_order_seq_cst));
+
+        m_semaphore.Release(numToWake);
+    }
+
+    JobSystem::Job* JobSystemWorkStealing::FindJob(const int threadIndex, uint32& randomState)
+    {
+        // Most recently queued Jobs of our own first, their data is most likely still in the cache.
+        if (Job* pJob = m_workerDeques[threadIndex].Pop())
+            return pJob;
+
+        // Then Jobs queued from outside the workers.
+        if (m_numSharedJobs.load(std::memory_order_relaxed) > 0)
+        {
+            Job* pJob;
+            if (m_sharedQueue.DequeueLocked(pJob))
+            {
+                m_numSharedJobs.fetch_sub(1, std::memory_order_relaxed);
+                return pJob;
+            }
+        }
+
+        // Then steal from the other workers, starting at a random one.
+        const int numThreads = m_numWorkers;
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        const int start = static_cast<int>(randomState % static_cast<uint32>(numThreads));
+        for (int i = 0; i < numThreads; ++i)
+        {
+            const int victim = (start + i) % numThreads;
+            if (victim == threadIndex)
+                continue;
+
+            if (Job* pJob = m_workerDeques[victim].Steal())
+                return pJob;
+        }
+
+        return nullptr;
+    }
+
+    bool JobSystemWorkStealing::HasQueuedJobs() const
+    {
+        if (m_numSharedJobs.load(std::memory_order_seq_cst) > 0)
+            return true;
+
+        for (int i = 0; i < m_numWorkers; ++i)
+        {
+            if (!m_workerDeques[i].IsEmpty())
+                return true;
+        }
+
+        return false;
+    }
+
+    void JobSystemWorkStealing::StartThreads(int numThreads)
+    {
+        // Assuming Thread support.
+        // If less than zero, assume that we want all available - 1 (subtract 1 for main thread).
+        if (numThreads < 0)
+            numThreads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+
+        // If no threads requested, return
+        if (numThreads == 0)
+            return;
+
+        // Don't quit the threads.
+        m_quit = false;
+
+        // Allocate a deque for each thread. The number of workers is set before starting them, because
+        // m_threads is still being filled while the first workers are already looking for Jobs.
+        NES_ASSERT(m_workerDeques == nullptr);
+        m_workerDeques = NES_NEW_ARRAY(JobDeque, numThreads);
+        m_numWorkers = numThreads;
+
+        // Start the threads:
+        NES_ASSERT(m_threads.empty());
+        m_threads.reserve(numThreads);
+        for (int i = 0; i < numThreads; ++i)
+        {
+            m_threads.emplace_back([this, i]() { ThreadMain(i); } );
+        }
+    }
+
+    void JobSystemWorkStealing::StopThreads()
+    {
+        if (m_threads.empty())
+            return;
+
+        // Signal threads that we want to quit, and wake all of them.
+        m_quit = true;
+        m_semaphore.Release(static_cast<unsigned>(m_threads.size()));
+
+        // Wait for all threads to finish
+        for (auto& thread : m_threads)
+        {
+            if (thread.joinable())
+                thread.join();
+        }
+
+        // Ensure that there are no lingering Jobs. No worker is running anymore, so we can steal from all deques.
+        for (int i = 0; i < m_numWorkers; ++i)
+        {
+            while (Job* pJob = m_workerDeques[i].Steal())
+            {
+                pJob->Execute();
+                pJob->RemoveRef();
+            }
+        }
+
+        Job* pJob;
+        while (m_sharedQueue.DequeueLocked(pJob))
+        {
+            pJob->Execute();
+            pJob->RemoveRef();
+        }
+        m_numSharedJobs = 0;
+        m_numSleepingWorkers = 0;
+
+        m_threads.clear();
+
+        // Destroy the deques.
+        NES_DELETE_ARRAY(m_workerDeques);
+        m_workerDeques = nullptr;
+        m_numWorkers = 0;
+    }
+
+    void JobSystemWorkStealing::ThreadMain(const int threadIndex)
+    {
+        // [TODO]: Name the thread:
+
+        // Register this thread as a worker, so that Jobs queued from this thread go to its own deque.
+        s_pWorkerJobSystem = this;
+        SetCurrentWorkerIndex(threadIndex);
+
+        // Seed for choosing which worker to steal from. Must not be 0 for the xorshift generator.
+        uint32 randomState = 0x9e3779b9u * static_cast<uint32>(threadIndex + 1);
+
+        // Call initialization function:
+        m_threadInitFunction(threadIndex);
+
+        int numSpins = 0;
+        while (!m_quit)
+        {
+            if (Job* pJob = FindJob(threadIndex, randomState))
+            {
+                // [TODO]: Scoped Profile for Job Execution.
+                pJob->Execute();
+                pJob->RemoveRef();
+                numSpins = 0;
+                continue;
+            }
+
+            // Keep looking for a while before going to sleep, as new Jobs are often queued shortly after.
+            if (++numSpins < kNumSpinsBeforeSleep)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            numSpins = 0;
+
+            // Announce that we are going to sleep, then check again for Jobs that were queued in the meantime.
+            // The fence pairs with the one in WakeWorkers().
+            m_numSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (HasQueuedJobs() || m_quit)
+            {
+                // Cancel going to sleep. If a queuing thread already claimed us, consume its wake-up.
+                uint32 numSleeping = m_numSleepingWorkers.load(std::memory_order_seq_cst);
+                while (numSleeping > 0 && !m_numSleepingWorkers.compare_exchange_weak(numSleeping, numSleeping - 1, std::memory_order_seq_cst))
+                {
+                    //
+                }
+
+                if (numSleeping == 0)
+                    m_semaphore.Acquire();
+
+                continue;
+            }
+
+            m_semaphore.Acquire();
+        }
+
+        // Call the exit function:
+        m_threadExitFunction(threadIndex);
+
+        s_pWorkerJobSystem = nullptr;
+        SetCurrentWorkerIndex(-1);
+    }
+}
@@ -0,0 +1,117 @@
+// JobSystemWorkStealing.h
+#pragma once
+#include "JobSystemWithBarrier.h"
+#include "Nessie/Core/Memory/FixedSizedFreeList.h"
+#include "Nessie/Core/Thread/Containers/ThreadSafeQueue.h"
+#include "Nessie/Core/Thread/Containers/WorkStealingDeque.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : JobSystem that gives each worker thread its own lock-free deque of Jobs. Jobs that are queued
+    ///     from a worker thread (e.g. by a Job removing a dependency) are pushed to that worker's deque and
+    ///     are picked up by the same worker first. Idle workers steal from the deques of random other workers.
+    ///     Jobs that are queued from any other thread are placed in a shared queue that all workers check.
+    ///
+    ///     Compared to the JobSystemThreadPool, there is no shared tail that every queue operation has to
+    ///     update, no fixed queue length, and sleeping workers are only woken when there are workers asleep.
+    //----------------------------------------------------------------------------------------------------
+    class JobSystemWorkStealing final : public JobSystemWithBarrier
+    {
+    public:
+        /// Function signature for both Initialization and Termination functors of the Worker Thread.
+        using ThreadInitExitFunction = std::function<void(const int threadIndex)>;
+
+    private:
+        using ThreadArray       = std::vector<std::thread>;
+        using AvailableJobs     = FixedSizeFreeList<Job>;
+        using JobDeque          = WorkStealingDeque<Job>;
+
+        /// Number of times an idle worker looks for work, yielding in between, before going to sleep.
+        static constexpr int    kNumSpinsBeforeSleep = 64;
+
+    public:
+                            JobSystemWorkStealing(const uint32 maxJobs, const uint32 maxBarriers, const int numThreads = -1);
+        virtual             ~JobSystemWorkStealing() override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the initialization function for a Job Thread.
+        /// @note : Must be set before calling Init().
+        //----------------------------------------------------------------------------------------------------
+        void                SetThreadInitFunction(const ThreadInitExitFunction& function) { m_threadInitFunction = function; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the exit function for a Job Thread.
+        /// @note : Must be set before calling Init().
+        //----------------------------------------------------------------------------------------------------
+        void                SetThreadExitFunction(const ThreadInitExitFunction& function) { m_threadExitFunction = function; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Initialize the Job System.
+        ///	@param maxJobs : Maximum number of Jobs that can be allocated at any time.
+        ///	@param maxBarriers : Maximum number of Barriers that can be allocated at any time.
+        ///	@param numThreads : Number of threads to start (the number of concurrent jobs is 1 more because the
+        ///     main thread will also run jobs while waiting for a barrier to complete. Use -1 to auto-detect
+        ///     the amount of CPUs.
+        //----------------------------------------------------------------------------------------------------
+        void                Init(const uint32 maxJobs, const uint32 maxBarriers, const int numThreads = -1);
+
+        virtual int         GetMaxConcurrency() override { return static_cast<int>(m_threads.size()) + 1; }
+        virtual JobHandle   CreateJob(const char* pName, JobFunction&& jobFunction, const uint32 numDependencies = 0, const EJobPriority priority = EJobPriority::Normal) override;
+
+    private:
+        virtual void        QueueJob(Job* pJob) override;
+        virtual void        QueueJobs(Job** pJobs, const uint32 numHandles) override;
+        virtual void        FreeJob(Job* pJob) override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Push a Job to the deque of the calling worker thread, or to the shared queue if the calling
+        ///     thread is not a worker of this Job System.
+        //----------------------------------------------------------------------------------------------------
+        void                QueueJobInternal(Job* pJob);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Wake up to 'count' sleeping workers. Does nothing if no workers are sleeping.
+        //----------------------------------------------------------------------------------------------------
+        void                WakeWorkers(const uint32 count);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the next Job for a worker: first from its own deque, then from the shared queue and
+        ///     finally by stealing from other workers. Returns nullptr if no Job was found.
+        //----------------------------------------------------------------------------------------------------
+        Job*                FindJob(const int threadIndex, uint32& randomState);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true if any deque or the shared queue appears to have Jobs.
+        //----------------------------------------------------------------------------------------------------
+        bool                HasQueuedJobs() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Start the Worker Threads.
+        //----------------------------------------------------------------------------------------------------
+        void                StartThreads(int numThreads);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Stop the Worker Threads, and execute any Jobs that are left in the queues.
+        //----------------------------------------------------------------------------------------------------
+        void                StopThreads();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Entry point for a worker thread.
+        //----------------------------------------------------------------------------------------------------
+        void                ThreadMain(int threadIndex);
+
+    private:
+        AvailableJobs           m_jobs;
+        ThreadArray             m_threads;
+        JobDeque*               m_workerDeques = nullptr;               /// One deque per worker thread.
+        int                     m_numWorkers = 0;                       /// Number of worker threads and deques.
+        ThreadSafeQueue<Job*>   m_sharedQueue;                          /// Jobs queued from threads that are not workers.
+        std::atomic<uint32>     m_numSharedJobs = 0;                    /// Number of Jobs in m_sharedQueue, to avoid locking it when empty.
+        std::atomic<uint32>     m_numSleepingWorkers = 0;               /// Number of workers that are (about to go) asleep and have not been woken yet.
+        Semaphore               m_semaphore;
+        std::atomic_bool        m_quit = false;
+        ThreadInitExitFunction  m_threadInitFunction = [](int){ };
+        ThreadInitExitFunction  m_threadExitFunction = [](int){ };
+    };
+}
@@ -35,13 +35,13 @@ namespace nes
         m_workerThread.WaitUntilDone();
     }
 
-    JobHandle JobSystemWorkerThread::CreateJob(const char* pName, const JobFunction& jobFunction, const uint32_t numDependencies)
+    JobHandle JobSystemWorkerThread::CreateJob(const char* pName, JobFunction&& jobFunction, const uint32_t numDependencies, const EJobPriority priority)
     {
         uint32_t index;
         // Loop until we get a job from the free list.
         while (true)
         {
-            index = m_jobs.ConstructObject(pName, this, jobFunction, numDependencies);
+            index = m_jobs.ConstructObject(pName, this, std::move(jobFunction), numDependencies, priority);
             if (index != JobArray::kInvalidObjectIndex)
                 break;
 
@@ -127,7 +127,7 @@ namespace nes
     {
         switch (instruction)
         {
-            case JobThreadInstruction::Init:            m_threadInitFunction(); break;
+            case JobThreadInstruction::Init:            SetCurrentWorkerIndex(0); m_threadInitFunction(); break;
             case JobThreadInstruction::JobsAvailable:   ThreadProcessJobQueue(); break; 
             case JobThreadInstruction::Terminate:       ThreadTerminate(); return false;
         }
@@ -170,5 +170,6 @@ namespace nes
         m_queueTail = 0;
         
         m_threadExitFunction();
+        SetCurrentWorkerIndex(-1);
     }
 }
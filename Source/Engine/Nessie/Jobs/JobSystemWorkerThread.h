@@ -41,7 +41,7 @@ namespace nes
         /// @brief : The Maximum concurrency is still 1 - the Jobs are just executed on another thread. 
         //----------------------------------------------------------------------------------------------------
         virtual int         GetMaxConcurrency() override { return 1; }
-        virtual JobHandle   CreateJob(const char* pName, const JobFunction& jobFunction, const uint32_t numDependencies) override;
+        virtual JobHandle   CreateJob(const char* pName, JobFunction&& jobFunction, const uint32_t numDependencies = 0, const EJobPriority priority = EJobPriority::Normal) override;
 
     private:
         virtual void        QueueJob(Job* pJob) override;
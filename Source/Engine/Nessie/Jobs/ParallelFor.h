@@ -0,0 +1,102 @@
+// ParallelFor.h
+#pragma once
+#include <atomic>
+#include <vector>
+#include "Nessie/Jobs/JobSystem.h"
+#include "Nessie/Core/Thread/Mutex.h"
+#include "Nessie/Math/Generic.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings for ParallelFor() and ParallelReduce().
+    //----------------------------------------------------------------------------------------------------
+    struct ParallelForSettings
+    {
+        const char*     m_pName = "Parallel For";       /// Name of the Jobs that are created.
+        uint32          m_grainSize = 0;                /// Minimum number of iterations per chunk. 0 chooses a grain size from the size of the range.
+        bool            m_deterministic = false;        /// If true, the range is split into chunks of exactly m_grainSize iterations, and ParallelReduce() combines the
+                                                        /// chunk results in order. The chunks and the result then only depend on the range and the settings, not on
+                                                        /// the number of threads or the timing of the Jobs. If false, chunks shrink as the range runs out, to balance the load.
+    };
+
+    namespace internal
+    {
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Hands out chunks of a range of iterations to the threads of a ParallelFor() or ParallelReduce().
+        //----------------------------------------------------------------------------------------------------
+        class ParallelForRange
+        {
+        public:
+            /// Number of chunks per thread that the automatic grain size aims for, so that a slow chunk can be balanced by the other threads.
+            static constexpr uint32 kAutoChunksPerThread = 4;
+
+            /// Number of chunks that the automatic grain size aims for in deterministic mode, which can't depend on the number of threads.
+            static constexpr uint32 kAutoDeterministicChunks = 64;
+
+            ParallelForRange(const uint32 begin, const uint32 end, const ParallelForSettings& settings, const int maxConcurrency);
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Claim the next chunk of iterations. Can be called from any thread.
+            /// @param outBegin : First iteration of the chunk.
+            /// @param outEnd : One past the last iteration of the chunk.
+            /// @param outChunkIndex : Index of the chunk. Only meaningful in deterministic mode.
+            /// @returns : False if there are no iterations left.
+            //----------------------------------------------------------------------------------------------------
+            bool                Next(uint32& outBegin, uint32& outEnd, uint32& outChunkIndex);
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Get the number of chunks in deterministic mode, or an estimate of the number of chunks otherwise.
+            //----------------------------------------------------------------------------------------------------
+            uint32              GetNumChunks() const        { return m_numChunks; }
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Get the number of Jobs to create to help the calling thread.
+            //----------------------------------------------------------------------------------------------------
+            uint32              GetNumHelperJobs() const    { return math::Min(m_numChunks, m_concurrency) - 1; }
+
+        private:
+            std::atomic<uint64> m_next;                     /// Next iteration to hand out. 64 bit so that claiming past the end can't overflow.
+            uint32              m_begin;
+            uint32              m_end;
+            uint32              m_grainSize;
+            uint32              m_numChunks;
+            uint32              m_concurrency;
+            bool                m_deterministic;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Run 'body' on the calling thread and on up to 'numHelperJobs' Jobs at the same time, and
+        ///     return when all of them are done. 'body' must claim work until there is none left.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Body>
+        void                    RunParallel(JobSystem& jobSystem, const char* pName, const uint32 numHelperJobs, Body& body);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Call 'function' for the iterations [begin, end), split up in chunks that run in parallel on the
+    ///     Job System. The calling thread processes chunks as well and returns when all iterations are done.
+    ///     Because the calling thread can always finish all work by itself, this can be called from inside a Job.
+    ///     If the range fits in a single chunk, or there is no Barrier available, everything runs on the calling thread.
+    /// @param function : Called as function(uint32 chunkBegin, uint32 chunkEnd). Must be safe to call from multiple
+    ///     threads at the same time, for different chunks.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Function>
+    void                        ParallelFor(JobSystem& jobSystem, const uint32 begin, const uint32 end, Function&& function, const ParallelForSettings& settings = {});
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Compute a value for each chunk of the iterations [begin, end) in parallel on the Job System, and
+    ///     combine the chunk values into a single result. Threading works the same as ParallelFor().
+    ///     In deterministic mode the chunk values are stored and combined in chunk order, so a reduction that is
+    ///     not associative (e.g. floating point addition) gives the same result on every run. Otherwise each
+    ///     thread combines its own chunks first, and the per-thread results are combined in the order that the
+    ///     threads finish.
+    /// @param identity : Value that doesn't change the result when combined with another value, e.g. 0 for a sum.
+    /// @param map : Called as Value map(uint32 chunkBegin, uint32 chunkEnd). Must be thread safe, like in ParallelFor().
+    /// @param reduce : Called as Value reduce(const Value& a, const Value& b), to combine two values.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Value, typename MapFunction, typename ReduceFunction>
+    Value                       ParallelReduce(JobSystem& jobSystem, const uint32 begin, const uint32 end, const Value& identity, MapFunction&& map, ReduceFunction&& reduce, const ParallelForSettings& settings = {});
+}
+
+#include "ParallelFor.inl"
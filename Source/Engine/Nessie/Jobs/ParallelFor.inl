@@ -0,0 +1,169 @@
+// ParallelFor.inl
+#pragma once
+
+namespace nes
+{
+    namespace internal
+    {
+        inline ParallelForRange::ParallelForRange(const uint32 begin, const uint32 end, const ParallelForSettings& settings, const int maxConcurrency)
+            : m_next(begin)
+            , m_begin(begin)
+            , m_end(end)
+            , m_concurrency(static_cast<uint32>(math::Max(maxConcurrency, 1)))
+            , m_deterministic(settings.m_deterministic)
+        {
+            NES_ASSERT(begin < end);
+            const uint32 numIterations = end - begin;
+
+            // Choose the grain size. In deterministic mode, it must not depend on the number of threads.
+            m_grainSize = settings.m_grainSize;
+            if (m_grainSize == 0)
+            {
+                const uint32 targetChunks = m_deterministic? kAutoDeterministicChunks : m_concurrency * kAutoChunksPerThread;
+                m_grainSize = math::Max((numIterations + targetChunks - 1) / targetChunks, 1u);
+            }
+
+            // Chunks are never smaller than the grain size, so this is the maximum number of chunks.
+            m_numChunks = (numIterations + m_grainSize - 1) / m_grainSize;
+        }
+
+        inline bool ParallelForRange::Next(uint32& outBegin, uint32& outEnd, uint32& outChunkIndex)
+        {
+            // Fixed size chunks, so that each chunk index always maps to the same iterations.
+            if (m_deterministic)
+            {
+                const uint64 chunkBegin = m_next.fetch_add(m_grainSize, std::memory_order_relaxed);
+                if (chunkBegin >= m_end)
+                    return false;
+
+                outBegin = static_cast<uint32>(chunkBegin);
+                outEnd = static_cast<uint32>(math::Min<uint64>(chunkBegin + m_grainSize, m_end));
+                outChunkIndex = (outBegin - m_begin) / m_grainSize;
+                return true;
+            }
+
+            // Claim a part of what is left: large chunks while there is a lot of work left, and chunks of the grain size
+            // towards the end, so that threads that finish early can still pick up work.
+            uint64 chunkBegin = m_next.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                if (chunkBegin >= m_end)
+                    return false;
+
+                const uint32 numRemaining = m_end - static_cast<uint32>(chunkBegin);
+                const uint32 chunkSize = math::Min(numRemaining, math::Max(m_grainSize, numRemaining / (2 * m_concurrency)));
+                if (m_next.compare_exchange_weak(chunkBegin, chunkBegin + chunkSize, std::memory_order_relaxed))
+                {
+                    outBegin = static_cast<uint32>(chunkBegin);
+                    outEnd = outBegin + chunkSize;
+                    outChunkIndex = 0;
+                    return true;
+                }
+            }
+        }
+
+        template <typename Body>
+        void RunParallel(JobSystem& jobSystem, const char* pName, const uint32 numHelperJobs, Body& body)
+        {
+            JobSystem::Barrier* pBarrier = numHelperJobs > 0? jobSystem.CreateBarrier() : nullptr;
+            if (pBarrier == nullptr)
+            {
+                body();
+                return;
+            }
+
+            // The Jobs only capture a reference to the body, which outlives them.
+            for (uint32 i = 0; i < numHelperJobs; ++i)
+            {
+                const JobHandle handle = jobSystem.CreateJob(pName, [&body]()
+                {
+                    body();
+                });
+                pBarrier->AddJob(handle);
+            }
+
+            // The calling thread claims chunks as well. Waiting then executes any helper Job that no worker has started yet,
+            // which finds no work left and returns immediately.
+            body();
+            jobSystem.WaitForJobs(pBarrier);
+            jobSystem.DestroyBarrier(pBarrier);
+        }
+    }
+
+    template <typename Function>
+    void ParallelFor(JobSystem& jobSystem, const uint32 begin, const uint32 end, Function&& function, const ParallelForSettings& settings)
+    {
+        if (begin >= end)
+            return;
+
+        internal::ParallelForRange range(begin, end, settings, jobSystem.GetMaxConcurrency());
+        const auto body = [&range, &function]()
+        {
+            uint32 chunkBegin, chunkEnd, chunkIndex;
+            while (range.Next(chunkBegin, chunkEnd, chunkIndex))
+                function(chunkBegin, chunkEnd);
+        };
+
+        internal::RunParallel(jobSystem, settings.m_pName, range.GetNumHelperJobs(), body);
+    }
+
+    template <typename Value, typename MapFunction, typename ReduceFunction>
+    Value ParallelReduce(JobSystem& jobSystem, const uint32 begin, const uint32 end, const Value& identity, MapFunction&& map, ReduceFunction&& reduce, const ParallelForSettings& settings)
+    {
+        if (begin >= end)
+            return identity;
+
+        internal::ParallelForRange range(begin, end, settings, jobSystem.GetMaxConcurrency());
+
+        if (settings.m_deterministic)
+        {
+            // Store the value of each chunk, and combine them in order when all chunks are done.
+            // The values are wrapped so that each chunk has its own cache line: a plain std::vector<bool> would pack
+            // the values into shared words, and threads writing neighbouring chunks would race.
+            struct alignas(NES_CACHE_LINE_SIZE) ChunkValue
+            {
+                Value   m_value;
+            };
+            
+            std::vector<ChunkValue> chunkValues(range.GetNumChunks(), ChunkValue{ identity });
+            const auto body = [&range, &map, &chunkValues]()
+            {
+                uint32 chunkBegin, chunkEnd, chunkIndex;
+                while (range.Next(chunkBegin, chunkEnd, chunkIndex))
+                    chunkValues[chunkIndex].m_value = map(chunkBegin, chunkEnd);
+            };
+
+            internal::RunParallel(jobSystem, settings.m_pName, range.GetNumHelperJobs(), body);
+
+            Value result = identity;
+            for (const ChunkValue& chunkValue : chunkValues)
+                result = reduce(result, chunkValue.m_value);
+            return result;
+        }
+
+        // Each thread combines the values of the chunks that it processed, and only locks once to add that to the result.
+        Value result = identity;
+        Mutex resultMutex;
+        const auto body = [&range, &map, &reduce, &identity, &result, &resultMutex]()
+        {
+            Value threadValue = identity;
+            bool hasValue = false;
+
+            uint32 chunkBegin, chunkEnd, chunkIndex;
+            while (range.Next(chunkBegin, chunkEnd, chunkIndex))
+            {
+                threadValue = reduce(threadValue, map(chunkBegin, chunkEnd));
+                hasValue = true;
+            }
+
+            if (hasValue)
+            {
+                std::lock_guard lock(resultMutex);
+                result = reduce(result, threadValue);
+            }
+        };
+
+        internal::RunParallel(jobSystem, settings.m_pName, range.GetNumHelperJobs(), body);
+        return result;
+    }
+}
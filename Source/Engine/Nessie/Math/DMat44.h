@@ -0,0 +1,191 @@
+// DMat44.h
+#pragma once
+#include "DVec3.h"
+#include "Mat44.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Rotation-Translation matrix with a double precision translation. Used to store world space
+    ///     transforms when NES_DOUBLE_PRECISION is defined (see RMat44). The rotation part is stored in single
+    ///     precision; only the translation column needs the extra precision to place objects far away from the origin.
+    //----------------------------------------------------------------------------------------------------
+    class alignas(NES_DVECTOR_ALIGNMENT) DMat44
+    {
+    public:
+        DMat44() = default;
+        DMat44(const DMat44& other) = default;
+        DMat44& operator=(const DMat44& other) = default;
+
+        NES_INLINE              DMat44(const Vec4Reg& c1, const Vec4Reg& c2, const Vec4Reg& c3, const DVec3& c4);
+        explicit NES_INLINE     DMat44(const Mat44& mat);
+
+        /// Operators
+        NES_INLINE bool         operator==(const DMat44& other) const;
+        NES_INLINE bool         operator!=(const DMat44& other) const               { return !(*this == other); }
+        NES_INLINE DMat44       operator*(const Mat44& other) const;
+        NES_INLINE DMat44       operator*(const DMat44& other) const;
+        friend NES_INLINE DMat44 operator*(const Mat44& left, const DMat44& right);
+        NES_INLINE DVec3        operator*(const Vec3& vec) const;
+        NES_INLINE DVec3        operator*(const DVec3& vec) const;
+
+        NES_INLINE Vec3         GetAxisX() const                                    { return m_columns[0].ToVec3(); }
+        NES_INLINE Vec3         GetAxisY() const                                    { return m_columns[1].ToVec3(); }
+        NES_INLINE Vec3         GetAxisZ() const                                    { return m_columns[2].ToVec3(); }
+        NES_INLINE void         SetAxisX(const Vec3& axis)                          { m_columns[0] = Vec4Reg(axis, 0.f); }
+        NES_INLINE void         SetAxisY(const Vec3& axis)                          { m_columns[1] = Vec4Reg(axis, 0.f); }
+        NES_INLINE void         SetAxisZ(const Vec3& axis)                          { m_columns[2] = Vec4Reg(axis, 0.f); }
+        NES_INLINE Vec3         GetColumn3(const uint column) const                 { NES_ASSERT(column < 3); return m_columns[column].ToVec3(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the translation component of this matrix.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        GetTranslation() const                              { return m_translation; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the translation component of this matrix.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         SetTranslation(const DVec3& translation)            { m_translation = translation; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if this matrix is close to another.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE bool         IsClose(const DMat44& other, const float maxSqrDist = 1.0e-12f) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Multiply a vector only by the 3x3 part of the matrix.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec3         Multiply3x3(const Vec3& vec) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Multiply a vector only by the 3x3 part of the matrix.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        Multiply3x3(const DVec3& vec) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Multiply a vector by the transpose of the 3x3 part of the matrix.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec3         Multiply3x3Transposed(const Vec3& vec) const        { return GetRotation().Multiply3x3Transposed(vec); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Transform a point by this matrix.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        TransformPoint(const DVec3& point) const            { return *this * point; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Transform a vector by this matrix. The translation is not applied.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec3         TransformVector(const Vec3& vector) const           { return Multiply3x3(vector); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the transpose of the 3x3 part of the matrix, with a zero translation.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Mat44        Transposed3x3() const                               { return GetRotation().Transposed3x3(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Inverse a matrix that contains only a rotation and a translation.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DMat44       InversedRotationTranslation() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the rotation part of the matrix, with a zero translation.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Mat44        GetRotation() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the rotation part of the matrix, with a zero translation. Safe to use when the matrix
+        ///     contains scaling.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Mat44        GetRotationSafe() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Updates the rotation part of this matrix (the first 3 columns).
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         SetRotation(const Mat44& rotation);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Convert the rotation part of the matrix to a Quaternion.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Quat         ToQuaternion() const                                { return GetRotation().ToQuaternion(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the scale from this matrix.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec3         GetScale() const                                    { return GetRotation().GetScale(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Decompose this matrix into a rotation-translation part and a scale part so that
+        ///     this = returnValue * Mat44::MakeScale(outScale).
+        /// @see : Mat44::Decompose()
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DMat44       Decompose(Vec3& outScale) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Pre multiply by translation matrix: result = this * Mat44::MakeTranslation(translation).
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DMat44       PreTranslated(const Vec3& translation) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Pre multiply by translation matrix: result = this * DMat44::MakeTranslation(translation).
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DMat44       PreTranslated(const DVec3& translation) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Post multiply by translation matrix: result = Mat44::MakeTranslation(translation) * this.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DMat44       PostTranslated(const Vec3& translation) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Post multiply by translation matrix: result = DMat44::MakeTranslation(translation) * this.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DMat44       PostTranslated(const DVec3& translation) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Scale a matrix: result = this * Mat44::MakeScale(scale).
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DMat44       PreScaled(const Vec3& scale) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Scale a matrix: result = Mat44::MakeScale(scale) * this.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DMat44       PostScaled(const Vec3& scale) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Convert to a single precision matrix. The translation is rounded to the nearest float,
+        ///     so this should only be used on transforms that are close to the origin, for example after
+        ///     they have been made relative to a base offset with PostTranslated(-baseOffset).
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Mat44        ToMat44() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Identity matrix.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DMat44 Identity();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Matrix with all components set to zero.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DMat44 Zero();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a matrix that translates by the given translation.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DMat44 MakeTranslation(const DVec3& translation);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a matrix that rotates and translates by the given rotation and translation.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DMat44 MakeRotationTranslation(const Quat& rotation, const DVec3& translation);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the inverse of the matrix that rotates and translates by the given rotation and translation.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DMat44 MakeInverseRotationTranslation(const Quat& rotation, const DVec3& translation);
+
+    private:
+        Vec4Reg                 m_columns[3];   /// Rotation columns.
+        DVec3                   m_translation;  /// Translation column.
+    };
+}
+
+#include "DMat44.inl"
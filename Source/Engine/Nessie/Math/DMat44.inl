@@ -0,0 +1,175 @@
+// DMat44.inl
+#pragma once
+#include "Quat.h"
+
+namespace nes
+{
+    DMat44::DMat44(const Vec4Reg& c1, const Vec4Reg& c2, const Vec4Reg& c3, const DVec3& c4)
+        : m_columns{ c1, c2, c3 }
+        , m_translation(c4)
+    {
+        //
+    }
+
+    DMat44::DMat44(const Mat44& mat)
+        : m_columns{ mat[0], mat[1], mat[2] }
+        , m_translation(mat.GetTranslation())
+    {
+        //
+    }
+
+    bool DMat44::operator==(const DMat44& other) const
+    {
+        return m_columns[0] == other.m_columns[0]
+            && m_columns[1] == other.m_columns[1]
+            && m_columns[2] == other.m_columns[2]
+            && m_translation == other.m_translation;
+    }
+
+    DMat44 DMat44::operator*(const Mat44& other) const
+    {
+        const Mat44 rotation = GetRotation().Multiply3x3(other);
+        return DMat44(rotation[0], rotation[1], rotation[2], *this * other.GetTranslation());
+    }
+
+    DMat44 DMat44::operator*(const DMat44& other) const
+    {
+        const Mat44 rotation = GetRotation().Multiply3x3(other.GetRotation());
+        return DMat44(rotation[0], rotation[1], rotation[2], *this * other.m_translation);
+    }
+
+    DMat44 operator*(const Mat44& left, const DMat44& right)
+    {
+        const Mat44 rotation = left.GetRotation().Multiply3x3(right.GetRotation());
+        return DMat44(rotation[0], rotation[1], rotation[2], DMat44(left) * right.m_translation);
+    }
+
+    DVec3 DMat44::operator*(const Vec3& vec) const
+    {
+        // The rotation can be done in single precision, only the translation needs to be added in double precision.
+        return m_translation + Multiply3x3(vec);
+    }
+
+    DVec3 DMat44::operator*(const DVec3& vec) const
+    {
+        return m_translation + Multiply3x3(vec);
+    }
+
+    bool DMat44::IsClose(const DMat44& other, const float maxSqrDist) const
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            if (!m_columns[i].IsClose(other.m_columns[i], maxSqrDist))
+                return false;
+        }
+
+        return m_translation.IsClose(other.m_translation, static_cast<double>(maxSqrDist));
+    }
+
+    Vec3 DMat44::Multiply3x3(const Vec3& vec) const
+    {
+        return GetRotation().Multiply3x3(vec);
+    }
+
+    DVec3 DMat44::Multiply3x3(const DVec3& vec) const
+    {
+        const DVec3 axisX(m_columns[0].ToVec3());
+        const DVec3 axisY(m_columns[1].ToVec3());
+        const DVec3 axisZ(m_columns[2].ToVec3());
+        return axisX * vec.x + axisY * vec.y + axisZ * vec.z;
+    }
+
+    DMat44 DMat44::InversedRotationTranslation() const
+    {
+        const Mat44 rotation = GetRotation().Transposed3x3();
+        const DVec3 translation = DMat44(rotation[0], rotation[1], rotation[2], DVec3::Zero()).Multiply3x3(-m_translation);
+        return DMat44(rotation[0], rotation[1], rotation[2], translation);
+    }
+
+    Mat44 DMat44::GetRotation() const
+    {
+        return Mat44(m_columns[0], m_columns[1], m_columns[2], Vec4Reg(0.f, 0.f, 0.f, 1.f));
+    }
+
+    Mat44 DMat44::GetRotationSafe() const
+    {
+        return GetRotation().GetRotationSafe();
+    }
+
+    void DMat44::SetRotation(const Mat44& rotation)
+    {
+        m_columns[0] = rotation[0];
+        m_columns[1] = rotation[1];
+        m_columns[2] = rotation[2];
+    }
+
+    DMat44 DMat44::Decompose(Vec3& outScale) const
+    {
+        const Mat44 rotation = GetRotation().Decompose(outScale);
+        return DMat44(rotation[0], rotation[1], rotation[2], m_translation);
+    }
+
+    DMat44 DMat44::PreTranslated(const Vec3& translation) const
+    {
+        return DMat44(m_columns[0], m_columns[1], m_columns[2], m_translation + Multiply3x3(translation));
+    }
+
+    DMat44 DMat44::PreTranslated(const DVec3& translation) const
+    {
+        return DMat44(m_columns[0], m_columns[1], m_columns[2], m_translation + Multiply3x3(translation));
+    }
+
+    DMat44 DMat44::PostTranslated(const Vec3& translation) const
+    {
+        return DMat44(m_columns[0], m_columns[1], m_columns[2], m_translation + translation);
+    }
+
+    DMat44 DMat44::PostTranslated(const DVec3& translation) const
+    {
+        return DMat44(m_columns[0], m_columns[1], m_columns[2], m_translation + translation);
+    }
+
+    DMat44 DMat44::PreScaled(const Vec3& scale) const
+    {
+        return DMat44(scale.x * m_columns[0], scale.y * m_columns[1], scale.z * m_columns[2], m_translation);
+    }
+
+    DMat44 DMat44::PostScaled(const Vec3& scale) const
+    {
+        const Vec4Reg scale4(scale, 1.f);
+        return DMat44(scale4 * m_columns[0], scale4 * m_columns[1], scale4 * m_columns[2], DVec3(scale) * m_translation);
+    }
+
+    Mat44 DMat44::ToMat44() const
+    {
+        return Mat44(m_columns[0], m_columns[1], m_columns[2], Vec4Reg(static_cast<Vec3>(m_translation), 1.f));
+    }
+
+    DMat44 DMat44::Identity()
+    {
+        return DMat44(Vec4Reg(1.f, 0.f, 0.f, 0.f), Vec4Reg(0.f, 1.f, 0.f, 0.f), Vec4Reg(0.f, 0.f, 1.f, 0.f), DVec3::Zero());
+    }
+
+    DMat44 DMat44::Zero()
+    {
+        return DMat44(Vec4Reg::Zero(), Vec4Reg::Zero(), Vec4Reg::Zero(), DVec3::Zero());
+    }
+
+    DMat44 DMat44::MakeTranslation(const DVec3& translation)
+    {
+        return DMat44(Vec4Reg(1.f, 0.f, 0.f, 0.f), Vec4Reg(0.f, 1.f, 0.f, 0.f), Vec4Reg(0.f, 0.f, 1.f, 0.f), translation);
+    }
+
+    DMat44 DMat44::MakeRotationTranslation(const Quat& rotation, const DVec3& translation)
+    {
+        const Mat44 rotationMatrix = Mat44::MakeRotation(rotation);
+        return DMat44(rotationMatrix[0], rotationMatrix[1], rotationMatrix[2], translation);
+    }
+
+    DMat44 DMat44::MakeInverseRotationTranslation(const Quat& rotation, const DVec3& translation)
+    {
+        const Mat44 rotationMatrix = Mat44::MakeRotation(rotation.Conjugate());
+        const DMat44 result(rotationMatrix[0], rotationMatrix[1], rotationMatrix[2], DVec3::Zero());
+        return result.PreTranslated(-translation);
+    }
+}
@@ -0,0 +1,208 @@
+// DVec3.h
+#pragma once
+#include "Scalar3.h"
+#include "MathTypes.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : 3-component double precision vector that is 32-byte aligned. Used to store world space
+    ///     positions when NES_DOUBLE_PRECISION is defined (see RVec3). Consider using Double3 for storage savings.
+    ///     Only a small set of operations is provided: calculations that don't need the extra precision should
+    ///     be done relative to a base offset using Vec3.
+    //----------------------------------------------------------------------------------------------------
+    class alignas (NES_DVECTOR_ALIGNMENT) DVec3
+    {
+    public:
+        static constexpr size_t N = 3;
+
+        double x;
+        double y;
+        double z;
+
+        DVec3() = default;
+        DVec3(const DVec3& other) = default;
+        DVec3& operator=(const DVec3& other) = default;
+
+        /// Conversion Constructors
+        explicit NES_INLINE     DVec3(const Vec3& vec);
+        explicit NES_INLINE     DVec3(const double uniformValue);
+        NES_INLINE              DVec3(const Double3& value);
+        NES_INLINE              DVec3(const double x, const double y, const double z);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Convert to a single precision vector, rounding to the nearest float.
+        //----------------------------------------------------------------------------------------------------
+        explicit NES_INLINE     operator Vec3() const;
+
+        /// Operators
+        NES_INLINE double       operator[](const size_t index) const                { NES_ASSERT(index < N); return *(&x + index); }
+        NES_INLINE double&      operator[](const size_t index)                      { NES_ASSERT(index < N); return *(&x + index); }
+        NES_INLINE bool         operator==(const DVec3& other) const                { return x == other.x && y == other.y && z == other.z; }
+        NES_INLINE bool         operator!=(const DVec3& other) const                { return !(*this == other); }
+        NES_INLINE DVec3        operator*(const DVec3& other) const;
+        NES_INLINE DVec3&       operator*=(const DVec3& other);
+        NES_INLINE DVec3        operator*(const double value) const;
+        NES_INLINE DVec3&       operator*=(const double value);
+        friend NES_INLINE DVec3 operator*(const double value, const DVec3& vec);
+        NES_INLINE DVec3        operator/(const DVec3& other) const;
+        NES_INLINE DVec3&       operator/=(const DVec3& other);
+        NES_INLINE DVec3        operator/(const double value) const;
+        NES_INLINE DVec3&       operator/=(const double value);
+        NES_INLINE DVec3        operator+(const DVec3& other) const;
+        NES_INLINE DVec3&       operator+=(const DVec3& other);
+        NES_INLINE DVec3        operator+(const Vec3& other) const;
+        NES_INLINE DVec3&       operator+=(const Vec3& other);
+        friend NES_INLINE DVec3 operator+(const Vec3& left, const DVec3& right)     { return right + left; }
+        NES_INLINE DVec3        operator-(const DVec3& other) const;
+        NES_INLINE DVec3&       operator-=(const DVec3& other);
+        NES_INLINE DVec3        operator-(const Vec3& other) const;
+        NES_INLINE DVec3&       operator-=(const Vec3& other);
+        friend NES_INLINE DVec3 operator-(const Vec3& left, const DVec3& right);
+        NES_INLINE DVec3        operator-() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if two vectors are close
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE bool         IsClose(const DVec3& other, const double maxDistSqr = 1.0e-24) const { return (other - *this).LengthSqr() <= maxDistSqr; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if the vector is close to zero.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE bool         IsNearZero(const double maxDistSqr = 1.0e-24) const                 { return LengthSqr() <= maxDistSqr; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if the vector is normalized (Length = 1.0).
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE bool         IsNormalized(const double tolerance = 1.0e-12) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if *any* components are NaN (not a number).
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE bool         IsNaN() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Return the absolute value of each component.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        Abs() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Return the reciprocal (1 / value) of each component.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        Reciprocal() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Return the dot product between this and another vector.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE double       Dot(const DVec3& other) const;
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Calculate the cross-product between this and another vector.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        Cross(const DVec3& other) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns the squared length (magnitude) of the vector.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE double       LengthSqr() const                                   { return Dot(*this); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns the length (magnitude) of the vector.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE double       Length() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get a normalized version of this vector.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        Normalized() const                                  { return *this / Length(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Component-wise square root.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        Sqrt() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns a vector that contains the sign of each component (1.0 for positive, -1.0 for negative).
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE DVec3        GetSign() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Convert to a single precision vector, rounding each component towards negative infinity.
+        ///     Used to make sure that a bounding box containing this point still contains it after conversion.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec3         ToVec3RoundDown() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Convert to a single precision vector, rounding each component towards positive infinity.
+        ///     Used to make sure that a bounding box containing this point still contains it after conversion.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec3         ToVec3RoundUp() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Store the component values into pOutDoubles.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         StoreDouble3(Double3* pOutDoubles) const            { *pOutDoubles = Double3(x, y, z); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Vector with all components set to zero.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 Zero()                                              { return Replicate(0.0); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Vector with all components set to one.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 One()                                               { return Replicate(1.0); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Vector with all components set to NaN (Not a Number).
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 NaN()                                               { return Replicate(std::numeric_limits<double>::quiet_NaN()); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a vector with all components to the specified value.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 Replicate(const double value)                       { return DVec3(value, value, value); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Load a vector from a 3-element double array.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 LoadDouble3Unsafe(const Double3& value)             { return DVec3(value); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Creates a vector with the minimum value of each component.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 Min(const DVec3& left, const DVec3& right);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Creates a vector with the maximum value of each component.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 Max(const DVec3& left, const DVec3& right);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Clamp each component of the vector between the min and max components.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 Clamp(const DVec3& vec, const DVec3& min, const DVec3& max) { return Max(Min(vec, max), min); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Return the dot product between two vectors.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE double Dot(const DVec3& a, const DVec3& b)                { return a.Dot(b); }
+
+        //----------------------------------------------------------------------------------------------------
+        ///	@brief : Linearly interpolate between two vectors.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE DVec3 Lerp(const DVec3& from, const DVec3& to, const double t) { return from + (to - from) * t; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Compute the distance between two points.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE double Distance(const DVec3& a, const DVec3& b)           { return (a - b).Length(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Compute the squared distance between two points.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE double DistanceSqr(const DVec3& a, const DVec3& b)        { return (a - b).LengthSqr(); }
+    };
+}
+
+#include "DVec3.inl"
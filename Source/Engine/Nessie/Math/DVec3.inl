@@ -0,0 +1,243 @@
+// DVec3.inl
+#pragma once
+#include <cmath>
+#include "Nessie/Math/Vec3.h"
+
+namespace nes
+{
+    namespace math
+    {
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Convert a double to the largest float that is smaller or equal to it.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE float DoubleToFloatRoundDown(const double value)
+        {
+            const float result = static_cast<float>(value);
+            return static_cast<double>(result) > value? std::nextafter(result, -std::numeric_limits<float>::infinity()) : result;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Convert a double to the smallest float that is larger or equal to it.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE float DoubleToFloatRoundUp(const double value)
+        {
+            const float result = static_cast<float>(value);
+            return static_cast<double>(result) < value? std::nextafter(result, std::numeric_limits<float>::infinity()) : result;
+        }
+    }
+
+    DVec3::DVec3(const Vec3& vec)
+        : x(vec.x)
+        , y(vec.y)
+        , z(vec.z)
+    {
+        //
+    }
+
+    DVec3::DVec3(const double uniformValue)
+        : x(uniformValue)
+        , y(uniformValue)
+        , z(uniformValue)
+    {
+        //
+    }
+
+    DVec3::DVec3(const Double3& value)
+        : x(value.x)
+        , y(value.y)
+        , z(value.z)
+    {
+        //
+    }
+
+    DVec3::DVec3(const double x, const double y, const double z)
+        : x(x)
+        , y(y)
+        , z(z)
+    {
+        //
+    }
+
+    DVec3::operator Vec3() const
+    {
+        return Vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+    }
+
+    DVec3 DVec3::operator*(const DVec3& other) const
+    {
+        return DVec3(x * other.x, y * other.y, z * other.z);
+    }
+
+    DVec3& DVec3::operator*=(const DVec3& other)
+    {
+        *this = *this * other;
+        return *this;
+    }
+
+    DVec3 DVec3::operator*(const double value) const
+    {
+        return DVec3(x * value, y * value, z * value);
+    }
+
+    DVec3& DVec3::operator*=(const double value)
+    {
+        *this = *this * value;
+        return *this;
+    }
+
+    DVec3 operator*(const double value, const DVec3& vec)
+    {
+        return vec * value;
+    }
+
+    DVec3 DVec3::operator/(const DVec3& other) const
+    {
+        return DVec3(x / other.x, y / other.y, z / other.z);
+    }
+
+    DVec3& DVec3::operator/=(const DVec3& other)
+    {
+        *this = *this / other;
+        return *this;
+    }
+
+    DVec3 DVec3::operator/(const double value) const
+    {
+        return DVec3(x / value, y / value, z / value);
+    }
+
+    DVec3& DVec3::operator/=(const double value)
+    {
+        *this = *this / value;
+        return *this;
+    }
+
+    DVec3 DVec3::operator+(const DVec3& other) const
+    {
+        return DVec3(x + other.x, y + other.y, z + other.z);
+    }
+
+    DVec3& DVec3::operator+=(const DVec3& other)
+    {
+        *this = *this + other;
+        return *this;
+    }
+
+    DVec3 DVec3::operator+(const Vec3& other) const
+    {
+        return DVec3(x + other.x, y + other.y, z + other.z);
+    }
+
+    DVec3& DVec3::operator+=(const Vec3& other)
+    {
+        *this = *this + other;
+        return *this;
+    }
+
+    DVec3 DVec3::operator-(const DVec3& other) const
+    {
+        return DVec3(x - other.x, y - other.y, z - other.z);
+    }
+
+    DVec3& DVec3::operator-=(const DVec3& other)
+    {
+        *this = *this - other;
+        return *this;
+    }
+
+    DVec3 DVec3::operator-(const Vec3& other) const
+    {
+        return DVec3(x - other.x, y - other.y, z - other.z);
+    }
+
+    DVec3& DVec3::operator-=(const Vec3& other)
+    {
+        *this = *this - other;
+        return *this;
+    }
+
+    DVec3 operator-(const Vec3& left, const DVec3& right)
+    {
+        return DVec3(left.x - right.x, left.y - right.y, left.z - right.z);
+    }
+
+    DVec3 DVec3::operator-() const
+    {
+        return DVec3(-x, -y, -z);
+    }
+
+    bool DVec3::IsNormalized(const double tolerance) const
+    {
+        return std::abs(LengthSqr() - 1.0) <= tolerance;
+    }
+
+    bool DVec3::IsNaN() const
+    {
+        return std::isnan(x) || std::isnan(y) || std::isnan(z);
+    }
+
+    DVec3 DVec3::Abs() const
+    {
+        return DVec3(std::abs(x), std::abs(y), std::abs(z));
+    }
+
+    DVec3 DVec3::Reciprocal() const
+    {
+        return One() / *this;
+    }
+
+    double DVec3::Dot(const DVec3& other) const
+    {
+        return x * other.x + y * other.y + z * other.z;
+    }
+
+    DVec3 DVec3::Cross(const DVec3& other) const
+    {
+        return DVec3
+        (
+            y * other.z - z * other.y,
+            z * other.x - x * other.z,
+            x * other.y - y * other.x
+        );
+    }
+
+    double DVec3::Length() const
+    {
+        return std::sqrt(LengthSqr());
+    }
+
+    DVec3 DVec3::Sqrt() const
+    {
+        return DVec3(std::sqrt(x), std::sqrt(y), std::sqrt(z));
+    }
+
+    DVec3 DVec3::GetSign() const
+    {
+        return DVec3
+        (
+            std::signbit(x)? -1.0 : 1.0,
+            std::signbit(y)? -1.0 : 1.0,
+            std::signbit(z)? -1.0 : 1.0
+        );
+    }
+
+    Vec3 DVec3::ToVec3RoundDown() const
+    {
+        return Vec3(math::DoubleToFloatRoundDown(x), math::DoubleToFloatRoundDown(y), math::DoubleToFloatRoundDown(z));
+    }
+
+    Vec3 DVec3::ToVec3RoundUp() const
+    {
+        return Vec3(math::DoubleToFloatRoundUp(x), math::DoubleToFloatRoundUp(y), math::DoubleToFloatRoundUp(z));
+    }
+
+    DVec3 DVec3::Min(const DVec3& left, const DVec3& right)
+    {
+        return DVec3(math::Min(left.x, right.x), math::Min(left.y, right.y), math::Min(left.z, right.z));
+    }
+
+    DVec3 DVec3::Max(const DVec3& left, const DVec3& right)
+    {
+        return DVec3(math::Max(left.x, right.x), math::Max(left.y, right.y), math::Max(left.z, right.z));
+    }
+}
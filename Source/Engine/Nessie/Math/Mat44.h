@@ -153,6 +153,8 @@ namespace nes
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the inverse of the 4x4 matrix.
+        /// @note : The scalar path evaluates the algorithm of the SSE path per component, so both return the
+        ///     same bits.
         //----------------------------------------------------------------------------------------------------
         NES_INLINE Mat44        Inversed() const;
 
@@ -263,6 +265,12 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         NES_INLINE void         Decompose(Vec3& outTranslation, Rotation& outRotation, Vec3& outScale) const;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns this matrix. Allows code that uses RMat44 to call DMat44::ToMat44() in both
+        ///     single and double precision.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Mat44        ToMat44() const                                     { return *this; }
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Identity Matrix - represents no rotation.
         //----------------------------------------------------------------------------------------------------
@@ -15,7 +15,7 @@ namespace nes
     {
         m_columns[0] = Vec4Reg(diagonal.x, 0.f, 0.f, 0.f);
         m_columns[1] = Vec4Reg(0.f, diagonal.y, 0.f, 0.f);
-        m_columns[2] = Vec4Reg(0.f, 0.f, diagonal.y, 0.f);
+        m_columns[2] = Vec4Reg(0.f, 0.f, diagonal.z, 0.f);
         m_columns[3] = Vec4Reg(0.f, 0.f, 0.f, 1.f);
     }
 
@@ -77,12 +77,13 @@ namespace nes
     #if defined (NES_USE_SSE)
         for (int i = 0; i < 4; ++i)
         {
-            const __m128 c = other.m_columns[i].m_value;
-            __m128 t = _mm_mul_ps(m_columns[0].m_value, _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0)));
-            t = _mm_add_ps(t, _mm_mul_ps(m_columns[1].m_value, _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1))));
-            t = _mm_add_ps(t, _mm_mul_ps(m_columns[2].m_value, _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2))));
-            t = _mm_add_ps(t, _mm_mul_ps(m_columns[3].m_value, _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3))));
-            result.m_columns[i].m_value = t;
+            // Separate multiply and add instead of FMA, so that the result is bit for bit equal to the scalar path.
+            const Vec4Reg c = other.m_columns[i];
+            Vec4Reg t = m_columns[0] * c.SplatX();
+            t += m_columns[1] * c.SplatY();
+            t += m_columns[2] * c.SplatZ();
+            t += m_columns[3] * c.SplatW();
+            result.m_columns[i] = t;
         }
     #else
         for (int i = 0; i < 4; ++i)
@@ -98,12 +99,11 @@ namespace nes
     #if defined (NES_USE_SSE)
         const Vec4Reg rVec = Vec4Reg(vec);
         
-        __m128 t = _mm_mul_ps(m_columns[0].m_value, _mm_shuffle_ps(rVec.m_value, rVec.m_value, _MM_SHUFFLE(0, 0, 0, 0)));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[1].m_value, _mm_shuffle_ps(rVec.m_value, rVec.m_value, _MM_SHUFFLE(1, 1, 1, 1))));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[2].m_value, _mm_shuffle_ps(rVec.m_value, rVec.m_value, _MM_SHUFFLE(2, 2, 2, 2))));
-        t = _mm_add_ps(t, m_columns[3].m_value);
-        t = Vec4Reg::FixW(t);
-        return Vec4Reg(t).ToVec3();
+        Vec4Reg t = m_columns[0] * rVec.SplatX();
+        t += m_columns[1] * rVec.SplatY();
+        t += m_columns[2] * rVec.SplatZ();
+        t += m_columns[3];
+        return Vec4Reg(Vec4Reg::FixW(t.m_value)).ToVec3();
     #else
         return Vec3
         (
@@ -119,11 +119,11 @@ namespace nes
     #if defined (NES_USE_SSE)
         const Vec4Reg rVec = Vec4Reg(vec);
         
-        __m128 t = _mm_mul_ps(m_columns[0].m_value, _mm_shuffle_ps(rVec.m_value, rVec.m_value, _MM_SHUFFLE(0, 0, 0, 0)));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[1].m_value, _mm_shuffle_ps(rVec.m_value, rVec.m_value, _MM_SHUFFLE(1, 1, 1, 1))));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[2].m_value, _mm_shuffle_ps(rVec.m_value, rVec.m_value, _MM_SHUFFLE(2, 2, 2, 2))));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[3].m_value, _mm_shuffle_ps(rVec.m_value, rVec.m_value, _MM_SHUFFLE(3, 3, 3, 3))));
-        return Vec4Reg(t).ToVec4();
+        Vec4Reg t = m_columns[0] * rVec.SplatX();
+        t += m_columns[1] * rVec.SplatY();
+        t += m_columns[2] * rVec.SplatZ();
+        t += m_columns[3] * rVec.SplatW();
+        return t.ToVec4();
     #else
         return Vec4
         (
@@ -138,10 +138,10 @@ namespace nes
     Vec4Reg Mat44::operator*(const Vec4Reg& vec) const
     {
 #if defined (NES_USE_SSE)
-        __m128 t = _mm_mul_ps(m_columns[0].m_value, _mm_shuffle_ps(vec.m_value, vec.m_value, _MM_SHUFFLE(0, 0, 0, 0)));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[1].m_value, _mm_shuffle_ps(vec.m_value, vec.m_value, _MM_SHUFFLE(1, 1, 1, 1))));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[2].m_value, _mm_shuffle_ps(vec.m_value, vec.m_value, _MM_SHUFFLE(2, 2, 2, 2))));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[3].m_value, _mm_shuffle_ps(vec.m_value, vec.m_value, _MM_SHUFFLE(3, 3, 3, 3))));
+        Vec4Reg t = m_columns[0] * vec.SplatX();
+        t += m_columns[1] * vec.SplatY();
+        t += m_columns[2] * vec.SplatZ();
+        t += m_columns[3] * vec.SplatW();
         return t;
 #else
         return Vec4
@@ -520,11 +520,16 @@ namespace nes
         const float y = vec.y;
         const float z = vec.z;
 
+        // Negate by subtracting from zero, like the SSE path.
+        const float minX = 0.f - x;
+        const float minY = 0.f - y;
+        const float minZ = 0.f - z;
+
         return Mat44
         (
-            Vec4Reg(0, z, -y, 0),
-            Vec4Reg(-z, 0, x, 0),
-            Vec4Reg(y, -x, 0, 0),
+            Vec4Reg(0, z, minY, 0),
+            Vec4Reg(minZ, 0, x, 0),
+            Vec4Reg(y, minX, 0, 0),
             Vec4Reg(0, 0, 0, 1)
         );
 #endif
@@ -718,10 +723,10 @@ namespace nes
     #if defined(NES_USE_SSE)
         const Vec4Reg rVec3 = Vec4Reg(vec);
         
-        __m128 t = _mm_mul_ps(m_columns[0].m_value, _mm_shuffle_ps(rVec3.m_value, rVec3.m_value, _MM_SHUFFLE(0, 0, 0, 0)));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[1].m_value, _mm_shuffle_ps(rVec3.m_value, rVec3.m_value, _MM_SHUFFLE(1, 1, 1, 1))));
-        t = _mm_add_ps(t, _mm_mul_ps(m_columns[2].m_value, _mm_shuffle_ps(rVec3.m_value, rVec3.m_value, _MM_SHUFFLE(2, 2, 2, 2))));
-        return Vec4Reg(Vec4Reg::FixW(t)).ToVec3();
+        Vec4Reg t = m_columns[0] * rVec3.SplatX();
+        t += m_columns[1] * rVec3.SplatY();
+        t += m_columns[2] * rVec3.SplatZ();
+        return Vec4Reg(Vec4Reg::FixW(t.m_value)).ToVec3();
     #else
         return Vec3
         (
@@ -759,11 +764,11 @@ namespace nes
     #if defined (NES_USE_SSE)
         for (int i = 0; i < 3; ++i)
         {
-            const __m128 c = other.m_columns[i].m_value;
-            __m128 t = _mm_mul_ps(m_columns[0].m_value, _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0)));
-            t = _mm_add_ps(t, _mm_mul_ps(m_columns[1].m_value, _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1))));
-            t = _mm_add_ps(t, _mm_mul_ps(m_columns[2].m_value, _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2))));
-            result.m_columns[i].m_value = t;
+            const Vec4Reg c = other.m_columns[i];
+            Vec4Reg t = m_columns[0] * c.SplatX();
+            t += m_columns[1] * c.SplatY();
+            t += m_columns[2] * c.SplatZ();
+            result.m_columns[i] = t;
         }
     #else
         for (int i = 0; i < 3; ++i)
@@ -771,6 +776,7 @@ namespace nes
             result.m_columns[i] = m_columns[0] * other.m_columns[i].m_f32[0] + m_columns[1] * other.m_columns[i].m_f32[1] + m_columns[2] * other.m_columns[i].m_f32[2];
         }
     #endif
+        result.m_columns[3] = Vec4Reg(0.f, 0.f, 0.f, 1.f);
         return result;
     }
 
@@ -950,38 +956,71 @@ namespace nes
 	    result.m_columns[3].m_value = _mm_mul_ps(det, minor3);
 	    return result;
     #else
-        float m00 = NES_RC(0, 0), m10 = NES_RC(1, 0), m20 = NES_RC(2, 0), m30 = NES_RC(3, 0);
-	    float m01 = NES_RC(0, 1), m11 = NES_RC(1, 1), m21 = NES_RC(2, 1), m31 = NES_RC(3, 1);
-	    float m02 = NES_RC(0, 2), m12 = NES_RC(1, 2), m22 = NES_RC(2, 2), m32 = NES_RC(3, 2);
-	    float m03 = NES_RC(0, 3), m13 = NES_RC(1, 3), m23 = NES_RC(2, 3), m33 = NES_RC(3, 3);
-
-	    float m10211120 = m10 * m21 - m11 * m20;
-	    float m10221220 = m10 * m22 - m12 * m20;
-	    float m10231320 = m10 * m23 - m13 * m20;
-	    float m10311130 = m10 * m31 - m11 * m30;
-	    float m10321230 = m10 * m32 - m12 * m30;
-	    float m10331330 = m10 * m33 - m13 * m30;
-	    float m11221221 = m11 * m22 - m12 * m21;
-	    float m11231321 = m11 * m23 - m13 * m21;
-	    float m11321231 = m11 * m32 - m12 * m31;
-	    float m11331331 = m11 * m33 - m13 * m31;
-	    float m12231322 = m12 * m23 - m13 * m22;
-	    float m12331332 = m12 * m33 - m13 * m32;
-	    float m20312130 = m20 * m31 - m21 * m30;
-	    float m20322230 = m20 * m32 - m22 * m30;
-	    float m20332330 = m20 * m33 - m23 * m30;
-	    float m21322231 = m21 * m32 - m22 * m31;
-	    float m21332331 = m21 * m33 - m23 * m31;
-	    float m22332332 = m22 * m33 - m23 * m32;
-
-	    const Vec4 col0(m11 * m22332332 - m12 * m21332331 + m13 * m21322231,		-m10 * m22332332 + m12 * m20332330 - m13 * m20322230,		m10 * m21332331 - m11 * m20332330 + m13 * m20312130,		-m10 * m21322231 + m11 * m20322230 - m12 * m20312130);
-	    const Vec4 col1(-m01 * m22332332 + m02 * m21332331 - m03 * m21322231,		m00 * m22332332 - m02 * m20332330 + m03 * m20322230,		-m00 * m21332331 + m01 * m20332330 - m03 * m20312130,		m00 * m21322231 - m01 * m20322230 + m02 * m20312130);
-	    const Vec4 col2(m01 * m12331332 - m02 * m11331331 + m03 * m11321231,		-m00 * m12331332 + m02 * m10331330 - m03 * m10321230,		m00 * m11331331 - m01 * m10331330 + m03 * m10311130,		-m00 * m11321231 + m01 * m10321230 - m02 * m10311130);
-	    const Vec4 col3(-m01 * m12231322 + m02 * m11231321 - m03 * m11221221,		m00 * m12231322 - m02 * m10231320 + m03 * m10221220,		-m00 * m11231321 + m01 * m10231320 - m03 * m10211120,		m00 * m11221221 - m01 * m10221220 + m02 * m10211120);
-
-	    float det = m00 * col0.x + m01 * col0.y + m02 * col0.z + m03 * col0.w;
-
-	    return Mat44(col0 / det, col1 / det, col2 / det, col3 / det);
+        // Same algorithm as the SSE path, evaluated per component, so that both paths return the same bits.
+        // Shuffles two vectors like _mm_shuffle_ps: the X and Y components come from 'a', Z and W from 'b'.
+        const auto shuffle = [](const Vec4Reg& a, const Vec4Reg& b, const size_t x, const size_t y, const size_t z, const size_t w)
+        {
+            return Vec4Reg(a[x], a[y], b[z], b[w]);
+        };
+
+        Vec4Reg tmp1 = shuffle(m_columns[0], m_columns[1], 0, 1, 0, 1);
+        Vec4Reg row1 = shuffle(m_columns[2], m_columns[3], 0, 1, 0, 1);
+        Vec4Reg row0 = shuffle(tmp1, row1, 0, 2, 0, 2);
+        row1 = shuffle(row1, tmp1, 1, 3, 1, 3);
+        tmp1 = shuffle(m_columns[0], m_columns[1], 2, 3, 2, 3);
+        Vec4Reg row3 = shuffle(m_columns[2], m_columns[3], 2, 3, 2, 3);
+        Vec4Reg row2 = shuffle(tmp1, row3, 0, 2, 0, 2);
+        row3 = shuffle(row3, tmp1, 1, 3, 1, 3);
+
+        tmp1 = (row2 * row3).Swizzle<1, 0, 3, 2>();
+        Vec4Reg minor0 = row1 * tmp1;
+        Vec4Reg minor1 = row0 * tmp1;
+        tmp1 = tmp1.Swizzle<2, 3, 0, 1>();
+        minor0 = row1 * tmp1 - minor0;
+        minor1 = row0 * tmp1 - minor1;
+        minor1 = minor1.Swizzle<2, 3, 0, 1>();
+
+        tmp1 = (row1 * row2).Swizzle<1, 0, 3, 2>();
+        minor0 = row3 * tmp1 + minor0;
+        Vec4Reg minor3 = row0 * tmp1;
+        tmp1 = tmp1.Swizzle<2, 3, 0, 1>();
+        minor0 = minor0 - row3 * tmp1;
+        minor3 = row0 * tmp1 - minor3;
+        minor3 = minor3.Swizzle<2, 3, 0, 1>();
+
+        tmp1 = (row1.Swizzle<2, 3, 0, 1>() * row3).Swizzle<1, 0, 3, 2>();
+        row2 = row2.Swizzle<2, 3, 0, 1>();
+        minor0 = row2 * tmp1 + minor0;
+        Vec4Reg minor2 = row0 * tmp1;
+        tmp1 = tmp1.Swizzle<2, 3, 0, 1>();
+        minor0 = minor0 - row2 * tmp1;
+        minor2 = row0 * tmp1 - minor2;
+        minor2 = minor2.Swizzle<2, 3, 0, 1>();
+
+        tmp1 = (row0 * row1).Swizzle<1, 0, 3, 2>();
+        minor2 = row3 * tmp1 + minor2;
+        minor3 = row2 * tmp1 - minor3;
+        tmp1 = tmp1.Swizzle<2, 3, 0, 1>();
+        minor2 = row3 * tmp1 - minor2;
+        minor3 = minor3 - row2 * tmp1;
+
+        tmp1 = (row0 * row3).Swizzle<1, 0, 3, 2>();
+        minor1 = minor1 - row2 * tmp1;
+        minor2 = row1 * tmp1 + minor2;
+        tmp1 = tmp1.Swizzle<2, 3, 0, 1>();
+        minor1 = row2 * tmp1 + minor1;
+        minor2 = minor2 - row1 * tmp1;
+
+        tmp1 = (row0 * row2).Swizzle<1, 0, 3, 2>();
+        minor1 = row3 * tmp1 + minor1;
+        minor3 = minor3 - row1 * tmp1;
+        tmp1 = tmp1.Swizzle<2, 3, 0, 1>();
+        minor1 = minor1 - row3 * tmp1;
+        minor3 = row1 * tmp1 + minor3;
+
+        const Vec4Reg det = row0 * minor0;
+        const Vec4Reg invDet = Vec4Reg::Replicate(1.f / ((det[0] + det[1]) + (det[2] + det[3])));
+        return Mat44(invDet * minor0, invDet * minor1, invDet * minor2, invDet * minor3);
     #endif
     }
 
@@ -1118,7 +1157,7 @@ namespace nes
 
     Quat Mat44::ToQuaternion() const
     {
-        const float tr = m_columns[0].m_f32[0] + m_columns[1].m_f32[1] - m_columns[2].m_f32[2];
+        const float tr = m_columns[0].m_f32[0] + m_columns[1].m_f32[1] + m_columns[2].m_f32[2];
         
         if (tr >= 0.f)
         {
@@ -5,6 +5,7 @@
 #include "Nessie/Math/Mat22.h"
 #include "Nessie/Math/Mat33.h"
 #include "Nessie/Math/Mat44.h"
+#include "Nessie/Math/DMat44.h"
 #include "Nessie/Math/Real.h"
 #include "Nessie/Math/IVec4.h"
 
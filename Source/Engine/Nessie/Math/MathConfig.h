@@ -3,12 +3,11 @@
 #include "Nessie/Core/Config.h"
 
 /// Uncomment to set NES_PRECISION_TYPE to "double". This is used across all default math types.
-/// Otherwise, the precision type is "float".
+/// Otherwise, the precision type is "float". This also makes world space positions (RVec3, RMat44) double precision,
+/// to support large worlds in the physics simulation.
 // #define NES_DOUBLE_PRECISION
 
 #ifdef NES_DOUBLE_PRECISION
-#error "Double Precision classes not setup properly yet!"
-
     #define NES_IF_SINGLE_PRECISION(...)
     #define NES_IF_SINGLE_PRECISION_ELSE(singleArg, doubleArg) doubleArg
     #define NES_IF_DOUBLE_PRECISION(...) __VA_ARGS__
@@ -12,6 +12,8 @@ namespace nes
     struct  Quat;
     struct  Rotation;
     class   Mat44;
+    class   DVec3;
+    class   DMat44;
 
     template <IntegralType Type> struct TIntVec2;
     using   IVec2 = TIntVec2<int>;
@@ -0,0 +1,71 @@
+// QuatSIMD.h
+#pragma once
+#include "Nessie/Math/Math.h"
+
+namespace nes::math
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Multiply 4 quaternions by 4 other quaternions, with the components of the quaternions split
+    ///     into registers: element 0 holds the x components of the 4 quaternions, element 1 the y components,
+    ///     etc.
+    ///	@param left : The x, y, z and w components of the 4 quaternions on the left.
+    ///	@param right : The x, y, z and w components of the 4 quaternions on the right.
+    ///	@param outResult : The x, y, z and w components of the 4 products (left * right). Can be left or right.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE void Quat4Multiply(const Vec4Reg left[4], const Vec4Reg right[4], Vec4Reg outResult[4])
+    {
+        const Vec4Reg x = left[3] * right[0] + left[0] * right[3] + left[1] * right[2] - left[2] * right[1];
+        const Vec4Reg y = left[3] * right[1] - left[0] * right[2] + left[1] * right[3] + left[2] * right[0];
+        const Vec4Reg z = left[3] * right[2] + left[0] * right[1] - left[1] * right[0] + left[2] * right[3];
+        const Vec4Reg w = left[3] * right[3] - left[0] * right[0] - left[1] * right[1] - left[2] * right[2];
+        outResult[0] = x;
+        outResult[1] = y;
+        outResult[2] = z;
+        outResult[3] = w;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Normalize 4 quaternions, with the components of the quaternions split into registers.
+    ///	@param quat : The x, y, z and w components of the 4 quaternions. None can be zero.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE void Quat4Normalize(Vec4Reg quat[4])
+    {
+        const Vec4Reg length = (quat[0] * quat[0] + quat[1] * quat[1] + quat[2] * quat[2] + quat[3] * quat[3]).Sqrt();
+        for (int i = 0; i < 4; ++i)
+            quat[i] /= length;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the 3x3 rotation matrices of 4 normalized quaternions, with the components of the
+    ///     quaternions split into registers. Same as Mat44::MakeRotation(), for 4 quaternions at once.
+    ///	@param quat : The x, y, z and w components of the 4 quaternions.
+    ///	@param outColumns : outColumns[column][row] holds that element of the 4 matrices.
+    //----------------------------------------------------------------------------------------------------
+    NES_INLINE void Quat4ToRotation3x3(const Vec4Reg quat[4], Vec4Reg outColumns[3][3])
+    {
+        const Vec4Reg x2 = quat[0] + quat[0];
+        const Vec4Reg y2 = quat[1] + quat[1];
+        const Vec4Reg z2 = quat[2] + quat[2];
+
+        const Vec4Reg xx = x2 * quat[0];
+        const Vec4Reg xy = y2 * quat[0];
+        const Vec4Reg xz = z2 * quat[0];
+        const Vec4Reg yy = y2 * quat[1];
+        const Vec4Reg yz = z2 * quat[1];
+        const Vec4Reg zz = z2 * quat[2];
+        const Vec4Reg wx = x2 * quat[3];
+        const Vec4Reg wy = y2 * quat[3];
+        const Vec4Reg wz = z2 * quat[3];
+        const Vec4Reg one = Vec4Reg::One();
+
+        outColumns[0][0] = one - (yy + zz);
+        outColumns[0][1] = xy + wz;
+        outColumns[0][2] = xz - wy;
+        outColumns[1][0] = xy - wz;
+        outColumns[1][1] = one - (xx + zz);
+        outColumns[1][2] = yz + wx;
+        outColumns[2][0] = xz + wy;
+        outColumns[2][1] = yz - wx;
+        outColumns[2][2] = one - (xx + yy);
+    }
+}
@@ -93,7 +93,7 @@ namespace nes
         NES_INLINE bool             TestAllXYZTrue() const                                  { return (GetTrues() & 0b111) == 0b111; }
         
         //----------------------------------------------------------------------------------------------------
-        /// @brief : Convert each int component to a float. 
+        /// @brief : Convert each component to a float. The components are treated as signed ints.
         //----------------------------------------------------------------------------------------------------
         NES_INLINE Vec4Reg          ToFloat() const;
 
@@ -239,6 +239,15 @@ namespace nes
         ///	@returns : The number of trues.
         //----------------------------------------------------------------------------------------------------
         static NES_INLINE int       CountAndSortTrues(const UVec4Reg& value, UVec4Reg& identifiers);
+
+    private:
+    #if defined (NES_USE_SSE) && !defined (NES_USE_SSE4_1)
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Component-wise 32-bit multiply, keeping the low 32 bits of each result. SSE2 fallback
+        ///     for _mm_mullo_epi32.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE Type      MultiplyLowSSE2(const Type a, const Type b);
+    #endif
     };
 }
 
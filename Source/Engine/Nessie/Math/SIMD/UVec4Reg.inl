@@ -29,8 +29,10 @@ namespace nes
 
     UVec4Reg UVec4Reg::operator*(const UVec4Reg& other) const
     {
-#if defined (NES_USE_SSE)
+#if defined (NES_USE_SSE4_1)
         return _mm_mullo_epi32(m_value, other.m_value);
+#elif defined (NES_USE_SSE)
+        return MultiplyLowSSE2(m_value, other.m_value);
 #else
         UVec4Reg result;
         for (int i = 0; i < 4; ++i)
@@ -43,8 +45,10 @@ namespace nes
 
     UVec4Reg& UVec4Reg::operator*=(const UVec4Reg& other)
     {
-#if defined (NES_USE_SSE)
+#if defined (NES_USE_SSE4_1)
         m_value = _mm_mullo_epi32(m_value, other.m_value);
+#elif defined (NES_USE_SSE)
+        m_value = MultiplyLowSSE2(m_value, other.m_value);
 #else
         for (int i = 0; i < 4; ++i)
         {
@@ -92,17 +96,29 @@ namespace nes
 
     uint32 UVec4Reg::GetY() const
     {
+#if defined (NES_USE_SSE4_1)
+        return static_cast<uint32>(_mm_extract_epi32(m_value, 1));
+#else
         return m_u32[1];
+#endif
     }
 
     uint32 UVec4Reg::GetZ() const
     {
+#if defined (NES_USE_SSE4_1)
+        return static_cast<uint32>(_mm_extract_epi32(m_value, 2));
+#else
         return m_u32[2];
+#endif
     }
 
     uint32 UVec4Reg::GetW() const
     {
+#if defined (NES_USE_SSE4_1)
+        return static_cast<uint32>(_mm_extract_epi32(m_value, 3));
+#else
         return m_u32[3];
+#endif
     }
 
     template <uint32 SwizzleX, uint32 SwizzleY, uint32 SwizzleZ, uint32 SwizzleW>
@@ -151,10 +167,10 @@ namespace nes
     #else
         return Vec4Reg
         (
-            static_cast<float>(m_u32[0]),
-            static_cast<float>(m_u32[1]),
-            static_cast<float>(m_u32[2]),
-            static_cast<float>(m_u32[3])
+            static_cast<float>(static_cast<int32>(m_u32[0])),
+            static_cast<float>(static_cast<int32>(m_u32[1])),
+            static_cast<float>(static_cast<int32>(m_u32[2])),
+            static_cast<float>(static_cast<int32>(m_u32[3]))
         );
     #endif
     }
@@ -311,10 +327,14 @@ namespace nes
         return _mm_shuffle_epi8(m_value, *reinterpret_cast<const UVec4Reg::Type*>(kFourMinusXShuffle[count]));
     #else
         UVec4Reg result;
-        for (int i = 0; i < 4; ++i)
+        for (int i = 0; i < count; ++i)
         {
             result.m_u32[i] = m_u32[i + 4 - count];
         }
+        for (int i = count; i < 4; ++i)
+        {
+            result.m_u32[i] = 0;
+        }
         return result;
     #endif
         
@@ -348,7 +368,7 @@ namespace nes
     #else
         return UVec4Reg
         (
-            *pValues, 0, 0, 0
+            *pValue, 0, 0, 0
         );
     #endif
     }
@@ -391,7 +411,7 @@ namespace nes
 
     UVec4Reg UVec4Reg::Min(const UVec4Reg& a, const UVec4Reg& b)
     {
-    #if defined (NES_USE_SSE)
+    #if defined (NES_USE_SSE4_1)
         return _mm_min_epu32(a.m_value, b.m_value);
     #else
         return UVec4Reg
@@ -406,7 +426,7 @@ namespace nes
 
     UVec4Reg UVec4Reg::Max(const UVec4Reg& a, const UVec4Reg& b)
     {
-    #if defined (NES_USE_SSE)
+    #if defined (NES_USE_SSE4_1)
         return _mm_max_epu32(a.m_value, b.m_value);
     #else
         return UVec4Reg
@@ -496,7 +516,9 @@ namespace nes
 
     UVec4Reg UVec4Reg::Select(const UVec4Reg& notSet, const UVec4Reg& set, const UVec4Reg& mask)
     {
-    #if defined (NES_USE_SSE)
+    #if defined (NES_USE_SSE4_1)
+        return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(notSet.m_value), _mm_castsi128_ps(set.m_value), _mm_castsi128_ps(mask.m_value)));
+    #elif defined (NES_USE_SSE)
         const __m128 isSet = _mm_castsi128_ps(_mm_srai_epi32(mask.m_value, 31));
         return _mm_castps_si128(_mm_or_ps(_mm_and_ps(isSet, _mm_castsi128_ps(set.m_value)), _mm_andnot_ps(isSet, _mm_castsi128_ps(notSet.m_value))));
     #else
@@ -527,5 +549,16 @@ namespace nes
     {
         identifiers = UVec4Reg::Sort4True(value, identifiers);
         return value.CountTrues();
-    }  
+    }
+
+#if defined (NES_USE_SSE) && !defined (NES_USE_SSE4_1)
+    UVec4Reg::Type UVec4Reg::MultiplyLowSSE2(const Type a, const Type b)
+    {
+        // SSE2 only has a 32x32 -> 64 bit multiply for the even lanes. Multiply the even and odd lanes separately,
+        // then interleave the low 32 bits of each result back together.
+        const Type evenProducts = _mm_mul_epu32(a, b);
+        const Type oddProducts = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(evenProducts, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(oddProducts, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+#endif
 }
\ No newline at end of file
@@ -63,7 +63,7 @@ namespace nes
         NES_INLINE Vec4Reg&         operator+=(const Vec4Reg& other);
         NES_INLINE Vec4Reg          operator-(const Vec4Reg& other) const;
         NES_INLINE Vec4Reg&         operator-=(const Vec4Reg& other);
-        NES_INLINE Vec4Reg          operator-() const;
+        NES_INLINE Vec4Reg          operator-() const;                                      // Subtracts from zero on every path, so -(+0) is +0.
 
         /// Get individual components
         NES_INLINE float            GetX() const;
@@ -148,16 +148,19 @@ namespace nes
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Return the dot product stored across each component of the result vector.   
+        /// @note : The products are summed as (x + y) + (z + w) on every path, like _mm_dp_ps.
         //----------------------------------------------------------------------------------------------------
         NES_INLINE Vec4Reg          DotV(const Vec4Reg& other) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Return the dot product between this and another vector.
+        /// @note : The products are summed as (x + y) + (z + w) on every path, like _mm_dp_ps.
         //----------------------------------------------------------------------------------------------------
         NES_INLINE float            Dot(const Vec4Reg& other) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Returns the squared length (magnitude) of the vector. 
+        /// @note : The squares are summed as (x + y) + (z + w) on every path, like _mm_dp_ps.
         //----------------------------------------------------------------------------------------------------
         NES_INLINE float            LengthSqr() const;
 
@@ -361,7 +364,9 @@ namespace nes
         static NES_INLINE UVec4Reg  GreaterOrEqual(const Vec4Reg& left, const Vec4Reg& right);
 
         //----------------------------------------------------------------------------------------------------
-        /// @brief : Calculates mul1 * mul2 + add.
+        /// @brief : Calculates mul1 * mul2 + add. With NES_USE_FMADD this rounds once instead of twice, so the
+        ///     result can differ from the scalar path in the last bit. Use separate operations where the result
+        ///     must be equal on all instruction sets.
         //----------------------------------------------------------------------------------------------------
         static NES_INLINE Vec4Reg   FusedMultiplyAdd(const Vec4Reg& mul1, const Vec4Reg& mul2, const Vec4Reg& add);
 
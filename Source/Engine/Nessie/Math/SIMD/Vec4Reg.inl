@@ -280,23 +280,14 @@ namespace nes
     #if defined(NES_USE_SSE)
         return _mm_sub_ps(_mm_setzero_ps(), m_value);
     #else
-        #ifdef NES_CROSS_PLATFORM_DETERMINISTIC
-            return Vec4Reg
-            (
-                0.f - m_f32[0],
-                0.f - m_f32[1],
-                0.f - m_f32[2],
-                0.f - m_f32[3]
-            );
-        #else
-            return Vec4Reg
-            (
-                -m_f32[0],
-                -m_f32[1],
-                -m_f32[2],
-                -m_f32[3]
-            );
-        #endif
+        // Subtract from zero like the SSE path, so that negating +0 returns +0 for both.
+        return Vec4Reg
+        (
+            0.f - m_f32[0],
+            0.f - m_f32[1],
+            0.f - m_f32[2],
+            0.f - m_f32[3]
+        );
     #endif
     }
 
@@ -311,27 +302,45 @@ namespace nes
 
     float Vec4Reg::GetY() const
     {
+    #if defined(NES_USE_SSE)
+        return _mm_cvtss_f32(_mm_shuffle_ps(m_value, m_value, _MM_SHUFFLE(1, 1, 1, 1)));
+    #else
         return m_f32[1];
+    #endif
     }
 
     float Vec4Reg::GetZ() const
     {
+    #if defined(NES_USE_SSE)
+        return _mm_cvtss_f32(_mm_shuffle_ps(m_value, m_value, _MM_SHUFFLE(2, 2, 2, 2)));
+    #else
         return m_f32[2];
+    #endif
     }
 
     float Vec4Reg::GetW() const
     {
+    #if defined(NES_USE_SSE)
+        return _mm_cvtss_f32(_mm_shuffle_ps(m_value, m_value, _MM_SHUFFLE(3, 3, 3, 3)));
+    #else
         return m_f32[3];
+    #endif
     }
     
     Vec3 Vec4Reg::ToVec3() const
     {
-        return Vec3(m_f32[0], m_f32[1], m_f32[2]);
+        return Vec3(GetX(), GetY(), GetZ());
     }
 
     Vec4 Vec4Reg::ToVec4() const
     {
+    #if defined(NES_USE_SSE)
+        Vec4 result;
+        _mm_storeu_ps(&result.x, m_value);
+        return result;
+    #else
         return Vec4(m_f32[0], m_f32[1], m_f32[2], m_f32[3]);
+    #endif
     }
 
     Vec4Reg Vec4Reg::Zero()
@@ -659,9 +668,10 @@ namespace nes
     #if defined (NES_USE_AVX512)
         return _mm_range_ps(m_value, m_value, 0b1000);
     #elif defined(NES_USE_SSE)
-        return _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), m_value), m_value);
+        // Clear the sign bit, so that -0 returns +0.
+        return _mm_and_ps(m_value, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
     #else
-        return Vec4Reg(math::Abs(m_f32[0]), math::Abs(m_f32[1]), math::Abs(m_f32[2]), math::Abs(m_f32[3]));
+        return Vec4Reg(std::fabs(m_f32[0]), std::fabs(m_f32[1]), std::fabs(m_f32[2]), std::fabs(m_f32[3]));
     #endif
     }
 
@@ -670,11 +680,8 @@ namespace nes
     #if defined(NES_USE_SSE4_1)
         return _mm_dp_ps(m_value, other.m_value, 0xff);
     #else
-        float dot = 0.f;
-        for (int i = 0; i < 4; i++)
-        {
-            dot += m_f32[i] * other.m_f32[i];
-        }
+        // Same summation order as _mm_dp_ps: (x + y) + (z + w).
+        const float dot = (m_f32[0] * other.m_f32[0] + m_f32[1] * other.m_f32[1]) + (m_f32[2] * other.m_f32[2] + m_f32[3] * other.m_f32[3]);
         return Vec4Reg::Replicate(dot);
     #endif
     }
@@ -684,12 +691,8 @@ namespace nes
     #if defined(NES_USE_SSE4_1)
         return _mm_cvtss_f32(_mm_dp_ps(m_value, other.m_value, 0xff));
     #else
-        float dot = 0.f;
-        for (int i = 0; i < 4; i++)
-        {
-            dot += m_f32[i] * other.m_f32[i];
-        }
-        return dot;
+        // Same summation order as _mm_dp_ps: (x + y) + (z + w).
+        return (m_f32[0] * other.m_f32[0] + m_f32[1] * other.m_f32[1]) + (m_f32[2] * other.m_f32[2] + m_f32[3] * other.m_f32[3]);
     #endif
     }
 
@@ -762,12 +765,8 @@ namespace nes
     #if defined(NES_USE_SSE4_1)
         return _mm_cvtss_f32(_mm_dp_ps(m_value, m_value, 0xff));
     #else
-        float lengthSqr = 0.f;
-        for (int i = 0; i < 4; i++)
-        {
-            lengthSqr += m_f32[i] * m_f32[i];
-        }
-        return lengthSqr;
+        // Same summation order as _mm_dp_ps: (x + y) + (z + w).
+        return (m_f32[0] * m_f32[0] + m_f32[1] * m_f32[1]) + (m_f32[2] * m_f32[2] + m_f32[3] * m_f32[3]);
     #endif
     }
 
@@ -782,7 +781,7 @@ namespace nes
 
     Vec4Reg Vec4Reg::Normalized() const
     {
-    #if defined(NES_USE_SSE)
+    #if defined(NES_USE_SSE4_1)
         return _mm_div_ps(m_value, _mm_sqrt_ps(_mm_dp_ps(m_value, m_value, 0xff)));
     #else
         return *this / Length();
@@ -792,7 +791,9 @@ namespace nes
     void Vec4Reg::StoreFloat4(Float4* pOutFloats) const
     {
     #if defined(NES_USE_SSE)
-        _mm_store_ps(&pOutFloats->x, m_value);
+        // Float4 is not guaranteed to be 16 byte aligned (e.g., when storing into a float array), so this
+        // has to be an unaligned store to match LoadFloat4().
+        _mm_storeu_ps(&pOutFloats->x, m_value);
     #else
         pOutFloats->x = m_f32[0];
         pOutFloats->y = m_f32[1];
@@ -1,6 +1,8 @@
 ﻿// Body.cpp
 #include "Body.h"
+#include "Nessie/Math/QuatSIMD.h"
 #include "Nessie/Physics/Collision/Shapes/EmptyShape.h"
+#include "Nessie/Physics/StateRecorder.h"
 
 namespace nes
 {
@@ -10,7 +12,7 @@ namespace nes
     Body Body::s_fixedToWorld(false);
     
     Body::Body(bool)
-        : m_position(Vec3::Zero())
+        : m_position(RVec3::Zero())
         , m_rotation(Quat::Identity())
         , m_pShape(&s_fixedToWorldShape)
         , m_friction(0.f)
@@ -67,17 +69,17 @@ namespace nes
             ResetSleepTimer();
     }
 
-    void Body::MoveKinematic(const Vec3& targetPosition, const Quat& targetRotation, const float deltaTime)
+    void Body::MoveKinematic(const RVec3& targetPosition, const Quat& targetRotation, const float deltaTime)
     {
         NES_ASSERT(IsRigidBody());
         NES_ASSERT(!IsStatic());
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::Read));
 
         // Calculate the center of mass at the end situation
-        const Vec3 newCOM = targetPosition + (targetRotation * m_pShape->GetCenterOfMass());
+        const RVec3 newCOM = targetPosition + (targetRotation * m_pShape->GetCenterOfMass());
         
         // Calculate the delta position and rotation
-        const Vec3 deltaPos = newCOM - m_position;
+        const Vec3 deltaPos = Vec3(newCOM - m_position);
         const Quat deltaRot = targetRotation * m_rotation.Conjugate();
 
         // Move the Body
@@ -116,6 +118,7 @@ namespace nes
         result.m_gravityScale = m_pMotionProperties != nullptr ? m_pMotionProperties->GetGravityScale() : 1.0f;
         result.m_numVelocityStepsOverride = m_pMotionProperties != nullptr ? m_pMotionProperties->GetNumVelocityStepsOverride() : 0;
         result.m_numPositionStepsOverride = m_pMotionProperties != nullptr ? m_pMotionProperties->GetNumPositionStepsOverride() : 0;
+        result.m_simulationRegion = m_pMotionProperties != nullptr ? m_pMotionProperties->GetSimulationRegion() : 0;
         result.m_overrideMassProperties = EOverrideMassProperties::MassAndInertiaProvided;
 
         // Invert inertia and mass
@@ -154,12 +157,74 @@ namespace nes
         return result;
     }
 
+    void Body::SaveState(StateRecorder& stream) const
+    {
+        stream.Write(m_position);
+        stream.Write(m_rotation);
+
+        if (m_pMotionProperties != nullptr)
+            m_pMotionProperties->SaveState(stream);
+    }
+
+    void Body::RestoreState(StateRecorder& stream)
+    {
+        stream.Read(m_position);
+        stream.Read(m_rotation);
+
+        if (m_pMotionProperties != nullptr)
+            m_pMotionProperties->RestoreState(stream);
+
+        Internal_CalculateWorldSpaceBounds();
+    }
+
     void Body::Internal_CalculateWorldSpaceBounds()
     {
         m_bounds = m_pShape->GetWorldBounds(GetCenterOfMassTransform(), Vec3::One());
     }
 
-    void Body::Internal_SetPositionAndRotation(const Vec3& position, const Quat& rotation, bool resetSleepTimer)
+    void Body::Internal_AddRotationStep4(Body* const* ppBodies, const Vec3* pAngularVelocityTimesDeltaTime, const uint32_t numBodies)
+    {
+        NES_ASSERT(numBodies > 0 && numBodies <= 4);
+        NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::ReadWrite));
+
+        // Lanes without a body repeat the first body, their results are not stored.
+        uint32_t laneIndex[4];
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            laneIndex[i] = i < numBodies? i : 0;
+            NES_ASSERT(ppBodies[laneIndex[i]]->IsRigidBody());
+        }
+
+        // Transpose, so that column i of each matrix holds component i of all 4 bodies.
+        const Mat44 step = Mat44(Vec4Reg(pAngularVelocityTimesDeltaTime[laneIndex[0]], 0.f), Vec4Reg(pAngularVelocityTimesDeltaTime[laneIndex[1]], 0.f), Vec4Reg(pAngularVelocityTimesDeltaTime[laneIndex[2]], 0.f), Vec4Reg(pAngularVelocityTimesDeltaTime[laneIndex[3]], 0.f)).Transposed();
+        const Mat44 rotation = Mat44(Vec4Reg::LoadVec4(&ppBodies[laneIndex[0]]->m_rotation.m_value), Vec4Reg::LoadVec4(&ppBodies[laneIndex[1]]->m_rotation.m_value), Vec4Reg::LoadVec4(&ppBodies[laneIndex[2]]->m_rotation.m_value), Vec4Reg::LoadVec4(&ppBodies[laneIndex[3]]->m_rotation.m_value)).Transposed();
+
+        // See Internal_AddRotationStep(): rotate by a quaternion made from the axis and angle of the step, and
+        // normalize. Bodies that rotate less than the threshold keep their rotation. The length is kept away from
+        // zero so that those lanes don't divide by zero.
+        const Vec4Reg length = (step[0] * step[0] + step[1] * step[1] + step[2] * step[2]).Sqrt();
+        const UVec4Reg shouldRotate = Vec4Reg::Greater(length, Vec4Reg::Replicate(1.0e-6f));
+        const Vec4Reg safeLength = Vec4Reg::Max(length, Vec4Reg::Replicate(1.0e-6f));
+
+        Vec4Reg sin, cos;
+        (0.5f * length).SinCos(sin, cos);
+        const Vec4Reg sinOverLength = sin / safeLength;
+        const Vec4Reg delta[4] = { step[0] * sinOverLength, step[1] * sinOverLength, step[2] * sinOverLength, cos };
+
+        Vec4Reg newRotation[4] = { rotation[0], rotation[1], rotation[2], rotation[3] };
+        math::Quat4Multiply(delta, newRotation, newRotation);
+        math::Quat4Normalize(newRotation);
+
+        // Transpose back and store the rotations of the bodies.
+        const Mat44 result = Mat44(Vec4Reg::Select(rotation[0], newRotation[0], shouldRotate), Vec4Reg::Select(rotation[1], newRotation[1], shouldRotate), Vec4Reg::Select(rotation[2], newRotation[2], shouldRotate), Vec4Reg::Select(rotation[3], newRotation[3], shouldRotate)).Transposed();
+        for (uint32_t i = 0; i < numBodies; ++i)
+        {
+            ppBodies[i]->m_rotation = Quat(result[i].ToVec4());
+            NES_ASSERT(!ppBodies[i]->m_rotation.IsNaN());
+        }
+    }
+
+    void Body::Internal_SetPositionAndRotation(const RVec3& position, const Quat& rotation, bool resetSleepTimer)
     {
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::ReadWrite));
 
@@ -209,18 +274,24 @@ namespace nes
             return ECanSleep::CannotSleep;
 
         // Get the points to test
-        Vec3 points[3];
+        RVec3 points[3];
         GetSleepTestPoints(points);
 
-        // [TODO]: If double precision, Get the bass offset for spheres  
+    #ifdef NES_DOUBLE_PRECISION
+        // Get the base offset for the spheres
+        const DVec3 offset = m_pMotionProperties->m_sleepTestOffset;
+    #endif
 
         for (int i = 0; i < 3; ++i)
         {
             Sphere& sphere = m_pMotionProperties->m_sleepTestSpheres[i];
 
             // Make point relative to base offset
-            // [TODO]: If double precision, Subtract bass offset 
+        #ifdef NES_DOUBLE_PRECISION
+            Vec3 point = Vec3(points[i] - offset);
+        #else
             Vec3 point = points[i];
+        #endif
 
             // Encapsulate point in a sphere
             sphere.Encapsulate(point);
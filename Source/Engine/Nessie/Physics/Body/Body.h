@@ -11,6 +11,7 @@
 namespace nes
 {
     class Shape;
+    class StateRecorder;
     
     //----------------------------------------------------------------------------------------------------
     //		NOTES:
@@ -22,6 +23,7 @@ namespace nes
     {
         friend class BodyManager;
         friend class BodyWithMotionProperties;
+        template <typename ObjectType> friend class FixedSizeFreeList;
 
     public:
         enum class EFlags : uint8_t
@@ -33,6 +35,7 @@ namespace nes
             UseManifoldReduction            = math::BitVal(4), /// Set this bit to indicate that this body can use manifold reduction.
             ApplyGyroscopicForce            = math::BitVal(5), /// Set this bit to indicate that the gyroscopic force should be applied to this Body (AKA Dzhanibekov effect, see https://en.wikipedia.org/wiki/Tennis_racket_theorem)
             EnhancedInternalEdgeRemoval     = math::BitVal(6), /// Set this bit to indicate that enhance internal edge removal should be used for this Body
+            AllocatedFromPool               = math::BitVal(7), /// Set by the BodyManager when the Body was allocated from one of its pools, instead of the heap.
         };
 
         static constexpr uint32_t kInactiveIndex = MotionProperties::kInactiveIndex;
@@ -58,7 +61,7 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get this body's current world position. 
         //----------------------------------------------------------------------------------------------------
-        Vec3                    GetPosition() const                                     { return m_position; }
+        RVec3                   GetPosition() const                                     { return m_position; }
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get this body's current world rotation. 
@@ -127,9 +130,17 @@ namespace nes
         inline bool             IsSoftBody() const                                      { /*Ignoring Soft Body Collision for now.*/ return false; }
 
         //----------------------------------------------------------------------------------------------------
-        /// @brief : Check whether this body is currently simulating (true) or sleeping (false). 
+        /// @brief : Check whether this body is currently simulating (true) or sleeping (false). A body that is
+        ///     frozen for the current update because its simulation region is skipped is still active, see
+        ///     IsSimulationSkipped().
         //----------------------------------------------------------------------------------------------------
-        bool                    IsActive() const                                        { return m_pMotionProperties != nullptr && m_pMotionProperties->m_indexInActiveBodies != kInactiveIndex; }
+        bool                    IsActive() const                                        { return m_pMotionProperties != nullptr && (m_pMotionProperties->m_indexInActiveBodies != kInactiveIndex || m_pMotionProperties->m_isSimulationSkipped); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check whether this active body is frozen for the current update, because its simulation
+        ///     region is not simulated in it. Only true during PhysicsScene::Update(). See SimulationRegionSettings.
+        //----------------------------------------------------------------------------------------------------
+        bool                    IsSimulationSkipped() const                             { return m_pMotionProperties != nullptr && m_pMotionProperties->m_isSimulationSkipped; }
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the body's motion type. Static, Kinematic or Dynamic.
@@ -157,6 +168,9 @@ namespace nes
         ///     sensor will never go to sleep automatically. When you make a Dynamcic or Kinematic sensor, make
         ///     sure that it is in a Collision Layer that does not collide with Static bodies or other sensors to
         ///     avoid extra overhead in the broadphase.
+        ///     Sensor pairs only run an overlap test that stops at the first hit, and never create contact
+        ///     manifolds or contact constraints. The contact listener receives one contact per body pair, with
+        ///     a single contact point.
         //----------------------------------------------------------------------------------------------------
         inline void             SetIsSensor(const bool isSensor);
         
@@ -314,7 +328,7 @@ namespace nes
         /// @brief : Returns the velocity of point (in world space, e.g. on the surface of the body)
         ///         of the body (unit: m/s).
         //----------------------------------------------------------------------------------------------------
-        inline Vec3             GetPointVelocity(const Vec3& point) const;
+        inline Vec3             GetPointVelocity(const RVec3& point) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Add force (unit: N) at the center of mass for the next time step. This will be reset after
@@ -328,7 +342,7 @@ namespace nes
         ///     to PhysicsSystem::Update().
         ///     If you want the body to wake up when it is sleeping, use BodyInterface::AddForce instead.
         //----------------------------------------------------------------------------------------------------
-        inline void             AddForce(const Vec3& force, const Vec3& position);
+        inline void             AddForce(const Vec3& force, const RVec3& position);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the total amount of force applied to the center of mass this time step (through AddForce()
@@ -359,7 +373,7 @@ namespace nes
         /// @brief : Add an impulse to "position" in world space (unit: kg m/s).
         ///     If you want the body to wake up when it is sleeping, use BodyInterface::AddImpulse instead.
         //----------------------------------------------------------------------------------------------------
-        inline void             AddImpulse(const Vec3& impulse, const Vec3& position);
+        inline void             AddImpulse(const Vec3& impulse, const RVec3& position);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Add angular impulse to this body in world space (unit: N m s).
@@ -393,7 +407,7 @@ namespace nes
         /// @brief : Set the velocity of the Body such that it will be positioned at targetPosition/targetRotation
         ///     in deltaTime seconds.
         //----------------------------------------------------------------------------------------------------
-        void                    MoveKinematic(const Vec3& targetPosition, const Quat& targetRotation, float deltaTime);
+        void                    MoveKinematic(const RVec3& targetPosition, const Quat& targetRotation, float deltaTime);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Check to see if this Body has been added to the physics system. 
@@ -414,22 +428,22 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Calculates the world transform for this body.
         //----------------------------------------------------------------------------------------------------
-        inline Mat44            GetWorldTransform() const;
+        inline RMat44           GetWorldTransform() const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the world space position of this body's center of mass. 
         //----------------------------------------------------------------------------------------------------
-        inline Vec3             GetCenterOfMassPosition() const;
+        inline RVec3            GetCenterOfMassPosition() const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get Calculates the world space transform for this body's center of mass. 
         //----------------------------------------------------------------------------------------------------
-        inline Mat44            GetCenterOfMassTransform() const;
+        inline RMat44           GetCenterOfMassTransform() const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Calculates the inverse of the transform for this body's center of mass. 
         //----------------------------------------------------------------------------------------------------
-        inline Mat44            GetInverseCenterOfMassTransform() const;
+        inline RMat44           GetInverseCenterOfMassTransform() const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the motion properties of this Body. This is only valid if the Body is not Static.
@@ -465,7 +479,7 @@ namespace nes
         /// @brief : Get the surface normal of a particular sub shape and its world space surface position on
         ///     the body.
         //----------------------------------------------------------------------------------------------------
-        inline Vec3             GetWorldSpaceSurfaceNormal(const SubShapeID& subShapeID, const Vec3& position) const;
+        inline Vec3             GetWorldSpaceSurfaceNormal(const SubShapeID& subShapeID, const RVec3& position) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the transformed shape of the body, which can be used to do collision detection outside
@@ -479,6 +493,17 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         BodyCreateInfo          GetBodyCreateInfo() const;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the state of the body (position, rotation and the state of the motion properties).
+        //----------------------------------------------------------------------------------------------------
+        void                    SaveState(StateRecorder& stream) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the state of the body that was saved with SaveState(). This updates the world space
+        ///     bounds, but does not notify the broadphase.
+        //----------------------------------------------------------------------------------------------------
+        void                    RestoreState(StateRecorder& stream);
+
         // [TODO]: SoftBody version of above.
         
         //----------------------------------------------------------------------------------------------------
@@ -507,6 +532,12 @@ namespace nes
         /// @brief : Subtract rotation using an Euler step (used during position integrate & constraint solving).
         //----------------------------------------------------------------------------------------------------
         inline void             Internal_SubRotationStep(const Vec3& angularVelocityTimesDeltaTime);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Same as Internal_AddRotationStep(), for up to 4 bodies at once. The rotations are transposed
+        ///     into registers that each hold one component of all 4 bodies.
+        //----------------------------------------------------------------------------------------------------
+        static void             Internal_AddRotationStep4(Body* const* ppBodies, const Vec3* pAngularVelocityTimesDeltaTime, const uint32_t numBodies);
         
         //----------------------------------------------------------------------------------------------------
         /// @brief : Set whether this Body is in the Broadphase.
@@ -534,7 +565,7 @@ namespace nes
         /// @brief : Function to update body's position (should only be called by the BodyInterface since it
         ///     also requires updating the broadphase)
         //----------------------------------------------------------------------------------------------------
-        void                    Internal_SetPositionAndRotation(const Vec3& position, const Quat& rotation, bool resetSleepTimer = true);
+        void                    Internal_SetPositionAndRotation(const RVec3& position, const Quat& rotation, bool resetSleepTimer = true);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Updates the center of mass and optionally mass properties after shifting the center of mass
@@ -557,6 +588,12 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         uint32_t                Internal_GetIndexInActiveBodies() const     { return m_pMotionProperties != nullptr ? m_pMotionProperties->m_indexInActiveBodies : kInactiveIndex; }
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if the body is in the BodyManager::m_activeBodies array, and is simulated in the current
+        ///     update. Unlike IsActive(), this is false for a body that is frozen by its simulation region.
+        //----------------------------------------------------------------------------------------------------
+        bool                    Internal_IsInActiveBodies() const           { return Internal_GetIndexInActiveBodies() != kInactiveIndex; }
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Update eligibility for sleeping. 
         //----------------------------------------------------------------------------------------------------
@@ -569,11 +606,11 @@ namespace nes
     private:
         inline void             SetFlag(const EFlags flag, bool set);
         inline bool             GetFlag(const EFlags flag) const;
-        inline void             GetSleepTestPoints(Vec3* outPoints) const;
+        inline void             GetSleepTestPoints(RVec3* outPoints) const;
 
     private:
         // 16 byte aligned
-        Vec3                    m_position;                                 /// World space position of center of mass (COM).
+        RVec3                   m_position;                                 /// World space position of center of mass (COM).
         Quat                    m_rotation;                                 /// World space rotation of center of mass (COM).
         AABox                   m_bounds;                                   /// World space bounding box of the body.
 
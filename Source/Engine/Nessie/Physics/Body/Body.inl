@@ -53,7 +53,7 @@ namespace nes
 
     void Body::ResetSleepTimer()
     {
-        Vec3 points[3];
+        RVec3 points[3];
         GetSleepTestPoints(points);
         m_pMotionProperties->Internal_ResetSleepTestSpheres(points);
     }
@@ -97,10 +97,10 @@ namespace nes
         return !IsStatic()? m_pMotionProperties->GetPointVelocityCOM(pointRelativeToCOM) : Vec3::Zero();
     }
 
-    Vec3 Body::GetPointVelocity(const Vec3& point) const
+    Vec3 Body::GetPointVelocity(const RVec3& point) const
     {
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::Read));
-        return GetPointVelocityCOM(point - m_position);
+        return GetPointVelocityCOM(Vec3(point - m_position));
     }
 
     void Body::AddForce(const Vec3& force)
@@ -110,7 +110,7 @@ namespace nes
         m_pMotionProperties->m_force += force;
     }
 
-    void Body::AddForce(const Vec3& force, const Vec3& position)
+    void Body::AddForce(const Vec3& force, const RVec3& position)
     {
         AddForce(force);
         AddTorque(Vec3(position - m_position).Cross(force));
@@ -141,7 +141,7 @@ namespace nes
         SetLinearVelocityClamped(m_pMotionProperties->GetLinearVelocity() + impulse * m_pMotionProperties->GetInverseMass());
     }
 
-    void Body::AddImpulse(const Vec3& impulse, const Vec3& position)
+    void Body::AddImpulse(const Vec3& impulse, const RVec3& position)
     {
         NES_ASSERT(IsDynamic());
         SetLinearVelocityClamped(m_pMotionProperties->GetLinearVelocity() + impulse * m_pMotionProperties->GetInverseMass());
@@ -178,28 +178,28 @@ namespace nes
         return GetMotionProperties()->GetInverseInertiaForRotation(Mat44::MakeRotation(m_rotation));
     }
 
-    Mat44 Body::GetWorldTransform() const
+    RMat44 Body::GetWorldTransform() const
     {
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::Read));
-        return Mat44::MakeRotationTranslation(m_rotation, m_position).PreTranslated(-m_pShape->GetCenterOfMass());
+        return RMat44::MakeRotationTranslation(m_rotation, m_position).PreTranslated(-m_pShape->GetCenterOfMass());
     }
 
-    Vec3 Body::GetCenterOfMassPosition() const
+    RVec3 Body::GetCenterOfMassPosition() const
     {
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::Read));
         return m_position;
     }
 
-    Mat44 Body::GetCenterOfMassTransform() const
+    RMat44 Body::GetCenterOfMassTransform() const
     {
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::Read));
-        return Mat44::MakeRotationTranslation(m_rotation, m_position);
+        return RMat44::MakeRotationTranslation(m_rotation, m_position);
     }
 
-    Mat44 Body::GetInverseCenterOfMassTransform() const
+    RMat44 Body::GetInverseCenterOfMassTransform() const
     {
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::Read));
-        return Mat44::MakeInverseRotationTranslation(m_rotation, m_position);
+        return RMat44::MakeInverseRotationTranslation(m_rotation, m_position);
     }
 
     const MotionProperties* Body::GetMotionProperties() const
@@ -214,9 +214,9 @@ namespace nes
         return m_pMotionProperties;
     }
 
-    Vec3 Body::GetWorldSpaceSurfaceNormal(const SubShapeID& subShapeID, const Vec3& position) const
+    Vec3 Body::GetWorldSpaceSurfaceNormal(const SubShapeID& subShapeID, const RVec3& position) const
     {
-        const Mat44 inverseCOM = GetInverseCenterOfMassTransform();
+        const RMat44 inverseCOM = GetInverseCenterOfMassTransform();
         return inverseCOM.Multiply3x3Transposed(m_pShape->GetSurfaceNormal(subShapeID, Vec3(inverseCOM.TransformPoint(position)))).Normalized();
     }
 
@@ -372,7 +372,7 @@ namespace nes
         return (m_flags.load(std::memory_order_relaxed) & static_cast<uint8_t>(flag)) != 0;
     }
 
-    void Body::GetSleepTestPoints(Vec3* outPoints) const
+    void Body::GetSleepTestPoints(RVec3* outPoints) const
     {
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetPositionAccess(), BodyAccess::EAccess::Read));
 
@@ -23,7 +23,7 @@ namespace nes
     //----------------------------------------------------------------------------------------------------
     struct BodyCreateInfo
     {
-        Vec3                    m_position                      = Vec3::Zero();                      /// Position of the body (not center of mass).
+        RVec3                   m_position                      = RVec3::Zero();                     /// Position of the body (not center of mass).
         Quat                    m_rotation                      = Quat::Identity();                     /// Rotation of the body
         Vec3                    m_linearVelocity                = Vec3::Zero();                      /// World space linear velocity of the center of mass (m/s). 
         Vec3                    m_angularVelocity               = Vec3::Zero();                      /// World space angular velocity (rad/s).
@@ -45,6 +45,7 @@ namespace nes
         float                   m_angularDamping                = 0.05f;                                /// Angular damping: dw/dt = -c * w. c must be between 0 and 1 but is usually close to 0.
         uint32_t                m_numVelocityStepsOverride      = 0;                                    /// Used only when this body is dynamic and colliding. Override for the number of solver velocity iterations to run, 0 means use the default in PhysicsSettings::mNumVelocitySteps. The number of iterations to use is the max of all contacts and constraints in the island.
         uint32_t                m_numPositionStepsOverride      = 0;                                    /// Used only when this body is dynamic and colliding. Override for the number of solver position iterations to run, 0 means use the default in PhysicsSettings::mNumPositionSteps. The number of iterations to use is the max of all contacts and constraints in the island.
+        uint32_t                m_simulationRegion              = 0;                                    /// Simulation region of the body, which determines how often it is simulated. See SimulationRegionSettings.
         bool                    m_isSensor                      = false;                                /// If this body is a sensor. A sensor will receive collision callbacks, but will not cause any collision responses and can be used as a trigger volume. See description at Body::SetIsSensor.
         bool                    m_allowSleeping                 = true;                                 /// If this body can go to sleep or not.
         bool                    m_allowDynamicOrKinematic       = false;                                /// When this body is created as static, this setting tells the system to create a MotionProperties object so that the object can be switched to kinematic or dynamic.
@@ -319,7 +319,7 @@ namespace nes
         return kInvalidCollisionLayer;
     }
 
-    void BodyInterface::SetPositionAndRotation(const BodyID& bodyID, const Vec3& position, const Quat& rotation,
+    void BodyInterface::SetPositionAndRotation(const BodyID& bodyID, const RVec3& position, const Quat& rotation,
         EBodyActivationMode activationMode)
     {
         BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
@@ -343,7 +343,7 @@ namespace nes
         }
     }
 
-    void BodyInterface::SetPositionAndRotationWhenChanged(const BodyID& bodyID, const Vec3& position,
+    void BodyInterface::SetPositionAndRotationWhenChanged(const BodyID& bodyID, const RVec3& position,
         const Quat& rotation, EBodyActivationMode activationMode)
     {
         BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
@@ -371,7 +371,7 @@ namespace nes
         }
     }
 
-    void BodyInterface::GetPositionAndRotation(const BodyID& bodyID, Vec3& outPosition, Quat& outRotation) const
+    void BodyInterface::GetPositionAndRotation(const BodyID& bodyID, RVec3& outPosition, Quat& outRotation) const
     {
         BodyLockRead lock(*m_pBodyLockInterface, bodyID);
         if (lock.Succeeded())
@@ -382,12 +382,12 @@ namespace nes
         }
         else
         {
-            outPosition = Vec3::Zero();
+            outPosition = RVec3::Zero();
             outRotation = Quat::Identity();
         }
     }
 
-    void BodyInterface::SetPosition(const BodyID& bodyID, const Vec3& position, EBodyActivationMode activationMode)
+    void BodyInterface::SetPosition(const BodyID& bodyID, const RVec3& position, EBodyActivationMode activationMode)
     {
         BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
         if (lock.Succeeded())
@@ -409,22 +409,22 @@ namespace nes
         }
     }
 
-    Vec3 BodyInterface::GetPosition(const BodyID& bodyID) const
+    RVec3 BodyInterface::GetPosition(const BodyID& bodyID) const
     {
         BodyLockRead lock(*m_pBodyLockInterface, bodyID);
         if (lock.Succeeded())
             return lock.GetBody().GetPosition();
         
-        return Vec3::Zero();
+        return RVec3::Zero();
     }
 
-    Vec3 BodyInterface::GetCenterOfMassPosition(const BodyID& bodyID) const
+    RVec3 BodyInterface::GetCenterOfMassPosition(const BodyID& bodyID) const
     {
         BodyLockRead lock(*m_pBodyLockInterface, bodyID);
         if (lock.Succeeded())
             return lock.GetBody().GetCenterOfMassPosition();
         
-        return Vec3::Zero();
+        return RVec3::Zero();
     }
 
     void BodyInterface::SetRotation(const BodyID& bodyID, const Quat& rotation, EBodyActivationMode activationMode)
@@ -458,25 +458,25 @@ namespace nes
         return Quat::Identity();
     }
 
-    Mat44 BodyInterface::GetWorldTransform(const BodyID& bodyID) const
+    RMat44 BodyInterface::GetWorldTransform(const BodyID& bodyID) const
     {
         BodyLockRead lock(*m_pBodyLockInterface, bodyID);
         if (lock.Succeeded())
             return lock.GetBody().GetWorldTransform();
         
-        return Mat44::Identity();
+        return RMat44::Identity();
     }
 
-    Mat44 BodyInterface::GetCenterOfMassTransform(const BodyID& bodyID) const
+    RMat44 BodyInterface::GetCenterOfMassTransform(const BodyID& bodyID) const
     {
         BodyLockRead lock(*m_pBodyLockInterface, bodyID);
         if (lock.Succeeded())
             return lock.GetBody().GetCenterOfMassTransform();
         
-        return Mat44::Identity();
+        return RMat44::Identity();
     }
 
-    void BodyInterface::MoveKinematic(const BodyID& bodyID, const Vec3& targetPosition, const Quat& targetRotation,
+    void BodyInterface::MoveKinematic(const BodyID& bodyID, const RVec3& targetPosition, const Quat& targetRotation,
         float deltaTime)
     {
         BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
@@ -629,7 +629,7 @@ namespace nes
         return Vec3::Zero();
     }
 
-    Vec3 BodyInterface::GetPointVelocity(const BodyID& bodyID, const Vec3& point) const
+    Vec3 BodyInterface::GetPointVelocity(const BodyID& bodyID, const RVec3& point) const
     {
         BodyLockRead lock(*m_pBodyLockInterface, bodyID);
         if (lock.Succeeded())
@@ -644,7 +644,7 @@ namespace nes
         return Vec3::Zero();
     }
 
-    void BodyInterface::SetPositionAndRotationAndVelocity(const BodyID& bodyID, const Vec3& position,
+    void BodyInterface::SetPositionAndRotationAndVelocity(const BodyID& bodyID, const RVec3& position,
         const Quat& rotation, const Vec3& linearVelocity, const Vec3& angularVelocity)
     {
         BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
@@ -690,7 +690,7 @@ namespace nes
         }
     }
 
-    void BodyInterface::AddForce(const BodyID& bodyID, const Vec3& force, const Vec3& point,
+    void BodyInterface::AddForce(const BodyID& bodyID, const Vec3& force, const RVec3& point,
         EBodyActivationMode activationMode)
     {
         BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
@@ -757,7 +757,7 @@ namespace nes
         }
     }
 
-    void BodyInterface::AddImpulse(const BodyID& bodyID, const Vec3& impulse, const Vec3& point)
+    void BodyInterface::AddImpulse(const BodyID& bodyID, const Vec3& impulse, const RVec3& point)
     {
         BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
         if (lock.Succeeded())
@@ -891,6 +891,22 @@ namespace nes
         return 1.f;
     }
 
+    void BodyInterface::SetSimulationRegion(const BodyID& bodyID, const uint32 region)
+    {
+        BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
+        if (lock.Succeeded() && lock.GetBody().GetMotionPropertiesUnchecked() != nullptr)
+            lock.GetBody().GetMotionPropertiesUnchecked()->SetSimulationRegion(region);
+    }
+
+    uint32 BodyInterface::GetSimulationRegion(const BodyID& bodyID) const
+    {
+        BodyLockRead lock(*m_pBodyLockInterface, bodyID);
+        if (lock.Succeeded() && lock.GetBody().GetMotionPropertiesUnchecked() != nullptr)
+            return lock.GetBody().GetMotionPropertiesUnchecked()->GetSimulationRegion();
+
+        return 0;
+    }
+
     void BodyInterface::SetUseManifoldReduction(const BodyID& bodyID, bool useManifoldReduction)
     {
         BodyLockWrite lock(*m_pBodyLockInterface, bodyID);
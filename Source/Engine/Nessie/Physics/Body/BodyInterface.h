@@ -5,6 +5,7 @@
 #include "MotionQuality.h"
 #include "MotionType.h"
 #include "Nessie/Core/Memory/StrongPtr.h"
+#include "Nessie/Math/Math.h"
 #include "Nessie/Physics/Collision/CollisionLayer.h"
 #include "Nessie/Physics/Collision/BroadPhase/BroadPhase.h"
 
@@ -273,34 +274,34 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Update the position and rotation of the body, and then activate the body. 
         //----------------------------------------------------------------------------------------------------
-        void                    SetPositionAndRotation(const BodyID& bodyID, const Vec3& position, const Quat& rotation, EBodyActivationMode activationMode);
+        void                    SetPositionAndRotation(const BodyID& bodyID, const RVec3& position, const Quat& rotation, EBodyActivationMode activationMode);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Will only update the position/rotation and activate the body when the difference is larger
         ///     than a very small number. This avoids updating the broadphase/waking up a body when the
         ///     resulting position/orientation doesn't really change.  
         //----------------------------------------------------------------------------------------------------
-        void                    SetPositionAndRotationWhenChanged(const BodyID& bodyID, const Vec3& position, const Quat& rotation, EBodyActivationMode activationMode);
+        void                    SetPositionAndRotationWhenChanged(const BodyID& bodyID, const RVec3& position, const Quat& rotation, EBodyActivationMode activationMode);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the current position and rotation of a body.
         //----------------------------------------------------------------------------------------------------
-        void                    GetPositionAndRotation(const BodyID& bodyID, Vec3& outPosition, Quat& outRotation) const;
+        void                    GetPositionAndRotation(const BodyID& bodyID, RVec3& outPosition, Quat& outRotation) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Update the position and activate the body. 
         //----------------------------------------------------------------------------------------------------
-        void                    SetPosition(const BodyID& bodyID, const Vec3& position, EBodyActivationMode activationMode);
+        void                    SetPosition(const BodyID& bodyID, const RVec3& position, EBodyActivationMode activationMode);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the current position of a body.
         //----------------------------------------------------------------------------------------------------
-        Vec3                    GetPosition(const BodyID& bodyID) const;
+        RVec3                   GetPosition(const BodyID& bodyID) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the current position of the body's center of mass. 
         //----------------------------------------------------------------------------------------------------
-        Vec3                    GetCenterOfMassPosition(const BodyID& bodyID) const;
+        RVec3                   GetCenterOfMassPosition(const BodyID& bodyID) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Update the rotation and activate the body. 
@@ -315,18 +316,18 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the world transform of a body. 
         //----------------------------------------------------------------------------------------------------
-        Mat44                   GetWorldTransform(const BodyID& bodyID) const;
+        RMat44                  GetWorldTransform(const BodyID& bodyID) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the world transform of a body's center of mass. 
         //----------------------------------------------------------------------------------------------------
-        Mat44                   GetCenterOfMassTransform(const BodyID& bodyID) const;
+        RMat44                  GetCenterOfMassTransform(const BodyID& bodyID) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Set the velocity of a Body such that it will be positioned at targetPosition/Rotation in
         ///     deltaTime seconds. This will activate the body if needed.
         //----------------------------------------------------------------------------------------------------
-        void                    MoveKinematic(const BodyID& bodyID, const Vec3& targetPosition, const Quat& targetRotation, float deltaTime);
+        void                    MoveKinematic(const BodyID& bodyID, const RVec3& targetPosition, const Quat& targetRotation, float deltaTime);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Set the linear and angular velocity of the body. This will activate the body if needed.
@@ -379,14 +380,14 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the velocity of a point (in world space, on the surface of the body) of the body.
         //----------------------------------------------------------------------------------------------------
-        Vec3                    GetPointVelocity(const BodyID& bodyID, const Vec3& point) const;
+        Vec3                    GetPointVelocity(const BodyID& bodyID, const RVec3& point) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Set the complete motion state of the body. 
         /// @note : The linear velocity is the velocity of the center of mass, which may not coincide with the position
         ///     of your object. To correct for this: VelocityCOM = Velocity - AngularVelocity * ShapeCOM.
         //----------------------------------------------------------------------------------------------------
-        void                    SetPositionAndRotationAndVelocity(const BodyID& bodyID, const Vec3& position, const Quat& rotation, const Vec3& linearVelocity, const Vec3& angularVelocity);
+        void                    SetPositionAndRotationAndVelocity(const BodyID& bodyID, const RVec3& position, const Quat& rotation, const Vec3& linearVelocity, const Vec3& angularVelocity);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Add force (unit: N) at the center of mass for the next time step. This will be reset after
@@ -397,7 +398,7 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Add Force, applied at a world space point.
         //----------------------------------------------------------------------------------------------------
-        void                    AddForce(const BodyID& bodyID, const Vec3& force, const Vec3& point, EBodyActivationMode activationMode = EBodyActivationMode::Activate);
+        void                    AddForce(const BodyID& bodyID, const Vec3& force, const RVec3& point, EBodyActivationMode activationMode = EBodyActivationMode::Activate);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Add torque (unit: N m) for the next time step, will be reset after the next call to
@@ -418,7 +419,7 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Add an impulse to a point in world space (unit: kg m/s).
         //----------------------------------------------------------------------------------------------------
-        void                    AddImpulse(const BodyID& bodyID, const Vec3& impulse, const Vec3& point);
+        void                    AddImpulse(const BodyID& bodyID, const Vec3& impulse, const RVec3& point);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Add angular impulse to this body in world space (unit: N m s).
@@ -484,6 +485,17 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         float                   GetGravityScale(const BodyID& bodyID) const;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the simulation region of a body, which determines how often it is simulated.
+        ///     See SimulationRegionSettings.
+        //----------------------------------------------------------------------------------------------------
+        void                    SetSimulationRegion(const BodyID& bodyID, const uint32 region);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the simulation region of a body. Returns 0 for static bodies.
+        //----------------------------------------------------------------------------------------------------
+        uint32                  GetSimulationRegion(const BodyID& bodyID) const;
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : If PhysicsSettings::m_useManifoldReduction is true, this allows turning off manifold reduction for this specific body.
         /// Manifold reduction by default will combine contacts with similar normals that come from different SubShapeIDs (e.g. different triangles in a mesh shape or different compound shapes).
@@ -32,18 +32,6 @@ namespace nes
     }
 #endif
     
-    //----------------------------------------------------------------------------------------------------
-    /// @brief : Helper class that combines a Body with its motion properties. 
-    //----------------------------------------------------------------------------------------------------
-    class BodyWithMotionProperties final : public Body
-    {
-    public:
-        NES_OVERRIDE_NEW_DELETE
-        
-        MotionProperties m_motionProperties{};  
-        BodyWithMotionProperties() = default;
-    };
-
     BodyManager::~BodyManager()
     {
         UniqueLock lock(m_bodiesMutex NES_IF_ASSERTS_ENABLED(, this, EPhysicsLockTypes::BodiesArray));
@@ -71,6 +59,11 @@ namespace nes
         // Allocate space for bodies
         m_bodies.reserve(maxBodies);
 
+        // Initialize the body pools. Pages are only allocated when they are needed.
+        const uint32_t bodiesPerPage = math::Min(kBodiesPerPage, math::GetNextPowerOf2(math::Max(maxBodies, 1u)));
+        m_staticBodyPool.Init(maxBodies, bodiesPerPage);
+        m_bodyWithMotionPropertiesPool.Init(maxBodies, bodiesPerPage);
+
         // Allocate space for active bodies
         NES_ASSERT(m_pActiveBodies == nullptr);
         m_pActiveBodies = NES_NEW_ARRAY(BodyID, maxBodies);
@@ -82,13 +75,6 @@ namespace nes
         m_pBroadPhaseLayer = &layerInterface;
     }
 
-    uint32_t BodyManager::GetNumBodies() const
-    {
-        UniqueLock lock(m_bodiesMutex NES_IF_ASSERTS_ENABLED(, this, EPhysicsLockTypes::BodiesArray));
-        
-        return m_numBodies;
-    }
-
     BodyManager::BodyStats BodyManager::GetStats() const
     {
         UniqueLock lock(m_bodiesMutex NES_IF_ASSERTS_ENABLED(, this, EPhysicsLockTypes::BodiesArray));
@@ -146,13 +132,33 @@ namespace nes
         Body* pBody = nullptr;
         if (createInfo.HasMassProperties())
         {
-            BodyWithMotionProperties* pBodyWithMotionProperties = new BodyWithMotionProperties();
+            BodyWithMotionProperties* pBodyWithMotionProperties;
+            const uint32_t poolIndex = m_bodyWithMotionPropertiesPool.ConstructObject();
+            if (poolIndex != FixedSizeFreeList<BodyWithMotionProperties>::kInvalidObjectIndex)
+            {
+                pBodyWithMotionProperties = &m_bodyWithMotionPropertiesPool.Get(poolIndex);
+                pBodyWithMotionProperties->SetFlag(Body::EFlags::AllocatedFromPool, true);
+            }
+            else
+            {
+                pBodyWithMotionProperties = new BodyWithMotionProperties();
+            }
+            
             pBody = pBodyWithMotionProperties;
             pBody->m_pMotionProperties = &pBodyWithMotionProperties->m_motionProperties;
         }
         else
         {
-            pBody = new Body();
+            const uint32_t poolIndex = m_staticBodyPool.ConstructObject();
+            if (poolIndex != FixedSizeFreeList<Body>::kInvalidObjectIndex)
+            {
+                pBody = &m_staticBodyPool.Get(poolIndex);
+                pBody->SetFlag(Body::EFlags::AllocatedFromPool, true);
+            }
+            else
+            {
+                pBody = new Body();
+            }
         }
 
         //pBody->m_bodyType = BodyType::Rigid;
@@ -192,8 +198,16 @@ namespace nes
             pProps->SetGravityScale(createInfo.m_gravityScale);
             pProps->SetNumVelocityStepsOverride(createInfo.m_numVelocityStepsOverride);
             pProps->SetNumPositionStepsOverride(createInfo.m_numPositionStepsOverride);
+            pProps->SetSimulationRegion(createInfo.m_simulationRegion);
             pProps->m_motionQuality = createInfo.m_motionQuality;
             pProps->m_allowSleeping = createInfo.m_allowSleeping;
+
+            // A static body that can be made dynamic or kinematic later starts at rest.
+            if (!pBody->IsStatic())
+            {
+                pProps->SetLinearVelocityClamped(createInfo.m_linearVelocity);
+                pProps->SetAngularVelocityClamped(createInfo.m_angularVelocity);
+            }
             
             NES_IF_LOGGING_ENABLED(pProps->m_cachedMotionType = pBody->m_motionType);
         }
@@ -414,9 +428,20 @@ namespace nes
                     {
                         AddBodyToActiveBodies(body);
 
-                        // Call the activation listener
-                        if (m_pActivationListener != nullptr)
-                            m_pActivationListener->OnBodyActivated(id, body.GetUserData());
+                        if (body.m_pMotionProperties->m_isSimulationSkipped)
+                        {
+                            // A body that skipped this update was never asleep, it is simulated for the rest of the update.
+                            body.m_pMotionProperties->m_isSimulationSkipped = false;
+                        }
+                        else
+                        {
+                            // Time that was skipped before the body went to sleep must not be caught up on.
+                            body.m_pMotionProperties->m_simulationSkippedTime = 0.f;
+
+                            // Call the activation listener
+                            if (m_pActivationListener != nullptr)
+                                m_pActivationListener->OnBodyActivated(id, body.GetUserData());
+                        }
                     }
                 }
             }
@@ -443,13 +468,17 @@ namespace nes
                 NES_ASSERT(body.GetID() == id);
                 NES_ASSERT(body.IsInBroadPhase(), "Use BodyInterface::AddBody to add the body first!");
 
-                if (body.m_pMotionProperties != nullptr && body.m_pMotionProperties->m_indexInActiveBodies != Body::kInactiveIndex)
+                if (body.m_pMotionProperties != nullptr && (body.m_pMotionProperties->m_indexInActiveBodies != Body::kInactiveIndex || body.m_pMotionProperties->m_isSimulationSkipped))
                 {
-                    // Remove from the active bodies list
-                    RemoveBodyFromActiveBodies(body);
+                    // Remove from the active bodies list. A body that skipped this update has already been removed.
+                    if (body.m_pMotionProperties->m_isSimulationSkipped)
+                        body.m_pMotionProperties->m_isSimulationSkipped = false;
+                    else
+                        RemoveBodyFromActiveBodies(body);
 
                     // Mark this body as no longer active
                     body.m_pMotionProperties->m_islandIndex = Body::kInactiveIndex;
+                    body.m_pMotionProperties->m_simulationSkippedTime = 0.f;
 
                     // Reset the velocity
                     body.m_pMotionProperties->m_linearVelocity = Vec3::Zero();
@@ -472,7 +501,7 @@ namespace nes
 
             NES_ASSERT(!m_activeBodiesLocked);
 
-            bool isActive = body.IsActive();
+            bool isActive = body.Internal_IsInActiveBodies();
             if (isActive && pMotion->GetMotionQuality() == EBodyMotionQuality::LinearCast)
                 --m_numActiveCCDBodies;
 
@@ -585,6 +614,190 @@ namespace nes
         m_bodiesCacheInvalid.clear();
     }
 
+    void BodyManager::SaveState(StateRecorder& stream, const StateRecorderFilter* pFilter) const
+    {
+        LockAllBodies();
+
+        // The order of the active bodies determines the order in which the islands are built, so it is saved when
+        // all bodies are. A filtered state only stores if each body is active.
+        const bool saveActiveBodies = pFilter == nullptr;
+        stream.Write(saveActiveBodies);
+
+        // Count the bodies to save
+        uint32 numBodies = 0;
+        for (const Body* pBody : m_bodies)
+        {
+            if (IsValidBodyPointer(pBody) && pBody->IsInBroadPhase() && (pFilter == nullptr || pFilter->ShouldSaveBody(*pBody)))
+                ++numBodies;
+        }
+        stream.Write(numBodies);
+
+        // Write the state of the bodies
+        for (const Body* pBody : m_bodies)
+        {
+            if (IsValidBodyPointer(pBody) && pBody->IsInBroadPhase() && (pFilter == nullptr || pFilter->ShouldSaveBody(*pBody)))
+            {
+                stream.Write(pBody->GetID());
+                stream.Write(pBody->IsActive());
+                pBody->SaveState(stream);
+            }
+        }
+
+        if (saveActiveBodies)
+        {
+            const uint32 numActiveBodies = m_numActiveBodies.load(std::memory_order_relaxed);
+            stream.Write(numActiveBodies);
+            stream.WriteBytes(m_pActiveBodies, numActiveBodies * sizeof(BodyID));
+        }
+
+        UnlockAllBodies();
+    }
+
+    bool BodyManager::RestoreState(StateRecorder& stream, BodyIDVector& outMovedBodies)
+    {
+        LockAllBodies();
+
+        // The body section of the stream is validated and copied into m_restoreStateBuffer before any body
+        // is modified, so that a stream that doesn't match the bodies leaves them untouched.
+        const bool success = ReadAndValidateState(stream);
+        if (success)
+            ApplyRestoreState(outMovedBodies);
+
+        UnlockAllBodies();
+        return success;
+    }
+
+    bool BodyManager::ReadAndValidateState(StateRecorder& stream)
+    {
+        m_restoreStateBuffer.Clear();
+
+        bool restoreActiveBodies = false;
+        stream.Read(restoreActiveBodies);
+        m_restoreStateBuffer.Write(restoreActiveBodies);
+
+        uint32 numBodies = 0;
+        stream.Read(numBodies);
+        if (stream.IsFailed() || numBodies > m_bodies.size())
+            return false;
+        m_restoreStateBuffer.Write(numBodies);
+
+        // Copy the state of each body. The size of the state depends on the body (static bodies have no
+        // motion properties), so it is measured by saving the current state of the body.
+        for (uint32 i = 0; i < numBodies; ++i)
+        {
+            BodyID bodyID;
+            stream.Read(bodyID);
+            const Body* pBody = TryGetBody(bodyID);
+            if (stream.IsFailed() || pBody == nullptr)
+                return false;
+            m_restoreStateBuffer.Write(bodyID);
+
+            StateRecorderSizeCounter stateSize;
+            pBody->SaveState(stateSize);
+            m_restoreStateBuffer.WriteBytesFrom(stream, sizeof(bool) + stateSize.GetSize());
+        }
+
+        if (restoreActiveBodies)
+        {
+            uint32 numActiveBodies = 0;
+            stream.Read(numActiveBodies);
+            if (stream.IsFailed() || numActiveBodies > GetMaxNumBodies())
+                return false;
+
+            // Each active body must exist, must be able to move and must be listed once.
+            m_restoreActiveBodies.resize(numActiveBodies);
+            stream.ReadBytes(m_restoreActiveBodies.data(), numActiveBodies * sizeof(BodyID));
+            if (stream.IsFailed())
+                return false;
+            
+            m_restoreStateBuffer.Write(numActiveBodies);
+            m_restoreStateBuffer.WriteBytes(m_restoreActiveBodies.data(), numActiveBodies * sizeof(BodyID));
+
+            for (const BodyID& bodyID : m_restoreActiveBodies)
+            {
+                const Body* pBody = TryGetBody(bodyID);
+                if (pBody == nullptr || pBody->IsStatic())
+                    return false;
+            }
+
+            std::sort(m_restoreActiveBodies.begin(), m_restoreActiveBodies.end());
+            if (std::adjacent_find(m_restoreActiveBodies.begin(), m_restoreActiveBodies.end()) != m_restoreActiveBodies.end())
+                return false;
+        }
+
+        return !stream.IsFailed();
+    }
+
+    void BodyManager::ApplyRestoreState(BodyIDVector& outMovedBodies)
+    {
+        StateRecorderImpl& stream = m_restoreStateBuffer;
+        outMovedBodies.clear();
+        m_bodiesToActivate.clear();
+        m_bodiesToDeactivate.clear();
+
+        bool restoreActiveBodies = false;
+        stream.Read(restoreActiveBodies);
+
+        uint32 numBodies = 0;
+        stream.Read(numBodies);
+
+        // Read the state of the bodies
+        for (uint32 i = 0; i < numBodies; ++i)
+        {
+            BodyID bodyID;
+            stream.Read(bodyID);
+            Body* pBody = TryGetBody(bodyID);
+            NES_ASSERT(pBody != nullptr);
+
+            bool isActive = false;
+            stream.Read(isActive);
+            if (!restoreActiveBodies && isActive != pBody->IsActive())
+                (isActive? m_bodiesToActivate : m_bodiesToDeactivate).push_back(bodyID);
+
+            // Only bodies that moved need to update their bounds in the broadphase.
+            const RVec3 position = pBody->GetCenterOfMassPosition();
+            const Quat rotation = pBody->GetRotation();
+            pBody->RestoreState(stream);
+            if (pBody->GetCenterOfMassPosition() != position || pBody->GetRotation() != rotation)
+                outMovedBodies.push_back(bodyID);
+        }
+
+        UniqueLock lock(m_activeBodiesMutex NES_IF_ASSERTS_ENABLED(, this, EPhysicsLockTypes::ActiveBodiesArray));
+        NES_ASSERT(!m_activeBodiesLocked);
+
+        if (restoreActiveBodies)
+        {
+            uint32 numActiveBodies = 0;
+            stream.Read(numActiveBodies);
+
+            // Clear the current active bodies list
+            const uint32 numCurrentActiveBodies = m_numActiveBodies.load(std::memory_order_relaxed);
+            for (uint32 i = 0; i < numCurrentActiveBodies; ++i)
+                m_bodies[m_pActiveBodies[i].GetIndex()]->m_pMotionProperties->m_indexInActiveBodies = Body::kInactiveIndex;
+            m_numActiveBodies.store(0, std::memory_order_release);
+            m_numActiveCCDBodies = 0;
+
+            // Read the saved list in place, and add the bodies in the same order.
+            stream.ReadBytes(m_pActiveBodies, numActiveBodies * sizeof(BodyID));
+            for (uint32 i = 0; i < numActiveBodies; ++i)
+                AddBodyToActiveBodies(*TryGetBody(m_pActiveBodies[i]));
+        }
+        else
+        {
+            for (const BodyID& bodyID : m_bodiesToActivate)
+            {
+                Body* pBody = TryGetBody(bodyID);
+                if (!pBody->IsStatic())
+                    AddBodyToActiveBodies(*pBody);
+            }
+
+            for (const BodyID& bodyID : m_bodiesToDeactivate)
+                RemoveBodyFromActiveBodies(*TryGetBody(bodyID));
+        }
+
+        NES_ASSERT(!stream.IsFailed());
+    }
+
     BodyManager::MutexMask BodyManager::Internal_GetAllBodiesMutexMask() const
     {
         return m_bodyMutexes.GetNumMutexes() == sizeof(MutexMask) * 8 ?
@@ -668,6 +881,53 @@ namespace nes
         body.m_broadPhaseLayer = m_pBroadPhaseLayer->GetBroadPhaseLayer(layer);
     }
 
+    void BodyManager::Internal_SkipBodiesSimulation(const BodyID* pBodyIDs, const int count)
+    {
+        if (count <= 0)
+            return;
+
+        UniqueLock lock(m_activeBodiesMutex NES_IF_ASSERTS_ENABLED(, this, EPhysicsLockTypes::ActiveBodiesArray));
+
+        NES_ASSERT(!m_activeBodiesLocked);
+
+        for (const BodyID* pID = pBodyIDs; pID < pBodyIDs + count; ++pID)
+        {
+            Body& body = *m_bodies[pID->GetIndex()];
+            MotionProperties* pMotion = body.m_pMotionProperties;
+            NES_ASSERT(body.GetID() == *pID);
+            NES_ASSERT(pMotion->m_indexInActiveBodies != Body::kInactiveIndex);
+
+            RemoveBodyFromActiveBodies(body);
+            pMotion->m_islandIndex = Body::kInactiveIndex;
+            pMotion->m_isSimulationSkipped = true;
+        }
+    }
+
+    void BodyManager::Internal_ResumeSkippedBodies(const BodyID* pBodyIDs, const int count, const float skippedTime)
+    {
+        if (count <= 0)
+            return;
+
+        UniqueLock lock(m_activeBodiesMutex NES_IF_ASSERTS_ENABLED(, this, EPhysicsLockTypes::ActiveBodiesArray));
+
+        NES_ASSERT(!m_activeBodiesLocked);
+
+        for (const BodyID* pID = pBodyIDs; pID < pBodyIDs + count; ++pID)
+        {
+            Body& body = *m_bodies[pID->GetIndex()];
+            MotionProperties* pMotion = body.m_pMotionProperties;
+            NES_ASSERT(body.GetID() == *pID);
+
+            // Bodies that were activated or deactivated during the update have already been handled.
+            if (!pMotion->m_isSimulationSkipped)
+                continue;
+
+            pMotion->m_isSimulationSkipped = false;
+            pMotion->m_simulationSkippedTime += skippedTime;
+            AddBodyToActiveBodies(body);
+        }
+    }
+
     void BodyManager::AddBodyToActiveBodies(Body& body)
     {
         // [TODO]: Delineate between Rigid and Soft body types.
@@ -695,7 +955,7 @@ namespace nes
 
         uint32_t lastBodyIndex = m_numActiveBodies.load(std::memory_order_relaxed) - 1;
         MotionProperties* pMotion = body.m_pMotionProperties;
-        if (pMotion->m_indexInActiveBodies == lastBodyIndex)
+        if (pMotion->m_indexInActiveBodies != lastBodyIndex)
         {
             // This is not the last body, use the last body to fill the hole.
             BodyID lastBodyID = m_pActiveBodies[lastBodyIndex];
@@ -735,18 +995,26 @@ namespace nes
         return pBody;
     }
 
-    inline void BodyManager::DeleteBody(Body* pBody)
+    inline void BodyManager::DeleteBody(Body* pBody) const
     {
+        const bool allocatedFromPool = pBody->GetFlag(Body::EFlags::AllocatedFromPool);
+        
         if (pBody->m_pMotionProperties != nullptr)
         {
             NES_IF_LOGGING_ENABLED(pBody->m_pMotionProperties = nullptr);
 
             // [TODO]: Soft Body version.
-            NES_DELETE(checked_cast<BodyWithMotionProperties*>(pBody));
+            if (allocatedFromPool)
+                m_bodyWithMotionPropertiesPool.DestructObject(checked_cast<BodyWithMotionProperties*>(pBody));
+            else
+                NES_DELETE(checked_cast<BodyWithMotionProperties*>(pBody));
         }
         else
         {
-            NES_DELETE(pBody);
+            if (allocatedFromPool)
+                m_staticBodyPool.DestructObject(pBody);
+            else
+                NES_DELETE(pBody);
         }
     }
 
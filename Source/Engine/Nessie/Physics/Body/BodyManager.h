@@ -2,16 +2,29 @@
 #pragma once
 #include "Body.h"
 #include "BodyActivationMode.h"
+#include "Nessie/Core/Memory/FixedSizedFreeList.h"
 #include "Nessie/Core/Thread/Mutex.h"
 #include "Nessie/Core/Thread/MutexArray.h"
+#include "Nessie/Physics/StateRecorderImpl.h"
 
 namespace nes
 {
-    
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Helper class that combines a Body with its motion properties. 
+    //----------------------------------------------------------------------------------------------------
+    class BodyWithMotionProperties final : public Body
+    {
+    public:
+        NES_OVERRIDE_NEW_DELETE
+        
+        MotionProperties m_motionProperties{};  
+        BodyWithMotionProperties() = default;
+    };
 
     using BodyVector = std::vector<Body*>;
     using BodyIDVector = std::vector<BodyID>;
     class BodyActivationListener;
+    class StateRecorderFilter;
 
     //----------------------------------------------------------------------------------------------------
     /// @brief : Class that contains all bodies. 
@@ -51,9 +64,10 @@ namespace nes
         void                                Init(uint32_t maxBodies, uint32_t numBodyMutexes, const BroadPhaseLayerInterface& layerInterface);
 
         //----------------------------------------------------------------------------------------------------
-        /// @brief : Get the current number of bodies in the body manager.
+        /// @brief : Get the current number of bodies in the body manager. This is not synchronized with bodies
+        ///     that are being added or removed on other threads.
         //----------------------------------------------------------------------------------------------------
-        inline uint32_t                     GetNumBodies() const;
+        inline uint32_t                     GetNumBodies() const                    { return m_numBodies; }
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the max number of bodies that is supported. 
@@ -218,6 +232,27 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         void                                ValidateContactCacheForAllBodies();
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the state of all bodies that are in the broadphase. Without a filter, the order of
+        ///     the active bodies list is saved as well so that a restored simulation is identical.
+        ///	@param stream : Stream to write the state to.
+        ///	@param pFilter : Optional filter that selects which bodies are saved.
+        //----------------------------------------------------------------------------------------------------
+        void                                SaveState(StateRecorder& stream, const StateRecorderFilter* pFilter) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the state of the bodies that was saved with SaveState(). Bodies are activated or
+        ///     deactivated to match the saved state, without calling the activation listener.
+        ///     The body section of the stream is validated before any body is modified, and it is copied into
+        ///     a buffer that is kept between calls, so restoring doesn't allocate once the buffers have grown.
+        ///	@param stream : Stream to read the state from.
+        ///	@param outMovedBodies : On return, the bodies whose position or rotation changed. Reserve space
+        ///     for the max number of bodies to prevent allocations.
+        /// @returns : False if the state doesn't match the bodies in the manager. No body is modified in that
+        ///     case, but the stream has been read up to the point where the mismatch was found.
+        //----------------------------------------------------------------------------------------------------
+        bool                                RestoreState(StateRecorder& stream, BodyIDVector& outMovedBodies);
+
         //----------------------------------------------------------------------------------------------------
         // FUNCTIONS BELOW ARE FOR INTERNAL USE ONLY.
         //----------------------------------------------------------------------------------------------------
@@ -229,8 +264,35 @@ namespace nes
         void                                Internal_LockWrite(const MutexMask mask) const;
         void                                Internal_UnlockWrite(const MutexMask mask) const;
         void                                Internal_SetBodyCollisionLayer(Body& body, CollisionLayer layer) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Remove active bodies from the active bodies list for the current update because their
+        ///     simulation region is not simulated. Unlike DeactivateBodies(), the velocities are kept and the
+        ///     activation listener is not called. Must be undone with Internal_ResumeSkippedBodies() before
+        ///     the end of the update.
+        //----------------------------------------------------------------------------------------------------
+        void                                Internal_SkipBodiesSimulation(const BodyID* pBodyIDs, const int count);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Add the bodies that were skipped with Internal_SkipBodiesSimulation() back to the active
+        ///     bodies list. Bodies that were activated during the update are left alone.
+        ///	@param skippedTime : Time that the bodies skipped, which is added to the next update in which they
+        ///     are simulated.
+        //----------------------------------------------------------------------------------------------------
+        void                                Internal_ResumeSkippedBodies(const BodyID* pBodyIDs, const int count, const float skippedTime);
     
     private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : First pass of RestoreState(). Reads the body section of the stream into m_restoreStateBuffer,
+        ///     and checks that every body exists and that the list of active bodies is valid.
+        //----------------------------------------------------------------------------------------------------
+        bool                                ReadAndValidateState(StateRecorder& stream);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Second pass of RestoreState(). Applies the validated state in m_restoreStateBuffer.
+        //----------------------------------------------------------------------------------------------------
+        void                                ApplyRestoreState(BodyIDVector& outMovedBodies);
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Increment and get the sequence number of a body. We intentionally overflow the uin8_t value.
         //----------------------------------------------------------------------------------------------------
@@ -256,7 +318,7 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Helper function to delete a body (which could actually be a BodyWithMotionProperties). 
         //----------------------------------------------------------------------------------------------------
-        inline static void                  DeleteBody(Body* pBody);
+        inline void                         DeleteBody(Body* pBody) const;
 
 #if defined(NES_DEBUG) && defined(NES_LOGGING_ENABLED)
         //----------------------------------------------------------------------------------------------------
@@ -274,6 +336,15 @@ namespace nes
 
         /// Amount of bits to shift to get an index to the next freed body.
         static constexpr unsigned           kFreedBodyIndexShift = 1;
+
+        /// Number of Bodies per page of the body pools. Bodies in the same page are contiguous in memory.
+        static constexpr uint32_t           kBodiesPerPage = 256;
+
+        /// Pools that the Bodies are allocated from, so that Bodies that are created together are close in memory.
+        /// This keeps the loops over the active Bodies during the simulation from jumping around the heap.
+        /// When a pool is full, Bodies are allocated on the heap instead.
+        mutable FixedSizeFreeList<Body>     m_staticBodyPool;
+        mutable FixedSizeFreeList<BodyWithMotionProperties> m_bodyWithMotionPropertiesPool;
         
         /// List of all pointers to all bodies. Contains invalid pointers for deleted bodies, check with
         /// kIsValidBodyPointer. Note that this array is reserved to hold the max num bodies that is passed
@@ -321,6 +392,12 @@ namespace nes
         /// Cached broadphase layer interface
         const BroadPhaseLayerInterface*     m_pBroadPhaseLayer = nullptr;
 
+        /// Validated body state and the active bodies that are changed by RestoreState(). Kept to prevent allocations.
+        StateRecorderImpl                   m_restoreStateBuffer;
+        BodyIDVector                        m_restoreActiveBodies;
+        BodyIDVector                        m_bodiesToActivate;
+        BodyIDVector                        m_bodiesToDeactivate;
+
     #if NES_ASSERTS_ENABLED
     public:
         //----------------------------------------------------------------------------------------------------
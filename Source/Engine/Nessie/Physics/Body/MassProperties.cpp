@@ -38,8 +38,8 @@ namespace nes
             outDiagonal[i] = eigenValue[indices[i]];
         }
 
-        // Make sure the result is left-handed.
-        if (!Vec3::IsLeftHanded(outRotation.GetAxisX(), outRotation.GetAxisY(), outRotation.GetAxisZ()))
+        // Make sure the result is a rotation, and not a reflection.
+        if (Vec3::IsLeftHanded(outRotation.GetAxisX(), outRotation.GetAxisY(), outRotation.GetAxisZ()))
             outRotation[2] = -outRotation[2];
 
 #if NES_ASSERTS_ENABLED
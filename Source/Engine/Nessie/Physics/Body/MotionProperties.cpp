@@ -1,6 +1,8 @@
 // MotionProperties.cpp
 #include "MotionProperties.h"
 #include "MassProperties.h"
+#include "Nessie/Math/QuatSIMD.h"
+#include "Nessie/Physics/StateRecorder.h"
 
 namespace nes
 {
@@ -55,4 +57,122 @@ namespace nes
         NES_ASSERT(m_inverseMass != 0.0f || m_inverseInertiaDiagonal != Vec3::Zero(), "Can't lock all axes, use a static body for this. This will crash with a division by zero later!");
     }
 
+    void MotionProperties::Internal_ApplyForceTorqueAndDrag4(MotionProperties* const* ppMotionProps, const Quat* pBodyRotations, const float* pDeltaTimes, const uint32_t numBodies, const Vec3& gravity)
+    {
+        NES_ASSERT(numBodies > 0 && numBodies <= 4);
+        NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetVelocityAccess(), BodyAccess::EAccess::ReadWrite));
+
+        // Lanes without a body repeat the first body, their results are not stored.
+        const MotionProperties* pLanes[4];
+        uint32_t laneIndex[4];
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            laneIndex[i] = i < numBodies? i : 0;
+            pLanes[i] = ppMotionProps[laneIndex[i]];
+            NES_ASSERT(pLanes[i]->m_cachedMotionType == EBodyMotionType::Dynamic);
+            NES_ASSERT(pLanes[i]->m_allowedDoFs == EAllowedDOFs::All);
+        }
+
+        // Transpose the state of the bodies, so that column i of each matrix holds component i of all 4 bodies.
+        const auto transposeVec3 = [&pLanes](Vec3 MotionProperties::* pMember)
+        {
+            return Mat44(Vec4Reg(pLanes[0]->*pMember, 0.f), Vec4Reg(pLanes[1]->*pMember, 0.f), Vec4Reg(pLanes[2]->*pMember, 0.f), Vec4Reg(pLanes[3]->*pMember, 0.f)).Transposed();
+        };
+        const auto loadFloat = [&pLanes](float MotionProperties::* pMember)
+        {
+            return Vec4Reg(pLanes[0]->*pMember, pLanes[1]->*pMember, pLanes[2]->*pMember, pLanes[3]->*pMember);
+        };
+        
+        Mat44 linearVelocity = transposeVec3(&MotionProperties::m_linearVelocity);
+        Mat44 angularVelocity = transposeVec3(&MotionProperties::m_angularVelocity);
+        const Mat44 force = transposeVec3(&MotionProperties::m_force);
+        const Mat44 torque = transposeVec3(&MotionProperties::m_torque);
+        const Mat44 inverseInertiaDiagonal = transposeVec3(&MotionProperties::m_inverseInertiaDiagonal);
+        const Mat44 bodyRotation = Mat44(Vec4Reg::LoadVec4(&pBodyRotations[laneIndex[0]].m_value), Vec4Reg::LoadVec4(&pBodyRotations[laneIndex[1]].m_value), Vec4Reg::LoadVec4(&pBodyRotations[laneIndex[2]].m_value), Vec4Reg::LoadVec4(&pBodyRotations[laneIndex[3]].m_value)).Transposed();
+        const Mat44 inertiaRotation = Mat44(Vec4Reg::LoadVec4(&pLanes[0]->m_inertiaRotation.m_value), Vec4Reg::LoadVec4(&pLanes[1]->m_inertiaRotation.m_value), Vec4Reg::LoadVec4(&pLanes[2]->m_inertiaRotation.m_value), Vec4Reg::LoadVec4(&pLanes[3]->m_inertiaRotation.m_value)).Transposed();
+        const Vec4Reg deltaTime(pDeltaTimes[laneIndex[0]], pDeltaTimes[laneIndex[1]], pDeltaTimes[laneIndex[2]], pDeltaTimes[laneIndex[3]]);
+        const Vec4Reg inverseMass = loadFloat(&MotionProperties::m_inverseMass);
+        const Vec4Reg gravityScale = loadFloat(&MotionProperties::m_gravityScale);
+
+        // Update Linear Velocity
+        for (uint32_t i = 0; i < 3; ++i)
+            linearVelocity[i] += deltaTime * (gravityScale * gravity[i] + inverseMass * force[i]);
+
+        // Update Angular Velocity, multiplying the torque by the world space inverse inertia: R * D * R^T, where R
+        // is the rotation of the body times the inertia rotation and D the inverse inertia diagonal.
+        Vec4Reg rotation[4] = { bodyRotation[0], bodyRotation[1], bodyRotation[2], bodyRotation[3] };
+        const Vec4Reg inertiaRotationComponents[4] = { inertiaRotation[0], inertiaRotation[1], inertiaRotation[2], inertiaRotation[3] };
+        math::Quat4Multiply(rotation, inertiaRotationComponents, rotation);
+        Vec4Reg rotationMatrix[3][3];
+        math::Quat4ToRotation3x3(rotation, rotationMatrix);
+
+        Vec4Reg localTorque[3];
+        for (uint32_t i = 0; i < 3; ++i)
+            localTorque[i] = inverseInertiaDiagonal[i] * (rotationMatrix[i][0] * torque[0] + rotationMatrix[i][1] * torque[1] + rotationMatrix[i][2] * torque[2]);
+        for (uint32_t i = 0; i < 3; ++i)
+            angularVelocity[i] += deltaTime * (rotationMatrix[0][i] * localTorque[0] + rotationMatrix[1][i] * localTorque[1] + rotationMatrix[2][i] * localTorque[2]);
+
+        // Linear and angular damping, see Internal_ApplyForceTorqueAndDrag().
+        const Vec4Reg linearDampingFactor = Vec4Reg::Max(Vec4Reg::Zero(), Vec4Reg::One() - loadFloat(&MotionProperties::m_linearDamping) * deltaTime);
+        const Vec4Reg angularDampingFactor = Vec4Reg::Max(Vec4Reg::Zero(), Vec4Reg::One() - loadFloat(&MotionProperties::m_angularDamping) * deltaTime);
+
+        // Clamp velocities. The length is kept away from zero so that lanes that are not clamped don't divide by zero.
+        const auto clampScale = [](const Mat44& velocity, const Vec4Reg& maxVelocity)
+        {
+            const Vec4Reg lengthSqr = velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2];
+            const Vec4Reg scale = maxVelocity / Vec4Reg::Max(lengthSqr, Vec4Reg::Replicate(FLT_MIN)).Sqrt();
+            return Vec4Reg::Select(Vec4Reg::One(), scale, Vec4Reg::Greater(lengthSqr, maxVelocity * maxVelocity));
+        };
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            linearVelocity[i] *= linearDampingFactor;
+            angularVelocity[i] *= angularDampingFactor;
+        }
+        const Vec4Reg linearScale = clampScale(linearVelocity, loadFloat(&MotionProperties::m_maxLinearVelocity));
+        const Vec4Reg angularScale = clampScale(angularVelocity, loadFloat(&MotionProperties::m_maxAngularVelocity));
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            linearVelocity[i] *= linearScale;
+            angularVelocity[i] *= angularScale;
+        }
+
+        // Transpose back and store the velocities of the bodies.
+        linearVelocity = linearVelocity.Transposed();
+        angularVelocity = angularVelocity.Transposed();
+        for (uint32_t i = 0; i < numBodies; ++i)
+        {
+            ppMotionProps[i]->m_linearVelocity = linearVelocity[i].ToVec3();
+            ppMotionProps[i]->m_angularVelocity = angularVelocity[i].ToVec3();
+        }
+    }
+
+    void MotionProperties::SaveState(StateRecorder& stream) const
+    {
+        stream.Write(m_linearVelocity);
+        stream.Write(m_angularVelocity);
+        stream.Write(m_force);
+        stream.Write(m_torque);
+        stream.Write(m_sleepTestSpheres);
+#ifdef NES_DOUBLE_PRECISION
+        stream.Write(m_sleepTestOffset);
+#endif
+        stream.Write(m_sleepTestTimer);
+        stream.Write(m_allowSleeping);
+        stream.Write(m_simulationSkippedTime);
+    }
+
+    void MotionProperties::RestoreState(StateRecorder& stream)
+    {
+        stream.Read(m_linearVelocity);
+        stream.Read(m_angularVelocity);
+        stream.Read(m_force);
+        stream.Read(m_torque);
+        stream.Read(m_sleepTestSpheres);
+#ifdef NES_DOUBLE_PRECISION
+        stream.Read(m_sleepTestOffset);
+#endif
+        stream.Read(m_sleepTestTimer);
+        stream.Read(m_allowSleeping);
+        stream.Read(m_simulationSkippedTime);
+    }
 }
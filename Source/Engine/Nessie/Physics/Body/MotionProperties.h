@@ -7,10 +7,12 @@
 #include "Nessie/Math/Quat.h"
 #include "Nessie/Math/Mat44.h"
 #include "Nessie/Geometry/Sphere.h"
+#include "Nessie/Physics/SimulationRegion.h"
 
 namespace nes
 {
     struct MassProperties;
+    class StateRecorder;
 
     enum class ECanSleep : uint8_t
     {
@@ -305,6 +307,28 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         inline void                 SetNumPositionStepsOverride(const uint32_t numSteps);
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the simulation region of this body, which determines how often it is simulated.
+        ///     See SimulationRegionSettings.
+        //----------------------------------------------------------------------------------------------------
+        inline uint32_t             GetSimulationRegion() const                             { return m_simulationRegion; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the simulation region of this body, which determines how often it is simulated.
+        ///     Must be less than kMaxSimulationRegions. See SimulationRegionSettings.
+        //----------------------------------------------------------------------------------------------------
+        inline void                 SetSimulationRegion(const uint32_t region);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the state of the motion properties (velocities, accumulated forces and sleep state).
+        //----------------------------------------------------------------------------------------------------
+        void                        SaveState(StateRecorder& stream) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the state of the motion properties that was saved with SaveState().
+        //----------------------------------------------------------------------------------------------------
+        void                        RestoreState(StateRecorder& stream);
+
         //----------------------------------------------------------------------------------------------------
         // FUNCTIONS BELOW ARE FOR INTERNAL USE ONLY.
         //----------------------------------------------------------------------------------------------------
@@ -316,11 +340,23 @@ namespace nes
         inline void                 Internal_ApplyGyroscopicForce(const Quat& bodyRotation, const float deltaTime);
         inline void                 Internal_ApplyForceTorqueAndDrag(const Quat& bodyRotation, const Vec3& gravity, const float deltaTime);
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Same as Internal_ApplyForceTorqueAndDrag(), for up to 4 bodies at once. The state of the bodies
+        ///     is transposed into registers that each hold one component of all 4 bodies. The bodies must be
+        ///     dynamic and have all degrees of freedom.
+        //----------------------------------------------------------------------------------------------------
+        static void                 Internal_ApplyForceTorqueAndDrag4(MotionProperties* const* ppMotionProps, const Quat* pBodyRotations, const float* pDeltaTimes, const uint32_t numBodies, const Vec3& gravity);
+
         inline uint32_t             Internal_GetIslandIndex() const                         { return m_islandIndex; }
         inline void                 Internal_SetIslandIndex(const uint32_t islandIndex)     { m_islandIndex = islandIndex; }
         inline uint32_t             Internal_GetIndexInActiveBodies() const                 { return m_indexInActiveBodies; }
+        inline bool                 Internal_IsSimulationSkipped() const                    { return m_isSimulationSkipped; }
+        inline float                Internal_GetSimulationTimeScale() const                 { return m_simulationTimeScale; }
+        inline void                 Internal_SetSimulationTimeScale(const float timeScale)  { m_simulationTimeScale = timeScale; }
+        inline float                Internal_GetSimulationSkippedTime() const               { return m_simulationSkippedTime; }
+        inline void                 Internal_SetSimulationSkippedTime(const float time)     { m_simulationSkippedTime = time; }
         
-        inline void                 Internal_ResetSleepTestSpheres(const Vec3* pPoints);
+        inline void                 Internal_ResetSleepTestSpheres(const RVec3* pPoints);
         inline void                 Internal_ResetSleepTestTimer()                          { m_sleepTestTimer = 0.f; }
         inline ECanSleep            Internal_AccumulateSleepTime(float deltaTime, float timeBeforeSleep);
     
@@ -348,8 +384,15 @@ namespace nes
         EAllowedDOFs         m_allowedDoFs          = EAllowedDOFs::All;             /// Allowed degrees of freedom for this body.
         uint8_t             m_numVelocityStepsOverride = 0;                          /// Used only when this Body is dynamic and colliding. Override for the number of solver velocity iterations to run, 0 means use the default in PhysicsSettings::mNumVelocitySteps. The number of iterations to use is the max of all contacts and constraints in the island.
         uint8_t             m_numPositionStepsOverride = 0;                          /// Used only when this Body is dynamic and colliding. Override for the number of solver position iterations to run, 0 means use the default in PhysicsSettings::mNumVelocitySteps. The number of iterations to use is the max of all contacts and constraints in the island.
+        uint8_t             m_simulationRegion      = 0;                            /// Simulation region of this body, see SimulationRegionSettings.
+        bool                m_isSimulationSkipped   = false;                        /// If the body is frozen for the current update because its simulation region is not simulated.
+        float               m_simulationTimeScale   = 1.f;                          /// Factor to multiply the step delta time with for this body. Larger than 1 when it catches up on skipped updates.
+        float               m_simulationSkippedTime = 0.f;                          /// Time that this body skipped since its simulation region was last simulated.
 
         // 3rd Cache line - Not used often.
+#ifdef NES_DOUBLE_PRECISION
+        DVec3               m_sleepTestOffset = DVec3::Zero();                   /// Offset that the sleep test spheres are relative to.
+#endif
         Sphere              m_sleepTestSpheres[3];                             /// Measure motion for 3 points on the body to see if it is resting: COM, COM + largest bounding box axis, COM + second largest bounding box axis.
         float               m_sleepTestTimer = 0.f;                              /// How long this body has been within the movement tolerance.
 
@@ -164,7 +164,7 @@ namespace nes
             m_inverseInertiaDiagonal.SplatZ() * rot.GetColumn4(2),
             Vec4(0.f, 0.f, 0.f, 1.f)
         );
-        Mat44 inverseInertia = rotation.Multiply3x3RightTransposed(rotationMulScaleTransposed);
+        Mat44 inverseInertia = rot.Multiply3x3RightTransposed(rotationMulScaleTransposed);
 
         // We need to mask out both rows and columns of DOFs that are not allowed.
         const Vec4Reg angularDOFsMask = GetAngularDOFsMask().ReinterpretAsFloat();
@@ -237,6 +237,12 @@ namespace nes
         m_numPositionStepsOverride = static_cast<uint8_t>(numSteps);
     }
 
+    void MotionProperties::SetSimulationRegion(const uint32_t region)
+    {
+        NES_ASSERT(region < kMaxSimulationRegions);
+        m_simulationRegion = static_cast<uint8_t>(region);
+    }
+
     void MotionProperties::Internal_AddLinearVelocityStep(const Vec3& linearVelocityChange)
     {
         NES_ASSERT(BodyAccess::CheckRights(BodyAccess::GetVelocityAccess(), BodyAccess::EAccess::ReadWrite));
@@ -320,10 +326,15 @@ namespace nes
         ClampAngularVelocity();
     }
 
-    void MotionProperties::Internal_ResetSleepTestSpheres(const Vec3* pPoints)
+    void MotionProperties::Internal_ResetSleepTestSpheres(const RVec3* pPoints)
     {
 #ifdef NES_DOUBLE_PRECISION
-        // [TODO]: 
+        // Store the spheres relative to the center of mass so that they keep their precision far away from the origin.
+        m_sleepTestOffset = pPoints[0];
+        for (int i = 0; i < 3; ++i)
+        {
+            m_sleepTestSpheres[i] = Sphere(Vec3(pPoints[i] - m_sleepTestOffset), 0.f);
+        }
 #else
         for (int i = 0; i < 3; ++i)
         {
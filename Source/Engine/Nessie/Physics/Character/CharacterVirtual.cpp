@@ -0,0 +1,903 @@
+// CharacterVirtual.cpp
+#include "CharacterVirtual.h"
+#include <algorithm>
+#include "Nessie/Jobs/ParallelFor.h"
+#include "Nessie/Physics/PhysicsScene.h"
+#include "Nessie/Physics/Body/Body.h"
+#include "Nessie/Physics/Body/BodyInterface.h"
+#include "Nessie/Physics/Collision/CollideShape.h"
+#include "Nessie/Physics/Collision/CollisionCollector.h"
+#include "Nessie/Physics/Collision/NarrowPhaseQuery.h"
+#include "Nessie/Physics/Collision/ShapeCast.h"
+
+namespace nes
+{
+    CharacterVirtual::CharacterVirtual(const CharacterVirtualSettings& settings, const RVec3& position, const Quat& rotation, PhysicsScene* pScene)
+        : m_pScene(pScene)
+        , m_pShape(settings.m_pShape)
+        , m_up(settings.m_up)
+        , m_cosMaxSlopeAngle(std::cos(settings.m_maxSlopeAngle))
+        , m_mass(settings.m_mass)
+        , m_maxStrength(settings.m_maxStrength)
+        , m_characterPadding(settings.m_characterPadding)
+        , m_predictiveContactDistance(settings.m_predictiveContactDistance)
+        , m_penetrationRecoverySpeed(settings.m_penetrationRecoverySpeed)
+        , m_collisionTolerance(settings.m_collisionTolerance)
+        , m_hitReductionCosMaxAngle(settings.m_hitReductionCosMaxAngle)
+        , m_minTimeRemaining(settings.m_minTimeRemaining)
+        , m_maxCollisionIterations(settings.m_maxCollisionIterations)
+        , m_maxConstraintIterations(settings.m_maxConstraintIterations)
+        , m_maxNumContacts(settings.m_maxNumContacts)
+        , m_backFaceMode(settings.m_backFaceMode)
+        , m_position(position)
+        , m_rotation(rotation)
+    {
+        NES_ASSERT(m_pScene != nullptr);
+        NES_ASSERT(m_pShape != nullptr);
+    }
+
+    bool CharacterVirtual::IsSlopeTooSteep(const Vec3& normal) const
+    {
+        // If the max slope angle is 90 degrees or more, no slope is too steep.
+        return m_cosMaxSlopeAngle > 0.f && normal.Dot(m_up) < m_cosMaxSlopeAngle;
+    }
+
+    void CharacterVirtual::Update(const float deltaTime, const Vec3& gravity, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter)
+    {
+        if (deltaTime <= 0.f)
+            return;
+
+        const QueryFilters filters { broadPhaseLayerFilter, collisionLayerFilter, bodyFilter, shapeFilter };
+        CollectNearbyShapes(GetSweptBounds(m_linearVelocity * deltaTime, 0.f), filters);
+
+        UpdateInternal(deltaTime, gravity, shapeFilter);
+    }
+
+    void CharacterVirtual::ExtendedUpdate(const float deltaTime, const Vec3& gravity, const CharacterVirtualUpdateSettings& updateSettings, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter)
+    {
+        if (deltaTime <= 0.f)
+            return;
+
+        // Collect the shapes once for the regular movement and all the stair walking and stick to floor sweeps below.
+        // The margin covers the largest distance that any of those sweeps can travel away from the regular movement.
+        const float extraMargin = updateSettings.m_stickToFloorStepDown.Length()
+            + updateSettings.m_walkStairsStepUp.Length()
+            + updateSettings.m_walkStairsStepDownExtra.Length()
+            + math::Max(updateSettings.m_walkStairsMinStepForward, updateSettings.m_walkStairsStepForwardTest);
+
+        const QueryFilters filters { broadPhaseLayerFilter, collisionLayerFilter, bodyFilter, shapeFilter };
+        CollectNearbyShapes(GetSweptBounds(m_linearVelocity * deltaTime, extraMargin), filters);
+
+        // Remember the state before the update.
+        const Vec3 desiredVelocity = m_linearVelocity;
+        const RVec3 oldPosition = m_position;
+        const EGroundState oldGroundState = m_groundState;
+
+        UpdateInternal(deltaTime, gravity, shapeFilter);
+
+        // If we lost contact with the ground while we were not moving up, we may have walked off a small ledge or down a slope.
+        // Try to find the floor again so that we don't start to fall.
+        const bool groundToAir = oldGroundState != EGroundState::InAir && m_groundState == EGroundState::InAir;
+        if (groundToAir && !updateSettings.m_stickToFloorStepDown.IsNearZero())
+        {
+            const float verticalVelocity = Vec3(m_position - oldPosition).Dot(m_up) / deltaTime;
+            if (verticalVelocity <= 1.0e-6f)
+                StickToFloor(updateSettings.m_stickToFloorStepDown, shapeFilter);
+        }
+
+        if (updateSettings.m_walkStairsStepUp.IsNearZero())
+            return;
+
+        // Calculate how much we wanted to move horizontally.
+        Vec3 desiredHorizontalStep = desiredVelocity * deltaTime;
+        desiredHorizontalStep -= desiredHorizontalStep.Dot(m_up) * m_up;
+        const float desiredHorizontalStepLength = desiredHorizontalStep.Length();
+        if (desiredHorizontalStepLength <= 0.f)
+            return;
+
+        // Calculate how much we moved horizontally. Only count movement in the desired direction,
+        // otherwise sliding down a hill while trying to walk uphill would count as progress.
+        const Vec3 stepForwardNormalized = desiredHorizontalStep / desiredHorizontalStepLength;
+        Vec3 achievedHorizontalStep = Vec3(m_position - oldPosition);
+        achievedHorizontalStep -= achievedHorizontalStep.Dot(m_up) * m_up;
+        const float achievedHorizontalStepLength = math::Max(0.f, achievedHorizontalStep.Dot(stepForwardNormalized));
+
+        // If we didn't move as far as we wanted and we're against a slope that's too steep, try to walk up the stairs.
+        if (achievedHorizontalStepLength + 1.0e-4f < desiredHorizontalStepLength && CanWalkStairs(desiredVelocity))
+        {
+            // Clamp the step forward to a minimum distance. At high frame rates the step can become so small that
+            // we would never move far enough to end up on top of the step.
+            const Vec3 stepForward = stepForwardNormalized * math::Max(updateSettings.m_walkStairsMinStepForward, desiredHorizontalStepLength - achievedHorizontalStepLength);
+
+            // Calculate where to test for a floor in case the floor normal at stepForward is too steep. Follow the
+            // ground normal in the horizontal plane, unless it's too different from the walking direction.
+            Vec3 stepForwardTest = -m_groundNormal;
+            stepForwardTest -= stepForwardTest.Dot(m_up) * m_up;
+            stepForwardTest = stepForwardTest.NormalizedOr(stepForwardNormalized);
+            if (stepForwardTest.Dot(stepForwardNormalized) < updateSettings.m_walkStairsCosAngleForwardContact)
+                stepForwardTest = stepForwardNormalized;
+            stepForwardTest *= updateSettings.m_walkStairsStepForwardTest;
+
+            WalkStairs(deltaTime, updateSettings.m_walkStairsStepUp, stepForward, stepForwardTest, updateSettings.m_walkStairsStepDownExtra, shapeFilter);
+        }
+    }
+
+    void CharacterVirtual::RefreshContacts(const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter)
+    {
+        const QueryFilters filters { broadPhaseLayerFilter, collisionLayerFilter, bodyFilter, shapeFilter };
+        CollectNearbyShapes(GetSweptBounds(Vec3::Zero(), 0.f), filters);
+
+        GetContactsAtPosition(m_position, m_linearVelocity.NormalizedOr(Vec3::Zero()), shapeFilter, m_activeContacts);
+        UpdateSupportingContact(true);
+    }
+
+    void CharacterVirtual::ExtendedUpdateCharacters(CharacterVirtual* const* ppCharacters, const uint32 numCharacters, const float deltaTime, const Vec3& gravity, const CharacterVirtualUpdateSettings& updateSettings, JobSystem* pJobSystem, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter)
+    {
+        // Characters are handed out in small batches so that threads that get cheap characters (e.g. standing
+        // still in open space) pick up more of the work.
+        static constexpr uint32 kCharactersPerBatch = 4;
+
+        const auto updateRange = [&](const uint32 begin, const uint32 end)
+        {
+            for (uint32 characterIndex = begin; characterIndex < end; ++characterIndex)
+                ppCharacters[characterIndex]->ExtendedUpdate(deltaTime, gravity, updateSettings, broadPhaseLayerFilter, collisionLayerFilter, bodyFilter, shapeFilter);
+        };
+
+        if (pJobSystem == nullptr)
+        {
+            updateRange(0, numCharacters);
+            return;
+        }
+
+        ParallelForSettings settings;
+        settings.m_pName = "UpdateCharacters";
+        settings.m_grainSize = kCharactersPerBatch;
+        ParallelFor(*pJobSystem, 0, numCharacters, updateRange, settings);
+    }
+
+    RMat44 CharacterVirtual::GetCenterOfMassTransform(const RVec3& position) const
+    {
+        return RMat44::MakeRotationTranslation(m_rotation, position).PreTranslated(m_pShape->GetCenterOfMass());
+    }
+
+    AABox CharacterVirtual::GetSweptBounds(const Vec3& displacement, const float extraMargin) const
+    {
+        AABox bounds = m_pShape->GetWorldBounds(GetCenterOfMassTransform(m_position), Vec3::One());
+
+        AABox endBounds = bounds;
+        endBounds.Translate(displacement);
+        bounds.Encapsulate(endBounds);
+
+        bounds.ExpandBy(Vec3::Replicate(m_predictiveContactDistance + m_characterPadding + extraMargin));
+        return bounds;
+    }
+
+    void CharacterVirtual::CollectNearbyShapes(const AABox& bounds, const QueryFilters& filters)
+    {
+        // Collects the leaf shapes of all bodies in the bounds, together with the motion properties of their body.
+        // The properties are read while the body is locked so that later queries don't need to lock the body again.
+        class NearbyShapeCollector final : public TransformedShapeCollector
+        {
+        public:
+            NearbyShapeCollector(std::vector<NearbyBody>& bodies, std::vector<NearbyShape>& shapes) : m_bodies(bodies), m_shapes(shapes) {}
+
+            virtual void OnBody(const Body& body) override
+            {
+                // The character doesn't collide with sensors.
+                m_skipBody = body.IsSensor();
+                if (m_skipBody)
+                    return;
+
+                NearbyBody& nearbyBody = m_bodies.emplace_back();
+                nearbyBody.m_centerOfMass = body.GetCenterOfMassPosition();
+                nearbyBody.m_linearVelocity = body.GetLinearVelocity();
+                nearbyBody.m_angularVelocity = body.GetAngularVelocity();
+                nearbyBody.m_bodyID = body.GetID();
+                nearbyBody.m_motionType = body.GetMotionType();
+            }
+
+            virtual void AddHit(const TransformedShape& shape) override
+            {
+                if (!m_skipBody)
+                    m_shapes.push_back({ shape, static_cast<uint32>(m_bodies.size() - 1) });
+            }
+
+        private:
+            std::vector<NearbyBody>& m_bodies;
+            std::vector<NearbyShape>& m_shapes;
+            bool m_skipBody = false;
+        };
+
+        m_nearbyBodies.clear();
+        m_nearbyShapes.clear();
+
+        NearbyShapeCollector collector(m_nearbyBodies, m_nearbyShapes);
+        m_pScene->GetNarrowPhaseQuery().CollectTransformedShapes(bounds, collector, filters.m_broadPhaseLayerFilter, filters.m_collisionLayerFilter, filters.m_bodyFilter, filters.m_shapeFilter);
+    }
+
+    void CharacterVirtual::GetContactsAtPosition(const RVec3& position, const Vec3& movementDirection, const ShapeFilter& shapeFilter, ContactList& outContacts) const
+    {
+        class ContactCollector final : public CollideShapeCollector
+        {
+        public:
+            ContactCollector(const CharacterVirtual& character, const RVec3& baseOffset, ContactList& contacts) : m_character(character), m_baseOffset(baseOffset), m_contacts(contacts) {}
+
+            virtual void AddHit(const CollideShapeResult& result) override
+            {
+                const RVec3 position = m_baseOffset + result.m_contactPointOn2;
+                const Vec3 contactNormal = -result.m_penetrationAxis.NormalizedOr(Vec3::Zero());
+                const float distance = -result.m_penetrationDepth;
+
+                // Merge with a contact of the same body that has nearly the same normal, keeping the deepest one.
+                for (Contact& contact : m_contacts)
+                {
+                    if (contact.m_bodyID == m_pBody->m_bodyID && contact.m_contactNormal.Dot(contactNormal) > m_character.m_hitReductionCosMaxAngle)
+                    {
+                        if (distance < contact.m_distance)
+                            FillContact(contact, result, position, contactNormal, distance);
+                        return;
+                    }
+                }
+
+                // When we're out of space, replace the contact that is furthest away if this one is closer.
+                if (m_contacts.size() >= m_character.m_maxNumContacts)
+                {
+                    auto furthest = std::max_element(m_contacts.begin(), m_contacts.end(), [](const Contact& left, const Contact& right) { return left.m_distance < right.m_distance; });
+                    if (furthest != m_contacts.end() && distance < furthest->m_distance)
+                        FillContact(*furthest, result, position, contactNormal, distance);
+                    return;
+                }
+
+                FillContact(m_contacts.emplace_back(), result, position, contactNormal, distance);
+            }
+
+            const NearbyBody*           m_pBody = nullptr;
+            const TransformedShape*     m_pShape = nullptr;
+
+        private:
+            void FillContact(Contact& contact, const CollideShapeResult& result, const RVec3& position, const Vec3& contactNormal, const float distance) const
+            {
+                contact = Contact();
+                contact.m_position = position;
+                contact.m_linearVelocity = m_pBody->m_linearVelocity + m_pBody->m_angularVelocity.Cross(Vec3(position - m_pBody->m_centerOfMass));
+                contact.m_contactNormal = contactNormal;
+                contact.m_surfaceNormal = m_pShape->GetWorldSpaceSurfaceNormal(result.m_subShapeID2, position);
+                contact.m_distance = distance;
+                contact.m_bodyID = m_pBody->m_bodyID;
+                contact.m_subShapeID = result.m_subShapeID2;
+                contact.m_motionType = m_pBody->m_motionType;
+
+                // When hitting a back face, the surface normal points away from the character.
+                if (contact.m_surfaceNormal.Dot(contactNormal) < 0.f)
+                    contact.m_surfaceNormal = -contact.m_surfaceNormal;
+            }
+
+            const CharacterVirtual&     m_character;
+            RVec3                       m_baseOffset;
+            ContactList&                m_contacts;
+        };
+
+        outContacts.clear();
+
+        CollideShapeSettings settings;
+        settings.m_activeEdgeMode = EActiveEdgeMode::CollideOnlyWithActive;
+        settings.m_activeEdgeMovementDirection = movementDirection;
+        settings.m_backFaceMode = m_backFaceMode;
+        settings.m_collisionTolerance = m_collisionTolerance;
+        settings.m_maxSeparationDistance = m_characterPadding + m_predictiveContactDistance;
+
+        const RMat44 centerOfMassTransform = GetCenterOfMassTransform(position);
+
+        ContactCollector collector(*this, position, outContacts);
+        for (const NearbyShape& nearbyShape : m_nearbyShapes)
+        {
+            collector.m_pBody = &m_nearbyBodies[nearbyShape.m_bodyIndex];
+            collector.m_pShape = &nearbyShape.m_shape;
+            nearbyShape.m_shape.CollideShape(m_pShape, Vec3::One(), centerOfMassTransform, settings, position, collector, shapeFilter);
+        }
+    }
+
+    bool CharacterVirtual::GetFirstContactForSweep(const RVec3& position, const Vec3& displacement, const ShapeFilter& shapeFilter, Contact& outContact) const
+    {
+        // Keeps the closest hit that we're moving into. Hits that we're moving away from (e.g. contacts that we are
+        // already touching at the start of the sweep) are ignored.
+        class FirstContactCollector final : public CastShapeCollector
+        {
+        public:
+            explicit FirstContactCollector(const Vec3& displacement) : m_displacement(displacement) {}
+
+            virtual void AddHit(const ShapeCastResult& result) override
+            {
+                if (result.GetEarlyOutFraction() >= GetEarlyOutFraction())
+                    return;
+
+                const Vec3 contactNormal = -result.m_penetrationAxis.NormalizedOr(Vec3::Zero());
+                if (contactNormal.Dot(m_displacement) >= 0.f)
+                    return;
+
+                m_hit = result;
+                m_pHitBody = m_pBody;
+                m_pHitShape = m_pShape;
+                UpdateEarlyOutFraction(result.GetEarlyOutFraction());
+            }
+
+            Vec3                        m_displacement;
+            const NearbyBody*           m_pBody = nullptr;
+            const TransformedShape*     m_pShape = nullptr;
+            ShapeCastResult             m_hit;
+            const NearbyBody*           m_pHitBody = nullptr;
+            const TransformedShape*     m_pHitShape = nullptr;
+        };
+
+        if (displacement.IsNearZero())
+            return false;
+
+        const RShapeCast shapeCast(m_pShape, Vec3::One(), GetCenterOfMassTransform(position), displacement);
+
+        ShapeCastSettings settings;
+        settings.m_activeEdgeMode = EActiveEdgeMode::CollideOnlyWithActive;
+        settings.m_activeEdgeMovementDirection = displacement;
+        settings.m_collisionTolerance = m_collisionTolerance;
+        settings.SetBackFaceMode(m_backFaceMode);
+        settings.m_useShrunkenShapeAndConvexRadius = true;
+        settings.m_returnDeepestPoint = false;
+
+        FirstContactCollector collector(displacement);
+        for (const NearbyShape& nearbyShape : m_nearbyShapes)
+        {
+            collector.m_pBody = &m_nearbyBodies[nearbyShape.m_bodyIndex];
+            collector.m_pShape = &nearbyShape.m_shape;
+            nearbyShape.m_shape.CastShape(shapeCast, settings, position, collector, shapeFilter);
+        }
+
+        if (collector.m_pHitBody == nullptr)
+            return false;
+
+        const ShapeCastResult& hit = collector.m_hit;
+        const NearbyBody& body = *collector.m_pHitBody;
+
+        outContact = Contact();
+        outContact.m_position = position + hit.m_contactPointOn2;
+        outContact.m_linearVelocity = body.m_linearVelocity + body.m_angularVelocity.Cross(Vec3(outContact.m_position - body.m_centerOfMass));
+        outContact.m_contactNormal = -hit.m_penetrationAxis.NormalizedOr(Vec3::Zero());
+        outContact.m_surfaceNormal = collector.m_pHitShape->GetWorldSpaceSurfaceNormal(hit.m_subShapeID2, outContact.m_position);
+        if (outContact.m_surfaceNormal.Dot(outContact.m_contactNormal) < 0.f)
+            outContact.m_surfaceNormal = -outContact.m_surfaceNormal;
+        outContact.m_distance = -hit.m_penetrationDepth;
+        outContact.m_fraction = hit.m_fraction;
+        outContact.m_bodyID = body.m_bodyID;
+        outContact.m_subShapeID = hit.m_subShapeID2;
+        outContact.m_motionType = body.m_motionType;
+
+        // Correct the fraction so that we keep the padding distance (p) along the contact normal (n). Moving back along the
+        // displacement (d) by d' gives: p / d' = -n.d / |d|, so the new fraction becomes f' = f - d' / |d| = f + p / n.d.
+        const float dot = outContact.m_contactNormal.Dot(displacement);
+        if (dot < 0.f)
+            outContact.m_fraction = math::Max(0.f, outContact.m_fraction + m_characterPadding / dot);
+
+        return true;
+    }
+
+    void CharacterVirtual::DetermineConstraints(ContactList& contacts, const float deltaTime, ConstraintList& outConstraints) const
+    {
+        outConstraints.clear();
+        outConstraints.reserve(2 * contacts.size());
+
+        for (Contact& contact : contacts)
+        {
+            // Penetrating contacts get a velocity that pushes the character out.
+            Vec3 contactVelocity = contact.m_linearVelocity;
+            if (contact.m_distance < 0.f)
+                contactVelocity -= contact.m_contactNormal * (contact.m_distance * m_penetrationRecoverySpeed / deltaTime);
+
+            Constraint& constraint = outConstraints.emplace_back();
+            constraint.m_pContact = &contact;
+            constraint.m_linearVelocity = contactVelocity;
+            constraint.m_plane = Plane(contact.m_contactNormal, contact.m_distance - m_characterPadding);
+
+            // If the slope is too steep, add a second, vertical plane that prevents the character from walking up the slope.
+            // The contact normal is used instead of the surface normal to allow for better sliding, as the surface normal may
+            // point against the movement direction.
+            if (!IsSlopeTooSteep(contact.m_surfaceNormal))
+                continue;
+
+            // A perfectly horizontal normal is already a vertical plane.
+            const float dot = contact.m_contactNormal.Dot(m_up);
+            if (dot <= 1.0e-3f)
+                continue;
+
+            constraint.m_isSteepSlope = true;
+
+            const Vec3 horizontalNormal = (contact.m_contactNormal - dot * m_up).Normalized();
+
+            Constraint& verticalConstraint = outConstraints.emplace_back();
+            verticalConstraint.m_pContact = &contact;
+            // Project the contact velocity on the new normal so that both planes push at an equal rate.
+            verticalConstraint.m_linearVelocity = contactVelocity.Dot(horizontalNormal) * horizontalNormal;
+            // Distance that we have to travel horizontally to hit the contact plane.
+            verticalConstraint.m_plane = Plane(horizontalNormal, contact.m_distance / horizontalNormal.Dot(contact.m_contactNormal) - m_characterPadding);
+        }
+    }
+
+    void CharacterVirtual::SolveConstraints(const Vec3& velocity, float timeRemaining, ConstraintList& constraints, float& outTimeSimulated, Vec3& outDisplacement) const
+    {
+        outDisplacement = Vec3::Zero();
+        outTimeSimulated = 0.f;
+
+        // Without constraints we can immediately move to the target.
+        if (constraints.empty())
+        {
+            outDisplacement = velocity * timeRemaining;
+            outTimeSimulated = timeRemaining;
+            return;
+        }
+
+        std::vector<Constraint*> sortedConstraints(constraints.size());
+        for (size_t i = 0; i < constraints.size(); ++i)
+            sortedConstraints[i] = &constraints[i];
+
+        // Constraints that were hit without moving a significant distance since. Used to find the crease between two planes.
+        std::vector<Constraint*> previousConstraints;
+        previousConstraints.reserve(m_maxConstraintIterations);
+
+        // The velocity that we use for the displacement; it changes each time we hit a plane.
+        Vec3 currentVelocity = velocity;
+        // The last velocity that was applied, used to detect when the velocity reverses.
+        Vec3 lastVelocity = velocity;
+
+        for (uint32 iteration = 0; iteration < m_maxConstraintIterations; ++iteration)
+        {
+            // Calculate the time of impact for all constraints.
+            for (Constraint& constraint : constraints)
+            {
+                constraint.m_projectedVelocity = constraint.m_plane.GetNormal().Dot(constraint.m_linearVelocity - currentVelocity);
+                if (constraint.m_projectedVelocity < 1.0e-6f)
+                {
+                    constraint.m_timeOfImpact = FLT_MAX;
+                    continue;
+                }
+
+                // Accept the movement if it penetrates the plane by too little.
+                const float distance = constraint.m_plane.SignedDistanceTo(outDisplacement);
+                if (distance - constraint.m_projectedVelocity * timeRemaining > -1.0e-4f)
+                    constraint.m_timeOfImpact = FLT_MAX;
+                else
+                    constraint.m_timeOfImpact = math::Max(0.f, distance / constraint.m_projectedVelocity);
+            }
+
+            std::sort(sortedConstraints.begin(), sortedConstraints.end(), [](const Constraint* pLeft, const Constraint* pRight)
+            {
+                // If both constraints hit at t = 0, order the one that will push the character furthest first. Because penetrating
+                // contacts have a velocity that pushes the character out, this resolves the deepest penetration first.
+                if (pLeft->m_timeOfImpact <= 0.f && pRight->m_timeOfImpact <= 0.f)
+                    return pLeft->m_projectedVelocity > pRight->m_projectedVelocity;
+
+                if (pLeft->m_timeOfImpact != pRight->m_timeOfImpact)
+                    return pLeft->m_timeOfImpact < pRight->m_timeOfImpact;
+
+                // As a tie-breaker, sort static first so that it has the most influence.
+                return pLeft->m_pContact->m_motionType < pRight->m_pContact->m_motionType;
+            });
+
+            // If we can't reach the first constraint, we can reach our goal.
+            Constraint* pConstraint = sortedConstraints.front();
+            if (pConstraint->m_timeOfImpact >= timeRemaining)
+            {
+                outDisplacement += currentVelocity * timeRemaining;
+                outTimeSimulated += timeRemaining;
+                return;
+            }
+            pConstraint->m_pContact->m_hadCollision = true;
+
+            // Move to the contact.
+            outDisplacement += currentVelocity * pConstraint->m_timeOfImpact;
+            timeRemaining -= pConstraint->m_timeOfImpact;
+            outTimeSimulated += pConstraint->m_timeOfImpact;
+
+            if (timeRemaining < m_minTimeRemaining)
+                return;
+
+            // If we've moved significantly, forget the previous constraints.
+            if (pConstraint->m_timeOfImpact > 1.0e-4f)
+                previousConstraints.clear();
+
+            const Vec3 planeNormal = pConstraint->m_plane.GetNormal();
+
+            // When hitting a steep slope, first cancel the velocity towards the slope so that we don't slide up the slope. We may
+            // hit the slope before the vertical plane that was added for it, which would result in a small movement up and jitter.
+            if (pConstraint->m_isSteepSlope)
+            {
+                // Vertical plane that blocks any further movement up the slope (not normalized).
+                const Vec3 verticalPlaneNormal = planeNormal - planeNormal.Dot(m_up) * m_up;
+                const Vec3 relativeVelocity = currentVelocity - pConstraint->m_linearVelocity;
+                currentVelocity -= math::Min(0.f, relativeVelocity.Dot(verticalPlaneNormal)) * verticalPlaneNormal / verticalPlaneNormal.LengthSqr();
+            }
+
+            // Cancel the relative velocity in the direction of the normal.
+            const Vec3 relativeVelocity = currentVelocity - pConstraint->m_linearVelocity;
+            Vec3 newVelocity = currentVelocity - relativeVelocity.Dot(planeNormal) * planeNormal;
+
+            // Find the previous constraint that we will violate the most if we move in this new direction.
+            float highestPenetration = 0.f;
+            Constraint* pOtherConstraint = nullptr;
+            for (Constraint* pPrevious : previousConstraints)
+            {
+                if (pPrevious == pConstraint)
+                    continue;
+
+                const Vec3 otherNormal = pPrevious->m_plane.GetNormal();
+                const float penetration = (pPrevious->m_linearVelocity - newVelocity).Dot(otherNormal);
+                if (penetration > highestPenetration)
+                {
+                    // Skip (anti-)parallel normals, they make the cross product below degenerate. Slack is approx 10 degrees.
+                    const float dot = otherNormal.Dot(planeNormal);
+                    if (dot < 0.984f && dot > -0.984f)
+                    {
+                        highestPenetration = penetration;
+                        pOtherConstraint = pPrevious;
+                    }
+                }
+            }
+
+            // If we are stuck between two planes, slide along the crease.
+            if (pOtherConstraint != nullptr)
+            {
+                const Vec3 otherNormal = pOtherConstraint->m_plane.GetNormal();
+                const Vec3 slideDirection = planeNormal.Cross(otherNormal).Normalized();
+                const Vec3 velocityInSlideDirection = newVelocity.Dot(slideDirection) * slideDirection;
+
+                // Cancel the velocity of each constraint in the direction of the other plane so that we don't keep ping-ponging between them.
+                pConstraint->m_linearVelocity -= math::Min(0.f, pConstraint->m_linearVelocity.Dot(otherNormal)) * otherNormal;
+                pOtherConstraint->m_linearVelocity -= math::Min(0.f, pOtherConstraint->m_linearVelocity.Dot(planeNormal)) * planeNormal;
+
+                // Add the velocities of both constraints perpendicular to the slide direction.
+                const Vec3 perpendicularVelocity = pConstraint->m_linearVelocity - pConstraint->m_linearVelocity.Dot(slideDirection) * slideDirection;
+                const Vec3 otherPerpendicularVelocity = pOtherConstraint->m_linearVelocity - pOtherConstraint->m_linearVelocity.Dot(slideDirection) * slideDirection;
+                newVelocity = velocityInSlideDirection + perpendicularVelocity + otherPerpendicularVelocity;
+            }
+
+            // If the constraint has velocity we accept the new velocity, otherwise we stop when the velocity reversed:
+            // we're stuck in a corner.
+            if (pConstraint->m_linearVelocity.IsNearZero(1.0e-8f) && newVelocity.Dot(lastVelocity) <= 0.f)
+                return;
+
+            currentVelocity = newVelocity;
+            lastVelocity = newVelocity;
+            previousConstraints.push_back(pConstraint);
+
+            if (currentVelocity.IsNearZero(1.0e-8f))
+                return;
+        }
+    }
+
+    void CharacterVirtual::MoveShape(RVec3& position, const Vec3& velocity, const float deltaTime, const ShapeFilter& shapeFilter, ContactList* pOutActiveContacts)
+    {
+        const Vec3 movementDirection = velocity.NormalizedOr(Vec3::Zero());
+
+        float timeRemaining = deltaTime;
+        for (uint32 iteration = 0; iteration < m_maxCollisionIterations && timeRemaining >= m_minTimeRemaining; ++iteration)
+        {
+            // Contacts are only gathered from the nearby shapes that were collected at the start of the update.
+            GetContactsAtPosition(position, movementDirection, shapeFilter, m_tempContacts);
+            DetermineConstraints(m_tempContacts, deltaTime, m_tempConstraints);
+
+            Vec3 displacement;
+            float timeSimulated;
+            SolveConstraints(velocity, timeRemaining, m_tempConstraints, timeSimulated, displacement);
+
+            // Store the contacts now that the colliding ones have been marked.
+            if (pOutActiveContacts != nullptr)
+                *pOutActiveContacts = m_tempContacts;
+
+            // Sweep to test if the path is really unobstructed; the contacts only cover the predictive distance.
+            Contact castContact;
+            if (GetFirstContactForSweep(position, displacement, shapeFilter, castContact))
+            {
+                displacement *= castContact.m_fraction;
+                timeSimulated *= castContact.m_fraction;
+            }
+
+            position += displacement;
+            timeRemaining -= timeSimulated;
+
+            // If the displacement was too small, we can't make any further progress this update.
+            if (displacement.LengthSqr() < 1.0e-8f)
+                break;
+        }
+    }
+
+    void CharacterVirtual::UpdateSupportingContact(const bool skipContactVelocityCheck)
+    {
+        // Flag contacts as colliding when they are close enough, unless we're moving away from them.
+        // Contacts that were marked as colliding by MoveShape() keep their flag.
+        for (Contact& contact : m_activeContacts)
+        {
+            if (!contact.m_hadCollision
+                && contact.m_distance < m_collisionTolerance
+                && (skipContactVelocityCheck || contact.m_surfaceNormal.Dot(m_linearVelocity - contact.m_linearVelocity) <= 1.0e-4f))
+            {
+                contact.m_hadCollision = true;
+            }
+        }
+
+        uint32 numSupported = 0;
+        uint32 numSliding = 0;
+        uint32 numAverageNormals = 0;
+        Vec3 averageNormal = Vec3::Zero();
+        Vec3 averageVelocity = Vec3::Zero();
+        const Contact* pSupportingContact = nullptr;
+        float maxCosAngle = -FLT_MAX;
+        const Contact* pDeepestContact = nullptr;
+        float smallestDistance = FLT_MAX;
+
+        for (const Contact& contact : m_activeContacts)
+        {
+            if (!contact.m_hadCollision)
+                continue;
+
+            if (contact.m_distance < smallestDistance)
+            {
+                pDeepestContact = &contact;
+                smallestDistance = contact.m_distance;
+            }
+
+            // The contact whose normal points most upwards is the supporting contact.
+            const float cosAngle = contact.m_surfaceNormal.Dot(m_up);
+            if (maxCosAngle < cosAngle)
+            {
+                pSupportingContact = &contact;
+                maxCosAngle = cosAngle;
+            }
+
+            const bool isSupported = !IsSlopeTooSteep(contact.m_surfaceNormal);
+            if (isSupported)
+                ++numSupported;
+            else
+                ++numSliding;
+
+            // Contacts that are less than 85 degrees from the up vector are used for the average ground normal and velocity.
+            if (cosAngle >= 0.08f)
+            {
+                averageNormal += contact.m_surfaceNormal;
+                ++numAverageNormals;
+
+                // For kinematic bodies that support us, take the velocity at our position instead of at the contact
+                // position so that we properly follow a rotating platform.
+                Vec3 velocity = contact.m_linearVelocity;
+                if (contact.m_motionType == EBodyMotionType::Kinematic && isSupported)
+                {
+                    for (const NearbyBody& body : m_nearbyBodies)
+                    {
+                        if (body.m_bodyID == contact.m_bodyID)
+                        {
+                            velocity = body.m_linearVelocity + body.m_angularVelocity.Cross(Vec3(m_position - body.m_centerOfMass));
+                            break;
+                        }
+                    }
+                }
+                averageVelocity += velocity;
+            }
+        }
+
+        const Contact* pBestContact = pSupportingContact != nullptr? pSupportingContact : pDeepestContact;
+
+        if (numAverageNormals > 0)
+        {
+            m_groundNormal = averageNormal.Normalized();
+            m_groundVelocity = averageVelocity / static_cast<float>(numAverageNormals);
+        }
+        else if (pBestContact != nullptr)
+        {
+            m_groundNormal = pBestContact->m_surfaceNormal;
+            m_groundVelocity = pBestContact->m_linearVelocity;
+        }
+        else
+        {
+            m_groundNormal = Vec3::Zero();
+            m_groundVelocity = Vec3::Zero();
+        }
+
+        if (pBestContact != nullptr)
+        {
+            m_groundPosition = pBestContact->m_position;
+            m_groundBodyID = pBestContact->m_bodyID;
+            m_groundSubShapeID = pBestContact->m_subShapeID;
+            m_groundMotionType = pBestContact->m_motionType;
+        }
+        else
+        {
+            m_groundPosition = RVec3::Zero();
+            m_groundBodyID = BodyID();
+            m_groundSubShapeID = SubShapeID();
+            m_groundMotionType = EBodyMotionType::Static;
+        }
+
+        if (numSupported > 0)
+            m_groundState = EGroundState::OnGround;
+        else if (numSliding > 0)
+            m_groundState = EGroundState::OnSteepGround;
+        else
+            m_groundState = pBestContact != nullptr? EGroundState::NotSupported : EGroundState::InAir;
+    }
+
+    void CharacterVirtual::MoveToContact(const RVec3& position, const Contact& contact, const ShapeFilter& shapeFilter)
+    {
+        m_position = position;
+
+        GetContactsAtPosition(m_position, m_linearVelocity.NormalizedOr(Vec3::Zero()), shapeFilter, m_activeContacts);
+
+        // Make sure that the contact that we moved to is marked as colliding; it may not have been found
+        // if it was culled by the hit reduction or lies just outside the predictive distance.
+        bool found = false;
+        for (Contact& activeContact : m_activeContacts)
+        {
+            if (activeContact.m_bodyID == contact.m_bodyID && activeContact.m_subShapeID == contact.m_subShapeID)
+            {
+                activeContact.m_hadCollision = true;
+                found = true;
+            }
+        }
+
+        if (!found && m_activeContacts.size() < m_maxNumContacts)
+        {
+            Contact& newContact = m_activeContacts.emplace_back(contact);
+            newContact.m_distance = -m_characterPadding;
+            newContact.m_hadCollision = true;
+        }
+
+        UpdateSupportingContact(true);
+    }
+
+    void CharacterVirtual::UpdateInternal(const float deltaTime, const Vec3& gravity, const ShapeFilter& shapeFilter)
+    {
+        MoveShape(m_position, m_linearVelocity, deltaTime, shapeFilter, &m_activeContacts);
+        UpdateSupportingContact(false);
+        ApplyImpulses(deltaTime, gravity);
+    }
+
+    bool CharacterVirtual::CanWalkStairs(const Vec3& linearVelocity) const
+    {
+        if (!IsSupported())
+            return false;
+
+        // Check if there's enough horizontal velocity to trigger a stair walk.
+        const Vec3 horizontalVelocity = linearVelocity - linearVelocity.Dot(m_up) * m_up;
+        if (horizontalVelocity.IsNearZero(1.0e-6f))
+            return false;
+
+        // We need to be pushing into a slope that is too steep.
+        for (const Contact& contact : m_activeContacts)
+        {
+            if (contact.m_hadCollision
+                && contact.m_surfaceNormal.Dot(horizontalVelocity - contact.m_linearVelocity) < 0.f
+                && IsSlopeTooSteep(contact.m_surfaceNormal))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool CharacterVirtual::WalkStairs(const float deltaTime, const Vec3& stepUp, const Vec3& stepForward, const Vec3& stepForwardTest, const Vec3& stepDownExtra, const ShapeFilter& shapeFilter)
+    {
+        // Move up.
+        Vec3 up = stepUp;
+        Contact contact;
+        if (GetFirstContactForSweep(m_position, up, shapeFilter, contact))
+        {
+            if (contact.m_fraction < 1.0e-6f)
+                return false;
+
+            up *= contact.m_fraction;
+        }
+        const RVec3 upPosition = m_position + up;
+
+        // Collect the normals of the steep slopes that we're walking into. This needs to happen before MoveShape(),
+        // which overwrites the temporary contacts.
+        const Vec3 characterVelocity = stepForward / deltaTime;
+        const Vec3 horizontalVelocity = characterVelocity - characterVelocity.Dot(m_up) * m_up;
+        std::vector<Vec3> steepSlopeNormals;
+        for (const Contact& activeContact : m_activeContacts)
+        {
+            if (activeContact.m_hadCollision
+                && activeContact.m_surfaceNormal.Dot(horizontalVelocity - activeContact.m_linearVelocity) < 0.f
+                && IsSlopeTooSteep(activeContact.m_surfaceNormal))
+            {
+                steepSlopeNormals.push_back(activeContact.m_surfaceNormal);
+            }
+        }
+        if (steepSlopeNormals.empty())
+            return false;
+
+        // Horizontal movement.
+        RVec3 newPosition = upPosition;
+        MoveShape(newPosition, characterVelocity, deltaTime, shapeFilter, nullptr);
+        const Vec3 horizontalMovement = Vec3(newPosition - upPosition);
+        const float horizontalMovementSqr = horizontalMovement.LengthSqr();
+        if (horizontalMovementSqr < 1.0e-8f)
+            return false;
+
+        // Check that we made progress towards one of the steep slopes. If not, we just slid along the slope and
+        // accepting the step would move us faster than we should, since the normal movement was already done.
+        const float maxDot = -0.05f * stepForward.Length();
+        bool madeProgress = false;
+        for (const Vec3& normal : steepSlopeNormals)
+        {
+            if (normal.Dot(horizontalMovement) < maxDot)
+            {
+                madeProgress = true;
+                break;
+            }
+        }
+        if (!madeProgress)
+            return false;
+
+        // Move down towards the floor: the same amount as we went up, plus the extra.
+        Vec3 down = -up + stepDownExtra;
+        if (!GetFirstContactForSweep(newPosition, down, shapeFilter, contact))
+            return false;
+
+        down *= contact.m_fraction;
+        newPosition += down;
+
+        // Test for a floor that will support the character.
+        if (IsSlopeTooSteep(contact.m_surfaceNormal))
+        {
+            if (stepForwardTest.IsNearZero())
+                return false;
+
+            // The delta time may be very small, so we may have hit the edge of the step where the normal is too horizontal.
+            // Test again further along to judge if the floor at the top of the step is walkable.
+            RVec3 testPosition = upPosition;
+            MoveShape(testPosition, stepForwardTest / deltaTime, deltaTime, shapeFilter, nullptr);
+            const float testHorizontalMovementSqr = Vec3(testPosition - upPosition).LengthSqr();
+            if (testHorizontalMovementSqr <= horizontalMovementSqr + 1.0e-8f)
+                return false;
+
+            Contact testContact;
+            if (!GetFirstContactForSweep(testPosition, down, shapeFilter, testContact))
+                return false;
+
+            if (IsSlopeTooSteep(testContact.m_surfaceNormal))
+                return false;
+        }
+
+        MoveToContact(newPosition, contact, shapeFilter);
+        return true;
+    }
+
+    bool CharacterVirtual::StickToFloor(const Vec3& stepDown, const ShapeFilter& shapeFilter)
+    {
+        Contact contact;
+        if (!GetFirstContactForSweep(m_position, stepDown, shapeFilter, contact))
+            return false;
+
+        MoveToContact(m_position + contact.m_fraction * stepDown, contact, shapeFilter);
+        return true;
+    }
+
+    void CharacterVirtual::ApplyImpulses(const float deltaTime, const Vec3& gravity) const
+    {
+        BodyInterface& bodyInterface = m_pScene->GetBodyInterface();
+
+        // Push the dynamic bodies that we walked into, limited by the strength of the character.
+        for (const Contact& contact : m_activeContacts)
+        {
+            // The body that we're standing on receives our weight below instead.
+            if (!contact.m_hadCollision || contact.m_motionType != EBodyMotionType::Dynamic || contact.m_bodyID == m_groundBodyID)
+                continue;
+
+            const float approachSpeed = (contact.m_linearVelocity - m_linearVelocity).Dot(contact.m_contactNormal);
+            if (approachSpeed <= 0.f)
+                continue;
+
+            const float impulse = math::Min(approachSpeed * m_mass, m_maxStrength * deltaTime);
+            bodyInterface.AddImpulse(contact.m_bodyID, -impulse * contact.m_contactNormal, contact.m_position);
+        }
+
+        // Apply our weight to the dynamic body that we're standing on.
+        if (m_groundState == EGroundState::OnGround && m_groundMotionType == EBodyMotionType::Dynamic)
+            bodyInterface.AddImpulse(m_groundBodyID, m_mass * deltaTime * gravity, m_groundPosition);
+    }
+}
@@ -0,0 +1,357 @@
+// CharacterVirtual.h
+#pragma once
+#include <vector>
+#include "Nessie/Core/Memory/StrongPtr.h"
+#include "Nessie/Geometry/Plane.h"
+#include "Nessie/Physics/Body/BodyFilter.h"
+#include "Nessie/Physics/Body/MotionType.h"
+#include "Nessie/Physics/Collision/BackFaceMode.h"
+#include "Nessie/Physics/Collision/ShapeFilter.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+#include "Nessie/Physics/Collision/BroadPhase/BroadPhaseLayer.h"
+#include "Nessie/Physics/Collision/CollisionLayer.h"
+
+namespace nes
+{
+    class PhysicsScene;
+    class JobSystem;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings used to create a CharacterVirtual.
+    //----------------------------------------------------------------------------------------------------
+    struct CharacterVirtualSettings
+    {
+        ConstStrongPtr<Shape>   m_pShape;                                                           /// Shape of the character. Should be a convex shape, usually a capsule, with the bottom at the character's position.
+        Vec3                    m_up                            = Vec3::AxisY();                    /// Vector indicating the up direction of the character.
+        float                   m_maxSlopeAngle                 = math::ToRadians(50.f);            /// Maximum angle of slope that the character can still walk on (radians).
+        float                   m_mass                          = 70.f;                             /// Character mass (kg). Used to push down objects with gravity when the character is standing on top.
+        float                   m_maxStrength                   = 100.f;                            /// Maximum force with which the character can push other bodies (N).
+        float                   m_characterPadding              = 0.02f;                            /// Distance to keep between the shape and the geometry that it collides with (m).
+        float                   m_predictiveContactDistance     = 0.1f;                             /// How far to scan outside of the shape for predictive contacts (m). Larger values are more robust against tunneling but find more contacts.
+        float                   m_penetrationRecoverySpeed      = 1.f;                              /// Fraction of the penetration that is resolved each update. 1 means fully resolving the penetration in one update.
+        float                   m_collisionTolerance            = 1.0e-3f;                          /// How far away from a surface contacts are still considered touching (m).
+        float                   m_hitReductionCosMaxAngle       = 0.999f;                           /// Contacts with the same body whose normals are closer than this cosine are merged into a single contact.
+        float                   m_minTimeRemaining              = 1.0e-4f;                          /// Early out condition: when this much time is left to simulate, we are done (s).
+        uint32                  m_maxCollisionIterations        = 5;                                /// Max number of collision loops, each loop collects contacts, solves the constraints and moves the character.
+        uint32                  m_maxConstraintIterations       = 15;                               /// Max number of iterations used to solve the constraints of a single collision loop.
+        uint32                  m_maxNumContacts                = 256;                              /// Max number of contacts that are kept for the character.
+        EBackFaceMode           m_backFaceMode                  = EBackFaceMode::CollideWithBackFaces; /// When colliding with back faces, the character will not be able to move through back facing triangles.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings for CharacterVirtual::ExtendedUpdate(). Set a vector to zero to disable the feature.
+    //----------------------------------------------------------------------------------------------------
+    struct CharacterVirtualUpdateSettings
+    {
+        Vec3                    m_stickToFloorStepDown          = Vec3(0.f, -0.5f, 0.f);            /// How far to sweep down to find the floor after losing contact with it while not moving up.
+        Vec3                    m_walkStairsStepUp              = Vec3(0.f, 0.4f, 0.f);             /// How high a step the character can walk up.
+        float                   m_walkStairsMinStepForward      = 0.02f;                            /// Minimal horizontal distance to move forward after stepping up (m). Prevents getting stuck on the edge of a step at high frame rates.
+        float                   m_walkStairsStepForwardTest     = 0.15f;                            /// If the floor at the top of the step is too steep, test again this far ahead for a walkable floor (m).
+        float                   m_walkStairsCosAngleForwardContact = 0.258819f;                     /// Cos(75 degrees). Max angle between the ground normal and the walk direction for the forward test to follow the ground normal.
+        Vec3                    m_walkStairsStepDownExtra       = Vec3::Zero();                     /// Extra distance to sweep down after stepping up and forward, on top of the step up height.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Kinematic character controller that is not represented by a Body in the PhysicsScene.
+    ///     The character is moved by sweeping its shape through the world with CastShape and CollideShape.
+    ///     It supports walking up slopes up to a maximum angle, stepping up stairs, sticking to the floor
+    ///     when walking down a slope and standing on moving (kinematic) bodies.
+    ///
+    ///     Each update gathers the shapes around the character with a single CollectTransformedShapes query
+    ///     over the bounds of the movement. All collision iterations of that update (including stair walking
+    ///     and sticking to the floor) then query only these cached shapes instead of going through the broad
+    ///     phase again.
+    ///
+    ///     Characters do not collide with each other and do not collide with sensors. The velocity of the
+    ///     character is controlled by the user; Update() will not modify it.
+    //----------------------------------------------------------------------------------------------------
+    class CharacterVirtual
+    {
+    public:
+        enum class EGroundState : uint8
+        {
+            OnGround,           /// Character is on the ground and can move freely.
+            OnSteepGround,      /// Character is on a slope that is too steep and can't climb up any further. The user should apply gravity to slide the character down.
+            NotSupported,       /// Character is touching an object, but is not supported by it and should fall. The ground properties are still valid.
+            InAir,              /// Character is in the air and is not touching anything.
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Encapsulates a collision contact of the character.
+        //----------------------------------------------------------------------------------------------------
+        struct Contact
+        {
+            RVec3               m_position;                     /// Position where the character makes contact.
+            Vec3                m_linearVelocity;               /// Velocity of the contact point.
+            Vec3                m_contactNormal;                /// Contact normal, pointing towards the character.
+            Vec3                m_surfaceNormal;                /// Surface normal of the contact, pointing towards the character.
+            float               m_distance = 0.f;               /// Distance to the contact. <= 0 means that the character is penetrating.
+            float               m_fraction = 0.f;               /// Fraction along the path where this contact takes place.
+            BodyID              m_bodyID;                       /// ID of the body that is being touched.
+            SubShapeID          m_subShapeID;                   /// Sub shape ID of the shape that is being touched.
+            EBodyMotionType     m_motionType = EBodyMotionType::Static; /// Motion type of the body that is being touched.
+            bool                m_hadCollision = false;         /// If the character actually collided with the contact (can be false if a predictive contact never becomes a real one).
+        };
+
+        using ContactList = std::vector<Contact>;
+
+    public:
+        CharacterVirtual(const CharacterVirtualSettings& settings, const RVec3& position, const Quat& rotation, PhysicsScene* pScene);
+        CharacterVirtual(const CharacterVirtual&) = delete;
+        CharacterVirtual& operator=(const CharacterVirtual&) = delete;
+        CharacterVirtual(CharacterVirtual&&) noexcept = delete;
+        CharacterVirtual& operator=(CharacterVirtual&&) noexcept = delete;
+        ~CharacterVirtual() = default;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the shape of the character.
+        //----------------------------------------------------------------------------------------------------
+        const Shape*            GetShape() const                                        { return m_pShape; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the position of the character.
+        //----------------------------------------------------------------------------------------------------
+        RVec3                   GetPosition() const                                     { return m_position; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the position of the character. This does not check for collisions; call RefreshContacts()
+        ///     afterward to update the ground state.
+        //----------------------------------------------------------------------------------------------------
+        void                    SetPosition(const RVec3& position)                      { m_position = position; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the rotation of the character.
+        //----------------------------------------------------------------------------------------------------
+        Quat                    GetRotation() const                                     { return m_rotation; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the rotation of the character.
+        //----------------------------------------------------------------------------------------------------
+        void                    SetRotation(const Quat& rotation)                       { m_rotation = rotation; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the world transform of the character.
+        //----------------------------------------------------------------------------------------------------
+        RMat44                  GetWorldTransform() const                               { return RMat44::MakeRotationTranslation(m_rotation, m_position); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the linear velocity of the character (m/s).
+        //----------------------------------------------------------------------------------------------------
+        Vec3                    GetLinearVelocity() const                               { return m_linearVelocity; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the linear velocity of the character (m/s). This is the desired velocity; the character
+        ///     will slide along any geometry that it hits.
+        //----------------------------------------------------------------------------------------------------
+        void                    SetLinearVelocity(const Vec3& velocity)                 { m_linearVelocity = velocity; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the up vector of the character.
+        //----------------------------------------------------------------------------------------------------
+        Vec3                    GetUp() const                                           { return m_up; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the up vector of the character.
+        //----------------------------------------------------------------------------------------------------
+        void                    SetUp(const Vec3& up)                                   { m_up = up; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the maximum angle of slope that the character can still walk on (radians).
+        //----------------------------------------------------------------------------------------------------
+        float                   GetMaxSlopeAngle() const                                { return std::acos(m_cosMaxSlopeAngle); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the maximum angle of slope that the character can still walk on (radians).
+        //----------------------------------------------------------------------------------------------------
+        void                    SetMaxSlopeAngle(const float maxSlopeAngle)             { m_cosMaxSlopeAngle = std::cos(maxSlopeAngle); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if a surface with the given normal is too steep for the character to walk on.
+        //----------------------------------------------------------------------------------------------------
+        bool                    IsSlopeTooSteep(const Vec3& normal) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the current ground state of the character.
+        //----------------------------------------------------------------------------------------------------
+        EGroundState            GetGroundState() const                                  { return m_groundState; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true if the character is standing on walkable ground or on a slope that is too steep.
+        //----------------------------------------------------------------------------------------------------
+        bool                    IsSupported() const                                     { return m_groundState == EGroundState::OnGround || m_groundState == EGroundState::OnSteepGround; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the contact point with the ground.
+        //----------------------------------------------------------------------------------------------------
+        RVec3                   GetGroundPosition() const                               { return m_groundPosition; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the contact normal with the ground.
+        //----------------------------------------------------------------------------------------------------
+        Vec3                    GetGroundNormal() const                                 { return m_groundNormal; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the velocity of the ground at the character's position. Useful to make the character
+        ///     move along with a moving platform.
+        //----------------------------------------------------------------------------------------------------
+        Vec3                    GetGroundVelocity() const                               { return m_groundVelocity; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the ID of the body that the character is standing on. Invalid if the character is in the air.
+        //----------------------------------------------------------------------------------------------------
+        BodyID                  GetGroundBodyID() const                                 { return m_groundBodyID; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the sub shape ID of the shape that the character is standing on.
+        //----------------------------------------------------------------------------------------------------
+        SubShapeID              GetGroundSubShapeID() const                             { return m_groundSubShapeID; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the contacts of the character at the end of the last update.
+        //----------------------------------------------------------------------------------------------------
+        const ContactList&      GetActiveContacts() const                               { return m_activeContacts; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Move the character according to its current velocity. The character will slide along the
+        ///     geometry that it hits. Dynamic bodies that are hit are pushed with an impulse limited by the
+        ///     character's strength, and the weight of the character is applied to a dynamic body that it stands on.
+        ///	@param deltaTime : Time step to simulate.
+        ///	@param gravity : Gravity vector, used to push down the object the character is standing on.
+        ///	@param broadPhaseLayerFilter : Filter used to determine which broad phase layers the character collides with.
+        ///	@param collisionLayerFilter : Filter used to determine which collision layers the character collides with.
+        ///	@param bodyFilter : Filter used to determine which bodies the character collides with.
+        ///	@param shapeFilter : Filter used to determine which shapes the character collides with.
+        //----------------------------------------------------------------------------------------------------
+        void                    Update(const float deltaTime, const Vec3& gravity, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {});
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Update() followed by sticking to the floor and walking stairs, as configured by updateSettings.
+        ///     The nearby shapes are collected once for all of these steps.
+        //----------------------------------------------------------------------------------------------------
+        void                    ExtendedUpdate(const float deltaTime, const Vec3& gravity, const CharacterVirtualUpdateSettings& updateSettings, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {});
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Recalculate the contacts and the ground state at the current position. Call this after
+        ///     SetPosition() or when the world around the character changed without the character moving.
+        //----------------------------------------------------------------------------------------------------
+        void                    RefreshContacts(const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {});
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Run ExtendedUpdate() on a batch of characters, distributing the characters over multiple
+        ///     jobs. This blocks until all characters have been updated.
+        /// @note : The filters are shared by all jobs and must be safe to call from multiple threads. This must not
+        ///     be called while the PhysicsScene is updating. Characters don't see each other, so the result does not
+        ///     depend on the order in which they are updated, apart from the impulses applied to dynamic bodies.
+        //----------------------------------------------------------------------------------------------------
+        static void             ExtendedUpdateCharacters(CharacterVirtual* const* ppCharacters, const uint32 numCharacters, const float deltaTime, const Vec3& gravity, const CharacterVirtualUpdateSettings& updateSettings, JobSystem* pJobSystem, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {});
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Cached properties of a body that was found by CollectNearbyShapes().
+        //----------------------------------------------------------------------------------------------------
+        struct NearbyBody
+        {
+            RVec3               m_centerOfMass;
+            Vec3                m_linearVelocity;
+            Vec3                m_angularVelocity;
+            BodyID              m_bodyID;
+            EBodyMotionType     m_motionType;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : A shape that was found by CollectNearbyShapes() and the index of the body that it belongs to.
+        //----------------------------------------------------------------------------------------------------
+        struct NearbyShape
+        {
+            TransformedShape    m_shape;
+            uint32              m_bodyIndex;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : A plane that the character cannot move through, created from a Contact.
+        //----------------------------------------------------------------------------------------------------
+        struct Constraint
+        {
+            Contact*            m_pContact = nullptr;           /// Contact that this constraint was generated from.
+            float               m_timeOfImpact = 0.f;           /// Calculated time of impact (can be negative if penetrating).
+            float               m_projectedVelocity = 0.f;      /// Velocity of the contact projected on the contact normal (negative if separating).
+            Vec3                m_linearVelocity;               /// Velocity of the contact (can contain a corrective velocity to resolve penetration).
+            Plane               m_plane;                        /// Plane around the origin that describes how far we can displace (from the origin).
+            bool                m_isSteepSlope = false;         /// If this constraint belongs to a steep slope.
+        };
+
+        using ConstraintList = std::vector<Constraint>;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Filters that are used by a single update.
+        //----------------------------------------------------------------------------------------------------
+        struct QueryFilters
+        {
+            const BroadPhaseLayerFilter& m_broadPhaseLayerFilter;
+            const CollisionLayerFilter& m_collisionLayerFilter;
+            const BodyFilter&   m_bodyFilter;
+            const ShapeFilter&  m_shapeFilter;
+        };
+
+        RMat44                  GetCenterOfMassTransform(const RVec3& position) const;
+        AABox                   GetSweptBounds(const Vec3& displacement, const float extraMargin) const;
+        void                    CollectNearbyShapes(const AABox& bounds, const QueryFilters& filters);
+        void                    GetContactsAtPosition(const RVec3& position, const Vec3& movementDirection, const ShapeFilter& shapeFilter, ContactList& outContacts) const;
+        bool                    GetFirstContactForSweep(const RVec3& position, const Vec3& displacement, const ShapeFilter& shapeFilter, Contact& outContact) const;
+        void                    DetermineConstraints(ContactList& contacts, const float deltaTime, ConstraintList& outConstraints) const;
+        void                    SolveConstraints(const Vec3& velocity, float timeRemaining, ConstraintList& constraints, float& outTimeSimulated, Vec3& outDisplacement) const;
+        void                    MoveShape(RVec3& position, const Vec3& velocity, const float deltaTime, const ShapeFilter& shapeFilter, ContactList* pOutActiveContacts);
+        void                    UpdateSupportingContact(const bool skipContactVelocityCheck);
+        void                    MoveToContact(const RVec3& position, const Contact& contact, const ShapeFilter& shapeFilter);
+        void                    UpdateInternal(const float deltaTime, const Vec3& gravity, const ShapeFilter& shapeFilter);
+        bool                    CanWalkStairs(const Vec3& linearVelocity) const;
+        bool                    WalkStairs(const float deltaTime, const Vec3& stepUp, const Vec3& stepForward, const Vec3& stepForwardTest, const Vec3& stepDownExtra, const ShapeFilter& shapeFilter);
+        bool                    StickToFloor(const Vec3& stepDown, const ShapeFilter& shapeFilter);
+        void                    ApplyImpulses(const float deltaTime, const Vec3& gravity) const;
+
+    private:
+        PhysicsScene*           m_pScene = nullptr;
+        ConstStrongPtr<Shape>   m_pShape;
+
+        /// Settings
+        Vec3                    m_up;
+        float                   m_cosMaxSlopeAngle;
+        float                   m_mass;
+        float                   m_maxStrength;
+        float                   m_characterPadding;
+        float                   m_predictiveContactDistance;
+        float                   m_penetrationRecoverySpeed;
+        float                   m_collisionTolerance;
+        float                   m_hitReductionCosMaxAngle;
+        float                   m_minTimeRemaining;
+        uint32                  m_maxCollisionIterations;
+        uint32                  m_maxConstraintIterations;
+        uint32                  m_maxNumContacts;
+        EBackFaceMode           m_backFaceMode;
+
+        /// State
+        RVec3                   m_position;
+        Quat                    m_rotation;
+        Vec3                    m_linearVelocity = Vec3::Zero();
+
+        /// Ground
+        EGroundState            m_groundState = EGroundState::InAir;
+        RVec3                   m_groundPosition = RVec3::Zero();
+        Vec3                    m_groundNormal = Vec3::Zero();
+        Vec3                    m_groundVelocity = Vec3::Zero();
+        BodyID                  m_groundBodyID;
+        SubShapeID              m_groundSubShapeID;
+        EBodyMotionType         m_groundMotionType = EBodyMotionType::Static;
+
+        /// Contacts of the last update.
+        ContactList             m_activeContacts;
+
+        /// Shapes around the character, collected once per update and reused by all collision iterations.
+        std::vector<NearbyBody> m_nearbyBodies;
+        std::vector<NearbyShape> m_nearbyShapes;
+
+        /// Scratch buffers for MoveShape(), kept around to avoid allocating every update.
+        ContactList             m_tempContacts;
+        ConstraintList          m_tempConstraints;
+    };
+}
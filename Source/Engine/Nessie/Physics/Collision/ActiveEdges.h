@@ -0,0 +1,96 @@
+// ActiveEdges.h
+#pragma once
+#include "Nessie/Geometry/ClosestPoint.h"
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Helper functions to find the active edges of a triangle mesh and to correct contact
+///     normals on inactive edges. An edge is active if it has no neighbouring triangle or if the angle
+///     between the two connecting faces is too large. Colliding with an inactive edge causes 'ghost
+///     collisions', where an object sliding over a flat mesh bumps into the edges between triangles.
+//----------------------------------------------------------------------------------------------------
+namespace nes::ActiveEdges
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Check if an edge that is shared by two triangles is active.
+    ///	@param normal1 : Normal of the first triangle.
+    ///	@param normal2 : Normal of the second triangle.
+    ///	@param edgeDirection : Direction of the edge, in the winding order of the first triangle.
+    ///	@param cosThresholdAngle : Cosine of the angle above which a convex edge is considered active.
+    //----------------------------------------------------------------------------------------------------
+    inline bool IsEdgeActive(const Vec3& normal1, const Vec3& normal2, const Vec3& edgeDirection, const float cosThresholdAngle)
+    {
+        // If the normals are opposite, the triangles are back to back, and the edge is active.
+        const float cosAngleNormals = normal1.Dot(normal2);
+        if (cosAngleNormals < -0.999848f) // cos(179 degrees)
+            return true;
+
+        // Concave edges are never active, an object cannot hit them without hitting one of the faces first.
+        if (normal1.Cross(normal2).Dot(edgeDirection) < 0.f)
+            return false;
+
+        // Convex edges are active when the angle is larger than the threshold.
+        return cosAngleNormals < cosThresholdAngle;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the active edge flags of a triangle after swapping vertex 1 and 2 to flip its winding order.
+    //----------------------------------------------------------------------------------------------------
+    inline uint8 FlipWinding(const uint8 activeEdges)
+    {
+        // Edge 0 (v0 -> v1) becomes edge 2 (v1 -> v0), edge 1 stays the same and edge 2 (v2 -> v0) becomes edge 0 (v0 -> v2).
+        return static_cast<uint8>(((activeEdges & 0b001) << 2) | (activeEdges & 0b010) | ((activeEdges & 0b100) >> 2));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Replace the penetration axis of a collision with a triangle with the triangle normal when
+    ///     the contact is on an inactive edge, or on a vertex where only inactive edges meet.
+    ///	@param v0, v1, v2 : Vertices of the triangle.
+    ///	@param triangleNormal : Normal of the triangle, pointing in the same direction as a penetration axis
+    ///     into the face (so away from the colliding object). Does not need to be normalized.
+    ///	@param activeEdges : Bit 'i' is set when the edge from vertex 'i' to vertex 'i + 1' is active.
+    ///	@param point : Contact point on the triangle.
+    ///	@param penetrationAxis : Penetration axis that was calculated for the collision. Does not need to be normalized.
+    ///	@param movementDirection : Direction that the colliding object is moving in. If the triangle normal would
+    ///     affect this movement more than the calculated penetration axis, the penetration axis is kept.
+    ///	@returns : The corrected penetration axis.
+    //----------------------------------------------------------------------------------------------------
+    inline Vec3 FixNormal(const Vec3& v0, const Vec3& v1, const Vec3& v2, const Vec3& triangleNormal, const uint8 activeEdges, const Vec3& point, const Vec3& penetrationAxis, const Vec3& movementDirection)
+    {
+        // All edges are active, the penetration axis is already correct.
+        if (activeEdges == 0b111)
+            return penetrationAxis;
+
+        // Sliding over a triangulated surface and grazing a steep triangle with an inactive edge are
+        // difficult to tell apart. When the calculated axis impedes the movement less, use it, otherwise
+        // the object would bounce back from the steep triangle.
+        const float axisLength = penetrationAxis.Length();
+        const float triangleNormalLength = triangleNormal.Length();
+        if (movementDirection.Dot(penetrationAxis) * triangleNormalLength < movementDirection.Dot(triangleNormal) * axisLength)
+            return penetrationAxis;
+
+        // The penetration axis is already (close to) the triangle normal.
+        if (penetrationAxis.Dot(triangleNormal) > 0.999848f * axisLength * triangleNormalLength) // cos(1 degree)
+            return penetrationAxis;
+
+        // Find the features of the triangle that the contact point is on.
+        float u, v, w;
+        if (!ClosestPoint::GetBaryCentricCoordinates(v0 - point, v1 - point, v2 - point, u, v, w))
+            return penetrationAxis;
+
+        constexpr float kEpsilon = 1.0e-4f;
+        uint8 collidingEdges = 0;
+        if (w < kEpsilon)
+            collidingEdges |= 0b001; // Edge v0 -> v1
+        if (u < kEpsilon)
+            collidingEdges |= 0b010; // Edge v1 -> v2
+        if (v < kEpsilon)
+            collidingEdges |= 0b100; // Edge v2 -> v0
+
+        // When touching an active edge (or a vertex of an active edge), the calculated axis is correct.
+        // Otherwise the contact is on the interior of the face or on inactive edges, use the face normal.
+        if ((collidingEdges & activeEdges) != 0)
+            return penetrationAxis;
+
+        return triangleNormal;
+    }
+}
@@ -9,6 +9,16 @@ namespace nes
     struct BodyPair;
     
     using BodyPairCollector = CollisionCollector<BodyPair, CollisionCollectorTraitsCollideShape>;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Available Broadphase implementations.
+    //----------------------------------------------------------------------------------------------------
+    enum class EBroadPhaseType : uint8
+    {
+        QuadTree,   /// BroadPhaseQuadTree: AABB trees with 4 children per Node.
+        OctTree,    /// BroadPhaseOctTree: AABB trees with 8 children per Node. Shallower trees, for scenes with a large number of Bodies.
+        SweepAndPrune, /// BroadPhaseSweepAndPrune: Bounds sorted along the X axis. For scenes with many small, similar sized Bodies that all move.
+    };
     
     //----------------------------------------------------------------------------------------------------
     /// @brief : Used to do coarse collision detection operations to quickly prune out Bodies that will not
@@ -134,6 +144,11 @@ namespace nes
         /// @brief : Same as BroadPhaseQuery::CastAABox(), but can be implemented in a way to take no broad phase locks.
         //----------------------------------------------------------------------------------------------------
         virtual void        CastAABoxNoLock(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const = 0;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Same as BroadPhaseQuery::CollideAABox(), but can be implemented in a way to take no broad phase locks.
+        //----------------------------------------------------------------------------------------------------
+        virtual void        CollideAABoxNoLock(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const = 0;
         
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the Bounding Box of all Bodies in this Broadphase. 
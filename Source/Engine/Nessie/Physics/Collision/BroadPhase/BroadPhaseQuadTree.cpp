@@ -7,12 +7,14 @@
 
 namespace nes
 {
-    BroadPhaseQuadTree::~BroadPhaseQuadTree()
+    template <int NumChildren>
+    TBroadPhaseAABBTree<NumChildren>::~TBroadPhaseAABBTree()
     {
         NES_DELETE_ARRAY(m_layers);
     }
 
-    void BroadPhaseQuadTree::Init(BodyManager* pBodyManager, const BroadPhaseLayerInterface& layerInterface)
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::Init(BodyManager* pBodyManager, const BroadPhaseLayerInterface& layerInterface)
     {
         BroadPhase::Init(pBodyManager, layerInterface);
 
@@ -31,12 +33,14 @@ namespace nes
         m_trackers.resize(m_maxBodies);
 
         // Initialize the Node Allocator
-        uint32 numLeaves = static_cast<uint32>(m_maxBodies + 1) / 2; // Assume 50% fill.
-        uint32 numLeavesPlusInternalNodes = numLeaves + (numLeaves + 2) / 3; // Sum(numLeaves * 4^-i) with i = [0, inf]
+        // Assume 2 bodies per leaf. This is 50% fill for 4 children, but PartitionChildren() splits small ranges in half
+        // until there are NumChildren partitions, so the leaves of an 8 wide tree don't hold more bodies on average.
+        uint32 numLeaves = static_cast<uint32>(m_maxBodies + 1) / 2;
+        uint32 numLeavesPlusInternalNodes = numLeaves + (numLeaves + NumChildren - 2) / (NumChildren - 1); // Sum(numLeaves * NumChildren^-i) with i = [0, inf]
         m_allocator.Init(2 * numLeavesPlusInternalNodes, 256); // We use double the amount o f odes while rebuilding the tree during Update().
 
         // Initialize Sub-Trees
-        m_layers = NES_NEW_ARRAY(QuadTree, m_numLayers);
+        m_layers = NES_NEW_ARRAY(Tree, m_numLayers);
 
         for (uint32 i = 0; i < m_numLayers; ++i)
         {
@@ -46,17 +50,18 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::Optimize()
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::Optimize()
     {
         FrameSync();
         LockModifications();
 
         for (uint32 i = 0; i < m_numLayers; ++i)
         {
-            QuadTree& tree = m_layers[i];
+            Tree& tree = m_layers[i];
             if (tree.HasBodies())
             {
-                QuadTree::UpdateState updateState;
+                typename Tree::UpdateState updateState;
                 tree.UpdatePrepare(m_pBodyManager->GetBodies(), m_trackers, updateState, true);
                 tree.UpdateFinalize(m_pBodyManager->GetBodies(), m_trackers, updateState);
             }
@@ -66,7 +71,8 @@ namespace nes
         m_nextLayerToUpdate = 0;
     }
 
-    void BroadPhaseQuadTree::FrameSync()
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::FrameSync()
     {
         // Take a unique lock on the old query lock so that we know no one is use the old nodes anymore.
         // Note that nothing should be locked at this point ot avoid risking a lock inversion deadlock.
@@ -80,19 +86,22 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::LockModifications()
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::LockModifications()
     {
         // From this point on, prevent modifications to the tree.
         PhysicsLock::Lock(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
     }
 
-    void BroadPhaseQuadTree::UnlockModifications()
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::UnlockModifications()
     {
         // From this point on, we allow modifications to the tree again.
         PhysicsLock::Unlock(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
     }
 
-    BroadPhase::UpdateState BroadPhaseQuadTree::UpdatePrepare()
+    template <int NumChildren>
+    BroadPhase::UpdateState TBroadPhaseAABBTree<NumChildren>::UpdatePrepare()
     {
         NES_ASSERT(m_updateMutex.is_locked());
 
@@ -103,7 +112,7 @@ namespace nes
         // Loop until we've seen all layers
         for (uint32 i = 0; i < m_numLayers; ++i)
         {
-            QuadTree& tree = m_layers[m_nextLayerToUpdate];
+            Tree& tree = m_layers[m_nextLayerToUpdate];
             m_nextLayerToUpdate = (m_nextLayerToUpdate + 1) % m_numLayers;
 
             // If it is dirty, then we update it and return.
@@ -120,7 +129,8 @@ namespace nes
         return updateState;
     }
 
-    void BroadPhaseQuadTree::UpdateFinalize(const UpdateState& updateState)
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::UpdateFinalize(const UpdateState& updateState)
     {
         NES_ASSERT(m_updateMutex.is_locked());
 
@@ -135,7 +145,8 @@ namespace nes
         m_queryLockIndex = m_queryLockIndex ^ 1;
     }
 
-    BroadPhase::AddState BroadPhaseQuadTree::AddBodiesPrepare(BodyID* pBodies, int number)
+    template <int NumChildren>
+    BroadPhase::AddState TBroadPhaseAABBTree<NumChildren>::AddBodiesPrepare(BodyID* pBodies, int number)
     {
         if (number <= 0)
             return nullptr;
@@ -199,7 +210,8 @@ namespace nes
         return pLayerStates;
     }
 
-    void BroadPhaseQuadTree::AddBodiesFinalize([[maybe_unused]] BodyID* pBodies, const int number, AddState addState)
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::AddBodiesFinalize([[maybe_unused]] BodyID* pBodies, const int number, AddState addState)
     {
         if (number <= 0)
         {
@@ -241,7 +253,8 @@ namespace nes
         delete [] pLayerStates;
     }
 
-    void BroadPhaseQuadTree::AddBodiesAbort([[maybe_unused]] BodyID* pBodies, const int number, AddState addState)
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::AddBodiesAbort([[maybe_unused]] BodyID* pBodies, const int number, AddState addState)
     {
         if (number <= 0)
         {
@@ -283,7 +296,8 @@ namespace nes
         delete [] pLayerStates;
     }
 
-    void BroadPhaseQuadTree::RemoveBodies(BodyID* pBodies, int number)
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::RemoveBodies(BodyID* pBodies, int number)
     {
         if (number <= 0)
             return;
@@ -338,7 +352,8 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::NotifyBodiesAABBChanged(BodyID* pBodies, int number, bool takeLock)
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::NotifyBodiesAABBChanged(BodyID* pBodies, int number, bool takeLock)
     {
         if (number <= 0)
             return;
@@ -383,7 +398,8 @@ namespace nes
             PhysicsLock::UnlockShared(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
     }
 
-    void BroadPhaseQuadTree::NotifyBodiesLayerChanged(BodyID* pBodies, int number)
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::NotifyBodiesLayerChanged(BodyID* pBodies, int number)
     {
         if (number <= 0)
             return;
@@ -424,7 +440,8 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::CastRay(const RayCast& ray, RayCastBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CastRay(const RayCast& ray, RayCastBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
     {
         NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
 
@@ -434,7 +451,7 @@ namespace nes
         // Loop over all layers and test the ones that could hit.
         for (BroadPhaseLayer::Type i = 0; i < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++i)
         {
-            const QuadTree& tree = m_layers[i];
+            const Tree& tree = m_layers[i];
             if (tree.HasBodies() && broadPhaseLayerFilter.ShouldCollide(BroadPhaseLayer(i)))
             {
                 tree.CastRay(ray, collector, collisionLayerFilter, m_trackers);
@@ -444,7 +461,25 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::CastAABox(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CastRays(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        // Prevent this from running in parallel with node deletion in FrameSync() - see notes there.
+        std::shared_lock lock(m_queryLocks[m_queryLockIndex]);
+
+        // Loop over all layers and test the ones that could hit. Rays that early out are skipped by the tree.
+        for (BroadPhaseLayer::Type i = 0; i < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++i)
+        {
+            const Tree& tree = m_layers[i];
+            if (tree.HasBodies() && broadPhaseLayerFilter.ShouldCollide(BroadPhaseLayer(i)))
+                tree.CastRays(pRays, pCollectors, numRays, collisionLayerFilter, m_trackers);
+        }
+    }
+
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CastAABox(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
     {
         // Prevent this from running in parallel with node deletion in FrameSync() - see notes there.
         std::shared_lock lock(m_queryLocks[m_queryLockIndex]);
@@ -452,14 +487,15 @@ namespace nes
         CastAABoxNoLock(box, collector, broadPhaseLayerFilter, collisionLayerFilter);
     }
 
-    void BroadPhaseQuadTree::CastAABoxNoLock(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CastAABoxNoLock(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
     {
         NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
         
         // Loop over all layers and test the ones that could hit.
         for (BroadPhaseLayer::Type i = 0; i < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++i)
         {
-            const QuadTree& tree = m_layers[i];
+            const Tree& tree = m_layers[i];
             if (tree.HasBodies() && broadPhaseLayerFilter.ShouldCollide(BroadPhaseLayer(i)))
             {
                 tree.CastAABox(box, collector, collisionLayerFilter, m_trackers);
@@ -469,17 +505,24 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::CollideAABox(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CollideAABox(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
     {
-        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
-
         // Prevent this from running in parallel with node deletion in FrameSync() - see notes there.
         std::shared_lock lock(m_queryLocks[m_queryLockIndex]);
 
+        CollideAABoxNoLock(box, collector, broadPhaseLayerFilter, collisionLayerFilter);
+    }
+
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CollideAABoxNoLock(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
         // Loop over all layers and test the ones that could hit.
         for (BroadPhaseLayer::Type i = 0; i < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++i)
         {
-            const QuadTree& tree = m_layers[i];
+            const Tree& tree = m_layers[i];
             if (tree.HasBodies() && broadPhaseLayerFilter.ShouldCollide(BroadPhaseLayer(i)))
             {
                 tree.CollideAABox(box, collector, collisionLayerFilter, m_trackers);
@@ -489,7 +532,8 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::CollideSphere(const Vec3& center, const float radius, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CollideSphere(const Vec3& center, const float radius, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
     {
         NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
 
@@ -499,7 +543,7 @@ namespace nes
         // Loop over all layers and test the ones that could hit.
         for (BroadPhaseLayer::Type i = 0; i < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++i)
         {
-            const QuadTree& tree = m_layers[i];
+            const Tree& tree = m_layers[i];
             if (tree.HasBodies() && broadPhaseLayerFilter.ShouldCollide(BroadPhaseLayer(i)))
             {
                 tree.CollideSphere(center, radius, collector, collisionLayerFilter, m_trackers);
@@ -509,7 +553,8 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::CollidePoint(const Vec3& point, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CollidePoint(const Vec3& point, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
     {
         NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
 
@@ -519,7 +564,7 @@ namespace nes
         // Loop over all layers and test the ones that could hit.
         for (BroadPhaseLayer::Type i = 0; i < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++i)
         {
-            const QuadTree& tree = m_layers[i];
+            const Tree& tree = m_layers[i];
             if (tree.HasBodies() && broadPhaseLayerFilter.ShouldCollide(BroadPhaseLayer(i)))
             {
                 tree.CollidePoint(point, collector, collisionLayerFilter, m_trackers);
@@ -529,7 +574,8 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::CollideOrientedBox(const OrientedBox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::CollideOrientedBox(const OrientedBox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
     {
         NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
 
@@ -539,7 +585,7 @@ namespace nes
         // Loop over all layers and test the ones that could hit.
         for (BroadPhaseLayer::Type i = 0; i < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++i)
         {
-            const QuadTree& tree = m_layers[i];
+            const Tree& tree = m_layers[i];
             if (tree.HasBodies() && broadPhaseLayerFilter.ShouldCollide(BroadPhaseLayer(i)))
             {
                 tree.CollideOrientedBox(box, collector, collisionLayerFilter, m_trackers);
@@ -549,7 +595,8 @@ namespace nes
         }
     }
 
-    void BroadPhaseQuadTree::FindCollidingPairs(BodyID* pActiveBodies, const int numActiveBodies, const float speculativeContactDistance, const CollisionVsBroadPhaseLayerFilter& collisionVsBroadPhaseLayerFilter, const CollisionLayerPairFilter& collisionLayerPairFilter, BodyPairCollector& pairCollector) const
+    template <int NumChildren>
+    void TBroadPhaseAABBTree<NumChildren>::FindCollidingPairs(BodyID* pActiveBodies, const int numActiveBodies, const float speculativeContactDistance, const CollisionVsBroadPhaseLayerFilter& collisionVsBroadPhaseLayerFilter, const CollisionLayerPairFilter& collisionLayerPairFilter, BodyPairCollector& pairCollector) const
     {
         const BodyVector& bodies = m_pBodyManager->GetBodies();
         NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
@@ -581,7 +628,7 @@ namespace nes
             // Loop over all broadphase layers and test the ones that we could hit:
             for (BroadPhaseLayer::Type i = 0; i < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++i)
             {
-                const QuadTree& tree = m_layers[i];
+                const Tree& tree = m_layers[i];
                 if (tree.HasBodies() && collisionVsBroadPhaseLayerFilter.ShouldCollide(collisionLayer, BroadPhaseLayer(i)))
                 {
                     tree.FindCollidingPairs(bodies, pStart, static_cast<int>(pMid - pStart), speculativeContactDistance, pairCollector, collisionLayerPairFilter);
@@ -593,7 +640,8 @@ namespace nes
         }
     }
 
-    AABox BroadPhaseQuadTree::GetBounds() const
+    template <int NumChildren>
+    AABox TBroadPhaseAABBTree<NumChildren>::GetBounds() const
     {
         // Prevent this from running in parallel with node deletion in FrameSync(), see notes there.
         std::shared_lock lock(m_queryLocks[m_queryLockIndex]);
@@ -605,4 +653,7 @@ namespace nes
         }
         return bounds;
     }
+
+    template class TBroadPhaseAABBTree<4>;
+    template class TBroadPhaseAABBTree<8>;
 }
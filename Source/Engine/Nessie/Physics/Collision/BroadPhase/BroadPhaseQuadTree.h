@@ -7,12 +7,16 @@
 namespace nes
 {
     //----------------------------------------------------------------------------------------------------
-    /// @brief : Quadtree implementation of the Broadphase. 
+    /// @brief : AABB Tree implementation of the Broadphase, with one tree per BroadPhaseLayer.
+    ///	@tparam NumChildren : Number of children per tree Node. See BroadPhaseQuadTree and BroadPhaseOctTree.
     //----------------------------------------------------------------------------------------------------
-    class BroadPhaseQuadTree final : public BroadPhase
+    template <int NumChildren>
+    class TBroadPhaseAABBTree final : public BroadPhase
     {
+        using Tree = TAABBTree<NumChildren>;
+        
     public:
-        virtual ~BroadPhaseQuadTree() override;
+        virtual ~TBroadPhaseAABBTree() override;
 
     public:
         virtual void                Init(BodyManager* pBodyManager, const BroadPhaseLayerInterface& layerInterface) override;
@@ -31,9 +35,11 @@ namespace nes
         virtual void                NotifyBodiesLayerChanged(BodyID* pBodies, int number) override;
         
         virtual void                CastRay(const RayCast& ray, RayCastBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CastRays(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
         virtual void                CastAABox(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
         virtual void                CastAABoxNoLock(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
         virtual void                CollideAABox(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CollideAABoxNoLock(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
         virtual void                CollideSphere(const Vec3& center, const float radius, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
         virtual void                CollidePoint(const Vec3& point, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
         virtual void                CollideOrientedBox(const OrientedBox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
@@ -51,7 +57,7 @@ namespace nes
 
             BodyID*                 m_pBodyStart = nullptr;
             BodyID*                 m_pBodyEnd = nullptr;
-            QuadTree::AddState      m_addState;
+            typename Tree::AddState m_addState;
         };
         
         //----------------------------------------------------------------------------------------------------
@@ -59,12 +65,12 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         struct UpdateStateImpl
         {
-            QuadTree*               m_pTree = nullptr;
-            QuadTree::UpdateState   m_updateState;
+            Tree*                   m_pTree = nullptr;
+            typename Tree::UpdateState m_updateState;
         };
 
-        using Tracker = QuadTree::BodyTracker;
-        using TrackerArray = QuadTree::BodyTrackerArray;
+        using Tracker = typename Tree::BodyTracker;
+        using TrackerArray = typename Tree::BodyTrackerArray;
     
     private:
 #if NES_ASSERTS_ENABLED
@@ -76,7 +82,7 @@ namespace nes
         TrackerArray                m_trackers;
 
         /// Node Allocator for all Trees.
-        QuadTree::Allocator         m_allocator{};
+        typename Tree::Allocator    m_allocator{};
 
         /// The Maximum number of Bodies that are supported.
         size_t                      m_maxBodies = 0;
@@ -84,8 +90,8 @@ namespace nes
         /// Information about the Broadphase->Collision Layer mappings
         const BroadPhaseLayerInterface* m_broadPhaseLayerInterface = nullptr;
 
-        /// One Quadtree per BroadPhaseLayer.
-        QuadTree*                   m_layers = nullptr;
+        /// One Tree per BroadPhaseLayer.
+        Tree*                       m_layers = nullptr;
         uint32                      m_numLayers = 0;
 
         /// This is the next tree to update in UpdatePrepare();
@@ -102,4 +108,11 @@ namespace nes
         /// Index indicates which Query Lock is currently active. It alternates between 0 and 1.
         std::atomic<uint32>         m_queryLockIndex {0};
     };
+
+    /// Broadphase using a tree with 4 children per Node. This is the default.
+    using BroadPhaseQuadTree = TBroadPhaseAABBTree<4>;
+
+    /// Broadphase using a tree with 8 children per Node. This halves the depth of the trees, which reduces the
+    /// number of Nodes visited in FindCollidingPairs and the cast queries for scenes with a large number of Bodies.
+    using BroadPhaseOctTree = TBroadPhaseAABBTree<8>;
 }
@@ -40,6 +40,18 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         virtual void CastRay(const RayCast& ray, RayCastBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter = { }, const CollisionLayerFilter& collisionLayerFilter = { }) const = 0;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Cast a batch of Rays, and add the hits of each Ray to its own collector. Implementations can
+        ///     test multiple Rays against the same bounds at once, so Rays that are close together should be
+        ///     next to each other in the array.
+        ///	@param pRays : Array of 'numRays' Rays.
+        ///	@param pCollectors : Array of 'numRays' collectors, one for each Ray.
+        ///	@param numRays : Number of Rays to cast.
+        ///	@param broadPhaseLayerFilter : Filter to test which BroadPhaseLayers should interact with the Rays.
+        ///	@param collisionLayerFilter : Filter to test which Collision layers are valid for the Rays.
+        //----------------------------------------------------------------------------------------------------
+        virtual void CastRays(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const BroadPhaseLayerFilter& broadPhaseLayerFilter = { }, const CollisionLayerFilter& collisionLayerFilter = { }) const = 0;
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Cast a AABox and add any hits to the collector.
         ///	@param box : Box to Cast.
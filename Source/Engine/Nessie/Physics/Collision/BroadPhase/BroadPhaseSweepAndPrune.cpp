@@ -0,0 +1,895 @@
+// BroadPhaseSweepAndPrune.cpp
+#include "BroadPhaseSweepAndPrune.h"
+
+#include <mutex>
+#include <shared_mutex>
+#include "Nessie/Core/QuickSort.h"
+#include "Nessie/Geometry/AABoxSIMD.h"
+#include "Nessie/Geometry/OrientedBox.h"
+#include "Nessie/Geometry/RayAABox.h"
+#include "Nessie/Physics/Body/BodyManager.h"
+#include "Nessie/Physics/Body/BodyPair.h"
+#include "Nessie/Physics/Collision/AABoxCast.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+
+namespace nes
+{
+    BroadPhaseSweepAndPrune::~BroadPhaseSweepAndPrune()
+    {
+        NES_DELETE_ARRAY(m_layers);
+    }
+
+    void BroadPhaseSweepAndPrune::Init(BodyManager* pBodyManager, const BroadPhaseLayerInterface& layerInterface)
+    {
+        BroadPhase::Init(pBodyManager, layerInterface);
+
+        m_numLayers = layerInterface.GetNumBroadPhaseLayers();
+        NES_ASSERT(m_numLayers < static_cast<BroadPhaseLayer::Type>(kInvalidBroadPhaseLayer));
+
+#if NES_ASSERTS_ENABLED
+        m_lockContext = pBodyManager;
+#endif
+
+        m_maxBodies = m_pBodyManager->GetMaxNumBodies();
+
+        // Initialize Tracking Data
+        m_trackers.resize(m_maxBodies);
+
+        // Initialize the layers, which only contain the padding entries.
+        m_layers = NES_NEW_ARRAY(Layer, m_numLayers);
+        for (uint32 i = 0; i < m_numLayers; ++i)
+            ResizeLayer(m_layers[i], 0);
+    }
+
+    void BroadPhaseSweepAndPrune::Optimize()
+    {
+        SortDirtyLayers();
+    }
+
+    void BroadPhaseSweepAndPrune::LockModifications()
+    {
+        // From this point on, prevent modifications to the broadphase.
+        PhysicsLock::Lock(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+    }
+
+    void BroadPhaseSweepAndPrune::UnlockModifications()
+    {
+        // From this point on, we allow modifications to the broadphase again.
+        PhysicsLock::Unlock(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+    }
+
+    BroadPhase::UpdateState BroadPhaseSweepAndPrune::UpdatePrepare()
+    {
+        NES_ASSERT(m_updateMutex.is_locked());
+
+        // Sort the layers of the Bodies that moved during the last update. This runs in parallel with the
+        // first FindCollidingPairs() calls, whichever gets to a layer first sorts it.
+        SortDirtyLayers();
+        return UpdateState();
+    }
+
+    void BroadPhaseSweepAndPrune::AddBodiesFinalize(BodyID* pBodies, const int number, [[maybe_unused]] AddState addState)
+    {
+        if (number <= 0)
+            return;
+
+        // This cannot run concurrently with UpdatePrepare()/UpdateFinalize().
+        SharedLock lock(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+        std::unique_lock layerLock(m_mutex);
+
+        const BodyVector& bodies = m_pBodyManager->GetBodies();
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        for (const BodyID* pBodyID = pBodies; pBodyID < pBodies + number; ++pBodyID)
+        {
+            const uint32 index = pBodyID->GetIndex();
+            Body* pBody = bodies[index];
+            NES_ASSERT(pBody->GetID() == *pBodyID);
+            NES_ASSERT(!pBody->IsInBroadPhase());
+
+            // Get the broadphase layer that the body is in.
+            const BroadPhaseLayer::Type broadPhaseLayer = static_cast<BroadPhaseLayer::Type>(pBody->GetBroadPhaseLayer());
+            NES_ASSERT(broadPhaseLayer < m_numLayers);
+
+            // Update the Tracker info.
+            Tracker& tracker = m_trackers[index];
+            NES_ASSERT(tracker.m_broadPhaseLayer == static_cast<BroadPhaseLayer::Type>(kInvalidBroadPhaseLayer));
+            tracker.m_broadPhaseLayer = broadPhaseLayer;
+            tracker.m_collisionLayer = pBody->GetCollisionLayer();
+
+            AddToLayer(m_layers[broadPhaseLayer], *pBody);
+
+            // Mark Added to the Broadphase
+            pBody->Internal_SetInBroadPhase(true);
+        }
+    }
+
+    void BroadPhaseSweepAndPrune::RemoveBodies(BodyID* pBodies, const int number)
+    {
+        if (number <= 0)
+            return;
+
+        // This cannot run concurrently with UpdatePrepare()/UpdateFinalize().
+        SharedLock lock(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+        std::unique_lock layerLock(m_mutex);
+
+        const BodyVector& bodies = m_pBodyManager->GetBodies();
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        for (const BodyID* pBodyID = pBodies; pBodyID < pBodies + number; ++pBodyID)
+        {
+            const uint32 index = pBodyID->GetIndex();
+            NES_ASSERT(bodies[index]->GetID() == *pBodyID);
+            NES_ASSERT(bodies[index]->IsInBroadPhase());
+
+            Tracker& tracker = m_trackers[index];
+            NES_ASSERT(tracker.m_broadPhaseLayer < m_numLayers);
+            RemoveFromLayer(m_layers[tracker.m_broadPhaseLayer], tracker.m_index);
+
+            // Reset the tracker info:
+            tracker = Tracker();
+
+            // Mark removed from the BroadPhase
+            bodies[index]->Internal_SetInBroadPhase(false);
+        }
+    }
+
+    void BroadPhaseSweepAndPrune::NotifyBodiesAABBChanged(BodyID* pBodies, const int number, const bool takeLock)
+    {
+        if (number <= 0)
+            return;
+
+        // This cannot run concurrently with UpdatePrepare()/UpdateFinalize().
+        if (takeLock)
+            PhysicsLock::LockShared(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+        else
+            NES_ASSERT(m_updateMutex.is_locked());
+
+        {
+            // Only copy the new bounds, sorting is deferred until the next time that the layer is needed.
+            std::unique_lock layerLock(m_mutex);
+
+            const BodyVector& bodies = m_pBodyManager->GetBodies();
+            NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+            for (const BodyID* pBodyID = pBodies; pBodyID < pBodies + number; ++pBodyID)
+            {
+                const uint32 index = pBodyID->GetIndex();
+                const Tracker& tracker = m_trackers[index];
+                NES_ASSERT(tracker.m_broadPhaseLayer < m_numLayers);
+
+                Layer& layer = m_layers[tracker.m_broadPhaseLayer];
+                SetEntryBounds(layer, tracker.m_index, bodies[index]->GetWorldSpaceBounds());
+                layer.m_isDirty.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        // Unlock if necessary:
+        if (takeLock)
+            PhysicsLock::UnlockShared(m_updateMutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::BroadPhaseUpdate));
+    }
+
+    void BroadPhaseSweepAndPrune::NotifyBodiesLayerChanged(BodyID* pBodies, int number)
+    {
+        if (number <= 0)
+            return;
+
+        {
+            // First sort the bodies that actually changed layer to the beginning of the array.
+            std::unique_lock layerLock(m_mutex);
+
+            const BodyVector& bodies = m_pBodyManager->GetBodies();
+            NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+            for (BodyID* pBodyID = pBodies + number - 1; pBodyID >= pBodies; --pBodyID)
+            {
+                const uint32 index = pBodyID->GetIndex();
+                NES_ASSERT(bodies[index]->GetID() == *pBodyID);
+
+                const Body* pBody = bodies[index];
+                const BroadPhaseLayer::Type broadPhaseLayer = static_cast<BroadPhaseLayer::Type>(pBody->GetBroadPhaseLayer());
+                NES_ASSERT(broadPhaseLayer < m_numLayers);
+
+                // If this body didn't actually change, then swap to the end and reduce our count.
+                if (m_trackers[index].m_broadPhaseLayer == broadPhaseLayer)
+                {
+                    // Update the tracking information:
+                    m_trackers[index].m_collisionLayer = pBody->GetCollisionLayer();
+
+                    // Swap to the end, the layer didn't change:
+                    std::swap(*pBodyID, pBodies[number - 1]);
+                    --number;
+                }
+            }
+        }
+
+        if (number > 0)
+        {
+            // Changing the layer requires us to move the body to the arrays of another layer, so this is
+            // equivalent to removing all bodies first then adding them again.
+            RemoveBodies(pBodies, number);
+            const AddState state = AddBodiesPrepare(pBodies, number);
+            AddBodiesFinalize(pBodies, number, state);
+        }
+    }
+
+    template <typename Visitor>
+    void BroadPhaseSweepAndPrune::WalkLayers(const float minX, const float maxX, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, Visitor& visitor) const
+    {
+        for (BroadPhaseLayer::Type layerIndex = 0; layerIndex < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++layerIndex)
+        {
+            const Layer& layer = m_layers[layerIndex];
+            if (layer.m_numBodies == 0 || !broadPhaseLayerFilter.ShouldCollide(BroadPhaseLayer(layerIndex)))
+                continue;
+
+            uint32 begin;
+            uint32 end;
+            GetOverlappingRange(layer, minX, maxX, begin, end);
+
+            // Test 4 entries at a time. The padding entries make sure that there are always 4 entries to load.
+            for (uint32 i = begin; i < end; i += 4)
+            {
+                const UVec4Reg hits = visitor.TestBounds(
+                    Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_minX[i])),
+                    Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_minY[i])),
+                    Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_minZ[i])),
+                    Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_maxX[i])),
+                    Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_maxY[i])),
+                    Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_maxZ[i])));
+
+                // Ignore the entries after the end of the range.
+                uint32 hitMask = static_cast<uint32>(hits.GetTrues());
+                if (end - i < 4)
+                    hitMask &= (1u << (end - i)) - 1;
+
+                while (hitMask != 0)
+                {
+                    const uint32 lane = math::CountTrailingZeros(hitMask);
+                    hitMask &= hitMask - 1;
+
+                    const BodyID bodyID = layer.m_bodyIDs[i + lane];
+                    const CollisionLayer collisionLayer = m_trackers[bodyID.GetIndex()].m_collisionLayer;
+                    if (collisionLayer != kInvalidCollisionLayer && collisionLayerFilter.ShouldCollide(collisionLayer))
+                    {
+                        visitor.VisitBody(bodyID, static_cast<int>(lane));
+                        if (visitor.ShouldAbort())
+                            return;
+                    }
+                }
+            }
+        }
+    }
+
+    void BroadPhaseSweepAndPrune::CastRay(const RayCast& ray, RayCastBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        class Visitor
+        {
+        public:
+            NES_INLINE Visitor(const RayCast& ray, RayCastBodyCollector& collector)
+                : m_origin(ray.m_origin)
+                , m_invDirection(ray.m_direction)
+                , m_collector(collector)
+            {
+                //
+            }
+
+            NES_INLINE bool         ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            NES_INLINE UVec4Reg     TestBounds(const Vec4Reg& boundsMinX, const Vec4Reg& boundsMinY, const Vec4Reg& boundsMinZ, const Vec4Reg& boundsMaxX, const Vec4Reg& boundsMaxY, const Vec4Reg& boundsMaxZ)
+            {
+                // Test the ray against 4 bounding boxes, and keep the fractions for VisitBody().
+                const Vec4Reg fraction = RayAABox4(m_origin, m_invDirection, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+                fraction.StoreFloat4(&m_fractions);
+                return Vec4Reg::Less(fraction, Vec4Reg::Replicate(m_collector.GetEarlyOutFraction()));
+            }
+
+            NES_INLINE void         VisitBody(const BodyID& bodyID, const int hitIndex)
+            {
+                // A hit with an earlier Body of the same 4 can have moved the early out fraction.
+                if (m_fractions[hitIndex] >= m_collector.GetEarlyOutFraction())
+                    return;
+
+                // Store potential hit with Body
+                BroadPhaseCastResult result { bodyID, m_fractions[hitIndex] };
+                m_collector.AddHit(result);
+            }
+
+        private:
+            Vec3                    m_origin;
+            RayInvDirection         m_invDirection;
+            RayCastBodyCollector&   m_collector;
+            Float4                  m_fractions;
+        };
+
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        // Sort the layers whose Bodies moved, so that not all of their entries are tested.
+        SortDirtyLayers();
+
+        // Prevent this from running in parallel with modifications.
+        std::shared_lock lock(m_mutex);
+
+        const Vec3 end = ray.m_origin + ray.m_direction;
+        Visitor visitor(ray, collector);
+        WalkLayers(math::Min(ray.m_origin.x, end.x), math::Max(ray.m_origin.x, end.x), broadPhaseLayerFilter, collisionLayerFilter, visitor);
+    }
+
+    void BroadPhaseSweepAndPrune::CastRays(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        // There is no hierarchy to share between rays, so each ray tests its own range of entries.
+        for (int i = 0; i < numRays; ++i)
+        {
+            if (!pCollectors[i]->ShouldEarlyOut())
+                CastRay(pRays[i], *pCollectors[i], broadPhaseLayerFilter, collisionLayerFilter);
+        }
+    }
+
+    void BroadPhaseSweepAndPrune::CastAABox(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        // Sort the layers whose Bodies moved, so that not all of their entries are tested.
+        SortDirtyLayers();
+
+        // Prevent this from running in parallel with modifications.
+        std::shared_lock lock(m_mutex);
+
+        CastAABoxInternal(box, collector, broadPhaseLayerFilter, collisionLayerFilter);
+    }
+
+    void BroadPhaseSweepAndPrune::CastAABoxNoLock(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        // This is used during the simulation after the Bodies have moved, so sort the layers first to not test all entries.
+        SortDirtyLayers();
+
+        CastAABoxInternal(box, collector, broadPhaseLayerFilter, collisionLayerFilter);
+    }
+
+    void BroadPhaseSweepAndPrune::CastAABoxInternal(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        class Visitor
+        {
+        public:
+            NES_INLINE Visitor(const AABoxCast& box, CastShapeBodyCollector& collector)
+                : m_origin(box.m_box.Center())
+                , m_extent(box.m_box.Extent())
+                , m_invDirection(box.m_direction)
+                , m_collector(collector)
+            {
+                //
+            }
+
+            NES_INLINE bool         ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            NES_INLINE UVec4Reg     TestBounds(const Vec4Reg& inBoundsMinX, const Vec4Reg& inBoundsMinY, const Vec4Reg& inBoundsMinZ, const Vec4Reg& inBoundsMaxX, const Vec4Reg& inBoundsMaxY, const Vec4Reg& inBoundsMaxZ)
+            {
+                // Enlarge them by the casted AABox extents
+                Vec4Reg boundsMinX = inBoundsMinX;
+                Vec4Reg boundsMinY = inBoundsMinY;
+                Vec4Reg boundsMinZ = inBoundsMinZ;
+                Vec4Reg boundsMaxX = inBoundsMaxX;
+                Vec4Reg boundsMaxY = inBoundsMaxY;
+                Vec4Reg boundsMaxZ = inBoundsMaxZ;
+                math::AABox4EnlargeWithExtent(m_extent, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+
+                // Test the ray against 4 bounding boxes, and keep the fractions for VisitBody().
+                const Vec4Reg fraction = RayAABox4(m_origin, m_invDirection, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+                fraction.StoreFloat4(&m_fractions);
+                return Vec4Reg::Less(fraction, Vec4Reg::Replicate(m_collector.GetPositiveEarlyOutFraction()));
+            }
+
+            NES_INLINE void         VisitBody(const BodyID& bodyID, const int hitIndex)
+            {
+                // A hit with an earlier Body of the same 4 can have moved the early out fraction.
+                if (m_fractions[hitIndex] >= m_collector.GetPositiveEarlyOutFraction())
+                    return;
+
+                // Store potential hit with Body
+                BroadPhaseCastResult result { bodyID, m_fractions[hitIndex] };
+                m_collector.AddHit(result);
+            }
+
+        private:
+            Vec3                    m_origin;
+            Vec3                    m_extent;
+            RayInvDirection         m_invDirection;
+            CastShapeBodyCollector& m_collector;
+            Float4                  m_fractions;
+        };
+
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        // The range of the sweep along the X axis.
+        const float minX = box.m_box.m_min.x + math::Min(0.f, box.m_direction.x);
+        const float maxX = box.m_box.m_max.x + math::Max(0.f, box.m_direction.x);
+
+        Visitor visitor(box, collector);
+        WalkLayers(minX, maxX, broadPhaseLayerFilter, collisionLayerFilter, visitor);
+    }
+
+    void BroadPhaseSweepAndPrune::CollideAABox(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        // Sort the layers whose Bodies moved, so that not all of their entries are tested.
+        SortDirtyLayers();
+
+        // Prevent this from running in parallel with modifications.
+        std::shared_lock lock(m_mutex);
+
+        CollideAABoxInternal(box, collector, broadPhaseLayerFilter, collisionLayerFilter);
+    }
+
+    void BroadPhaseSweepAndPrune::CollideAABoxNoLock(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        // This is used during the simulation after the Bodies have moved, so sort the layers first to not test all entries.
+        SortDirtyLayers();
+
+        CollideAABoxInternal(box, collector, broadPhaseLayerFilter, collisionLayerFilter);
+    }
+
+    void BroadPhaseSweepAndPrune::CollideAABoxInternal(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        class Visitor
+        {
+        public:
+            NES_INLINE explicit         Visitor(const AABox& box, CollideShapeBodyCollector& collector) : m_box(box), m_collector(collector) {}
+
+            NES_INLINE bool             ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            NES_INLINE UVec4Reg         TestBounds(const Vec4Reg& boundsMinX, const Vec4Reg& boundsMinY, const Vec4Reg& boundsMinZ, const Vec4Reg& boundsMaxX, const Vec4Reg& boundsMaxY, const Vec4Reg& boundsMaxZ) const
+            {
+                return math::AABox4VsAABox(m_box, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+            }
+
+            NES_INLINE void             VisitBody(const BodyID& id, [[maybe_unused]] const int hitIndex)
+            {
+                // Store the potential hit with the body.
+                m_collector.AddHit(id);
+            }
+
+        private:
+            const AABox&                m_box;
+            CollideShapeBodyCollector&  m_collector;
+        };
+
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        Visitor visitor(box, collector);
+        WalkLayers(box.m_min.x, box.m_max.x, broadPhaseLayerFilter, collisionLayerFilter, visitor);
+    }
+
+    void BroadPhaseSweepAndPrune::CollideSphere(const Vec3& center, const float radius, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        class Visitor
+        {
+        public:
+            NES_INLINE Visitor(const Vec3 center, const float radius, CollideShapeBodyCollector& collector)
+                : m_centerX(center.SplatX())
+                , m_centerY(center.SplatY())
+                , m_centerZ(center.SplatZ())
+                , m_radiusSqr(Vec4Reg::Replicate(math::Squared(radius)))
+                , m_collector(collector)
+            {
+                //
+            }
+
+            NES_INLINE bool             ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            NES_INLINE UVec4Reg         TestBounds(const Vec4Reg& boundsMinX, const Vec4Reg& boundsMinY, const Vec4Reg& boundsMinZ, const Vec4Reg& boundsMaxX, const Vec4Reg& boundsMaxY, const Vec4Reg& boundsMaxZ) const
+            {
+                return math::AABox4VsSphere(m_centerX, m_centerY, m_centerZ, m_radiusSqr, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+            }
+
+            NES_INLINE void             VisitBody(const BodyID& id, [[maybe_unused]] const int hitIndex)
+            {
+                // Store the potential hit with the body.
+                m_collector.AddHit(id);
+            }
+
+        private:
+            Vec4Reg                     m_centerX;
+            Vec4Reg                     m_centerY;
+            Vec4Reg                     m_centerZ;
+            Vec4Reg                     m_radiusSqr;
+            CollideShapeBodyCollector&  m_collector;
+        };
+
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        // Sort the layers whose Bodies moved, so that not all of their entries are tested.
+        SortDirtyLayers();
+
+        // Prevent this from running in parallel with modifications.
+        std::shared_lock lock(m_mutex);
+
+        Visitor visitor(center, radius, collector);
+        WalkLayers(center.x - radius, center.x + radius, broadPhaseLayerFilter, collisionLayerFilter, visitor);
+    }
+
+    void BroadPhaseSweepAndPrune::CollidePoint(const Vec3& point, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        class Visitor
+        {
+        public:
+            NES_INLINE Visitor(const Vec3 point, CollideShapeBodyCollector& collector)
+                : m_point(point)
+                , m_collector(collector)
+            {
+                //
+            }
+
+            NES_INLINE bool             ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            NES_INLINE UVec4Reg         TestBounds(const Vec4Reg& boundsMinX, const Vec4Reg& boundsMinY, const Vec4Reg& boundsMinZ, const Vec4Reg& boundsMaxX, const Vec4Reg& boundsMaxY, const Vec4Reg& boundsMaxZ) const
+            {
+                return math::AABox4VsPoint(m_point, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+            }
+
+            NES_INLINE void             VisitBody(const BodyID& id, [[maybe_unused]] const int hitIndex)
+            {
+                // Store the potential hit with the body.
+                m_collector.AddHit(id);
+            }
+
+        private:
+            Vec3                        m_point;
+            CollideShapeBodyCollector&  m_collector;
+        };
+
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        // Sort the layers whose Bodies moved, so that not all of their entries are tested.
+        SortDirtyLayers();
+
+        // Prevent this from running in parallel with modifications.
+        std::shared_lock lock(m_mutex);
+
+        Visitor visitor(point, collector);
+        WalkLayers(point.x, point.x, broadPhaseLayerFilter, collisionLayerFilter, visitor);
+    }
+
+    void BroadPhaseSweepAndPrune::CollideOrientedBox(const OrientedBox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const
+    {
+        class Visitor
+        {
+        public:
+            NES_INLINE Visitor(const OrientedBox& box, CollideShapeBodyCollector& collector)
+                : m_box(box)
+                , m_collector(collector)
+            {
+                //
+            }
+
+            NES_INLINE bool             ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            NES_INLINE UVec4Reg         TestBounds(const Vec4Reg& boundsMinX, const Vec4Reg& boundsMinY, const Vec4Reg& boundsMinZ, const Vec4Reg& boundsMaxX, const Vec4Reg& boundsMaxY, const Vec4Reg& boundsMaxZ) const
+            {
+                return math::AABox4VsBox(m_box, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+            }
+
+            NES_INLINE void             VisitBody(const BodyID& id, [[maybe_unused]] const int hitIndex)
+            {
+                // Store the potential hit with the body.
+                m_collector.AddHit(id);
+            }
+
+        private:
+            OrientedBox                 m_box;
+            CollideShapeBodyCollector&  m_collector;
+        };
+
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        // Sort the layers whose Bodies moved, so that not all of their entries are tested.
+        SortDirtyLayers();
+
+        // Prevent this from running in parallel with modifications.
+        std::shared_lock lock(m_mutex);
+
+        // The range of the box along the X axis.
+        const AABox bounds = AABox(-box.m_halfExtents, box.m_halfExtents).Transformed(box.m_orientation);
+
+        Visitor visitor(box, collector);
+        WalkLayers(bounds.m_min.x, bounds.m_max.x, broadPhaseLayerFilter, collisionLayerFilter, visitor);
+    }
+
+    void BroadPhaseSweepAndPrune::FindCollidingPairs(BodyID* pActiveBodies, const int numActiveBodies, const float speculativeContactDistance, const CollisionVsBroadPhaseLayerFilter& collisionVsBroadPhaseLayerFilter, const CollisionLayerPairFilter& collisionLayerPairFilter, BodyPairCollector& pairCollector) const
+    {
+        const BodyVector& bodies = m_pBodyManager->GetBodies();
+        NES_ASSERT(m_maxBodies == m_pBodyManager->GetMaxNumBodies());
+
+        // Make sure that the layers are sorted. After that, we don't take any locks. We know that the Bodies are
+        // not going to be modified while finding collision pairs due to the way the jobs are scheduled in PhysicsScene::Update.
+        SortDirtyLayers();
+
+        // Sort the Bodies based on CollisionLayer
+        const Tracker* pTrackers = m_trackers.data();
+        QuickSort(pActiveBodies, pActiveBodies + numActiveBodies, [pTrackers](BodyID left, BodyID right)
+        {
+            return pTrackers[left.GetIndex()].m_collisionLayer < pTrackers[right.GetIndex()].m_collisionLayer;
+        });
+
+        BodyID* pStart = pActiveBodies;
+        BodyID* pEnd = pActiveBodies + numActiveBodies;
+        while (pStart < pEnd)
+        {
+            // Get the Collision Layer:
+            const CollisionLayer collisionLayer = pTrackers[pStart->GetIndex()].m_collisionLayer;
+            NES_ASSERT(collisionLayer != kInvalidCollisionLayer);
+
+            // Find the first Body with a different layer:
+            BodyID* pMid = std::upper_bound(pStart, pEnd, collisionLayer, [pTrackers](const CollisionLayer layer, const BodyID bodyID)
+            {
+                return layer < pTrackers[bodyID.GetIndex()].m_collisionLayer;
+            });
+
+            // Loop over all broadphase layers and test the ones that we could hit:
+            for (BroadPhaseLayer::Type layerIndex = 0; layerIndex < static_cast<BroadPhaseLayer::Type>(m_numLayers); ++layerIndex)
+            {
+                const Layer& layer = m_layers[layerIndex];
+                if (layer.m_numBodies == 0 || !collisionVsBroadPhaseLayerFilter.ShouldCollide(collisionLayer, BroadPhaseLayer(layerIndex)))
+                    continue;
+
+                for (const BodyID* pBody1ID = pStart; pBody1ID < pMid; ++pBody1ID)
+                {
+                    const BodyID body1ID = *pBody1ID;
+                    const Body& body1 = *bodies[body1ID.GetIndex()];
+                    NES_ASSERT(!body1.IsStatic());
+
+                    // Expand the bounding box by the speculative contact distance.
+                    AABox bounds1 = body1.GetWorldSpaceBounds();
+                    bounds1.ExpandBy(Vec3::Replicate(speculativeContactDistance));
+
+                    // Only the entries with a min X in this range can overlap.
+                    uint32 begin;
+                    uint32 end;
+                    GetOverlappingRange(layer, bounds1.m_min.x, bounds1.m_max.x, begin, end);
+
+                    for (uint32 i = begin; i < end; i += 4)
+                    {
+                        const UVec4Reg overlap = math::AABox4VsAABox(bounds1,
+                            Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_minX[i])),
+                            Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_minY[i])),
+                            Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_minZ[i])),
+                            Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_maxX[i])),
+                            Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_maxY[i])),
+                            Vec4Reg::LoadFloat4(reinterpret_cast<const Float4*>(&layer.m_maxZ[i])));
+
+                        // Ignore the entries after the end of the range.
+                        uint32 overlapMask = static_cast<uint32>(overlap.GetTrues());
+                        if (end - i < 4)
+                            overlapMask &= (1u << (end - i)) - 1;
+
+                        while (overlapMask != 0)
+                        {
+                            const uint32 lane = math::CountTrailingZeros(overlapMask);
+                            overlapMask &= overlapMask - 1;
+
+                            // Don't collide with self.
+                            const BodyID body2ID = layer.m_bodyIDs[i + lane];
+                            if (body1ID == body2ID)
+                                continue;
+
+                            // Collisions between dynamic pairs need to be picked up only once.
+                            const Body& body2 = *bodies[body2ID.GetIndex()];
+                            if (collisionLayerPairFilter.ShouldCollide(body1.GetCollisionLayer(), body2.GetCollisionLayer())
+                                && Body::Internal_FindCollidingPairsCanCollide(body1, body2))
+                            {
+                                pairCollector.AddHit({ body1ID, body2ID });
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Repeat for the next Collision Layer
+            pStart = pMid;
+        }
+    }
+
+    AABox BroadPhaseSweepAndPrune::GetBounds() const
+    {
+        // Prevent this from running in parallel with modifications.
+        std::shared_lock lock(m_mutex);
+
+        AABox bounds;
+        for (uint32 layerIndex = 0; layerIndex < m_numLayers; ++layerIndex)
+        {
+            const Layer& layer = m_layers[layerIndex];
+            for (uint32 i = 0; i < layer.m_numBodies; ++i)
+                bounds.Encapsulate(AABox(Vec3(layer.m_minX[i], layer.m_minY[i], layer.m_minZ[i]), Vec3(layer.m_maxX[i], layer.m_maxY[i], layer.m_maxZ[i])));
+        }
+        return bounds;
+    }
+
+    void BroadPhaseSweepAndPrune::ResizeLayer(Layer& layer, const uint32 numBodies)
+    {
+        const size_t size = numBodies + kNumPaddingEntries;
+        layer.m_minX.resize(size);
+        layer.m_minY.resize(size);
+        layer.m_minZ.resize(size);
+        layer.m_maxX.resize(size);
+        layer.m_maxY.resize(size);
+        layer.m_maxZ.resize(size);
+        layer.m_bodyIDs.resize(size);
+        layer.m_numBodies = numBodies;
+
+        // The padding entries are never hit. They sort after all Bodies, as their min X is the largest possible value.
+        for (uint32 i = numBodies; i < size; ++i)
+        {
+            layer.m_minX[i] = layer.m_minY[i] = layer.m_minZ[i] = FLT_MAX;
+            layer.m_maxX[i] = layer.m_maxY[i] = layer.m_maxZ[i] = -FLT_MAX;
+            layer.m_bodyIDs[i] = BodyID();
+        }
+    }
+
+    void BroadPhaseSweepAndPrune::AddToLayer(Layer& layer, const Body& body)
+    {
+        const uint32 index = layer.m_numBodies;
+        ResizeLayer(layer, index + 1);
+        SetEntryBounds(layer, index, body.GetWorldSpaceBounds());
+        layer.m_bodyIDs[index] = body.GetID();
+        m_trackers[body.GetID().GetIndex()].m_index = index;
+
+        // The new entry can be anywhere in the sorted order.
+        layer.m_needsFullSort = true;
+        layer.m_isDirty.store(true, std::memory_order_relaxed);
+    }
+
+    void BroadPhaseSweepAndPrune::RemoveFromLayer(Layer& layer, const uint32 index)
+    {
+        NES_ASSERT(index < layer.m_numBodies);
+
+        // Move the last entry into the hole.
+        const uint32 lastIndex = layer.m_numBodies - 1;
+        if (index != lastIndex)
+        {
+            layer.m_minX[index] = layer.m_minX[lastIndex];
+            layer.m_minY[index] = layer.m_minY[lastIndex];
+            layer.m_minZ[index] = layer.m_minZ[lastIndex];
+            layer.m_maxX[index] = layer.m_maxX[lastIndex];
+            layer.m_maxY[index] = layer.m_maxY[lastIndex];
+            layer.m_maxZ[index] = layer.m_maxZ[lastIndex];
+            layer.m_bodyIDs[index] = layer.m_bodyIDs[lastIndex];
+            m_trackers[layer.m_bodyIDs[index].GetIndex()].m_index = index;
+
+            // The moved entry is out of order.
+            layer.m_needsFullSort = true;
+            layer.m_isDirty.store(true, std::memory_order_relaxed);
+        }
+
+        ResizeLayer(layer, lastIndex);
+    }
+
+    void BroadPhaseSweepAndPrune::SetEntryBounds(Layer& layer, const uint32 index, const AABox& bounds)
+    {
+        layer.m_minX[index] = bounds.m_min.x;
+        layer.m_minY[index] = bounds.m_min.y;
+        layer.m_minZ[index] = bounds.m_min.z;
+        layer.m_maxX[index] = bounds.m_max.x;
+        layer.m_maxY[index] = bounds.m_max.y;
+        layer.m_maxZ[index] = bounds.m_max.z;
+
+        // The max extent only grows until the next sort, which recalculates it.
+        layer.m_maxExtentX = math::Max(layer.m_maxExtentX, bounds.m_max.x - bounds.m_min.x);
+    }
+
+    void BroadPhaseSweepAndPrune::SortDirtyLayers() const
+    {
+        for (uint32 layerIndex = 0; layerIndex < m_numLayers; ++layerIndex)
+        {
+            Layer& layer = m_layers[layerIndex];
+            if (!layer.m_isDirty.load(std::memory_order_acquire))
+                continue;
+
+            // Check again, another thread may have sorted the layer while we were waiting for the lock.
+            std::unique_lock lock(m_mutex);
+            if (layer.m_isDirty.load(std::memory_order_relaxed))
+            {
+                SortLayer(layer);
+                layer.m_isDirty.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    void BroadPhaseSweepAndPrune::SortLayer(Layer& layer) const
+    {
+        const uint32 numBodies = layer.m_numBodies;
+
+        if (layer.m_needsFullSort)
+        {
+            // Sort the indices of the entries by min X.
+            m_sortOrder.resize(numBodies);
+            for (uint32 i = 0; i < numBodies; ++i)
+                m_sortOrder[i] = i;
+
+            const float* pMinX = layer.m_minX.data();
+            QuickSort(m_sortOrder.begin(), m_sortOrder.end(), [pMinX](const uint32 left, const uint32 right)
+            {
+                return pMinX[left] < pMinX[right];
+            });
+
+            // Reorder all arrays.
+            m_sortFloats.resize(numBodies);
+            for (std::vector<float>* pValues : { &layer.m_minX, &layer.m_minY, &layer.m_minZ, &layer.m_maxX, &layer.m_maxY, &layer.m_maxZ })
+            {
+                std::vector<float>& values = *pValues;
+                for (uint32 i = 0; i < numBodies; ++i)
+                    m_sortFloats[i] = values[m_sortOrder[i]];
+                std::copy(m_sortFloats.begin(), m_sortFloats.end(), values.begin());
+            }
+
+            m_sortBodyIDs.resize(numBodies);
+            for (uint32 i = 0; i < numBodies; ++i)
+                m_sortBodyIDs[i] = layer.m_bodyIDs[m_sortOrder[i]];
+            std::copy(m_sortBodyIDs.begin(), m_sortBodyIDs.end(), layer.m_bodyIDs.begin());
+
+            layer.m_needsFullSort = false;
+        }
+        else
+        {
+            // Insertion sort. Bodies only move a small distance between updates, so most entries are already
+            // in place and the others only move a few places.
+            for (uint32 i = 1; i < numBodies; ++i)
+            {
+                const float minX = layer.m_minX[i];
+                if (minX >= layer.m_minX[i - 1])
+                    continue;
+
+                const float minY = layer.m_minY[i];
+                const float minZ = layer.m_minZ[i];
+                const float maxX = layer.m_maxX[i];
+                const float maxY = layer.m_maxY[i];
+                const float maxZ = layer.m_maxZ[i];
+                const BodyID bodyID = layer.m_bodyIDs[i];
+
+                uint32 j = i;
+                do
+                {
+                    layer.m_minX[j] = layer.m_minX[j - 1];
+                    layer.m_minY[j] = layer.m_minY[j - 1];
+                    layer.m_minZ[j] = layer.m_minZ[j - 1];
+                    layer.m_maxX[j] = layer.m_maxX[j - 1];
+                    layer.m_maxY[j] = layer.m_maxY[j - 1];
+                    layer.m_maxZ[j] = layer.m_maxZ[j - 1];
+                    layer.m_bodyIDs[j] = layer.m_bodyIDs[j - 1];
+                    --j;
+                } while (j > 0 && layer.m_minX[j - 1] > minX);
+
+                layer.m_minX[j] = minX;
+                layer.m_minY[j] = minY;
+                layer.m_minZ[j] = minZ;
+                layer.m_maxX[j] = maxX;
+                layer.m_maxY[j] = maxY;
+                layer.m_maxZ[j] = maxZ;
+                layer.m_bodyIDs[j] = bodyID;
+            }
+        }
+
+        // Update the location of the Bodies, and the max extent.
+        float maxExtentX = 0.f;
+        for (uint32 i = 0; i < numBodies; ++i)
+        {
+            m_trackers[layer.m_bodyIDs[i].GetIndex()].m_index = i;
+            maxExtentX = math::Max(maxExtentX, layer.m_maxX[i] - layer.m_minX[i]);
+        }
+        layer.m_maxExtentX = maxExtentX;
+    }
+
+    void BroadPhaseSweepAndPrune::GetOverlappingRange(const Layer& layer, const float minX, const float maxX, uint32& outBegin, uint32& outEnd)
+    {
+        // If the layer hasn't been sorted since the Bodies moved, all entries need to be tested.
+        if (layer.m_isDirty.load(std::memory_order_relaxed))
+        {
+            outBegin = 0;
+            outEnd = layer.m_numBodies;
+            return;
+        }
+
+        // An entry can only overlap if its min X is <= maxX, and its max X (which is at most min X + max extent) is >= minX.
+        const float* pBegin = layer.m_minX.data();
+        const float* pEnd = pBegin + layer.m_numBodies;
+        const float* pRangeBegin = std::lower_bound(pBegin, pEnd, minX - layer.m_maxExtentX);
+        const float* pRangeEnd = std::upper_bound(pRangeBegin, pEnd, maxX);
+        outBegin = static_cast<uint32>(pRangeBegin - pBegin);
+        outEnd = static_cast<uint32>(pRangeEnd - pBegin);
+    }
+}
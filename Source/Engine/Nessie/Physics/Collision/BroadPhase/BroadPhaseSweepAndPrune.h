@@ -0,0 +1,186 @@
+// BroadPhaseSweepAndPrune.h
+#pragma once
+#include <atomic>
+#include <limits>
+#include <vector>
+#include "BroadPhase.h"
+#include "Nessie/Core/Memory/Memory.h"
+#include "Nessie/Core/Thread/Mutex.h"
+#include "Nessie/Physics/PhysicsLock.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Sweep and prune implementation of the Broadphase. For each BroadPhaseLayer, the bounds of
+    ///     the Bodies are stored in arrays sorted by the min X coordinate. A query only tests the range of
+    ///     Bodies whose X interval can overlap the query, 4 at a time.
+    ///
+    ///     Moving a Body only updates its bounds. The arrays are sorted again on the next update or query, with an
+    ///     insertion sort that is close to linear when the Bodies only moved a little since the last frame.
+    ///     This makes it a good fit for scenes with a large number of small, similar sized Bodies that move
+    ///     every frame, where refitting a tree is more expensive. Large Bodies increase the range that needs
+    ///     to be tested for every query in their layer, so they should be placed in a different layer.
+    //----------------------------------------------------------------------------------------------------
+    class BroadPhaseSweepAndPrune final : public BroadPhase
+    {
+    public:
+        virtual ~BroadPhaseSweepAndPrune() override;
+
+    public:
+        virtual void                Init(BodyManager* pBodyManager, const BroadPhaseLayerInterface& layerInterface) override;
+        virtual void                Optimize() override;
+        virtual void                LockModifications() override;
+        virtual void                UnlockModifications() override;
+        virtual UpdateState         UpdatePrepare() override;
+
+        virtual void                AddBodiesFinalize(BodyID* pBodies, int number, AddState addState) override;
+        virtual void                RemoveBodies(BodyID* pBodies, int number) override;
+        virtual void                NotifyBodiesAABBChanged(BodyID* pBodies, int number, bool takeLock) override;
+        virtual void                NotifyBodiesLayerChanged(BodyID* pBodies, int number) override;
+
+        virtual void                CastRay(const RayCast& ray, RayCastBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CastRays(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CastAABox(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CastAABoxNoLock(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CollideAABox(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CollideAABoxNoLock(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CollideSphere(const Vec3& center, const float radius, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CollidePoint(const Vec3& point, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                CollideOrientedBox(const OrientedBox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const override;
+        virtual void                FindCollidingPairs(BodyID* pActiveBodies, int numActiveBodies, float speculativeContactDistance, const CollisionVsBroadPhaseLayerFilter& collisionVsBroadPhaseLayerFilter, const CollisionLayerPairFilter& collisionLayerPairFilter, BodyPairCollector& pairCollector) const override;
+
+        virtual AABox               GetBounds() const override;
+
+    private:
+        /// Number of invalid entries at the end of the arrays of a layer, so that 4 entries can always be loaded at once.
+        static constexpr uint32     kNumPaddingEntries = 3;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Location of a Body in the Broadphase.
+        //----------------------------------------------------------------------------------------------------
+        struct Tracker
+        {
+            static constexpr uint32 kInvalidIndex = std::numeric_limits<uint32>::max();
+
+            BroadPhaseLayer::Type   m_broadPhaseLayer = static_cast<BroadPhaseLayer::Type>(kInvalidBroadPhaseLayer);
+            CollisionLayer          m_collisionLayer = kInvalidCollisionLayer;
+            uint32                  m_index = kInvalidIndex;    /// Index of the Body in the arrays of its layer.
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Bounds of all Bodies in a BroadPhaseLayer, in structure of arrays layout. When the layer
+        ///     is sorted, the entries are in order of increasing min X.
+        //----------------------------------------------------------------------------------------------------
+        struct Layer
+        {
+            std::vector<float>      m_minX;
+            std::vector<float>      m_minY;
+            std::vector<float>      m_minZ;
+            std::vector<float>      m_maxX;
+            std::vector<float>      m_maxY;
+            std::vector<float>      m_maxZ;
+            std::vector<BodyID>     m_bodyIDs;
+
+            /// Number of Bodies in the layer. The arrays contain kNumPaddingEntries more entries.
+            uint32                  m_numBodies = 0;
+
+            /// Largest size of the bounds of a Body along the X axis. A Body with a min X that is further
+            /// than this below the min X of a query cannot overlap it.
+            float                   m_maxExtentX = 0.f;
+
+            /// If the entries need to be sorted again. Set when bounds change, read without a lock by
+            /// FindCollidingPairs.
+            std::atomic<bool>       m_isDirty { false };
+
+            /// If entries were added or removed since the last sort. These can be far from their sorted
+            /// position, so a full sort is used instead of an insertion sort.
+            bool                    m_needsFullSort = false;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Resize the arrays of a layer to hold 'numBodies' Bodies, and fill the padding entries
+        ///     after them with invalid bounds.
+        //----------------------------------------------------------------------------------------------------
+        static void                 ResizeLayer(Layer& layer, const uint32 numBodies);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Add a Body to the end of the arrays of a layer.
+        //----------------------------------------------------------------------------------------------------
+        void                        AddToLayer(Layer& layer, const Body& body);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Remove a Body from a layer by moving the last entry into its place.
+        //----------------------------------------------------------------------------------------------------
+        void                        RemoveFromLayer(Layer& layer, const uint32 index);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Copy the bounds of a Body into entry 'index' of a layer.
+        //----------------------------------------------------------------------------------------------------
+        static void                 SetEntryBounds(Layer& layer, const uint32 index, const AABox& bounds);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Sort all layers that have changed since the last sort. Safe to call from multiple threads.
+        //----------------------------------------------------------------------------------------------------
+        void                        SortDirtyLayers() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Sort the entries of a layer by min X and update the Trackers. Requires a unique lock on m_mutex.
+        //----------------------------------------------------------------------------------------------------
+        void                        SortLayer(Layer& layer) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the range of entries [outBegin, outEnd) of a layer that can overlap the X interval
+        ///     [minX, maxX]. Returns all entries if the layer is not sorted.
+        //----------------------------------------------------------------------------------------------------
+        static void                 GetOverlappingRange(const Layer& layer, const float minX, const float maxX, uint32& outBegin, uint32& outEnd);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Implementation of CastAABox() and CastAABoxNoLock(), without locking.
+        //----------------------------------------------------------------------------------------------------
+        void                        CastAABoxInternal(const AABoxCast& box, CastShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Implementation of CollideAABox() and CollideAABoxNoLock(), without locking.
+        //----------------------------------------------------------------------------------------------------
+        void                        CollideAABoxInternal(const AABox& box, CollideShapeBodyCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Test the entries of all layers that pass the filters against a query. Requires a shared lock on m_mutex.
+        ///	@param minX : Min X of the bounds of the query.
+        ///	@param maxX : Max X of the bounds of the query.
+        ///	@param visitor : Needs the function 'UVec4Reg TestBounds(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ,
+        ///     const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ)' that returns which of the 4 entries are hit,
+        ///     'void VisitBody(const BodyID& bodyID, const int hitIndex)' and 'bool ShouldAbort() const'.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Visitor>
+        void                        WalkLayers(const float minX, const float maxX, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, Visitor& visitor) const;
+
+    private:
+#if NES_ASSERTS_ENABLED
+        /// Context used to lock a physics lock.
+        PhysicsLockContext          m_lockContext = nullptr;
+#endif
+
+        /// Array that for each BodyID, it keeps track of where it is located. Sorting a layer updates the
+        /// indices, which doesn't change the contents of the Broadphase.
+        mutable std::vector<Tracker> m_trackers;
+
+        /// The Maximum number of Bodies that are supported.
+        size_t                      m_maxBodies = 0;
+
+        /// One set of sorted arrays per BroadPhaseLayer.
+        Layer*                      m_layers = nullptr;
+        uint32                      m_numLayers = 0;
+
+        /// Scratch buffers for a full sort, reused to prevent allocations.
+        mutable std::vector<uint32> m_sortOrder;
+        mutable std::vector<float>  m_sortFloats;
+        mutable std::vector<BodyID> m_sortBodyIDs;
+
+        /// Mutex that prevents object modification during UpdatePrepare()/UpdateFinalize().
+        SharedMutex                 m_updateMutex;
+
+        /// Protects the layers. Queries take a shared lock, modifications and sorting take a unique lock.
+        mutable SharedMutex         m_mutex;
+    };
+}
@@ -14,35 +14,38 @@
 
 namespace nes
 {
-    QuadTree::Node::Node(const bool isChanged)
+    template <int NumChildren>
+    TAABBTree<NumChildren>::Node::Node(const bool isChanged)
         : m_isChanged(isChanged)
     {
         // Initialize the Node bounds to have the min and max positions
         // switched, ensuring that no collision can occur with this Node.
-        Vec4Reg val = Vec4::Replicate(math::kLargeFloat);
-        val.StoreFloat4(reinterpret_cast<Float4*>(&m_minX));
-        val.StoreFloat4(reinterpret_cast<Float4*>(&m_minY));
-        val.StoreFloat4(reinterpret_cast<Float4*>(&m_minZ));
-        
-        val = Vec4Reg::Replicate(-math::kLargeFloat);
-        val.StoreFloat4(reinterpret_cast<Float4*>(&m_maxX));
-        val.StoreFloat4(reinterpret_cast<Float4*>(&m_maxY));
-        val.StoreFloat4(reinterpret_cast<Float4*>(&m_maxZ));
+        for (int i = 0; i < NumChildren; i += 4)
+        {
+            Vec4Reg val = Vec4::Replicate(math::kLargeFloat);
+            val.StoreFloat4(reinterpret_cast<Float4*>(&m_minX[i]));
+            val.StoreFloat4(reinterpret_cast<Float4*>(&m_minY[i]));
+            val.StoreFloat4(reinterpret_cast<Float4*>(&m_minZ[i]));
+            
+            val = Vec4Reg::Replicate(-math::kLargeFloat);
+            val.StoreFloat4(reinterpret_cast<Float4*>(&m_maxX[i]));
+            val.StoreFloat4(reinterpret_cast<Float4*>(&m_maxY[i]));
+            val.StoreFloat4(reinterpret_cast<Float4*>(&m_maxZ[i]));
+        }
         
         // Reset child NodeIDs.
-        m_childNodeIDs[0] = NodeID::InvalidID();
-        m_childNodeIDs[1] = NodeID::InvalidID();
-        m_childNodeIDs[2] = NodeID::InvalidID();
-        m_childNodeIDs[3] = NodeID::InvalidID();
+        for (AtomicNodeID& childNodeID : m_childNodeIDs)
+            childNodeID = NodeID::InvalidID();
     }
 
-    void QuadTree::Node::GetNodeBounds(AABox& outBounds) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::Node::GetNodeBounds(AABox& outBounds) const
     {
         // Get the first child bounds.
         GetChildBounds(0, outBounds);
 
         // Grow to encapsulate the other children.
-        for (int i = 1; i < 4; ++i)
+        for (int i = 1; i < NumChildren; ++i)
         {
             AABox temp;
             GetChildBounds(i, temp);
@@ -50,17 +53,19 @@ namespace nes
         }
     }
 
-    void QuadTree::Node::GetChildBounds(const int childIndex, AABox& outBounds) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::Node::GetChildBounds(const int childIndex, AABox& outBounds) const
     {
-        NES_ASSERT(childIndex >= 0 && childIndex < 4);
+        NES_ASSERT(childIndex >= 0 && childIndex < NumChildren);
 
         outBounds.m_min = Vec3(m_minX[childIndex], m_minY[childIndex], m_minZ[childIndex]);
         outBounds.m_max = Vec3(m_maxX[childIndex], m_maxY[childIndex], m_maxZ[childIndex]);
     }
 
-    void QuadTree::Node::SetChildBounds(const int childIndex, const AABox& bounds)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::Node::SetChildBounds(const int childIndex, const AABox& bounds)
     {
-        NES_ASSERT(childIndex >= 0 && childIndex < 4);
+        NES_ASSERT(childIndex >= 0 && childIndex < NumChildren);
         NES_ASSERT(bounds.IsValid());
 
         // Set max first (this keeps the bounding box invalid for reading threads)
@@ -74,9 +79,10 @@ namespace nes
         m_minX[childIndex] = bounds.m_min.x;
     }
 
-    void QuadTree::Node::InvalidateChildBounds(const int childIndex)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::Node::InvalidateChildBounds(const int childIndex)
     {
-        NES_ASSERT(childIndex >= 0 && childIndex < 4);
+        NES_ASSERT(childIndex >= 0 && childIndex < NumChildren);
         
         // First we make the box invalid by setting the min to cLargeFloat
         m_minX[childIndex] = math::kLargeFloat; // Min X becomes invalid first
@@ -89,9 +95,10 @@ namespace nes
         m_maxZ[childIndex] = -math::kLargeFloat;
     }
 
-    bool QuadTree::Node::EncapsulateChildBounds(int childIndex, const AABox& bounds)
+    template <int NumChildren>
+    bool TAABBTree<NumChildren>::Node::EncapsulateChildBounds(int childIndex, const AABox& bounds)
     {
-        NES_ASSERT(childIndex >= 0 && childIndex < 4);
+        NES_ASSERT(childIndex >= 0 && childIndex < NumChildren);
         
         bool wasChanged = AtomicMin(m_minX[childIndex], bounds.m_min.x);
         wasChanged |= AtomicMin(m_minY[childIndex], bounds.m_min.y);
@@ -102,7 +109,8 @@ namespace nes
         return wasChanged;
     }
 
-    QuadTree::BodyTracker::BodyTracker(const BodyTracker& other)
+    template <int NumChildren>
+    TAABBTree<NumChildren>::BodyTracker::BodyTracker(const BodyTracker& other)
         : m_broadPhaseLayer(other.m_broadPhaseLayer.load())
         , m_collisionLayer(other.m_collisionLayer.load())
         , m_bodyLocation(other.m_bodyLocation.load())
@@ -110,7 +118,8 @@ namespace nes
         //
     }
 
-    const AABox QuadTree::kInvalidBounds(Vec3(math::kLargeFloat), Vec3(-math::kLargeFloat));
+    template <int NumChildren>
+    const AABox TAABBTree<NumChildren>::kInvalidBounds(Vec3(math::kLargeFloat), Vec3(-math::kLargeFloat));
 
     static inline void QuadTreePerformanceWarning()
     {
@@ -126,14 +135,15 @@ namespace nes
     #endif
     }
 
-    QuadTree::~QuadTree()
+    template <int NumChildren>
+    TAABBTree<NumChildren>::~TAABBTree()
     {
         DiscardOldTree();
 
         const RootNode& rootNode = GetCurrentRoot();
 
         // Collect all Nodes:
-        Allocator::Batch freeBatch;
+        typename Allocator::Batch freeBatch;
         std::vector<NodeID, STLLocalAllocator<NodeID, kStackSize>> nodeStack;
         nodeStack.reserve(kStackSize);
         nodeStack.push_back(rootNode.GetNodeID());
@@ -171,7 +181,8 @@ namespace nes
     //----------------------------------------------------------------------------------------------------
     /// @brief : Initialize the Quadtree. 
     //----------------------------------------------------------------------------------------------------
-    void QuadTree::Init(Allocator& allocator)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::Init(Allocator& allocator)
     {
         m_pAllocator = &allocator;
         m_rootNodes[m_rootNodeIndex].m_index = AllocateNode(false);
@@ -180,7 +191,8 @@ namespace nes
     //----------------------------------------------------------------------------------------------------
     /// @brief : Throws away the previous frame's Nodes so that a new Tree can be built in the background. 
     //----------------------------------------------------------------------------------------------------
-    void QuadTree::DiscardOldTree()
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::DiscardOldTree()
     {
         // Check if there is an old tree:
         RootNode& oldRoot = m_rootNodes[m_rootNodeIndex ^ 1];
@@ -193,11 +205,12 @@ namespace nes
             m_pAllocator->DestructBatch(m_freeNodeBatch);
             
             // Clear the Batch:
-            m_freeNodeBatch = Allocator::Batch();
+            m_freeNodeBatch = typename Allocator::Batch();
         }
     }
 
-    void QuadTree::UpdatePrepare(const BodyVector& bodies, BodyTrackerArray& outTrackers, UpdateState& outState, const bool doFullRebuild)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::UpdatePrepare(const BodyVector& bodies, BodyTrackerArray& outTrackers, UpdateState& outState, const bool doFullRebuild)
     {
 #if NES_ASSERTS_ENABLED
         // We only read positions.
@@ -214,8 +227,15 @@ namespace nes
         ValidateTree(bodies, outTrackers, rootNode.m_index, m_numBodies);
 #endif
 
-        // Create space for all BodyIDs.
-        NodeID* pNodeIDs = new NodeID[m_numBodies];
+        // Create space for all BodyIDs. The buffers only grow, so the tree update doesn't allocate once the
+        // number of bodies has settled.
+        const uint32 numBodies = m_numBodies;
+        if (m_updateNodeIDs.size() < numBodies)
+        {
+            m_updateNodeIDs.resize(numBodies);
+            m_updateCenters.resize(numBodies);
+        }
+        NodeID* pNodeIDs = m_updateNodeIDs.data();
         NodeID* pCurrentNodeID = pNodeIDs;
 
         // Collect all Bodies
@@ -284,7 +304,7 @@ namespace nes
 
             // Build the new Tree:
             AABox rootBounds;
-            rootNodeID = BuildTree(bodies, outTrackers, pNodeIDs, static_cast<int>(numNodeIDs), kMaxDepthMarkChanged, rootBounds);
+            rootNodeID = BuildTree(bodies, outTrackers, pNodeIDs, static_cast<int>(numNodeIDs), kMaxDepthMarkChanged, m_updateCenters.data(), rootBounds);
 
             // For a single Body, we allocate a new Root Node.
             if (rootNodeID.IsBody())
@@ -304,11 +324,11 @@ namespace nes
             rootNodeID = NodeID::FromNodeIndex(rootIndex);
         }
         
-        delete[] pNodeIDs;
         outState.m_rootNodeID = rootNodeID;
     }
 
-    void QuadTree::UpdateFinalize([[maybe_unused]] const BodyVector& bodies, [[maybe_unused]] const BodyTrackerArray& trackers, const UpdateState& state)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::UpdateFinalize([[maybe_unused]] const BodyVector& bodies, [[maybe_unused]] const BodyTrackerArray& trackers, const UpdateState& state)
     {
         // Tree Building is complete, now we switch the old with the new tree.
         uint32 newRootIndex = m_rootNodeIndex ^ 1;
@@ -329,7 +349,8 @@ namespace nes
 #endif
     }
 
-    void QuadTree::AddBodiesPrepare(const BodyVector& bodies, BodyTrackerArray& trackers, BodyID* bodyIDArray,
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::AddBodiesPrepare(const BodyVector& bodies, BodyTrackerArray& trackers, BodyID* bodyIDArray,
         const int number, AddState& outState)
     {
         // Assert sane input
@@ -346,7 +367,10 @@ namespace nes
 
         // Build a subtree for the new Bodies. Note that we make all nodes as 'not changed'
         // so that they will stay together as a batch and will make the tree rebuild cheaper.
-        outState.m_leafID = BuildTree(bodies, trackers, reinterpret_cast<NodeID*>(bodyIDArray), number, 0, outState.m_leafBounds);
+        // Bodies can be added from multiple threads at the same time, so the centers can't use the buffer of the tree.
+        Vec3* pCenters = NES_NEW_ARRAY(Vec3, number);
+        outState.m_leafID = BuildTree(bodies, trackers, reinterpret_cast<NodeID*>(bodyIDArray), number, 0, pCenters, outState.m_leafBounds);
+        NES_DELETE_ARRAY(pCenters);
 
 #ifdef NES_DEBUG
         if (outState.m_leafID.IsNode())
@@ -354,7 +378,8 @@ namespace nes
 #endif
     }
 
-    void QuadTree::AddBodiesFinalize(BodyTrackerArray& trackers, int numBodies, const AddState& state)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::AddBodiesFinalize(BodyTrackerArray& trackers, int numBodies, const AddState& state)
     {
         NES_ASSERT(numBodies > 0);
 
@@ -375,10 +400,11 @@ namespace nes
         }
     }
 
-    void QuadTree::AddBodiesAbort(BodyTrackerArray& trackers, const AddState& state)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::AddBodiesAbort(BodyTrackerArray& trackers, const AddState& state)
     {
         // Collect all bodies:
-        Allocator::Batch freeBatch;
+        typename Allocator::Batch freeBatch;
         NodeID nodeStack[kStackSize];
         nodeStack[0] = state.m_leafID;
         NES_ASSERT(nodeStack[0].IsValid());
@@ -417,7 +443,8 @@ namespace nes
         m_pAllocator->DestructBatch(freeBatch);
     }
 
-    void QuadTree::RemoveBodies([[maybe_unused]] const BodyVector& bodies, BodyTrackerArray& trackers, const BodyID* bodyIDArray,
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::RemoveBodies([[maybe_unused]] const BodyVector& bodies, BodyTrackerArray& trackers, const BodyID* bodyIDArray,
         const int number)
     {
         NES_ASSERT(bodyIDArray != nullptr);
@@ -453,7 +480,8 @@ namespace nes
         m_numBodies -= number;
     }
 
-    void QuadTree::NotifyBodiesAABBChanged(const BodyVector& bodies, const BodyTrackerArray& trackers,
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::NotifyBodiesAABBChanged(const BodyVector& bodies, const BodyTrackerArray& trackers,
         const BodyID* bodyIDArray, const int number)
     {
         NES_ASSERT(bodyIDArray != nullptr);
@@ -486,7 +514,8 @@ namespace nes
         }
     }
 
-    void QuadTree::CastRay(const RayCast& ray, RayCastBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::CastRay(const RayCast& ray, RayCastBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
     {
         class Visitor
         {
@@ -523,6 +552,43 @@ namespace nes
                 return SortReverseAndStore(fraction, m_collector.GetEarlyOutFraction(), childNodeIDs, &m_fractionStack[stackTop]);
             }
 
+            //----------------------------------------------------------------------------------------------------
+            ///	@brief : Visit the 8 children of an OctTree node at once. Stores the IDs of the children that were hit
+            ///     in pOutChildNodeIDs so that the closest hits are processed first, and returns the number of hits.
+            //----------------------------------------------------------------------------------------------------
+            NES_INLINE int          VisitNodes8(const float* pBoundsMinX, const float* pBoundsMinY, const float* pBoundsMinZ, const float* pBoundsMaxX, const float* pBoundsMaxY, const float* pBoundsMaxZ, const uint32* pChildNodeIDs, uint32* pOutChildNodeIDs, const int stackTop)
+            {
+                // Test the ray against 8 bounding boxes.
+                Vec4Reg fractionA;
+                Vec4Reg fractionB;
+                RayAABox8(m_origin, m_invDirection, pBoundsMinX, pBoundsMinY, pBoundsMinZ, pBoundsMaxX, pBoundsMaxY, pBoundsMaxZ, fractionA, fractionB);
+
+                // Sort each half so that the highest values are first.
+                UVec4Reg childIDsA = UVec4Reg::LoadInt4(pChildNodeIDs);
+                UVec4Reg childIDsB = UVec4Reg::LoadInt4(pChildNodeIDs + 4);
+                float fractionsA[4];
+                float fractionsB[4];
+                int numA = SortReverseAndStore(fractionA, m_collector.GetEarlyOutFraction(), childIDsA, fractionsA);
+                int numB = SortReverseAndStore(fractionB, m_collector.GetEarlyOutFraction(), childIDsB, fractionsB);
+
+                // We process the stack from top to bottom, so the half with the closest hit should be stored last.
+                if (numA > 0 && numB > 0 && fractionsA[numA - 1] < fractionsB[numB - 1])
+                {
+                    std::swap(childIDsA, childIDsB);
+                    std::swap(fractionsA, fractionsB);
+                    std::swap(numA, numB);
+                }
+
+                childIDsA.StoreInt4(pOutChildNodeIDs);
+                childIDsB.StoreInt4(pOutChildNodeIDs + numA);
+                for (int i = 0; i < numA; ++i)
+                    m_fractionStack[stackTop + i] = fractionsA[i];
+                for (int i = 0; i < numB; ++i)
+                    m_fractionStack[stackTop + numA + i] = fractionsB[i];
+
+                return numA + numB;
+            }
+
             //----------------------------------------------------------------------------------------------------
             ///	@brief : Visit a body. Returns false if the algorithm should terminate because no hits can be generated anymore.
             //----------------------------------------------------------------------------------------------------
@@ -553,7 +619,198 @@ namespace nes
         WalkTree(layerFilter, trackers, visitor);
     }
 
-    void QuadTree::CastAABox(const AABoxCast& box, CastShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::CastRays(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
+    {
+        // Walk the tree once per packet of rays.
+        for (int first = 0; first < numRays; first += kRayPacketSize)
+            CastRayPacket(pRays + first, pCollectors + first, math::Min(numRays - first, kRayPacketSize), layerFilter, trackers);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    //	NOTES:
+    //  Each stack entry holds the rays that hit the bounds of the Node, and the closest of those hits.
+    //  A ray is dropped from an entry when that closest hit is no closer than the early out fraction of
+    //  the ray, since its own hit with the Node can only be further away. Bodies are passed to the
+    //  collector of each ray when their parent Node is visited, closest first, so that a closest hit
+    //  collector can skip the Nodes behind them.
+    //----------------------------------------------------------------------------------------------------
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::CastRayPacket(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
+    {
+        static_assert(kRayPacketSize <= 32, "The rays of a packet are stored in a 32-bit mask!");
+        NES_ASSERT(numRays <= kRayPacketSize);
+
+        struct StackEntry
+        {
+            NodeID                  m_nodeID;
+            uint32                  m_rayMask;      /// Rays that hit the bounds of the Node.
+            float                   m_fraction;     /// Closest hit of these rays with the bounds of the Node.
+        };
+
+        // Rays of which the collector already wants to early out are not cast.
+        Vec3 origins[kRayPacketSize];
+        RayInvDirection invDirections[kRayPacketSize];
+        uint32 activeRays = 0;
+        for (int i = 0; i < numRays; ++i)
+        {
+            origins[i] = pRays[i].m_origin;
+            invDirections[i].Set(pRays[i].m_direction);
+            if (!pCollectors[i]->ShouldEarlyOut())
+                activeRays |= 1u << i;
+        }
+
+        std::vector<StackEntry, STLLocalAllocator<StackEntry, kStackSize>> stack;
+        stack.resize(kStackSize);
+        stack[0] = { GetCurrentRoot().GetNodeID(), activeRays, -1.f };
+        int top = 0;
+        while (top >= 0 && activeRays != 0)
+        {
+            const StackEntry entry = stack[top--];
+
+            // Drop the rays that can no longer find a closer hit in this Node.
+            uint32 rayMask = entry.m_rayMask & activeRays;
+            for (uint32 mask = rayMask; mask != 0; mask &= mask - 1)
+            {
+                const uint32 rayIndex = math::CountTrailingZeros(mask);
+                if (entry.m_fraction >= pCollectors[rayIndex]->GetEarlyOutFraction())
+                    rayMask &= ~(1u << rayIndex);
+            }
+            if (rayMask == 0)
+                continue;
+
+            const Node& node = m_pAllocator->Get(entry.m_nodeID.GetNodeIndex());
+            NES_ASSERT(math::IsAligned(&node, NES_CACHE_LINE_SIZE));
+
+            // Read the children once, and test the layers of the Bodies once for all rays.
+            NodeID childNodeIDs[NumChildren];
+            uint32 bodyChildren = 0;
+            uint32 nodeChildren = 0;
+            for (int i = 0; i < NumChildren; ++i)
+            {
+                childNodeIDs[i] = node.m_childNodeIDs[i];
+                if (childNodeIDs[i].IsBody())
+                {
+                    const CollisionLayer layer = trackers[childNodeIDs[i].GetBodyID().GetIndex()].m_collisionLayer;
+                    if (layer != kInvalidCollisionLayer && layerFilter.ShouldCollide(layer))
+                        bodyChildren |= 1u << i;
+                }
+                else if (childNodeIDs[i].IsValid())
+                {
+                    nodeChildren |= 1u << i;
+                }
+            }
+
+            // For each child Node, the rays that hit it and the closest of those hits.
+            UVec4Reg childRayMasks[NumChildren / 4];
+            Vec4Reg childFractions[NumChildren / 4];
+
+            for (int group = 0; group < NumChildren / 4; ++group)
+            {
+                childRayMasks[group] = UVec4Reg::Zero();
+                childFractions[group] = Vec4Reg::Replicate(FLT_MAX);
+
+                const uint32 groupBodies = (bodyChildren >> (group * 4)) & 0xf;
+                const uint32 groupNodes = (nodeChildren >> (group * 4)) & 0xf;
+                if ((groupBodies | groupNodes) == 0)
+                    continue;
+                const UVec4Reg isNode(groupNodes & 1 ? 0xffffffff : 0, groupNodes & 2 ? 0xffffffff : 0, groupNodes & 4 ? 0xffffffff : 0, groupNodes & 8 ? 0xffffffff : 0);
+
+                // Load the bounds of the 4 children once for all rays:
+                const Vec4Reg boundsMinX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minX[group * 4]));
+                const Vec4Reg boundsMinY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minY[group * 4]));
+                const Vec4Reg boundsMinZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minZ[group * 4]));
+                const Vec4Reg boundsMaxX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxX[group * 4]));
+                const Vec4Reg boundsMaxY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxY[group * 4]));
+                const Vec4Reg boundsMaxZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxZ[group * 4]));
+
+                for (uint32 mask = rayMask; mask != 0; mask &= mask - 1)
+                {
+                    const uint32 rayIndex = math::CountTrailingZeros(mask);
+                    RayCastBodyCollector& collector = *pCollectors[rayIndex];
+
+                    const Vec4Reg fraction = RayAABox4(origins[rayIndex], invDirections[rayIndex], boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+                    const UVec4Reg isHit = Vec4Reg::Less(fraction, Vec4Reg::Replicate(collector.GetEarlyOutFraction()));
+                    const uint32 hits = static_cast<uint32>(isHit.GetTrues());
+
+                    // Add the ray to the child Nodes that it hits.
+                    if (hits & groupNodes)
+                    {
+                        const UVec4Reg isNodeHit = UVec4Reg::And(isHit, isNode);
+                        childRayMasks[group] = UVec4Reg::Or(childRayMasks[group], UVec4Reg::And(isNodeHit, UVec4Reg::Replicate(1u << rayIndex)));
+                        childFractions[group] = Vec4Reg::Min(childFractions[group], Vec4Reg::Select(Vec4Reg::Replicate(FLT_MAX), fraction, isNodeHit));
+                    }
+
+                    // Pass the Bodies that it hits to the collector, closest first.
+                    uint32 bodyHits = hits & groupBodies;
+                    if (bodyHits == 0)
+                        continue;
+
+                    alignas(16) float fractions[4];
+                    fraction.StoreFloat4(reinterpret_cast<Float4*>(fractions));
+                    do
+                    {
+                        uint32 closest = math::CountTrailingZeros(bodyHits);
+                        for (uint32 remaining = bodyHits & (bodyHits - 1); remaining != 0; remaining &= remaining - 1)
+                        {
+                            const uint32 index = math::CountTrailingZeros(remaining);
+                            if (fractions[index] < fractions[closest])
+                                closest = index;
+                        }
+                        bodyHits &= ~(1u << closest);
+
+                        // A closer Body can have moved the early out fraction.
+                        if (fractions[closest] >= collector.GetEarlyOutFraction())
+                            break;
+
+                        // [TODO]: Stat tracking.
+                        BroadPhaseCastResult result { childNodeIDs[group * 4 + closest].GetBodyID(), fractions[closest] };
+                        collector.AddHit(result);
+                        if (collector.ShouldEarlyOut())
+                        {
+                            activeRays &= ~(1u << rayIndex);
+                            rayMask &= ~(1u << rayIndex);
+                            break;
+                        }
+                    }
+                    while (bodyHits != 0);
+                }
+            }
+
+            if (top + NumChildren >= static_cast<int>(stack.size()))
+            {
+                QuadTreePerformanceWarning();
+                stack.resize(stack.size() << 1);
+            }
+
+            // Push the child Nodes so that the closest is on top of the stack.
+            alignas(16) uint32 rayMasks[NumChildren];
+            alignas(16) float fractions[NumChildren];
+            for (int group = 0; group < NumChildren / 4; ++group)
+            {
+                childRayMasks[group].StoreInt4(&rayMasks[group * 4]);
+                childFractions[group].StoreFloat4(reinterpret_cast<Float4*>(&fractions[group * 4]));
+            }
+
+            int numPushed = 0;
+            for (int i = 0; i < NumChildren; ++i)
+            {
+                if ((rayMasks[i] & activeRays) == 0)
+                    continue;
+
+                const StackEntry childEntry { childNodeIDs[i], rayMasks[i], fractions[i] };
+                int index = top + 1 + numPushed;
+                for (; index > top + 1 && stack[index - 1].m_fraction < childEntry.m_fraction; --index)
+                    stack[index] = stack[index - 1];
+                stack[index] = childEntry;
+                ++numPushed;
+            }
+            top += numPushed;
+        }
+    }
+
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::CastAABox(const AABoxCast& box, CastShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
     {
         class Visitor
         {
@@ -631,7 +888,8 @@ namespace nes
         WalkTree(layerFilter, trackers, visitor);
     }
 
-    void QuadTree::CollideAABox(const AABox& box, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::CollideAABox(const AABox& box, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
     {
         class Visitor
         {
@@ -669,7 +927,8 @@ namespace nes
         WalkTree(layerFilter, trackers, visitor);
     }
 
-    void QuadTree::CollideSphere(const Vec3& center, const float radius, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::CollideSphere(const Vec3& center, const float radius, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
     {
         class Visitor
         {
@@ -718,7 +977,8 @@ namespace nes
         WalkTree(layerFilter, trackers, visitor);
     }
 
-    void QuadTree::CollidePoint(const Vec3& point, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::CollidePoint(const Vec3& point, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
     {
         class Visitor
         {
@@ -761,7 +1021,8 @@ namespace nes
         WalkTree(layerFilter, trackers, visitor);
     }
 
-    void QuadTree::CollideOrientedBox(const OrientedBox& box, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::CollideOrientedBox(const OrientedBox& box, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const
     {
         class Visitor
         {
@@ -810,7 +1071,8 @@ namespace nes
         WalkTree(layerFilter, trackers, visitor); 
     }
 
-    void QuadTree::FindCollidingPairs(const BodyVector& bodies, const BodyID* activeBodiesArray, const int numActiveBodies, float speculativeContactDistance, BodyPairCollector& collector, const CollisionLayerPairFilter& layerFilter) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::FindCollidingPairs(const BodyVector& bodies, const BodyID* activeBodiesArray, const int numActiveBodies, float speculativeContactDistance, BodyPairCollector& collector, const CollisionLayerPairFilter& layerFilter) const
     {
         // Note that we don't lock the tree at this point. We know that the tree is not going to be swapped or deleted while finding collision pairs due to the way the jobs are scheduled in
         // the PhysicsScene::Update. We double-check this assumption at the end of the function.
@@ -865,36 +1127,74 @@ namespace nes
                     const Node& node = m_pAllocator->Get(childNodeID.GetNodeIndex());
                     NES_ASSERT(math::IsAligned(&node, NES_CACHE_LINE_SIZE));
 
-                    // Get the bounds of the 4 children
-                    const Vec4Reg boundsMinX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minX));
-                    const Vec4Reg boundsMinY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minY));
-                    const Vec4Reg boundsMinZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minZ));
-                    const Vec4Reg boundsMaxX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxX));
-                    const Vec4Reg boundsMaxY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxY));
-                    const Vec4Reg boundsMaxZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxZ));
-
-                    // Test overlap
-                    const UVec4Reg overlap = math::AABox4VsAABox(bounds1, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
-                    const int numResults = overlap.CountTrues();
-                    if (numResults > 0)
+                    if constexpr (NumChildren == 4)
                     {
-                        // Load the ids for the 4 children
-                        UVec4Reg childIDs = UVec4Reg::LoadInt4Aligned(reinterpret_cast<const uint32*>(&node.m_childNodeIDs[0]));
-
-                        // Sort so that overlaps are first.
-                        childIDs = UVec4Reg::Sort4True(overlap, childIDs);
-
-                        // Ensure there is space on the stack (falls back to the heap if there isn't).
-                        if (top + 4 >= static_cast<int>(nodeStackArray.size()))
+                        // Get the bounds of the 4 children
+                        const Vec4Reg boundsMinX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minX));
+                        const Vec4Reg boundsMinY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minY));
+                        const Vec4Reg boundsMinZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minZ));
+                        const Vec4Reg boundsMaxX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxX));
+                        const Vec4Reg boundsMaxY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxY));
+                        const Vec4Reg boundsMaxZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxZ));
+
+                        // Test overlap
+                        const UVec4Reg overlap = math::AABox4VsAABox(bounds1, boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ);
+                        const int numResults = overlap.CountTrues();
+                        if (numResults > 0)
                         {
-                            QuadTreePerformanceWarning();
-                            nodeStackArray.resize(nodeStackArray.size() << 1);
-                            pNodeStack = nodeStackArray.data();
+                            // Load the ids for the 4 children
+                            UVec4Reg childIDs = UVec4Reg::LoadInt4Aligned(reinterpret_cast<const uint32*>(&node.m_childNodeIDs[0]));
+
+                            // Sort so that overlaps are first.
+                            childIDs = UVec4Reg::Sort4True(overlap, childIDs);
+
+                            // Ensure there is space on the stack (falls back to the heap if there isn't).
+                            if (top + 4 >= static_cast<int>(nodeStackArray.size()))
+                            {
+                                QuadTreePerformanceWarning();
+                                nodeStackArray.resize(nodeStackArray.size() << 1);
+                                pNodeStack = nodeStackArray.data();
+                            }
+
+                            // Push them onto the stack
+                            childIDs.StoreInt4(reinterpret_cast<uint32*>(&pNodeStack[top]));
+                            top += numResults;
+                        }
+                    }
+                    else
+                    {
+                        // Test overlap with the 8 children
+                        UVec4Reg overlapLow;
+                        UVec4Reg overlapHigh;
+                        math::AABox8VsAABox(bounds1
+                            , reinterpret_cast<const float*>(node.m_minX), reinterpret_cast<const float*>(node.m_minY), reinterpret_cast<const float*>(node.m_minZ)
+                            , reinterpret_cast<const float*>(node.m_maxX), reinterpret_cast<const float*>(node.m_maxY), reinterpret_cast<const float*>(node.m_maxZ)
+                            , overlapLow, overlapHigh);
+                        
+                        const int numResultsLow = overlapLow.CountTrues();
+                        const int numResultsHigh = overlapHigh.CountTrues();
+                        if (numResultsLow + numResultsHigh > 0)
+                        {
+                            // Load the ids for the 8 children, and sort so that overlaps are first.
+                            UVec4Reg childIDsLow = UVec4Reg::LoadInt4Aligned(reinterpret_cast<const uint32*>(&node.m_childNodeIDs[0]));
+                            UVec4Reg childIDsHigh = UVec4Reg::LoadInt4Aligned(reinterpret_cast<const uint32*>(&node.m_childNodeIDs[4]));
+                            childIDsLow = UVec4Reg::Sort4True(overlapLow, childIDsLow);
+                            childIDsHigh = UVec4Reg::Sort4True(overlapHigh, childIDsHigh);
+
+                            // Ensure there is space on the stack (falls back to the heap if there isn't).
+                            if (top + 8 >= static_cast<int>(nodeStackArray.size()))
+                            {
+                                QuadTreePerformanceWarning();
+                                nodeStackArray.resize(nodeStackArray.size() << 1);
+                                pNodeStack = nodeStackArray.data();
+                            }
+
+                            // Push them onto the stack
+                            childIDsLow.StoreInt4(reinterpret_cast<uint32*>(&pNodeStack[top]));
+                            top += numResultsLow;
+                            childIDsHigh.StoreInt4(reinterpret_cast<uint32*>(&pNodeStack[top]));
+                            top += numResultsHigh;
                         }
-
-                        // Push them onto the stack
-                        childIDs.StoreInt4(reinterpret_cast<uint32*>(&pNodeStack[top]));
-                        top += numResults;
                     }
                 }
 
@@ -909,7 +1209,8 @@ namespace nes
         NES_ASSERT(&rootNode == &GetCurrentRoot());
     }
 
-    AABox QuadTree::GetBounds() const
+    template <int NumChildren>
+    AABox TAABBTree<NumChildren>::GetBounds() const
     {
         const uint32 nodeIndex = GetCurrentRoot().m_index;
         NES_ASSERT(nodeIndex != kInvalidNodeIndex);
@@ -920,7 +1221,8 @@ namespace nes
         return bounds;
     }
 
-    void QuadTree::GetBodyLocation(const BodyTrackerArray& trackers, const BodyID bodyID, uint32& outNodeIndex, uint32& outChildIndex) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::GetBodyLocation(const BodyTrackerArray& trackers, const BodyID bodyID, uint32& outNodeIndex, uint32& outChildIndex) const
     {
         const uint32 bodyLocation = trackers[bodyID.GetIndex()].m_bodyLocation;
         NES_ASSERT(bodyLocation != BodyTracker::kInvalidBodyLocation);
@@ -929,10 +1231,11 @@ namespace nes
         NES_ASSERT(m_pAllocator->Get(outNodeIndex).m_childNodeIDs[outChildIndex] == bodyID, "Make sure that the body is in the node where it should be!");
     }
 
-    void QuadTree::SetBodyLocation(BodyTrackerArray& trackers, const BodyID bodyID, const uint32 nodeIndex, const uint32 childIndex) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::SetBodyLocation(BodyTrackerArray& trackers, const BodyID bodyID, const uint32 nodeIndex, const uint32 childIndex) const
     {
         NES_ASSERT(nodeIndex <= BodyTracker::kBodyIndexMask);
-        NES_ASSERT(childIndex < 4);
+        NES_ASSERT(childIndex < NumChildren);
         NES_ASSERT(m_pAllocator->Get(nodeIndex).m_childNodeIDs[childIndex] == bodyID, "Make sure that the body is in the node where it should be!");
         trackers[bodyID.GetIndex()].m_bodyLocation = nodeIndex + (childIndex << BodyTracker::kChildIndexShift);
 
@@ -946,12 +1249,14 @@ namespace nes
 #endif
     }
 
-    void QuadTree::InvalidateBodyLocation(BodyTrackerArray& trackers, const BodyID bodyID)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::InvalidateBodyLocation(BodyTrackerArray& trackers, const BodyID bodyID)
     {
         trackers[bodyID.GetIndex()].m_bodyLocation = BodyTracker::kInvalidBodyLocation;
     }
 
-    AABox QuadTree::GetNodeOrBodyBounds(const BodyVector& bodies, NodeID nodeID) const
+    template <int NumChildren>
+    AABox TAABBTree<NumChildren>::GetNodeOrBodyBounds(const BodyVector& bodies, NodeID nodeID) const
     {
         if (nodeID.IsNode())
         {
@@ -968,7 +1273,8 @@ namespace nes
         return bodies[nodeID.GetBodyID().GetIndex()]->GetWorldSpaceBounds();   
     }
 
-    void QuadTree::MarkNodeAndParentsChanged(uint32 nodeIndex)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::MarkNodeAndParentsChanged(uint32 nodeIndex)
     {
         uint32 currentIndex = nodeIndex;
 
@@ -989,7 +1295,8 @@ namespace nes
         while (currentIndex != kInvalidNodeIndex);
     }
 
-    void QuadTree::WidenAndMarkNodeAndParentsChanged(const uint32 nodeIndex, const AABox& newBounds)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::WidenAndMarkNodeAndParentsChanged(const uint32 nodeIndex, const AABox& newBounds)
     {
         uint32 currentIndex = nodeIndex;
 
@@ -1008,7 +1315,7 @@ namespace nes
             Node& parentNode = m_pAllocator->Get(parentNodeIndex);
             NodeID nodeID = NodeID::FromNodeIndex(currentIndex);
             int childIndex = -1;
-            for (int i = 0; i < 4; ++i)
+            for (int i = 0; i < NumChildren; ++i)
             {
                 if (parentNode.m_childNodeIDs[i] == nodeID)
                 {
@@ -1024,16 +1331,17 @@ namespace nes
             {
                 // No changes to the bounding box, only marking as changed needs to be done.
                 if (!parentNode.m_isChanged)
-                    MarkNodeAndParentsChanged(nodeIndex);
+                    MarkNodeAndParentsChanged(parentNodeIndex);
                 
                 break;
             }
 
-            currentIndex = parentNode.m_parentNodeIndex;
+            currentIndex = parentNodeIndex;
         }
     }
 
-    uint32 QuadTree::AllocateNode(bool isChanged)
+    template <int NumChildren>
+    uint32 TAABBTree<NumChildren>::AllocateNode(bool isChanged)
     {
         const uint32 index = m_pAllocator->ConstructObject(isChanged);
         if (index == Allocator::kInvalidObjectIndex)
@@ -1056,7 +1364,8 @@ namespace nes
         return index;
     }
 
-    bool QuadTree::TryInsertLeaf(BodyTrackerArray& trackers, const int nodeIndex, const NodeID leafID, const AABox& leafBounds, const int numLeafBodies)
+    template <int NumChildren>
+    bool TAABBTree<NumChildren>::TryInsertLeaf(BodyTrackerArray& trackers, const int nodeIndex, const NodeID leafID, const AABox& leafBounds, const int numLeafBodies)
     {
         // Tentatively assign the node as the parent.
         const bool leafIsNode = leafID.IsNode();
@@ -1070,7 +1379,7 @@ namespace nes
         Node& node = m_pAllocator->Get(nodeIndex);
 
         // Find an empty child node
-        for (uint32 childIndex = 0; childIndex < 4; ++childIndex)
+        for (uint32 childIndex = 0; childIndex < NumChildren; ++childIndex)
         {
             // Check if we can claim the Child Node
             if (node.m_childNodeIDs[childIndex].CompareExchange(NodeID::InvalidID(), leafID))
@@ -1098,7 +1407,8 @@ namespace nes
         return false;
     }
 
-    bool QuadTree::TryCreateNewRoot(BodyTrackerArray& trackers, std::atomic<uint32>& rootNodeIndex, NodeID leafID, const AABox& leafBounds, int numLeafBodies)
+    template <int NumChildren>
+    bool TAABBTree<NumChildren>::TryCreateNewRoot(BodyTrackerArray& trackers, std::atomic<uint32>& rootNodeIndex, NodeID leafID, const AABox& leafBounds, int numLeafBodies)
     {
         // Grab the old root
         uint32 rootIndex = rootNodeIndex;
@@ -1148,7 +1458,8 @@ namespace nes
         return false;
     }
 
-    QuadTree::NodeID QuadTree::BuildTree(const BodyVector& bodies, BodyTrackerArray& trackers, NodeID* pNodeIDs, int number, uint maxDepthMarkChanged, AABox& outBounds)
+    template <int NumChildren>
+    typename TAABBTree<NumChildren>::NodeID TAABBTree<NumChildren>::BuildTree(const BodyVector& bodies, BodyTrackerArray& trackers, NodeID* pNodeIDs, int number, uint maxDepthMarkChanged, Vec3* pCenters, AABox& outBounds)
     {
         // Trivial case: No Bodies in the tree
         if (number == 0)
@@ -1172,7 +1483,6 @@ namespace nes
         }
 
         // Calculate the centers of all bodies that are to be inserted.
-        Vec3* pCenters = NES_NEW_ARRAY(Vec3, number);
         NES_ASSERT(math::IsAligned(pCenters, NES_VECTOR_ALIGNMENT));
         Vec3* pCurrent = pCenters;
         for (const NodeID* pValue = pNodeIDs, *pEnd = pNodeIDs + number; pValue < pEnd; ++pValue, ++pCurrent)
@@ -1185,13 +1495,13 @@ namespace nes
         {
             uint32  m_nodeIndex;       /// Node index of the Node that is generated.
             int     m_childIndex;      /// Index of the child that we are currently processing.
-            int     m_splitIndices[5]; /// Indices where the node ID's have been split to form 4 partitions.
+            int     m_splitIndices[NumChildren + 1]; /// Indices where the node ID's have been split to form NumChildren partitions.
             uint32  m_depth;           /// Depth of this node in the tree.
             Vec3    m_boundsMin;       /// Bounding box min, accumulated while iterating over children.
             Vec3    m_boundsMax;       /// Bounding box max, accumulated while iterating over children.
         };
-        static_assert(sizeof(StackEntry) == 64);
-        StackEntry stack[kStackSize / 4]; // We don't process 4 at a time in this loop but 1, so the stack can be 4x as small.
+        static_assert(NumChildren != 4 || sizeof(StackEntry) == 64);
+        StackEntry stack[kStackSize / NumChildren]; // We don't process NumChildren at a time in this loop but 1, so the stack can be NumChildren times as small.
         int top = 0;
 
         // Create the root Node
@@ -1200,7 +1510,7 @@ namespace nes
         stack[0].m_depth = 0;
         stack[0].m_boundsMin = Vec3(math::kLargeFloat);
         stack[0].m_boundsMax = Vec3(-math::kLargeFloat);
-        Partition4(pNodeIDs, pCenters, 0, number, stack[0].m_splitIndices);
+        PartitionChildren(pNodeIDs, pCenters, 0, number, stack[0].m_splitIndices);
 
         for (;;)
         {
@@ -1210,7 +1520,7 @@ namespace nes
             ++current.m_childIndex;
 
             // Check if all children processed:
-            if (current.m_childIndex >= 4)
+            if (current.m_childIndex >= NumChildren)
             {
                 // Terminate if there's nothing left to pop
                 if (top <= 0)
@@ -1273,21 +1583,18 @@ namespace nes
                     // Allocate a new Node
                     ++top;
                     StackEntry& newStack = stack[top];
-                    NES_ASSERT(top < (kStackSize / 4));
+                    NES_ASSERT(top < (kStackSize / NumChildren));
                     const uint32 nextDepth = current.m_depth + 1;
                     newStack.m_nodeIndex = AllocateNode(maxDepthMarkChanged > nextDepth);
                     newStack.m_childIndex = -1;
                     newStack.m_depth = nextDepth;
                     newStack.m_boundsMin = Vec3(math::kLargeFloat);
                     newStack.m_boundsMax = Vec3(-math::kLargeFloat);
-                    Partition4(pNodeIDs, pCenters, low, high, newStack.m_splitIndices);
+                    PartitionChildren(pNodeIDs, pCenters, low, high, newStack.m_splitIndices);
                 }
             }
         }
 
-        // Delete the centers array
-        NES_DELETE_ARRAY(pCenters);
-
         // Store the bounding box of the Root
         outBounds.m_min = stack[0].m_boundsMin;
         outBounds.m_max = stack[0].m_boundsMax;
@@ -1296,7 +1603,8 @@ namespace nes
         return NodeID::FromNodeIndex(stack[0].m_nodeIndex);
     }
 
-    void QuadTree::Partition(NodeID* nodeIDs, Vec3* nodeCenters, int number, int& outMidPoint)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::Partition(NodeID* nodeIDs, Vec3* nodeCenters, int number, int& outMidPoint)
     {
         // Handle trivial case
         if (number <= 4)
@@ -1357,30 +1665,31 @@ namespace nes
         }
     }
 
-    void QuadTree::Partition4(NodeID* nodeIDs, Vec3* nodeCenters, const int begin, const int end, int* outSplitIndices)
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::PartitionChildren(NodeID* nodeIDs, Vec3* nodeCenters, const int begin, const int end, int* outSplitIndices)
     {
-        NodeID* subIDs = nodeIDs + begin;
-        Vec3* subCenters = nodeCenters + begin;
-        const int number = end - begin;
-
-        // Partition the entire range: 
-        Partition(subIDs, subCenters, number, outSplitIndices[2]);
+        outSplitIndices[0] = begin;
+        outSplitIndices[NumChildren] = end;
 
-        // Partition the lower half:
-        Partition(subIDs, subCenters, outSplitIndices[2], outSplitIndices[1]);
-        
-        // Partition the upper half:
-        Partition(subIDs + outSplitIndices[2], subCenters + outSplitIndices[2], number - outSplitIndices[2], outSplitIndices[3]);
+        // Split the entire range in half, then split each half in half, etc. until we have NumChildren partitions.
+        // For 4 children, this partitions [0, 4] into [0, 2] and [2, 4], then [0, 1], [1, 2], [2, 3] and [3, 4].
+        for (int step = NumChildren / 2; step > 0; step /= 2)
+        {
+            for (int i = step; i < NumChildren; i += 2 * step)
+            {
+                // Partition the range [outSplitIndices[i - step], outSplitIndices[i + step]]:
+                const int low = outSplitIndices[i - step];
+                const int high = outSplitIndices[i + step];
+                Partition(nodeIDs + low, nodeCenters + low, high - low, outSplitIndices[i]);
 
-        // Convert to proper range: [begin, end]
-        outSplitIndices[0] = begin;
-        outSplitIndices[1] += begin;
-        outSplitIndices[2] += begin;
-        outSplitIndices[3] += outSplitIndices[2];
-        outSplitIndices[4] = end;
+                // Convert to proper range: [begin, end]
+                outSplitIndices[i] += low;
+            }
+        }
     }
 
-    uint32 QuadTree::GetMaxTreeDepth(const NodeID nodeID) const
+    template <int NumChildren>
+    uint32 TAABBTree<NumChildren>::GetMaxTreeDepth(const NodeID nodeID) const
     {
         // Reached a leaf:
         if (!nodeID.IsValid() || nodeID.IsBody())
@@ -1396,8 +1705,9 @@ namespace nes
         return maxDepth + 1;
     }
 
+    template <int NumChildren>
     template <typename Visitor>
-    void QuadTree::WalkTree(const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers, Visitor& visitor) const
+    void TAABBTree<NumChildren>::WalkTree(const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers, Visitor& visitor) const
     {
         const RootNode& rootNode = GetCurrentRoot();
 
@@ -1426,7 +1736,7 @@ namespace nes
 
             else if (childNodeID.IsValid())
             {
-                if (top + 4 >= static_cast<int>(nodeStackArray.size()))
+                if (top + NumChildren >= static_cast<int>(nodeStackArray.size()))
                 {
                     QuadTreePerformanceWarning();
                     nodeStackArray.resize(static_cast<int>(nodeStackArray.size() << 1));
@@ -1436,21 +1746,36 @@ namespace nes
                 
                 const Node& node = m_pAllocator->Get(childNodeID.GetNodeIndex());
                 NES_ASSERT(math::IsAligned(&node, NES_CACHE_LINE_SIZE));
-                
-                // Load the bounds of the 4 children:
-                Vec4Reg boundsMinX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_minX)); 
-                Vec4Reg boundsMinY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_minY)); 
-                Vec4Reg boundsMinZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_minZ));
-                Vec4Reg boundsMaxX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_maxX)); 
-                Vec4Reg boundsMaxY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_maxY)); 
-                Vec4Reg boundsMaxZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_maxZ));
-
-                // Load the Child IDs.
-                UVec4Reg childIDs = UVec4Reg::LoadInt4(reinterpret_cast<const uint32*>(node.m_childNodeIDs));
-
-                const int numResults = visitor.VisitNodes(boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ, childIDs, top);
-                childIDs.StoreInt4(reinterpret_cast<uint32*>(&pNodeStack[top]));
-                top += numResults;
+
+                if constexpr (NumChildren == 8 && requires { &Visitor::VisitNodes8; })
+                {
+                    // The visitor can test all 8 children at once.
+                    const int numResults = visitor.VisitNodes8(reinterpret_cast<const float*>(node.m_minX), reinterpret_cast<const float*>(node.m_minY), reinterpret_cast<const float*>(node.m_minZ)
+                        , reinterpret_cast<const float*>(node.m_maxX), reinterpret_cast<const float*>(node.m_maxY), reinterpret_cast<const float*>(node.m_maxZ)
+                        , reinterpret_cast<const uint32*>(node.m_childNodeIDs), reinterpret_cast<uint32*>(&pNodeStack[top]), top);
+                    top += numResults;
+                }
+                else
+                {
+                    // Visit the children in groups of 4:
+                    for (int i = 0; i < NumChildren; i += 4)
+                    {
+                        // Load the bounds of the 4 children:
+                        Vec4Reg boundsMinX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minX[i])); 
+                        Vec4Reg boundsMinY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minY[i])); 
+                        Vec4Reg boundsMinZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_minZ[i]));
+                        Vec4Reg boundsMaxX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxX[i])); 
+                        Vec4Reg boundsMaxY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxY[i])); 
+                        Vec4Reg boundsMaxZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(&node.m_maxZ[i]));
+
+                        // Load the Child IDs.
+                        UVec4Reg childIDs = UVec4Reg::LoadInt4(reinterpret_cast<const uint32*>(&node.m_childNodeIDs[i]));
+
+                        const int numResults = visitor.VisitNodes(boundsMinX, boundsMinY, boundsMinZ, boundsMaxX, boundsMaxY, boundsMaxZ, childIDs, top);
+                        childIDs.StoreInt4(reinterpret_cast<uint32*>(&pNodeStack[top]));
+                        top += numResults;
+                    }
+                }
             }
 
             // Fetch the next node until we find one that the visitor wants to see.
@@ -1465,7 +1790,8 @@ namespace nes
     }
 
 #if NES_LOGGING_ENABLED
-    void QuadTree::ValidateTree(const BodyVector& bodies, const BodyTrackerArray& trackers, uint32 nodeIndex, uint32 numExpectedBodies) const
+    template <int NumChildren>
+    void TAABBTree<NumChildren>::ValidateTree(const BodyVector& bodies, const BodyTrackerArray& trackers, uint32 nodeIndex, uint32 numExpectedBodies) const
     {
         NES_ASSERT(nodeIndex != kInvalidNodeIndex);
 
@@ -1497,7 +1823,7 @@ namespace nes
             NES_ASSERT(current.m_parentNodeIndex == kInvalidNodeIndex || m_pAllocator->Get(current.m_parentNodeIndex).m_isChanged || !node.m_isChanged);
 
             // Loop childen
-            for (int i = 0; i < 4; ++i)
+            for (int i = 0; i < NumChildren; ++i)
             {
                 NodeID childNodeID = node.m_childNodeIDs[i];
                 if (childNodeID.IsValid())
@@ -1545,4 +1871,7 @@ namespace nes
         NES_ASSERT(numBodies == numExpectedBodies);
     }
 #endif
+
+    template class TAABBTree<4>;
+    template class TAABBTree<8>;
 }
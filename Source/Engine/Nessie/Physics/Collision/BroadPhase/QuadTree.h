@@ -9,16 +9,27 @@
 namespace nes
 {
     //----------------------------------------------------------------------------------------------------
-    /// @brief : Internal tree structure in the Broadphase - a Quad AABB Tree.
+    /// @brief : Internal tree structure in the Broadphase - an AABB Tree where each Node has NumChildren children.
+    ///     A width of 4 is the QuadTree. A width of 8 is the OctTree, which halves the depth of the tree and
+    ///     so the number of Nodes that are visited per query, at the cost of testing twice as many bounds per
+    ///     Node. The 8-wide Node tests are done in a single AVX register when available.
+    ///	@tparam NumChildren : Number of children per Node. Must be 4 or 8.
     //----------------------------------------------------------------------------------------------------
-    class QuadTree
+    template <int NumChildren>
+    class TAABBTree
     {
+        static_assert(NumChildren == 4 || NumChildren == 8, "Only 4 and 8 children per Node are supported!");
+
         /// Index value to denote an invalid Node. 
         static constexpr uint32     kInvalidNodeIndex = 0xffffffff;
         
         /// Maximum size of the Stack during a Tree Walk.
         static constexpr int        kStackSize = 128;
 
+        /// Number of rays that CastRays() walks the tree with at the same time. Each Node that is visited
+        /// is loaded once for all rays of the packet that hit it.
+        static constexpr int        kRayPacketSize = 16;
+
         /// Invalid Bounding Box to initialize an empty Node with.
         static const AABox          kInvalidBounds;
         
@@ -103,15 +114,15 @@ namespace nes
             
             /// The Bounding Box values for all child nodes or bodies. These are all initialized to invalid values
             /// so that no collision test will ever traverse to the leaf.
-            std::atomic<float>      m_minX[4];
-            std::atomic<float>      m_minY[4];
-            std::atomic<float>      m_minZ[4];
-            std::atomic<float>      m_maxX[4];
-            std::atomic<float>      m_maxY[4];
-            std::atomic<float>      m_maxZ[4];
+            std::atomic<float>      m_minX[NumChildren];
+            std::atomic<float>      m_minY[NumChildren];
+            std::atomic<float>      m_minZ[NumChildren];
+            std::atomic<float>      m_maxX[NumChildren];
+            std::atomic<float>      m_maxY[NumChildren];
+            std::atomic<float>      m_maxZ[NumChildren];
 
             /// Indices of Child Nodes or Body IDs.
-            AtomicNodeID            m_childNodeIDs[4];
+            AtomicNodeID            m_childNodeIDs[NumChildren];
 
             /// Index of the Parent Node.
             /// This can be unreliable during the UpdatePrepare/Finalize() functions as a Node may be
@@ -119,8 +130,9 @@ namespace nes
             std::atomic<uint32>     m_parentNodeIndex = kInvalidNodeIndex;
             std::atomic<uint32>     m_isChanged;
 
-            /// Padding to align to 124 bytes
-            uint32                  m_padding = 0;
+            /// Padding so that the Node + the free list index fills a whole number of cache lines
+            /// (124 bytes for 4 children, 252 bytes for 8 children).
+            uint32                  m_padding[NumChildren == 4? 1 : 5] {};
             
             void                    GetNodeBounds(AABox& outBounds) const;
             void                    GetChildBounds(int childIndex, AABox& outBounds) const;
@@ -136,8 +148,8 @@ namespace nes
         struct BodyTracker
         {
             static constexpr uint32             kInvalidBodyLocation = std::numeric_limits<uint32>::max();
-            static constexpr uint32             kBodyIndexMask = 0x3fffffff;
-            static constexpr uint32             kChildIndexShift = 30;
+            static constexpr uint32             kChildIndexShift = NumChildren == 4? 30 : 29; /// Upper bits store the child index in the Node.
+            static constexpr uint32             kBodyIndexMask = (1u << kChildIndexShift) - 1;
             
             std::atomic<BroadPhaseLayer::Type>  m_broadPhaseLayer = static_cast<BroadPhaseLayer::Type>(kInvalidBroadPhaseLayer);
             std::atomic<CollisionLayer>         m_collisionLayer = kInvalidCollisionLayer;
@@ -163,10 +175,10 @@ namespace nes
         using BodyTrackerArray = std::vector<BodyTracker>;
         
     public:
-        QuadTree() = default;
-        QuadTree(const QuadTree&) = delete;
-        QuadTree& operator=(const QuadTree&) = delete;
-        ~QuadTree();
+        TAABBTree() = default;
+        TAABBTree(const TAABBTree&) = delete;
+        TAABBTree& operator=(const TAABBTree&) = delete;
+        ~TAABBTree();
         
         void                    Init(Allocator& allocator);
         void                    DiscardOldTree();
@@ -186,6 +198,7 @@ namespace nes
         void                    NotifyBodiesAABBChanged(const BodyVector& bodies, const BodyTrackerArray& trackers, const BodyID* bodyIDArray, int number);
         
         void                    CastRay(const RayCast& ray, RayCastBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const;
+        void                    CastRays(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const;
         void                    CastAABox(const AABoxCast& box, CastShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const;
         void                    CollideAABox(const AABox& box, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const;
         void                    CollideSphere(const Vec3& center, const float radius, CollideShapeBodyCollector& collector, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const;
@@ -203,7 +216,7 @@ namespace nes
     private:
         //----------------------------------------------------------------------------------------------------
         /// @brief : Root Node of the Tree. The index will always point to a Node, it will never point to a body.
-        ///     The QuadTree maintains two RootNodes, meaning two trees, in order to let collision queries complete
+        ///     The tree maintains two RootNodes, meaning two trees, in order to let collision queries complete
         ///     in parallel to adding/removing Bodies/Nodes to the tree. 
         //----------------------------------------------------------------------------------------------------
         struct RootNode
@@ -237,13 +250,23 @@ namespace nes
         uint32                  AllocateNode(bool isChanged);
         bool                    TryInsertLeaf(BodyTrackerArray& trackers, int nodeIndex, NodeID leafID, const AABox& leafBounds, int numLeafBodies);
         bool                    TryCreateNewRoot(BodyTrackerArray& trackers, std::atomic<uint32>& rootNodeIndex, NodeID leafID, const AABox& leafBounds, int numLeafBodies);
-        NodeID                  BuildTree(const BodyVector& bodies, BodyTrackerArray& trackers, NodeID* pNodeIDs, int number, uint maxDepthMarkChanged, AABox& outBounds);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Build a tree from a list of bodies and nodes.
+        ///	@param pCenters : Scratch space for the centers of 'number' bodies and nodes.
+        //----------------------------------------------------------------------------------------------------
+        NodeID                  BuildTree(const BodyVector& bodies, BodyTrackerArray& trackers, NodeID* pNodeIDs, int number, uint maxDepthMarkChanged, Vec3* pCenters, AABox& outBounds);
         
         static void             Partition(NodeID* nodeIDs, Vec3* nodeCenters, int number, int& outMidPoint);
-        static void             Partition4(NodeID* nodeIDs, Vec3* nodeCenters, int begin, int end, int* outSplitIndices);
+        static void             PartitionChildren(NodeID* nodeIDs, Vec3* nodeCenters, int begin, int end, int* outSplitIndices);
         
         uint32                  GetMaxTreeDepth(const NodeID nodeID) const;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Walk the tree with a packet of up to kRayPacketSize rays, see CastRays().
+        //----------------------------------------------------------------------------------------------------
+        void                    CastRayPacket(const RayCast* pRays, RayCastBodyCollector* const* pCollectors, const int numRays, const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers) const;
+
         template <typename Visitor>
         NES_INLINE void         WalkTree(const CollisionLayerFilter& layerFilter, const BodyTrackerArray& trackers, Visitor& visitor) const;
 
@@ -274,7 +297,18 @@ namespace nes
         /// Flag to keep track of changes to the broadphase. If False, we don't need to UpdatePrepare/Finalize().
         std::atomic<bool>       m_isDirty = false;
 
+        /// Node IDs and centers that UpdatePrepare() builds the new tree from. Only one update runs at a time,
+        /// so they are kept to prevent allocations.
+        std::vector<NodeID>     m_updateNodeIDs;
+        std::vector<Vec3>       m_updateCenters;
+
         // [TODO]: Stats:
         //struct Stats{};
     };
+
+    /// AABB Tree with 4 children per Node.
+    using QuadTree = TAABBTree<4>;
+
+    /// AABB Tree with 8 children per Node.
+    using OctTree = TAABBTree<8>;
 }
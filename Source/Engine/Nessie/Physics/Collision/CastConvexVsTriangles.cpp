@@ -0,0 +1,96 @@
+// CastConvexVsTriangles.cpp
+#include "CastConvexVsTriangles.h"
+
+#include "Nessie/Geometry/ConvexSupport.h"
+#include "Nessie/Geometry/EPAPenetrationDepth.h"
+#include "Nessie/Physics/Collision/ActiveEdges.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+
+namespace nes
+{
+    CastConvexVsTriangles::CastConvexVsTriangles(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings,
+        const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, CastShapeCollector& collector)
+        : m_shapeCast(shapeCast)
+        , m_shapeCastSettings(shapeCastSettings)
+        , m_centerOfMassTransform2(centerOfMassTransform2)
+        , m_subShapeID1(subShapeIDCreator1.GetID())
+        , m_collector(collector)
+    {
+        NES_ASSERT(shapeCast.m_pShape->GetType() == EShapeType::Convex);
+    }
+
+    void CastConvexVsTriangles::Cast(const Vec3& v0, const Vec3& v1, const Vec3& v2, const uint8 activeEdges, const SubShapeID& subShapeID2)
+    {
+        // The triangle is back facing when we are moving in the direction of its normal.
+        const Vec3 triangleNormal = (v1 - v0).Cross(v2 - v0);
+        const bool isBackFacing = triangleNormal.Dot(m_shapeCast.m_direction) > 0.f;
+        if (m_shapeCastSettings.m_backfaceModeTriangles == EBackFaceMode::IgnoreBackFaces && isBackFacing)
+            return;
+
+        // Create the support function of the cast shape on first use
+        if (m_pSupport == nullptr)
+        {
+            const ConvexShape* pCastShape = checked_cast<const ConvexShape*>(m_shapeCast.m_pShape);
+            const ConvexShape::ESupportMode supportMode = m_shapeCastSettings.m_useShrunkenShapeAndConvexRadius? ConvexShape::ESupportMode::ExcludeConvexRadius : ConvexShape::ESupportMode::Default;
+            m_pSupport = pCastShape->GetSupportFunction(supportMode, m_supportBuffer, m_shapeCast.m_scale);
+        }
+
+        // Do a raycast of the shape against the triangle
+        const TriangleConvexSupport triangle(v0, v1, v2);
+        EPAPenetrationDepth epa;
+        float fraction = m_collector.GetEarlyOutFraction();
+        Vec3 contactPointA;
+        Vec3 contactPointB;
+        Vec3 contactNormal;
+        if (!epa.CastShape(
+            m_shapeCast.m_centerOfMassStart
+            , m_shapeCast.m_direction
+            , m_shapeCastSettings.m_collisionTolerance
+            , m_shapeCastSettings.m_penetrationTolerance
+            , *m_pSupport, triangle
+            , m_pSupport->GetConvexRadius(), 0.f
+            , m_shapeCastSettings.m_returnDeepestPoint
+            , fraction
+            , contactPointA, contactPointB, contactNormal))
+        {
+            return;
+        }
+
+        // Replace the contact normal with the triangle normal when hitting an inactive edge.
+        if (m_shapeCastSettings.m_activeEdgeMode == EActiveEdgeMode::CollideOnlyWithActive && activeEdges != 0b111)
+        {
+            const Vec3 movementDirection = m_centerOfMassTransform2.Multiply3x3Transposed(m_shapeCastSettings.m_activeEdgeMovementDirection) + m_shapeCast.m_direction;
+            contactNormal = ActiveEdges::FixNormal(v0, v1, v2, isBackFacing? triangleNormal : -triangleNormal, activeEdges, contactPointB, contactNormal, movementDirection);
+        }
+
+        // Convert to world space
+        const Vec3 contactPointAWorld = m_centerOfMassTransform2.TransformPoint(contactPointA);
+        const Vec3 contactPointBWorld = m_centerOfMassTransform2.TransformPoint(contactPointB);
+        const Vec3 contactNormalWorld = m_centerOfMassTransform2.TransformVector(contactNormal);
+
+        ShapeCastResult result(fraction, contactPointAWorld, contactPointBWorld, contactNormalWorld, isBackFacing, m_subShapeID1, subShapeID2, TransformedShape::GetBodyID(m_collector.GetContext()));
+
+        // Early out if this hit is deeper than the collector's early out value
+        if (fraction == 0.f && -result.m_penetrationDepth >= m_collector.GetEarlyOutFraction())
+            return;
+
+        // Gather faces
+        if (m_shapeCastSettings.m_collectFacesMode == ECollectFacesMode::CollectFaces)
+        {
+            // Get the supporting face of the cast shape
+            const ConvexShape* pCastShape = checked_cast<const ConvexShape*>(m_shapeCast.m_pShape);
+            Mat44 transform1To2 = m_shapeCast.m_centerOfMassStart;
+            transform1To2.SetTranslation(transform1To2.GetTranslation() + fraction * m_shapeCast.m_direction);
+            pCastShape->GetSupportingFace(SubShapeID(), transform1To2.Multiply3x3Transposed(-contactNormal), m_shapeCast.m_scale, m_centerOfMassTransform2 * transform1To2, result.m_shape1Face);
+
+            // The supporting face of shape 2 is the triangle
+            result.m_shape2Face.resize(3);
+            result.m_shape2Face[0] = m_centerOfMassTransform2.TransformPoint(v0);
+            result.m_shape2Face[1] = m_centerOfMassTransform2.TransformPoint(v1);
+            result.m_shape2Face[2] = m_centerOfMassTransform2.TransformPoint(v2);
+        }
+
+        // [TODO]: Narrow Phase tracking
+        m_collector.AddHit(result);
+    }
+}
@@ -0,0 +1,45 @@
+// CastConvexVsTriangles.h
+#pragma once
+#include "ShapeCast.h"
+#include "Shapes/ConvexShape.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Collision detection helper that casts a convex object against triangles. Shapes made of
+    ///     triangles, like the MeshShape, create one of these and call Cast() for each triangle that the
+    ///     swept bounds of the convex object overlap.
+    /// @note : The shape cast and the triangle vertices are in the space of shape 2, with the scale of
+    ///     shape 2 applied to the triangles.
+    //----------------------------------------------------------------------------------------------------
+    class CastConvexVsTriangles
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        ///	@param shapeCast : The shape cast, in the space of shape 2. The cast shape must be convex.
+        ///	@param shapeCastSettings : Settings for the cast.
+        ///	@param centerOfMassTransform2 : Transform of the center of mass of shape 2 (world space).
+        ///	@param subShapeIDCreator1 : Sub shape ID creator of the cast shape.
+        ///	@param collector : Receives the hits.
+        //----------------------------------------------------------------------------------------------------
+        CastConvexVsTriangles(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, CastShapeCollector& collector);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Cast the shape against a triangle.
+        ///	@param v0, v1, v2 : Vertices of the triangle in the space of shape 2, with scale 2 applied.
+        ///     Counter-clockwise when seen from the front.
+        ///	@param activeEdges : Bit 'i' is set when the edge from vertex 'i' to vertex 'i + 1' is active.
+        ///	@param subShapeID2 : Sub shape ID of the triangle.
+        //----------------------------------------------------------------------------------------------------
+        void                            Cast(const Vec3& v0, const Vec3& v1, const Vec3& v2, const uint8 activeEdges, const SubShapeID& subShapeID2);
+
+    private:
+        const ShapeCast&                m_shapeCast;
+        const ShapeCastSettings&        m_shapeCastSettings;
+        const Mat44&                    m_centerOfMassTransform2;
+        SubShapeID                      m_subShapeID1;
+        CastShapeCollector&             m_collector;
+        ConvexShape::SupportBuffer      m_supportBuffer;
+        const ConvexShape::Support*     m_pSupport = nullptr; /// Created on the first call to Cast().
+    };
+}
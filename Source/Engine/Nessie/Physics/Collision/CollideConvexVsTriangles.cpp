@@ -0,0 +1,143 @@
+// CollideConvexVsTriangles.cpp
+#include "CollideConvexVsTriangles.h"
+
+#include "Nessie/Geometry/ConvexSupport.h"
+#include "Nessie/Geometry/EPAPenetrationDepth.h"
+#include "Nessie/Physics/Collision/ActiveEdges.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+
+namespace nes
+{
+    CollideConvexVsTriangles::CollideConvexVsTriangles(const ConvexShape* pShape1, const Vec3& scale1, const Vec3& scale2,
+        const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeID& subShapeID1,
+        const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector)
+        : m_collideShapeSettings(collideShapeSettings)
+        , m_collector(collector)
+        , m_pShape1(pShape1)
+        , m_scale1(scale1)
+        , m_transform1(centerOfMassTransform1)
+        , m_subShapeID1(subShapeID1)
+        , m_maxSeparationDistance(collideShapeSettings.m_maxSeparationDistance)
+    {
+        // Triangles are collided in the space of shape 1
+        m_transform2To1 = centerOfMassTransform1.InversedRotationTranslation() * centerOfMassTransform2;
+
+        // Get the bounds of shape 1, in its own space and in the space of shape 2
+        m_boundsOf1 = pShape1->GetLocalBounds().Scaled(scale1);
+        m_boundsOf1.ExpandBy(Vec3::Replicate(m_maxSeparationDistance));
+        m_boundsOf1InSpaceOf2 = m_boundsOf1.Transformed(m_transform2To1.InversedRotationTranslation());
+
+        // [Note]: The winding order of the triangles is flipped by the caller when scale 2 is inside out.
+        (void)scale2;
+    }
+
+    void CollideConvexVsTriangles::Collide(const Vec3& v0, const Vec3& v1, const Vec3& v2, const uint8 activeEdges, const SubShapeID& subShapeID2)
+    {
+        // Transform the triangle into the space of shape 1
+        const Vec3 p0 = m_transform2To1.TransformPoint(v0);
+        const Vec3 p1 = m_transform2To1.TransformPoint(v1);
+        const Vec3 p2 = m_transform2To1.TransformPoint(v2);
+
+        // The center of mass of shape 1 is at the origin. When it is behind the triangle, the triangle is back facing.
+        const Vec3 triangleNormal = (p1 - p0).Cross(p2 - p0);
+        const bool isBackFacing = triangleNormal.Dot(p0) > 0.f;
+        if (m_collideShapeSettings.m_backFaceMode == EBackFaceMode::IgnoreBackFaces && isBackFacing)
+            return;
+
+        // Check if the triangle overlaps the bounds of shape 1
+        AABox triangleBounds(Vec3::Min(Vec3::Min(p0, p1), p2), Vec3::Max(Vec3::Max(p0, p1), p2));
+        if (!triangleBounds.Overlaps(m_boundsOf1))
+            return;
+
+        // Create the support function of shape 1 on first use
+        if (m_pShape1ExclConvexRadius == nullptr)
+            m_pShape1ExclConvexRadius = m_pShape1->GetSupportFunction(ConvexShape::ESupportMode::ExcludeConvexRadius, m_bufferExclConvexRadius, m_scale1);
+
+        // Start with the axis from the center of mass of shape 1 to the triangle
+        Vec3 penetrationAxis = (p0 + p1 + p2) / 3.f;
+        if (penetrationAxis.IsNearZero())
+            penetrationAxis = Vec3::Right();
+
+        const TriangleConvexSupport triangle(p0, p1, p2);
+        float maxSeparationDistance = m_maxSeparationDistance;
+        Vec3 point1;
+        Vec3 point2;
+        EPAPenetrationDepth penDepth;
+        const EPAPenetrationDepth::EStatus status = penDepth.GetPenetrationDepthStepGJK(
+            *m_pShape1ExclConvexRadius
+            , m_pShape1ExclConvexRadius->GetConvexRadius() + maxSeparationDistance
+            , triangle, 0.f
+            , m_collideShapeSettings.m_collisionTolerance
+            , penetrationAxis
+            , point1
+            , point2);
+
+        switch (status)
+        {
+            case EPAPenetrationDepth::EStatus::Colliding:
+                break;
+
+            case EPAPenetrationDepth::EStatus::NotColliding:
+                return;
+
+            case EPAPenetrationDepth::EStatus::Indeterminate:
+            {
+                // Need to run the expensive EPA algorithm.
+                // See ConvexShape::CollideConvexVsConvex() for why the separation distance is clamped.
+                maxSeparationDistance = math::Min(maxSeparationDistance, 1.0f);
+
+                ConvexShape::SupportBuffer bufferInclConvexRadius;
+                const ConvexShape::Support* pShape1InclConvexRadius = m_pShape1->GetSupportFunction(ConvexShape::ESupportMode::IncludeConvexRadius, bufferInclConvexRadius, m_scale1);
+                AddConvexRadius shape1AddMaxSeparationDistance(*pShape1InclConvexRadius, maxSeparationDistance);
+
+                if (!penDepth.GetPenetrationDepthStepEPA(
+                    shape1AddMaxSeparationDistance
+                    , triangle
+                    , m_collideShapeSettings.m_penetrationTolerance
+                    , penetrationAxis
+                    , point1
+                    , point2))
+                {
+                    return;
+                }
+                break;
+            }
+        }
+
+        // Check if the penetration is bigger than the early out fraction
+        const float penetrationDepth = (point2 - point1).Length() - maxSeparationDistance;
+        if (-penetrationDepth >= m_collector.GetEarlyOutFraction())
+            return;
+
+        // Correct point1 for the added separation distance
+        const float penetrationAxisLength = penetrationAxis.Length();
+        if (penetrationAxisLength > 0.f)
+            point1 -= penetrationAxis * (maxSeparationDistance / penetrationAxisLength);
+
+        // Replace the penetration axis with the triangle normal when hitting an inactive edge.
+        if (m_collideShapeSettings.m_activeEdgeMode == EActiveEdgeMode::CollideOnlyWithActive && activeEdges != 0b111)
+        {
+            const Vec3 movementDirection = m_transform1.Multiply3x3Transposed(m_collideShapeSettings.m_activeEdgeMovementDirection);
+            penetrationAxis = ActiveEdges::FixNormal(p0, p1, p2, isBackFacing? triangleNormal : -triangleNormal, activeEdges, point2, penetrationAxis, movementDirection);
+        }
+
+        // Convert to world space
+        CollideShapeResult result(m_transform1.TransformPoint(point1), m_transform1.TransformPoint(point2), m_transform1.TransformVector(penetrationAxis), penetrationDepth, m_subShapeID1, subShapeID2, TransformedShape::GetBodyID(m_collector.GetContext()));
+
+        // Gather faces
+        if (m_collideShapeSettings.m_collectFacesMode == ECollectFacesMode::CollectFaces)
+        {
+            // Set the supporting face of shape 1
+            m_pShape1->GetSupportingFace(SubShapeID(), -penetrationAxis, m_scale1, m_transform1, result.m_shape1Face);
+
+            // Set the supporting face of shape 2, which is the triangle
+            result.m_shape2Face.resize(3);
+            result.m_shape2Face[0] = m_transform1.TransformPoint(p0);
+            result.m_shape2Face[1] = m_transform1.TransformPoint(p1);
+            result.m_shape2Face[2] = m_transform1.TransformPoint(p2);
+        }
+
+        // [TODO]: NarrowPhase Tracking
+        m_collector.AddHit(result);
+    }
+}
@@ -0,0 +1,58 @@
+// CollideConvexVsTriangles.h
+#pragma once
+#include "CollideShape.h"
+#include "Shapes/ConvexShape.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Collision detection helper that collides a convex object (shape 1) with triangles
+    ///     (shape 2). Shapes made of triangles, like the MeshShape, create one of these and call Collide()
+    ///     for each triangle that overlaps the bounds of the convex object.
+    /// @note : The triangle vertices are passed in the space of shape 2, scaled by the scale of shape 2.
+    //----------------------------------------------------------------------------------------------------
+    class CollideConvexVsTriangles
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        ///	@param pShape1 : The convex shape to collide against the triangles.
+        ///	@param scale1 : Local space scale of shape 1.
+        ///	@param scale2 : Local space scale of the shape that the triangles belong to.
+        ///	@param centerOfMassTransform1 : Transform of the center of mass of shape 1 (world space).
+        ///	@param centerOfMassTransform2 : Transform of the center of mass of shape 2 (world space).
+        ///	@param subShapeID1 : Sub shape ID of shape 1.
+        ///	@param collideShapeSettings : Settings for the collision query.
+        ///	@param collector : Receives the hits.
+        //----------------------------------------------------------------------------------------------------
+        CollideConvexVsTriangles(const ConvexShape* pShape1, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeID& subShapeID1, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Collide shape 1 with a triangle.
+        ///	@param v0, v1, v2 : Vertices of the triangle in the space of shape 2, with scale 2 applied.
+        ///     Counter-clockwise when seen from the front.
+        ///	@param activeEdges : Bit 'i' is set when the edge from vertex 'i' to vertex 'i + 1' is active.
+        ///	@param subShapeID2 : Sub shape ID of the triangle.
+        //----------------------------------------------------------------------------------------------------
+        void                            Collide(const Vec3& v0, const Vec3& v1, const Vec3& v2, const uint8 activeEdges, const SubShapeID& subShapeID2);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the bounds of shape 1 (including the max separation distance) in the space of shape 2,
+        ///     with scale 2 applied. Triangles outside these bounds cannot collide.
+        //----------------------------------------------------------------------------------------------------
+        const AABox&                    GetBoundsOf1InSpaceOf2() const { return m_boundsOf1InSpaceOf2; }
+
+    private:
+        const CollideShapeSettings&     m_collideShapeSettings;
+        CollideShapeCollector&          m_collector;
+        const ConvexShape*              m_pShape1;
+        Vec3                            m_scale1;
+        Mat44                           m_transform1;
+        Mat44                           m_transform2To1;
+        SubShapeID                      m_subShapeID1;
+        AABox                           m_boundsOf1;
+        AABox                           m_boundsOf1InSpaceOf2;
+        float                           m_maxSeparationDistance;
+        ConvexShape::SupportBuffer      m_bufferExclConvexRadius;
+        const ConvexShape::Support*     m_pShape1ExclConvexRadius = nullptr; /// Created on the first call to Collide().
+    };
+}
@@ -0,0 +1,261 @@
+// DeferredContactListener.cpp
+#include "DeferredContactListener.h"
+
+#include <limits>
+#include "Nessie/Core/QuickSort.h"
+#include "Nessie/Physics/Body/Body.h"
+
+namespace nes
+{
+    namespace internal
+    {
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Buffer that the current thread last wrote to, and the listener and generation of buffers
+        ///     that it belongs to.
+        //----------------------------------------------------------------------------------------------------
+        struct ThreadBufferCache
+        {
+            uint64  m_listenerID = 0;
+            uint32  m_generation = 0;
+            void*   m_pBuffer = nullptr;
+        };
+
+        static thread_local ThreadBufferCache s_threadBufferCache;
+        static std::atomic<uint64> s_nextListenerID = 1;
+    }
+
+    DeferredContactListener::DeferredContactListener(ContactListener* pValidateListener)
+        : m_pValidateListener(pValidateListener)
+        , m_id(internal::s_nextListenerID.fetch_add(1, std::memory_order_relaxed))
+    {
+        //
+    }
+
+    EValidateContactResult DeferredContactListener::OnContactValidate(const Body& body1, const Body& body2, const RVec3 baseOffset, const CollideShapeResult& collisionResult)
+    {
+        // Filtering needs to happen inline, it affects the simulation.
+        if (m_pValidateListener != nullptr)
+            return m_pValidateListener->OnContactValidate(body1, body2, baseOffset, collisionResult);
+
+        return EValidateContactResult::AcceptAllContactsForThisBodyPair;
+    }
+
+    void DeferredContactListener::OnContactAdded(const Body& body1, const Body& body2, const ContactManifold& manifold, ContactSettings& ioSettings)
+    {
+        const ContactEvent event = CreateEvent(body1, body2, manifold, ioSettings);
+        if (ThreadBuffer* pBuffer = GetThreadBuffer())
+        {
+            pBuffer->m_added.push_back(event);
+        }
+        else
+        {
+            std::lock_guard lock(m_overflowMutex);
+            m_overflowBuffer.m_added.push_back(event);
+        }
+    }
+
+    void DeferredContactListener::OnContactPersisted(const Body& body1, const Body& body2, const ContactManifold& manifold, ContactSettings& ioSettings)
+    {
+        const ContactEvent event = CreateEvent(body1, body2, manifold, ioSettings);
+        if (ThreadBuffer* pBuffer = GetThreadBuffer())
+        {
+            pBuffer->m_persisted.push_back(event);
+        }
+        else
+        {
+            std::lock_guard lock(m_overflowMutex);
+            m_overflowBuffer.m_persisted.push_back(event);
+        }
+    }
+
+    void DeferredContactListener::OnContactRemoved(const SubShapeIDPair& subShapePair)
+    {
+        // The removed callbacks are made by a single job at the end of the step. Contacts that are added or
+        // persisted after it belong to the next step, see GetAddedOrPersistedStep().
+        const uint32 step = m_step.load(std::memory_order_relaxed);
+        m_lastRemovedStep.store(step, std::memory_order_relaxed);
+
+        const RemovedEvent event { subShapePair, step, m_nextSequence.fetch_add(1, std::memory_order_relaxed) };
+        if (ThreadBuffer* pBuffer = GetThreadBuffer())
+        {
+            pBuffer->m_removed.push_back(event);
+        }
+        else
+        {
+            std::lock_guard lock(m_overflowMutex);
+            m_overflowBuffer.m_removed.push_back(event);
+        }
+    }
+
+    void DeferredContactListener::DeliverEvents(ContactEventHandler& handler)
+    {
+        // Merge the buffers of all threads.
+        const uint32 numThreadBuffers = math::Min(m_numThreadBuffers.load(std::memory_order_acquire), kMaxThreadBuffers);
+        for (uint32 i = 0; i <= numThreadBuffers; ++i)
+        {
+            const ThreadBuffer& buffer = i < numThreadBuffers? m_threadBuffers[i] : m_overflowBuffer;
+            m_mergedAdded.insert(m_mergedAdded.end(), buffer.m_added.begin(), buffer.m_added.end());
+            m_mergedPersisted.insert(m_mergedPersisted.end(), buffer.m_persisted.begin(), buffer.m_persisted.end());
+            m_mergedRemoved.insert(m_mergedRemoved.end(), buffer.m_removed.begin(), buffer.m_removed.end());
+        }
+        ReleaseThreadBuffers();
+
+        // Sort the events by step, so that the order doesn't depend on which thread found the contact. Events of the
+        // same SubShapeIDPair in the same step (for example a CCD contact and a discrete contact) keep the order
+        // in which they were recorded.
+        const auto compareEvents = [](const auto& left, const auto& right)
+        {
+            if (left.m_step != right.m_step)
+                return left.m_step < right.m_step;
+            if (left.m_subShapePair != right.m_subShapePair)
+                return left.m_subShapePair < right.m_subShapePair;
+            return left.m_sequence < right.m_sequence;
+        };
+        QuickSort(m_mergedAdded.begin(), m_mergedAdded.end(), compareEvents);
+        QuickSort(m_mergedPersisted.begin(), m_mergedPersisted.end(), compareEvents);
+        QuickSort(m_mergedRemoved.begin(), m_mergedRemoved.end(), compareEvents);
+
+        m_removedPairs.resize(m_mergedRemoved.size());
+        for (size_t i = 0; i < m_mergedRemoved.size(); ++i)
+            m_removedPairs[i] = m_mergedRemoved[i].m_subShapePair;
+
+        // Deliver the events step by step, so that a contact that is removed in one step and added in the next
+        // is reported in that order.
+        size_t addedIndex = 0, persistedIndex = 0, removedIndex = 0;
+        while (addedIndex < m_mergedAdded.size() || persistedIndex < m_mergedPersisted.size() || removedIndex < m_mergedRemoved.size())
+        {
+            uint32 step = std::numeric_limits<uint32>::max();
+            if (addedIndex < m_mergedAdded.size())
+                step = math::Min(step, m_mergedAdded[addedIndex].m_step);
+            if (persistedIndex < m_mergedPersisted.size())
+                step = math::Min(step, m_mergedPersisted[persistedIndex].m_step);
+            if (removedIndex < m_mergedRemoved.size())
+                step = math::Min(step, m_mergedRemoved[removedIndex].m_step);
+
+            size_t addedEnd = addedIndex;
+            while (addedEnd < m_mergedAdded.size() && m_mergedAdded[addedEnd].m_step == step)
+                ++addedEnd;
+            size_t persistedEnd = persistedIndex;
+            while (persistedEnd < m_mergedPersisted.size() && m_mergedPersisted[persistedEnd].m_step == step)
+                ++persistedEnd;
+            size_t removedEnd = removedIndex;
+            while (removedEnd < m_mergedRemoved.size() && m_mergedRemoved[removedEnd].m_step == step)
+                ++removedEnd;
+
+            if (addedEnd > addedIndex)
+                handler.OnContactsAdded(std::span<const ContactEvent>(m_mergedAdded.data() + addedIndex, addedEnd - addedIndex));
+            if (persistedEnd > persistedIndex)
+                handler.OnContactsPersisted(std::span<const ContactEvent>(m_mergedPersisted.data() + persistedIndex, persistedEnd - persistedIndex));
+            if (removedEnd > removedIndex)
+                handler.OnContactsRemoved(std::span<const SubShapeIDPair>(m_removedPairs.data() + removedIndex, removedEnd - removedIndex));
+
+            addedIndex = addedEnd;
+            persistedIndex = persistedEnd;
+            removedIndex = removedEnd;
+        }
+
+        m_mergedAdded.clear();
+        m_mergedPersisted.clear();
+        m_mergedRemoved.clear();
+        m_removedPairs.clear();
+    }
+
+    void DeferredContactListener::ClearEvents()
+    {
+        ReleaseThreadBuffers();
+    }
+
+    void DeferredContactListener::ReleaseThreadBuffers()
+    {
+        const uint32 numThreadBuffers = math::Min(m_numThreadBuffers.load(std::memory_order_acquire), kMaxThreadBuffers);
+        for (uint32 i = 0; i <= numThreadBuffers; ++i)
+        {
+            // Keep the memory of the buffers for the next update.
+            ThreadBuffer& buffer = i < numThreadBuffers? m_threadBuffers[i] : m_overflowBuffer;
+            buffer.m_owner.store(std::thread::id(), std::memory_order_relaxed);
+            buffer.m_added.clear();
+            buffer.m_persisted.clear();
+            buffer.m_removed.clear();
+        }
+
+        // Threads that still cache a buffer of the previous generation will look it up again. This is not called
+        // during an update, so no thread is writing to the buffers.
+        m_numThreadBuffers.store(0, std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    DeferredContactListener::ThreadBuffer* DeferredContactListener::GetThreadBuffer()
+    {
+        // Fast path, this thread wrote to this listener last, after the buffers were last released.
+        internal::ThreadBufferCache& cache = internal::s_threadBufferCache;
+        const uint32 generation = m_generation.load(std::memory_order_acquire);
+        if (cache.m_listenerID == m_id && cache.m_generation == generation)
+            return static_cast<ThreadBuffer*>(cache.m_pBuffer);
+
+        // Look for a buffer that this thread already claimed.
+        const std::thread::id threadID = std::this_thread::get_id();
+        const uint32 numThreadBuffers = math::Min(m_numThreadBuffers.load(std::memory_order_acquire), kMaxThreadBuffers);
+        ThreadBuffer* pBuffer = nullptr;
+        for (uint32 i = 0; i < numThreadBuffers; ++i)
+        {
+            if (m_threadBuffers[i].m_owner.load(std::memory_order_relaxed) == threadID)
+            {
+                pBuffer = &m_threadBuffers[i];
+                break;
+            }
+        }
+
+        // Claim a new buffer.
+        if (pBuffer == nullptr)
+        {
+            // If all buffers are taken, the cache remembers that this thread uses the overflow buffer.
+            const uint32 index = m_numThreadBuffers.fetch_add(1, std::memory_order_acq_rel);
+            if (index < kMaxThreadBuffers)
+            {
+                pBuffer = &m_threadBuffers[index];
+                pBuffer->m_owner.store(threadID, std::memory_order_relaxed);
+            }
+        }
+
+        cache.m_listenerID = m_id;
+        cache.m_generation = generation;
+        cache.m_pBuffer = pBuffer;
+        return pBuffer;
+    }
+
+    uint32 DeferredContactListener::GetAddedOrPersistedStep()
+    {
+        // The removed callbacks of a step happen before all collision jobs of the next step, so the first thread that
+        // sees them starts the next step. If another thread was first, the exchange loads the step that it started.
+        uint32 step = m_step.load(std::memory_order_relaxed);
+        if (m_lastRemovedStep.load(std::memory_order_relaxed) == step && m_step.compare_exchange_strong(step, step + 1, std::memory_order_relaxed))
+            ++step;
+        return step;
+    }
+
+    ContactEvent DeferredContactListener::CreateEvent(const Body& body1, const Body& body2, const ContactManifold& manifold, const ContactSettings& settings)
+    {
+        ContactEvent event;
+        event.m_subShapePair = SubShapeIDPair(body1.GetID(), manifold.m_subShapeID1, body2.GetID(), manifold.m_subShapeID2);
+        event.m_step = GetAddedOrPersistedStep();
+        event.m_sequence = m_nextSequence.fetch_add(1, std::memory_order_relaxed);
+        event.m_worldSpaceNormal = manifold.m_worldSpaceNormal;
+        event.m_penetrationDepth = manifold.m_penetrationDepth;
+        event.m_numContactPoints = static_cast<uint32>(manifold.m_relativeContactPointsOn2.size());
+        event.m_isSensor = settings.m_isSensor;
+
+        // Average the contact points.
+        Vec3 relativePosition = Vec3::Zero();
+        for (const Vec3& point : manifold.m_relativeContactPointsOn2)
+            relativePosition += point;
+        if (event.m_numContactPoints > 0)
+            relativePosition /= static_cast<float>(event.m_numContactPoints);
+        event.m_position = manifold.m_baseOffset + relativePosition;
+
+        // The velocities are solved after this callback, so this is the only time the impact speed is known.
+        // The normal points from Body 1 to Body 2, so the speed is positive when the Bodies move toward each other.
+        const Vec3 relativeVelocity = body1.GetPointVelocity(event.m_position) - body2.GetPointVelocity(event.m_position);
+        event.m_normalSpeed = relativeVelocity.Dot(manifold.m_worldSpaceNormal);
+        return event;
+    }
+}
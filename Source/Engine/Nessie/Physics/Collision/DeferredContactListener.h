@@ -0,0 +1,181 @@
+// DeferredContactListener.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <span>
+#include <thread>
+#include <vector>
+#include "ContactListener.h"
+#include "Nessie/Core/Thread/Mutex.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Compact description of a contact that was added or persisted during a PhysicsScene::Update.
+    //----------------------------------------------------------------------------------------------------
+    struct ContactEvent
+    {
+        SubShapeIDPair      m_subShapePair;                     /// Bodies and sub shapes in contact. Body 1 ID < Body 2 ID, see ContactListener::OnContactAdded.
+        RVec3               m_position;                         /// Average world space position of the contact points on Body 2.
+        Vec3                m_worldSpaceNormal;                 /// Direction along which to move Body 2 out of collision.
+        float               m_penetrationDepth;                 /// Penetration depth of the manifold. Negative for speculative contacts.
+        float               m_normalSpeed;                      /// Speed at which the Bodies approach each other along the normal at m_position, before the contact was solved. Can be used for impact sounds.
+        uint32              m_numContactPoints;                 /// Number of contact points in the manifold.
+        bool                m_isSensor;                         /// If the contact is treated as a sensor contact.
+        uint32              m_step;                             /// Step of the simulation in which the event was recorded, see DeferredContactListener.
+        uint64              m_sequence;                         /// Order in which the event was recorded, used to order events of the same SubShapeIDPair within a step.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Receives the contact events recorded by a DeferredContactListener. Unlike ContactListener,
+    ///     this is called on the thread that calls DeferredContactListener::DeliverEvents(), after the
+    ///     PhysicsScene::Update, so the locking body interfaces can be used.
+    //----------------------------------------------------------------------------------------------------
+    class ContactEventHandler
+    {
+    public:
+        virtual                 ~ContactEventHandler() = default;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Called with the contacts that were added in a step, sorted by SubShapeIDPair. Events of the
+        ///     same SubShapeIDPair are in the order in which they were recorded.
+        //----------------------------------------------------------------------------------------------------
+        virtual void            OnContactsAdded([[maybe_unused]] std::span<const ContactEvent> events) { /* Do nothing. */ }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Called with the contacts that persisted in a step, sorted by SubShapeIDPair. Events of the
+        ///     same SubShapeIDPair are in the order in which they were recorded.
+        //----------------------------------------------------------------------------------------------------
+        virtual void            OnContactsPersisted([[maybe_unused]] std::span<const ContactEvent> events) { /* Do nothing. */ }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Called with the contacts that were removed in a step, sorted. The Bodies may not exist anymore,
+        ///     see ContactListener::OnContactRemoved.
+        //----------------------------------------------------------------------------------------------------
+        virtual void            OnContactsRemoved([[maybe_unused]] std::span<const SubShapeIDPair> subShapePairs) { /* Do nothing. */ }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A ContactListener that doesn't do any work in the callbacks of the simulation. Instead, the
+    ///     added, persisted and removed contacts are written to per thread buffers and are delivered to
+    ///     a ContactEventHandler by calling DeliverEvents() after PhysicsScene::Update has returned.
+    ///     The events are sorted, so the order doesn't depend on how the jobs were scheduled.
+    ///
+    ///     The events are delivered step by step: the added, persisted and removed contacts of one step, then
+    ///     those of the next step. This keeps a contact that is removed in one collision step and added again
+    ///     in the next in that order. The listener doesn't know the step index of the simulation, so it starts
+    ///     a new step when a contact is added or persisted after the contact removed callbacks of the previous
+    ///     step. Steps without removed contacts are merged with the next step, which doesn't change the order
+    ///     of the events of a SubShapeIDPair.
+    ///
+    ///     OnContactValidate is still called inline, on an optional listener that is passed to the constructor,
+    ///     so that contacts can be rejected. Because the events are delivered after the simulation, the
+    ///     ContactSettings cannot be modified. If you need that, use a regular ContactListener instead.
+    ///
+    ///     Register it with PhysicsScene::SetContactListener.
+    //----------------------------------------------------------------------------------------------------
+    class DeferredContactListener final : public ContactListener
+    {
+    public:
+        /// Maximum number of threads that can report contacts between two deliveries. Threads beyond this share a
+        /// locked buffer.
+        static constexpr uint32 kMaxThreadBuffers = 64;
+
+    public:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Constructor.
+        ///	@param pValidateListener : Optional listener that OnContactValidate is forwarded to. None of the
+        ///     other callbacks are called on it.
+        //----------------------------------------------------------------------------------------------------
+        explicit DeferredContactListener(ContactListener* pValidateListener = nullptr);
+
+        DeferredContactListener(const DeferredContactListener&) = delete;
+        DeferredContactListener& operator=(const DeferredContactListener&) = delete;
+
+        virtual EValidateContactResult OnContactValidate(const Body& body1, const Body& body2, const RVec3 baseOffset, const CollideShapeResult& collisionResult) override;
+        virtual void            OnContactAdded(const Body& body1, const Body& body2, const ContactManifold& manifold, ContactSettings& ioSettings) override;
+        virtual void            OnContactPersisted(const Body& body1, const Body& body2, const ContactManifold& manifold, ContactSettings& ioSettings) override;
+        virtual void            OnContactRemoved(const SubShapeIDPair& subShapePair) override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Merge the events recorded by all threads, sort them and pass them to the handler. The
+        ///     recorded events are cleared afterward. Must not be called during PhysicsScene::Update.
+        //----------------------------------------------------------------------------------------------------
+        void                    DeliverEvents(ContactEventHandler& handler);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Discard all recorded events without delivering them. Must not be called during
+        ///     PhysicsScene::Update.
+        //----------------------------------------------------------------------------------------------------
+        void                    ClearEvents();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of threads that recorded events since the last DeliverEvents() or ClearEvents(),
+        ///     including the threads that had to use the locked overflow buffer.
+        //----------------------------------------------------------------------------------------------------
+        uint32                  GetNumRecordingThreads() const  { return m_numThreadBuffers.load(std::memory_order_acquire); }
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Recorded OnContactRemoved callback.
+        //----------------------------------------------------------------------------------------------------
+        struct RemovedEvent
+        {
+            SubShapeIDPair              m_subShapePair;
+            uint32                      m_step;
+            uint64                      m_sequence;
+        };
+        
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Events recorded by a single thread.
+        //----------------------------------------------------------------------------------------------------
+        struct alignas(NES_CACHE_LINE_SIZE) ThreadBuffer
+        {
+            std::atomic<std::thread::id> m_owner {};
+            std::vector<ContactEvent>   m_added;
+            std::vector<ContactEvent>   m_persisted;
+            std::vector<RemovedEvent>   m_removed;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the buffer that the calling thread writes to. Returns nullptr when all buffers are
+        ///     in use, in which case the shared m_overflowBuffer must be used under m_overflowMutex.
+        //----------------------------------------------------------------------------------------------------
+        ThreadBuffer*           GetThreadBuffer();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Clear the events of all buffers and release them, so that the threads of the next update can
+        ///     claim them again, whether or not they are the same threads.
+        //----------------------------------------------------------------------------------------------------
+        void                    ReleaseThreadBuffers();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create the event for an added or persisted contact.
+        //----------------------------------------------------------------------------------------------------
+        ContactEvent            CreateEvent(const Body& body1, const Body& body2, const ContactManifold& manifold, const ContactSettings& settings);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the step for an added or persisted contact. Starts a new step if contacts were removed
+        ///     in the current step, as those callbacks are made at the end of a step.
+        //----------------------------------------------------------------------------------------------------
+        uint32                  GetAddedOrPersistedStep();
+
+    private:
+        ContactListener*        m_pValidateListener = nullptr;
+        uint64                  m_id;                           /// Unique ID of this listener, used to cache the buffer of a thread.
+        std::array<ThreadBuffer, kMaxThreadBuffers> m_threadBuffers;
+        std::atomic<uint32>     m_numThreadBuffers = 0;
+        std::atomic<uint32>     m_generation = 0;               /// Incremented when the buffers are released, invalidates the buffers cached by threads.
+        ThreadBuffer            m_overflowBuffer;
+        Mutex                   m_overflowMutex;
+        std::atomic<uint32>     m_step = 0;                     /// Step that events are recorded in.
+        std::atomic<uint32>     m_lastRemovedStep = ~0u;        /// Last step in which a contact was removed.
+        std::atomic<uint64>     m_nextSequence = 0;             /// Sequence number of the next event.
+
+        /// Merged events, kept to prevent allocations on every delivery.
+        std::vector<ContactEvent>   m_mergedAdded;
+        std::vector<ContactEvent>   m_mergedPersisted;
+        std::vector<RemovedEvent>   m_mergedRemoved;
+        std::vector<SubShapeIDPair> m_removedPairs;
+    };
+}
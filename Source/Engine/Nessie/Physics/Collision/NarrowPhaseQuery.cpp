@@ -8,19 +8,20 @@
 #include "Nessie/Physics/Collision/CollisionCollector.h"
 #include "Nessie/Physics/Collision/CastResult.h"
 #include "Nessie/Physics/Collision/InternalEdgeRemovingCollector.h"
+#include "Nessie/Jobs/ParallelFor.h"
 
 namespace nes
 {
-    bool NarrowPhaseQuery::CastRay(const RRayCast& ray, RayCastResult& hit, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter) const
+    namespace internal
     {
-        struct MyCollector : public RayCastBodyCollector
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Broadphase collector that casts a ray against the shape of each Body that it receives and
+        ///     keeps the closest hit.
+        //----------------------------------------------------------------------------------------------------
+        class CastRayClosestBodyCollector final : public RayCastBodyCollector
         {
-            RRayCast                    m_ray;
-            RayCastResult&              m_hit;
-            const BodyLockInterface&    m_bodyLockInterface;
-            const BodyFilter&           m_bodyFilter;
-            
-            MyCollector(const RRayCast& ray, RayCastResult& hit, const BodyLockInterface& bodyLockInterface, const BodyFilter& bodyFilter)
+        public:
+            CastRayClosestBodyCollector(const RRayCast& ray, RayCastResult& hit, const BodyLockInterface& bodyLockInterface, const BodyFilter& bodyFilter)
                 : m_ray(ray)
                 , m_hit(hit)
                 , m_bodyLockInterface(bodyLockInterface)
@@ -64,14 +65,76 @@ namespace nes
                     }
                 }
             }
+
+        private:
+            RRayCast                    m_ray;
+            RayCastResult&              m_hit;
+            const BodyLockInterface&    m_bodyLockInterface;
+            const BodyFilter&           m_bodyFilter;
         };
+    }
 
+    bool NarrowPhaseQuery::CastRay(const RRayCast& ray, RayCastResult& hit, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter) const
+    {
         // Do the broadphase test; note that the broadphase uses floats so we drop precision here.
-        MyCollector collector(ray, hit, *m_pBodyLockInterface, bodyFilter);
+        internal::CastRayClosestBodyCollector collector(ray, hit, *m_pBodyLockInterface, bodyFilter);
         m_pBroadPhaseQuery->CastRay(RayCast(ray), collector, broadPhaseLayerFilter, collisionLayerFilter);
         return hit.m_fraction <= 1.0f;
     }
 
+    uint NarrowPhaseQuery::CastRays(std::span<const RRayCast> rays, std::span<RayCastResult> hits, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, std::span<const BodyFilter* const> rayBodyFilters) const
+    {
+        NES_ASSERT(rays.size() == hits.size());
+        NES_ASSERT(rayBodyFilters.empty() || rayBodyFilters.size() == rays.size());
+
+        const size_t numRays = rays.size();
+        if (numRays == 0)
+            return 0;
+
+        // Create a collector for each ray; note that the broadphase uses floats so we drop precision here.
+        std::vector<internal::CastRayClosestBodyCollector> collectors;
+        std::vector<RayCastBodyCollector*> collectorPtrs(numRays);
+        std::vector<RayCast> broadPhaseRays(numRays);
+        collectors.reserve(numRays);
+        for (size_t i = 0; i < numRays; ++i)
+        {
+            const BodyFilter& filter = !rayBodyFilters.empty() && rayBodyFilters[i] != nullptr ? *rayBodyFilters[i] : bodyFilter;
+            collectorPtrs[i] = &collectors.emplace_back(rays[i], hits[i], *m_pBodyLockInterface, filter);
+            broadPhaseRays[i] = RayCast(rays[i]);
+        }
+
+        m_pBroadPhaseQuery->CastRays(broadPhaseRays.data(), collectorPtrs.data(), static_cast<int>(numRays), broadPhaseLayerFilter, collisionLayerFilter);
+
+        uint numHits = 0;
+        for (const RayCastResult& hit : hits)
+        {
+            if (hit.m_fraction <= 1.0f)
+                ++numHits;
+        }
+        return numHits;
+    }
+
+    uint NarrowPhaseQuery::CastRays(JobSystem& jobSystem, std::span<const RRayCast> rays, std::span<RayCastResult> hits, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, std::span<const BodyFilter* const> rayBodyFilters) const
+    {
+        NES_ASSERT(rays.size() == hits.size());
+        NES_ASSERT(rayBodyFilters.empty() || rayBodyFilters.size() == rays.size());
+
+        // Each chunk casts a contiguous range of rays, so that coherent rays stay in the same packets.
+        ParallelForSettings settings;
+        settings.m_pName = "Cast Rays";
+        settings.m_grainSize = kMinRaysPerChunk;
+
+        return ParallelReduce(jobSystem, 0, static_cast<uint32>(rays.size()), 0u, [&, this](const uint32 first, const uint32 end)
+        {
+            const uint32 count = end - first;
+            return CastRays(rays.subspan(first, count), hits.subspan(first, count), broadPhaseLayerFilter, collisionLayerFilter, bodyFilter
+                , rayBodyFilters.empty()? rayBodyFilters : rayBodyFilters.subspan(first, count));
+        }, [](const uint a, const uint b)
+        {
+            return a + b;
+        }, settings);
+    }
+
     void NarrowPhaseQuery::CastRay(const RRayCast& ray, const RayCastSettings& rayCastSettings, CastRayCollector& inCollector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter) const
     {
         struct MyCollector : public RayCastBodyCollector
@@ -203,13 +266,13 @@ namespace nes
         m_pBroadPhaseQuery->CollidePoint(Vec3(point), collector, broadPhaseLayerFilter, collisionLayerFilter);
     }
 
-    void NarrowPhaseQuery::CollideShape(const Shape* pShape, const Vec3 shapeScale, const Mat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3 baseOffset, CollideShapeCollector& inCollector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter) const
+    void NarrowPhaseQuery::CollideShape(const Shape* pShape, const Vec3 shapeScale, const RMat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3 baseOffset, CollideShapeCollector& inCollector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter) const
     {
         struct MyCollector : public CollideShapeBodyCollector
         {
             const Shape*                m_pShape;
             Vec3                        m_shapeScale;
-            Mat44                       m_centerOfMassTransform; // RMat44
+            RMat44                      m_centerOfMassTransform;
             const CollideShapeSettings& m_collideShapeSettings;
             RVec3                       m_baseOffset;
             CollideShapeCollector&      m_collector;
@@ -217,7 +280,7 @@ namespace nes
             const BodyFilter&           m_bodyFilter;
             const ShapeFilter&          m_shapeFilter;
 
-            MyCollector(const Shape* pShape, const Vec3 shapeScale, const Mat44& centerOfMassTransform, const CollideShapeSettings& settings, const RVec3 baseOffset, CollideShapeCollector& collector, const BodyLockInterface& bodyLockInterface, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter)
+            MyCollector(const Shape* pShape, const Vec3 shapeScale, const RMat44& centerOfMassTransform, const CollideShapeSettings& settings, const RVec3 baseOffset, CollideShapeCollector& collector, const BodyLockInterface& bodyLockInterface, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter)
                 : CollideShapeBodyCollector(collector)
                 , m_pShape(pShape)
                 , m_shapeScale(shapeScale)
@@ -279,7 +342,7 @@ namespace nes
         m_pBroadPhaseQuery->CollideAABox(bounds, collector, broadPhaseLayerFilter, collisionLayerFilter);
     }
     
-    void NarrowPhaseQuery::CollideShapeWithInternalEdgeRemoval(const Shape* pShape, const Vec3 shapeScale, const Mat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3 baseOffset, CollideShapeCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter) const
+    void NarrowPhaseQuery::CollideShapeWithInternalEdgeRemoval(const Shape* pShape, const Vec3 shapeScale, const RMat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3 baseOffset, CollideShapeCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter, const CollisionLayerFilter& collisionLayerFilter, const BodyFilter& bodyFilter, const ShapeFilter& shapeFilter) const
     {
         // We require these settings to internal-edge removal to work.
         CollideShapeSettings settings = collideShapeSettings;
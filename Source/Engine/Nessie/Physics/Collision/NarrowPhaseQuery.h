@@ -1,5 +1,6 @@
 ﻿// NarrowPhaseQuery.h
 #pragma once
+#include <span>
 #include "Nessie/Physics/Body/BodyFilter.h"
 #include "Nessie/Physics/Body/BodyLock.h"
 #include "Nessie/Physics/Body/BodyLockInterface.h"
@@ -10,6 +11,7 @@
 namespace nes
 {
     class Shape;
+    class JobSystem;
     struct CollideShapeSettings;
     struct RayCastResult;
 
@@ -51,6 +53,33 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         void                CastRay(const RRayCast& ray, const RayCastSettings& rayCastSettings, CastRayCollector& inCollector, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {}) const;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Cast a batch of rays and find the closest hit of each ray. This gives the same results as
+        /// calling CastRay() for each ray, but the broadphase is walked once for a packet of rays, testing the
+        /// bounds of each Node that it visits against all rays of the packet. Rays that are close together
+        /// (e.g. line of sight checks from the same character) should be next to each other in the batch.
+        ///
+        /// As with CastRay(), hits further than hits[i].m_fraction are not considered, so initialize the results
+        /// before calling this (a default RayCastResult considers the entire ray).
+        ///	@param rays : The rays to cast.
+        ///	@param hits : The closest hit of each ray, must be the same size as 'rays'. A ray hit something if its
+        ///     fraction is <= 1.
+        ///	@param broadPhaseLayerFilter : Filter that filters at the broadphase level.
+        ///	@param collisionLayerFilter : Filter that filters at the collision layer level.
+        ///	@param bodyFilter : Filter that filters at the body level.
+        ///	@param rayBodyFilters : Optional filter for each ray. If not empty, it must be the same size as 'rays',
+        ///     and a non-null filter is used for its ray instead of 'bodyFilter'.
+        ///	@returns : The number of rays that hit something.
+        //----------------------------------------------------------------------------------------------------
+        uint                CastRays(std::span<const RRayCast> rays, std::span<RayCastResult> hits, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, std::span<const BodyFilter* const> rayBodyFilters = {}) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Same as CastRays(), but the rays are divided over jobs on the job system with ParallelReduce().
+        ///     The calling thread casts rays as well, and this function returns when all rays are done. The filters
+        ///     are called from multiple threads at the same time.
+        //----------------------------------------------------------------------------------------------------
+        uint                CastRays(JobSystem& jobSystem, std::span<const RRayCast> rays, std::span<RayCastResult> hits, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, std::span<const BodyFilter* const> rayBodyFilters = {}) const;
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Check if a point is inside any shapes. For this test, all shapes are considered solid.
         /// For a mesh shape, this test will only provide sensible information if the mesh is a closed manifold.
@@ -73,13 +102,13 @@ namespace nes
         ///	@param bodyFilter : Filter that filters at the body level.
         ///	@param shapeFilter : Filter that filters at the shape level.
         //----------------------------------------------------------------------------------------------------
-        void                CollideShape(const Shape* pShape, const Vec3 shapeScale, const Mat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3 baseOffset, CollideShapeCollector& inCollector, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {}) const;
+        void                CollideShape(const Shape* pShape, const Vec3 shapeScale, const RMat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3 baseOffset, CollideShapeCollector& inCollector, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {}) const;
         
         //----------------------------------------------------------------------------------------------------
         /// @brief : Same as CollideShape, but uses InternalEdgeRemovingCollector to remove internal edges from
         ///     the collision results (a.k.a. ghost collisions).
         //----------------------------------------------------------------------------------------------------
-        void                CollideShapeWithInternalEdgeRemoval(const Shape* pShape, const Vec3 shapeScale, const Mat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3 baseOffset, CollideShapeCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {}) const;
+        void                CollideShapeWithInternalEdgeRemoval(const Shape* pShape, const Vec3 shapeScale, const RMat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3 baseOffset, CollideShapeCollector& collector, const BroadPhaseLayerFilter& broadPhaseLayerFilter = {}, const CollisionLayerFilter& collisionLayerFilter = {}, const BodyFilter& bodyFilter = {}, const ShapeFilter& shapeFilter = {}) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Cast a shape into the physics scene and report any hits to inCollector.
@@ -107,6 +136,9 @@ namespace nes
         void                Internal_Init(BodyLockInterface& bodyLockInterface, BroadPhaseQuery& broadPhaseQuery) { m_pBodyLockInterface = &bodyLockInterface; m_pBroadPhaseQuery = &broadPhaseQuery; }
     
     private:
+        /// Minimum number of rays that are cast by each chunk in the job system version of CastRays().
+        static constexpr uint kMinRaysPerChunk = 256;
+
         BodyLockInterface*  m_pBodyLockInterface = nullptr;
         BroadPhaseQuery*    m_pBroadPhaseQuery = nullptr;
     };
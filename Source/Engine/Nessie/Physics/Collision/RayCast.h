@@ -48,9 +48,9 @@ namespace nes
     //----------------------------------------------------------------------------------------------------
     /// @brief : RayCast type whose precision is based on Real. 
     //----------------------------------------------------------------------------------------------------
-    struct RRayCast : public TRayCast<RVec3, Mat44, RRayCast>
+    struct RRayCast : public TRayCast<RVec3, RMat44, RRayCast>
     {
-        using TRayCast<RVec3, Mat44, RRayCast>::TRayCast;
+        using TRayCast<RVec3, RMat44, RRayCast>::TRayCast;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Explicit cast form RayCast. Converts from single to double precision. 
@@ -45,7 +45,7 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         ShapeCastType               PostTransformed(const MatType& transform) const
         {
-            Mat44 start = transform * m_centerOfMassStart;
+            MatType start = transform * m_centerOfMassStart;
             Vec3 direction = transform.Multiply3x3(m_direction);
             return { m_pShape, m_scale, start, direction };
         }
@@ -53,7 +53,7 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get a translated copy of this shape cast by 'translation'. 
         //----------------------------------------------------------------------------------------------------
-        ShapeCastType               PostTranslated(const Vec3& translation) const
+        ShapeCastType               PostTranslated(const VecType& translation) const
         {
             return { m_pShape, m_scale, m_centerOfMassStart.PostTranslated(translation), m_direction };
         }
@@ -79,15 +79,15 @@ namespace nes
     //----------------------------------------------------------------------------------------------------
     /// @brief : ShapeCast type whose precision is based on Real. 
     //----------------------------------------------------------------------------------------------------
-    struct RShapeCast : public TShapeCast<RVec3, Mat44, RShapeCast>
+    struct RShapeCast : public TShapeCast<RVec3, RMat44, RShapeCast>
     {
-        using TShapeCast<RVec3, Mat44, RShapeCast>::TShapeCast;
+        using TShapeCast<RVec3, RMat44, RShapeCast>::TShapeCast;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Explicit cast form ShapeCast. Converts from single to double precision. 
         //----------------------------------------------------------------------------------------------------
         explicit RShapeCast(const ShapeCast& cast)
-            : RShapeCast(cast.m_pShape, cast.m_scale, Mat44(cast.m_centerOfMassStart), cast.m_direction, cast.m_shapeWorldBounds)
+            : RShapeCast(cast.m_pShape, cast.m_scale, RMat44(cast.m_centerOfMassStart), cast.m_direction, cast.m_shapeWorldBounds)
         {
             //
         }
@@ -97,7 +97,7 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         explicit operator ShapeCast() const
         {
-            return ShapeCast(m_pShape, m_scale, m_centerOfMassStart, m_direction, m_shapeWorldBounds);
+            return ShapeCast(m_pShape, m_scale, m_centerOfMassStart.ToMat44(), m_direction, m_shapeWorldBounds);
         }
     };
 
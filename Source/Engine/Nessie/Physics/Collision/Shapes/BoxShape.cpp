@@ -212,7 +212,7 @@ namespace nes
 
         switch (mode)
         {
-            case ESupportMode::ExcludeConvexRadius:
+            case ESupportMode::IncludeConvexRadius:
             case ESupportMode::Default:
             {
                 // Make a box out of our half extents
@@ -221,7 +221,7 @@ namespace nes
                 return new (&buffer) Box(box, 0.f);
                 
             }
-            case ESupportMode::IncludeConvexRadius:
+            case ESupportMode::ExcludeConvexRadius:
             {
                 // Reduce the box by our convex radius
                 float convexRadius = ScaleHelpers::ScaleConvexRadius(m_convexRadius, scale);
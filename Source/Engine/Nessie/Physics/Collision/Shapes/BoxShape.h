@@ -88,6 +88,11 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         float                   GetConvexRadius() const { return m_convexRadius; }
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get half the size of the box, including the convex radius.
+        //----------------------------------------------------------------------------------------------------
+        const Vec3&             GetHalfExtent() const   { return m_halfExtent; }
+
         //----------------------------------------------------------------------------------------------------
         /// @see : ConvexShape::GetSupportFunction()
         //----------------------------------------------------------------------------------------------------
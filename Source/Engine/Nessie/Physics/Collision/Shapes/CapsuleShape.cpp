@@ -0,0 +1,490 @@
+// CapsuleShape.cpp
+#include "CapsuleShape.h"
+
+#include "Nessie/Geometry/RayCapsule.h"
+#include "Nessie/Geometry/Segment.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/CollidePointResult.h"
+#include "Nessie/Physics/Collision/CollideShape.h"
+#include "Nessie/Physics/Collision/CollisionSolver.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Physics/Collision/ShapeCast.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+#include "Nessie/Physics/Collision/Shapes/GetTrianglesContext.h"
+#include "Nessie/Physics/Collision/Shapes/ScaleHelpers.h"
+#include "Nessie/Physics/Collision/Shapes/SphereShape.h"
+
+namespace nes
+{
+    static const StaticArray<Vec3, 192> s_capsuleTopTriangles = []()
+    {
+        StaticArray<Vec3, 192> vertices;
+        GetTrianglesContextVertexList::CreateHalfUnitSphereTop(vertices, 2);
+        return vertices;
+    }();
+
+    static const StaticArray<Vec3, 96> s_capsuleMiddleTriangles = []()
+    {
+        StaticArray<Vec3, 96> vertices;
+        GetTrianglesContextVertexList::CreateUnitOpenCylinder(vertices, 2);
+        return vertices;
+    }();
+
+    static const StaticArray<Vec3, 192> s_capsuleBottomTriangles = []()
+    {
+        StaticArray<Vec3, 192> vertices;
+        GetTrianglesContextVertexList::CreateHalfUnitSphereBottom(vertices, 2);
+        return vertices;
+    }();
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Shared implementation for the analytic capsule collisions. Both shapes are reduced to the
+    ///     closest points on their inner segments (or center) with a radius around them.
+    ///	@param closest1 : Closest point on the inner segment of shape 1, in world space.
+    ///	@param closest2 : Closest point on the inner segment of shape 2, in world space.
+    ///	@param fallbackAxis : Axis (from shape 1 towards shape 2) to use when the closest points coincide.
+    //----------------------------------------------------------------------------------------------------
+    static void CollideRoundedPoints(const ConvexShape* pShape1, const ConvexShape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const Vec3& closest1, const float radius1, const Vec3& closest2, const float radius2, const Vec3& fallbackAxis, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector)
+    {
+        const Vec3 delta = closest2 - closest1;
+        const float distanceSqr = delta.LengthSqr();
+        const float combinedRadius = radius1 + radius2;
+        if (distanceSqr > math::Squared(combinedRadius + collideShapeSettings.m_maxSeparationDistance))
+            return;
+
+        // Check if the penetration is bigger than the early out fraction
+        const float distance = std::sqrt(distanceSqr);
+        const float penetrationDepth = combinedRadius - distance;
+        if (-penetrationDepth >= collector.GetEarlyOutFraction())
+            return;
+
+        const Vec3 penetrationAxis = distance > 0.f? delta / distance : fallbackAxis;
+        const Vec3 point1 = closest1 + radius1 * penetrationAxis;
+        const Vec3 point2 = closest2 - radius2 * penetrationAxis;
+
+        CollideShapeResult result(point1, point2, penetrationAxis, penetrationDepth, subShapeIDCreator1.GetID(), subShapeIDCreator2.GetID(), TransformedShape::GetBodyID(collector.GetContext()));
+
+        // Gather faces, a capsule lying on another capsule needs both points of the cylinder side for a stable manifold.
+        if (collideShapeSettings.m_collectFacesMode == ECollectFacesMode::CollectFaces)
+        {
+            pShape1->GetSupportingFace(SubShapeID(), centerOfMassTransform1.Multiply3x3Transposed(-penetrationAxis), scale1, centerOfMassTransform1, result.m_shape1Face);
+            pShape2->GetSupportingFace(SubShapeID(), centerOfMassTransform2.Multiply3x3Transposed(penetrationAxis), scale2, centerOfMassTransform2, result.m_shape2Face);
+        }
+
+        // [TODO]: NarrowPhase Tracking
+        collector.AddHit(result);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Support function that includes the convex radius (the full capsule).
+    //----------------------------------------------------------------------------------------------------
+    class CapsuleShape::CapsuleNoConvex final : public Support
+    {
+        Vec3    m_halfHeightOfCylinder;
+        float   m_radius;
+
+    public:
+        CapsuleNoConvex(const Vec3& halfHeightOfCylinder, const float radius)
+            : m_halfHeightOfCylinder(halfHeightOfCylinder)
+            , m_radius(radius)
+        {
+            static_assert(sizeof(CapsuleNoConvex) <= sizeof(SupportBuffer), "Buffer size too small");
+            NES_ASSERT(math::IsAligned(this, alignof(CapsuleNoConvex)));
+        }
+
+        virtual Vec3 GetSupport(const Vec3& direction) const override
+        {
+            const float length = direction.Length();
+            const Vec3 radius = length > 0.f? (m_radius / length) * direction : Vec3::Zero();
+            return direction.y > 0.f? radius + m_halfHeightOfCylinder : radius - m_halfHeightOfCylinder;
+        }
+
+        virtual float GetConvexRadius() const override
+        {
+            return 0.f;
+        }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Support function that represents the capsule as a line segment with a convex radius.
+    //----------------------------------------------------------------------------------------------------
+    class CapsuleShape::CapsuleWithConvex final : public Support
+    {
+        Vec3    m_halfHeightOfCylinder;
+        float   m_radius;
+
+    public:
+        CapsuleWithConvex(const Vec3& halfHeightOfCylinder, const float radius)
+            : m_halfHeightOfCylinder(halfHeightOfCylinder)
+            , m_radius(radius)
+        {
+            static_assert(sizeof(CapsuleWithConvex) <= sizeof(SupportBuffer), "Buffer size too small");
+            NES_ASSERT(math::IsAligned(this, alignof(CapsuleWithConvex)));
+        }
+
+        virtual Vec3 GetSupport(const Vec3& direction) const override
+        {
+            return direction.y > 0.f? m_halfHeightOfCylinder : -m_halfHeightOfCylinder;
+        }
+
+        virtual float GetConvexRadius() const override
+        {
+            return m_radius;
+        }
+    };
+
+    ShapeSettings::ShapeResult CapsuleShapeSettings::Create() const
+    {
+        if (m_cachedResult.IsEmpty())
+        {
+            if (IsSphere())
+            {
+                // A capsule without a cylinder is a sphere, which has cheaper collision functions.
+                SphereShape* pSphere = new SphereShape(m_radius);
+                pSphere->SetUserData(m_userData);
+                pSphere->SetDensity(m_density);
+                m_cachedResult.Set(pSphere);
+            }
+            else
+            {
+                StrongPtr<Shape> pShape = new CapsuleShape(*this, m_cachedResult);
+            }
+        }
+        return m_cachedResult;
+    }
+
+    CapsuleShape::CapsuleShape(const CapsuleShapeSettings& settings, ShapeResult& outResult)
+        : ConvexShape(EShapeSubType::Capsule, settings, outResult)
+        , m_radius(settings.m_radius)
+        , m_halfHeightOfCylinder(settings.m_halfHeightOfCylinder)
+    {
+        if (settings.m_halfHeightOfCylinder <= 0.f)
+        {
+            outResult.SetError("Invalid height");
+            return;
+        }
+
+        if (settings.m_radius <= 0.f)
+        {
+            outResult.SetError("Invalid radius");
+            return;
+        }
+
+        outResult.Set(this);
+    }
+
+    CapsuleShape::CapsuleShape(const float halfHeightOfCylinder, const float radius)
+        : ConvexShape(EShapeSubType::Capsule)
+        , m_radius(radius)
+        , m_halfHeightOfCylinder(halfHeightOfCylinder)
+    {
+        NES_ASSERT(halfHeightOfCylinder > 0.f);
+        NES_ASSERT(radius > 0.f);
+    }
+
+    void CapsuleShape::GetScaledSegment(const Vec3& scale, const Mat44& transform, Vec3& outTop, Vec3& outBottom) const
+    {
+        NES_ASSERT(IsValidScale(scale));
+
+        const float scaledHalfHeight = math::Abs(scale.x) * m_halfHeightOfCylinder;
+        const Vec3 axis = scaledHalfHeight * transform.GetAxisY();
+        const Vec3 center = transform.GetTranslation();
+        outTop = center + axis;
+        outBottom = center - axis;
+    }
+
+    AABox CapsuleShape::GetLocalBounds() const
+    {
+        const Vec3 halfExtent(m_radius, m_halfHeightOfCylinder + m_radius, m_radius);
+        return AABox(-halfExtent, halfExtent);
+    }
+
+    AABox CapsuleShape::GetWorldBounds(const Mat44& centerOfMassTransform, const Vec3& scale) const
+    {
+        // The bounds of the segment between the end-cap centers, expanded by the radius.
+        Vec3 top, bottom;
+        GetScaledSegment(scale, centerOfMassTransform, top, bottom);
+        const Vec3 radius = Vec3::Replicate(math::Abs(scale.x) * m_radius);
+        return AABox(Vec3::Min(top, bottom) - radius, Vec3::Max(top, bottom) + radius);
+    }
+
+    MassProperties CapsuleShape::GetMassProperties() const
+    {
+        MassProperties props;
+
+        // Calculate the inertia and mass according to:
+        // https://www.gamedev.net/resources/_/technical/math-and-physics/capsule-inertia-tensor-r3856
+        const float density = GetDensity();
+        const float radiusSqr = math::Squared(m_radius);
+        const float height = 2.f * m_halfHeightOfCylinder;
+        const float cylinderMass = math::Pi<float>() * height * radiusSqr * density;
+        const float hemisphereMass = (2.f * math::Pi<float>() / 3.f) * radiusSqr * m_radius * density;
+
+        // From the cylinder
+        const float heightSqr = math::Squared(height);
+        float inertiaY = radiusSqr * cylinderMass * 0.5f;
+        float inertiaXZ = inertiaY * 0.5f + cylinderMass * heightSqr / 12.f;
+
+        // From the hemispheres
+        const float temp = hemisphereMass * 4.f * radiusSqr / 5.f;
+        inertiaY += temp;
+        inertiaXZ += temp + hemisphereMass * (0.5f * heightSqr + (3.f / 4.f) * height * m_radius);
+
+        props.m_mass = cylinderMass + 2.f * hemisphereMass;
+        props.m_inertia = Mat44::MakeScale(Vec3(inertiaXZ, inertiaY, inertiaXZ));
+        return props;
+    }
+
+    Vec3 CapsuleShape::GetSurfaceNormal([[maybe_unused]] const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const
+    {
+        NES_ASSERT(subShapeID.IsEmpty(), "Invalid subshape ID");
+
+        // The normal points away from the closest point on the inner segment.
+        const float clampedY = math::Clamp(localSurfacePosition.y, -m_halfHeightOfCylinder, m_halfHeightOfCylinder);
+        return (localSurfacePosition - Vec3(0.f, clampedY, 0.f)).NormalizedOr(Vec3::AxisY());
+    }
+
+    bool CapsuleShape::CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const
+    {
+        const float fraction = RayCapsule(ray.m_origin, ray.m_direction, m_halfHeightOfCylinder, m_radius);
+        if (fraction < hitResult.m_fraction)
+        {
+            hitResult.m_fraction = fraction;
+            hitResult.m_subShapeID2 = subShapeIDCreator.GetID();
+            return true;
+        }
+
+        return false;
+    }
+
+    void CapsuleShape::CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator,
+        CollidePointCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test Shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        const float clampedY = math::Clamp(point.y, -m_halfHeightOfCylinder, m_halfHeightOfCylinder);
+        if ((point - Vec3(0.f, clampedY, 0.f)).LengthSqr() <= math::Squared(m_radius))
+        {
+            collector.AddHit({ TransformedShape::GetBodyID(collector.GetContext()), subShapeIDCreator.GetID() });
+        }
+    }
+
+    void CapsuleShape::GetTrianglesStart(GetTrianglesContext& context, [[maybe_unused]] const AABox& box, const Vec3& positionCOM,
+        const Quat& rotation, const Vec3& scale) const
+    {
+        NES_ASSERT(IsValidScale(scale));
+
+        const Mat44 unscaledTransform = Mat44::MakeRotationTranslation(rotation, positionCOM);
+        const float absScale = math::Abs(scale.x);
+        const float scaledRadius = absScale * m_radius;
+        const float scaledHalfHeight = absScale * m_halfHeightOfCylinder;
+
+        GetTrianglesContextMultiVertexList* pContext = new (&context) GetTrianglesContextMultiVertexList(false);
+
+        Mat44 transform = unscaledTransform * Mat44::MakeTranslation(Vec3(0.f, scaledHalfHeight, 0.f)) * Mat44::MakeScale(scaledRadius);
+        pContext->AddPart(transform, s_capsuleTopTriangles.data(), s_capsuleTopTriangles.size());
+
+        transform = unscaledTransform * Mat44::MakeScale(Vec3(scaledRadius, scaledHalfHeight, scaledRadius));
+        pContext->AddPart(transform, s_capsuleMiddleTriangles.data(), s_capsuleMiddleTriangles.size());
+
+        transform = unscaledTransform * Mat44::MakeTranslation(Vec3(0.f, -scaledHalfHeight, 0.f)) * Mat44::MakeScale(scaledRadius);
+        pContext->AddPart(transform, s_capsuleBottomTriangles.data(), s_capsuleBottomTriangles.size());
+    }
+
+    int CapsuleShape::GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested,
+        Float3* outTriangleVertices) const
+    {
+        return (reinterpret_cast<GetTrianglesContextMultiVertexList&>(context).GetTrianglesNext(maxTrianglesRequested, outTriangleVertices));
+    }
+
+    float CapsuleShape::GetVolume() const
+    {
+        const float radiusSqr = math::Squared(m_radius);
+        return (4.f / 3.f * math::Pi<float>()) * radiusSqr * m_radius + 2.f * math::Pi<float>() * m_halfHeightOfCylinder * radiusSqr;
+    }
+
+    bool CapsuleShape::IsValidScale(const Vec3& scale) const
+    {
+        return ConvexShape::IsValidScale(scale) && ScaleHelpers::IsUniformScale(scale.Abs());
+    }
+
+    Vec3 CapsuleShape::MakeScaleValid(const Vec3& scale) const
+    {
+        const Vec3 nonZeroScale = ScaleHelpers::MakeNonZeroScale(scale);
+        return nonZeroScale.GetSign() * ScaleHelpers::MakeUniformScale(nonZeroScale.Abs());
+    }
+
+    const ConvexShape::Support* CapsuleShape::GetSupportFunction(ESupportMode mode, SupportBuffer& buffer,
+        const Vec3& scale) const
+    {
+        NES_ASSERT(IsValidScale(scale));
+
+        const float absScale = math::Abs(scale.x);
+        const float scaledRadius = absScale * m_radius;
+        const Vec3 scaledHalfHeight(0.f, absScale * m_halfHeightOfCylinder, 0.f);
+
+        switch (mode)
+        {
+            case ESupportMode::IncludeConvexRadius:
+                return new (&buffer) CapsuleNoConvex(scaledHalfHeight, scaledRadius);
+
+            case ESupportMode::ExcludeConvexRadius:
+            case ESupportMode::Default:
+                return new (&buffer) CapsuleWithConvex(scaledHalfHeight, scaledRadius);
+        }
+
+        NES_ASSERT(false);
+        return nullptr;
+    }
+
+    void CapsuleShape::GetSupportingFace([[maybe_unused]] const SubShapeID& subShapeID, const Vec3& direction, const Vec3& scale, const Mat44& centerOfMassTransform, SupportingFace& outVertices) const
+    {
+        NES_ASSERT(subShapeID.IsEmpty(), "Invalid subshape ID");
+        NES_ASSERT(IsValidScale(scale));
+
+        const float absScale = math::Abs(scale.x);
+        const float scaledRadius = absScale * m_radius;
+        const Vec3 scaledHalfHeight(0.f, absScale * m_halfHeightOfCylinder, 0.f);
+
+        // Get the direction in the horizontal plane. If it is zero, we are hitting an end-cap which has no face.
+        const Vec3 horizontal(direction.x, 0.f, direction.z);
+        const float length = horizontal.Length();
+        if (length == 0.f)
+            return;
+
+        // Get the support points of the top and bottom sphere in the opposite direction.
+        const Vec3 support = (scaledRadius / length) * horizontal;
+        const Vec3 supportTop = scaledHalfHeight - support;
+        const Vec3 supportBottom = -scaledHalfHeight - support;
+
+        // If the projections are roughly equal, the cylinder side is the supporting face. Otherwise, there is
+        // only a single point.
+        const float projectionTop = supportTop.Dot(direction);
+        const float projectionBottom = supportBottom.Dot(direction);
+        if (math::Abs(projectionTop - projectionBottom) < physics::kCapsuleProjectionSlop * direction.Length())
+        {
+            outVertices.push_back(centerOfMassTransform.TransformPoint(supportTop));
+            outVertices.push_back(centerOfMassTransform.TransformPoint(supportBottom));
+        }
+    }
+
+    void CapsuleShape::Register()
+    {
+        ShapeFunctions& f = ShapeFunctions::Get(EShapeSubType::Capsule);
+        f.m_construct = []() -> Shape* { return new CapsuleShape; };
+        f.m_color = Color::Green();
+
+        // Replace the generic GJK/EPA paths with closed form solutions.
+        CollisionSolver::RegisterCollideShape(EShapeSubType::Capsule, EShapeSubType::Capsule, CollideCapsuleVsCapsule);
+        CollisionSolver::RegisterCollideShape(EShapeSubType::Sphere, EShapeSubType::Capsule, CollideSphereVsCapsule);
+        CollisionSolver::RegisterCollideShape(EShapeSubType::Capsule, EShapeSubType::Sphere, CollisionSolver::ReversedCollideShape);
+        CollisionSolver::RegisterCastShape(EShapeSubType::Sphere, EShapeSubType::Capsule, CastSphereVsCapsule);
+    }
+
+    void CapsuleShape::CollideCapsuleVsCapsule(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1,
+        const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2,
+        const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2,
+        const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        [[maybe_unused]] const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape1->GetSubType() == EShapeSubType::Capsule);
+        NES_ASSERT(pShape2->GetSubType() == EShapeSubType::Capsule);
+        const CapsuleShape* pCapsule1 = checked_cast<const CapsuleShape*>(pShape1);
+        const CapsuleShape* pCapsule2 = checked_cast<const CapsuleShape*>(pShape2);
+
+        Segment segment1, segment2;
+        pCapsule1->GetScaledSegment(scale1, centerOfMassTransform1, segment1.m_start, segment1.m_end);
+        pCapsule2->GetScaledSegment(scale2, centerOfMassTransform2, segment2.m_start, segment2.m_end);
+
+        Vec3 closest1, closest2;
+        float t1, t2;
+        ClosestPointsBetweenSegments(segment1, segment2, closest1, closest2, t1, t2);
+
+        // When the segments intersect, push the capsules apart perpendicular to both axes.
+        const Vec3 fallbackAxis = segment1.Vector().Cross(segment2.Vector()).NormalizedOr(centerOfMassTransform1.GetAxisX());
+
+        const float radius1 = math::Abs(scale1.x) * pCapsule1->m_radius;
+        const float radius2 = math::Abs(scale2.x) * pCapsule2->m_radius;
+        CollideRoundedPoints(pCapsule1, pCapsule2, scale1, scale2, centerOfMassTransform1, centerOfMassTransform2, closest1, radius1, closest2, radius2, fallbackAxis, subShapeIDCreator1, subShapeIDCreator2, collideShapeSettings, collector);
+    }
+
+    void CapsuleShape::CollideSphereVsCapsule(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1,
+        const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2,
+        const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2,
+        const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        [[maybe_unused]] const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape1->GetSubType() == EShapeSubType::Sphere);
+        NES_ASSERT(pShape2->GetSubType() == EShapeSubType::Capsule);
+        const SphereShape* pSphere = checked_cast<const SphereShape*>(pShape1);
+        const CapsuleShape* pCapsule = checked_cast<const CapsuleShape*>(pShape2);
+
+        Segment segment;
+        pCapsule->GetScaledSegment(scale2, centerOfMassTransform2, segment.m_start, segment.m_end);
+
+        const Vec3 center = centerOfMassTransform1.GetTranslation();
+        const Vec3 closest = segment.ClosestPoint(center);
+
+        // When the sphere center is on the capsule axis, push the sphere out sideways.
+        const float sphereRadius = math::Abs(scale1.x) * pSphere->GetRadius();
+        const float capsuleRadius = math::Abs(scale2.x) * pCapsule->m_radius;
+        CollideRoundedPoints(pSphere, pCapsule, scale1, scale2, centerOfMassTransform1, centerOfMassTransform2, center, sphereRadius, closest, capsuleRadius, centerOfMassTransform2.GetAxisX(), subShapeIDCreator1, subShapeIDCreator2, collideShapeSettings, collector);
+    }
+
+    void CapsuleShape::CastSphereVsCapsule(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings,
+        const Shape* pShape, const Vec3& scale, [[maybe_unused]] const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2,
+        const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2,
+        CastShapeCollector& collector)
+    {
+        NES_ASSERT(shapeCast.m_pShape->GetSubType() == EShapeSubType::Sphere);
+        NES_ASSERT(pShape->GetSubType() == EShapeSubType::Capsule);
+        const SphereShape* pSphere = checked_cast<const SphereShape*>(shapeCast.m_pShape);
+        const CapsuleShape* pCapsule = checked_cast<const CapsuleShape*>(pShape);
+
+        // The cast is in the local space of the capsule. Casting a sphere against a capsule is the same as
+        // casting a ray against a capsule with the combined radius.
+        const float sphereRadius = math::Abs(shapeCast.m_scale.x) * pSphere->GetRadius();
+        const float absScale = math::Abs(scale.x);
+        const float capsuleRadius = absScale * pCapsule->m_radius;
+        const float halfHeight = absScale * pCapsule->m_halfHeightOfCylinder;
+        const Vec3 start = shapeCast.m_centerOfMassStart.GetTranslation();
+
+        const float fraction = RayCapsule(start, shapeCast.m_direction, halfHeight, sphereRadius + capsuleRadius);
+        if (fraction >= collector.GetEarlyOutFraction())
+            return;
+
+        // Contact normal points from the sphere towards the closest point on the capsule axis.
+        const Vec3 centerAtHit = start + fraction * shapeCast.m_direction;
+        const Vec3 closestOnAxis(0.f, math::Clamp(centerAtHit.y, -halfHeight, halfHeight), 0.f);
+        const Vec3 delta = closestOnAxis - centerAtHit;
+        const float distance = delta.Length();
+        const Vec3 contactNormal = distance > 0.f? delta / distance : shapeCast.m_direction.NormalizedOr(Vec3::AxisX());
+
+        // Test if back facing
+        if (shapeCastSettings.m_backfaceModeConvex == EBackFaceMode::IgnoreBackFaces && contactNormal.Dot(shapeCast.m_direction) <= 0.f)
+            return;
+
+        // When touching both contact points coincide, when starting in penetration they are the deepest points.
+        const Vec3 contactPointA = centerAtHit + sphereRadius * contactNormal;
+        const Vec3 contactPointB = fraction > 0.f? contactPointA : closestOnAxis - capsuleRadius * contactNormal;
+
+        ShapeCastResult result(fraction
+            , centerOfMassTransform2.TransformPoint(contactPointA)
+            , centerOfMassTransform2.TransformPoint(contactPointB)
+            , centerOfMassTransform2.TransformVector(contactNormal)
+            , false, subShapeIDCreator1.GetID(), subShapeIDCreator2.GetID(), TransformedShape::GetBodyID(collector.GetContext()));
+
+        // Early out if this hit is deeper than the collector's early out value:
+        if (fraction == 0.f && -result.m_penetrationDepth >= collector.GetEarlyOutFraction())
+            return;
+
+        // Gather faces, the sphere doesn't have a supporting face.
+        if (shapeCastSettings.m_collectFacesMode == ECollectFacesMode::CollectFaces)
+            pCapsule->GetSupportingFace(SubShapeID(), contactNormal, scale, centerOfMassTransform2, result.m_shape2Face);
+
+        // [TODO]: Narrow Phase tracking
+        collector.AddHit(result);
+    }
+}
@@ -0,0 +1,164 @@
+// CapsuleShape.h
+#pragma once
+#include "ConvexShape.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings that create a Capsule Shape.
+    //----------------------------------------------------------------------------------------------------
+    class CapsuleShapeSettings final : public ConvexShapeSettings
+    {
+    public:
+        float   m_radius = 0.f;                 /// Radius of the cylinder and the two end-cap spheres.
+        float   m_halfHeightOfCylinder = 0.f;   /// Half the height of the cylinder part, excluding the end-caps.
+
+        CapsuleShapeSettings() = default;
+        CapsuleShapeSettings(const float halfHeightOfCylinder, const float radius) : m_radius(radius), m_halfHeightOfCylinder(halfHeightOfCylinder) {}
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if the settings describe a sphere (a capsule with a cylinder height of 0).
+        //----------------------------------------------------------------------------------------------------
+        bool                IsSphere() const { return m_halfHeightOfCylinder == 0.f; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ShapeSettings::Create()
+        //----------------------------------------------------------------------------------------------------
+        virtual ShapeResult Create() const override;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A Capsule, centered around the origin with its axis along the Y axis.
+    /// @note : Collisions against other capsules and spheres, and sphere casts, are solved analytically
+    ///     instead of going through GJK/EPA.
+    //----------------------------------------------------------------------------------------------------
+    class CapsuleShape final : public ConvexShape
+    {
+    public:
+        CapsuleShape() : ConvexShape(EShapeSubType::Capsule) {}
+        CapsuleShape(const CapsuleShapeSettings& settings, ShapeResult& outResult);
+        CapsuleShape(const float halfHeightOfCylinder, const float radius);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the radius of the capsule.
+        //----------------------------------------------------------------------------------------------------
+        float                   GetRadius() const                   { return m_radius; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get half the height of the cylinder part, excluding the end-caps.
+        //----------------------------------------------------------------------------------------------------
+        float                   GetHalfHeightOfCylinder() const     { return m_halfHeightOfCylinder; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetLocalBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetLocalBounds() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetWorldBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetWorldBounds(const Mat44& centerOfMassTransform, const Vec3& scale) const override;
+        using Shape::GetWorldBounds;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetInnerRadius()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetInnerRadius() const override     { return m_radius; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetMassProperties()
+        //----------------------------------------------------------------------------------------------------
+        virtual MassProperties  GetMassProperties() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSurfaceNormal()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            GetSurfaceNormal(const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const override;
+
+        // The collector version of CastRay in ConvexShape uses the analytic single hit version above.
+        using ConvexShape::CastRay;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CollidePoint()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesStart()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesNext()
+        //----------------------------------------------------------------------------------------------------
+        virtual int             GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested, Float3* outTriangleVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetVolume()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetVolume() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::IsValidScale()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            IsValidScale(const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::MakeScaleValid()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            MakeScaleValid(const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ConvexShape::GetSupportFunction()
+        //----------------------------------------------------------------------------------------------------
+        virtual const Support*  GetSupportFunction(ESupportMode mode, SupportBuffer& buffer, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ConvexShape::GetSupportingFace()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction, const Vec3& scale, const Mat44& centerOfMassTransform, SupportingFace& outVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Register shape functions within the registry. This also registers the analytic
+        ///     capsule vs capsule and capsule vs sphere collision functions, so it must be called after
+        ///     ConvexShape::Register(), which installs the generic GJK/EPA functions for all convex pairs.
+        //----------------------------------------------------------------------------------------------------
+        static void             Register();
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the line segment between the centers of the two end-caps in the space of the transform.
+        //----------------------------------------------------------------------------------------------------
+        inline void             GetScaledSegment(const Vec3& scale, const Mat44& transform, Vec3& outTop, Vec3& outBottom) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Closed form capsule vs capsule test
+        ///     based on the closest points between the two inner segments.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideCapsuleVsCapsule(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Closed form sphere vs capsule test.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideSphereVsCapsule(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Casts a sphere against a capsule by
+        ///     intersecting the ray of its center with a capsule of the combined radius.
+        //----------------------------------------------------------------------------------------------------
+        static void             CastSphereVsCapsule(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape, const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector);
+
+    private:
+        /// Classes for GetSupportFunction()
+        class CapsuleNoConvex;
+        class CapsuleWithConvex;
+
+        float   m_radius = 0.f;
+        float   m_halfHeightOfCylinder = 0.f;
+    };
+}
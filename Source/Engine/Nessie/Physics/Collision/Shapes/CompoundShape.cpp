@@ -0,0 +1,324 @@
+// CompoundShape.cpp
+#include "CompoundShape.h"
+
+#include "ScaleHelpers.h"
+#include "Nessie/Physics/Collision/CollisionSolver.h"
+#include "Nessie/Physics/Collision/ShapeCast.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+
+namespace nes
+{
+    /// Above this number of sub shapes, GetWorldBounds() transforms the local bounds instead of combining the
+    /// world bounds of each sub shape.
+    static constexpr uint kMaxSubShapesForTightWorldBounds = 10;
+
+    void CompoundShapeSettings::AddShape(const Vec3& position, const Quat& rotation, const ShapeSettings* pShape, const uint32 userData)
+    {
+        NES_ASSERT(pShape != nullptr);
+
+        SubShapeSettings& subShape = m_subShapes.emplace_back();
+        subShape.m_pShape = pShape;
+        subShape.m_position = position;
+        subShape.m_rotation = rotation;
+        subShape.m_userData = userData;
+    }
+
+    void CompoundShapeSettings::AddShape(const Vec3& position, const Quat& rotation, const Shape* pShape, const uint32 userData)
+    {
+        NES_ASSERT(pShape != nullptr);
+
+        SubShapeSettings& subShape = m_subShapes.emplace_back();
+        subShape.m_pShapePtr = pShape;
+        subShape.m_position = position;
+        subShape.m_rotation = rotation;
+        subShape.m_userData = userData;
+    }
+
+    bool CompoundShape::SubShape::FromSettings(const CompoundShapeSettings::SubShapeSettings& settings, ShapeResult& outResult)
+    {
+        if (settings.m_pShapePtr != nullptr)
+        {
+            m_pShape = settings.m_pShapePtr;
+        }
+        else
+        {
+            if (settings.m_pShape == nullptr)
+            {
+                outResult.SetError("Sub shape has no shape or shape settings!");
+                return false;
+            }
+
+            ShapeResult childResult = settings.m_pShape->Create();
+            if (!childResult.IsValid())
+            {
+                outResult = childResult;
+                return false;
+            }
+            m_pShape = childResult.Get();
+        }
+
+        m_userData = settings.m_userData;
+        SetTransform(settings.m_position, settings.m_rotation, Vec3::Zero());
+        return true;
+    }
+
+    void CompoundShape::SubShape::SetTransform(const Vec3& position, const Quat& rotation, const Vec3& centerOfMass)
+    {
+        m_positionCOM = position - centerOfMass + rotation * m_pShape->GetCenterOfMass();
+        m_isRotationIdentity = rotation.IsClose(Quat::Identity()) || rotation.IsClose(-Quat::Identity());
+        m_rotation = m_isRotationIdentity ? Quat::Identity() : rotation;
+    }
+
+    bool CompoundShape::SubShape::IsValidScale(const Vec3& scale) const
+    {
+        return m_isRotationIdentity || ScaleHelpers::CanScaleBeRotated(m_rotation, scale);
+    }
+
+    Vec3 CompoundShape::SubShape::TransformScale(const Vec3& scale) const
+    {
+        return m_isRotationIdentity ? scale : ScaleHelpers::RotateScale(m_rotation, scale);
+    }
+
+    bool CompoundShape::MustBeStatic() const
+    {
+        for (const SubShape& subShape : m_subShapes)
+        {
+            if (subShape.m_pShape->MustBeStatic())
+                return true;
+        }
+
+        return false;
+    }
+
+    AABox CompoundShape::GetWorldBounds(const Mat44& centerOfMassTransform, const Vec3& scale) const
+    {
+        if (m_subShapes.empty())
+        {
+            // An empty compound has no bounds, return a point at the center of mass.
+            return AABox(centerOfMassTransform.GetTranslation(), centerOfMassTransform.GetTranslation());
+        }
+
+        if (m_subShapes.size() > kMaxSubShapesForTightWorldBounds)
+            return Shape::GetWorldBounds(centerOfMassTransform, scale);
+
+        AABox bounds;
+        for (const SubShape& subShape : m_subShapes)
+        {
+            const Mat44 transform = centerOfMassTransform * subShape.GetLocalTransformNoScale(scale);
+            bounds.Encapsulate(subShape.m_pShape->GetWorldBounds(transform, subShape.TransformScale(scale)));
+        }
+        return bounds;
+    }
+
+    unsigned CompoundShape::GetSubSShapeIDBitsRecursive() const
+    {
+        // Add the max number of bits of the sub shapes to our own
+        unsigned maxBits = 0;
+        for (const SubShape& subShape : m_subShapes)
+            maxBits = math::Max(maxBits, subShape.m_pShape->GetSubSShapeIDBitsRecursive());
+
+        return GetSubShapeIDBits() + maxBits;
+    }
+
+    MassProperties CompoundShape::GetMassProperties() const
+    {
+        MassProperties result;
+        for (const SubShape& subShape : m_subShapes)
+        {
+            // Move the mass properties of the sub shape into the space of the compound
+            MassProperties child = subShape.m_pShape->GetMassProperties();
+            child.Rotate(Mat44::MakeRotation(subShape.m_rotation));
+            child.Translate(subShape.m_positionCOM);
+
+            result.m_mass += child.m_mass;
+            result.m_inertia += child.m_inertia;
+        }
+
+        // Adding the inertia matrices changes the bottom right element, make it a 3x3 matrix again.
+        result.m_inertia.SetColumn4(3, Vec4(0.f, 0.f, 0.f, 1.f));
+        return result;
+    }
+
+    const Shape* CompoundShape::GetLeafShape(const SubShapeID& subShapeID, SubShapeID& outRemainder) const
+    {
+        SubShapeID remainder;
+        const uint32 index = GetSubShapeIndexFromID(subShapeID, remainder);
+        if (index >= m_subShapes.size())
+        {
+            // The SubShapeID is no longer valid, the compound was modified.
+            outRemainder = SubShapeID();
+            return nullptr;
+        }
+
+        return m_subShapes[index].m_pShape->GetLeafShape(remainder, outRemainder);
+    }
+
+    Vec3 CompoundShape::GetSurfaceNormal(const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const
+    {
+        SubShapeID remainder;
+        const SubShape& subShape = m_subShapes[GetSubShapeIndexFromID(subShapeID, remainder)];
+
+        // Get the normal in the space of the sub shape and rotate it back
+        const Vec3 subShapePosition = subShape.m_rotation.Conjugate() * (localSurfacePosition - subShape.m_positionCOM);
+        return subShape.m_rotation * subShape.m_pShape->GetSurfaceNormal(remainder, subShapePosition);
+    }
+
+    void CompoundShape::GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction, const Vec3& scale,
+        const Mat44& centerOfMassTransform, SupportingFace& outVertices) const
+    {
+        SubShapeID remainder;
+        const SubShape& subShape = m_subShapes[GetSubShapeIndexFromID(subShapeID, remainder)];
+
+        const Mat44 transform = centerOfMassTransform * subShape.GetLocalTransformNoScale(scale);
+        subShape.m_pShape->GetSupportingFace(remainder, subShape.m_rotation.Conjugate() * direction, subShape.TransformScale(scale), transform, outVertices);
+    }
+
+    uint64_t CompoundShape::GetSubShapeUserData(const SubShapeID& subShapeID) const
+    {
+        SubShapeID remainder;
+        const uint32 index = GetSubShapeIndexFromID(subShapeID, remainder);
+        if (index >= m_subShapes.size())
+            return 0; // The SubShapeID is no longer valid, the compound was modified.
+
+        return m_subShapes[index].m_pShape->GetSubShapeUserData(remainder);
+    }
+
+    TransformedShape CompoundShape::GetSubShapeTransformedShape(const SubShapeID& subShapeID, const Vec3& positionCOM,
+        const Quat& rotation, const Vec3& scale, SubShapeID& outRemainder) const
+    {
+        const SubShape& subShape = m_subShapes[GetSubShapeIndexFromID(subShapeID, outRemainder)];
+
+        // Calculate the transform of the sub shape
+        const Vec3 position = positionCOM + rotation * (scale * subShape.m_positionCOM);
+        const Quat subShapeRotation = rotation * subShape.m_rotation;
+
+        TransformedShape tShape(RVec3(position), subShapeRotation, subShape.m_pShape, BodyID());
+        tShape.SetShapeScale(subShape.TransformScale(scale));
+        return tShape;
+    }
+
+    void CompoundShape::TransformShape(const Mat44& centerOfMassTransform, TransformedShapeCollector& collector) const
+    {
+        for (const SubShape& subShape : m_subShapes)
+            subShape.m_pShape->TransformShape(centerOfMassTransform * Mat44::MakeRotationTranslation(subShape.m_rotation, subShape.m_positionCOM), collector);
+    }
+
+    void CompoundShape::GetTrianglesStart([[maybe_unused]] GetTrianglesContext& context, [[maybe_unused]] const AABox& box,
+        [[maybe_unused]] const Vec3& positionCOM, [[maybe_unused]] const Quat& rotation, [[maybe_unused]] const Vec3& scale) const
+    {
+        NES_ASSERT(false, "Cannot get the triangles of a compound shape, use CollectTransformedShapes() to collect the leaf shapes first!");
+    }
+
+    int CompoundShape::GetTrianglesNext([[maybe_unused]] GetTrianglesContext& context, [[maybe_unused]] int maxTrianglesRequested,
+        [[maybe_unused]] Float3* outTriangleVertices) const
+    {
+        NES_ASSERT(false, "Cannot get the triangles of a compound shape, use CollectTransformedShapes() to collect the leaf shapes first!");
+        return 0;
+    }
+
+    float CompoundShape::GetVolume() const
+    {
+        float volume = 0.f;
+        for (const SubShape& subShape : m_subShapes)
+            volume += subShape.m_pShape->GetVolume();
+        return volume;
+    }
+
+    bool CompoundShape::IsValidScale(const Vec3& scale) const
+    {
+        if (!Shape::IsValidScale(scale))
+            return false;
+
+        for (const SubShape& subShape : m_subShapes)
+        {
+            if (!subShape.IsValidScale(scale) || !subShape.m_pShape->IsValidScale(subShape.TransformScale(scale)))
+                return false;
+        }
+
+        return true;
+    }
+
+    Vec3 CompoundShape::MakeScaleValid(const Vec3& scale) const
+    {
+        const Vec3 nonZeroScale = ScaleHelpers::MakeNonZeroScale(scale);
+        if (CompoundShape::IsValidScale(nonZeroScale))
+            return nonZeroScale;
+
+        // A uniform scale can be passed on to any rotated sub shape.
+        return nonZeroScale.GetSign() * ScaleHelpers::MakeUniformScale(nonZeroScale.Abs());
+    }
+
+    bool CompoundShape::CreateSubShapes(const CompoundShapeSettings& settings, ShapeResult& outResult)
+    {
+        m_subShapes.resize(settings.m_subShapes.size());
+        for (size_t i = 0; i < settings.m_subShapes.size(); ++i)
+        {
+            if (!m_subShapes[i].FromSettings(settings.m_subShapes[i], outResult))
+                return false;
+        }
+
+        // Make the sub shapes relative to the center of mass
+        m_centerOfMass = CalculateCenterOfMass();
+        for (SubShape& subShape : m_subShapes)
+            subShape.m_positionCOM -= m_centerOfMass;
+
+        CalculateInnerRadius();
+        return true;
+    }
+
+    Vec3 CompoundShape::CalculateCenterOfMass() const
+    {
+        Vec3 centerOfMass = Vec3::Zero();
+        float mass = 0.f;
+        for (const SubShape& subShape : m_subShapes)
+        {
+            const float subShapeMass = subShape.m_pShape->GetMassProperties().m_mass;
+            centerOfMass += subShape.m_positionCOM * subShapeMass;
+            mass += subShapeMass;
+        }
+
+        if (mass > 0.f)
+            centerOfMass /= mass;
+        return centerOfMass;
+    }
+
+    void CompoundShape::CalculateInnerRadius()
+    {
+        m_innerRadius = m_subShapes.empty() ? 0.f : FLT_MAX;
+        for (const SubShape& subShape : m_subShapes)
+            m_innerRadius = math::Min(m_innerRadius, subShape.m_pShape->GetInnerRadius());
+    }
+
+    void CompoundShape::CastCompoundVsShape(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape,
+        const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector)
+    {
+        NES_ASSERT(shapeCast.m_pShape->GetType() == EShapeType::Compound);
+        const CompoundShape* pCompound = checked_cast<const CompoundShape*>(shapeCast.m_pShape);
+        const uint subShapeBits = pCompound->GetSubShapeIDBits();
+
+        // Cast each of the sub shapes, there is no early out on the bounds of the sub shapes since they all move
+        // along the same direction.
+        for (uint i = 0; i < pCompound->GetNumSubShapes(); ++i)
+        {
+            const SubShape& subShape = pCompound->m_subShapes[i];
+            NES_ASSERT(subShape.IsValidScale(shapeCast.m_scale));
+
+            const Mat44 transform = shapeCast.m_centerOfMassStart * subShape.GetLocalTransformNoScale(shapeCast.m_scale);
+            const ShapeCast subShapeCast(subShape.m_pShape, subShape.TransformScale(shapeCast.m_scale), transform, shapeCast.m_direction);
+            CollisionSolver::CastShapeVsShapeLocalSpace(subShapeCast, shapeCastSettings, pShape, scale, shapeFilter, centerOfMassTransform2, subShapeIDCreator1.PushID(i, subShapeBits), subShapeIDCreator2, collector);
+
+            if (collector.ShouldEarlyOut())
+                break;
+        }
+    }
+
+    void CompoundShape::Register()
+    {
+        for (const EShapeSubType compoundType : kCompoundSubShapeTypes)
+        {
+            for (const EShapeSubType subType : kAllSubShapeTypes)
+                CollisionSolver::RegisterCastShape(compoundType, subType, CastCompoundVsShape);
+        }
+    }
+}
@@ -0,0 +1,293 @@
+// CompoundShape.h
+#pragma once
+#include "Shape.h"
+#include "SubShapeID.h"
+
+namespace nes
+{
+    struct CollideShapeSettings;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Base class for the settings of a compound shape, a shape that consists of other shapes.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShapeSettings : public ShapeSettings
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : A sub shape of the compound. Either m_pShape or m_pShapePtr should be set.
+        //----------------------------------------------------------------------------------------------------
+        struct SubShapeSettings
+        {
+            ConstStrongPtr<ShapeSettings>   m_pShape;                           /// Settings to create the sub shape with.
+            ConstStrongPtr<Shape>           m_pShapePtr;                        /// Already created sub shape, used instead of m_pShape when set.
+            Vec3                            m_position = Vec3::Zero();          /// Position of the sub shape, relative to the origin of the compound.
+            Quat                            m_rotation = Quat::Identity();      /// Rotation of the sub shape, relative to the compound.
+            uint32                          m_userData = 0;                     /// User data of the sub shape, see CompoundShape::GetCompoundUserData().
+        };
+
+        std::vector<SubShapeSettings>       m_subShapes{};
+
+    public:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Add a sub shape that will be created from settings.
+        //----------------------------------------------------------------------------------------------------
+        void                AddShape(const Vec3& position, const Quat& rotation, const ShapeSettings* pShape, const uint32 userData = 0);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Add a sub shape that has already been created.
+        //----------------------------------------------------------------------------------------------------
+        void                AddShape(const Vec3& position, const Quat& rotation, const Shape* pShape, const uint32 userData = 0);
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Base class for shapes that consist of other shapes. Each sub shape has a position and
+    ///     rotation relative to the center of mass of the compound. A sub shape is addressed by pushing its
+    ///     index onto the SubShapeID, using GetSubShapeIDBits() bits.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShape : public Shape
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : A sub shape of the compound, with its transform relative to the center of mass of the
+        ///     compound.
+        //----------------------------------------------------------------------------------------------------
+        struct SubShape
+        {
+            ConstStrongPtr<Shape>   m_pShape;
+            Vec3                    m_positionCOM = Vec3::Zero();       /// Position of the center of mass of the sub shape, relative to the center of mass of the compound.
+            Quat                    m_rotation = Quat::Identity();      /// Rotation of the sub shape, relative to the compound.
+            uint32                  m_userData = 0;
+            bool                    m_isRotationIdentity = true;        /// Used to skip the scale checks when the sub shape is not rotated.
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Initialize the sub shape from settings. The position is relative to the origin of the
+            ///     compound until the center of mass of the compound is known.
+            /// @returns : False if the sub shape could not be created, in which case outResult has the error.
+            //----------------------------------------------------------------------------------------------------
+            bool            FromSettings(const CompoundShapeSettings::SubShapeSettings& settings, ShapeResult& outResult);
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Set the transform of the sub shape.
+            ///	@param position : Position of the origin of the sub shape, relative to the origin of the compound.
+            ///	@param rotation : Rotation of the sub shape.
+            ///	@param centerOfMass : Center of mass of the compound.
+            //----------------------------------------------------------------------------------------------------
+            void            SetTransform(const Vec3& position, const Quat& rotation, const Vec3& centerOfMass);
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Get the position of the origin of the sub shape, relative to the center of mass of the compound.
+            //----------------------------------------------------------------------------------------------------
+            inline Vec3     GetPosition() const                                 { return m_positionCOM - m_rotation * m_pShape->GetCenterOfMass(); }
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Get the transform of the sub shape relative to the compound, when the compound has 'scale'.
+            ///     The scale itself is not part of the transform, see TransformScale().
+            //----------------------------------------------------------------------------------------------------
+            inline Mat44    GetLocalTransformNoScale(const Vec3& scale) const   { return Mat44::MakeRotationTranslation(m_rotation, scale * m_positionCOM); }
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Test if the scale of the compound can be expressed as a scale of this sub shape.
+            //----------------------------------------------------------------------------------------------------
+            bool            IsValidScale(const Vec3& scale) const;
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Convert the scale of the compound to the scale of this sub shape.
+            //----------------------------------------------------------------------------------------------------
+            Vec3            TransformScale(const Vec3& scale) const;
+        };
+
+        using SubShapes = std::vector<SubShape>;
+
+    public:
+        explicit CompoundShape(const EShapeSubType subType) : Shape(EShapeType::Compound, subType) {}
+        CompoundShape(const EShapeSubType subType, const ShapeSettings& settings, ShapeResult& outResult) : Shape(EShapeType::Compound, subType, settings, outResult) {}
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : A compound must be static if any of its sub shapes must be static.
+        /// @see : Shape::MustBeStatic()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            MustBeStatic() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetCenterOfMass()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            GetCenterOfMass() const override        { return m_centerOfMass; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetLocalBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetLocalBounds() const override         { return m_localBounds; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Combines the world bounds of the sub shapes when there are only a few, which is tighter
+        ///     than transforming the local bounds.
+        /// @see : Shape::GetWorldBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetWorldBounds(const Mat44& centerOfMassTransform, const Vec3& scale) const override;
+        using Shape::GetWorldBounds;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSubSShapeIDBitsRecursive()
+        //----------------------------------------------------------------------------------------------------
+        virtual unsigned        GetSubSShapeIDBitsRecursive() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : The smallest inner radius of the sub shapes.
+        /// @see : Shape::GetInnerRadius()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetInnerRadius() const override         { return m_innerRadius; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetMassProperties()
+        //----------------------------------------------------------------------------------------------------
+        virtual MassProperties  GetMassProperties() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetLeafShape()
+        //----------------------------------------------------------------------------------------------------
+        virtual const Shape*    GetLeafShape(const SubShapeID& subShapeID, SubShapeID& outRemainder) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSurfaceNormal()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            GetSurfaceNormal(const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSupportingFace()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction, const Vec3& scale, const Mat44& centerOfMassTransform, SupportingFace& outVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSubShapeUserData()
+        //----------------------------------------------------------------------------------------------------
+        virtual uint64_t        GetSubShapeUserData(const SubShapeID& subShapeID) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSubShapeTransformedShape()
+        //----------------------------------------------------------------------------------------------------
+        virtual TransformedShape GetSubShapeTransformedShape(const SubShapeID& subShapeID, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale, SubShapeID& outRemainder) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::TransformShape()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            TransformShape(const Mat44& centerOfMassTransform, TransformedShapeCollector& collector) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Not supported, use CollectTransformedShapes() to get the leaf shapes first.
+        /// @see : Shape::GetTrianglesStart()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Not supported, use CollectTransformedShapes() to get the leaf shapes first.
+        /// @see : Shape::GetTrianglesNext()
+        //----------------------------------------------------------------------------------------------------
+        virtual int             GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested, Float3* outTriangleVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetVolume()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetVolume() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : The scale is only valid if it can be passed on to every (rotated) sub shape.
+        /// @see : Shape::IsValidScale()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            IsValidScale(const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::MakeScaleValid()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            MakeScaleValid(const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of sub shapes in the compound.
+        //----------------------------------------------------------------------------------------------------
+        inline uint             GetNumSubShapes() const                 { return static_cast<uint>(m_subShapes.size()); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get a sub shape by index.
+        //----------------------------------------------------------------------------------------------------
+        inline const SubShape&  GetSubShape(const uint index) const     { return m_subShapes[index]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get all sub shapes.
+        //----------------------------------------------------------------------------------------------------
+        inline const SubShapes& GetSubShapes() const                    { return m_subShapes; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the user data of the sub shape at 'index'.
+        //----------------------------------------------------------------------------------------------------
+        inline uint32           GetCompoundUserData(const uint index) const { return m_subShapes[index].m_userData; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the user data of the sub shape at 'index'.
+        //----------------------------------------------------------------------------------------------------
+        inline void             SetCompoundUserData(const uint index, const uint32 userData) { m_subShapes[index].m_userData = userData; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of bits used to encode the index of a sub shape in a SubShapeID.
+        //----------------------------------------------------------------------------------------------------
+        inline uint             GetSubShapeIDBits() const
+        {
+            // Enough bits to encode the indices [0, n - 1]
+            const uint32 numSubShapes = static_cast<uint32>(m_subShapes.size());
+            return numSubShapes <= 1 ? 0 : 32 - math::CountLeadingZeros(numSubShapes - 1);
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the index of the sub shape that a SubShapeID points to. The remainder is the part of
+        ///     the SubShapeID that is relative to the sub shape.
+        /// @note : The index can be out of range when the SubShapeID was created before sub shapes were removed.
+        //----------------------------------------------------------------------------------------------------
+        inline uint32           GetSubShapeIndexFromID(const SubShapeID& subShapeID, SubShapeID& outRemainder) const
+        {
+            return subShapeID.PopID(GetSubShapeIDBits(), outRemainder);
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Register shape functions within the registry. This registers casting a compound against
+        ///     any other shape, the derived compounds register the other directions.
+        //----------------------------------------------------------------------------------------------------
+        static void             Register();
+
+    protected:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create the sub shapes from settings, calculate the center of mass of the compound and move
+        ///     the sub shapes so that they are relative to it.
+        /// @returns : False if any of the sub shapes could not be created, in which case outResult has the error.
+        //----------------------------------------------------------------------------------------------------
+        bool                    CreateSubShapes(const CompoundShapeSettings& settings, ShapeResult& outResult);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Calculate the center of mass of the sub shapes, weighted by their mass.
+        //----------------------------------------------------------------------------------------------------
+        Vec3                    CalculateCenterOfMass() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Recalculate the cached inner radius from the sub shapes.
+        //----------------------------------------------------------------------------------------------------
+        void                    CalculateInnerRadius();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Casts each sub shape of the compound
+        ///     against the other shape.
+        //----------------------------------------------------------------------------------------------------
+        static void             CastCompoundVsShape(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape, const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector);
+
+        /// Visitors that are shared between the compound shapes, see CompoundShapeVisitors.h.
+        class CastRayClosestVisitor;
+        class CastRayCollectorVisitor;
+        class CollidePointVisitor;
+        class CollectTransformedShapesVisitor;
+        class CollideCompoundVsShapeVisitor;
+        class CollideShapeVsCompoundVisitor;
+        class CastShapeVsCompoundVisitor;
+
+    protected:
+        SubShapes               m_subShapes{};
+        AABox                   m_localBounds{};
+        Vec3                    m_centerOfMass = Vec3::Zero();
+        float                   m_innerRadius = FLT_MAX;
+    };
+}
@@ -0,0 +1,383 @@
+// CompoundShapeVisitors.h
+#pragma once
+#include "CompoundShape.h"
+#include "Nessie/Geometry/AABoxSIMD.h"
+#include "Nessie/Geometry/OrientedBox.h"
+#include "Nessie/Geometry/RayAABox.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/CollidePointResult.h"
+#include "Nessie/Physics/Collision/CollideShape.h"
+#include "Nessie/Physics/Collision/CollisionSolver.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Physics/Collision/ShapeCast.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+
+//----------------------------------------------------------------------------------------------------
+//	NOTES:
+//  These visitors are shared by the compound shapes, which walk their sub shapes in their own way
+//  (StaticCompoundShape::WalkTree(), MutableCompoundShape::WalkSubShapes()). A visitor implements:
+//  - static constexpr bool kTestsDistance : True if TestBounds() returns the fraction at which a cast hits
+//      each box, in which case boxes are visited closest first and skipped when they are beyond
+//      GetEarlyOutFraction(). False if TestBounds() returns which boxes overlap.
+//  - bool ShouldAbort() const : Return true to stop visiting sub shapes.
+//  - float GetEarlyOutFraction() const : Only needed when kTestsDistance is true.
+//  - Vec4Reg/UVec4Reg TestBounds(minX, minY, minZ, maxX, maxY, maxZ) const : Test the bounds of 4 sub shapes
+//      or nodes, in the unscaled space of the compound.
+//  - void VisitShape(const SubShape& subShape, uint32 subShapeIndex) : Visit a sub shape whose bounds passed.
+//----------------------------------------------------------------------------------------------------
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Finds the closest hit of a ray with the sub shapes.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShape::CastRayClosestVisitor
+    {
+    public:
+        static constexpr bool kTestsDistance = true;
+
+        CastRayClosestVisitor(const RayCast& ray, const CompoundShape& shape, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult)
+            : m_ray(ray)
+            , m_invDirection(ray.m_direction)
+            , m_subShapeIDCreator(subShapeIDCreator)
+            , m_hit(hitResult)
+            , m_subShapeBits(shape.GetSubShapeIDBits())
+        {
+            //
+        }
+
+        bool ShouldAbort() const                            { return m_hit.m_fraction <= 0.f; }
+        float GetEarlyOutFraction() const                   { return m_hit.m_fraction; }
+
+        Vec4Reg TestBounds(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ) const
+        {
+            return RayAABox4(m_ray.m_origin, m_invDirection, minX, minY, minZ, maxX, maxY, maxZ);
+        }
+
+        void VisitShape(const SubShape& subShape, const uint32 subShapeIndex)
+        {
+            // Transform the ray to the space of the sub shape
+            const Mat44 transform = Mat44::MakeInverseRotationTranslation(subShape.m_rotation, subShape.m_positionCOM);
+            if (subShape.m_pShape->CastRay(m_ray.Transformed(transform), m_subShapeIDCreator.PushID(subShapeIndex, m_subShapeBits), m_hit))
+                m_didHit = true;
+        }
+
+        RayCast                     m_ray;
+        RayInvDirection             m_invDirection;
+        const SubShapeIDCreator&    m_subShapeIDCreator;
+        RayCastResult&              m_hit;
+        uint                        m_subShapeBits;
+        bool                        m_didHit = false;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Reports all hits of a ray with the sub shapes to a collector.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShape::CastRayCollectorVisitor
+    {
+    public:
+        static constexpr bool kTestsDistance = true;
+
+        CastRayCollectorVisitor(const RayCast& ray, const RayCastSettings& settings, const CompoundShape& shape, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter)
+            : m_ray(ray)
+            , m_invDirection(ray.m_direction)
+            , m_settings(settings)
+            , m_subShapeIDCreator(subShapeIDCreator)
+            , m_collector(collector)
+            , m_shapeFilter(shapeFilter)
+            , m_subShapeBits(shape.GetSubShapeIDBits())
+        {
+            //
+        }
+
+        bool ShouldAbort() const                            { return m_collector.ShouldEarlyOut(); }
+        float GetEarlyOutFraction() const                   { return m_collector.GetEarlyOutFraction(); }
+
+        Vec4Reg TestBounds(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ) const
+        {
+            return RayAABox4(m_ray.m_origin, m_invDirection, minX, minY, minZ, maxX, maxY, maxZ);
+        }
+
+        void VisitShape(const SubShape& subShape, const uint32 subShapeIndex)
+        {
+            const Mat44 transform = Mat44::MakeInverseRotationTranslation(subShape.m_rotation, subShape.m_positionCOM);
+            subShape.m_pShape->CastRay(m_ray.Transformed(transform), m_settings, m_subShapeIDCreator.PushID(subShapeIndex, m_subShapeBits), m_collector, m_shapeFilter);
+        }
+
+        RayCast                     m_ray;
+        RayInvDirection             m_invDirection;
+        const RayCastSettings&      m_settings;
+        const SubShapeIDCreator&    m_subShapeIDCreator;
+        CastRayCollector&           m_collector;
+        const ShapeFilter&          m_shapeFilter;
+        uint                        m_subShapeBits;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Reports the sub shapes that contain a point.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShape::CollidePointVisitor
+    {
+    public:
+        static constexpr bool kTestsDistance = false;
+
+        CollidePointVisitor(const Vec3& point, const CompoundShape& shape, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector, const ShapeFilter& shapeFilter)
+            : m_point(point)
+            , m_subShapeIDCreator(subShapeIDCreator)
+            , m_collector(collector)
+            , m_shapeFilter(shapeFilter)
+            , m_subShapeBits(shape.GetSubShapeIDBits())
+        {
+            //
+        }
+
+        bool ShouldAbort() const                            { return m_collector.ShouldEarlyOut(); }
+
+        UVec4Reg TestBounds(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ) const
+        {
+            return math::AABox4VsPoint(m_point, minX, minY, minZ, maxX, maxY, maxZ);
+        }
+
+        void VisitShape(const SubShape& subShape, const uint32 subShapeIndex)
+        {
+            const Mat44 transform = Mat44::MakeInverseRotationTranslation(subShape.m_rotation, subShape.m_positionCOM);
+            subShape.m_pShape->CollidePoint(transform.TransformPoint(m_point), m_subShapeIDCreator.PushID(subShapeIndex, m_subShapeBits), m_collector, m_shapeFilter);
+        }
+
+        Vec3                        m_point;
+        const SubShapeIDCreator&    m_subShapeIDCreator;
+        CollidePointCollector&      m_collector;
+        const ShapeFilter&          m_shapeFilter;
+        uint                        m_subShapeBits;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Collects the leaf shapes of the sub shapes that overlap a world space box.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShape::CollectTransformedShapesVisitor
+    {
+    public:
+        static constexpr bool kTestsDistance = false;
+
+        CollectTransformedShapesVisitor(const AABox& box, const CompoundShape& shape, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale, const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter)
+            : m_box(box)
+            , m_localBox(Mat44::MakeInverseRotationTranslation(rotation, positionCOM), box)
+            , m_positionCOM(positionCOM)
+            , m_rotation(rotation)
+            , m_scale(scale)
+            , m_subShapeIDCreator(subShapeIDCreator)
+            , m_collector(collector)
+            , m_shapeFilter(shapeFilter)
+            , m_subShapeBits(shape.GetSubShapeIDBits())
+        {
+            //
+        }
+
+        bool ShouldAbort() const                            { return m_collector.ShouldEarlyOut(); }
+
+        UVec4Reg TestBounds(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ) const
+        {
+            Vec4Reg scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ;
+            math::AABox4Scale(m_scale, minX, minY, minZ, maxX, maxY, maxZ, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+            return math::AABox4VsBox(m_localBox, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+        }
+
+        void VisitShape(const SubShape& subShape, const uint32 subShapeIndex)
+        {
+            // Calculate the world transform of the sub shape and recurse into it
+            const Vec3 position = m_positionCOM + m_rotation * (m_scale * subShape.m_positionCOM);
+            const Quat rotation = m_rotation * subShape.m_rotation;
+            subShape.m_pShape->CollectTransformedShapes(m_box, position, rotation, subShape.TransformScale(m_scale), m_subShapeIDCreator.PushID(subShapeIndex, m_subShapeBits), m_collector, m_shapeFilter);
+        }
+
+        AABox                       m_box;
+        OrientedBox                 m_localBox;             /// The box in the space of the compound.
+        Vec3                        m_positionCOM;
+        Quat                        m_rotation;
+        Vec3                        m_scale;
+        const SubShapeIDCreator&    m_subShapeIDCreator;
+        TransformedShapeCollector&  m_collector;
+        const ShapeFilter&          m_shapeFilter;
+        uint                        m_subShapeBits;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Collides the sub shapes of compound 1 that overlap the bounds of shape 2 with shape 2.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShape::CollideCompoundVsShapeVisitor
+    {
+    public:
+        static constexpr bool kTestsDistance = false;
+
+        CollideCompoundVsShapeVisitor(const CompoundShape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter)
+            : m_pShape2(pShape2)
+            , m_scale1(scale1)
+            , m_scale2(scale2)
+            , m_centerOfMassTransform1(centerOfMassTransform1)
+            , m_centerOfMassTransform2(centerOfMassTransform2)
+            , m_subShapeIDCreator1(subShapeIDCreator1)
+            , m_subShapeIDCreator2(subShapeIDCreator2)
+            , m_collideShapeSettings(collideShapeSettings)
+            , m_collector(collector)
+            , m_shapeFilter(shapeFilter)
+            , m_subShapeBits(pShape1->GetSubShapeIDBits())
+        {
+            // Get the bounds of shape 2 in the space of compound 1
+            const Mat44 transform2To1 = centerOfMassTransform1.InversedRotationTranslation() * centerOfMassTransform2;
+            m_boundsOf2InSpaceOf1 = pShape2->GetLocalBounds().Scaled(scale2).Transformed(transform2To1);
+            m_boundsOf2InSpaceOf1.ExpandBy(Vec3::Replicate(collideShapeSettings.m_maxSeparationDistance));
+        }
+
+        bool ShouldAbort() const                            { return m_collector.ShouldEarlyOut(); }
+
+        UVec4Reg TestBounds(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ) const
+        {
+            Vec4Reg scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ;
+            math::AABox4Scale(m_scale1, minX, minY, minZ, maxX, maxY, maxZ, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+            return math::AABox4VsAABox(m_boundsOf2InSpaceOf1, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+        }
+
+        void VisitShape(const SubShape& subShape, const uint32 subShapeIndex)
+        {
+            NES_ASSERT(subShape.IsValidScale(m_scale1));
+
+            const Mat44 transform1 = m_centerOfMassTransform1 * subShape.GetLocalTransformNoScale(m_scale1);
+            CollisionSolver::CollideShapeVsShape(subShape.m_pShape, m_pShape2, subShape.TransformScale(m_scale1), m_scale2, transform1, m_centerOfMassTransform2, m_subShapeIDCreator1.PushID(subShapeIndex, m_subShapeBits), m_subShapeIDCreator2, m_collideShapeSettings, m_collector, m_shapeFilter);
+        }
+
+        const Shape*                m_pShape2;
+        Vec3                        m_scale1;
+        Vec3                        m_scale2;
+        Mat44                       m_centerOfMassTransform1;
+        Mat44                       m_centerOfMassTransform2;
+        const SubShapeIDCreator&    m_subShapeIDCreator1;
+        const SubShapeIDCreator&    m_subShapeIDCreator2;
+        const CollideShapeSettings& m_collideShapeSettings;
+        CollideShapeCollector&      m_collector;
+        const ShapeFilter&          m_shapeFilter;
+        AABox                       m_boundsOf2InSpaceOf1;
+        uint                        m_subShapeBits;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Collides shape 1 with the sub shapes of compound 2 that overlap the bounds of shape 1.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShape::CollideShapeVsCompoundVisitor
+    {
+    public:
+        static constexpr bool kTestsDistance = false;
+
+        CollideShapeVsCompoundVisitor(const Shape* pShape1, const CompoundShape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter)
+            : m_pShape1(pShape1)
+            , m_scale1(scale1)
+            , m_scale2(scale2)
+            , m_centerOfMassTransform1(centerOfMassTransform1)
+            , m_centerOfMassTransform2(centerOfMassTransform2)
+            , m_subShapeIDCreator1(subShapeIDCreator1)
+            , m_subShapeIDCreator2(subShapeIDCreator2)
+            , m_collideShapeSettings(collideShapeSettings)
+            , m_collector(collector)
+            , m_shapeFilter(shapeFilter)
+            , m_subShapeBits(pShape2->GetSubShapeIDBits())
+        {
+            // Get the bounds of shape 1 in the space of compound 2
+            const Mat44 transform1To2 = centerOfMassTransform2.InversedRotationTranslation() * centerOfMassTransform1;
+            m_boundsOf1InSpaceOf2 = pShape1->GetLocalBounds().Scaled(scale1).Transformed(transform1To2);
+            m_boundsOf1InSpaceOf2.ExpandBy(Vec3::Replicate(collideShapeSettings.m_maxSeparationDistance));
+        }
+
+        bool ShouldAbort() const                            { return m_collector.ShouldEarlyOut(); }
+
+        UVec4Reg TestBounds(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ) const
+        {
+            Vec4Reg scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ;
+            math::AABox4Scale(m_scale2, minX, minY, minZ, maxX, maxY, maxZ, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+            return math::AABox4VsAABox(m_boundsOf1InSpaceOf2, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+        }
+
+        void VisitShape(const SubShape& subShape, const uint32 subShapeIndex)
+        {
+            NES_ASSERT(subShape.IsValidScale(m_scale2));
+
+            const Mat44 transform2 = m_centerOfMassTransform2 * subShape.GetLocalTransformNoScale(m_scale2);
+            CollisionSolver::CollideShapeVsShape(m_pShape1, subShape.m_pShape, m_scale1, subShape.TransformScale(m_scale2), m_centerOfMassTransform1, transform2, m_subShapeIDCreator1, m_subShapeIDCreator2.PushID(subShapeIndex, m_subShapeBits), m_collideShapeSettings, m_collector, m_shapeFilter);
+        }
+
+        const Shape*                m_pShape1;
+        Vec3                        m_scale1;
+        Vec3                        m_scale2;
+        Mat44                       m_centerOfMassTransform1;
+        Mat44                       m_centerOfMassTransform2;
+        const SubShapeIDCreator&    m_subShapeIDCreator1;
+        const SubShapeIDCreator&    m_subShapeIDCreator2;
+        const CollideShapeSettings& m_collideShapeSettings;
+        CollideShapeCollector&      m_collector;
+        const ShapeFilter&          m_shapeFilter;
+        AABox                       m_boundsOf1InSpaceOf2;
+        uint                        m_subShapeBits;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Casts a shape against the sub shapes of a compound that its swept bounds pass through,
+    ///     closest sub shapes first. The shape cast is in the space of the compound.
+    //----------------------------------------------------------------------------------------------------
+    class CompoundShape::CastShapeVsCompoundVisitor
+    {
+    public:
+        static constexpr bool kTestsDistance = true;
+
+        CastShapeVsCompoundVisitor(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const CompoundShape* pShape, const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector)
+            : m_shapeCast(shapeCast)
+            , m_shapeCastSettings(shapeCastSettings)
+            , m_shapeFilter(shapeFilter)
+            , m_collector(collector)
+            , m_centerOfMassTransform2(centerOfMassTransform2)
+            , m_subShapeIDCreator1(subShapeIDCreator1)
+            , m_subShapeIDCreator2(subShapeIDCreator2)
+            , m_boxCenter(shapeCast.m_shapeWorldBounds.Center())
+            , m_boxExtent(shapeCast.m_shapeWorldBounds.Extent())
+            , m_invDirection(shapeCast.m_direction)
+            , m_scale(scale)
+            , m_subShapeBits(pShape->GetSubShapeIDBits())
+        {
+            //
+        }
+
+        bool ShouldAbort() const                            { return m_collector.ShouldEarlyOut(); }
+        float GetEarlyOutFraction() const                   { return m_collector.GetPositiveEarlyOutFraction(); }
+
+        Vec4Reg TestBounds(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ) const
+        {
+            // Scale the bounds, and enlarge them by the extent of the cast shape.
+            Vec4Reg scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ;
+            math::AABox4Scale(m_scale, minX, minY, minZ, maxX, maxY, maxZ, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+            math::AABox4EnlargeWithExtent(m_boxExtent, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+
+            // Cast the center of the box against the enlarged bounds.
+            return RayAABox4(m_boxCenter, m_invDirection, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+        }
+
+        void VisitShape(const SubShape& subShape, const uint32 subShapeIndex)
+        {
+            NES_ASSERT(subShape.IsValidScale(m_scale));
+
+            // Move the shape cast to the space of the sub shape
+            const Mat44 localTransform = subShape.GetLocalTransformNoScale(m_scale);
+            const ShapeCast localShapeCast = m_shapeCast.PostTransformed(localTransform.InversedRotationTranslation());
+            CollisionSolver::CastShapeVsShapeLocalSpace(localShapeCast, m_shapeCastSettings, subShape.m_pShape, subShape.TransformScale(m_scale), m_shapeFilter, m_centerOfMassTransform2 * localTransform, m_subShapeIDCreator1, m_subShapeIDCreator2.PushID(subShapeIndex, m_subShapeBits), m_collector);
+        }
+
+        const ShapeCast&            m_shapeCast;
+        const ShapeCastSettings&    m_shapeCastSettings;
+        const ShapeFilter&          m_shapeFilter;
+        CastShapeCollector&         m_collector;
+        Mat44                       m_centerOfMassTransform2;
+        const SubShapeIDCreator&    m_subShapeIDCreator1;
+        const SubShapeIDCreator&    m_subShapeIDCreator2;
+        Vec3                        m_boxCenter;
+        Vec3                        m_boxExtent;
+        RayInvDirection             m_invDirection;
+        Vec3                        m_scale;
+        uint                        m_subShapeBits;
+    };
+}
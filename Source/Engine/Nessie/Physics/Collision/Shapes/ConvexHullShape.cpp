@@ -0,0 +1,707 @@
+// ConvexHullShape.cpp
+#include "ConvexHullShape.h"
+
+#include <algorithm>
+#include "Nessie/Geometry/ConvexHull3.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/CollidePointResult.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+#include "Nessie/Physics/Collision/Shapes/GetTrianglesContext.h"
+#include "Nessie/Physics/Collision/Shapes/ScaleHelpers.h"
+#include "Nessie/Physics/StateRecorder.h"
+
+namespace nes
+{
+    /// Hulls with this many vertices or fewer test all vertices in GetSupportPoint(), which is cheaper than walking the adjacency graph.
+    static constexpr uint kBruteForceSupportMaxPoints = 16;
+
+    /// Header values of the binary state, see ConvexHullShape::SaveBinaryState().
+    static constexpr uint32 kBinaryStateMagic = 0x4C55484E; // "NHUL"
+    static constexpr uint32 kBinaryStateVersion = 1;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Write the number of values followed by the values.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Type>
+    static void WriteArray(StateRecorder& stream, const std::vector<Type>& values)
+    {
+        stream.Write(static_cast<uint32>(values.size()));
+        for (const Type& value : values)
+            stream.Write(value);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Read an array that was written with WriteArray(). Values are appended one at a time, so a
+    ///     corrupt count fails at the end of the stream instead of allocating the whole count up front.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Type>
+    static bool ReadArray(StateRecorder& stream, std::vector<Type>& outValues)
+    {
+        uint32 count = 0;
+        stream.Read(count);
+
+        outValues.clear();
+        for (uint32 i = 0; i < count && !stream.IsFailed(); ++i)
+        {
+            Type value {};
+            stream.Read(value);
+            outValues.push_back(value);
+        }
+        return !stream.IsFailed();
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Support function for the hull. The convex radius is always 0, so the result is the same
+    ///     for all support modes.
+    //----------------------------------------------------------------------------------------------------
+    class ConvexHullShape::HullNoConvex final : public Support
+    {
+    public:
+        HullNoConvex(const ConvexHullShape* pShape, const Vec3& scale)
+            : m_pShape(pShape)
+            , m_scale(scale)
+        {
+            static_assert(sizeof(HullNoConvex) <= sizeof(SupportBuffer), "Buffer size too small");
+            NES_ASSERT(math::IsAligned(this, alignof(HullNoConvex)));
+        }
+
+        virtual Vec3 GetSupport(const Vec3& direction) const override
+        {
+            // The support point of the scaled hull in direction D is the scaled support point of the
+            // unscaled hull in direction (Scale * D).
+            return m_scale * m_pShape->GetSupportPoint(m_scale * direction);
+        }
+
+        virtual float GetConvexRadius() const override
+        {
+            return 0.f;
+        }
+
+    private:
+        const ConvexHullShape*  m_pShape;
+        Vec3                    m_scale;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Returns the faces of the hull as a fan of triangles.
+    //----------------------------------------------------------------------------------------------------
+    class ConvexHullShape::CHSGetTrianglesContext
+    {
+    public:
+        CHSGetTrianglesContext(const Vec3& positionCOM, const Quat& rotation, const Vec3& scale)
+            : m_localToWorld(Mat44::MakeRotationTranslation(rotation, positionCOM) * Mat44::MakeScale(scale))
+            , m_isInsideOut(ScaleHelpers::IsInsideOut(scale))
+        {
+            //
+        }
+
+        Mat44               m_localToWorld;
+        bool                m_isInsideOut;
+        uint                m_currentFace = 0;
+        uint                m_currentVertex = 1;
+    };
+
+    ShapeSettings::ShapeResult ConvexHullShapeSettings::Create() const
+    {
+        if (m_cachedResult.IsEmpty())
+        {
+            StrongPtr<Shape> pShape = new ConvexHullShape(*this, m_cachedResult);
+        }
+        return m_cachedResult;
+    }
+
+    ConvexHullShape::ConvexHullShape(const ConvexHullShapeSettings& settings, ShapeResult& outResult)
+        : ConvexShape(EShapeSubType::ConvexHull, settings, outResult)
+    {
+        // Build the hull
+        ConvexHull3 hull;
+        const ConvexHull3::EResult result = hull.TrySolve(settings.m_points, kMaxPointsInHull, settings.m_hullTolerance);
+        if (result == ConvexHull3::EResult::TooFewPoints)
+        {
+            outResult.SetError("Need at least 4 points to create a Convex Hull!");
+            return;
+        }
+
+        if (result == ConvexHull3::EResult::Degenerate)
+        {
+            outResult.SetError("Failed to create Convex Hull: the points are colinear or coplanar!");
+            return;
+        }
+
+        // [Note]: MaxVerticesReached is not an error, the hull contains the points that were furthest apart.
+        const std::vector<int>& hullIndices = hull.GetHullIndices();
+        const std::vector<ConvexHull3::Face>& hullFaces = hull.GetFaces();
+        NES_ASSERT(hullIndices.size() <= static_cast<size_t>(kMaxPointsInHull));
+
+        // Remap the input indices to the compact vertex list.
+        std::vector<int> remap(settings.m_points.size(), -1);
+        m_points.reserve(hullIndices.size());
+        for (const int index : hullIndices)
+        {
+            remap[index] = static_cast<int>(m_points.size());
+            m_points.push_back(settings.m_points[index]);
+        }
+
+        // Calculate the volume, center of mass and inertia by splitting the hull into tetrahedrons that
+        // share a reference point inside the hull.
+        // See: "Explicit Exact Formulas for the 3-D Tetrahedron Inertia Tensor in Terms of its Vertex Coordinates" - F. Tonon.
+        Vec3 reference = Vec3::Zero();
+        for (const Vec3& point : m_points)
+            reference += point;
+        reference /= static_cast<float>(m_points.size());
+
+        float volume6 = 0.f;
+        Vec3 centerOfMass = Vec3::Zero();
+        float covariance[3][3] = {};
+        for (const ConvexHull3::Face& face : hullFaces)
+        {
+            const Vec3 p0 = settings.m_points[face.m_vertices[0]] - reference;
+            for (size_t i = 1; i + 1 < face.m_vertices.size(); ++i)
+            {
+                const Vec3 p1 = settings.m_points[face.m_vertices[i]] - reference;
+                const Vec3 p2 = settings.m_points[face.m_vertices[i + 1]] - reference;
+
+                // Six times the signed volume of the tetrahedron.
+                const float determinant = p0.Dot(p1.Cross(p2));
+                volume6 += determinant;
+                centerOfMass += determinant * (p0 + p1 + p2);
+
+                // Covariance of the tetrahedron relative to the reference point:
+                // det / 120 * (p0 p0^T + p1 p1^T + p2 p2^T + (p0 + p1 + p2) (p0 + p1 + p2)^T)
+                const Vec3 sum = p0 + p1 + p2;
+                for (int row = 0; row < 3; ++row)
+                {
+                    for (int column = 0; column < 3; ++column)
+                        covariance[row][column] += determinant / 120.f * (p0[row] * p0[column] + p1[row] * p1[column] + p2[row] * p2[column] + sum[row] * sum[column]);
+                }
+            }
+        }
+
+        if (volume6 <= 0.f)
+        {
+            outResult.SetError("Failed to create Convex Hull: the hull has no volume!");
+            return;
+        }
+
+        // The center of mass of a tetrahedron is the average of its 4 vertices, one of which is the reference point.
+        m_volume = volume6 / 6.f;
+        centerOfMass /= 4.f * volume6;
+        m_centerOfMass = reference + centerOfMass;
+
+        // Move the covariance to the center of mass (parallel axis theorem) and convert it to the inertia tensor.
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 3; ++column)
+                covariance[row][column] -= m_volume * centerOfMass[row] * centerOfMass[column];
+        }
+
+        const float trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+        Vec4 columns[3];
+        for (int column = 0; column < 3; ++column)
+        {
+            for (int row = 0; row < 3; ++row)
+                columns[column][row] = (row == column? trace : 0.f) - covariance[row][column];
+            columns[column][3] = 0.f;
+        }
+        m_inertia = Mat44(columns[0], columns[1], columns[2], Vec4(0.f, 0.f, 0.f, 1.f));
+
+        // Store the points relative to the center of mass.
+        for (Vec3& point : m_points)
+        {
+            point -= m_centerOfMass;
+            m_localBounds.Encapsulate(point);
+        }
+
+        // Store the faces and planes.
+        m_faces.reserve(hullFaces.size());
+        m_planes.reserve(hullFaces.size());
+        m_innerRadius = FLT_MAX;
+        for (const ConvexHull3::Face& hullFace : hullFaces)
+        {
+            Face& face = m_faces.emplace_back();
+            face.m_firstVertex = static_cast<uint16>(m_vertexIndices.size());
+            face.m_numVertices = static_cast<uint16>(hullFace.m_vertices.size());
+            for (const int index : hullFace.m_vertices)
+                m_vertexIndices.push_back(static_cast<uint8>(remap[index]));
+
+            const float constant = hullFace.m_constant + hullFace.m_normal.Dot(m_centerOfMass);
+            m_planes.emplace_back(hullFace.m_normal, constant);
+            m_innerRadius = math::Min(m_innerRadius, -constant);
+        }
+        m_innerRadius = math::Max(0.f, m_innerRadius);
+
+        BuildSupportData();
+        outResult.Set(this);
+    }
+
+    void ConvexHullShape::BuildSupportData()
+    {
+        const size_t numPoints = m_points.size();
+
+        // Each edge of a face connects two vertices. Every edge is shared by two faces, so only store it
+        // for the face that has it going from the lower to the higher index.
+        std::vector<std::vector<uint8>> neighbors(numPoints);
+        for (const Face& face : m_faces)
+        {
+            const uint8* pVertices = m_vertexIndices.data() + face.m_firstVertex;
+            for (uint16 i = 0; i < face.m_numVertices; ++i)
+            {
+                const uint8 start = pVertices[i];
+                const uint8 end = pVertices[(i + 1) % face.m_numVertices];
+                if (start < end)
+                {
+                    neighbors[start].push_back(end);
+                    neighbors[end].push_back(start);
+                }
+            }
+        }
+
+        m_adjacencyStart.resize(numPoints + 1);
+        m_adjacency.clear();
+        for (size_t i = 0; i < numPoints; ++i)
+        {
+            m_adjacencyStart[i] = static_cast<uint16>(m_adjacency.size());
+            m_adjacency.insert(m_adjacency.end(), neighbors[i].begin(), neighbors[i].end());
+        }
+        m_adjacencyStart[numPoints] = static_cast<uint16>(m_adjacency.size());
+
+        // Find the extreme vertices along each axis.
+        std::fill(std::begin(m_extremeVertices), std::end(m_extremeVertices), static_cast<uint8>(0));
+        for (size_t i = 1; i < numPoints; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (m_points[i][axis] < m_points[m_extremeVertices[2 * axis]][axis])
+                    m_extremeVertices[2 * axis] = static_cast<uint8>(i);
+                if (m_points[i][axis] > m_points[m_extremeVertices[2 * axis + 1]][axis])
+                    m_extremeVertices[2 * axis + 1] = static_cast<uint8>(i);
+            }
+        }
+    }
+
+    Vec3 ConvexHullShape::GetSupportPoint(const Vec3& direction) const
+    {
+        const uint numPoints = GetNumPoints();
+        if (numPoints <= kBruteForceSupportMaxPoints)
+        {
+            uint bestIndex = 0;
+            float bestDot = m_points[0].Dot(direction);
+            for (uint i = 1; i < numPoints; ++i)
+            {
+                const float dot = m_points[i].Dot(direction);
+                if (dot > bestDot)
+                {
+                    bestDot = dot;
+                    bestIndex = i;
+                }
+            }
+            return m_points[bestIndex];
+        }
+
+        // Start at the extreme vertex that is furthest in the direction.
+        uint bestIndex = m_extremeVertices[0];
+        float bestDot = m_points[bestIndex].Dot(direction);
+        for (int i = 1; i < 6; ++i)
+        {
+            const float dot = m_points[m_extremeVertices[i]].Dot(direction);
+            if (dot > bestDot)
+            {
+                bestDot = dot;
+                bestIndex = m_extremeVertices[i];
+            }
+        }
+
+        // Move to a better neighbor until there is none. Because the hull is convex, the local maximum is
+        // the global maximum.
+        for (bool improved = true; improved;)
+        {
+            improved = false;
+            for (uint i = m_adjacencyStart[bestIndex], end = m_adjacencyStart[bestIndex + 1]; i < end; ++i)
+            {
+                const uint neighbor = m_adjacency[i];
+                const float dot = m_points[neighbor].Dot(direction);
+                if (dot > bestDot)
+                {
+                    bestDot = dot;
+                    bestIndex = neighbor;
+                    improved = true;
+                }
+            }
+        }
+
+        return m_points[bestIndex];
+    }
+
+    MassProperties ConvexHullShape::GetMassProperties() const
+    {
+        const float density = GetDensity();
+
+        MassProperties props;
+        props.m_mass = density * m_volume;
+        props.m_inertia = density * m_inertia;
+        props.m_inertia.SetColumn4(3, Vec4(0.f, 0.f, 0.f, 1.f));
+        return props;
+    }
+
+    Vec3 ConvexHullShape::GetSurfaceNormal([[maybe_unused]] const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const
+    {
+        NES_ASSERT(subShapeID.IsEmpty(), "Invalid subshape ID");
+
+        // The closest face is the one with the largest signed distance.
+        const Plane* pBestPlane = &m_planes[0];
+        float bestDistance = pBestPlane->SignedDistanceTo(localSurfacePosition);
+        for (const Plane& plane : m_planes)
+        {
+            const float distance = plane.SignedDistanceTo(localSurfacePosition);
+            if (distance > bestDistance)
+            {
+                bestDistance = distance;
+                pBestPlane = &plane;
+            }
+        }
+
+        return pBestPlane->GetNormal();
+    }
+
+    bool ConvexHullShape::CastRayHelper(const RayCast& ray, float& outMinFraction, float& outMaxFraction) const
+    {
+        outMinFraction = -FLT_MAX;
+        outMaxFraction = FLT_MAX;
+
+        // Clip the ray's line against all planes.
+        for (const Plane& plane : m_planes)
+        {
+            const float distance = plane.SignedDistanceTo(ray.m_origin);
+            const float denominator = plane.GetNormal().Dot(ray.m_direction);
+            if (denominator == 0.f)
+            {
+                // The ray is parallel to the plane, it misses if it starts in front of it.
+                if (distance > 0.f)
+                    return false;
+                continue;
+            }
+
+            const float fraction = -distance / denominator;
+            if (denominator < 0.f)
+                outMinFraction = math::Max(outMinFraction, fraction);   // Entering the plane
+            else
+                outMaxFraction = math::Min(outMaxFraction, fraction);   // Leaving the plane
+
+            if (outMinFraction > outMaxFraction)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool ConvexHullShape::CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const
+    {
+        float minFraction, maxFraction;
+        if (CastRayHelper(ray, minFraction, maxFraction)
+            && maxFraction >= 0.f)  // End of ray should be inside the hull
+        {
+            const float fraction = math::Max(minFraction, 0.f);
+            if (fraction < hitResult.m_fraction)
+            {
+                hitResult.m_fraction = fraction;
+                hitResult.m_subShapeID2 = subShapeIDCreator.GetID();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ConvexHullShape::CastRay(const RayCast& ray, const RayCastSettings& settings,
+        const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        float minFraction, maxFraction;
+        if (CastRayHelper(ray, minFraction, maxFraction)
+            && maxFraction >= 0.f                               // End of ray should be inside the hull
+            && minFraction < collector.GetEarlyOutFraction())   // Start of ray should be before the early out fraction
+        {
+            RayCastResult hit;
+            hit.m_bodyID = TransformedShape::GetBodyID(collector.GetContext());
+            hit.m_subShapeID2 = subShapeIDCreator.GetID();
+
+            // Check front side
+            if (settings.m_treatConvexAsSolid || minFraction > 0.f)
+            {
+                hit.m_fraction = math::Max(0.f, minFraction);
+                collector.AddHit(hit);
+            }
+
+            // Check back side hit
+            if (settings.m_backfaceModeConvex == EBackFaceMode::CollideWithBackFaces
+                && maxFraction < collector.GetEarlyOutFraction())
+            {
+                hit.m_fraction = maxFraction;
+                collector.AddHit(hit);
+            }
+        }
+    }
+
+    void ConvexHullShape::CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator,
+        CollidePointCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test Shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        if (!m_localBounds.Contains(point))
+            return;
+
+        // The point needs to be behind all planes
+        for (const Plane& plane : m_planes)
+        {
+            if (plane.SignedDistanceTo(point) > 0.f)
+                return;
+        }
+
+        collector.AddHit({ TransformedShape::GetBodyID(collector.GetContext()), subShapeIDCreator.GetID() });
+    }
+
+    void ConvexHullShape::GetTrianglesStart(GetTrianglesContext& context, [[maybe_unused]] const AABox& box, const Vec3& positionCOM,
+        const Quat& rotation, const Vec3& scale) const
+    {
+        static_assert(sizeof(CHSGetTrianglesContext) <= sizeof(GetTrianglesContext), "GetTrianglesContext is too small!");
+        NES_ASSERT(math::IsAligned(&context, alignof(CHSGetTrianglesContext)));
+
+        new (&context) CHSGetTrianglesContext(positionCOM, rotation, scale);
+    }
+
+    int ConvexHullShape::GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested,
+        Float3* outTriangleVertices) const
+    {
+        NES_ASSERT(maxTrianglesRequested >= kGetTrianglesMinTrianglesRequested);
+
+        CHSGetTrianglesContext& chsContext = reinterpret_cast<CHSGetTrianglesContext&>(context);
+
+        // Triangulate each face as a fan around its first vertex.
+        int totalNumTriangles = 0;
+        while (totalNumTriangles < maxTrianglesRequested && chsContext.m_currentFace < GetNumFaces())
+        {
+            const Face& face = m_faces[chsContext.m_currentFace];
+            const uint8* pVertices = m_vertexIndices.data() + face.m_firstVertex;
+
+            const Vec3 v0 = chsContext.m_localToWorld.TransformPoint(m_points[pVertices[0]]);
+            const Vec3 v1 = chsContext.m_localToWorld.TransformPoint(m_points[pVertices[chsContext.m_currentVertex]]);
+            const Vec3 v2 = chsContext.m_localToWorld.TransformPoint(m_points[pVertices[chsContext.m_currentVertex + 1]]);
+
+            v0.StoreFloat3(outTriangleVertices++);
+            if (chsContext.m_isInsideOut)
+            {
+                // Store the triangle flipped
+                v2.StoreFloat3(outTriangleVertices++);
+                v1.StoreFloat3(outTriangleVertices++);
+            }
+            else
+            {
+                v1.StoreFloat3(outTriangleVertices++);
+                v2.StoreFloat3(outTriangleVertices++);
+            }
+            ++totalNumTriangles;
+
+            // Move to the next triangle
+            if (++chsContext.m_currentVertex + 1 >= face.m_numVertices)
+            {
+                ++chsContext.m_currentFace;
+                chsContext.m_currentVertex = 1;
+            }
+        }
+
+        // [TODO]:
+        // Store Materials
+
+        return totalNumTriangles;
+    }
+
+    const ConvexShape::Support* ConvexHullShape::GetSupportFunction([[maybe_unused]] ESupportMode mode, SupportBuffer& buffer,
+        const Vec3& scale) const
+    {
+        // [Note]: The hull has no convex radius, so all modes return the same support function.
+        return new (&buffer) HullNoConvex(this, scale);
+    }
+
+    void ConvexHullShape::GetSupportingFace([[maybe_unused]] const SubShapeID& subShapeID, const Vec3& direction, const Vec3& scale, const Mat44& centerOfMassTransform, SupportingFace& outVertices) const
+    {
+        NES_ASSERT(subShapeID.IsEmpty(), "Invalid subshape ID");
+
+        // Normals transform with the inverse of the scale. Find the face whose scaled normal is most
+        // opposite to the direction.
+        const Vec3 inverseScale = scale.Reciprocal();
+        uint bestFace = 0;
+        float bestDot = FLT_MAX;
+        for (uint i = 0; i < GetNumFaces(); ++i)
+        {
+            const float dot = direction.Dot((inverseScale * m_planes[i].GetNormal()).Normalized());
+            if (dot < bestDot)
+            {
+                bestDot = dot;
+                bestFace = i;
+            }
+        }
+
+        const Face& face = m_faces[bestFace];
+        const uint8* pVertices = m_vertexIndices.data() + face.m_firstVertex;
+        const uint numVertices = math::Min(static_cast<uint>(face.m_numVertices), static_cast<uint>(outVertices.capacity()));
+
+        // Transform to world space, the winding order needs to be flipped when the shape is inside out.
+        const Mat44 transform = centerOfMassTransform * Mat44::MakeScale(scale);
+        if (ScaleHelpers::IsInsideOut(scale))
+        {
+            for (uint i = numVertices; i > 0; --i)
+                outVertices.push_back(transform.TransformPoint(m_points[pVertices[i - 1]]));
+        }
+        else
+        {
+            for (uint i = 0; i < numVertices; ++i)
+                outVertices.push_back(transform.TransformPoint(m_points[pVertices[i]]));
+        }
+    }
+
+    void ConvexHullShape::SaveBinaryState(StateRecorder& stream) const
+    {
+        // Header
+        stream.Write(kBinaryStateMagic);
+        stream.Write(kBinaryStateVersion);
+
+        // Shape properties
+        stream.Write(GetDensity());
+        stream.Write(m_centerOfMass);
+        stream.Write(m_volume);
+        stream.Write(m_innerRadius);
+        stream.Write(m_localBounds.m_min);
+        stream.Write(m_localBounds.m_max);
+        for (uint column = 0; column < 3; ++column)
+            stream.Write(m_inertia.GetColumn3(column));
+
+        // Hull
+        WriteArray(stream, m_points);
+
+        stream.Write(static_cast<uint32>(m_faces.size()));
+        for (size_t i = 0; i < m_faces.size(); ++i)
+        {
+            stream.Write(m_faces[i].m_firstVertex);
+            stream.Write(m_faces[i].m_numVertices);
+            stream.Write(m_planes[i].GetNormal());
+            stream.Write(m_planes[i].GetConstant());
+        }
+
+        WriteArray(stream, m_vertexIndices);
+
+        // Support data
+        WriteArray(stream, m_adjacencyStart);
+        WriteArray(stream, m_adjacency);
+        for (const uint8 index : m_extremeVertices)
+            stream.Write(index);
+    }
+
+    ShapeSettings::ShapeResult ConvexHullShape::RestoreFromBinaryState(StateRecorder& stream)
+    {
+        ShapeResult result;
+
+        uint32 magic = 0, version = 0;
+        stream.Read(magic);
+        if (stream.IsFailed() || magic != kBinaryStateMagic)
+        {
+            result.SetError("Invalid Convex Hull binary state!");
+            return result;
+        }
+
+        stream.Read(version);
+        if (stream.IsFailed() || version != kBinaryStateVersion)
+        {
+            result.SetError("Unsupported Convex Hull binary state version!");
+            return result;
+        }
+
+        StrongPtr<ConvexHullShape> pShape = new ConvexHullShape;
+
+        // Shape properties. A failed stream reads zeros, so the values are checked once at the end.
+        float density = 0.f;
+        Vec3 inertiaColumns[3];
+        stream.Read(density);
+        stream.Read(pShape->m_centerOfMass);
+        stream.Read(pShape->m_volume);
+        stream.Read(pShape->m_innerRadius);
+        stream.Read(pShape->m_localBounds.m_min);
+        stream.Read(pShape->m_localBounds.m_max);
+        for (Vec3& column : inertiaColumns)
+            stream.Read(column);
+
+        // Hull
+        ReadArray(stream, pShape->m_points);
+
+        uint32 numFaces = 0;
+        stream.Read(numFaces);
+        for (uint32 i = 0; i < numFaces && !stream.IsFailed(); ++i)
+        {
+            Face face;
+            Vec3 normal;
+            float constant = 0.f;
+            stream.Read(face.m_firstVertex);
+            stream.Read(face.m_numVertices);
+            stream.Read(normal);
+            stream.Read(constant);
+            pShape->m_faces.push_back(face);
+            pShape->m_planes.push_back(Plane(normal, constant));
+        }
+
+        ReadArray(stream, pShape->m_vertexIndices);
+
+        // Support data
+        ReadArray(stream, pShape->m_adjacencyStart);
+        ReadArray(stream, pShape->m_adjacency);
+        for (uint8& index : pShape->m_extremeVertices)
+            stream.Read(index);
+
+        if (stream.IsFailed())
+        {
+            result.SetError("Convex Hull binary state is truncated!");
+            return result;
+        }
+
+        // Validate all indices, so that a corrupt blob cannot cause out of bounds reads.
+        const size_t numPoints = pShape->m_points.size();
+        bool isValid = numPoints >= 4 && numPoints <= static_cast<size_t>(kMaxPointsInHull)
+            && !pShape->m_faces.empty()
+            && pShape->m_adjacencyStart.size() == numPoints + 1
+            && pShape->m_adjacencyStart.back() == pShape->m_adjacency.size();
+
+        for (const Face& face : pShape->m_faces)
+            isValid = isValid && face.m_numVertices >= 3 && static_cast<size_t>(face.m_firstVertex) + face.m_numVertices <= pShape->m_vertexIndices.size();
+
+        for (size_t i = 0; i + 1 < pShape->m_adjacencyStart.size(); ++i)
+            isValid = isValid && pShape->m_adjacencyStart[i] <= pShape->m_adjacencyStart[i + 1];
+
+        const auto isValidIndex = [numPoints](const uint8 index) { return index < numPoints; };
+        isValid = isValid
+            && std::all_of(pShape->m_vertexIndices.begin(), pShape->m_vertexIndices.end(), isValidIndex)
+            && std::all_of(pShape->m_adjacency.begin(), pShape->m_adjacency.end(), isValidIndex)
+            && std::all_of(std::begin(pShape->m_extremeVertices), std::end(pShape->m_extremeVertices), isValidIndex);
+
+        if (!isValid)
+        {
+            result.SetError("Convex Hull binary state is corrupt!");
+            return result;
+        }
+
+        pShape->SetDensity(density);
+        pShape->m_inertia = Mat44(Vec4(inertiaColumns[0], 0.f), Vec4(inertiaColumns[1], 0.f), Vec4(inertiaColumns[2], 0.f), Vec4(0.f, 0.f, 0.f, 1.f));
+        result.Set(pShape.Get());
+        return result;
+    }
+
+    void ConvexHullShape::Register()
+    {
+        ShapeFunctions& f = ShapeFunctions::Get(EShapeSubType::ConvexHull);
+        f.m_construct = []() -> Shape* { return new ConvexHullShape; };
+        f.m_color = Color::Green();
+    }
+}
@@ -0,0 +1,206 @@
+// ConvexHullShape.h
+#pragma once
+#include "ConvexShape.h"
+#include "Nessie/Geometry/Plane.h"
+
+namespace nes
+{
+    class StateRecorder;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings that create a Convex Hull Shape. The hull is built from the points with a 3D
+    ///     quickhull when the shape is created. To avoid rebuilding the hull on every load, the created
+    ///     shape can be saved with ConvexHullShape::SaveBinaryState() and loaded with
+    ///     ConvexHullShape::RestoreFromBinaryState().
+    //----------------------------------------------------------------------------------------------------
+    class ConvexHullShapeSettings final : public ConvexShapeSettings
+    {
+    public:
+        std::vector<Vec3>   m_points{};                 /// Points to create the hull from. Points that end up inside the hull are discarded.
+        float               m_hullTolerance = 1.0e-3f;  /// Points within this distance of the hull are considered part of the hull. Coplanar triangles (within this distance) are merged into a single face.
+
+        ConvexHullShapeSettings() = default;
+        explicit ConvexHullShapeSettings(const std::vector<Vec3>& points) : m_points(points) {}
+        ConvexHullShapeSettings(const Vec3* pPoints, const size_t numPoints) : m_points(pPoints, pPoints + numPoints) {}
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ShapeSettings::Create()
+        //----------------------------------------------------------------------------------------------------
+        virtual ShapeResult Create() const override;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A Convex Hull, stored as a compact list of vertices, polygon faces and face planes. All
+    ///     data is stored relative to the center of mass of the hull.
+    /// @note : The support function walks the vertex adjacency graph (hill climbing) instead of testing
+    ///     every vertex, so support queries on hulls with many vertices stay cheap.
+    //----------------------------------------------------------------------------------------------------
+    class ConvexHullShape final : public ConvexShape
+    {
+    public:
+        /// Maximum number of vertices in a hull. This allows vertex indices to be stored as 8-bit values.
+        static constexpr int    kMaxPointsInHull = 256;
+
+    public:
+        ConvexHullShape() : ConvexShape(EShapeSubType::ConvexHull) {}
+        ConvexHullShape(const ConvexHullShapeSettings& settings, ShapeResult& outResult);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetCenterOfMass()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            GetCenterOfMass() const override            { return m_centerOfMass; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetLocalBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetLocalBounds() const override             { return m_localBounds; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetInnerRadius()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetInnerRadius() const override             { return m_innerRadius; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetMassProperties()
+        //----------------------------------------------------------------------------------------------------
+        virtual MassProperties  GetMassProperties() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSurfaceNormal()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            GetSurfaceNormal(const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CollidePoint()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesStart()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesNext()
+        //----------------------------------------------------------------------------------------------------
+        virtual int             GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested, Float3* outTriangleVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetVolume()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetVolume() const override                  { return m_volume; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ConvexShape::GetSupportFunction()
+        //----------------------------------------------------------------------------------------------------
+        virtual const Support*  GetSupportFunction(ESupportMode mode, SupportBuffer& buffer, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ConvexShape::GetSupportingFace()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction, const Vec3& scale, const Mat44& centerOfMassTransform, SupportingFace& outVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of vertices in the hull.
+        //----------------------------------------------------------------------------------------------------
+        uint                    GetNumPoints() const                        { return static_cast<uint>(m_points.size()); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get a vertex of the hull, relative to the center of mass.
+        //----------------------------------------------------------------------------------------------------
+        const Vec3&             GetPoint(const uint index) const            { return m_points[index]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of polygon faces of the hull.
+        //----------------------------------------------------------------------------------------------------
+        uint                    GetNumFaces() const                         { return static_cast<uint>(m_faces.size()); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of vertices of a face.
+        //----------------------------------------------------------------------------------------------------
+        uint                    GetNumVerticesInFace(const uint faceIndex) const { return m_faces[faceIndex].m_numVertices; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the vertex indices of a face, counter-clockwise when seen from the outside.
+        //----------------------------------------------------------------------------------------------------
+        const uint8*            GetFaceVertices(const uint faceIndex) const { return m_vertexIndices.data() + m_faces[faceIndex].m_firstVertex; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the plane of a face, relative to the center of mass.
+        //----------------------------------------------------------------------------------------------------
+        const Plane&            GetPlane(const uint faceIndex) const        { return m_planes[faceIndex]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Find the vertex that is furthest in a direction, by walking the vertex adjacency graph
+        ///     from the best of the axis-extreme vertices. Relative to the center of mass.
+        //----------------------------------------------------------------------------------------------------
+        Vec3                    GetSupportPoint(const Vec3& direction) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write the cooked hull to a stream. The state can be loaded with RestoreFromBinaryState().
+        /// @note : The state is stored in the byte order of the machine that saved it.
+        //----------------------------------------------------------------------------------------------------
+        void                    SaveBinaryState(StateRecorder& stream) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a hull from a stream that was written by SaveBinaryState(). This does not
+        ///     rebuild the hull.
+        ///	@returns : The shape, or an error if the state is invalid.
+        //----------------------------------------------------------------------------------------------------
+        static ShapeResult      RestoreFromBinaryState(StateRecorder& stream);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Register shape functions within the registry.
+        //----------------------------------------------------------------------------------------------------
+        static void             Register();
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Intersect a ray with all face planes. 
+        ///	@returns : False if the ray's line does not intersect the hull.
+        //----------------------------------------------------------------------------------------------------
+        bool                    CastRayHelper(const RayCast& ray, float& outMinFraction, float& outMaxFraction) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Build the vertex adjacency lists and pick the vertices that start the hill climbing.
+        //----------------------------------------------------------------------------------------------------
+        void                    BuildSupportData();
+
+    private:
+        /// Classes for GetSupportFunction() and GetTrianglesStart/Next().
+        class HullNoConvex;
+        class CHSGetTrianglesContext;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Range of vertex indices (in m_vertexIndices) that make up a face.
+        //----------------------------------------------------------------------------------------------------
+        struct Face
+        {
+            uint16              m_firstVertex = 0;
+            uint16              m_numVertices = 0;
+        };
+
+        std::vector<Vec3>       m_points{};                 /// Vertices of the hull, relative to the center of mass.
+        std::vector<Face>       m_faces{};
+        std::vector<Plane>      m_planes{};                 /// Plane of each face, relative to the center of mass.
+        std::vector<uint8>      m_vertexIndices{};          /// Vertex indices of all faces.
+        std::vector<uint16>     m_adjacencyStart{};         /// Range of m_adjacency that belongs to each vertex; vertex N uses [m_adjacencyStart[N], m_adjacencyStart[N + 1]).
+        std::vector<uint8>      m_adjacency{};              /// Vertices that share an edge with each vertex.
+        uint8                   m_extremeVertices[6] = {};  /// Vertices with the min and max X, Y and Z coordinates, used to start the hill climbing.
+        Mat44                   m_inertia = Mat44::Zero();  /// Inertia tensor for a density of 1, around the center of mass.
+        Vec3                    m_centerOfMass = Vec3::Zero();
+        AABox                   m_localBounds{};
+        float                   m_volume = 0.f;
+        float                   m_innerRadius = 0.f;
+    };
+}
@@ -326,9 +326,9 @@ namespace nes
         if (penetrationAxisLength > 0.f)
             point1 -= penetrationAxis * (maxSeparationDistance / penetrationAxisLength);
 
-        // Convert to world space
+        // Convert to world space. Both points were calculated in the space of shape 1.
         point1 = centerOfMassTransform1.TransformPoint(point1);
-        point2 = centerOfMassTransform2.TransformPoint(point2);
+        point2 = centerOfMassTransform1.TransformPoint(point2);
         Vec3 penetrationAxisWorld = centerOfMassTransform1.TransformVector(penetrationAxis);
 
         // Create collision result
@@ -0,0 +1,1231 @@
+// HeightFieldShape.cpp
+#include "HeightFieldShape.h"
+
+#include "ConvexShape.h"
+#include "GetTrianglesContext.h"
+#include "ScaleHelpers.h"
+#include "Nessie/Geometry/AABoxSIMD.h"
+#include "Nessie/Geometry/RayAABox.h"
+#include "Nessie/Geometry/RayTriangle.h"
+#include "Nessie/Physics/Collision/ActiveEdges.h"
+#include "Nessie/Physics/Collision/CastConvexVsTriangles.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/CollideConvexVsTriangles.h"
+#include "Nessie/Physics/Collision/CollisionSolver.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Physics/Collision/ShapeCast.h"
+#include "Nessie/Physics/Collision/SortReverseAndStore.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+
+namespace nes
+{
+    /// Max value of a quantized sample, kNoCollisionSample is reserved for holes.
+    static constexpr uint   kSampleQuantizeSteps = 0xfffe;
+
+    /// Max value of a quantized height in the hierarchy. One step of headroom is left at the top so that
+    /// rounding the max of a cell up cannot end up below the samples in the cell.
+    static constexpr uint   kRangeQuantizeSteps = 0xfffe;
+    static constexpr uint16 kRangeQuantizeMax = 0xffff;
+
+    static constexpr uint32 kInvalidTriangle = 0xffffffff;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create a reference to a cell of the hierarchy.
+    //----------------------------------------------------------------------------------------------------
+    static NES_INLINE uint32 MakeCell(const uint level, const uint x, const uint y)
+    {
+        return (static_cast<uint32>(level) << 28) | (static_cast<uint32>(y) << 14) | static_cast<uint32>(x);
+    }
+
+    static NES_INLINE uint GetCellLevel(const uint32 cell)  { return cell >> 28; }
+    static NES_INLINE uint GetCellX(const uint32 cell)      { return cell & 0x3fff; }
+    static NES_INLINE uint GetCellY(const uint32 cell)      { return (cell >> 14) & 0x3fff; }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Positions of the samples that are used by the quads of a block. Triangle 0 of the quad (x, y)
+    ///     is (x, y), (x, y + 1), (x + 1, y + 1) and triangle 1 is (x, y), (x + 1, y + 1), (x + 1, y).
+    //----------------------------------------------------------------------------------------------------
+    struct HeightFieldShape::DecodedBlock
+    {
+        static constexpr uint kMaxSamplesPerSide = kMaxBlockSize + 1;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the position of a sample, relative to the first sample of the block.
+        //----------------------------------------------------------------------------------------------------
+        const Vec3&     GetPosition(const uint x, const uint y) const   { return m_positions[y * kMaxSamplesPerSide + x]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if a sample is a hole, relative to the first sample of the block.
+        //----------------------------------------------------------------------------------------------------
+        bool            IsHole(const uint x, const uint y) const        { return m_isHole[y * kMaxSamplesPerSide + x]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the vertices of a triangle of a quad, relative to the first quad of the block.
+        ///	@returns : False if the triangle uses a hole sample.
+        //----------------------------------------------------------------------------------------------------
+        bool            GetTriangle(const uint x, const uint y, const uint triangle, Vec3& outV0, Vec3& outV1, Vec3& outV2) const
+        {
+            const uint x2 = triangle == 0? x : x + 1;
+            const uint y2 = triangle == 0? y + 1 : y;
+            if (IsHole(x, y) || IsHole(x + 1, y + 1) || IsHole(x2, y2))
+                return false;
+
+            outV0 = GetPosition(x, y);
+            outV1 = triangle == 0? GetPosition(x2, y2) : GetPosition(x + 1, y + 1);
+            outV2 = triangle == 0? GetPosition(x + 1, y + 1) : GetPosition(x2, y2);
+            return true;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the index of a triangle of a quad, relative to the first quad of the block.
+        //----------------------------------------------------------------------------------------------------
+        uint32          GetTriangleIndex(const uint x, const uint y, const uint triangle) const
+        {
+            return ((m_startY + y) * m_quadsPerSide + m_startX + x) * 2 + triangle;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Intersect a ray with all triangles of the block, 4 triangles at a time. The callback implements
+        ///     'void operator()(uint32 triangleIndex, float fraction)' and is called for every hit.
+        //----------------------------------------------------------------------------------------------------
+        template <typename HitCallback>
+        void            CastRay(const Vec3& origin, const Vec3& direction, HitCallback& callback) const
+        {
+            alignas(16) float components[9][4];
+            uint32 triangleIndices[4];
+            uint numTriangles = 0;
+
+            auto flush = [&]()
+            {
+                // Fill the unused lanes with a copy of the first triangle
+                for (uint t = numTriangles; t < 4; ++t)
+                {
+                    for (uint i = 0; i < 9; ++i)
+                        components[i][t] = components[i][0];
+                }
+
+                Vec4Reg vertices[9];
+                for (uint i = 0; i < 9; ++i)
+                    vertices[i] = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(components[i]));
+
+                float fractions[4];
+                RayTriangle4(origin, direction, vertices[0], vertices[1], vertices[2], vertices[3], vertices[4], vertices[5], vertices[6], vertices[7], vertices[8]).StoreFloat4(reinterpret_cast<Float4*>(fractions));
+                for (uint t = 0; t < numTriangles; ++t)
+                {
+                    if (fractions[t] != FLT_MAX)
+                        callback(triangleIndices[t], fractions[t]);
+                }
+                numTriangles = 0;
+            };
+
+            for (uint y = 0; y < m_numQuadsY; ++y)
+            {
+                for (uint x = 0; x < m_numQuadsX; ++x)
+                {
+                    for (uint triangle = 0; triangle < 2; ++triangle)
+                    {
+                        Vec3 vertices[3];
+                        if (!GetTriangle(x, y, triangle, vertices[0], vertices[1], vertices[2]))
+                            continue;
+
+                        for (uint corner = 0; corner < 3; ++corner)
+                        {
+                            components[corner * 3 + 0][numTriangles] = vertices[corner].x;
+                            components[corner * 3 + 1][numTriangles] = vertices[corner].y;
+                            components[corner * 3 + 2][numTriangles] = vertices[corner].z;
+                        }
+                        triangleIndices[numTriangles] = GetTriangleIndex(x, y, triangle);
+
+                        if (++numTriangles == 4)
+                            flush();
+                    }
+                }
+            }
+
+            if (numTriangles > 0)
+                flush();
+        }
+
+        Vec3            m_positions[kMaxSamplesPerSide * kMaxSamplesPerSide];
+        bool            m_isHole[kMaxSamplesPerSide * kMaxSamplesPerSide];
+        uint            m_startX;           /// First quad of the block.
+        uint            m_startY;
+        uint            m_numQuadsX;        /// Number of quads in the block, which is less than the block size for the last row and column.
+        uint            m_numQuadsY;
+        uint            m_quadsPerSide;     /// Number of quads along each side of the height field.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    //	NOTES:
+    //  Interface of the visitor used by WalkHierarchy():
+    //  - bool ShouldAbort() const : Return true to stop walking the hierarchy.
+    //  - bool ShouldVisitCell(int stackTop) const : Called when a cell is popped from the stack, return false to skip it.
+    //  - int VisitCells(minX, minY, minZ, maxX, maxY, maxZ, const UVec4Reg& isValid, UVec4Reg& ioChildren, int stackTop) :
+    //      Test the bounds of 4 children. Children that are not valid must not be visited. Move the children that
+    //      should be visited to the front of ioChildren and return how many there are. The first child will be
+    //      stored at stackTop.
+    //  - void VisitBlock(uint blockX, uint blockY) : Visit the triangles of a block.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Visitor>
+    void HeightFieldShape::WalkHierarchy(Visitor& visitor) const
+    {
+        uint32 stack[kStackSize];
+        stack[0] = MakeCell(m_numLevels - 1, 0, 0);
+        int top = 0;
+        do
+        {
+            // Pop the top of the stack
+            const uint32 cell = stack[top];
+            const bool shouldVisit = visitor.ShouldVisitCell(top);
+            --top;
+            if (!shouldVisit)
+                continue;
+
+            if (GetCellLevel(cell) == 0)
+            {
+                visitor.VisitBlock(GetCellX(cell), GetCellY(cell));
+            }
+            else
+            {
+                Vec4Reg minX, minY, minZ, maxX, maxY, maxZ;
+                UVec4Reg children;
+                GetChildBounds(cell, minX, minY, minZ, maxX, maxY, maxZ, children);
+                const UVec4Reg isValid = UVec4Reg::Not(UVec4Reg::Equals(children, UVec4Reg::Replicate(kInvalidCell)));
+
+                NES_ASSERT(top + 4 < kStackSize, "Stack overflow!");
+                const int numChildren = visitor.VisitCells(minX, minY, minZ, maxX, maxY, maxZ, isValid, children, top + 1);
+                children.StoreInt4(&stack[top + 1]);
+                top += numChildren;
+            }
+        }
+        while (top >= 0 && !visitor.ShouldAbort());
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Finds the closest hit of a ray with the height field.
+    //----------------------------------------------------------------------------------------------------
+    class HeightFieldShape::RayCastClosestVisitor
+    {
+    public:
+        RayCastClosestVisitor(const HeightFieldShape& shape, const RayCast& ray, const float maxFraction)
+            : m_shape(shape)
+            , m_ray(ray)
+            , m_invDirection(ray.m_direction)
+            , m_fraction(maxFraction)
+        {
+            m_distanceStack[0] = 0.f;
+        }
+
+        bool ShouldAbort() const                            { return m_fraction <= 0.f; }
+        bool ShouldVisitCell(const int stackTop) const      { return m_distanceStack[stackTop] < m_fraction; }
+
+        int VisitCells(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, const UVec4Reg& isValid, UVec4Reg& ioChildren, const int stackTop)
+        {
+            Vec4Reg distance = RayAABox4(m_ray.m_origin, m_invDirection, minX, minY, minZ, maxX, maxY, maxZ);
+            distance = Vec4Reg::Select(Vec4Reg::Replicate(FLT_MAX), distance, isValid);
+            return SortReverseAndStore(distance, m_fraction, ioChildren, &m_distanceStack[stackTop]);
+        }
+
+        void VisitBlock(const uint blockX, const uint blockY)
+        {
+            DecodedBlock block;
+            m_shape.DecodeBlock(blockX, blockY, block);
+            block.CastRay(m_ray.m_origin, m_ray.m_direction, *this);
+        }
+
+        void operator()(const uint32 triangleIndex, const float fraction)
+        {
+            if (fraction < m_fraction)
+            {
+                m_fraction = fraction;
+                m_triangleIndex = triangleIndex;
+            }
+        }
+
+        const HeightFieldShape& m_shape;
+        RayCast                 m_ray;
+        RayInvDirection         m_invDirection;
+        float                   m_fraction;
+        uint32                  m_triangleIndex = kInvalidTriangle;
+        float                   m_distanceStack[kStackSize];
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Reports all hits of a ray with the height field to a collector.
+    //----------------------------------------------------------------------------------------------------
+    class HeightFieldShape::RayCastCollectorVisitor
+    {
+    public:
+        RayCastCollectorVisitor(const HeightFieldShape& shape, const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter)
+            : m_shape(shape)
+            , m_ray(ray)
+            , m_invDirection(ray.m_direction)
+            , m_settings(settings)
+            , m_subShapeIDCreator(subShapeIDCreator)
+            , m_collector(collector)
+            , m_shapeFilter(shapeFilter)
+        {
+            m_distanceStack[0] = 0.f;
+        }
+
+        bool ShouldAbort() const                            { return m_collector.ShouldEarlyOut(); }
+        bool ShouldVisitCell(const int stackTop) const      { return m_distanceStack[stackTop] < m_collector.GetEarlyOutFraction(); }
+
+        int VisitCells(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, const UVec4Reg& isValid, UVec4Reg& ioChildren, const int stackTop)
+        {
+            Vec4Reg distance = RayAABox4(m_ray.m_origin, m_invDirection, minX, minY, minZ, maxX, maxY, maxZ);
+            distance = Vec4Reg::Select(Vec4Reg::Replicate(FLT_MAX), distance, isValid);
+            return SortReverseAndStore(distance, m_collector.GetEarlyOutFraction(), ioChildren, &m_distanceStack[stackTop]);
+        }
+
+        void VisitBlock(const uint blockX, const uint blockY)
+        {
+            DecodedBlock block;
+            m_shape.DecodeBlock(blockX, blockY, block);
+            block.CastRay(m_ray.m_origin, m_ray.m_direction, *this);
+        }
+
+        void operator()(const uint32 triangleIndex, const float fraction)
+        {
+            if (fraction >= m_collector.GetEarlyOutFraction())
+                return;
+
+            // Check if we hit the back side of the triangle
+            Vec3 v0, v1, v2;
+            uint8 activeEdges;
+            m_shape.GetTriangle(triangleIndex, v0, v1, v2, activeEdges);
+            const bool isBackFacing = (v1 - v0).Cross(v2 - v0).Dot(m_ray.m_direction) > 0.f;
+            if (isBackFacing && m_settings.m_backfaceModeTriangles == EBackFaceMode::IgnoreBackFaces)
+                return;
+
+            const SubShapeID subShapeID = m_subShapeIDCreator.PushID(triangleIndex, m_shape.m_numSubShapeIDBits).GetID();
+            if (!m_shapeFilter.ShouldCollide(&m_shape, subShapeID))
+                return;
+
+            RayCastResult hit;
+            hit.m_bodyID = TransformedShape::GetBodyID(m_collector.GetContext());
+            hit.m_fraction = fraction;
+            hit.m_subShapeID2 = subShapeID;
+            m_collector.AddHit(hit);
+        }
+
+        const HeightFieldShape&     m_shape;
+        RayCast                     m_ray;
+        RayInvDirection             m_invDirection;
+        const RayCastSettings&      m_settings;
+        const SubShapeIDCreator&    m_subShapeIDCreator;
+        CastRayCollector&           m_collector;
+        const ShapeFilter&          m_shapeFilter;
+        float                       m_distanceStack[kStackSize];
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Checks if any block of the height field overlaps a box.
+    //----------------------------------------------------------------------------------------------------
+    class HeightFieldShape::CollectTransformedShapesVisitor
+    {
+    public:
+        explicit CollectTransformedShapesVisitor(const AABox& box) : m_box(box) {}
+
+        bool ShouldAbort() const                            { return m_foundBlock; }
+        bool ShouldVisitCell(const int) const               { return true; }
+
+        int VisitCells(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, const UVec4Reg& isValid, UVec4Reg& ioChildren, const int)
+        {
+            const UVec4Reg hit = UVec4Reg::And(math::AABox4VsAABox(m_box, minX, minY, minZ, maxX, maxY, maxZ), isValid);
+            return CountAndSortTrues(hit, ioChildren);
+        }
+
+        void VisitBlock(const uint, const uint)             { m_foundBlock = true; }
+
+        AABox   m_box;
+        bool    m_foundBlock = false;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Calls the callback for every triangle that overlaps a box. See VisitBlockTriangles() for the
+    ///     callback interface, it also implements 'bool ShouldAbort() const'.
+    //----------------------------------------------------------------------------------------------------
+    template <typename TriangleCallback>
+    class HeightFieldShape::BoxVisitor
+    {
+    public:
+        BoxVisitor(const HeightFieldShape& shape, const AABox& box, TriangleCallback& callback) : m_shape(shape), m_box(box), m_callback(callback) {}
+
+        bool ShouldAbort() const                            { return m_callback.ShouldAbort(); }
+        bool ShouldVisitCell(const int) const               { return true; }
+
+        int VisitCells(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, const UVec4Reg& isValid, UVec4Reg& ioChildren, const int)
+        {
+            const UVec4Reg hit = UVec4Reg::And(math::AABox4VsAABox(m_box, minX, minY, minZ, maxX, maxY, maxZ), isValid);
+            return CountAndSortTrues(hit, ioChildren);
+        }
+
+        void VisitBlock(const uint blockX, const uint blockY)
+        {
+            m_shape.VisitBlockTriangles(blockX, blockY, m_box, m_callback);
+        }
+
+        const HeightFieldShape& m_shape;
+        AABox                   m_box;
+        TriangleCallback&       m_callback;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Calls the callback for every triangle that a box sweeps through, closest cells first.
+    ///     The cell bounds are scaled to the space of the cast. See BoxVisitor for the callback interface.
+    //----------------------------------------------------------------------------------------------------
+    template <typename TriangleCallback>
+    class HeightFieldShape::SweptBoxVisitor
+    {
+    public:
+        SweptBoxVisitor(const HeightFieldShape& shape, const ShapeCast& shapeCast, const Vec3& scale, const CastShapeCollector& collector, TriangleCallback& callback)
+            : m_shape(shape)
+            , m_boxCenter(shapeCast.m_shapeWorldBounds.Center())
+            , m_boxExtent(shapeCast.m_shapeWorldBounds.Extent())
+            , m_invDirection(shapeCast.m_direction)
+            , m_scale(scale)
+            , m_collector(collector)
+            , m_callback(callback)
+        {
+            // The triangles of a block are culled against the bounds of the whole sweep, in the unscaled space of the shape.
+            AABox sweptBounds = shapeCast.m_shapeWorldBounds;
+            sweptBounds.Encapsulate(shapeCast.m_shapeWorldBounds.m_min + shapeCast.m_direction);
+            sweptBounds.Encapsulate(shapeCast.m_shapeWorldBounds.m_max + shapeCast.m_direction);
+            m_sweptBox = ScaleHelpers::UnscaleBox(sweptBounds, scale);
+
+            m_distanceStack[0] = 0.f;
+        }
+
+        bool ShouldAbort() const                            { return m_callback.ShouldAbort(); }
+        bool ShouldVisitCell(const int stackTop) const      { return m_distanceStack[stackTop] < m_collector.GetPositiveEarlyOutFraction(); }
+
+        int VisitCells(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, const UVec4Reg& isValid, UVec4Reg& ioChildren, const int stackTop)
+        {
+            // Scale the bounds of the children, and enlarge them by the extent of the cast shape.
+            Vec4Reg scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ;
+            math::AABox4Scale(m_scale, minX, minY, minZ, maxX, maxY, maxZ, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+            math::AABox4EnlargeWithExtent(m_boxExtent, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+
+            // Cast the center of the box against the enlarged bounds.
+            Vec4Reg distance = RayAABox4(m_boxCenter, m_invDirection, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+            distance = Vec4Reg::Select(Vec4Reg::Replicate(FLT_MAX), distance, isValid);
+            return SortReverseAndStore(distance, m_collector.GetPositiveEarlyOutFraction(), ioChildren, &m_distanceStack[stackTop]);
+        }
+
+        void VisitBlock(const uint blockX, const uint blockY)
+        {
+            m_shape.VisitBlockTriangles(blockX, blockY, m_sweptBox, m_callback);
+        }
+
+        const HeightFieldShape&     m_shape;
+        Vec3                        m_boxCenter;
+        Vec3                        m_boxExtent;
+        RayInvDirection             m_invDirection;
+        Vec3                        m_scale;
+        AABox                       m_sweptBox;
+        const CastShapeCollector&   m_collector;
+        TriangleCallback&           m_callback;
+        float                       m_distanceStack[kStackSize];
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Returns the triangles that overlap a box. The triangles of a block are gathered up front,
+    ///     so that the context only has to store their indices.
+    //----------------------------------------------------------------------------------------------------
+    class HeightFieldShape::HSGetTrianglesContext
+    {
+    public:
+        HSGetTrianglesContext(const HeightFieldShape& shape, const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale)
+            : m_localToWorld(Mat44::MakeRotationTranslation(rotation, positionCOM) * Mat44::MakeScale(scale))
+            , m_isInsideOut(ScaleHelpers::IsInsideOut(scale))
+        {
+            // Get the box in the unscaled space of the height field
+            const Mat44 worldToCOM = Mat44::MakeRotationTranslation(rotation, positionCOM).InversedRotationTranslation();
+            m_localBox = ScaleHelpers::UnscaleBox(box.Transformed(worldToCOM), scale);
+            m_stack[0] = MakeCell(shape.m_numLevels - 1, 0, 0);
+        }
+
+        void operator()(const uint32 triangleIndex, const Vec3&, const Vec3&, const Vec3&)
+        {
+            m_triangles[m_numTriangles++] = triangleIndex;
+        }
+
+        static constexpr uint kMaxTrianglesPerBlock = 2 * kMaxBlockSize * kMaxBlockSize;
+
+        Mat44               m_localToWorld;
+        AABox               m_localBox;
+        bool                m_isInsideOut;
+        uint                m_numTriangles = 0;         /// Number of triangles of the current block.
+        uint                m_nextTriangle = 0;         /// Next triangle of the current block to output.
+        int                 m_stackTop = 0;
+        uint32              m_stack[kStackSize];
+        uint32              m_triangles[kMaxTrianglesPerBlock];
+    };
+
+    HeightFieldShapeSettings::HeightFieldShapeSettings(const float* pSamples, const Vec3& offset, const Vec3& scale, const uint sampleCount)
+        : m_heightSamples(pSamples, pSamples + static_cast<size_t>(sampleCount) * sampleCount)
+        , m_offset(offset)
+        , m_scale(scale)
+        , m_sampleCount(sampleCount)
+    {
+        //
+    }
+
+    ShapeSettings::ShapeResult HeightFieldShapeSettings::Create() const
+    {
+        if (m_cachedResult.IsEmpty())
+        {
+            StrongPtr<Shape> pShape = new HeightFieldShape(*this, m_cachedResult);
+        }
+        return m_cachedResult;
+    }
+
+    HeightFieldShape::HeightFieldShape(const HeightFieldShapeSettings& settings, ShapeResult& outResult)
+        : Shape(EShapeType::HeightField, EShapeSubType::HeightField, settings, outResult)
+        , m_offset(settings.m_offset)
+        , m_scale(settings.m_scale)
+        , m_sampleCount(settings.m_sampleCount)
+        , m_blockSize(settings.m_blockSize)
+    {
+        if (m_sampleCount < 2)
+        {
+            outResult.SetError("Height Field Shape needs at least 2 x 2 samples!");
+            return;
+        }
+
+        if (settings.m_heightSamples.size() != static_cast<size_t>(m_sampleCount) * m_sampleCount)
+        {
+            outResult.SetError("Height Field Shape sample count does not match the number of height samples!");
+            return;
+        }
+
+        if (m_blockSize < kMinBlockSize || m_blockSize > kMaxBlockSize)
+        {
+            outResult.SetError("Height Field Shape block size must be in the range [2, 8]!");
+            return;
+        }
+
+        if (!Vec3::Greater(m_scale, Vec3::Zero()).TestAllXYZTrue())
+        {
+            outResult.SetError("Height Field Shape scale must be positive!");
+            return;
+        }
+
+        const uint quadsPerSide = m_sampleCount - 1;
+        const uint numBlocks = (quadsPerSide + m_blockSize - 1) / m_blockSize;
+        if (numBlocks > (1u << kCellCoordinateBits) || static_cast<uint64>(quadsPerSide) * quadsPerSide * 2 > static_cast<uint64>(UINT32_MAX))
+        {
+            outResult.SetError("Too many samples to create a Height Field Shape!");
+            return;
+        }
+
+        // Get the sizes of the levels of the hierarchy
+        m_numLevels = 1;
+        m_levelSizes[0] = numBlocks;
+        m_levelOffsets[0] = 0;
+        while (m_levelSizes[m_numLevels - 1] > 1)
+        {
+            const uint previousSize = m_levelSizes[m_numLevels - 1];
+            m_levelOffsets[m_numLevels] = m_levelOffsets[m_numLevels - 1] + previousSize * previousSize;
+            m_levelSizes[m_numLevels] = (previousSize + 1) / 2;
+            ++m_numLevels;
+        }
+        NES_ASSERT(m_numLevels <= kMaxLevels);
+
+        // Quantize the samples, relative to the range of the samples owned by each block. The samples in the last
+        // row and column of the height field belong to the last block of that row or column.
+        const std::vector<float>& heights = settings.m_heightSamples;
+        m_samples.resize(heights.size());
+        m_blockQuantization.resize(static_cast<size_t>(numBlocks) * numBlocks);
+        for (uint blockY = 0; blockY < numBlocks; ++blockY)
+        {
+            for (uint blockX = 0; blockX < numBlocks; ++blockX)
+            {
+                const uint startX = blockX * m_blockSize;
+                const uint startY = blockY * m_blockSize;
+                const uint endX = blockX == numBlocks - 1? m_sampleCount : startX + m_blockSize;
+                const uint endY = blockY == numBlocks - 1? m_sampleCount : startY + m_blockSize;
+
+                float minHeight = FLT_MAX;
+                float maxHeight = -FLT_MAX;
+                for (uint y = startY; y < endY; ++y)
+                {
+                    for (uint x = startX; x < endX; ++x)
+                    {
+                        const float height = heights[y * m_sampleCount + x];
+                        if (height != HeightFieldShapeSettings::kNoCollisionValue)
+                        {
+                            minHeight = math::Min(minHeight, height);
+                            maxHeight = math::Max(maxHeight, height);
+                        }
+                    }
+                }
+
+                BlockQuantization& quantization = m_blockQuantization[blockY * numBlocks + blockX];
+                quantization.m_offset = minHeight <= maxHeight? minHeight : 0.f;
+                quantization.m_scale = minHeight < maxHeight? (maxHeight - minHeight) / static_cast<float>(kSampleQuantizeSteps) : 0.f;
+                const float inverseScale = quantization.m_scale > 0.f? 1.f / quantization.m_scale : 0.f;
+
+                for (uint y = startY; y < endY; ++y)
+                {
+                    for (uint x = startX; x < endX; ++x)
+                    {
+                        const float height = heights[y * m_sampleCount + x];
+                        uint16& sample = m_samples[y * m_sampleCount + x];
+                        if (height == HeightFieldShapeSettings::kNoCollisionValue)
+                            sample = kNoCollisionSample;
+                        else
+                            sample = static_cast<uint16>(math::Clamp(std::round((height - quantization.m_offset) * inverseScale), 0.f, static_cast<float>(kSampleQuantizeSteps)));
+                    }
+                }
+            }
+        }
+
+        // Get the range of the quantized samples, which is used to quantize the hierarchy.
+        float minHeight = FLT_MAX;
+        float maxHeight = -FLT_MAX;
+        for (uint y = 0; y < m_sampleCount; ++y)
+        {
+            for (uint x = 0; x < m_sampleCount; ++x)
+            {
+                const uint16 sample = m_samples[y * m_sampleCount + x];
+                if (sample != kNoCollisionSample)
+                {
+                    const BlockQuantization& quantization = m_blockQuantization[GetSampleBlockIndex(x, y)];
+                    const float height = quantization.m_offset + static_cast<float>(sample) * quantization.m_scale;
+                    minHeight = math::Min(minHeight, height);
+                    maxHeight = math::Max(maxHeight, height);
+                }
+            }
+        }
+
+        if (minHeight > maxHeight)
+        {
+            outResult.SetError("Height Field Shape needs at least one sample that is not a hole!");
+            return;
+        }
+
+        m_rangeOffset = minHeight;
+        m_rangeScale = (maxHeight - minHeight) / static_cast<float>(kRangeQuantizeSteps);
+
+        // Quantize a height of the hierarchy, rounding away from the samples. The loops correct for the rounding of
+        // the float math, so that the dequantized value is guaranteed to be on the correct side.
+        auto dequantizeRange = [this](const uint value) { return m_rangeOffset + static_cast<float>(value) * m_rangeScale; };
+        auto quantizeRangeMin = [this, &dequantizeRange](const float height)
+        {
+            if (m_rangeScale <= 0.f)
+                return static_cast<uint16>(0);
+
+            uint value = static_cast<uint>(math::Clamp(std::floor((height - m_rangeOffset) / m_rangeScale), 0.f, static_cast<float>(kRangeQuantizeMax)));
+            while (value > 0 && dequantizeRange(value) > height)
+                --value;
+            return static_cast<uint16>(value);
+        };
+        auto quantizeRangeMax = [this, &dequantizeRange](const float height)
+        {
+            if (m_rangeScale <= 0.f)
+                return static_cast<uint16>(0);
+
+            uint value = static_cast<uint>(math::Clamp(std::ceil((height - m_rangeOffset) / m_rangeScale), 0.f, static_cast<float>(kRangeQuantizeMax)));
+            while (value < kRangeQuantizeMax && dequantizeRange(value) < height)
+                ++value;
+            return static_cast<uint16>(value);
+        };
+
+        // Build the first level of the hierarchy, from all the samples that are used by the quads of each block.
+        const uint numCells = m_levelOffsets[m_numLevels - 1] + 1;
+        m_ranges.resize(numCells);
+        for (uint blockY = 0; blockY < numBlocks; ++blockY)
+        {
+            for (uint blockX = 0; blockX < numBlocks; ++blockX)
+            {
+                float minBlockHeight = FLT_MAX;
+                float maxBlockHeight = -FLT_MAX;
+                const uint endX = math::Min((blockX + 1) * m_blockSize, quadsPerSide);
+                const uint endY = math::Min((blockY + 1) * m_blockSize, quadsPerSide);
+                for (uint y = blockY * m_blockSize; y <= endY; ++y)
+                {
+                    for (uint x = blockX * m_blockSize; x <= endX; ++x)
+                    {
+                        const uint16 sample = m_samples[y * m_sampleCount + x];
+                        if (sample != kNoCollisionSample)
+                        {
+                            const BlockQuantization& quantization = m_blockQuantization[GetSampleBlockIndex(x, y)];
+                            const float height = quantization.m_offset + static_cast<float>(sample) * quantization.m_scale;
+                            minBlockHeight = math::Min(minBlockHeight, height);
+                            maxBlockHeight = math::Max(maxBlockHeight, height);
+                        }
+                    }
+                }
+
+                RangeBlock& range = m_ranges[blockY * numBlocks + blockX];
+                if (minBlockHeight <= maxBlockHeight)
+                {
+                    range.m_min = quantizeRangeMin(minBlockHeight);
+                    range.m_max = quantizeRangeMax(maxBlockHeight);
+                }
+                else
+                {
+                    // Only holes
+                    range.m_min = kRangeQuantizeMax;
+                    range.m_max = 0;
+                }
+            }
+        }
+
+        // Build the other levels, each cell combines 2 x 2 cells of the level below.
+        for (uint level = 1; level < m_numLevels; ++level)
+        {
+            const uint size = m_levelSizes[level];
+            const uint childSize = m_levelSizes[level - 1];
+            for (uint y = 0; y < size; ++y)
+            {
+                for (uint x = 0; x < size; ++x)
+                {
+                    RangeBlock range { kRangeQuantizeMax, 0 };
+                    for (uint i = 0; i < 4; ++i)
+                    {
+                        const uint childX = 2 * x + (i & 1);
+                        const uint childY = 2 * y + (i >> 1);
+                        if (childX < childSize && childY < childSize)
+                        {
+                            const RangeBlock& childRange = m_ranges[m_levelOffsets[level - 1] + childY * childSize + childX];
+                            range.m_min = math::Min(range.m_min, childRange.m_min);
+                            range.m_max = math::Max(range.m_max, childRange.m_max);
+                        }
+                    }
+                    m_ranges[m_levelOffsets[level] + y * size + x] = range;
+                }
+            }
+        }
+
+        // Set the bounds from the root of the hierarchy, which matches the bounds that the queries test against.
+        const RangeBlock& root = m_ranges[m_levelOffsets[m_numLevels - 1]];
+        m_bounds.m_min = Vec3(m_offset.x, m_offset.y + m_scale.y * dequantizeRange(root.m_min), m_offset.z);
+        m_bounds.m_max = Vec3(m_offset.x + m_scale.x * static_cast<float>(quadsPerSide), m_offset.y + m_scale.y * dequantizeRange(root.m_max), m_offset.z + m_scale.z * static_cast<float>(quadsPerSide));
+
+        // Find the active edges. Every quad stores 3 bits:
+        // - bit 0: the diagonal edge between triangle 0 and 1 of the quad.
+        // - bit 1: the edge at x, between triangle 0 of the quad and triangle 1 of the quad at (x - 1, y).
+        // - bit 2: the edge at y, between triangle 1 of the quad and triangle 0 of the quad at (x, y - 1).
+        // The edges at the other two sides of the quad are stored by the neighbouring quads, see GetActiveEdges().
+        auto getTriangle = [this](const uint quadX, const uint quadY, const uint triangle, Vec3& outV0, Vec3& outV1, Vec3& outV2)
+        {
+            uint8 activeEdges;
+            return GetTriangle((quadY * (m_sampleCount - 1) + quadX) * 2 + triangle, outV0, outV1, outV2, activeEdges);
+        };
+
+        auto isEdgeActive = [&settings, &getTriangle](const uint quadX1, const uint quadY1, const uint triangle1, const uint edge1, const uint quadX2, const uint quadY2, const uint triangle2)
+        {
+            Vec3 vertices1[3], vertices2[3];
+            if (!getTriangle(quadX1, quadY1, triangle1, vertices1[0], vertices1[1], vertices1[2])
+                || !getTriangle(quadX2, quadY2, triangle2, vertices2[0], vertices2[1], vertices2[2]))
+                return true;
+
+            const Vec3 normal1 = (vertices1[1] - vertices1[0]).Cross(vertices1[2] - vertices1[0]).NormalizedOr(Vec3::Zero());
+            const Vec3 normal2 = (vertices2[1] - vertices2[0]).Cross(vertices2[2] - vertices2[0]).NormalizedOr(Vec3::Zero());
+            const Vec3 edgeDirection = vertices1[(edge1 + 1) % 3] - vertices1[edge1];
+            return ActiveEdges::IsEdgeActive(normal1, normal2, edgeDirection, settings.m_activeEdgeCosThresholdAngle);
+        };
+
+        // One extra byte, so that the flags of a quad can always be read as 16 bits.
+        const size_t numQuads = static_cast<size_t>(quadsPerSide) * quadsPerSide;
+        m_activeEdges.resize((numQuads * 3 + 7) / 8 + 1, 0);
+        for (uint quadY = 0; quadY < quadsPerSide; ++quadY)
+        {
+            for (uint quadX = 0; quadX < quadsPerSide; ++quadX)
+            {
+                uint flags = 0;
+                if (isEdgeActive(quadX, quadY, 0, 2, quadX, quadY, 1))
+                    flags |= 0b001;
+                if (quadX == 0 || isEdgeActive(quadX, quadY, 0, 0, quadX - 1, quadY, 1))
+                    flags |= 0b010;
+                if (quadY == 0 || isEdgeActive(quadX, quadY, 1, 2, quadX, quadY - 1, 0))
+                    flags |= 0b100;
+
+                const size_t bitIndex = (static_cast<size_t>(quadY) * quadsPerSide + quadX) * 3;
+                m_activeEdges[bitIndex >> 3] |= static_cast<uint8>(flags << (bitIndex & 7));
+                m_activeEdges[(bitIndex >> 3) + 1] |= static_cast<uint8>(flags >> (8 - (bitIndex & 7)));
+            }
+        }
+
+        // The sub shape ID is the index of the quad * 2 + the index of the triangle in the quad.
+        const uint32 maxTriangleIndex = static_cast<uint32>(numQuads * 2 - 1);
+        m_numSubShapeIDBits = math::Max(32u - math::CountLeadingZeros(maxTriangleIndex), 1u);
+
+        outResult.Set(this);
+    }
+
+    uint HeightFieldShape::GetSampleBlockIndex(const uint x, const uint y) const
+    {
+        const uint numBlocks = m_levelSizes[0];
+        const uint blockX = math::Min(x / m_blockSize, numBlocks - 1);
+        const uint blockY = math::Min(y / m_blockSize, numBlocks - 1);
+        return blockY * numBlocks + blockX;
+    }
+
+    float HeightFieldShape::GetHeight(const uint x, const uint y) const
+    {
+        NES_ASSERT(x < m_sampleCount && y < m_sampleCount);
+
+        const uint16 sample = m_samples[y * m_sampleCount + x];
+        if (sample == kNoCollisionSample)
+            return HeightFieldShapeSettings::kNoCollisionValue;
+
+        const BlockQuantization& quantization = m_blockQuantization[GetSampleBlockIndex(x, y)];
+        return m_offset.y + m_scale.y * (quantization.m_offset + static_cast<float>(sample) * quantization.m_scale);
+    }
+
+    Vec3 HeightFieldShape::GetPosition(const uint x, const uint y) const
+    {
+        return Vec3(m_offset.x + m_scale.x * static_cast<float>(x), GetHeight(x, y), m_offset.z + m_scale.z * static_cast<float>(y));
+    }
+
+    void HeightFieldShape::GetChildBounds(const uint32 cell, Vec4Reg& outMinX, Vec4Reg& outMinY, Vec4Reg& outMinZ, Vec4Reg& outMaxX, Vec4Reg& outMaxY, Vec4Reg& outMaxZ, UVec4Reg& outChildren) const
+    {
+        const uint childLevel = GetCellLevel(cell) - 1;
+        const uint childSize = m_levelSizes[childLevel];
+        const uint quadsPerSide = m_sampleCount - 1;
+        const uint quadsPerCell = m_blockSize << childLevel;
+
+        alignas(16) float minX[4], minY[4], minZ[4], maxX[4], maxY[4], maxZ[4];
+        alignas(16) uint32 children[4];
+        for (uint i = 0; i < 4; ++i)
+        {
+            const uint childX = 2 * GetCellX(cell) + (i & 1);
+            const uint childY = 2 * GetCellY(cell) + (i >> 1);
+            const RangeBlock* pRange = childX < childSize && childY < childSize? &m_ranges[m_levelOffsets[childLevel] + childY * childSize + childX] : nullptr;
+            if (pRange == nullptr || pRange->m_min > pRange->m_max)
+            {
+                // The child does not exist or only contains holes
+                minX[i] = minY[i] = minZ[i] = maxX[i] = maxY[i] = maxZ[i] = 0.f;
+                children[i] = kInvalidCell;
+                continue;
+            }
+
+            const uint startX = childX * quadsPerCell;
+            const uint startY = childY * quadsPerCell;
+            minX[i] = m_offset.x + m_scale.x * static_cast<float>(startX);
+            minZ[i] = m_offset.z + m_scale.z * static_cast<float>(startY);
+            maxX[i] = m_offset.x + m_scale.x * static_cast<float>(math::Min(startX + quadsPerCell, quadsPerSide));
+            maxZ[i] = m_offset.z + m_scale.z * static_cast<float>(math::Min(startY + quadsPerCell, quadsPerSide));
+            minY[i] = m_offset.y + m_scale.y * (m_rangeOffset + static_cast<float>(pRange->m_min) * m_rangeScale);
+            maxY[i] = m_offset.y + m_scale.y * (m_rangeOffset + static_cast<float>(pRange->m_max) * m_rangeScale);
+            children[i] = MakeCell(childLevel, childX, childY);
+        }
+
+        outMinX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(minX));
+        outMinY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(minY));
+        outMinZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(minZ));
+        outMaxX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(maxX));
+        outMaxY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(maxY));
+        outMaxZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(maxZ));
+        outChildren = UVec4Reg::LoadInt4Aligned(children);
+    }
+
+    void HeightFieldShape::DecodeBlock(const uint blockX, const uint blockY, DecodedBlock& outBlock) const
+    {
+        const uint quadsPerSide = m_sampleCount - 1;
+        outBlock.m_startX = blockX * m_blockSize;
+        outBlock.m_startY = blockY * m_blockSize;
+        outBlock.m_numQuadsX = math::Min(m_blockSize, quadsPerSide - outBlock.m_startX);
+        outBlock.m_numQuadsY = math::Min(m_blockSize, quadsPerSide - outBlock.m_startY);
+        outBlock.m_quadsPerSide = quadsPerSide;
+
+        for (uint y = 0; y <= outBlock.m_numQuadsY; ++y)
+        {
+            for (uint x = 0; x <= outBlock.m_numQuadsX; ++x)
+            {
+                const uint index = y * DecodedBlock::kMaxSamplesPerSide + x;
+                const float height = GetHeight(outBlock.m_startX + x, outBlock.m_startY + y);
+                outBlock.m_isHole[index] = height == HeightFieldShapeSettings::kNoCollisionValue;
+                outBlock.m_positions[index] = Vec3(m_offset.x + m_scale.x * static_cast<float>(outBlock.m_startX + x), height, m_offset.z + m_scale.z * static_cast<float>(outBlock.m_startY + y));
+            }
+        }
+    }
+
+    bool HeightFieldShape::GetQuadRange(const DecodedBlock& block, const AABox& box, uint& outMinX, uint& outMinY, uint& outMaxX, uint& outMaxY) const
+    {
+        // Convert the box to sample coordinates, relative to the block. The range is widened by a quad to be
+        // safe against rounding, the triangles are tested against the box afterward.
+        const float minX = std::floor((box.m_min.x - m_offset.x) / m_scale.x) - static_cast<float>(block.m_startX) - 1.f;
+        const float minY = std::floor((box.m_min.z - m_offset.z) / m_scale.z) - static_cast<float>(block.m_startY) - 1.f;
+        const float maxX = std::floor((box.m_max.x - m_offset.x) / m_scale.x) - static_cast<float>(block.m_startX) + 1.f;
+        const float maxY = std::floor((box.m_max.z - m_offset.z) / m_scale.z) - static_cast<float>(block.m_startY) + 1.f;
+        if (maxX < 0.f || maxY < 0.f || minX >= static_cast<float>(block.m_numQuadsX) || minY >= static_cast<float>(block.m_numQuadsY))
+            return false;
+
+        outMinX = static_cast<uint>(math::Max(minX, 0.f));
+        outMinY = static_cast<uint>(math::Max(minY, 0.f));
+        outMaxX = static_cast<uint>(math::Min(maxX, static_cast<float>(block.m_numQuadsX - 1)));
+        outMaxY = static_cast<uint>(math::Min(maxY, static_cast<float>(block.m_numQuadsY - 1)));
+        return true;
+    }
+
+    template <typename TriangleCallback>
+    void HeightFieldShape::VisitBlockTriangles(const uint blockX, const uint blockY, const AABox& box, TriangleCallback& callback) const
+    {
+        DecodedBlock block;
+        DecodeBlock(blockX, blockY, block);
+
+        uint minX, minY, maxX, maxY;
+        if (!GetQuadRange(block, box, minX, minY, maxX, maxY))
+            return;
+
+        for (uint y = minY; y <= maxY; ++y)
+        {
+            for (uint x = minX; x <= maxX; ++x)
+            {
+                for (uint triangle = 0; triangle < 2; ++triangle)
+                {
+                    Vec3 v0, v1, v2;
+                    if (!block.GetTriangle(x, y, triangle, v0, v1, v2))
+                        continue;
+
+                    // Only report the triangles inside the box
+                    const Vec3 triangleMin = Vec3::Min(Vec3::Min(v0, v1), v2);
+                    const Vec3 triangleMax = Vec3::Max(Vec3::Max(v0, v1), v2);
+                    if (!box.Overlaps(AABox(triangleMin, triangleMax)))
+                        continue;
+
+                    callback(block.GetTriangleIndex(x, y, triangle), v0, v1, v2);
+                }
+            }
+        }
+    }
+
+    uint HeightFieldShape::GetQuadEdgeFlags(const uint quadX, const uint quadY) const
+    {
+        const size_t bitIndex = (static_cast<size_t>(quadY) * (m_sampleCount - 1) + quadX) * 3;
+        const uint value = static_cast<uint>(m_activeEdges[bitIndex >> 3]) | (static_cast<uint>(m_activeEdges[(bitIndex >> 3) + 1]) << 8);
+        return (value >> (bitIndex & 7)) & 0b111;
+    }
+
+    uint8 HeightFieldShape::GetActiveEdges(const uint32 triangleIndex) const
+    {
+        const uint quadsPerSide = m_sampleCount - 1;
+        const uint quad = triangleIndex >> 1;
+        const uint quadX = quad % quadsPerSide;
+        const uint quadY = quad / quadsPerSide;
+        const uint flags = GetQuadEdgeFlags(quadX, quadY);
+        const uint diagonal = flags & 0b001;
+
+        // The edges on the border of the height field have no neighbour and are always active.
+        if ((triangleIndex & 1) == 0)
+        {
+            // Edges: (x, y) -> (x, y + 1), (x, y + 1) -> (x + 1, y + 1), (x + 1, y + 1) -> (x, y)
+            const uint left = (flags >> 1) & 1;
+            const uint top = quadY + 1 < quadsPerSide? (GetQuadEdgeFlags(quadX, quadY + 1) >> 2) & 1 : 1;
+            return static_cast<uint8>(left | (top << 1) | (diagonal << 2));
+        }
+
+        // Edges: (x, y) -> (x + 1, y + 1), (x + 1, y + 1) -> (x + 1, y), (x + 1, y) -> (x, y)
+        const uint right = quadX + 1 < quadsPerSide? (GetQuadEdgeFlags(quadX + 1, quadY) >> 1) & 1 : 1;
+        const uint bottom = (flags >> 2) & 1;
+        return static_cast<uint8>(diagonal | (right << 1) | (bottom << 2));
+    }
+
+    bool HeightFieldShape::GetTriangle(const uint32 triangleIndex, Vec3& outV0, Vec3& outV1, Vec3& outV2, uint8& outActiveEdges) const
+    {
+        const uint quadsPerSide = m_sampleCount - 1;
+        const uint quad = triangleIndex >> 1;
+        const uint x = quad % quadsPerSide;
+        const uint y = quad / quadsPerSide;
+        NES_ASSERT(y < quadsPerSide, "Invalid triangle index!");
+
+        const bool isTriangle0 = (triangleIndex & 1) == 0;
+        const uint x2 = isTriangle0? x : x + 1;
+        const uint y2 = isTriangle0? y + 1 : y;
+        if (GetHeight(x, y) == HeightFieldShapeSettings::kNoCollisionValue
+            || GetHeight(x + 1, y + 1) == HeightFieldShapeSettings::kNoCollisionValue
+            || GetHeight(x2, y2) == HeightFieldShapeSettings::kNoCollisionValue)
+            return false;
+
+        outV0 = GetPosition(x, y);
+        outV1 = isTriangle0? GetPosition(x2, y2) : GetPosition(x + 1, y + 1);
+        outV2 = isTriangle0? GetPosition(x + 1, y + 1) : GetPosition(x2, y2);
+        outActiveEdges = GetActiveEdges(triangleIndex);
+        return true;
+    }
+
+    uint32 HeightFieldShape::GetTriangleIndex(const SubShapeID& subShapeID) const
+    {
+        SubShapeID remainder;
+        const uint32 triangleIndex = subShapeID.PopID(m_numSubShapeIDBits, remainder);
+        NES_ASSERT(remainder.IsEmpty(), "Invalid SubShapeID!");
+        return triangleIndex;
+    }
+
+    MassProperties HeightFieldShape::GetMassProperties() const
+    {
+        // A height field has no volume, so mass properties cannot be calculated. Height fields can only be used on static bodies.
+        return MassProperties();
+    }
+
+    Vec3 HeightFieldShape::GetSurfaceNormal(const SubShapeID& subShapeID, [[maybe_unused]] const Vec3& localSurfacePosition) const
+    {
+        Vec3 v0, v1, v2;
+        uint8 activeEdges;
+        if (!GetTriangle(GetTriangleIndex(subShapeID), v0, v1, v2, activeEdges))
+            return Vec3::AxisY();
+
+        return (v1 - v0).Cross(v2 - v0).Normalized();
+    }
+
+    void HeightFieldShape::GetSupportingFace(const SubShapeID& subShapeID, [[maybe_unused]] const Vec3& direction, const Vec3& scale,
+        const Mat44& centerOfMassTransform, SupportingFace& outVertices) const
+    {
+        Vec3 v0, v1, v2;
+        uint8 activeEdges;
+        if (!GetTriangle(GetTriangleIndex(subShapeID), v0, v1, v2, activeEdges))
+            return;
+
+        const Mat44 transform = centerOfMassTransform * Mat44::MakeScale(scale);
+        outVertices.push_back(transform.TransformPoint(v0));
+        if (ScaleHelpers::IsInsideOut(scale))
+        {
+            // Store the triangle flipped
+            outVertices.push_back(transform.TransformPoint(v2));
+            outVertices.push_back(transform.TransformPoint(v1));
+        }
+        else
+        {
+            outVertices.push_back(transform.TransformPoint(v1));
+            outVertices.push_back(transform.TransformPoint(v2));
+        }
+    }
+
+    bool HeightFieldShape::CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const
+    {
+        RayCastClosestVisitor visitor(*this, ray, hitResult.m_fraction);
+        WalkHierarchy(visitor);
+
+        if (visitor.m_triangleIndex == kInvalidTriangle)
+            return false;
+
+        hitResult.m_fraction = visitor.m_fraction;
+        hitResult.m_subShapeID2 = subShapeIDCreator.PushID(visitor.m_triangleIndex, m_numSubShapeIDBits).GetID();
+        return true;
+    }
+
+    void HeightFieldShape::CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator,
+        CastRayCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        RayCastCollectorVisitor visitor(*this, ray, settings, subShapeIDCreator, collector, shapeFilter);
+        WalkHierarchy(visitor);
+    }
+
+    void HeightFieldShape::CollectTransformedShapes(const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale,
+        const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        // Only add the height field when the box overlaps one of the blocks, not just the bounds of the height field.
+        const Mat44 worldToCOM = Mat44::MakeRotationTranslation(rotation, positionCOM).InversedRotationTranslation();
+        CollectTransformedShapesVisitor visitor(ScaleHelpers::UnscaleBox(box.Transformed(worldToCOM), scale));
+        WalkHierarchy(visitor);
+        if (!visitor.m_foundBlock)
+            return;
+
+        TransformedShape tShape(RVec3(positionCOM), rotation, this, TransformedShape::GetBodyID(collector.GetContext()), subShapeIDCreator);
+        tShape.SetShapeScale(scale);
+        collector.AddHit(tShape);
+    }
+
+    void HeightFieldShape::GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& positionCOM,
+        const Quat& rotation, const Vec3& scale) const
+    {
+        static_assert(sizeof(HSGetTrianglesContext) <= sizeof(GetTrianglesContext), "GetTrianglesContext is too small!");
+        NES_ASSERT(math::IsAligned(&context, alignof(HSGetTrianglesContext)));
+
+        new (&context) HSGetTrianglesContext(*this, box, positionCOM, rotation, scale);
+    }
+
+    int HeightFieldShape::GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested, Float3* outTriangleVertices) const
+    {
+        NES_ASSERT(maxTrianglesRequested >= kGetTrianglesMinTrianglesRequested);
+
+        HSGetTrianglesContext& hsContext = reinterpret_cast<HSGetTrianglesContext&>(context);
+
+        int totalNumTriangles = 0;
+        while (totalNumTriangles < maxTrianglesRequested)
+        {
+            // Output the triangles of the current block
+            if (hsContext.m_nextTriangle < hsContext.m_numTriangles)
+            {
+                Vec3 v0, v1, v2;
+                uint8 activeEdges;
+                GetTriangle(hsContext.m_triangles[hsContext.m_nextTriangle++], v0, v1, v2, activeEdges);
+
+                hsContext.m_localToWorld.TransformPoint(v0).StoreFloat3(outTriangleVertices++);
+                if (hsContext.m_isInsideOut)
+                {
+                    // Store the triangle flipped
+                    hsContext.m_localToWorld.TransformPoint(v2).StoreFloat3(outTriangleVertices++);
+                    hsContext.m_localToWorld.TransformPoint(v1).StoreFloat3(outTriangleVertices++);
+                }
+                else
+                {
+                    hsContext.m_localToWorld.TransformPoint(v1).StoreFloat3(outTriangleVertices++);
+                    hsContext.m_localToWorld.TransformPoint(v2).StoreFloat3(outTriangleVertices++);
+                }
+
+                ++totalNumTriangles;
+                continue;
+            }
+
+            // Done when the stack is empty
+            if (hsContext.m_stackTop < 0)
+                break;
+
+            const uint32 cell = hsContext.m_stack[hsContext.m_stackTop--];
+            if (GetCellLevel(cell) == 0)
+            {
+                hsContext.m_numTriangles = 0;
+                hsContext.m_nextTriangle = 0;
+                VisitBlockTriangles(GetCellX(cell), GetCellY(cell), hsContext.m_localBox, hsContext);
+                continue;
+            }
+
+            Vec4Reg minX, minY, minZ, maxX, maxY, maxZ;
+            UVec4Reg children;
+            GetChildBounds(cell, minX, minY, minZ, maxX, maxY, maxZ, children);
+            const UVec4Reg isValid = UVec4Reg::Not(UVec4Reg::Equals(children, UVec4Reg::Replicate(kInvalidCell)));
+
+            NES_ASSERT(hsContext.m_stackTop + 4 < kStackSize, "Stack overflow!");
+            const int numChildren = CountAndSortTrues(UVec4Reg::And(math::AABox4VsAABox(hsContext.m_localBox, minX, minY, minZ, maxX, maxY, maxZ), isValid), children);
+            children.StoreInt4(&hsContext.m_stack[hsContext.m_stackTop + 1]);
+            hsContext.m_stackTop += numChildren;
+        }
+
+        // [TODO]:
+        // Store Materials
+
+        return totalNumTriangles;
+    }
+
+    size_t HeightFieldShape::GetMemoryUsage() const
+    {
+        return sizeof(*this)
+            + m_samples.size() * sizeof(uint16)
+            + m_blockQuantization.size() * sizeof(BlockQuantization)
+            + m_ranges.size() * sizeof(RangeBlock)
+            + m_activeEdges.size() * sizeof(uint8);
+    }
+
+    void HeightFieldShape::CollideConvexVsHeightField(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2,
+        const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape1->GetType() == EShapeType::Convex);
+        NES_ASSERT(pShape2->GetSubType() == EShapeSubType::HeightField);
+        const ConvexShape* pConvex1 = checked_cast<const ConvexShape*>(pShape1);
+        const HeightFieldShape* pHeightField2 = checked_cast<const HeightFieldShape*>(pShape2);
+
+        CollideConvexVsTriangles collider(pConvex1, scale1, scale2, centerOfMassTransform1, centerOfMassTransform2, subShapeIDCreator1.GetID(), collideShapeSettings, collector);
+
+        struct Callback
+        {
+            bool ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            void operator()(const uint32 triangleIndex, const Vec3& v0, const Vec3& v1, const Vec3& v2)
+            {
+                if (ShouldAbort())
+                    return;
+
+                const SubShapeID subShapeID2 = m_subShapeIDCreator2.PushID(triangleIndex, m_heightField.m_numSubShapeIDBits).GetID();
+                if (!m_shapeFilter.ShouldCollide(m_pShape1, m_subShapeIDCreator1.GetID(), &m_heightField, subShapeID2))
+                    return;
+
+                const uint8 activeEdges = m_heightField.GetActiveEdges(triangleIndex);
+                if (m_isInsideOut)
+                    m_collider.Collide(v0 * m_scale2, v2 * m_scale2, v1 * m_scale2, ActiveEdges::FlipWinding(activeEdges), subShapeID2);
+                else
+                    m_collider.Collide(v0 * m_scale2, v1 * m_scale2, v2 * m_scale2, activeEdges, subShapeID2);
+            }
+
+            const HeightFieldShape&     m_heightField;
+            const Shape*                m_pShape1;
+            const SubShapeIDCreator&    m_subShapeIDCreator1;
+            const SubShapeIDCreator&    m_subShapeIDCreator2;
+            const ShapeFilter&          m_shapeFilter;
+            CollideShapeCollector&      m_collector;
+            CollideConvexVsTriangles&   m_collider;
+            Vec3                        m_scale2;
+            bool                        m_isInsideOut;
+        };
+
+        Callback callback { *pHeightField2, pShape1, subShapeIDCreator1, subShapeIDCreator2, shapeFilter, collector, collider, scale2, ScaleHelpers::IsInsideOut(scale2) };
+        BoxVisitor<Callback> visitor(*pHeightField2, ScaleHelpers::UnscaleBox(collider.GetBoundsOf1InSpaceOf2(), scale2), callback);
+        pHeightField2->WalkHierarchy(visitor);
+    }
+
+    void HeightFieldShape::CastConvexVsHeightField(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape,
+        const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector)
+    {
+        NES_ASSERT(pShape->GetSubType() == EShapeSubType::HeightField);
+        const HeightFieldShape* pHeightField = checked_cast<const HeightFieldShape*>(pShape);
+
+        CastConvexVsTriangles caster(shapeCast, shapeCastSettings, centerOfMassTransform2, subShapeIDCreator1, collector);
+
+        struct Callback
+        {
+            bool ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            void operator()(const uint32 triangleIndex, const Vec3& v0, const Vec3& v1, const Vec3& v2)
+            {
+                if (ShouldAbort())
+                    return;
+
+                const SubShapeID subShapeID2 = m_subShapeIDCreator2.PushID(triangleIndex, m_heightField.m_numSubShapeIDBits).GetID();
+                if (!m_shapeFilter.ShouldCollide(m_pCastShape, m_subShapeIDCreator1.GetID(), &m_heightField, subShapeID2))
+                    return;
+
+                const uint8 activeEdges = m_heightField.GetActiveEdges(triangleIndex);
+                if (m_isInsideOut)
+                    m_caster.Cast(v0 * m_scale, v2 * m_scale, v1 * m_scale, ActiveEdges::FlipWinding(activeEdges), subShapeID2);
+                else
+                    m_caster.Cast(v0 * m_scale, v1 * m_scale, v2 * m_scale, activeEdges, subShapeID2);
+            }
+
+            const HeightFieldShape&     m_heightField;
+            const Shape*                m_pCastShape;
+            const SubShapeIDCreator&    m_subShapeIDCreator1;
+            const SubShapeIDCreator&    m_subShapeIDCreator2;
+            const ShapeFilter&          m_shapeFilter;
+            CastShapeCollector&         m_collector;
+            CastConvexVsTriangles&      m_caster;
+            Vec3                        m_scale;
+            bool                        m_isInsideOut;
+        };
+
+        Callback callback { *pHeightField, shapeCast.m_pShape, subShapeIDCreator1, subShapeIDCreator2, shapeFilter, collector, caster, scale, ScaleHelpers::IsInsideOut(scale) };
+        SweptBoxVisitor<Callback> visitor(*pHeightField, shapeCast, scale, collector, callback);
+        pHeightField->WalkHierarchy(visitor);
+    }
+
+    void HeightFieldShape::Register()
+    {
+        ShapeFunctions& f = ShapeFunctions::Get(EShapeSubType::HeightField);
+        f.m_construct = []() -> Shape* { return new HeightFieldShape; };
+        f.m_color = Color::Magenta();
+
+        for (const EShapeSubType subType : kConvexSubShapeTypes)
+        {
+            CollisionSolver::RegisterCollideShape(subType, EShapeSubType::HeightField, CollideConvexVsHeightField);
+            CollisionSolver::RegisterCastShape(subType, EShapeSubType::HeightField, CastConvexVsHeightField);
+
+            CollisionSolver::RegisterCollideShape(EShapeSubType::HeightField, subType, CollisionSolver::ReversedCollideShape);
+            CollisionSolver::RegisterCastShape(EShapeSubType::HeightField, subType, CollisionSolver::ReversedCastShape);
+        }
+    }
+}
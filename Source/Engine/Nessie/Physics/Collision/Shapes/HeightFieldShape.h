@@ -0,0 +1,303 @@
+// HeightFieldShape.h
+#pragma once
+#include "Shape.h"
+#include "SubShapeID.h"
+
+namespace nes
+{
+    struct CollideShapeSettings;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings that create a Height Field Shape.
+    //----------------------------------------------------------------------------------------------------
+    class HeightFieldShapeSettings final : public ShapeSettings
+    {
+    public:
+        /// Height value that marks a sample as a hole. Triangles that use a hole sample do not collide.
+        static constexpr float  kNoCollisionValue = FLT_MAX;
+
+        /// Height samples, m_sampleCount x m_sampleCount values. Sample (x, y) is stored at index (y * m_sampleCount + x).
+        std::vector<float>      m_heightSamples{};
+
+        /// Sample (x, y) is positioned at m_offset + m_scale * (x, height, y). All components of the scale must be positive.
+        Vec3                    m_offset = Vec3::Zero();
+        Vec3                    m_scale = Vec3::One();
+
+        /// Number of samples along each side of the height field. Must be at least 2.
+        uint                    m_sampleCount = 0;
+
+        /// The height field is divided into blocks of m_blockSize x m_blockSize quads, in the range [2, 8]. Each block
+        /// has its own quantization range, and is the smallest unit of the min/max hierarchy. Smaller blocks give more precise
+        /// samples and a tighter hierarchy, at the cost of memory.
+        uint                    m_blockSize = 4;
+
+        /// Cosine of the threshold angle. If the angle between two triangles is bigger than this, the edge is active.
+        /// Setting this to -1 makes all edges active. Default is cos(5 degrees).
+        float                   m_activeEdgeCosThresholdAngle = 0.996195f;
+
+        HeightFieldShapeSettings() = default;
+        HeightFieldShapeSettings(const float* pSamples, const Vec3& offset, const Vec3& scale, const uint sampleCount);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ShapeSettings::Create()
+        //----------------------------------------------------------------------------------------------------
+        virtual ShapeResult     Create() const override;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A shape for terrain, made from a regular grid of height samples. Height fields can only be
+    ///     used on static bodies. Each grid cell (quad) is split into two triangles, counter-clockwise when
+    ///     seen from above (+Y).
+    ///
+    /// Each sample is stored as 16 bits. The value is relative to the quantization range of the block it
+    /// belongs to. For every block, the hierarchy stores the min and max height of the samples it uses.
+    /// Each level above that combines 2 x 2 cells. Queries walk down this hierarchy and test 4 cells at a time.
+    /// Ray casts visit cells front to back, so they march along the ray. Box queries only visit the blocks they
+    /// overlap, and only return the triangles inside the query box.
+    /// @note : Samples on the border of a block are used by the neighbouring blocks as well. The bounds of a block
+    ///     include these samples, so the triangles are always inside the bounds of the block.
+    //----------------------------------------------------------------------------------------------------
+    class HeightFieldShape final : public Shape
+    {
+    public:
+        HeightFieldShape() : Shape(EShapeType::HeightField, EShapeSubType::HeightField) {}
+        HeightFieldShape(const HeightFieldShapeSettings& settings, ShapeResult& outResult);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::MustBeStatic()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            MustBeStatic() const override           { return true; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetLocalBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetLocalBounds() const override         { return m_bounds; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSubSShapeIDBitsRecursive()
+        //----------------------------------------------------------------------------------------------------
+        virtual unsigned        GetSubSShapeIDBitsRecursive() const override { return m_numSubShapeIDBits; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetInnerRadius()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetInnerRadius() const override         { return 0.f; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetMassProperties()
+        //----------------------------------------------------------------------------------------------------
+        virtual MassProperties  GetMassProperties() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSurfaceNormal()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            GetSurfaceNormal(const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSupportingFace()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction, const Vec3& scale, const Mat44& centerOfMassTransform, SupportingFace& outVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : A height field has no volume, so a point is never inside of it.
+        /// @see : Shape::CollidePoint()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollidePoint(const Vec3&, const SubShapeIDCreator&, CollidePointCollector&, const ShapeFilter&) const override {}
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Adds this shape to the collector if the box overlaps a block of the height field that
+        ///     is not a hole.
+        /// @see : Shape::CollectTransformedShapes()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollectTransformedShapes(const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale, const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesStart()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesNext()
+        //----------------------------------------------------------------------------------------------------
+        virtual int             GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested, Float3* outTriangleVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetVolume()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetVolume() const override              { return 0.f; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of samples along each side of the height field.
+        //----------------------------------------------------------------------------------------------------
+        uint                    GetSampleCount() const                  { return m_sampleCount; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the height of a sample after quantization, in the local space of the shape.
+        ///     Returns HeightFieldShapeSettings::kNoCollisionValue when the sample is a hole.
+        //----------------------------------------------------------------------------------------------------
+        float                   GetHeight(const uint x, const uint y) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the local space position of a sample. The sample must not be a hole.
+        //----------------------------------------------------------------------------------------------------
+        Vec3                    GetPosition(const uint x, const uint y) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of bytes used by the samples, the hierarchy and the active edges.
+        //----------------------------------------------------------------------------------------------------
+        size_t                  GetMemoryUsage() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Register shape functions within the registry. This also registers the collision functions
+        ///     of all convex shapes against the height field, so it must be called after ConvexShape::Register().
+        //----------------------------------------------------------------------------------------------------
+        static void             Register();
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Quantization range of the samples of a block: height = m_offset + sample * m_scale.
+        //----------------------------------------------------------------------------------------------------
+        struct BlockQuantization
+        {
+            float               m_offset;
+            float               m_scale;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Height range of a cell of the hierarchy, quantized to the height range of the whole shape.
+        ///     A cell that only contains holes has m_min > m_max.
+        //----------------------------------------------------------------------------------------------------
+        struct RangeBlock
+        {
+            uint16              m_min;
+            uint16              m_max;
+        };
+
+        /// Quantized value of a sample that is a hole.
+        static constexpr uint16 kNoCollisionSample = 0xffff;
+
+        /// Max number of levels of the hierarchy. A cell is referenced by its level (4 bits) and its x and y
+        /// coordinate (14 bits each) within that level.
+        static constexpr uint   kMaxLevels = 15;
+        static constexpr uint   kCellCoordinateBits = 14;
+        static constexpr uint32 kCellCoordinateMask = (1u << kCellCoordinateBits) - 1;
+        static constexpr uint32 kInvalidCell = 0xffffffff;
+
+        /// Max size of the stack used to walk the hierarchy.
+        static constexpr int    kStackSize = 4 * kMaxLevels;
+
+        static constexpr uint   kMinBlockSize = 2;
+        static constexpr uint   kMaxBlockSize = 8;
+
+        /// Decoded samples of a block, see DecodeBlock().
+        struct DecodedBlock;
+
+        /// Hierarchy visitors, see WalkHierarchy().
+        class RayCastClosestVisitor;
+        class RayCastCollectorVisitor;
+        class CollectTransformedShapesVisitor;
+        template <typename TriangleCallback> class BoxVisitor;
+        template <typename TriangleCallback> class SweptBoxVisitor;
+
+        /// Class for GetTrianglesStart/Next()
+        class HSGetTrianglesContext;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Walk the hierarchy, see HeightFieldShape.cpp for the interface of the visitor.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Visitor>
+        void                    WalkHierarchy(Visitor& visitor) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the bounds of the 4 children of a cell of the hierarchy. Children that do not exist or
+        ///     that only contain holes are set to kInvalidCell.
+        //----------------------------------------------------------------------------------------------------
+        void                    GetChildBounds(const uint32 cell, Vec4Reg& outMinX, Vec4Reg& outMinY, Vec4Reg& outMinZ, Vec4Reg& outMaxX, Vec4Reg& outMaxY, Vec4Reg& outMaxZ, UVec4Reg& outChildren) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Decode the positions of the samples that are used by the quads of a block.
+        //----------------------------------------------------------------------------------------------------
+        void                    DecodeBlock(const uint blockX, const uint blockY, DecodedBlock& outBlock) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the range of quads of a block that can overlap a box in the local space of the shape.
+        ///     The range is relative to the first quad of the block, and the max is inclusive.
+        ///	@returns : False if no quad overlaps the box.
+        //----------------------------------------------------------------------------------------------------
+        bool                    GetQuadRange(const DecodedBlock& block, const AABox& box, uint& outMinX, uint& outMinY, uint& outMaxX, uint& outMaxY) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Call the callback for every triangle of a block that overlaps a box in the local space of
+        ///     the shape. Triangles that use a hole sample are skipped. The callback implements
+        ///     'void operator()(uint32 triangleIndex, const Vec3& v0, const Vec3& v1, const Vec3& v2)'.
+        //----------------------------------------------------------------------------------------------------
+        template <typename TriangleCallback>
+        void                    VisitBlockTriangles(const uint blockX, const uint blockY, const AABox& box, TriangleCallback& callback) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the active edge flags of a triangle. Bit 'i' is set when the edge from vertex 'i' to
+        ///     vertex 'i + 1' is active.
+        //----------------------------------------------------------------------------------------------------
+        uint8                   GetActiveEdges(const uint32 triangleIndex) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the 3 stored active edge bits of a quad, see HeightFieldShape.cpp.
+        //----------------------------------------------------------------------------------------------------
+        inline uint             GetQuadEdgeFlags(const uint quadX, const uint quadY) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the vertices and active edges of a triangle.
+        ///	@returns : False if the triangle uses a hole sample.
+        //----------------------------------------------------------------------------------------------------
+        bool                    GetTriangle(const uint32 triangleIndex, Vec3& outV0, Vec3& outV1, Vec3& outV2, uint8& outActiveEdges) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the triangle index from a sub shape ID.
+        //----------------------------------------------------------------------------------------------------
+        inline uint32           GetTriangleIndex(const SubShapeID& subShapeID) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the index of the block that stores the quantization range of a sample.
+        //----------------------------------------------------------------------------------------------------
+        inline uint             GetSampleBlockIndex(const uint x, const uint y) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Collides a convex shape with the triangles
+        ///     of the height field.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideConvexVsHeightField(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Casts a convex shape against the triangles
+        ///     of the height field.
+        //----------------------------------------------------------------------------------------------------
+        static void             CastConvexVsHeightField(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape, const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector);
+
+    private:
+        std::vector<uint16>             m_samples{};            /// Quantized samples, see BlockQuantization.
+        std::vector<BlockQuantization>  m_blockQuantization{};  /// Quantization range per block.
+        std::vector<RangeBlock>         m_ranges{};             /// Min/max hierarchy, all levels after each other. Level 0 has a cell per block.
+        std::vector<uint8>              m_activeEdges{};        /// 3 bits per quad, see GetQuadEdgeFlags().
+        uint32                          m_levelOffsets[kMaxLevels] {}; /// Index of the first cell of each level in m_ranges.
+        uint                            m_levelSizes[kMaxLevels] {};   /// Number of cells along each side for each level.
+        AABox                           m_bounds{};
+        Vec3                            m_offset = Vec3::Zero();
+        Vec3                            m_scale = Vec3::One();
+        float                           m_rangeOffset = 0.f;    /// Quantization of the hierarchy: height = m_rangeOffset + value * m_rangeScale.
+        float                           m_rangeScale = 0.f;
+        uint                            m_sampleCount = 0;
+        uint                            m_blockSize = 4;
+        uint                            m_numLevels = 0;
+        uint                            m_numSubShapeIDBits = 1;
+    };
+}
@@ -0,0 +1,1247 @@
+// MeshShape.cpp
+#include "MeshShape.h"
+
+#include <algorithm>
+#include "ConvexShape.h"
+#include "GetTrianglesContext.h"
+#include "ScaleHelpers.h"
+#include "Nessie/Geometry/AABoxSIMD.h"
+#include "Nessie/Geometry/RayAABox.h"
+#include "Nessie/Geometry/RayTriangle.h"
+#include "Nessie/Physics/Collision/ActiveEdges.h"
+#include "Nessie/Physics/Collision/CastConvexVsTriangles.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/CollideConvexVsTriangles.h"
+#include "Nessie/Physics/Collision/CollidePointResult.h"
+#include "Nessie/Physics/Collision/CollisionSolver.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Physics/Collision/ShapeCast.h"
+#include "Nessie/Physics/Collision/SortReverseAndStore.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+
+namespace nes
+{
+    /// Max value of a quantized node bound. One step of headroom is left at the top so that the rounding of the
+    /// dequantized max bound cannot end up below the bounds of the mesh.
+    static constexpr uint   kNodeQuantizeSteps = 0xfffe;
+    static constexpr uint16 kNodeQuantizeMax = 0xffff;
+
+    /// Number of bins used to evaluate the Surface Area Heuristic.
+    static constexpr uint   kNumSAHBins = 16;
+
+    /// Below this depth of the tree, nodes are split at the median instead of with the SAH. This bounds the depth
+    /// of the tree (and with that the stack size needed to walk it) when the SAH keeps choosing unbalanced splits.
+    static constexpr uint   kMaxSAHDepth = 16;
+
+    /// Window of vertices that a TriangleBlock can reference with its 8-bit indices. A block adds at most
+    /// 12 vertices, which need to be in range as well.
+    static constexpr uint32 kVertexWindow = 256 - 12;
+
+    static constexpr uint32 kInvalidTriangle = 0xffffffff;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Load 4 uint16 values, zero extended to 32 bits.
+    //----------------------------------------------------------------------------------------------------
+    static NES_INLINE UVec4Reg LoadUInt16x4(const uint16* pValues)
+    {
+    #if defined(NES_USE_SSE4_1)
+        return _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pValues)));
+    #else
+        return UVec4Reg(pValues[0], pValues[1], pValues[2], pValues[3]);
+    #endif
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Test a box against the bounds of 4 children of a node. Unlike RayAABox4(), AABox4VsAABox() does
+    ///     not reject the inverted bounds of empty children, so they are masked out here.
+    //----------------------------------------------------------------------------------------------------
+    static NES_INLINE UVec4Reg AABoxVsChildren(const AABox& box, const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, const UVec4Reg& children, const uint32 invalidChild)
+    {
+        const UVec4Reg isValid = UVec4Reg::Not(UVec4Reg::Equals(children, UVec4Reg::Replicate(invalidChild)));
+        return UVec4Reg::And(math::AABox4VsAABox(box, minX, minY, minZ, maxX, maxY, maxZ), isValid);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Builds the tree of the mesh. Nodes are split top-down: the child with the most triangles
+    ///     is split with a binned SAH until the node is full or all children fit in a leaf.
+    //----------------------------------------------------------------------------------------------------
+    class MeshShape::TreeBuilder
+    {
+    public:
+        TreeBuilder(MeshShape& shape, const MeshShapeSettings& settings, const std::vector<uint64>& quantizedVertices, const std::vector<Vec3>& positions, const std::vector<uint8>& activeEdges, const uint maxTrianglesPerLeaf)
+            : m_shape(shape)
+            , m_settings(settings)
+            , m_quantizedVertices(quantizedVertices)
+            , m_activeEdges(activeEdges)
+            , m_maxTrianglesPerLeaf(maxTrianglesPerLeaf)
+            , m_vertexRemap(quantizedVertices.size(), kInvalidTriangle)
+        {
+            m_triangles.reserve(settings.m_indexedTriangles.size());
+            for (uint32 i = 0; i < static_cast<uint32>(settings.m_indexedTriangles.size()); ++i)
+            {
+                const IndexedTriangle& triangle = settings.m_indexedTriangles[i];
+                BuildTriangle& buildTriangle = m_triangles.emplace_back();
+                buildTriangle.m_bounds.Encapsulate(positions[triangle[0]]);
+                buildTriangle.m_bounds.Encapsulate(positions[triangle[1]]);
+                buildTriangle.m_bounds.Encapsulate(positions[triangle[2]]);
+                buildTriangle.m_centroid = buildTriangle.m_bounds.Center();
+                buildTriangle.m_index = i;
+            }
+
+            for (int axis = 0; axis < 3; ++axis)
+                m_inverseNodeScale[axis] = m_shape.m_nodeScale[axis] > 0.f? 1.f / m_shape.m_nodeScale[axis] : 0.f;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Build the tree and return the root node.
+        //----------------------------------------------------------------------------------------------------
+        uint32 Build()
+        {
+            const size_t numTriangles = m_triangles.size();
+            m_shape.m_triangleBlocks.reserve((numTriangles + 3) / 4 + numTriangles / 8);
+            m_shape.m_vertices.reserve(m_quantizedVertices.size());
+            return BuildNode(0, static_cast<uint>(numTriangles), 0);
+        }
+
+    private:
+        struct BuildTriangle
+        {
+            AABox   m_bounds;
+            Vec3    m_centroid;
+            uint32  m_index;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a node for the triangles in the range [begin, end).
+        //----------------------------------------------------------------------------------------------------
+        uint32 BuildNode(const uint begin, const uint end, const uint depth)
+        {
+            // Allocate the node, all children start out empty.
+            NodeBlock emptyBlock;
+            for (uint i = 0; i < 4; ++i)
+            {
+                emptyBlock.m_minX[i] = emptyBlock.m_minY[i] = emptyBlock.m_minZ[i] = kNodeQuantizeMax;
+                emptyBlock.m_maxX[i] = emptyBlock.m_maxY[i] = emptyBlock.m_maxZ[i] = 0;
+                emptyBlock.m_children[i] = kInvalidChild;
+            }
+
+            const uint32 nodeIndex = static_cast<uint32>(m_shape.m_nodes.size());
+            const uint nodeWidth = m_shape.m_nodeWidth;
+            m_shape.m_nodes.insert(m_shape.m_nodes.end(), nodeWidth / 4, emptyBlock);
+
+            // Split the triangles into groups, always splitting the biggest group that doesn't fit in a leaf.
+            uint groupBegin[8] = { begin };
+            uint groupEnd[8] = { end };
+            uint numGroups = 1;
+            while (numGroups < nodeWidth)
+            {
+                uint splitGroup = numGroups;
+                uint maxCount = m_maxTrianglesPerLeaf;
+                for (uint i = 0; i < numGroups; ++i)
+                {
+                    const uint count = groupEnd[i] - groupBegin[i];
+                    if (count > maxCount)
+                    {
+                        splitGroup = i;
+                        maxCount = count;
+                    }
+                }
+
+                if (splitGroup == numGroups)
+                    break;
+
+                const uint split = Split(groupBegin[splitGroup], groupEnd[splitGroup], depth);
+                groupBegin[numGroups] = split;
+                groupEnd[numGroups] = groupEnd[splitGroup];
+                groupEnd[splitGroup] = split;
+                ++numGroups;
+            }
+
+            // Create the children. Leaves are emitted in depth first order, so that the triangles of
+            // neighbouring leaves are close together in memory.
+            for (uint i = 0; i < numGroups; ++i)
+            {
+                const uint32 child = groupEnd[i] - groupBegin[i] <= m_maxTrianglesPerLeaf
+                    ? BuildLeaf(groupBegin[i], groupEnd[i])
+                    : BuildNode(groupBegin[i], groupEnd[i], depth + 1);
+
+                // [Note]: Get the block after building the child, building can resize the node array.
+                NodeBlock& block = m_shape.m_nodes[nodeIndex + i / 4];
+                const uint slot = i % 4;
+                block.m_children[slot] = child;
+
+                const AABox bounds = GetBounds(groupBegin[i], groupEnd[i]);
+                block.m_minX[slot] = QuantizeMin(bounds.m_min.x, 0);
+                block.m_minY[slot] = QuantizeMin(bounds.m_min.y, 1);
+                block.m_minZ[slot] = QuantizeMin(bounds.m_min.z, 2);
+                block.m_maxX[slot] = QuantizeMax(bounds.m_max.x, 0);
+                block.m_maxY[slot] = QuantizeMax(bounds.m_max.y, 1);
+                block.m_maxZ[slot] = QuantizeMax(bounds.m_max.z, 2);
+            }
+
+            return nodeIndex;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Store the triangles in the range [begin, end) in triangle blocks, and return the leaf reference.
+        //----------------------------------------------------------------------------------------------------
+        uint32 BuildLeaf(const uint begin, const uint end)
+        {
+            const uint numTriangles = end - begin;
+            NES_ASSERT(numTriangles > 0 && numTriangles <= 8);
+
+            const uint32 firstBlock = static_cast<uint32>(m_shape.m_triangleBlocks.size());
+            NES_ASSERT(firstBlock <= kLeafBlockMask);
+
+            std::vector<uint64>& vertices = m_shape.m_vertices;
+            for (uint blockBegin = begin; blockBegin < end; blockBegin += 4)
+            {
+                // Vertices that were already added and are within the window of the block are shared,
+                // otherwise they are added again.
+                const uint32 numVertices = static_cast<uint32>(vertices.size());
+                TriangleBlock& block = m_shape.m_triangleBlocks.emplace_back();
+                block.m_vertexBase = numVertices > kVertexWindow? numVertices - kVertexWindow : 0;
+
+                const uint blockEnd = math::Min(blockBegin + 4, end);
+                for (uint t = 0; t < 4; ++t)
+                {
+                    // Unused triangles reference the first vertex of the window, so that they can be decoded safely.
+                    if (blockBegin + t >= blockEnd)
+                    {
+                        block.m_indices[0][t] = block.m_indices[1][t] = block.m_indices[2][t] = 0;
+                        block.m_activeEdges[t] = 0;
+                        continue;
+                    }
+
+                    const uint32 triangleIndex = m_triangles[blockBegin + t].m_index;
+                    const IndexedTriangle& triangle = m_settings.m_indexedTriangles[triangleIndex];
+                    for (uint corner = 0; corner < 3; ++corner)
+                    {
+                        uint32& outputIndex = m_vertexRemap[triangle[corner]];
+                        if (outputIndex == kInvalidTriangle || outputIndex < block.m_vertexBase)
+                        {
+                            outputIndex = static_cast<uint32>(vertices.size());
+                            vertices.push_back(m_quantizedVertices[triangle[corner]]);
+                        }
+
+                        NES_ASSERT(outputIndex - block.m_vertexBase <= 0xff);
+                        block.m_indices[corner][t] = static_cast<uint8>(outputIndex - block.m_vertexBase);
+                    }
+                    block.m_activeEdges[t] = m_activeEdges[triangleIndex];
+                }
+            }
+
+            return kLeafBit | ((numTriangles - 1) << kLeafNumTrianglesShift) | firstBlock;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Partition the triangles in the range [begin, end) in two, and return the start of the second half.
+        //----------------------------------------------------------------------------------------------------
+        uint Split(const uint begin, const uint end, const uint depth)
+        {
+            NES_ASSERT(end - begin > 1);
+
+            // Split along the axis where the centroids are the furthest apart.
+            AABox centroidBounds;
+            for (uint i = begin; i < end; ++i)
+                centroidBounds.Encapsulate(m_triangles[i].m_centroid);
+            const Vec3 centroidSize = centroidBounds.Size();
+            const int axis = centroidSize.MaxComponentIndex();
+
+            const uint median = (begin + end) / 2;
+            if (depth >= kMaxSAHDepth || centroidSize[axis] <= 1.0e-12f)
+                return SplitAtMedian(begin, end, axis);
+
+            // Put the triangles in bins based on their centroid.
+            const float binScale = static_cast<float>(kNumSAHBins) / centroidSize[axis];
+            const float binOffset = centroidBounds.m_min[axis];
+            auto getBin = [binScale, binOffset, axis](const BuildTriangle& triangle)
+            {
+                return math::Min(static_cast<uint>((triangle.m_centroid[axis] - binOffset) * binScale), kNumSAHBins - 1);
+            };
+
+            AABox binBounds[kNumSAHBins];
+            uint binCounts[kNumSAHBins] = {};
+            for (uint i = begin; i < end; ++i)
+            {
+                const uint bin = getBin(m_triangles[i]);
+                binBounds[bin].Encapsulate(m_triangles[i].m_bounds);
+                ++binCounts[bin];
+            }
+
+            // Sweep from the right to get the cost of the right side of each split.
+            float rightCosts[kNumSAHBins];
+            AABox rightBounds;
+            uint rightCount = 0;
+            for (uint bin = kNumSAHBins - 1; bin > 0; --bin)
+            {
+                rightBounds.Encapsulate(binBounds[bin]);
+                rightCount += binCounts[bin];
+                rightCosts[bin] = rightCount > 0? rightBounds.SurfaceArea() * static_cast<float>(rightCount) : 0.f;
+            }
+
+            // Sweep from the left to find the split with the lowest cost. Split 'i' puts bins [0, i) on the left.
+            uint bestSplit = 0;
+            float bestCost = FLT_MAX;
+            AABox leftBounds;
+            uint leftCount = 0;
+            for (uint split = 1; split < kNumSAHBins; ++split)
+            {
+                leftBounds.Encapsulate(binBounds[split - 1]);
+                leftCount += binCounts[split - 1];
+                if (leftCount == 0 || leftCount == end - begin)
+                    continue;
+
+                const float cost = leftBounds.SurfaceArea() * static_cast<float>(leftCount) + rightCosts[split];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestSplit = split;
+                }
+            }
+
+            if (bestSplit == 0)
+                return SplitAtMedian(begin, end, axis);
+
+            const auto it = std::partition(m_triangles.begin() + begin, m_triangles.begin() + end, [&getBin, bestSplit](const BuildTriangle& triangle)
+            {
+                return getBin(triangle) < bestSplit;
+            });
+
+            const uint split = static_cast<uint>(it - m_triangles.begin());
+            return split == begin || split == end? median : split;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Partition the triangles in the range [begin, end) in two halves along an axis.
+        //----------------------------------------------------------------------------------------------------
+        uint SplitAtMedian(const uint begin, const uint end, const int axis)
+        {
+            const uint median = (begin + end) / 2;
+            std::nth_element(m_triangles.begin() + begin, m_triangles.begin() + median, m_triangles.begin() + end, [axis](const BuildTriangle& a, const BuildTriangle& b)
+            {
+                return a.m_centroid[axis] < b.m_centroid[axis];
+            });
+            return median;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the bounds of the triangles in the range [begin, end).
+        //----------------------------------------------------------------------------------------------------
+        AABox GetBounds(const uint begin, const uint end) const
+        {
+            AABox bounds;
+            for (uint i = begin; i < end; ++i)
+                bounds.Encapsulate(m_triangles[i].m_bounds);
+            return bounds;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Quantize a min bound, rounding down. The result is corrected until dequantizing it (with
+        ///     the same operations as GetNodeBounds()) gives a value that is not larger than the input.
+        //----------------------------------------------------------------------------------------------------
+        uint16 QuantizeMin(const float value, const int axis) const
+        {
+            const float offset = m_shape.m_bounds.m_min[axis];
+            const float scale = m_shape.m_nodeScale[axis];
+            int quantized = math::Clamp(static_cast<int>(std::floor((value - offset) * m_inverseNodeScale[axis])), 0, static_cast<int>(kNodeQuantizeSteps));
+            while (quantized > 0 && offset + static_cast<float>(quantized) * scale > value)
+                --quantized;
+            return static_cast<uint16>(quantized);
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Quantize a max bound, rounding up. The result is corrected until dequantizing it gives
+        ///     a value that is not smaller than the input.
+        //----------------------------------------------------------------------------------------------------
+        uint16 QuantizeMax(const float value, const int axis) const
+        {
+            const float offset = m_shape.m_bounds.m_min[axis];
+            const float scale = m_shape.m_nodeScale[axis];
+            int quantized = math::Clamp(static_cast<int>(std::ceil((value - offset) * m_inverseNodeScale[axis])), 0, static_cast<int>(kNodeQuantizeMax));
+            while (quantized < kNodeQuantizeMax && offset + static_cast<float>(quantized) * scale < value)
+                ++quantized;
+            return static_cast<uint16>(quantized);
+        }
+
+    private:
+        MeshShape&                  m_shape;
+        const MeshShapeSettings&    m_settings;
+        const std::vector<uint64>&  m_quantizedVertices;
+        const std::vector<uint8>&   m_activeEdges;
+        uint                        m_maxTrianglesPerLeaf;
+        std::vector<BuildTriangle>  m_triangles;
+        std::vector<uint32>         m_vertexRemap;      /// Index in the output vertex array of each input vertex, or kInvalidTriangle when not added yet.
+        Vec3                        m_inverseNodeScale;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // A visitor for MeshShape::WalkTree() implements:
+    //  - bool ShouldAbort() const : Return true to stop walking the tree.
+    //  - bool ShouldVisitNode(int stackTop) const : Return false to skip the node at the top of the stack.
+    //  - int VisitNodes(minX, minY, minZ, maxX, maxY, maxZ, UVec4Reg& ioChildren, int stackTop) : Test the
+    //      bounds of 4 children. Move the children that should be visited to the front of ioChildren and return
+    //      how many there are. The first child will be stored at stackTop.
+    //  - void VisitTriangles(uint32 firstBlock, uint numTriangles) : Visit the triangles of a leaf.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Visitor>
+    void MeshShape::WalkTree(Visitor& visitor) const
+    {
+        const uint numBlocksPerNode = m_nodeWidth / 4;
+
+        uint32 stack[kStackSize];
+        stack[0] = m_rootNode;
+        int top = 0;
+        do
+        {
+            // Pop the top of the stack
+            const uint32 child = stack[top];
+            const bool shouldVisit = visitor.ShouldVisitNode(top);
+            --top;
+            if (!shouldVisit)
+                continue;
+
+            if (child & kLeafBit)
+            {
+                visitor.VisitTriangles(child & kLeafBlockMask, ((child >> kLeafNumTrianglesShift) & 0b111) + 1);
+            }
+            else
+            {
+                for (uint i = 0; i < numBlocksPerNode; ++i)
+                {
+                    const NodeBlock& block = m_nodes[child + i];
+
+                    Vec4Reg minX, minY, minZ, maxX, maxY, maxZ;
+                    GetNodeBounds(block, minX, minY, minZ, maxX, maxY, maxZ);
+                    UVec4Reg children = UVec4Reg::LoadInt4(block.m_children);
+
+                    NES_ASSERT(top + 4 < kStackSize, "Stack overflow!");
+                    const int numChildren = visitor.VisitNodes(minX, minY, minZ, maxX, maxY, maxZ, children, top + 1);
+                    children.StoreInt4(&stack[top + 1]);
+                    top += numChildren;
+                }
+            }
+        }
+        while (top >= 0 && !visitor.ShouldAbort());
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Finds the closest hit of a ray with the mesh.
+    //----------------------------------------------------------------------------------------------------
+    class MeshShape::RayCastClosestVisitor
+    {
+    public:
+        RayCastClosestVisitor(const MeshShape& shape, const RayCast& ray, const float maxFraction)
+            : m_shape(shape)
+            , m_ray(ray)
+            , m_invDirection(ray.m_direction)
+            , m_fraction(maxFraction)
+        {
+            m_distanceStack[0] = 0.f;
+        }
+
+        bool ShouldAbort() const                            { return m_fraction <= 0.f; }
+        bool ShouldVisitNode(const int stackTop) const      { return m_distanceStack[stackTop] < m_fraction; }
+
+        int VisitNodes(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, UVec4Reg& ioChildren, const int stackTop)
+        {
+            const Vec4Reg distance = RayAABox4(m_ray.m_origin, m_invDirection, minX, minY, minZ, maxX, maxY, maxZ);
+            return SortReverseAndStore(distance, m_fraction, ioChildren, &m_distanceStack[stackTop]);
+        }
+
+        void VisitTriangles(const uint32 firstBlock, const uint numTriangles)
+        {
+            const uint numBlocks = (numTriangles + 3) / 4;
+            for (uint i = 0; i < numBlocks; ++i)
+            {
+                const uint32 blockIndex = firstBlock + i;
+                Vec4Reg vertices[9];
+                m_shape.GetTriangleBlockVertices(m_shape.m_triangleBlocks[blockIndex], vertices);
+
+                float fractions[4];
+                RayTriangle4(m_ray.m_origin, m_ray.m_direction, vertices[0], vertices[1], vertices[2], vertices[3], vertices[4], vertices[5], vertices[6], vertices[7], vertices[8]).StoreFloat4(reinterpret_cast<Float4*>(fractions));
+
+                const uint numInBlock = math::Min(numTriangles - i * 4, 4u);
+                for (uint t = 0; t < numInBlock; ++t)
+                {
+                    if (fractions[t] < m_fraction)
+                    {
+                        m_fraction = fractions[t];
+                        m_triangleIndex = blockIndex * 4 + t;
+                    }
+                }
+            }
+        }
+
+        const MeshShape&    m_shape;
+        RayCast             m_ray;
+        RayInvDirection     m_invDirection;
+        float               m_fraction;
+        uint32              m_triangleIndex = kInvalidTriangle;
+        float               m_distanceStack[kStackSize];
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Reports all hits of a ray with the mesh to a collector.
+    //----------------------------------------------------------------------------------------------------
+    class MeshShape::RayCastCollectorVisitor
+    {
+    public:
+        RayCastCollectorVisitor(const MeshShape& shape, const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter)
+            : m_shape(shape)
+            , m_ray(ray)
+            , m_invDirection(ray.m_direction)
+            , m_settings(settings)
+            , m_subShapeIDCreator(subShapeIDCreator)
+            , m_collector(collector)
+            , m_shapeFilter(shapeFilter)
+        {
+            m_distanceStack[0] = 0.f;
+        }
+
+        bool ShouldAbort() const                            { return m_collector.ShouldEarlyOut(); }
+        bool ShouldVisitNode(const int stackTop) const      { return m_distanceStack[stackTop] < m_collector.GetEarlyOutFraction(); }
+
+        int VisitNodes(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, UVec4Reg& ioChildren, const int stackTop)
+        {
+            const Vec4Reg distance = RayAABox4(m_ray.m_origin, m_invDirection, minX, minY, minZ, maxX, maxY, maxZ);
+            return SortReverseAndStore(distance, m_collector.GetEarlyOutFraction(), ioChildren, &m_distanceStack[stackTop]);
+        }
+
+        void VisitTriangles(const uint32 firstBlock, const uint numTriangles)
+        {
+            const uint numBlocks = (numTriangles + 3) / 4;
+            for (uint i = 0; i < numBlocks; ++i)
+            {
+                const uint32 blockIndex = firstBlock + i;
+                Vec4Reg vertices[9];
+                m_shape.GetTriangleBlockVertices(m_shape.m_triangleBlocks[blockIndex], vertices);
+
+                float fractions[4];
+                RayTriangle4(m_ray.m_origin, m_ray.m_direction, vertices[0], vertices[1], vertices[2], vertices[3], vertices[4], vertices[5], vertices[6], vertices[7], vertices[8]).StoreFloat4(reinterpret_cast<Float4*>(fractions));
+
+                const uint numInBlock = math::Min(numTriangles - i * 4, 4u);
+                for (uint t = 0; t < numInBlock; ++t)
+                {
+                    if (fractions[t] >= m_collector.GetEarlyOutFraction())
+                        continue;
+
+                    const uint32 triangleIndex = blockIndex * 4 + t;
+                    Vec3 v0, v1, v2;
+                    uint8 activeEdges;
+                    m_shape.GetTriangle(triangleIndex, v0, v1, v2, activeEdges);
+
+                    // Check if we hit the back side of the triangle
+                    const bool isBackFacing = (v1 - v0).Cross(v2 - v0).Dot(m_ray.m_direction) > 0.f;
+                    if (isBackFacing && m_settings.m_backfaceModeTriangles == EBackFaceMode::IgnoreBackFaces)
+                        continue;
+
+                    const SubShapeID subShapeID = m_subShapeIDCreator.PushID(triangleIndex, m_shape.m_numSubShapeIDBits).GetID();
+                    if (!m_shapeFilter.ShouldCollide(&m_shape, subShapeID))
+                        continue;
+
+                    RayCastResult hit;
+                    hit.m_bodyID = TransformedShape::GetBodyID(m_collector.GetContext());
+                    hit.m_fraction = fractions[t];
+                    hit.m_subShapeID2 = subShapeID;
+                    m_collector.AddHit(hit);
+                }
+            }
+        }
+
+        const MeshShape&            m_shape;
+        RayCast                     m_ray;
+        RayInvDirection             m_invDirection;
+        const RayCastSettings&      m_settings;
+        const SubShapeIDCreator&    m_subShapeIDCreator;
+        CastRayCollector&           m_collector;
+        const ShapeFilter&          m_shapeFilter;
+        float                       m_distanceStack[kStackSize];
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Checks if any leaf of the tree overlaps a box.
+    //----------------------------------------------------------------------------------------------------
+    class MeshShape::CollectTransformedShapesVisitor
+    {
+    public:
+        explicit CollectTransformedShapesVisitor(const AABox& box) : m_box(box) {}
+
+        bool ShouldAbort() const                            { return m_foundLeaf; }
+        bool ShouldVisitNode(const int) const               { return true; }
+
+        int VisitNodes(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, UVec4Reg& ioChildren, const int)
+        {
+            const UVec4Reg hit = AABoxVsChildren(m_box, minX, minY, minZ, maxX, maxY, maxZ, ioChildren, kInvalidChild);
+            return CountAndSortTrues(hit, ioChildren);
+        }
+
+        void VisitTriangles(const uint32, const uint)       { m_foundLeaf = true; }
+
+        AABox   m_box;
+        bool    m_foundLeaf = false;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Calls the callback for every triangle in a leaf that overlaps a box. The callback implements
+    ///     'bool ShouldAbort() const' and 'void operator()(uint32 triangleIndex)'.
+    //----------------------------------------------------------------------------------------------------
+    template <typename TriangleCallback>
+    class MeshShape::BoxVisitor
+    {
+    public:
+        BoxVisitor(const AABox& box, TriangleCallback& callback) : m_box(box), m_callback(callback) {}
+
+        bool ShouldAbort() const                            { return m_callback.ShouldAbort(); }
+        bool ShouldVisitNode(const int) const               { return true; }
+
+        int VisitNodes(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, UVec4Reg& ioChildren, const int)
+        {
+            const UVec4Reg hit = AABoxVsChildren(m_box, minX, minY, minZ, maxX, maxY, maxZ, ioChildren, kInvalidChild);
+            return CountAndSortTrues(hit, ioChildren);
+        }
+
+        void VisitTriangles(const uint32 firstBlock, const uint numTriangles)
+        {
+            for (uint32 triangleIndex = firstBlock * 4; triangleIndex < firstBlock * 4 + numTriangles && !m_callback.ShouldAbort(); ++triangleIndex)
+                m_callback(triangleIndex);
+        }
+
+        AABox               m_box;
+        TriangleCallback&   m_callback;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Calls the callback for every triangle in a leaf that a box sweeps through, closest leaves first.
+    ///     The node bounds are scaled to the space of the cast. See BoxVisitor for the callback interface.
+    //----------------------------------------------------------------------------------------------------
+    template <typename TriangleCallback>
+    class MeshShape::SweptBoxVisitor
+    {
+    public:
+        SweptBoxVisitor(const ShapeCast& shapeCast, const Vec3& scale, const CastShapeCollector& collector, TriangleCallback& callback)
+            : m_boxCenter(shapeCast.m_shapeWorldBounds.Center())
+            , m_boxExtent(shapeCast.m_shapeWorldBounds.Extent())
+            , m_invDirection(shapeCast.m_direction)
+            , m_scale(scale)
+            , m_collector(collector)
+            , m_callback(callback)
+        {
+            m_distanceStack[0] = 0.f;
+        }
+
+        bool ShouldAbort() const                            { return m_callback.ShouldAbort(); }
+        bool ShouldVisitNode(const int stackTop) const      { return m_distanceStack[stackTop] < m_collector.GetPositiveEarlyOutFraction(); }
+
+        int VisitNodes(const Vec4Reg& minX, const Vec4Reg& minY, const Vec4Reg& minZ, const Vec4Reg& maxX, const Vec4Reg& maxY, const Vec4Reg& maxZ, UVec4Reg& ioChildren, const int stackTop)
+        {
+            // Scale the bounds of the children, and enlarge them by the extent of the cast shape.
+            Vec4Reg scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ;
+            math::AABox4Scale(m_scale, minX, minY, minZ, maxX, maxY, maxZ, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+            math::AABox4EnlargeWithExtent(m_boxExtent, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+
+            // Cast the center of the box against the enlarged bounds. A negative scale swaps the inverted bounds of
+            // empty children back into valid bounds, so these are excluded explicitly.
+            Vec4Reg distance = RayAABox4(m_boxCenter, m_invDirection, scaledMinX, scaledMinY, scaledMinZ, scaledMaxX, scaledMaxY, scaledMaxZ);
+            distance = Vec4Reg::Select(distance, Vec4Reg::Replicate(FLT_MAX), UVec4Reg::Equals(ioChildren, UVec4Reg::Replicate(kInvalidChild)));
+            return SortReverseAndStore(distance, m_collector.GetPositiveEarlyOutFraction(), ioChildren, &m_distanceStack[stackTop]);
+        }
+
+        void VisitTriangles(const uint32 firstBlock, const uint numTriangles)
+        {
+            for (uint32 triangleIndex = firstBlock * 4; triangleIndex < firstBlock * 4 + numTriangles && !m_callback.ShouldAbort(); ++triangleIndex)
+                m_callback(triangleIndex);
+        }
+
+        Vec3                        m_boxCenter;
+        Vec3                        m_boxExtent;
+        RayInvDirection             m_invDirection;
+        Vec3                        m_scale;
+        const CastShapeCollector&   m_collector;
+        TriangleCallback&           m_callback;
+        float                       m_distanceStack[kStackSize];
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Returns the triangles of the leaves that overlap a box.
+    //----------------------------------------------------------------------------------------------------
+    class MeshShape::MSGetTrianglesContext
+    {
+    public:
+        MSGetTrianglesContext(const MeshShape& shape, const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale)
+            : m_localToWorld(Mat44::MakeRotationTranslation(rotation, positionCOM) * Mat44::MakeScale(scale))
+            , m_isInsideOut(ScaleHelpers::IsInsideOut(scale))
+        {
+            // Get the box in the unscaled space of the mesh
+            const Mat44 worldToCOM = Mat44::MakeRotationTranslation(rotation, positionCOM).InversedRotationTranslation();
+            m_localBox = ScaleHelpers::UnscaleBox(box.Transformed(worldToCOM), scale);
+            m_stack[0] = shape.m_rootNode;
+        }
+
+        Mat44               m_localToWorld;
+        AABox               m_localBox;
+        bool                m_isInsideOut;
+        uint32              m_nextTriangle = 0;         /// Next triangle of the current leaf.
+        uint                m_numLeafTrianglesLeft = 0; /// Number of triangles left in the current leaf.
+        int                 m_stackTop = 0;
+        uint32              m_stack[kStackSize];
+    };
+
+    MeshShapeSettings::MeshShapeSettings(std::vector<Float3> vertices, std::vector<IndexedTriangle> triangles)
+        : m_triangleVertices(std::move(vertices))
+        , m_indexedTriangles(std::move(triangles))
+    {
+        Sanitize();
+    }
+
+    void MeshShapeSettings::Sanitize()
+    {
+        // Sort a copy of the triangles, rotated so that the lowest index comes first. Equivalent triangles end up next to each other.
+        std::vector<std::pair<IndexedTriangle, uint32>> sorted;
+        sorted.reserve(m_indexedTriangles.size());
+        for (uint32 i = 0; i < static_cast<uint32>(m_indexedTriangles.size()); ++i)
+        {
+            IndexedTriangle triangle = m_indexedTriangles[i];
+            while (triangle[0] > triangle[1] || triangle[0] > triangle[2])
+                triangle = IndexedTriangle(triangle[1], triangle[2], triangle[0]);
+            sorted.emplace_back(triangle, i);
+        }
+
+        std::sort(sorted.begin(), sorted.end(), [](const std::pair<IndexedTriangle, uint32>& a, const std::pair<IndexedTriangle, uint32>& b)
+        {
+            if (a.first[0] != b.first[0]) return a.first[0] < b.first[0];
+            if (a.first[1] != b.first[1]) return a.first[1] < b.first[1];
+            if (a.first[2] != b.first[2]) return a.first[2] < b.first[2];
+            return a.second < b.second;
+        });
+
+        std::vector<bool> remove(m_indexedTriangles.size(), false);
+        for (size_t i = 1; i < sorted.size(); ++i)
+        {
+            if (sorted[i].first.IsEquivalent(sorted[i - 1].first))
+                remove[sorted[i].second] = true;
+        }
+
+        // Remove the duplicates and the degenerate triangles, keeping the order of the remaining triangles.
+        // [Note]: Triangles with an out of range index are kept, MeshShape reports them as an error.
+        const uint32 numVertices = static_cast<uint32>(m_triangleVertices.size());
+        size_t numKept = 0;
+        for (size_t i = 0; i < m_indexedTriangles.size(); ++i)
+        {
+            const IndexedTriangle& triangle = m_indexedTriangles[i];
+            const bool isInRange = triangle[0] < numVertices && triangle[1] < numVertices && triangle[2] < numVertices;
+            if (remove[i] || (isInRange && triangle.IsDegenerate(m_triangleVertices.data())))
+                continue;
+
+            m_indexedTriangles[numKept++] = triangle;
+        }
+        m_indexedTriangles.resize(numKept);
+    }
+
+    ShapeSettings::ShapeResult MeshShapeSettings::Create() const
+    {
+        if (m_cachedResult.IsEmpty())
+        {
+            StrongPtr<Shape> pShape = new MeshShape(*this, m_cachedResult);
+        }
+        return m_cachedResult;
+    }
+
+    MeshShape::MeshShape(const MeshShapeSettings& settings, ShapeResult& outResult)
+        : Shape(EShapeType::Mesh, EShapeSubType::Mesh, settings, outResult)
+    {
+        const std::vector<Float3>& inputVertices = settings.m_triangleVertices;
+        const std::vector<IndexedTriangle>& inputTriangles = settings.m_indexedTriangles;
+
+        if (inputTriangles.empty())
+        {
+            outResult.SetError("Need at least 1 triangle to create a Mesh Shape!");
+            return;
+        }
+
+        if (settings.m_nodeWidth != 4 && settings.m_nodeWidth != 8)
+        {
+            outResult.SetError("Mesh Shape node width must be 4 or 8!");
+            return;
+        }
+
+        // Leaves can reference at most kLeafBlockMask triangle blocks, and in the worst case every triangle has its own block.
+        if (inputTriangles.size() > static_cast<size_t>(kLeafBlockMask))
+        {
+            outResult.SetError("Too many triangles to create a Mesh Shape!");
+            return;
+        }
+
+        // Get the bounds of the vertices that are used.
+        const uint32 numVertices = static_cast<uint32>(inputVertices.size());
+        AABox vertexBounds;
+        for (const IndexedTriangle& triangle : inputTriangles)
+        {
+            for (uint corner = 0; corner < 3; ++corner)
+            {
+                if (triangle[corner] >= numVertices)
+                {
+                    outResult.SetError("Mesh Shape triangle index out of range!");
+                    return;
+                }
+                vertexBounds.Encapsulate(Vec3(inputVertices[triangle[corner]]));
+            }
+        }
+
+        // Quantize the vertices. The bounds of the mesh are calculated from the quantized positions, so that
+        // the tree contains the triangles exactly as they are tested.
+        m_quantizeOffset = vertexBounds.m_min;
+        m_vertexScale = vertexBounds.Size() / static_cast<float>(kVertexMask);
+        Vec3 inverseVertexScale;
+        for (int axis = 0; axis < 3; ++axis)
+            inverseVertexScale[axis] = m_vertexScale[axis] > 0.f? 1.f / m_vertexScale[axis] : 0.f;
+
+        std::vector<uint64> quantizedVertices(numVertices, 0);
+        std::vector<Vec3> positions(numVertices, Vec3::Zero());
+        for (uint32 i = 0; i < numVertices; ++i)
+        {
+            const Vec3 relative = (Vec3(inputVertices[i]) - m_quantizeOffset) * inverseVertexScale;
+            uint64 quantized = 0;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const uint64 component = static_cast<uint64>(math::Clamp(std::round(relative[axis]), 0.f, static_cast<float>(kVertexMask)));
+                quantized |= component << (axis * kVertexBits);
+            }
+
+            quantizedVertices[i] = quantized;
+            positions[i] = DequantizeVertex(quantized);
+        }
+
+        m_bounds = AABox();
+        for (const IndexedTriangle& triangle : inputTriangles)
+        {
+            for (uint corner = 0; corner < 3; ++corner)
+                m_bounds.Encapsulate(positions[triangle[corner]]);
+        }
+        m_nodeScale = m_bounds.Size() / static_cast<float>(kNodeQuantizeSteps);
+
+        // Find the active edges. Each edge is stored with the lowest vertex index first, so that the edges
+        // shared by two triangles end up next to each other after sorting.
+        struct Edge
+        {
+            uint64  m_key;
+            uint32  m_triangle;
+            uint32  m_edge;
+        };
+
+        std::vector<Edge> edges;
+        edges.reserve(inputTriangles.size() * 3);
+        for (uint32 i = 0; i < static_cast<uint32>(inputTriangles.size()); ++i)
+        {
+            for (uint32 edge = 0; edge < 3; ++edge)
+            {
+                const uint32 index0 = inputTriangles[i][edge];
+                const uint32 index1 = inputTriangles[i][(edge + 1) % 3];
+                edges.push_back({ (static_cast<uint64>(math::Min(index0, index1)) << 32) | math::Max(index0, index1), i, edge });
+            }
+        }
+        std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.m_key < b.m_key; });
+
+        auto getNormal = [&inputVertices](const IndexedTriangle& triangle)
+        {
+            const Vec3 v0(inputVertices[triangle[0]]);
+            return (Vec3(inputVertices[triangle[1]]) - v0).Cross(Vec3(inputVertices[triangle[2]]) - v0).NormalizedOr(Vec3::Zero());
+        };
+
+        std::vector<uint8> activeEdges(inputTriangles.size(), 0);
+        for (size_t begin = 0; begin < edges.size();)
+        {
+            size_t end = begin + 1;
+            while (end < edges.size() && edges[end].m_key == edges[begin].m_key)
+                ++end;
+
+            // Edges that are not shared or that are shared by more than two triangles are always active.
+            bool isActive = true;
+            if (end - begin == 2)
+            {
+                const Edge& edge1 = edges[begin];
+                const Edge& edge2 = edges[begin + 1];
+                const IndexedTriangle& triangle1 = inputTriangles[edge1.m_triangle];
+                const Vec3 edgeDirection = Vec3(inputVertices[triangle1[(edge1.m_edge + 1) % 3]]) - Vec3(inputVertices[triangle1[edge1.m_edge]]);
+                isActive = ActiveEdges::IsEdgeActive(getNormal(triangle1), getNormal(inputTriangles[edge2.m_triangle]), edgeDirection, settings.m_activeEdgeCosThresholdAngle);
+            }
+
+            if (isActive)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    activeEdges[edges[i].m_triangle] |= static_cast<uint8>(1 << edges[i].m_edge);
+            }
+
+            begin = end;
+        }
+
+        // Build the tree
+        m_nodeWidth = settings.m_nodeWidth;
+        m_numTriangles = static_cast<uint>(inputTriangles.size());
+        TreeBuilder builder(*this, settings, quantizedVertices, positions, activeEdges, math::Clamp(settings.m_maxTrianglesPerLeaf, 1u, 8u));
+        m_rootNode = builder.Build();
+
+        // Release the memory that was reserved up front.
+        m_nodes.shrink_to_fit();
+        m_triangleBlocks.shrink_to_fit();
+        m_vertices.shrink_to_fit();
+
+        // The sub shape ID is the index of the triangle block * 4 + the index of the triangle in the block.
+        const uint32 maxTriangleIndex = static_cast<uint32>(m_triangleBlocks.size()) * 4 - 1;
+        m_numSubShapeIDBits = math::Max(32u - math::CountLeadingZeros(maxTriangleIndex), 1u);
+
+        outResult.Set(this);
+    }
+
+    Vec3 MeshShape::DequantizeVertex(const uint64 quantizedVertex) const
+    {
+        const Vec3 quantized
+        (
+            static_cast<float>(quantizedVertex & kVertexMask),
+            static_cast<float>((quantizedVertex >> kVertexBits) & kVertexMask),
+            static_cast<float>((quantizedVertex >> (2 * kVertexBits)) & kVertexMask)
+        );
+        return m_quantizeOffset + quantized * m_vertexScale;
+    }
+
+    void MeshShape::GetNodeBounds(const NodeBlock& block, Vec4Reg& outMinX, Vec4Reg& outMinY, Vec4Reg& outMinZ, Vec4Reg& outMaxX, Vec4Reg& outMaxY, Vec4Reg& outMaxZ) const
+    {
+        const Vec4Reg offsetX = Vec4Reg::Replicate(m_bounds.m_min.x);
+        const Vec4Reg offsetY = Vec4Reg::Replicate(m_bounds.m_min.y);
+        const Vec4Reg offsetZ = Vec4Reg::Replicate(m_bounds.m_min.z);
+        const Vec4Reg scaleX = Vec4Reg::Replicate(m_nodeScale.x);
+        const Vec4Reg scaleY = Vec4Reg::Replicate(m_nodeScale.y);
+        const Vec4Reg scaleZ = Vec4Reg::Replicate(m_nodeScale.z);
+
+        outMinX = offsetX + LoadUInt16x4(block.m_minX).ToFloat() * scaleX;
+        outMinY = offsetY + LoadUInt16x4(block.m_minY).ToFloat() * scaleY;
+        outMinZ = offsetZ + LoadUInt16x4(block.m_minZ).ToFloat() * scaleZ;
+        outMaxX = offsetX + LoadUInt16x4(block.m_maxX).ToFloat() * scaleX;
+        outMaxY = offsetY + LoadUInt16x4(block.m_maxY).ToFloat() * scaleY;
+        outMaxZ = offsetZ + LoadUInt16x4(block.m_maxZ).ToFloat() * scaleZ;
+    }
+
+    void MeshShape::GetTriangleBlockVertices(const TriangleBlock& block, Vec4Reg* outVertices) const
+    {
+        alignas(16) float components[9][4];
+        for (uint corner = 0; corner < 3; ++corner)
+        {
+            for (uint t = 0; t < 4; ++t)
+            {
+                const Vec3 vertex = DequantizeVertex(m_vertices[block.m_vertexBase + block.m_indices[corner][t]]);
+                components[corner * 3 + 0][t] = vertex.x;
+                components[corner * 3 + 1][t] = vertex.y;
+                components[corner * 3 + 2][t] = vertex.z;
+            }
+        }
+
+        for (uint i = 0; i < 9; ++i)
+            outVertices[i] = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(components[i]));
+    }
+
+    void MeshShape::GetTriangle(const uint32 triangleIndex, Vec3& outV0, Vec3& outV1, Vec3& outV2, uint8& outActiveEdges) const
+    {
+        NES_ASSERT(triangleIndex / 4 < m_triangleBlocks.size());
+        const TriangleBlock& block = m_triangleBlocks[triangleIndex / 4];
+        const uint t = triangleIndex % 4;
+        outV0 = DequantizeVertex(m_vertices[block.m_vertexBase + block.m_indices[0][t]]);
+        outV1 = DequantizeVertex(m_vertices[block.m_vertexBase + block.m_indices[1][t]]);
+        outV2 = DequantizeVertex(m_vertices[block.m_vertexBase + block.m_indices[2][t]]);
+        outActiveEdges = block.m_activeEdges[t];
+    }
+
+    uint32 MeshShape::GetTriangleIndex(const SubShapeID& subShapeID) const
+    {
+        SubShapeID remainder;
+        const uint32 triangleIndex = subShapeID.PopID(m_numSubShapeIDBits, remainder);
+        NES_ASSERT(remainder.IsEmpty(), "Invalid SubShapeID!");
+        return triangleIndex;
+    }
+
+    MassProperties MeshShape::GetMassProperties() const
+    {
+        // A mesh has no volume, so mass properties cannot be calculated. Mesh shapes can only be used on static bodies.
+        return MassProperties();
+    }
+
+    Vec3 MeshShape::GetSurfaceNormal(const SubShapeID& subShapeID, [[maybe_unused]] const Vec3& localSurfacePosition) const
+    {
+        Vec3 v0, v1, v2;
+        uint8 activeEdges;
+        GetTriangle(GetTriangleIndex(subShapeID), v0, v1, v2, activeEdges);
+        return (v1 - v0).Cross(v2 - v0).Normalized();
+    }
+
+    void MeshShape::GetSupportingFace(const SubShapeID& subShapeID, [[maybe_unused]] const Vec3& direction, const Vec3& scale,
+        const Mat44& centerOfMassTransform, SupportingFace& outVertices) const
+    {
+        Vec3 v0, v1, v2;
+        uint8 activeEdges;
+        GetTriangle(GetTriangleIndex(subShapeID), v0, v1, v2, activeEdges);
+
+        const Mat44 transform = centerOfMassTransform * Mat44::MakeScale(scale);
+        outVertices.push_back(transform.TransformPoint(v0));
+        if (ScaleHelpers::IsInsideOut(scale))
+        {
+            // Store the triangle flipped
+            outVertices.push_back(transform.TransformPoint(v2));
+            outVertices.push_back(transform.TransformPoint(v1));
+        }
+        else
+        {
+            outVertices.push_back(transform.TransformPoint(v1));
+            outVertices.push_back(transform.TransformPoint(v2));
+        }
+    }
+
+    bool MeshShape::CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const
+    {
+        RayCastClosestVisitor visitor(*this, ray, hitResult.m_fraction);
+        WalkTree(visitor);
+
+        if (visitor.m_triangleIndex == kInvalidTriangle)
+            return false;
+
+        hitResult.m_fraction = visitor.m_fraction;
+        hitResult.m_subShapeID2 = subShapeIDCreator.PushID(visitor.m_triangleIndex, m_numSubShapeIDBits).GetID();
+        return true;
+    }
+
+    void MeshShape::CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator,
+        CastRayCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        RayCastCollectorVisitor visitor(*this, ray, settings, subShapeIDCreator, collector, shapeFilter);
+        WalkTree(visitor);
+    }
+
+    void MeshShape::CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector,
+        const ShapeFilter& shapeFilter) const
+    {
+        // Count the number of triangles that a ray from the point hits, which is odd when the point is inside.
+        CollidePointUsingRayCast(*this, point, subShapeIDCreator, collector, shapeFilter);
+    }
+
+    void MeshShape::CollectTransformedShapes(const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale,
+        const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        // Only add the mesh when the box overlaps one of the leaves, not just the bounds of the mesh.
+        const Mat44 worldToCOM = Mat44::MakeRotationTranslation(rotation, positionCOM).InversedRotationTranslation();
+        CollectTransformedShapesVisitor visitor(ScaleHelpers::UnscaleBox(box.Transformed(worldToCOM), scale));
+        WalkTree(visitor);
+        if (!visitor.m_foundLeaf)
+            return;
+
+        TransformedShape tShape(RVec3(positionCOM), rotation, this, TransformedShape::GetBodyID(collector.GetContext()), subShapeIDCreator);
+        tShape.SetShapeScale(scale);
+        collector.AddHit(tShape);
+    }
+
+    void MeshShape::GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& positionCOM,
+        const Quat& rotation, const Vec3& scale) const
+    {
+        static_assert(sizeof(MSGetTrianglesContext) <= sizeof(GetTrianglesContext), "GetTrianglesContext is too small!");
+        NES_ASSERT(math::IsAligned(&context, alignof(MSGetTrianglesContext)));
+
+        new (&context) MSGetTrianglesContext(*this, box, positionCOM, rotation, scale);
+    }
+
+    int MeshShape::GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested, Float3* outTriangleVertices) const
+    {
+        NES_ASSERT(maxTrianglesRequested >= kGetTrianglesMinTrianglesRequested);
+
+        MSGetTrianglesContext& msContext = reinterpret_cast<MSGetTrianglesContext&>(context);
+        const uint numBlocksPerNode = m_nodeWidth / 4;
+
+        int totalNumTriangles = 0;
+        while (totalNumTriangles < maxTrianglesRequested)
+        {
+            // Output the triangles of the current leaf
+            if (msContext.m_numLeafTrianglesLeft > 0)
+            {
+                Vec3 v0, v1, v2;
+                uint8 activeEdges;
+                GetTriangle(msContext.m_nextTriangle, v0, v1, v2, activeEdges);
+
+                msContext.m_localToWorld.TransformPoint(v0).StoreFloat3(outTriangleVertices++);
+                if (msContext.m_isInsideOut)
+                {
+                    // Store the triangle flipped
+                    msContext.m_localToWorld.TransformPoint(v2).StoreFloat3(outTriangleVertices++);
+                    msContext.m_localToWorld.TransformPoint(v1).StoreFloat3(outTriangleVertices++);
+                }
+                else
+                {
+                    msContext.m_localToWorld.TransformPoint(v1).StoreFloat3(outTriangleVertices++);
+                    msContext.m_localToWorld.TransformPoint(v2).StoreFloat3(outTriangleVertices++);
+                }
+
+                ++msContext.m_nextTriangle;
+                --msContext.m_numLeafTrianglesLeft;
+                ++totalNumTriangles;
+                continue;
+            }
+
+            // Done when the stack is empty
+            if (msContext.m_stackTop < 0)
+                break;
+
+            const uint32 child = msContext.m_stack[msContext.m_stackTop--];
+            if (child & kLeafBit)
+            {
+                msContext.m_nextTriangle = (child & kLeafBlockMask) * 4;
+                msContext.m_numLeafTrianglesLeft = ((child >> kLeafNumTrianglesShift) & 0b111) + 1;
+                continue;
+            }
+
+            for (uint i = 0; i < numBlocksPerNode; ++i)
+            {
+                const NodeBlock& block = m_nodes[child + i];
+
+                Vec4Reg minX, minY, minZ, maxX, maxY, maxZ;
+                GetNodeBounds(block, minX, minY, minZ, maxX, maxY, maxZ);
+                UVec4Reg children = UVec4Reg::LoadInt4(block.m_children);
+
+                NES_ASSERT(msContext.m_stackTop + 4 < kStackSize, "Stack overflow!");
+                const int numChildren = CountAndSortTrues(AABoxVsChildren(msContext.m_localBox, minX, minY, minZ, maxX, maxY, maxZ, children, kInvalidChild), children);
+                children.StoreInt4(&msContext.m_stack[msContext.m_stackTop + 1]);
+                msContext.m_stackTop += numChildren;
+            }
+        }
+
+        // [TODO]:
+        // Store Materials
+
+        return totalNumTriangles;
+    }
+
+    size_t MeshShape::GetMemoryUsage() const
+    {
+        return sizeof(*this)
+            + m_nodes.size() * sizeof(NodeBlock)
+            + m_triangleBlocks.size() * sizeof(TriangleBlock)
+            + m_vertices.size() * sizeof(uint64);
+    }
+
+    void MeshShape::CollideConvexVsMesh(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2,
+        const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape1->GetType() == EShapeType::Convex);
+        NES_ASSERT(pShape2->GetSubType() == EShapeSubType::Mesh);
+        const ConvexShape* pConvex1 = checked_cast<const ConvexShape*>(pShape1);
+        const MeshShape* pMesh2 = checked_cast<const MeshShape*>(pShape2);
+
+        CollideConvexVsTriangles collider(pConvex1, scale1, scale2, centerOfMassTransform1, centerOfMassTransform2, subShapeIDCreator1.GetID(), collideShapeSettings, collector);
+
+        struct Callback
+        {
+            bool ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            void operator()(const uint32 triangleIndex)
+            {
+                const SubShapeID subShapeID2 = m_subShapeIDCreator2.PushID(triangleIndex, m_mesh.m_numSubShapeIDBits).GetID();
+                if (!m_shapeFilter.ShouldCollide(m_pShape1, m_subShapeIDCreator1.GetID(), &m_mesh, subShapeID2))
+                    return;
+
+                Vec3 v0, v1, v2;
+                uint8 activeEdges;
+                m_mesh.GetTriangle(triangleIndex, v0, v1, v2, activeEdges);
+                v0 *= m_scale2;
+                v1 *= m_scale2;
+                v2 *= m_scale2;
+
+                if (m_isInsideOut)
+                    m_collider.Collide(v0, v2, v1, ActiveEdges::FlipWinding(activeEdges), subShapeID2);
+                else
+                    m_collider.Collide(v0, v1, v2, activeEdges, subShapeID2);
+            }
+
+            const MeshShape&            m_mesh;
+            const Shape*                m_pShape1;
+            const SubShapeIDCreator&    m_subShapeIDCreator1;
+            const SubShapeIDCreator&    m_subShapeIDCreator2;
+            const ShapeFilter&          m_shapeFilter;
+            CollideShapeCollector&      m_collector;
+            CollideConvexVsTriangles&   m_collider;
+            Vec3                        m_scale2;
+            bool                        m_isInsideOut;
+        };
+
+        Callback callback { *pMesh2, pShape1, subShapeIDCreator1, subShapeIDCreator2, shapeFilter, collector, collider, scale2, ScaleHelpers::IsInsideOut(scale2) };
+        BoxVisitor<Callback> visitor(ScaleHelpers::UnscaleBox(collider.GetBoundsOf1InSpaceOf2(), scale2), callback);
+        pMesh2->WalkTree(visitor);
+    }
+
+    void MeshShape::CastConvexVsMesh(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape,
+        const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector)
+    {
+        NES_ASSERT(pShape->GetSubType() == EShapeSubType::Mesh);
+        const MeshShape* pMesh = checked_cast<const MeshShape*>(pShape);
+
+        CastConvexVsTriangles caster(shapeCast, shapeCastSettings, centerOfMassTransform2, subShapeIDCreator1, collector);
+
+        struct Callback
+        {
+            bool ShouldAbort() const { return m_collector.ShouldEarlyOut(); }
+
+            void operator()(const uint32 triangleIndex)
+            {
+                const SubShapeID subShapeID2 = m_subShapeIDCreator2.PushID(triangleIndex, m_mesh.m_numSubShapeIDBits).GetID();
+                if (!m_shapeFilter.ShouldCollide(m_pCastShape, m_subShapeIDCreator1.GetID(), &m_mesh, subShapeID2))
+                    return;
+
+                Vec3 v0, v1, v2;
+                uint8 activeEdges;
+                m_mesh.GetTriangle(triangleIndex, v0, v1, v2, activeEdges);
+                v0 *= m_scale;
+                v1 *= m_scale;
+                v2 *= m_scale;
+
+                if (m_isInsideOut)
+                    m_caster.Cast(v0, v2, v1, ActiveEdges::FlipWinding(activeEdges), subShapeID2);
+                else
+                    m_caster.Cast(v0, v1, v2, activeEdges, subShapeID2);
+            }
+
+            const MeshShape&            m_mesh;
+            const Shape*                m_pCastShape;
+            const SubShapeIDCreator&    m_subShapeIDCreator1;
+            const SubShapeIDCreator&    m_subShapeIDCreator2;
+            const ShapeFilter&          m_shapeFilter;
+            CastShapeCollector&         m_collector;
+            CastConvexVsTriangles&      m_caster;
+            Vec3                        m_scale;
+            bool                        m_isInsideOut;
+        };
+
+        Callback callback { *pMesh, shapeCast.m_pShape, subShapeIDCreator1, subShapeIDCreator2, shapeFilter, collector, caster, scale, ScaleHelpers::IsInsideOut(scale) };
+        SweptBoxVisitor<Callback> visitor(shapeCast, scale, collector, callback);
+        pMesh->WalkTree(visitor);
+    }
+
+    void MeshShape::Register()
+    {
+        ShapeFunctions& f = ShapeFunctions::Get(EShapeSubType::Mesh);
+        f.m_construct = []() -> Shape* { return new MeshShape; };
+        f.m_color = Color::Red();
+
+        for (const EShapeSubType subType : kConvexSubShapeTypes)
+        {
+            CollisionSolver::RegisterCollideShape(subType, EShapeSubType::Mesh, CollideConvexVsMesh);
+            CollisionSolver::RegisterCastShape(subType, EShapeSubType::Mesh, CastConvexVsMesh);
+
+            CollisionSolver::RegisterCollideShape(EShapeSubType::Mesh, subType, CollisionSolver::ReversedCollideShape);
+            CollisionSolver::RegisterCastShape(EShapeSubType::Mesh, subType, CollisionSolver::ReversedCastShape);
+        }
+    }
+}
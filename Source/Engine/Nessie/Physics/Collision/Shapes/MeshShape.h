@@ -0,0 +1,260 @@
+// MeshShape.h
+#pragma once
+#include "Shape.h"
+#include "SubShapeID.h"
+#include "Nessie/Geometry/IndexedTriangle.h"
+
+namespace nes
+{
+    struct CollideShapeSettings;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings that create a Mesh Shape.
+    //----------------------------------------------------------------------------------------------------
+    class MeshShapeSettings final : public ShapeSettings
+    {
+    public:
+        std::vector<Float3>             m_triangleVertices{};           /// Vertices of the triangles.
+        std::vector<IndexedTriangle>    m_indexedTriangles{};           /// Triangles, indexing into m_triangleVertices. Counter-clockwise when seen from the front.
+        uint                            m_maxTrianglesPerLeaf = 8;      /// Maximum number of triangles in each leaf of the tree, in the range [1, 8].
+        uint                            m_nodeWidth = 4;                /// Number of children of each node of the tree, 4 or 8. Wider nodes make shallower trees, which help large meshes.
+
+        /// Cosine of the threshold angle. If the angle between two triangles is bigger than this, the edge is active.
+        /// Setting this to -1 makes all edges active. Default is cos(5 degrees).
+        float                           m_activeEdgeCosThresholdAngle = 0.996195f;
+
+        MeshShapeSettings() = default;
+        MeshShapeSettings(std::vector<Float3> vertices, std::vector<IndexedTriangle> triangles);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Removes degenerate and duplicate triangles. This is called by the constructor that
+        ///     takes the triangles, call it again if you modified the triangles afterwards.
+        //----------------------------------------------------------------------------------------------------
+        void                Sanitize();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ShapeSettings::Create()
+        //----------------------------------------------------------------------------------------------------
+        virtual ShapeResult Create() const override;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A shape consisting of triangles, used for static level geometry. Mesh shapes can only be
+    ///     used on static bodies.
+    ///
+    /// The triangles are stored in a bounding volume hierarchy with 4 or 8 children per node, built top-down
+    /// with a binned Surface Area Heuristic. Node bounds are quantized to 16 bits relative to the bounds of
+    /// the mesh and stored as a structure of arrays, so that 4 children can be tested at a time. Vertices are
+    /// quantized to 21 bits per axis, and triangles are stored in blocks of 4 with 8-bit vertex indices and
+    /// active edge flags. For a typical level mesh this comes down to around 13 bytes per triangle, see
+    /// GetMemoryUsage().
+    /// @note : Because vertices are quantized, vertex positions can be off by up to 1 / 2^21 of the size
+    ///     of the mesh. Shared vertices are quantized to the same value, so this does not create cracks.
+    //----------------------------------------------------------------------------------------------------
+    class MeshShape final : public Shape
+    {
+    public:
+        MeshShape() : Shape(EShapeType::Mesh, EShapeSubType::Mesh) {}
+        MeshShape(const MeshShapeSettings& settings, ShapeResult& outResult);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::MustBeStatic()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            MustBeStatic() const override           { return true; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetLocalBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetLocalBounds() const override         { return m_bounds; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSubSShapeIDBitsRecursive()
+        //----------------------------------------------------------------------------------------------------
+        virtual unsigned        GetSubSShapeIDBitsRecursive() const override { return m_numSubShapeIDBits; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetInnerRadius()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetInnerRadius() const override         { return 0.f; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetMassProperties()
+        //----------------------------------------------------------------------------------------------------
+        virtual MassProperties  GetMassProperties() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSurfaceNormal()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            GetSurfaceNormal(const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSupportingFace()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction, const Vec3& scale, const Mat44& centerOfMassTransform, SupportingFace& outVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Check if a point is inside the mesh. This only gives a sensible result for closed meshes.
+        /// @see : Shape::CollidePoint()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Adds this shape to the collector if any triangle leaf of the tree overlaps the box.
+        /// @see : Shape::CollectTransformedShapes()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollectTransformedShapes(const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale, const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesStart()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesNext()
+        //----------------------------------------------------------------------------------------------------
+        virtual int             GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested, Float3* outTriangleVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetVolume()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetVolume() const override              { return 0.f; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of triangles in the mesh. Degenerate and duplicate triangles are not counted.
+        //----------------------------------------------------------------------------------------------------
+        uint                    GetNumTriangles() const                 { return m_numTriangles; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of bytes used by the tree, the triangles and the vertices.
+        //----------------------------------------------------------------------------------------------------
+        size_t                  GetMemoryUsage() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Register shape functions within the registry. This also registers the collision functions
+        ///     of all convex shapes against the mesh, so it must be called after ConvexShape::Register().
+        //----------------------------------------------------------------------------------------------------
+        static void             Register();
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Node of the tree. Stores the quantized bounds of 4 children as a structure of arrays.
+        ///     Nodes with 8 children are stored as 2 consecutive blocks.
+        //----------------------------------------------------------------------------------------------------
+        struct NodeBlock
+        {
+            uint16              m_minX[4];
+            uint16              m_minY[4];
+            uint16              m_minZ[4];
+            uint16              m_maxX[4];
+            uint16              m_maxY[4];
+            uint16              m_maxZ[4];
+            uint32              m_children[4];      /// See kLeafBit. Set to kInvalidChild when there is no child.
+        };
+        static_assert(sizeof(NodeBlock) == 64, "NodeBlock should fit in a cache line!");
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Stores 4 triangles. The vertex indices are relative to m_vertexBase.
+        //----------------------------------------------------------------------------------------------------
+        struct TriangleBlock
+        {
+            uint32              m_vertexBase;
+            uint8               m_indices[3][4];    /// Vertex index of [corner][triangle].
+            uint8               m_activeEdges[4];   /// Bit 'i' is set when the edge from vertex 'i' to vertex 'i + 1' is active.
+        };
+
+        /// Child references: a leaf has the top bit set, the number of triangles minus 1 in the next 3 bits and the
+        /// index of the first TriangleBlock in the remaining bits. Otherwise, it is the index of the first NodeBlock.
+        static constexpr uint32 kLeafBit = 0x80000000;
+        static constexpr uint32 kLeafNumTrianglesShift = 28;
+        static constexpr uint32 kLeafBlockMask = 0x0fffffff;
+        static constexpr uint32 kInvalidChild = 0xffffffff;
+
+        /// Number of bits used to quantize a vertex component.
+        static constexpr uint   kVertexBits = 21;
+        static constexpr uint64 kVertexMask = (static_cast<uint64>(1) << kVertexBits) - 1;
+
+        /// Max size of the stack used to walk the tree.
+        static constexpr int    kStackSize = 256;
+
+        /// Builds the tree, see MeshShape.cpp.
+        class TreeBuilder;
+
+        /// Tree visitors, see WalkTree().
+        class RayCastClosestVisitor;
+        class RayCastCollectorVisitor;
+        class CollectTransformedShapesVisitor;
+        template <typename TriangleCallback> class BoxVisitor;
+        template <typename TriangleCallback> class SweptBoxVisitor;
+
+        /// Class for GetTrianglesStart/Next()
+        class MSGetTrianglesContext;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Walk the tree, see MeshShape.cpp for the interface of the visitor.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Visitor>
+        void                    WalkTree(Visitor& visitor) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Dequantize the bounds of the 4 children of a node block.
+        //----------------------------------------------------------------------------------------------------
+        inline void             GetNodeBounds(const NodeBlock& block, Vec4Reg& outMinX, Vec4Reg& outMinY, Vec4Reg& outMinZ, Vec4Reg& outMaxX, Vec4Reg& outMaxY, Vec4Reg& outMaxZ) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the vertices of the 4 triangles in a block, as a structure of arrays.
+        ///	@param outVertices : [v0X, v0Y, v0Z, v1X, v1Y, v1Z, v2X, v2Y, v2Z].
+        //----------------------------------------------------------------------------------------------------
+        inline void             GetTriangleBlockVertices(const TriangleBlock& block, Vec4Reg* outVertices) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Convert a quantized vertex to a position.
+        //----------------------------------------------------------------------------------------------------
+        inline Vec3             DequantizeVertex(const uint64 quantizedVertex) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the vertices and active edges of a triangle. The triangle index is the sub shape ID
+        ///     of the triangle.
+        //----------------------------------------------------------------------------------------------------
+        inline void             GetTriangle(const uint32 triangleIndex, Vec3& outV0, Vec3& outV1, Vec3& outV2, uint8& outActiveEdges) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the triangle index from a sub shape ID.
+        //----------------------------------------------------------------------------------------------------
+        inline uint32           GetTriangleIndex(const SubShapeID& subShapeID) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Collides a convex shape with the triangles
+        ///     of the mesh.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideConvexVsMesh(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Casts a convex shape against the triangles
+        ///     of the mesh.
+        //----------------------------------------------------------------------------------------------------
+        static void             CastConvexVsMesh(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape, const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector);
+
+    private:
+        std::vector<NodeBlock>      m_nodes{};
+        std::vector<TriangleBlock>  m_triangleBlocks{};
+        std::vector<uint64>         m_vertices{};           /// Quantized vertices, 21 bits per component.
+        AABox                       m_bounds{};             /// Bounds of the (quantized) vertices.
+        Vec3                        m_quantizeOffset = Vec3::Zero();
+        Vec3                        m_vertexScale = Vec3::Zero(); /// Size of one step of a quantized vertex component.
+        Vec3                        m_nodeScale = Vec3::Zero();   /// Size of one step of a quantized node bound.
+        uint32                      m_rootNode = 0;
+        uint                        m_nodeWidth = 4;
+        uint                        m_numTriangles = 0;
+        uint                        m_numSubShapeIDBits = 1;
+    };
+}
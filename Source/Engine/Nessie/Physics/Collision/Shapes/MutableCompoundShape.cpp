@@ -0,0 +1,386 @@
+// MutableCompoundShape.cpp
+#include "MutableCompoundShape.h"
+
+#include "CompoundShapeVisitors.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    //	NOTES:
+    //  The sub shapes are tested 4 at a time against their cached bounds. Entries past the last sub shape
+    //  are masked out here rather than relying on their inverted bounds, because scaling inverted bounds
+    //  with a negative scale can make them pass the tests of the visitor.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Visitor>
+    void MutableCompoundShape::WalkSubShapes(Visitor& visitor) const
+    {
+        const uint numSubShapes = GetNumSubShapes();
+        const uint numBlocks = GetNumBlocks();
+        for (uint blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+        {
+            const BoundsBlock& block = m_subShapeBounds[blockIndex];
+            const Vec4Reg minX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minX));
+            const Vec4Reg minY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minY));
+            const Vec4Reg minZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minZ));
+            const Vec4Reg maxX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxX));
+            const Vec4Reg maxY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxY));
+            const Vec4Reg maxZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxZ));
+
+            const uint firstIndex = blockIndex * 4;
+            const uint numInBlock = math::Min(4U, numSubShapes - firstIndex);
+
+            if constexpr (Visitor::kTestsDistance)
+            {
+                alignas(16) float distances[4];
+                visitor.TestBounds(minX, minY, minZ, maxX, maxY, maxZ).StoreFloat4(reinterpret_cast<Float4*>(distances));
+
+                for (uint i = 0; i < numInBlock; ++i)
+                {
+                    // The early out fraction can shrink with every sub shape that is visited.
+                    if (distances[i] < visitor.GetEarlyOutFraction())
+                    {
+                        visitor.VisitShape(m_subShapes[firstIndex + i], firstIndex + i);
+                        if (visitor.ShouldAbort())
+                            return;
+                    }
+                }
+            }
+            else
+            {
+                int mask = visitor.TestBounds(minX, minY, minZ, maxX, maxY, maxZ).GetTrues() & ((1 << numInBlock) - 1);
+                while (mask != 0)
+                {
+                    const uint i = math::CountTrailingZeros(static_cast<uint32>(mask));
+                    mask &= mask - 1;
+
+                    visitor.VisitShape(m_subShapes[firstIndex + i], firstIndex + i);
+                    if (visitor.ShouldAbort())
+                        return;
+                }
+            }
+        }
+    }
+
+    ShapeSettings::ShapeResult MutableCompoundShapeSettings::Create() const
+    {
+        if (m_cachedResult.IsEmpty())
+        {
+            StrongPtr<Shape> pShape = new MutableCompoundShape(*this, m_cachedResult);
+        }
+
+        return m_cachedResult;
+    }
+
+    MutableCompoundShape::MutableCompoundShape(const MutableCompoundShapeSettings& settings, ShapeResult& outResult)
+        : CompoundShape(EShapeSubType::MutableCompound, settings, outResult)
+    {
+        // An empty compound is valid, sub shapes can be added later.
+        if (!CreateSubShapes(settings, outResult))
+            return;
+
+        ResizeBounds();
+        for (uint i = 0; i < GetNumSubShapes(); ++i)
+            SetSubShapeBounds(i, CalculateSubShapeBounds(m_subShapes[i]));
+        CalculateLocalBounds();
+
+        outResult.Set(this);
+    }
+
+    bool MutableCompoundShape::CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const
+    {
+        CastRayClosestVisitor visitor(ray, *this, subShapeIDCreator, hitResult);
+        WalkSubShapes(visitor);
+        return visitor.m_didHit;
+    }
+
+    void MutableCompoundShape::CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator,
+        CastRayCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        CastRayCollectorVisitor visitor(ray, settings, *this, subShapeIDCreator, collector, shapeFilter);
+        WalkSubShapes(visitor);
+    }
+
+    void MutableCompoundShape::CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector,
+        const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        CollidePointVisitor visitor(point, *this, subShapeIDCreator, collector, shapeFilter);
+        WalkSubShapes(visitor);
+    }
+
+    void MutableCompoundShape::CollectTransformedShapes(const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale,
+        const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        CollectTransformedShapesVisitor visitor(box, *this, positionCOM, rotation, scale, subShapeIDCreator, collector, shapeFilter);
+        WalkSubShapes(visitor);
+    }
+
+    uint MutableCompoundShape::AddShape(const Vec3& position, const Quat& rotation, const Shape* pShape, const uint32 userData, const uint index)
+    {
+        NES_ASSERT(pShape != nullptr);
+
+        SubShape subShape;
+        subShape.m_pShape = pShape;
+        subShape.m_userData = userData;
+        subShape.SetTransform(position, rotation, Vec3::Zero());
+
+        // Insert the sub shape, and move the bounds of the sub shapes after it up one entry.
+        const uint numSubShapes = GetNumSubShapes();
+        const uint insertIndex = math::Min(index, numSubShapes);
+        m_subShapes.insert(m_subShapes.begin() + insertIndex, subShape);
+        ResizeBounds();
+        for (uint i = numSubShapes; i > insertIndex; --i)
+            SetSubShapeBounds(i, GetSubShapeBounds(i - 1));
+
+        const AABox bounds = CalculateSubShapeBounds(subShape);
+        SetSubShapeBounds(insertIndex, bounds);
+
+        m_innerRadius = numSubShapes == 0 ? pShape->GetInnerRadius() : math::Min(m_innerRadius, pShape->GetInnerRadius());
+        RefitLocalBounds(AABox(), bounds);
+
+        return insertIndex;
+    }
+
+    void MutableCompoundShape::RemoveShape(const uint index)
+    {
+        NES_ASSERT(index < GetNumSubShapes());
+
+        const AABox removedBounds = GetSubShapeBounds(index);
+        const float removedInnerRadius = m_subShapes[index].m_pShape->GetInnerRadius();
+        m_subShapes.erase(m_subShapes.begin() + index);
+
+        // Move the bounds of the sub shapes after it down one entry, and clear the last entry.
+        const uint numSubShapes = GetNumSubShapes();
+        for (uint i = index; i < numSubShapes; ++i)
+            SetSubShapeBounds(i, GetSubShapeBounds(i + 1));
+        SetSubShapeBounds(numSubShapes, AABox());
+        ResizeBounds();
+
+        // The inner radius only changes if the removed sub shape was the smallest.
+        if (removedInnerRadius <= m_innerRadius)
+            CalculateInnerRadius();
+
+        RefitLocalBounds(removedBounds, AABox());
+    }
+
+    void MutableCompoundShape::ModifyShape(const uint index, const Vec3& position, const Quat& rotation)
+    {
+        NES_ASSERT(index < GetNumSubShapes());
+
+        SubShape& subShape = m_subShapes[index];
+        subShape.SetTransform(position, rotation, Vec3::Zero());
+
+        const AABox removedBounds = GetSubShapeBounds(index);
+        const AABox addedBounds = CalculateSubShapeBounds(subShape);
+        SetSubShapeBounds(index, addedBounds);
+        RefitLocalBounds(removedBounds, addedBounds);
+    }
+
+    void MutableCompoundShape::ModifyShape(const uint index, const Vec3& position, const Quat& rotation, const Shape* pShape)
+    {
+        NES_ASSERT(index < GetNumSubShapes());
+        NES_ASSERT(pShape != nullptr);
+
+        SubShape& subShape = m_subShapes[index];
+        const float removedInnerRadius = subShape.m_pShape->GetInnerRadius();
+        subShape.m_pShape = pShape;
+        subShape.SetTransform(position, rotation, Vec3::Zero());
+
+        if (removedInnerRadius <= m_innerRadius)
+            CalculateInnerRadius();
+        else
+            m_innerRadius = math::Min(m_innerRadius, pShape->GetInnerRadius());
+
+        const AABox removedBounds = GetSubShapeBounds(index);
+        const AABox addedBounds = CalculateSubShapeBounds(subShape);
+        SetSubShapeBounds(index, addedBounds);
+        RefitLocalBounds(removedBounds, addedBounds);
+    }
+
+    void MutableCompoundShape::ModifyShapes(const uint startIndex, const uint count, const Vec3* pPositions, const Quat* pRotations)
+    {
+        NES_ASSERT(startIndex + count <= GetNumSubShapes());
+
+        AABox removedBounds;
+        AABox addedBounds;
+        for (uint i = 0; i < count; ++i)
+        {
+            const uint index = startIndex + i;
+            SubShape& subShape = m_subShapes[index];
+            subShape.SetTransform(pPositions[i], pRotations[i], Vec3::Zero());
+
+            removedBounds.Encapsulate(GetSubShapeBounds(index));
+            const AABox bounds = CalculateSubShapeBounds(subShape);
+            addedBounds.Encapsulate(bounds);
+            SetSubShapeBounds(index, bounds);
+        }
+
+        RefitLocalBounds(removedBounds, addedBounds);
+    }
+
+    void MutableCompoundShape::AdjustCenterOfMass()
+    {
+        const Vec3 offset = CalculateCenterOfMass();
+        if (offset.IsNearZero())
+            return;
+
+        for (SubShape& subShape : m_subShapes)
+            subShape.m_positionCOM -= offset;
+        m_centerOfMass += offset;
+
+        // Move the cached bounds along. Unused entries stay inverted, since they are +/-FLT_MAX.
+        const Vec4Reg offsetX = Vec4Reg::Replicate(offset.x);
+        const Vec4Reg offsetY = Vec4Reg::Replicate(offset.y);
+        const Vec4Reg offsetZ = Vec4Reg::Replicate(offset.z);
+        for (BoundsBlock& block : m_subShapeBounds)
+        {
+            (Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minX)) - offsetX).StoreFloat4(reinterpret_cast<Float4*>(block.m_minX));
+            (Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minY)) - offsetY).StoreFloat4(reinterpret_cast<Float4*>(block.m_minY));
+            (Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minZ)) - offsetZ).StoreFloat4(reinterpret_cast<Float4*>(block.m_minZ));
+            (Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxX)) - offsetX).StoreFloat4(reinterpret_cast<Float4*>(block.m_maxX));
+            (Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxY)) - offsetY).StoreFloat4(reinterpret_cast<Float4*>(block.m_maxY));
+            (Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxZ)) - offsetZ).StoreFloat4(reinterpret_cast<Float4*>(block.m_maxZ));
+        }
+
+        m_localBounds.Translate(-offset);
+    }
+
+    AABox MutableCompoundShape::GetSubShapeBounds(const uint index) const
+    {
+        const BoundsBlock& block = m_subShapeBounds[index >> 2];
+        const uint i = index & 3;
+        return AABox(Vec3(block.m_minX[i], block.m_minY[i], block.m_minZ[i]), Vec3(block.m_maxX[i], block.m_maxY[i], block.m_maxZ[i]));
+    }
+
+    void MutableCompoundShape::SetSubShapeBounds(const uint index, const AABox& bounds)
+    {
+        BoundsBlock& block = m_subShapeBounds[index >> 2];
+        const uint i = index & 3;
+        block.m_minX[i] = bounds.m_min.x;
+        block.m_minY[i] = bounds.m_min.y;
+        block.m_minZ[i] = bounds.m_min.z;
+        block.m_maxX[i] = bounds.m_max.x;
+        block.m_maxY[i] = bounds.m_max.y;
+        block.m_maxZ[i] = bounds.m_max.z;
+    }
+
+    AABox MutableCompoundShape::CalculateSubShapeBounds(const SubShape& subShape)
+    {
+        return subShape.m_pShape->GetWorldBounds(Mat44::MakeRotationTranslation(subShape.m_rotation, subShape.m_positionCOM), Vec3::One());
+    }
+
+    void MutableCompoundShape::ResizeBounds()
+    {
+        const uint numBlocks = GetNumBlocks();
+        const uint previousNumBlocks = static_cast<uint>(m_subShapeBounds.size());
+        m_subShapeBounds.resize(numBlocks);
+
+        const AABox invalid;
+        for (uint i = previousNumBlocks * 4; i < numBlocks * 4; ++i)
+            SetSubShapeBounds(i, invalid);
+    }
+
+    void MutableCompoundShape::CalculateLocalBounds()
+    {
+        if (m_subShapes.empty())
+        {
+            // An empty compound has no bounds, use a point at the center of mass.
+            m_localBounds = AABox(Vec3::Zero(), Vec3::Zero());
+            return;
+        }
+
+        // Unused entries are inverted, so they don't affect the result.
+        Vec4Reg minX = Vec4Reg::Replicate(FLT_MAX), minY = minX, minZ = minX;
+        Vec4Reg maxX = Vec4Reg::Replicate(-FLT_MAX), maxY = maxX, maxZ = maxX;
+        for (const BoundsBlock& block : m_subShapeBounds)
+        {
+            minX = Vec4Reg::Min(minX, Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minX)));
+            minY = Vec4Reg::Min(minY, Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minY)));
+            minZ = Vec4Reg::Min(minZ, Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_minZ)));
+            maxX = Vec4Reg::Max(maxX, Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxX)));
+            maxY = Vec4Reg::Max(maxY, Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxY)));
+            maxZ = Vec4Reg::Max(maxZ, Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(block.m_maxZ)));
+        }
+
+        // Reduce the 4 lanes
+        const auto reduceMin = [](const Vec4Reg& value) { return math::Min(math::Min(value[0], value[1]), math::Min(value[2], value[3])); };
+        const auto reduceMax = [](const Vec4Reg& value) { return math::Max(math::Max(value[0], value[1]), math::Max(value[2], value[3])); };
+        m_localBounds = AABox(Vec3(reduceMin(minX), reduceMin(minY), reduceMin(minZ)), Vec3(reduceMax(maxX), reduceMax(maxY), reduceMax(maxZ)));
+    }
+
+    void MutableCompoundShape::RefitLocalBounds(const AABox& removedBounds, const AABox& addedBounds)
+    {
+        // If the removed bounds touched the bounds of the compound, the compound may shrink, which
+        // requires looking at all sub shapes. Otherwise, the bounds only need to grow.
+        const bool needsRecalculate = m_subShapes.size() <= 1
+            || !m_localBounds.IsValid()
+            || (removedBounds.IsValid()
+                && (Vec3::LessOrEqual(removedBounds.m_min, m_localBounds.m_min).TestAnyXYZTrue()
+                    || Vec3::GreaterOrEqual(removedBounds.m_max, m_localBounds.m_max).TestAnyXYZTrue()));
+
+        if (needsRecalculate)
+            CalculateLocalBounds();
+        else if (addedBounds.IsValid())
+            m_localBounds.Encapsulate(addedBounds);
+    }
+
+    void MutableCompoundShape::CollideCompoundVsShape(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2,
+        const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape1->GetSubType() == EShapeSubType::MutableCompound);
+        const MutableCompoundShape* pCompound1 = checked_cast<const MutableCompoundShape*>(pShape1);
+
+        CollideCompoundVsShapeVisitor visitor(pCompound1, pShape2, scale1, scale2, centerOfMassTransform1, centerOfMassTransform2, subShapeIDCreator1, subShapeIDCreator2, collideShapeSettings, collector, shapeFilter);
+        pCompound1->WalkSubShapes(visitor);
+    }
+
+    void MutableCompoundShape::CollideShapeVsCompound(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2,
+        const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape2->GetSubType() == EShapeSubType::MutableCompound);
+        const MutableCompoundShape* pCompound2 = checked_cast<const MutableCompoundShape*>(pShape2);
+
+        CollideShapeVsCompoundVisitor visitor(pShape1, pCompound2, scale1, scale2, centerOfMassTransform1, centerOfMassTransform2, subShapeIDCreator1, subShapeIDCreator2, collideShapeSettings, collector, shapeFilter);
+        pCompound2->WalkSubShapes(visitor);
+    }
+
+    void MutableCompoundShape::CastShapeVsCompound(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape,
+        const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector)
+    {
+        NES_ASSERT(pShape->GetSubType() == EShapeSubType::MutableCompound);
+        const MutableCompoundShape* pCompound = checked_cast<const MutableCompoundShape*>(pShape);
+
+        CastShapeVsCompoundVisitor visitor(shapeCast, shapeCastSettings, pCompound, scale, shapeFilter, centerOfMassTransform2, subShapeIDCreator1, subShapeIDCreator2, collector);
+        pCompound->WalkSubShapes(visitor);
+    }
+
+    void MutableCompoundShape::Register()
+    {
+        ShapeFunctions& f = ShapeFunctions::Get(EShapeSubType::MutableCompound);
+        f.m_construct = []() -> Shape* { return new MutableCompoundShape; };
+        f.m_color = Color::Cyan();
+
+        for (const EShapeSubType subType : kAllSubShapeTypes)
+        {
+            CollisionSolver::RegisterCollideShape(EShapeSubType::MutableCompound, subType, CollideCompoundVsShape);
+            CollisionSolver::RegisterCollideShape(subType, EShapeSubType::MutableCompound, CollideShapeVsCompound);
+            CollisionSolver::RegisterCastShape(subType, EShapeSubType::MutableCompound, CastShapeVsCompound);
+        }
+    }
+}
@@ -0,0 +1,192 @@
+// MutableCompoundShape.h
+#pragma once
+#include "CompoundShape.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings that create a Mutable Compound Shape.
+    //----------------------------------------------------------------------------------------------------
+    class MutableCompoundShapeSettings final : public CompoundShapeSettings
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ShapeSettings::Create()
+        //----------------------------------------------------------------------------------------------------
+        virtual ShapeResult Create() const override;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A compound shape whose sub shapes can be added, removed and moved after it is created.
+    ///
+    /// The bounds of each sub shape are cached in blocks of 4 as a structure of arrays, which queries test
+    /// 4 at a time. Changing a sub shape only recalculates the bounds of that sub shape. The bounds of the
+    /// compound grow to include the new bounds, and are only recalculated from the cached bounds when the
+    /// old bounds of the sub shape touched them. For compounds with many sub shapes that don't change, a
+    /// StaticCompoundShape is faster to query.
+    ///
+    /// @note : Positions are relative to the center of mass of the compound, see GetCenterOfMass(). The center
+    ///     of mass does not change when sub shapes are modified, call AdjustCenterOfMass() to recalculate it.
+    /// @note : The compound can be modified while it is in use by a body, but not while it is being queried.
+    ///     Call BodyInterface::NotifyShapeChanged() afterwards to update the body.
+    /// @note : Adding or removing sub shapes can change the number of bits in a SubShapeID, and shifts the
+    ///     indices of the sub shapes after it, so SubShapeIDs of the compound become invalid.
+    //----------------------------------------------------------------------------------------------------
+    class MutableCompoundShape final : public CompoundShape
+    {
+    public:
+        MutableCompoundShape() : CompoundShape(EShapeSubType::MutableCompound) {}
+        MutableCompoundShape(const MutableCompoundShapeSettings& settings, ShapeResult& outResult);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CollidePoint()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Recurses into the sub shapes that overlap the box.
+        /// @see : Shape::CollectTransformedShapes()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollectTransformedShapes(const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale, const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Add a sub shape.
+        ///	@param position : Position of the origin of the sub shape, relative to the center of mass of the compound.
+        ///	@param rotation : Rotation of the sub shape.
+        ///	@param pShape : The sub shape.
+        ///	@param userData : User data of the sub shape.
+        ///	@param index : Index to insert the sub shape at. By default, it is added at the end.
+        ///	@returns : The index of the sub shape.
+        //----------------------------------------------------------------------------------------------------
+        uint                    AddShape(const Vec3& position, const Quat& rotation, const Shape* pShape, const uint32 userData = 0, const uint index = std::numeric_limits<uint>::max());
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Remove the sub shape at 'index'. The sub shapes after it move down one index.
+        //----------------------------------------------------------------------------------------------------
+        void                    RemoveShape(const uint index);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Move the sub shape at 'index'.
+        ///	@param position : Position of the origin of the sub shape, relative to the center of mass of the compound.
+        ///	@param rotation : Rotation of the sub shape.
+        //----------------------------------------------------------------------------------------------------
+        void                    ModifyShape(const uint index, const Vec3& position, const Quat& rotation);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Move the sub shape at 'index' and replace its shape.
+        ///	@param position : Position of the origin of the sub shape, relative to the center of mass of the compound.
+        ///	@param rotation : Rotation of the sub shape.
+        ///	@param pShape : The new shape.
+        //----------------------------------------------------------------------------------------------------
+        void                    ModifyShape(const uint index, const Vec3& position, const Quat& rotation, const Shape* pShape);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Move a range of sub shapes. The bounds of the compound are updated once for all of them.
+        ///	@param startIndex : Index of the first sub shape to move.
+        ///	@param count : Number of sub shapes to move.
+        ///	@param pPositions : 'count' positions of the origins of the sub shapes, relative to the center of mass of the compound.
+        ///	@param pRotations : 'count' rotations of the sub shapes.
+        //----------------------------------------------------------------------------------------------------
+        void                    ModifyShapes(const uint startIndex, const uint count, const Vec3* pPositions, const Quat* pRotations);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Recalculate the center of mass and move the sub shapes so that they are relative to it.
+        ///     The cached bounds are moved along, nothing is recalculated from the sub shapes.
+        //----------------------------------------------------------------------------------------------------
+        void                    AdjustCenterOfMass();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Register shape functions within the registry. This registers colliding any shape with the
+        ///     mutable compound and casting any shape against it.
+        //----------------------------------------------------------------------------------------------------
+        static void             Register();
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Bounds of 4 sub shapes as a structure of arrays, relative to the center of mass of the
+        ///     compound. Unused entries have inverted bounds.
+        //----------------------------------------------------------------------------------------------------
+        struct alignas(16) BoundsBlock
+        {
+            float               m_minX[4];
+            float               m_minY[4];
+            float               m_minZ[4];
+            float               m_maxX[4];
+            float               m_maxY[4];
+            float               m_maxZ[4];
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of blocks of bounds needed for the sub shapes.
+        //----------------------------------------------------------------------------------------------------
+        inline uint             GetNumBlocks() const                    { return (GetNumSubShapes() + 3) / 4; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the cached bounds of the sub shape at 'index'.
+        //----------------------------------------------------------------------------------------------------
+        AABox                   GetSubShapeBounds(const uint index) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the cached bounds of the sub shape at 'index'.
+        //----------------------------------------------------------------------------------------------------
+        void                    SetSubShapeBounds(const uint index, const AABox& bounds);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Calculate the bounds of a sub shape, relative to the center of mass of the compound.
+        //----------------------------------------------------------------------------------------------------
+        static AABox            CalculateSubShapeBounds(const SubShape& subShape);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Grow or shrink the blocks of bounds to the number of sub shapes. New entries are inverted.
+        //----------------------------------------------------------------------------------------------------
+        void                    ResizeBounds();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Calculate the bounds of the compound from the cached bounds of all sub shapes.
+        //----------------------------------------------------------------------------------------------------
+        void                    CalculateLocalBounds();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Update the bounds of the compound after the bounds of sub shapes changed from 'removedBounds'
+        ///     to 'addedBounds'. Either can be an invalid box.
+        //----------------------------------------------------------------------------------------------------
+        void                    RefitLocalBounds(const AABox& removedBounds, const AABox& addedBounds);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Test the bounds of all sub shapes, see CompoundShapeVisitors.h for the interface of the visitor.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Visitor>
+        void                    WalkSubShapes(Visitor& visitor) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Collides the sub shapes that overlap
+        ///     shape 2 with shape 2.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideCompoundVsShape(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Collides shape 1 with the sub shapes that
+        ///     overlap it.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideShapeVsCompound(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Casts a shape against the sub shapes that
+        ///     it sweeps through.
+        //----------------------------------------------------------------------------------------------------
+        static void             CastShapeVsCompound(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape, const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector);
+
+    private:
+        std::vector<BoundsBlock> m_subShapeBounds{};
+    };
+}
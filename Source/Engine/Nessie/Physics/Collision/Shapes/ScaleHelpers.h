@@ -1,6 +1,7 @@
 // ScaleHelpers.h
 #pragma once
 #include "Nessie/Math/Math.h"
+#include "Nessie/Geometry/AABox.h"
 #include "Nessie/Physics/PhysicsSettings.h"
 
 namespace nes::ScaleHelpers
@@ -42,6 +43,11 @@ namespace nes::ScaleHelpers
     //----------------------------------------------------------------------------------------------------
     inline Vec3     MakeNonZeroScale(const Vec3& scale) { return scale.GetSign() * Vec3::Max(scale.Abs(), Vec3::Replicate(kMinScale)); }
 
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the average of the scale components, used to make the scale uniform when a shape doesn't support non-uniform scale.
+    //----------------------------------------------------------------------------------------------------
+    inline Vec3     MakeUniformScale(const Vec3& scale) { return Vec3::Replicate((scale.x + scale.y + scale.z) / 3.0f); }
+
     //----------------------------------------------------------------------------------------------------
     /// @brief : Get the scaled convex radius of an object. 
     //----------------------------------------------------------------------------------------------------
@@ -49,5 +55,46 @@ namespace nes::ScaleHelpers
     {
         return math::Min(convexRadius * scale.Abs().MinComponent(), physics::kDefaultConvexRadius);
     }
-    
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Convert a box in scaled space to a box in unscaled space.
+    //----------------------------------------------------------------------------------------------------
+    inline AABox    UnscaleBox(const AABox& box, const Vec3& scale)
+    {
+        const Vec3 invScale = scale.Reciprocal();
+        return AABox::FromTwoPoints(box.m_min * invScale, box.m_max * invScale);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Test if a scale can be passed on to a child shape that is rotated by 'rotation'. This is
+    ///     the case when the scale is uniform, or when the rotation only swaps axes, since a scale in the
+    ///     space of the child can then express the same transform.
+    //----------------------------------------------------------------------------------------------------
+    inline bool     CanScaleBeRotated(const Quat& rotation, const Vec3& scale)
+    {
+        // The scale in the space of the child is R^T * S * R. If any of the off-diagonal elements are not zero,
+        // there is no scale in the space of the child that matches.
+        const Mat44 r = Mat44::MakeRotation(rotation);
+        const Mat44 childScale = r.Multiply3x3LeftTransposed(r.PostScaled(scale));
+        for (uint column = 0; column < 3; ++column)
+        {
+            for (uint row = 0; row < 3; ++row)
+            {
+                if (row != column && std::abs(childScale[column][row]) >= 1.0e-6f)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the scale in the space of a child shape that is rotated by 'rotation'.
+    /// @note : Only valid if CanScaleBeRotated() returns true.
+    //----------------------------------------------------------------------------------------------------
+    inline Vec3     RotateScale(const Quat& rotation, const Vec3& scale)
+    {
+        const Mat44 r = Mat44::MakeRotation(rotation);
+        return r.Multiply3x3LeftTransposed(r.PostScaled(scale)).GetDiagonal3();
+    }
+
 }
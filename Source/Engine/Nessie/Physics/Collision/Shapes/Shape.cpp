@@ -30,7 +30,7 @@ namespace nes
         outRemainder = SubShapeID();
 
         // Just return the transformed shape for this shape
-        TransformedShape tShape(Vec3(positionCOM), rotation, this, BodyID());
+        TransformedShape tShape(RVec3(positionCOM), rotation, this, BodyID());
         tShape.SetShapeScale(scale);
         return tShape;
     }
@@ -40,10 +40,10 @@ namespace nes
         const ShapeFilter& shapeFilter) const
     {
         // Test the shape filter
-        if (shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
             return;
 
-        TransformedShape tShape(positionCOM, rotation, this, TransformedShape::GetBodyID(collector.GetContext()), subShapeIDCreator);
+        TransformedShape tShape(RVec3(positionCOM), rotation, this, TransformedShape::GetBodyID(collector.GetContext()), subShapeIDCreator);
         tShape.SetShapeScale(scale);
         collector.AddHit(tShape);
     }
@@ -52,7 +52,7 @@ namespace nes
     {
         Vec3 scale;
         Mat44 transform = centerOfMassTransform.Decompose(scale);
-        TransformedShape tShape(transform.GetTranslation(), transform.ToQuaternion(), this, BodyID(), SubShapeIDCreator());
+        TransformedShape tShape(RVec3(transform.GetTranslation()), transform.ToQuaternion(), this, BodyID(), SubShapeIDCreator());
         tShape.SetShapeScale(MakeScaleValid(scale));
         collector.AddHit(tShape);
     }
@@ -202,6 +202,20 @@ namespace nes
         ///     box; by default, it will just transform what GetLocalBounds() returns.
         //----------------------------------------------------------------------------------------------------
         virtual AABox           GetWorldBounds(const Mat44& centerOfMassTransform, const Vec3& scale) const;
+
+#ifdef NES_DOUBLE_PRECISION
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the world space bounds for a double precision transform. The bounds are calculated
+        ///     around the origin and then translated, rounding outwards so that the single precision box
+        ///     still contains the shape.
+        //----------------------------------------------------------------------------------------------------
+        AABox                   GetWorldBounds(const DMat44& centerOfMassTransform, const Vec3& scale) const
+        {
+            const AABox bounds = GetWorldBounds(centerOfMassTransform.GetRotation(), scale);
+            const DVec3 offset = centerOfMassTransform.GetTranslation();
+            return AABox((offset + bounds.m_min).ToVec3RoundDown(), (offset + bounds.m_max).ToVec3RoundUp());
+        }
+#endif
         
         //----------------------------------------------------------------------------------------------------
         // ?
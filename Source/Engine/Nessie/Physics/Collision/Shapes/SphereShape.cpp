@@ -0,0 +1,428 @@
+// SphereShape.cpp
+#include "SphereShape.h"
+
+#include "Nessie/Geometry/RaySphere.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/CollidePointResult.h"
+#include "Nessie/Physics/Collision/CollideShape.h"
+#include "Nessie/Physics/Collision/CollisionSolver.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Physics/Collision/ShapeCast.h"
+#include "Nessie/Physics/Collision/TransformedShape.h"
+#include "Nessie/Physics/Collision/Shapes/BoxShape.h"
+#include "Nessie/Physics/Collision/Shapes/GetTrianglesContext.h"
+#include "Nessie/Physics/Collision/Shapes/ScaleHelpers.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Support function that includes the radius of the sphere.
+    //----------------------------------------------------------------------------------------------------
+    class SphereShape::SphereNoConvex final : public Support
+    {
+        float m_radius;
+
+    public:
+        explicit SphereNoConvex(const float radius)
+            : m_radius(radius)
+        {
+            static_assert(sizeof(SphereNoConvex) <= sizeof(SupportBuffer), "Buffer size too small");
+            NES_ASSERT(math::IsAligned(this, alignof(SphereNoConvex)));
+        }
+
+        virtual Vec3 GetSupport(const Vec3& direction) const override
+        {
+            const float length = direction.Length();
+            return length > 0.f? (m_radius / length) * direction : Vec3::Zero();
+        }
+
+        virtual float GetConvexRadius() const override
+        {
+            return 0.f;
+        }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Support function that represents the sphere as a point with a convex radius.
+    //----------------------------------------------------------------------------------------------------
+    class SphereShape::SphereWithConvex final : public Support
+    {
+        float m_radius;
+
+    public:
+        explicit SphereWithConvex(const float radius)
+            : m_radius(radius)
+        {
+            static_assert(sizeof(SphereWithConvex) <= sizeof(SupportBuffer), "Buffer size too small");
+            NES_ASSERT(math::IsAligned(this, alignof(SphereWithConvex)));
+        }
+
+        virtual Vec3 GetSupport([[maybe_unused]] const Vec3& direction) const override
+        {
+            return Vec3::Zero();
+        }
+
+        virtual float GetConvexRadius() const override
+        {
+            return m_radius;
+        }
+    };
+
+    ShapeSettings::ShapeResult SphereShapeSettings::Create() const
+    {
+        if (m_cachedResult.IsEmpty())
+        {
+            StrongPtr<Shape> pShape = new SphereShape(*this, m_cachedResult);
+        }
+        return m_cachedResult;
+    }
+
+    SphereShape::SphereShape(const SphereShapeSettings& settings, ShapeResult& outResult)
+        : ConvexShape(EShapeSubType::Sphere, settings, outResult)
+        , m_radius(settings.m_radius)
+    {
+        if (settings.m_radius <= 0.f)
+        {
+            outResult.SetError("Invalid radius");
+            return;
+        }
+
+        outResult.Set(this);
+    }
+
+    SphereShape::SphereShape(const float radius)
+        : ConvexShape(EShapeSubType::Sphere)
+        , m_radius(radius)
+    {
+        NES_ASSERT(radius > 0.f);
+    }
+
+    float SphereShape::GetScaledRadius(const Vec3& scale) const
+    {
+        NES_ASSERT(IsValidScale(scale));
+
+        const Vec3 absScale = scale.Abs();
+        return absScale.x * m_radius;
+    }
+
+    AABox SphereShape::GetLocalBounds() const
+    {
+        const Vec3 halfExtent = Vec3::Replicate(m_radius);
+        return AABox(-halfExtent, halfExtent);
+    }
+
+    AABox SphereShape::GetWorldBounds(const Mat44& centerOfMassTransform, const Vec3& scale) const
+    {
+        // A sphere is rotation invariant, so the bounds only depend on the position.
+        const Vec3 halfExtent = Vec3::Replicate(GetScaledRadius(scale));
+        const Vec3 center = centerOfMassTransform.GetTranslation();
+        return AABox(center - halfExtent, center + halfExtent);
+    }
+
+    MassProperties SphereShape::GetMassProperties() const
+    {
+        MassProperties props;
+
+        // Mass of a solid sphere: density * 4/3 * pi * r^3, inertia: 2/5 * m * r^2 around each axis.
+        const float radiusSqr = math::Squared(m_radius);
+        props.m_mass = (4.0f / 3.0f * math::Pi<float>()) * m_radius * radiusSqr * GetDensity();
+        props.m_inertia = Mat44::MakeScale(Vec3::Replicate(0.4f * props.m_mass * radiusSqr));
+        return props;
+    }
+
+    Vec3 SphereShape::GetSurfaceNormal([[maybe_unused]] const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const
+    {
+        NES_ASSERT(subShapeID.IsEmpty(), "Invalid subshape ID");
+
+        const float length = localSurfacePosition.Length();
+        return length > 0.f? localSurfacePosition / length : Vec3::AxisY();
+    }
+
+    bool SphereShape::CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const
+    {
+        const float fraction = RaySphere(ray.m_origin, ray.m_direction, Vec3::Zero(), m_radius);
+        if (fraction < hitResult.m_fraction)
+        {
+            hitResult.m_fraction = fraction;
+            hitResult.m_subShapeID2 = subShapeIDCreator.GetID();
+            return true;
+        }
+
+        return false;
+    }
+
+    void SphereShape::CastRay(const RayCast& ray, const RayCastSettings& settings,
+        const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        float minFraction, maxFraction;
+        const int numResults = RaySphere(ray.m_origin, ray.m_direction, Vec3::Zero(), m_radius, minFraction, maxFraction);
+        if (numResults > 0                                      // Ray should intersect
+            && maxFraction >= 0.f                               // End of ray should be inside the sphere
+            && minFraction < collector.GetEarlyOutFraction())   // Start of ray should be before the early out fraction
+        {
+            // Better hit than the current hit
+            RayCastResult hit;
+            hit.m_bodyID = TransformedShape::GetBodyID(collector.GetContext());
+            hit.m_subShapeID2 = subShapeIDCreator.GetID();
+
+            // Check front side
+            if (settings.m_treatConvexAsSolid || minFraction > 0.f)
+            {
+                hit.m_fraction = math::Max(0.f, minFraction);
+                collector.AddHit(hit);
+            }
+
+            // Check back side hit
+            if (settings.m_backfaceModeConvex == EBackFaceMode::CollideWithBackFaces
+                && numResults > 1 // Ray should not touch the edge of the sphere
+                && maxFraction < collector.GetEarlyOutFraction())
+            {
+                hit.m_fraction = maxFraction;
+                collector.AddHit(hit);
+            }
+        }
+    }
+
+    void SphereShape::CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator,
+        CollidePointCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test Shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        if (point.LengthSqr() <= math::Squared(m_radius))
+        {
+            collector.AddHit({ TransformedShape::GetBodyID(collector.GetContext()), subShapeIDCreator.GetID() });
+        }
+    }
+
+    void SphereShape::GetTrianglesStart(GetTrianglesContext& context, [[maybe_unused]] const AABox& box, const Vec3& positionCOM,
+        const Quat& rotation, const Vec3& scale) const
+    {
+        new (&context) GetTrianglesContextVertexList(positionCOM, rotation, scale, Mat44::MakeScale(m_radius), s_unitSphereTriangles.data(), s_unitSphereTriangles.size());
+    }
+
+    int SphereShape::GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested,
+        Float3* outTriangleVertices) const
+    {
+        return (reinterpret_cast<GetTrianglesContextVertexList&>(context).GetTrianglesNext(maxTrianglesRequested, outTriangleVertices));
+    }
+
+    float SphereShape::GetVolume() const
+    {
+        return (4.0f / 3.0f * math::Pi<float>()) * math::Squared(m_radius) * m_radius;
+    }
+
+    bool SphereShape::IsValidScale(const Vec3& scale) const
+    {
+        return ConvexShape::IsValidScale(scale) && ScaleHelpers::IsUniformScale(scale.Abs());
+    }
+
+    Vec3 SphereShape::MakeScaleValid(const Vec3& scale) const
+    {
+        const Vec3 nonZeroScale = ScaleHelpers::MakeNonZeroScale(scale);
+        return nonZeroScale.GetSign() * ScaleHelpers::MakeUniformScale(nonZeroScale.Abs());
+    }
+
+    const ConvexShape::Support* SphereShape::GetSupportFunction(ESupportMode mode, SupportBuffer& buffer,
+        const Vec3& scale) const
+    {
+        const float scaledRadius = GetScaledRadius(scale);
+
+        switch (mode)
+        {
+            case ESupportMode::IncludeConvexRadius:
+                return new (&buffer) SphereNoConvex(scaledRadius);
+
+            case ESupportMode::ExcludeConvexRadius:
+            case ESupportMode::Default:
+                return new (&buffer) SphereWithConvex(scaledRadius);
+        }
+
+        NES_ASSERT(false);
+        return nullptr;
+    }
+
+    void SphereShape::Register()
+    {
+        ShapeFunctions& f = ShapeFunctions::Get(EShapeSubType::Sphere);
+        f.m_construct = []() -> Shape* { return new SphereShape; };
+        f.m_color = Color::Green();
+
+        // Replace the generic GJK/EPA paths with closed form solutions.
+        CollisionSolver::RegisterCollideShape(EShapeSubType::Sphere, EShapeSubType::Sphere, CollideSphereVsSphere);
+        CollisionSolver::RegisterCollideShape(EShapeSubType::Sphere, EShapeSubType::Box, CollideSphereVsBox);
+        CollisionSolver::RegisterCollideShape(EShapeSubType::Box, EShapeSubType::Sphere, CollisionSolver::ReversedCollideShape);
+        CollisionSolver::RegisterCastShape(EShapeSubType::Sphere, EShapeSubType::Sphere, CastSphereVsSphere);
+    }
+
+    void SphereShape::CollideSphereVsSphere(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1,
+        const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2,
+        const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2,
+        const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        [[maybe_unused]] const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape1->GetSubType() == EShapeSubType::Sphere);
+        NES_ASSERT(pShape2->GetSubType() == EShapeSubType::Sphere);
+        const SphereShape* pSphere1 = checked_cast<const SphereShape*>(pShape1);
+        const SphereShape* pSphere2 = checked_cast<const SphereShape*>(pShape2);
+
+        const float radius1 = pSphere1->GetScaledRadius(scale1);
+        const float radius2 = pSphere2->GetScaledRadius(scale2);
+        const Vec3 center1 = centerOfMassTransform1.GetTranslation();
+        const Vec3 center2 = centerOfMassTransform2.GetTranslation();
+
+        // Check if the spheres are within the max separation distance of each other.
+        const Vec3 delta = center2 - center1;
+        const float distanceSqr = delta.LengthSqr();
+        const float combinedRadius = radius1 + radius2;
+        if (distanceSqr > math::Squared(combinedRadius + collideShapeSettings.m_maxSeparationDistance))
+            return;
+
+        // Check if the penetration is bigger than the early out fraction
+        const float distance = std::sqrt(distanceSqr);
+        const float penetrationDepth = combinedRadius - distance;
+        if (-penetrationDepth >= collector.GetEarlyOutFraction())
+            return;
+
+        // Push shape 2 away from shape 1, if the centers coincide pick an arbitrary axis.
+        const Vec3 penetrationAxis = distance > 0.f? delta / distance : Vec3::AxisY();
+        const Vec3 point1 = center1 + radius1 * penetrationAxis;
+        const Vec3 point2 = center2 - radius2 * penetrationAxis;
+
+        // [Note]: Spheres don't have supporting faces, so the faces are left empty even if requested.
+        CollideShapeResult result(point1, point2, penetrationAxis, penetrationDepth, subShapeIDCreator1.GetID(), subShapeIDCreator2.GetID(), TransformedShape::GetBodyID(collector.GetContext()));
+
+        // [TODO]: NarrowPhase Tracking
+        collector.AddHit(result);
+    }
+
+    void SphereShape::CollideSphereVsBox(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1,
+        const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2,
+        const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2,
+        const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        [[maybe_unused]] const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape1->GetSubType() == EShapeSubType::Sphere);
+        NES_ASSERT(pShape2->GetSubType() == EShapeSubType::Box);
+        const SphereShape* pSphere = checked_cast<const SphereShape*>(pShape1);
+        const BoxShape* pBox = checked_cast<const BoxShape*>(pShape2);
+
+        // The box is treated the same way the GJK path treats it: a box that is shrunk by the convex radius,
+        // with the convex radius added to the sphere instead.
+        const float boxConvexRadius = ScaleHelpers::ScaleConvexRadius(pBox->GetConvexRadius(), scale2);
+        const Vec3 halfExtent = scale2.Abs() * pBox->GetHalfExtent() - Vec3::Replicate(boxConvexRadius);
+        const float sphereRadius = pSphere->GetScaledRadius(scale1);
+        const float combinedRadius = sphereRadius + boxConvexRadius;
+
+        // Get the sphere center in the space of the box.
+        const Mat44 inverseTransform2 = centerOfMassTransform2.InversedRotationTranslation();
+        const Vec3 center = inverseTransform2.TransformPoint(centerOfMassTransform1.GetTranslation());
+
+        // Find the closest point on the (shrunken) box.
+        const Vec3 closestOnBox = Vec3::Min(Vec3::Max(center, -halfExtent), halfExtent);
+        const Vec3 delta = closestOnBox - center;
+        const float distanceSqr = delta.LengthSqr();
+
+        Vec3 penetrationAxis;   // Points from the sphere towards the box, in box space.
+        Vec3 pointOnBox;
+        float penetrationDepth;
+        if (distanceSqr > 0.f)
+        {
+            // The sphere center is outside the box.
+            if (distanceSqr > math::Squared(combinedRadius + collideShapeSettings.m_maxSeparationDistance))
+                return;
+
+            const float distance = std::sqrt(distanceSqr);
+            penetrationAxis = delta / distance;
+            pointOnBox = closestOnBox;
+            penetrationDepth = combinedRadius - distance;
+        }
+        else
+        {
+            // The sphere center is inside the box, push it out through the closest face.
+            const Vec3 distanceToFaces = halfExtent - center.Abs();
+            const int axis = distanceToFaces.MinComponentIndex();
+            const float sign = center[axis] > 0.f? 1.f : -1.f;
+
+            penetrationAxis = Vec3::Zero();
+            penetrationAxis[axis] = -sign;
+            pointOnBox = center;
+            pointOnBox[axis] = sign * halfExtent[axis];
+            penetrationDepth = distanceToFaces[axis] + combinedRadius;
+        }
+
+        // Check if the penetration is bigger than the early out fraction
+        if (-penetrationDepth >= collector.GetEarlyOutFraction())
+            return;
+
+        // Convert to world space. The points are moved from the shrunken shapes to the real surfaces.
+        const Vec3 point1 = centerOfMassTransform2.TransformPoint(center + sphereRadius * penetrationAxis);
+        const Vec3 point2 = centerOfMassTransform2.TransformPoint(pointOnBox - boxConvexRadius * penetrationAxis);
+        const Vec3 penetrationAxisWorld = centerOfMassTransform2.TransformVector(penetrationAxis);
+
+        CollideShapeResult result(point1, point2, penetrationAxisWorld, penetrationDepth, subShapeIDCreator1.GetID(), subShapeIDCreator2.GetID(), TransformedShape::GetBodyID(collector.GetContext()));
+
+        // Gather faces, the sphere doesn't have a supporting face.
+        if (collideShapeSettings.m_collectFacesMode == ECollectFacesMode::CollectFaces)
+            pBox->GetSupportingFace(SubShapeID(), penetrationAxis, scale2, centerOfMassTransform2, result.m_shape2Face);
+
+        // [TODO]: NarrowPhase Tracking
+        collector.AddHit(result);
+    }
+
+    void SphereShape::CastSphereVsSphere(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings,
+        const Shape* pShape, const Vec3& scale, [[maybe_unused]] const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2,
+        const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2,
+        CastShapeCollector& collector)
+    {
+        NES_ASSERT(shapeCast.m_pShape->GetSubType() == EShapeSubType::Sphere);
+        NES_ASSERT(pShape->GetSubType() == EShapeSubType::Sphere);
+        const SphereShape* pCastSphere = checked_cast<const SphereShape*>(shapeCast.m_pShape);
+        const SphereShape* pTargetSphere = checked_cast<const SphereShape*>(pShape);
+
+        // The cast is in the local space of the target sphere, so it is centered around the origin.
+        // Casting a sphere against a sphere is the same as casting a ray against a sphere with the combined radius.
+        const float castRadius = pCastSphere->GetScaledRadius(shapeCast.m_scale);
+        const float targetRadius = pTargetSphere->GetScaledRadius(scale);
+        const Vec3 start = shapeCast.m_centerOfMassStart.GetTranslation();
+
+        float minFraction, maxFraction;
+        if (RaySphere(start, shapeCast.m_direction, Vec3::Zero(), castRadius + targetRadius, minFraction, maxFraction) == 0
+            || maxFraction < 0.f                                // Sphere is behind the cast
+            || minFraction >= collector.GetEarlyOutFraction())  // Hit is further than the current best hit
+            return;
+
+        const float fraction = math::Max(0.f, minFraction);
+        const Vec3 centerAtHit = start + fraction * shapeCast.m_direction;
+        const float distance = centerAtHit.Length();
+
+        // Contact normal points from the cast sphere towards the target sphere.
+        const Vec3 contactNormal = distance > 0.f? -centerAtHit / distance : -shapeCast.m_direction.NormalizedOr(Vec3::AxisY());
+
+        // Test if back facing
+        if (shapeCastSettings.m_backfaceModeConvex == EBackFaceMode::IgnoreBackFaces && contactNormal.Dot(shapeCast.m_direction) <= 0.f)
+            return;
+
+        // When touching both contact points coincide, when starting in penetration they are the deepest points.
+        const Vec3 contactPointA = centerAtHit + castRadius * contactNormal;
+        const Vec3 contactPointB = fraction > 0.f? contactPointA : -targetRadius * contactNormal;
+
+        ShapeCastResult result(fraction
+            , centerOfMassTransform2.TransformPoint(contactPointA)
+            , centerOfMassTransform2.TransformPoint(contactPointB)
+            , centerOfMassTransform2.TransformVector(contactNormal)
+            , false, subShapeIDCreator1.GetID(), subShapeIDCreator2.GetID(), TransformedShape::GetBodyID(collector.GetContext()));
+
+        // Early out if this hit is deeper than the collector's early out value:
+        if (fraction == 0.f && -result.m_penetrationDepth >= collector.GetEarlyOutFraction())
+            return;
+
+        // [TODO]: Narrow Phase tracking
+        collector.AddHit(result);
+    }
+}
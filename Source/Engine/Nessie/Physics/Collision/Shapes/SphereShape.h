@@ -0,0 +1,148 @@
+// SphereShape.h
+#pragma once
+#include "ConvexShape.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings that create a Sphere Shape.
+    //----------------------------------------------------------------------------------------------------
+    class SphereShapeSettings final : public ConvexShapeSettings
+    {
+    public:
+        float   m_radius = 0.f;
+
+        SphereShapeSettings() = default;
+        explicit SphereShapeSettings(const float radius) : m_radius(radius) {}
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ShapeSettings::Create()
+        //----------------------------------------------------------------------------------------------------
+        virtual ShapeResult Create() const override;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A Sphere, centered around the origin.
+    /// @note : Spheres are the most efficient collision shape. Collisions against other spheres and boxes,
+    ///     and ray/sphere casts, are solved analytically instead of going through GJK/EPA.
+    //----------------------------------------------------------------------------------------------------
+    class SphereShape final : public ConvexShape
+    {
+    public:
+        SphereShape() : ConvexShape(EShapeSubType::Sphere) {}
+        SphereShape(const SphereShapeSettings& settings, ShapeResult& outResult);
+        explicit SphereShape(const float radius);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the radius of the sphere.
+        //----------------------------------------------------------------------------------------------------
+        float                   GetRadius() const { return m_radius; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetLocalBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetLocalBounds() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetWorldBounds()
+        //----------------------------------------------------------------------------------------------------
+        virtual AABox           GetWorldBounds(const Mat44& centerOfMassTransform, const Vec3& scale) const override;
+        using Shape::GetWorldBounds;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetInnerRadius()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetInnerRadius() const override { return m_radius; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetMassProperties()
+        //----------------------------------------------------------------------------------------------------
+        virtual MassProperties  GetMassProperties() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetSurfaceNormal()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            GetSurfaceNormal(const SubShapeID& subShapeID, const Vec3& localSurfacePosition) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CollidePoint()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesStart()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetTrianglesNext()
+        //----------------------------------------------------------------------------------------------------
+        virtual int             GetTrianglesNext(GetTrianglesContext& context, int maxTrianglesRequested, Float3* outTriangleVertices) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::GetVolume()
+        //----------------------------------------------------------------------------------------------------
+        virtual float           GetVolume() const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::IsValidScale()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            IsValidScale(const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::MakeScaleValid()
+        //----------------------------------------------------------------------------------------------------
+        virtual Vec3            MakeScaleValid(const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ConvexShape::GetSupportFunction()
+        //----------------------------------------------------------------------------------------------------
+        virtual const Support*  GetSupportFunction(ESupportMode mode, SupportBuffer& buffer, const Vec3& scale) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Register shape functions within the registry. This also registers the analytic
+        ///     sphere vs sphere and sphere vs box collision functions, so it must be called after
+        ///     ConvexShape::Register(), which installs the generic GJK/EPA functions for all convex pairs.
+        //----------------------------------------------------------------------------------------------------
+        static void             Register();
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the radius of the sphere, taking the (uniform) scale into account.
+        //----------------------------------------------------------------------------------------------------
+        inline float            GetScaledRadius(const Vec3& scale) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Closed form sphere vs sphere test.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideSphereVsSphere(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Closed form sphere vs (rounded) box test.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideSphereVsBox(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Casts a sphere against a sphere by
+        ///     intersecting the ray of its center with a sphere of the combined radius.
+        //----------------------------------------------------------------------------------------------------
+        static void             CastSphereVsSphere(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape, const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector);
+
+    private:
+        /// Classes for GetSupportFunction()
+        class SphereNoConvex;
+        class SphereWithConvex;
+
+        float   m_radius = 0.f;
+    };
+}
@@ -0,0 +1,279 @@
+// StaticCompoundShape.cpp
+#include "StaticCompoundShape.h"
+
+#include <algorithm>
+#include "CompoundShapeVisitors.h"
+#include "Nessie/Physics/Collision/SortReverseAndStore.h"
+
+namespace nes
+{
+    void StaticCompoundShape::Node::SetChild(const uint index, const uint32 child, const AABox& bounds)
+    {
+        m_minX[index] = bounds.m_min.x;
+        m_minY[index] = bounds.m_min.y;
+        m_minZ[index] = bounds.m_min.z;
+        m_maxX[index] = bounds.m_max.x;
+        m_maxY[index] = bounds.m_max.y;
+        m_maxZ[index] = bounds.m_max.z;
+        m_children[index] = child;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    //	NOTES:
+    //  Children that are pushed onto the stack are only visited when their distance is still below the
+    //  early out fraction of the visitor when they are popped, since closer sub shapes may have found a hit
+    //  in the meantime. Empty children are skipped here, because scaling their inverted bounds with a
+    //  negative scale can make them pass the tests of the visitor.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Visitor>
+    void StaticCompoundShape::WalkTree(Visitor& visitor) const
+    {
+        uint32 stack[kStackSize];
+        [[maybe_unused]] float distanceStack[kStackSize];
+        stack[0] = 0;
+        distanceStack[0] = 0.f;
+        int top = 0;
+        do
+        {
+            // Pop the top of the stack
+            const uint32 child = stack[top];
+            bool shouldVisit = child != kInvalidChild;
+            if constexpr (Visitor::kTestsDistance)
+                shouldVisit &= distanceStack[top] < visitor.GetEarlyOutFraction();
+            --top;
+            if (!shouldVisit)
+                continue;
+
+            if (child & kIsSubShape)
+            {
+                const uint32 subShapeIndex = child & ~kIsSubShape;
+                visitor.VisitShape(m_subShapes[subShapeIndex], subShapeIndex);
+            }
+            else
+            {
+                const Node& node = m_nodes[child];
+                const Vec4Reg minX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_minX));
+                const Vec4Reg minY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_minY));
+                const Vec4Reg minZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_minZ));
+                const Vec4Reg maxX = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_maxX));
+                const Vec4Reg maxY = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_maxY));
+                const Vec4Reg maxZ = Vec4Reg::LoadFloat4Aligned(reinterpret_cast<const Float4*>(node.m_maxZ));
+                UVec4Reg children = UVec4Reg::LoadInt4Aligned(node.m_children);
+
+                NES_ASSERT(top + 4 < kStackSize, "Stack overflow!");
+                int numChildren;
+                if constexpr (Visitor::kTestsDistance)
+                    numChildren = SortReverseAndStore(visitor.TestBounds(minX, minY, minZ, maxX, maxY, maxZ), visitor.GetEarlyOutFraction(), children, &distanceStack[top + 1]);
+                else
+                    numChildren = CountAndSortTrues(visitor.TestBounds(minX, minY, minZ, maxX, maxY, maxZ), children);
+                children.StoreInt4(&stack[top + 1]);
+                top += numChildren;
+            }
+        }
+        while (top >= 0 && !visitor.ShouldAbort());
+    }
+
+    ShapeSettings::ShapeResult StaticCompoundShapeSettings::Create() const
+    {
+        if (m_cachedResult.IsEmpty())
+        {
+            StrongPtr<Shape> pShape = new StaticCompoundShape(*this, m_cachedResult);
+        }
+
+        return m_cachedResult;
+    }
+
+    StaticCompoundShape::StaticCompoundShape(const StaticCompoundShapeSettings& settings, ShapeResult& outResult)
+        : CompoundShape(EShapeSubType::StaticCompound, settings, outResult)
+    {
+        if (settings.m_subShapes.empty())
+        {
+            outResult.SetError("Compound needs at least 1 sub shape!");
+            return;
+        }
+
+        if (!CreateSubShapes(settings, outResult))
+            return;
+
+        // Get the bounds of the sub shapes, relative to the center of mass.
+        const uint numSubShapes = GetNumSubShapes();
+        std::vector<AABox> subShapeBounds(numSubShapes);
+        std::vector<uint> subShapeOrder(numSubShapes);
+        for (uint i = 0; i < numSubShapes; ++i)
+        {
+            const SubShape& subShape = m_subShapes[i];
+            subShapeBounds[i] = subShape.m_pShape->GetWorldBounds(Mat44::MakeRotationTranslation(subShape.m_rotation, subShape.m_positionCOM), Vec3::One());
+            subShapeOrder[i] = i;
+            m_localBounds.Encapsulate(subShapeBounds[i]);
+        }
+
+        // Every node except a root with a single sub shape has at least 2 children, so there are fewer nodes than sub shapes.
+        m_nodes.reserve(numSubShapes);
+        BuildNode(subShapeBounds, subShapeOrder.data(), subShapeOrder.data() + numSubShapes);
+
+        outResult.Set(this);
+    }
+
+    uint32 StaticCompoundShape::BuildNode(const std::vector<AABox>& subShapeBounds, uint* pBegin, uint* pEnd)
+    {
+        // Splits the sub shapes in [pSplitBegin, pSplitEnd) in two at the median of their centers along the
+        // axis in which the centers are spread out the most.
+        auto split = [&subShapeBounds](uint* pSplitBegin, uint* pSplitEnd) -> uint*
+        {
+            AABox centers;
+            for (const uint* pIndex = pSplitBegin; pIndex < pSplitEnd; ++pIndex)
+                centers.Encapsulate(subShapeBounds[*pIndex].Center());
+            const int axis = centers.Size().MaxComponentIndex();
+
+            uint* pMiddle = pSplitBegin + (pSplitEnd - pSplitBegin) / 2;
+            std::nth_element(pSplitBegin, pMiddle, pSplitEnd, [&subShapeBounds, axis](const uint left, const uint right)
+            {
+                return subShapeBounds[left].Center()[axis] < subShapeBounds[right].Center()[axis];
+            });
+            return pMiddle;
+        };
+
+        // Divide the sub shapes over the 4 children. Up to 4 sub shapes are stored directly in the node.
+        uint* groups[5];
+        groups[0] = pBegin;
+        groups[4] = pEnd;
+        if (pEnd - pBegin <= 4)
+        {
+            for (int i = 1; i < 4; ++i)
+                groups[i] = std::min(pBegin + i, pEnd);
+        }
+        else
+        {
+            groups[2] = split(pBegin, pEnd);
+            groups[1] = split(pBegin, groups[2]);
+            groups[3] = split(groups[2], pEnd);
+        }
+
+        // Children are built after this node, so that the root is the first node.
+        const uint32 nodeIndex = static_cast<uint32>(m_nodes.size());
+        m_nodes.emplace_back();
+
+        for (uint i = 0; i < 4; ++i)
+        {
+            uint32 child;
+            AABox bounds;
+            const auto numInGroup = groups[i + 1] - groups[i];
+            if (numInGroup == 0)
+            {
+                child = kInvalidChild;
+            }
+            else if (numInGroup == 1)
+            {
+                child = *groups[i] | kIsSubShape;
+                bounds = subShapeBounds[*groups[i]];
+            }
+            else
+            {
+                for (const uint* pIndex = groups[i]; pIndex < groups[i + 1]; ++pIndex)
+                    bounds.Encapsulate(subShapeBounds[*pIndex]);
+                child = BuildNode(subShapeBounds, groups[i], groups[i + 1]);
+            }
+
+            // Building the children can grow m_nodes, so the node is looked up again.
+            m_nodes[nodeIndex].SetChild(i, child, bounds);
+        }
+
+        return nodeIndex;
+    }
+
+    bool StaticCompoundShape::CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const
+    {
+        CastRayClosestVisitor visitor(ray, *this, subShapeIDCreator, hitResult);
+        WalkTree(visitor);
+        return visitor.m_didHit;
+    }
+
+    void StaticCompoundShape::CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator,
+        CastRayCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        CastRayCollectorVisitor visitor(ray, settings, *this, subShapeIDCreator, collector, shapeFilter);
+        WalkTree(visitor);
+    }
+
+    void StaticCompoundShape::CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector,
+        const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        CollidePointVisitor visitor(point, *this, subShapeIDCreator, collector, shapeFilter);
+        WalkTree(visitor);
+    }
+
+    void StaticCompoundShape::CollectTransformedShapes(const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale,
+        const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter) const
+    {
+        // Test the shape filter
+        if (!shapeFilter.ShouldCollide(this, subShapeIDCreator.GetID()))
+            return;
+
+        CollectTransformedShapesVisitor visitor(box, *this, positionCOM, rotation, scale, subShapeIDCreator, collector, shapeFilter);
+        WalkTree(visitor);
+    }
+
+    size_t StaticCompoundShape::GetMemoryUsage() const
+    {
+        return sizeof(*this)
+            + m_subShapes.size() * sizeof(SubShape)
+            + m_nodes.size() * sizeof(Node);
+    }
+
+    void StaticCompoundShape::CollideCompoundVsShape(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2,
+        const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape1->GetSubType() == EShapeSubType::StaticCompound);
+        const StaticCompoundShape* pCompound1 = checked_cast<const StaticCompoundShape*>(pShape1);
+
+        CollideCompoundVsShapeVisitor visitor(pCompound1, pShape2, scale1, scale2, centerOfMassTransform1, centerOfMassTransform2, subShapeIDCreator1, subShapeIDCreator2, collideShapeSettings, collector, shapeFilter);
+        pCompound1->WalkTree(visitor);
+    }
+
+    void StaticCompoundShape::CollideShapeVsCompound(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2,
+        const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector,
+        const ShapeFilter& shapeFilter)
+    {
+        NES_ASSERT(pShape2->GetSubType() == EShapeSubType::StaticCompound);
+        const StaticCompoundShape* pCompound2 = checked_cast<const StaticCompoundShape*>(pShape2);
+
+        CollideShapeVsCompoundVisitor visitor(pShape1, pCompound2, scale1, scale2, centerOfMassTransform1, centerOfMassTransform2, subShapeIDCreator1, subShapeIDCreator2, collideShapeSettings, collector, shapeFilter);
+        pCompound2->WalkTree(visitor);
+    }
+
+    void StaticCompoundShape::CastShapeVsCompound(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape,
+        const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1,
+        const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector)
+    {
+        NES_ASSERT(pShape->GetSubType() == EShapeSubType::StaticCompound);
+        const StaticCompoundShape* pCompound = checked_cast<const StaticCompoundShape*>(pShape);
+
+        CastShapeVsCompoundVisitor visitor(shapeCast, shapeCastSettings, pCompound, scale, shapeFilter, centerOfMassTransform2, subShapeIDCreator1, subShapeIDCreator2, collector);
+        pCompound->WalkTree(visitor);
+    }
+
+    void StaticCompoundShape::Register()
+    {
+        ShapeFunctions& f = ShapeFunctions::Get(EShapeSubType::StaticCompound);
+        f.m_construct = []() -> Shape* { return new StaticCompoundShape; };
+        f.m_color = Color::Yellow();
+
+        for (const EShapeSubType subType : kAllSubShapeTypes)
+        {
+            CollisionSolver::RegisterCollideShape(EShapeSubType::StaticCompound, subType, CollideCompoundVsShape);
+            CollisionSolver::RegisterCollideShape(subType, EShapeSubType::StaticCompound, CollideShapeVsCompound);
+            CollisionSolver::RegisterCastShape(subType, EShapeSubType::StaticCompound, CastShapeVsCompound);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+// StaticCompoundShape.h
+#pragma once
+#include "CompoundShape.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings that create a Static Compound Shape.
+    //----------------------------------------------------------------------------------------------------
+    class StaticCompoundShapeSettings final : public CompoundShapeSettings
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        /// @see : ShapeSettings::Create()
+        //----------------------------------------------------------------------------------------------------
+        virtual ShapeResult Create() const override;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A compound shape whose sub shapes cannot change after it is created, e.g. a vehicle or a
+    ///     building made out of many parts.
+    ///
+    /// The bounds of the sub shapes are stored in a tree with 4 children per node, built top-down by
+    /// splitting the sub shapes at the median of their centers. The bounds of the children are stored as
+    /// a structure of arrays, so that queries test 4 children at a time and only visit the sub shapes that
+    /// they overlap. Use a MutableCompoundShape if sub shapes need to be added, removed or moved.
+    //----------------------------------------------------------------------------------------------------
+    class StaticCompoundShape final : public CompoundShape
+    {
+    public:
+        StaticCompoundShape() : CompoundShape(EShapeSubType::StaticCompound) {}
+        StaticCompoundShape(const StaticCompoundShapeSettings& settings, ShapeResult& outResult);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual bool            CastRay(const RayCast& ray, const SubShapeIDCreator& subShapeIDCreator, RayCastResult& hitResult) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CastRay()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CastRay(const RayCast& ray, const RayCastSettings& settings, const SubShapeIDCreator& subShapeIDCreator, CastRayCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @see : Shape::CollidePoint()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollidePoint(const Vec3& point, const SubShapeIDCreator& subShapeIDCreator, CollidePointCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Recurses into the sub shapes that overlap the box.
+        /// @see : Shape::CollectTransformedShapes()
+        //----------------------------------------------------------------------------------------------------
+        virtual void            CollectTransformedShapes(const AABox& box, const Vec3& positionCOM, const Quat& rotation, const Vec3& scale, const SubShapeIDCreator& subShapeIDCreator, TransformedShapeCollector& collector, const ShapeFilter& shapeFilter) const override;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of bytes used by the sub shapes and the tree.
+        //----------------------------------------------------------------------------------------------------
+        size_t                  GetMemoryUsage() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Register shape functions within the registry. This registers colliding any shape with the
+        ///     static compound and casting any shape against it.
+        //----------------------------------------------------------------------------------------------------
+        static void             Register();
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Node of the tree. Stores the bounds of 4 children as a structure of arrays, relative to the
+        ///     center of mass of the compound.
+        //----------------------------------------------------------------------------------------------------
+        struct alignas(16) Node
+        {
+            float               m_minX[4];
+            float               m_minY[4];
+            float               m_minZ[4];
+            float               m_maxX[4];
+            float               m_maxY[4];
+            float               m_maxZ[4];
+            uint32              m_children[4];      /// Index of a child node, or a sub shape index with kIsSubShape set, or kInvalidChild.
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Set the child at 'index'.
+            //----------------------------------------------------------------------------------------------------
+            void                SetChild(const uint index, const uint32 child, const AABox& bounds);
+        };
+
+        /// Child references with this bit set are the index of a sub shape, otherwise they are the index of a node.
+        static constexpr uint32 kIsSubShape = 0x80000000;
+        static constexpr uint32 kInvalidChild = 0xffffffff;
+
+        /// Max size of the stack used to walk the tree. Each level of the tree adds at most 3 entries.
+        static constexpr int    kStackSize = 128;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Build the node for the sub shapes in [pBegin, pEnd), and the nodes below it.
+        ///	@param subShapeBounds : Bounds of all sub shapes, relative to the center of mass of the compound.
+        ///	@returns : Index of the node.
+        //----------------------------------------------------------------------------------------------------
+        uint32                  BuildNode(const std::vector<AABox>& subShapeBounds, uint* pBegin, uint* pEnd);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Walk the tree, see CompoundShapeVisitors.h for the interface of the visitor.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Visitor>
+        void                    WalkTree(Visitor& visitor) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Collides the sub shapes that overlap
+        ///     shape 2 with shape 2.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideCompoundVsShape(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Collides shape 1 with the sub shapes that
+        ///     overlap it.
+        //----------------------------------------------------------------------------------------------------
+        static void             CollideShapeVsCompound(const Shape* pShape1, const Shape* pShape2, const Vec3& scale1, const Vec3& scale2, const Mat44& centerOfMassTransform1, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, const CollideShapeSettings& collideShapeSettings, CollideShapeCollector& collector, const ShapeFilter& shapeFilter);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Helper function called by the CollisionSolver. Casts a shape against the sub shapes that
+        ///     it sweeps through.
+        //----------------------------------------------------------------------------------------------------
+        static void             CastShapeVsCompound(const ShapeCast& shapeCast, const ShapeCastSettings& shapeCastSettings, const Shape* pShape, const Vec3& scale, const ShapeFilter& shapeFilter, const Mat44& centerOfMassTransform2, const SubShapeIDCreator& subShapeIDCreator1, const SubShapeIDCreator& subShapeIDCreator2, CastShapeCollector& collector);
+
+    private:
+        std::vector<Node>       m_nodes{};              /// The root is the first node.
+    };
+}
@@ -74,7 +74,7 @@ namespace nes
         }
     }
 
-    void TransformedShape::CollideShape(const Shape* pShape, const Vec3& shapeScale, const Mat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3& baseOffset, CollideShapeCollector& collector, const ShapeFilter& shapeFilter) const
+    void TransformedShape::CollideShape(const Shape* pShape, const Vec3& shapeScale, const RMat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3& baseOffset, CollideShapeCollector& collector, const ShapeFilter& shapeFilter) const
     {
         if (m_pShape != nullptr)
         {
@@ -85,8 +85,8 @@ namespace nes
             // Collide the shapes.
             SubShapeIDCreator subShapeID1(m_subShapeIDCreator);
             SubShapeIDCreator subShapeID2(m_subShapeIDCreator);
-            Mat44 transform1 = centerOfMassTransform.PostTranslated(-baseOffset);
-            Mat44 transform2 = GetCenterOfMassTransform().PostTranslated(-baseOffset);
+            Mat44 transform1 = centerOfMassTransform.PostTranslated(-baseOffset).ToMat44();
+            Mat44 transform2 = GetCenterOfMassTransform().PostTranslated(-baseOffset).ToMat44();
             CollisionSolver::CollideShapeVsShape(pShape, m_pShape, shapeScale, GetShapeScale(), transform1, transform2, subShapeID1, subShapeID2, collideShapeSettings, collector, shapeFilter);
         }
     }
@@ -103,7 +103,7 @@ namespace nes
             ShapeCast localShapeCast(shapeCast.PostTranslated(-baseOffset));
 
             // Get center of mass of object we're casting against relative to the base offset and convert it to floats
-            Mat44 centerOfMassTransform2 = GetCenterOfMassTransform().PostTranslated(-baseOffset);
+            Mat44 centerOfMassTransform2 = GetCenterOfMassTransform().PostTranslated(-baseOffset).ToMat44();
 
             // Cast the shape onto this one.
             SubShapeIDCreator subShapeID1(m_subShapeIDCreator);
@@ -119,9 +119,9 @@ namespace nes
             struct MyCollector : public TransformedShapeCollector
             {
                 TransformedShapeCollector& m_collector;
-                Vec3 m_shapePositionCOM;
+                RVec3 m_shapePositionCOM;
                 
-                MyCollector(TransformedShapeCollector& collector, const Vec3& shapePositionCOM)
+                MyCollector(TransformedShapeCollector& collector, const RVec3& shapePositionCOM)
                     : TransformedShapeCollector(collector)
                     , m_collector(collector)
                     , m_shapePositionCOM(shapePositionCOM)
@@ -158,7 +158,7 @@ namespace nes
         }
     }
     
-    void TransformedShape::GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& baseOffset) const
+    void TransformedShape::GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const RVec3& baseOffset) const
     {
         if (m_pShape != nullptr)
         {
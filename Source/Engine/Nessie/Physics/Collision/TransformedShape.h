@@ -29,7 +29,7 @@ namespace nes
     public:
         using GetTrianglesContext = Shape::GetTrianglesContext;
         
-        Vec3                    m_shapePositionCOM;
+        RVec3                   m_shapePositionCOM;
         Quat                    m_shapeRotation;
         ConstStrongPtr<Shape>   m_pShape;
         Float3                  m_shapeScale { 1.0, 1.0, 1.0 };
@@ -40,7 +40,7 @@ namespace nes
         NES_OVERRIDE_NEW_DELETE
 
         TransformedShape() = default;
-        inline TransformedShape(const Vec3& positionCOM, const Quat& rotation, const Shape* pShape, const BodyID& bodyID, const SubShapeIDCreator& subShapeIdCreator = SubShapeIDCreator());
+        inline TransformedShape(const RVec3& positionCOM, const Quat& rotation, const Shape* pShape, const BodyID& bodyID, const SubShapeIDCreator& subShapeIdCreator = SubShapeIDCreator());
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Cast a ray and find the closest hit. Returns true if it finds a hit. Hits further than
@@ -80,7 +80,7 @@ namespace nes
         ///	@param collector : Collector that receives the hits.
         ///	@param shapeFilter : Filter that allows you to reject certain collisions.
         //----------------------------------------------------------------------------------------------------
-        void                    CollideShape(const Shape* pShape, const Vec3& shapeScale, const Mat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3& baseOffset, CollideShapeCollector& collector, const ShapeFilter& shapeFilter = {}) const;
+        void                    CollideShape(const Shape* pShape, const Vec3& shapeScale, const RMat44& centerOfMassTransform, const CollideShapeSettings& collideShapeSettings, const RVec3& baseOffset, CollideShapeCollector& collector, const ShapeFilter& shapeFilter = {}) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Cast a shape and report any hits in the collector.
@@ -107,7 +107,7 @@ namespace nes
         ///	@param baseOffset : All hit results will be returned relative to this offset; can be zero to get results
         ///     in world space.
         //----------------------------------------------------------------------------------------------------
-        void                    GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const Vec3& baseOffset) const;
+        void                    GetTrianglesStart(GetTrianglesContext& context, const AABox& box, const RVec3& baseOffset) const;
 
         //----------------------------------------------------------------------------------------------------
         //	NOTES:
@@ -137,30 +137,30 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         /// @brief : Calculates the center of mass transform for this shape's center of mass (excluding scale). 
         //----------------------------------------------------------------------------------------------------
-        inline Mat44            GetCenterOfMassTransform() const        { return Mat44::MakeRotationTranslation(m_shapeRotation, m_shapePositionCOM); }
+        inline RMat44           GetCenterOfMassTransform() const        { return RMat44::MakeRotationTranslation(m_shapeRotation, m_shapePositionCOM); }
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Calculates the inverse of the center of mass transform for this shape's center of mass (excluding scale). 
         //----------------------------------------------------------------------------------------------------
-        inline Mat44            GetInverseCenterOfMassTransform() const { return Mat44::MakeInverseRotationTranslation(m_shapeRotation, m_shapePositionCOM); }
+        inline RMat44           GetInverseCenterOfMassTransform() const { return RMat44::MakeInverseRotationTranslation(m_shapeRotation, m_shapePositionCOM); }
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Set the world transform (including scale) of this transformed shape.
         /// @note : This is not from the center of mass, but in the space the shape was created.
         //----------------------------------------------------------------------------------------------------
-        inline void             SetWorldTransform(const Vec3& position, const Quat& rotation, const Vec3& scale);
+        inline void             SetWorldTransform(const RVec3& position, const Quat& rotation, const Vec3& scale);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Set the world transform (including scale) of this transformed shape.
         /// @note : This is not from the center of mass, but in the space the shape was created.
         //----------------------------------------------------------------------------------------------------
-        inline void             SetWorldTransform(const Mat44& transform);
+        inline void             SetWorldTransform(const RMat44& transform);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the world transform (including scale) of this transformed shape.
         /// @note : This is not from the center of mass, but in the space the shape was created.
         //----------------------------------------------------------------------------------------------------
-        inline Mat44            GetWorldTransform() const;
+        inline RMat44           GetWorldTransform() const;
         
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the world space bounding box for the transformed shape. 
@@ -180,7 +180,7 @@ namespace nes
         ///     as contact normal as GetWorldSpaceSurfaceNormal() will only return face normals (and not vertex
         ///     or edge normals).
         //----------------------------------------------------------------------------------------------------
-        inline Vec3             GetWorldSpaceSurfaceNormal(const SubShapeID& subShapeID, const Vec3& position) const;
+        inline Vec3             GetWorldSpaceSurfaceNormal(const SubShapeID& subShapeID, const RVec3& position) const;
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the vertices of the face that faces 'direction' the most (Includes any convex radius).
@@ -193,7 +193,7 @@ namespace nes
         ///	@param outVertices : Resulting face. Note that the returned face can have a single point if the shape
         ///     doesn't have polygons to return (e.g. because it's a sphere). The face will be returned in world space.
         //----------------------------------------------------------------------------------------------------
-        inline void             GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction, const Vec3& baseOffset, Shape::SupportingFace& outVertices) const;
+        inline void             GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction, const RVec3& baseOffset, Shape::SupportingFace& outVertices) const;
 
         // [TODO]: Physics Material
 
@@ -3,7 +3,7 @@
 
 namespace nes
 {
-    TransformedShape::TransformedShape(const Vec3& positionCOM, const Quat& rotation, const Shape* pShape, const BodyID& bodyID, const SubShapeIDCreator& subShapeIdCreator)
+    TransformedShape::TransformedShape(const RVec3& positionCOM, const Quat& rotation, const Shape* pShape, const BodyID& bodyID, const SubShapeIDCreator& subShapeIdCreator)
         : m_shapePositionCOM(positionCOM)
         , m_shapeRotation(rotation)
         , m_pShape(pShape)
@@ -13,24 +13,25 @@ namespace nes
         //
     }
 
-    void TransformedShape::SetWorldTransform(const Vec3& position, const Quat& rotation, const Vec3& scale)
+    void TransformedShape::SetWorldTransform(const RVec3& position, const Quat& rotation, const Vec3& scale)
     {
         m_shapePositionCOM = position + rotation * (scale * m_pShape->GetCenterOfMass());
         m_shapeRotation = rotation;
         SetShapeScale(scale);
     }
 
-    void TransformedShape::SetWorldTransform(const Mat44& transform)
+    void TransformedShape::SetWorldTransform(const RMat44& transform)
     {
         Vec3 scale;
-        Mat44 rotationTranslation = transform.Decompose(scale);
-        SetWorldTransform(rotationTranslation.GetColumn3(3), rotationTranslation.ToQuaternion(), scale);
+        RMat44 rotationTranslation = transform.Decompose(scale);
+        SetWorldTransform(rotationTranslation.GetTranslation(), rotationTranslation.ToQuaternion(), scale);
     }
 
-    Mat44 TransformedShape::GetWorldTransform() const
+    RMat44 TransformedShape::GetWorldTransform() const
     {
-        Mat44 transform = Mat44::MakeRotation(m_shapeRotation).PreScaled(GetShapeScale());
-        transform.SetTranslation(m_shapePositionCOM - transform.TransformVector(m_pShape->GetCenterOfMass()));
+        const Mat44 rotation = Mat44::MakeRotation(m_shapeRotation).PreScaled(GetShapeScale());
+        RMat44 transform(rotation);
+        transform.SetTranslation(m_shapePositionCOM - rotation.TransformVector(m_pShape->GetCenterOfMass()));
         return transform;
     }
 
@@ -46,17 +47,17 @@ namespace nes
         return result;
     }
 
-    Vec3 TransformedShape::GetWorldSpaceSurfaceNormal(const SubShapeID& subShapeID, const Vec3& position) const
+    Vec3 TransformedShape::GetWorldSpaceSurfaceNormal(const SubShapeID& subShapeID, const RVec3& position) const
     {
-        Mat44 inverseCOM = GetInverseCenterOfMassTransform();
+        RMat44 inverseCOM = GetInverseCenterOfMassTransform();
         Vec3 scale = GetShapeScale();
         return inverseCOM.Multiply3x3Transposed(m_pShape->GetSurfaceNormal(MakeSubShapeIDRelativeToShape(subShapeID), Vec3(inverseCOM.TransformPoint(position)) / scale) / scale).Normalized();
     }
 
     void TransformedShape::GetSupportingFace(const SubShapeID& subShapeID, const Vec3& direction,
-        const Vec3& baseOffset, Shape::SupportingFace& outVertices) const
+        const RVec3& baseOffset, Shape::SupportingFace& outVertices) const
     {
-        const Mat44 com = GetCenterOfMassTransform().PostTranslated(-baseOffset);
+        const Mat44 com = GetCenterOfMassTransform().PostTranslated(-baseOffset).ToMat44();
         m_pShape->GetSupportingFace(MakeSubShapeIDRelativeToShape(subShapeID), com.Multiply3x3Transposed(direction), GetShapeScale(), com, outVertices);
     }
 
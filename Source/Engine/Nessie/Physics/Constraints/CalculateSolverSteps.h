@@ -1,6 +1,10 @@
 // CalculateSolverSteps.h
 #pragma once
+#include <type_traits>
 #include "Nessie/Physics/PhysicsSettings.h"
+#include "Nessie/Physics/SimulationRegion.h"
+#include "Nessie/Physics/Body/MotionProperties.h"
+#include "Nessie/Physics/Constraints/TwoBodyConstraint.h"
 
 namespace nes
 {
@@ -10,7 +14,14 @@ namespace nes
     class CalculateSolverSteps
     {
     public:
-        NES_INLINE explicit CalculateSolverSteps(const PhysicsSettings& settings) : m_settings(settings) {}
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Constructor.
+        ///	@param settings : Settings that provide the default number of steps.
+        ///	@param pRegionSettings : Optional array of kMaxSimulationRegions settings. Bodies without an override
+        ///     use the override of their simulation region. Constraints without an override use the highest
+        ///     override of the regions of the dynamic bodies that they connect.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE explicit CalculateSolverSteps(const PhysicsSettings& settings, const SimulationRegionSettings* pRegionSettings = nullptr) : m_settings(settings), m_pRegionSettings(pRegionSettings) {}
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Combine the number of velocity and position steps for this body/constraint with the current values.
@@ -19,11 +30,40 @@ namespace nes
         NES_INLINE void     operator()(const ObjectType* pObject)
         {
             unsigned numVelocitySteps = pObject->GetNumVelocityStepsOverride();
+            unsigned numPositionSteps = pObject->GetNumPositionStepsOverride();
+
+            if constexpr (std::is_same_v<ObjectType, MotionProperties>)
+            {
+                if (m_pRegionSettings != nullptr)
+                    ApplyRegionOverride(pObject, numVelocitySteps, numPositionSteps);
+            }
+            else if constexpr (std::is_same_v<ObjectType, Constraint>)
+            {
+                // Constraints don't belong to a region. Islands that only have constraints pass no bodies to this
+                // calculator, so the bodies of the constraint provide the region override.
+                if (m_pRegionSettings != nullptr && pObject->GetType() == EConstraintType::TwoBodyConstraint)
+                {
+                    const TwoBodyConstraint* pTwoBodyConstraint = static_cast<const TwoBodyConstraint*>(pObject);
+                    const unsigned constraintVelocitySteps = numVelocitySteps;
+                    const unsigned constraintPositionSteps = numPositionSteps;
+                    for (const Body* pBody : { pTwoBodyConstraint->GetBodyA(), pTwoBodyConstraint->GetBodyB() })
+                    {
+                        if (!pBody->IsDynamic())
+                            continue;
+
+                        unsigned bodyVelocitySteps = constraintVelocitySteps;
+                        unsigned bodyPositionSteps = constraintPositionSteps;
+                        ApplyRegionOverride(pBody->GetMotionPropertiesUnchecked(), bodyVelocitySteps, bodyPositionSteps);
+                        numVelocitySteps = math::Max(numVelocitySteps, bodyVelocitySteps);
+                        numPositionSteps = math::Max(numPositionSteps, bodyPositionSteps);
+                    }
+                }
+            }
+
             m_numVelocitySteps = math::Max(m_numVelocitySteps, numVelocitySteps);
             m_applyDefaultVelocity |= numVelocitySteps == 0;
 
-            unsigned numPositionSteps = pObject->GetNumPositionStepsOverride();
-            m_numVelocitySteps = math::Max(m_numPositionSteps, numPositionSteps);
+            m_numPositionSteps = math::Max(m_numPositionSteps, numPositionSteps);
             m_applyDefaultPosition |= numPositionSteps == 0;
         }
 
@@ -44,7 +84,20 @@ namespace nes
         NES_INLINE unsigned int GetNumPositionSteps() const { return m_numPositionSteps; }
 
     private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Replace step counts that are 0 (not overridden) with the override of the body's region.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void     ApplyRegionOverride(const MotionProperties* pMotionProperties, unsigned& numVelocitySteps, unsigned& numPositionSteps) const
+        {
+            const SimulationRegionSettings& region = m_pRegionSettings[pMotionProperties->GetSimulationRegion()];
+            if (numVelocitySteps == 0)
+                numVelocitySteps = region.m_numVelocityStepsOverride;
+            if (numPositionSteps == 0)
+                numPositionSteps = region.m_numPositionStepsOverride;
+        }
+
         const PhysicsSettings& m_settings;
+        const SimulationRegionSettings* m_pRegionSettings = nullptr;
         unsigned int           m_numVelocitySteps = 0;
         unsigned int           m_numPositionSteps = 0;
         bool                   m_applyDefaultVelocity = false; 
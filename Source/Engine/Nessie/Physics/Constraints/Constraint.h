@@ -4,6 +4,7 @@
 #include "Nessie/Core/Result.h"
 #include "Nessie/Core/Memory/StrongPtr.h"
 #include "Nessie/Math/Math.h"
+#include "Nessie/Physics/StateRecorder.h"
 
 namespace nes
 {
@@ -194,6 +195,17 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         virtual StrongPtr<ConstraintSettings> GetConstraintSettings() const = 0;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the state of the constraint. Derived constraints should call this version and then save
+        ///     the accumulated impulses of their constraint parts, which are used for warm starting.
+        //----------------------------------------------------------------------------------------------------
+        virtual void                SaveState(StateRecorder& stream) const              { stream.Write(m_isEnabled); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the state of the constraint that was saved with SaveState().
+        //----------------------------------------------------------------------------------------------------
+        virtual void                RestoreState(StateRecorder& stream)                 { stream.Read(m_isEnabled); }
+
     protected:
         //----------------------------------------------------------------------------------------------------
         /// @brief : Helper function to copy settings beack to constraint settings for this base class.
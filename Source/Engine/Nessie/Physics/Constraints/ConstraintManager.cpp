@@ -58,6 +58,52 @@ namespace nes
         return copy;
     }
 
+    void ConstraintManager::SaveState(StateRecorder& stream, const StateRecorderFilter* pFilter) const
+    {
+        UniqueLock lock(m_mutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::ConstraintsArray));
+
+        // Count the constraints to save
+        uint32 numConstraints = 0;
+        for (const StrongPtr<Constraint>& pConstraint : m_constraints)
+        {
+            if (pFilter == nullptr || pFilter->ShouldSaveConstraint(*pConstraint))
+                ++numConstraints;
+        }
+        stream.Write(numConstraints);
+
+        // Write the state of the constraints
+        for (const StrongPtr<Constraint>& pConstraint : m_constraints)
+        {
+            if (pFilter == nullptr || pFilter->ShouldSaveConstraint(*pConstraint))
+            {
+                stream.Write(pConstraint->m_constraintIndex);
+                pConstraint->SaveState(stream);
+            }
+        }
+    }
+
+    bool ConstraintManager::RestoreState(StateRecorder& stream)
+    {
+        UniqueLock lock(m_mutex NES_IF_ASSERTS_ENABLED(, m_lockContext, EPhysicsLockTypes::ConstraintsArray));
+
+        uint32 numConstraints = 0;
+        stream.Read(numConstraints);
+        if (stream.IsFailed() || numConstraints > m_constraints.size())
+            return false;
+
+        for (uint32 i = 0; i < numConstraints; ++i)
+        {
+            uint32 constraintIndex = Constraint::kInvalidConstraintIndex;
+            stream.Read(constraintIndex);
+            if (constraintIndex >= m_constraints.size())
+                return false;
+
+            m_constraints[constraintIndex]->RestoreState(stream);
+        }
+
+        return !stream.IsFailed();
+    }
+
     void ConstraintManager::GetActiveConstraints(uint32_t beginIndex, uint32_t endIndex, Constraint** outActiveConstraints, uint32_t& outNumActiveConstraints) const
     {
         NES_ASSERT(endIndex <= m_constraints.size());
@@ -85,6 +85,19 @@ namespace nes
         /// @brief : This function is called multiple times to iteratively come to a solution that meets all position constraints
         //----------------------------------------------------------------------------------------------------
         static bool         SolvePositionConstraints(Constraint** activeConstraints, const uint32_t* pIndexBegin, const uint32_t* pIndexEnd, const float deltaTime, const float baumgarte);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the state of the constraints.
+        ///	@param stream : Stream to write the state to.
+        ///	@param pFilter : Optional filter that selects which constraints are saved.
+        //----------------------------------------------------------------------------------------------------
+        void                SaveState(StateRecorder& stream, const StateRecorderFilter* pFilter) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the state of the constraints that was saved with SaveState(). Returns false if the
+        ///     state doesn't match the constraints in the manager.
+        //----------------------------------------------------------------------------------------------------
+        bool                RestoreState(StateRecorder& stream);
         
         //----------------------------------------------------------------------------------------------------
         /// @brief : Lock all constraints. This should only be done during PhysicsSystem::Update(). 
@@ -3,6 +3,7 @@
 #include "Nessie/Physics/Body/Body.h"
 #include "Nessie/Physics/Constraints/ConstraintPart/SpringPart.h"
 #include "Nessie/Physics/Constraints/SpringSettings.h"
+#include "Nessie/Physics/StateRecorder.h"
 
 namespace nes
 {
@@ -39,6 +40,8 @@ namespace nes
     //----------------------------------------------------------------------------------------------------
     class AxisConstraintPart
     {
+        friend class AxisConstraintPart4;
+
     public:
         AxisConstraintPart() = default;
         
@@ -221,6 +224,16 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         inline float        GetTotalLambda() const { return m_totalLambda; }
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the accumulated impulse, which is used for warm starting. 
+        //----------------------------------------------------------------------------------------------------
+        inline void         SaveState(StateRecorder& stream) const  { stream.Write(m_totalLambda); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the accumulated impulse that was saved with SaveState().
+        //----------------------------------------------------------------------------------------------------
+        inline void         RestoreState(StateRecorder& stream)     { stream.Read(m_totalLambda); }
+
     private:
         //----------------------------------------------------------------------------------------------------
         /// @brief : Internal helper function to update velocities after Lagrange multiplier is calculated. 
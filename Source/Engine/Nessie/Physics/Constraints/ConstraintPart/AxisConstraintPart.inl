@@ -146,7 +146,7 @@ namespace nes
     bool AxisConstraintPart::TemplatedSolveVelocityConstraintApplyLambda(MotionProperties* pMotionProps1, const float invMass1, MotionProperties* pMotionProps2, const float invMass2, const Vec3 worldSpaceAxis, const float totalLambda)
     {
         const float deltaLambda = totalLambda - m_totalLambda; // Calculate change in lambda
-        m_totalLambda += totalLambda;
+        m_totalLambda = totalLambda; // Store the accumulated impulse
 
         return ApplyVelocityStep<Type1, Type2>(pMotionProps1, invMass1, pMotionProps2, invMass2, worldSpaceAxis, deltaLambda);
     }
@@ -374,12 +374,12 @@ namespace nes
             if constexpr (Type1 == EBodyMotionType::Dynamic)
             {
                 pMotionProps1->Internal_SubLinearVelocityStep((lambda * invMass1) * worldSpaceAxis);
-                pMotionProps1->Internal_SubLinearVelocityStep(lambda * Vec3::LoadFloat3Unsafe(m_InvI1_R1PlusUxAxis));
+                pMotionProps1->Internal_SubAngularVelocityStep(lambda * Vec3::LoadFloat3Unsafe(m_InvI1_R1PlusUxAxis));
             }
             if constexpr (Type2 == EBodyMotionType::Dynamic)
             {
                 pMotionProps2->Internal_AddLinearVelocityStep((lambda * invMass2) * worldSpaceAxis);
-                pMotionProps2->Internal_AddLinearVelocityStep(lambda * Vec3::LoadFloat3Unsafe(m_InvI2_R2xAxis));
+                pMotionProps2->Internal_AddAngularVelocityStep(lambda * Vec3::LoadFloat3Unsafe(m_InvI2_R2xAxis));
             }
             return true;
         }
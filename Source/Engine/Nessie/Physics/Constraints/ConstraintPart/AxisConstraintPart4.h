@@ -0,0 +1,162 @@
+// AxisConstraintPart4.h
+#pragma once
+#include "AxisConstraintPart.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : 4 three component vectors stored as a structure of arrays, one register per component.
+    ///     Lane i of m_x, m_y and m_z is vector i.
+    //----------------------------------------------------------------------------------------------------
+    struct Vec3x4
+    {
+        Vec4Reg                 m_x;
+        Vec4Reg                 m_y;
+        Vec4Reg                 m_z;
+
+        NES_INLINE Vec3x4       operator+(const Vec3x4& other) const                    { return { m_x + other.m_x, m_y + other.m_y, m_z + other.m_z }; }
+        NES_INLINE Vec3x4       operator-(const Vec3x4& other) const                    { return { m_x - other.m_x, m_y - other.m_y, m_z - other.m_z }; }
+        NES_INLINE Vec3x4       operator*(const Vec4Reg& scale) const                   { return { m_x * scale, m_y * scale, m_z * scale }; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Dot product of each lane.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec4Reg      Dot(const Vec3x4& other) const                          { return m_x * other.m_x + m_y * other.m_y + m_z * other.m_z; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Transpose 4 vectors (the W component is ignored) into a structure of arrays.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE Vec3x4 Transpose(const Vec4Reg& vec0, const Vec4Reg& vec1, const Vec4Reg& vec2, const Vec4Reg& vec3);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Transpose back into 4 vectors. The W components are undefined.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         TransposeTo(Vec4Reg& outVec0, Vec4Reg& outVec1, Vec4Reg& outVec2, Vec4Reg& outVec3) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : For each lane, select 'set' when the mask is true and 'notSet' otherwise.
+        //----------------------------------------------------------------------------------------------------
+        static NES_INLINE Vec3x4 Select(const Vec3x4& notSet, const Vec3x4& set, const UVec4Reg& mask)  { return { Vec4Reg::Select(notSet.m_x, set.m_x, mask), Vec4Reg::Select(notSet.m_y, set.m_y, mask), Vec4Reg::Select(notSet.m_z, set.m_z, mask) }; }
+
+        static NES_INLINE Vec3x4 Zero()                                                 { return { Vec4Reg::Zero(), Vec4Reg::Zero(), Vec4Reg::Zero() }; }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Linear and angular velocity of 4 bodies, one per lane. The velocities are loaded from the
+    ///     MotionProperties before solving and the change is written back afterward, so they stay in
+    ///     registers while all constraint parts of the lanes are solved.
+    //----------------------------------------------------------------------------------------------------
+    struct BodyVelocity4
+    {
+        Vec3x4                  m_linearVelocity;
+        Vec3x4                  m_angularVelocity;
+        Vec3x4                  m_linearDOFs;           /// Bit mask of the allowed translation axes, see MotionProperties::GetLinearDOFsMask().
+        Vec3x4                  m_angularDOFs;          /// Bit mask of the allowed rotation axes, see MotionProperties::GetAngularDOFsMask().
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Load the velocities of 4 bodies. Lanes that are nullptr (static bodies or unused lanes)
+        ///     have zero velocity.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         Load(const MotionProperties* const (&pMotionProps)[4]);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Add the change in velocity since 'initial' to the bodies. Lanes that are nullptr are skipped,
+        ///     pass nullptr for all bodies that are not dynamic.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         StoreChange(const BodyVelocity4& initial, MotionProperties* const (&pMotionProps)[4]) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Zero the linear velocity along the axes that the bodies can't translate along, like
+        ///     MotionProperties::LockTranslation() does after each velocity step.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         LockTranslation();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Zero the angular velocity around the axes that the bodies can't rotate around, like
+        ///     MotionProperties::LockAngular() does.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         LockAngular();
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : 4 AxisConstraintParts that act on different bodies, solved at the same time with one SIMD
+    ///     lane per part. The parts are loaded as a structure of arrays with Load(), solved against
+    ///     BodyVelocity4, and the accumulated impulse is written back with StoreTotalLambda().
+    ///
+    /// The motion types of the bodies can differ per lane. Instead of the templated motion types of
+    /// AxisConstraintPart, the Jacobian of a static body and the inverse inertia of a body that is not dynamic
+    /// are zero for that lane, as is its inverse mass (which the caller should ensure). Inactive parts and
+    /// unused lanes have zero effective mass and apply no impulse.
+    /// @see : AxisConstraintPart for the equations.
+    //----------------------------------------------------------------------------------------------------
+    class AxisConstraintPart4
+    {
+    public:
+        AxisConstraintPart4() = default;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Load 4 constraint parts.
+        ///	@param pParts : The parts for each lane, nullptr for unused lanes.
+        ///	@param nonStatic1 : Lanes where body 1 is not static.
+        ///	@param dynamic1 : Lanes where body 1 is dynamic.
+        ///	@param nonStatic2 : Lanes where body 2 is not static.
+        ///	@param dynamic2 : Lanes where body 2 is dynamic.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         Load(const AxisConstraintPart* const (&pParts)[4], const UVec4Reg& nonStatic1, const UVec4Reg& dynamic1, const UVec4Reg& nonStatic2, const UVec4Reg& dynamic2);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write the accumulated impulse of each lane back to its part. Lanes that are nullptr are skipped.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         StoreTotalLambda(AxisConstraintPart* const (&pParts)[4]) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the lanes where the constraint part is active.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE UVec4Reg     IsActive() const                                        { return UVec4Reg::Not(Vec4Reg::Equals(m_effectiveMass, Vec4Reg::Zero())); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the accumulated impulse of each lane.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec4Reg      GetTotalLambda() const                                  { return m_totalLambda; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Apply the previous frame's impulses, see AxisConstraintPart::WarmStart().
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         WarmStart(BodyVelocity4& velocity1, const Vec4Reg& invMass1, BodyVelocity4& velocity2, const Vec4Reg& invMass2, const Vec3x4& worldSpaceAxis, const Vec4Reg& warmStartImpulseRatio);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Solve the velocity constraint, part 1: get the total lambda of each lane.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE Vec4Reg      SolveVelocityConstraintGetTotalLambda(const BodyVelocity4& velocity1, const BodyVelocity4& velocity2, const Vec3x4& worldSpaceAxis) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Solve the velocity constraint, part 2: apply the new total lambda of each lane. Returns the
+        ///     lanes where an impulse was applied.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE UVec4Reg     SolveVelocityConstraintApplyLambda(BodyVelocity4& velocity1, const Vec4Reg& invMass1, BodyVelocity4& velocity2, const Vec4Reg& invMass2, const Vec3x4& worldSpaceAxis, const Vec4Reg& totalLambda);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Solve the velocity constraint, clamping the total lambda of each lane to [minLambda, maxLambda].
+        ///     Returns the lanes where an impulse was applied.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE UVec4Reg     SolveVelocityConstraint(BodyVelocity4& velocity1, const Vec4Reg& invMass1, BodyVelocity4& velocity2, const Vec4Reg& invMass2, const Vec3x4& worldSpaceAxis, const Vec4Reg& minLambda, const Vec4Reg& maxLambda);
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Internal helper function to update the velocities after the Lagrange multipliers are calculated.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void         ApplyVelocityStep(BodyVelocity4& velocity1, const Vec4Reg& invMass1, BodyVelocity4& velocity2, const Vec4Reg& invMass2, const Vec3x4& worldSpaceAxis, const Vec4Reg& lambda) const;
+
+    private:
+        Vec3x4                  m_R1PlusUxAxis;
+        Vec3x4                  m_R2xAxis;
+        Vec3x4                  m_InvI1_R1PlusUxAxis;
+        Vec3x4                  m_InvI2_R2xAxis;
+        Vec4Reg                 m_effectiveMass;
+        Vec4Reg                 m_springBias;
+        Vec4Reg                 m_springSoftness;
+        Vec4Reg                 m_totalLambda;
+    };
+}
+
+#include "AxisConstraintPart4.inl"
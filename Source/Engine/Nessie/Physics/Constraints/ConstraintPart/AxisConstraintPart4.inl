@@ -0,0 +1,199 @@
+// AxisConstraintPart4.inl
+#pragma once
+
+namespace nes
+{
+    Vec3x4 Vec3x4::Transpose(const Vec4Reg& vec0, const Vec4Reg& vec1, const Vec4Reg& vec2, const Vec4Reg& vec3)
+    {
+        const Mat44 transposed = Mat44(vec0, vec1, vec2, vec3).Transposed();
+        return { transposed[0], transposed[1], transposed[2] };
+    }
+
+    void Vec3x4::TransposeTo(Vec4Reg& outVec0, Vec4Reg& outVec1, Vec4Reg& outVec2, Vec4Reg& outVec3) const
+    {
+        const Mat44 transposed = Mat44(m_x, m_y, m_z, Vec4Reg::Zero()).Transposed();
+        outVec0 = transposed[0];
+        outVec1 = transposed[1];
+        outVec2 = transposed[2];
+        outVec3 = transposed[3];
+    }
+
+    void BodyVelocity4::Load(const MotionProperties* const (&pMotionProps)[4])
+    {
+        Vec4Reg linearVelocity[4];
+        Vec4Reg angularVelocity[4];
+        Vec4Reg linearDOFs[4];
+        Vec4Reg angularDOFs[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            if (const MotionProperties* pProps = pMotionProps[i])
+            {
+                linearVelocity[i] = Vec4Reg::LoadVec3Unsafe(pProps->GetLinearVelocity());
+                angularVelocity[i] = Vec4Reg::LoadVec3Unsafe(pProps->GetAngularVelocity());
+                linearDOFs[i] = pProps->GetLinearDOFsMask().ReinterpretAsFloat();
+                angularDOFs[i] = pProps->GetAngularDOFsMask().ReinterpretAsFloat();
+            }
+            else
+            {
+                linearVelocity[i] = Vec4Reg::Zero();
+                angularVelocity[i] = Vec4Reg::Zero();
+                linearDOFs[i] = UVec4Reg::Replicate(0xffffffff).ReinterpretAsFloat();
+                angularDOFs[i] = linearDOFs[i];
+            }
+        }
+
+        m_linearVelocity = Vec3x4::Transpose(linearVelocity[0], linearVelocity[1], linearVelocity[2], linearVelocity[3]);
+        m_angularVelocity = Vec3x4::Transpose(angularVelocity[0], angularVelocity[1], angularVelocity[2], angularVelocity[3]);
+        m_linearDOFs = Vec3x4::Transpose(linearDOFs[0], linearDOFs[1], linearDOFs[2], linearDOFs[3]);
+        m_angularDOFs = Vec3x4::Transpose(angularDOFs[0], angularDOFs[1], angularDOFs[2], angularDOFs[3]);
+    }
+
+    void BodyVelocity4::StoreChange(const BodyVelocity4& initial, MotionProperties* const (&pMotionProps)[4]) const
+    {
+        Vec4Reg linearVelocityChange[4];
+        Vec4Reg angularVelocityChange[4];
+        (m_linearVelocity - initial.m_linearVelocity).TransposeTo(linearVelocityChange[0], linearVelocityChange[1], linearVelocityChange[2], linearVelocityChange[3]);
+        (m_angularVelocity - initial.m_angularVelocity).TransposeTo(angularVelocityChange[0], angularVelocityChange[1], angularVelocityChange[2], angularVelocityChange[3]);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            if (MotionProperties* pProps = pMotionProps[i])
+            {
+                pProps->Internal_AddLinearVelocityStep(linearVelocityChange[i].ToVec3());
+                pProps->Internal_AddAngularVelocityStep(angularVelocityChange[i].ToVec3());
+            }
+        }
+    }
+
+    void BodyVelocity4::LockTranslation()
+    {
+        m_linearVelocity.m_x = Vec4Reg::And(m_linearVelocity.m_x, m_linearDOFs.m_x);
+        m_linearVelocity.m_y = Vec4Reg::And(m_linearVelocity.m_y, m_linearDOFs.m_y);
+        m_linearVelocity.m_z = Vec4Reg::And(m_linearVelocity.m_z, m_linearDOFs.m_z);
+    }
+
+    void BodyVelocity4::LockAngular()
+    {
+        m_angularVelocity.m_x = Vec4Reg::And(m_angularVelocity.m_x, m_angularDOFs.m_x);
+        m_angularVelocity.m_y = Vec4Reg::And(m_angularVelocity.m_y, m_angularDOFs.m_y);
+        m_angularVelocity.m_z = Vec4Reg::And(m_angularVelocity.m_z, m_angularDOFs.m_z);
+    }
+
+    void AxisConstraintPart4::Load(const AxisConstraintPart* const (&pParts)[4], const UVec4Reg& nonStatic1, const UVec4Reg& dynamic1, const UVec4Reg& nonStatic2, const UVec4Reg& dynamic2)
+    {
+        Vec4Reg r1PlusUxAxis[4];
+        Vec4Reg r2xAxis[4];
+        Vec4Reg invI1_R1PlusUxAxis[4];
+        Vec4Reg invI2_R2xAxis[4];
+        float effectiveMass[4];
+        float springBias[4];
+        float springSoftness[4];
+        float totalLambda[4];
+
+        for (int i = 0; i < 4; ++i)
+        {
+            const AxisConstraintPart* pPart = pParts[i];
+
+            // The vectors of an inactive part are not always calculated, zero them so that they don't add NaNs.
+            if (pPart != nullptr && pPart->IsActive())
+            {
+                r1PlusUxAxis[i] = Vec4Reg::LoadFloat3Unsafe(pPart->m_R1PlusUxAxis);
+                r2xAxis[i] = Vec4Reg::LoadFloat3Unsafe(pPart->m_R2xAxis);
+                invI1_R1PlusUxAxis[i] = Vec4Reg::LoadFloat3Unsafe(pPart->m_InvI1_R1PlusUxAxis);
+                invI2_R2xAxis[i] = Vec4Reg::LoadFloat3Unsafe(pPart->m_InvI2_R2xAxis);
+                effectiveMass[i] = pPart->m_effectiveMass;
+                springBias[i] = pPart->m_springPart.m_bias;
+                springSoftness[i] = pPart->m_springPart.m_softness;
+            }
+            else
+            {
+                r1PlusUxAxis[i] = Vec4Reg::Zero();
+                r2xAxis[i] = Vec4Reg::Zero();
+                invI1_R1PlusUxAxis[i] = Vec4Reg::Zero();
+                invI2_R2xAxis[i] = Vec4Reg::Zero();
+                effectiveMass[i] = 0.f;
+                springBias[i] = 0.f;
+                springSoftness[i] = 0.f;
+            }
+
+            totalLambda[i] = pPart != nullptr? pPart->m_totalLambda : 0.f;
+        }
+
+        // The templated AxisConstraintPart doesn't calculate these for static and non-dynamic bodies, so they are
+        // undefined. Zero them so that they have no effect, like the motion types that are baked into the templates.
+        const Vec3x4 zero = Vec3x4::Zero();
+        m_R1PlusUxAxis = Vec3x4::Select(zero, Vec3x4::Transpose(r1PlusUxAxis[0], r1PlusUxAxis[1], r1PlusUxAxis[2], r1PlusUxAxis[3]), nonStatic1);
+        m_R2xAxis = Vec3x4::Select(zero, Vec3x4::Transpose(r2xAxis[0], r2xAxis[1], r2xAxis[2], r2xAxis[3]), nonStatic2);
+        m_InvI1_R1PlusUxAxis = Vec3x4::Select(zero, Vec3x4::Transpose(invI1_R1PlusUxAxis[0], invI1_R1PlusUxAxis[1], invI1_R1PlusUxAxis[2], invI1_R1PlusUxAxis[3]), dynamic1);
+        m_InvI2_R2xAxis = Vec3x4::Select(zero, Vec3x4::Transpose(invI2_R2xAxis[0], invI2_R2xAxis[1], invI2_R2xAxis[2], invI2_R2xAxis[3]), dynamic2);
+        m_effectiveMass = Vec4Reg(effectiveMass[0], effectiveMass[1], effectiveMass[2], effectiveMass[3]);
+        m_springBias = Vec4Reg(springBias[0], springBias[1], springBias[2], springBias[3]);
+        m_springSoftness = Vec4Reg(springSoftness[0], springSoftness[1], springSoftness[2], springSoftness[3]);
+        m_totalLambda = Vec4Reg(totalLambda[0], totalLambda[1], totalLambda[2], totalLambda[3]);
+    }
+
+    void AxisConstraintPart4::StoreTotalLambda(AxisConstraintPart* const (&pParts)[4]) const
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            if (pParts[i] != nullptr)
+                pParts[i]->m_totalLambda = m_totalLambda[i];
+        }
+    }
+
+    void AxisConstraintPart4::WarmStart(BodyVelocity4& velocity1, const Vec4Reg& invMass1, BodyVelocity4& velocity2, const Vec4Reg& invMass2, const Vec3x4& worldSpaceAxis, const Vec4Reg& warmStartImpulseRatio)
+    {
+        m_totalLambda *= warmStartImpulseRatio;
+        ApplyVelocityStep(velocity1, invMass1, velocity2, invMass2, worldSpaceAxis, m_totalLambda);
+    }
+
+    Vec4Reg AxisConstraintPart4::SolveVelocityConstraintGetTotalLambda(const BodyVelocity4& velocity1, const BodyVelocity4& velocity2, const Vec3x4& worldSpaceAxis) const
+    {
+        // Calculate jacobian multiplied by linear and angular velocity. The velocity of a static body is zero.
+        const Vec4Reg jv = worldSpaceAxis.Dot(velocity1.m_linearVelocity - velocity2.m_linearVelocity)
+            + m_R1PlusUxAxis.Dot(velocity1.m_angularVelocity)
+            - m_R2xAxis.Dot(velocity2.m_angularVelocity);
+
+        // Lagrange multiplier is:
+        //  Lambda = -K^-1 (J v + b)
+        const Vec4Reg lambda = m_effectiveMass * (jv - (m_springSoftness * m_totalLambda + m_springBias));
+
+        // Return the total accumulated lambda
+        return m_totalLambda + lambda;
+    }
+
+    UVec4Reg AxisConstraintPart4::SolveVelocityConstraintApplyLambda(BodyVelocity4& velocity1, const Vec4Reg& invMass1, BodyVelocity4& velocity2, const Vec4Reg& invMass2, const Vec3x4& worldSpaceAxis, const Vec4Reg& totalLambda)
+    {
+        const Vec4Reg deltaLambda = totalLambda - m_totalLambda; // Calculate change in lambda
+        m_totalLambda = totalLambda; // Store the accumulated impulse
+
+        ApplyVelocityStep(velocity1, invMass1, velocity2, invMass2, worldSpaceAxis, deltaLambda);
+        return UVec4Reg::Not(Vec4Reg::Equals(deltaLambda, Vec4Reg::Zero()));
+    }
+
+    UVec4Reg AxisConstraintPart4::SolveVelocityConstraint(BodyVelocity4& velocity1, const Vec4Reg& invMass1, BodyVelocity4& velocity2, const Vec4Reg& invMass2, const Vec3x4& worldSpaceAxis, const Vec4Reg& minLambda, const Vec4Reg& maxLambda)
+    {
+        Vec4Reg totalLambda = SolveVelocityConstraintGetTotalLambda(velocity1, velocity2, worldSpaceAxis);
+
+        // Clamp impulse to specified range
+        totalLambda = Vec4Reg::Min(Vec4Reg::Max(totalLambda, minLambda), maxLambda);
+
+        return SolveVelocityConstraintApplyLambda(velocity1, invMass1, velocity2, invMass2, worldSpaceAxis, totalLambda);
+    }
+
+    void AxisConstraintPart4::ApplyVelocityStep(BodyVelocity4& velocity1, const Vec4Reg& invMass1, BodyVelocity4& velocity2, const Vec4Reg& invMass2, const Vec3x4& worldSpaceAxis, const Vec4Reg& lambda) const
+    {
+        // Calculate velocity change due to constraint, see AxisConstraintPart::ApplyVelocityStep(). Lanes with a
+        // zero lambda or a body that is not dynamic (zero inverse mass and inertia) don't change. The locked axes
+        // are masked out on every step, so a body with restricted DOFs never picks up velocity along them.
+        velocity1.m_linearVelocity = velocity1.m_linearVelocity - worldSpaceAxis * (lambda * invMass1);
+        velocity1.m_angularVelocity = velocity1.m_angularVelocity - m_InvI1_R1PlusUxAxis * lambda;
+        velocity1.LockTranslation();
+        velocity1.LockAngular();
+
+        velocity2.m_linearVelocity = velocity2.m_linearVelocity + worldSpaceAxis * (lambda * invMass2);
+        velocity2.m_angularVelocity = velocity2.m_angularVelocity + m_InvI2_R2xAxis * lambda;
+        velocity2.LockTranslation();
+        velocity2.LockAngular();
+    }
+}
@@ -2,6 +2,7 @@
 #pragma once
 #include "Nessie/Math/Math.h"
 #include "Nessie/Physics/Body/Body.h"
+#include "Nessie/Physics/StateRecorder.h"
 
 namespace nes
 {
@@ -83,6 +84,16 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         inline const Vec2&  GetTotalLambda() const { return m_totalLambda; }
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the accumulated impulse, which is used for warm starting.
+        //----------------------------------------------------------------------------------------------------
+        inline void         SaveState(StateRecorder& stream) const  { stream.Write(m_totalLambda); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the accumulated impulse that was saved with SaveState().
+        //----------------------------------------------------------------------------------------------------
+        inline void         RestoreState(StateRecorder& stream)     { stream.Read(m_totalLambda); }
+
     private:
         //----------------------------------------------------------------------------------------------------
         /// @brief : Internal helper function to update velocities of bodies after Lagrange multiplier is calculated.
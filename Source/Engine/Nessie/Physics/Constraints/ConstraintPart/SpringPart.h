@@ -10,6 +10,8 @@ namespace nes
     //----------------------------------------------------------------------------------------------------
     class SpringPart
     {
+        friend class AxisConstraintPart4;
+
     public:
         //----------------------------------------------------------------------------------------------------
         /// @brief : Turn off the spring and set a bias only.
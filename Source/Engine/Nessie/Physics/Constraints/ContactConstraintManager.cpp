@@ -2,7 +2,10 @@
 #include "ContactConstraintManager.h"
 
 #include "Nessie/Physics/Constraints/CalculateSolverSteps.h"
+#include "Nessie/Physics/Constraints/ConstraintPart/AxisConstraintPart4.h"
 #include "Nessie/Physics/Body/Body.h"
+#include "Nessie/Physics/Body/BodyManager.h"
+#include "Nessie/Physics/Collision/CollideShape.h"
 #include "Nessie/Physics/PhysicsUpdateContext.h"
 #include "Nessie/Physics/PhysicsSettings.h"
 #include "Nessie/Physics/PhysicsScene.h"
@@ -143,12 +146,14 @@ namespace nes
 
         m_cachedManifolds.Init(math::GetNextPowerOf2(inMaxContactConstraints));
         m_cachedBodyPairs.Init(math::GetNextPowerOf2(maxBodyPairs));
+        m_cachedSensorPairs.Init(math::GetNextPowerOf2(maxBodyPairs));
     }
 
     void ContactConstraintManager::ManifoldCache::Clear()
     {
         m_cachedManifolds.Clear();
         m_cachedBodyPairs.Clear();
+        m_cachedSensorPairs.Clear();
         m_allocator.Clear();
 
     #ifdef NES_ASSERTS_ENABLED
@@ -166,6 +171,7 @@ namespace nes
         // use this frame.
         m_cachedManifolds.SetNumBuckets(math::Min(math::Max(kMinBuckets, math::GetNextPowerOf2(expectedNumManifolds)), m_cachedManifolds.GetMaxBuckets()));
         m_cachedBodyPairs.SetNumBuckets(math::Min(math::Max(kMinBuckets, math::GetNextPowerOf2(expectedNumBodyPairs)), m_cachedBodyPairs.GetMaxBuckets()));
+        m_cachedSensorPairs.SetNumBuckets(math::Min(math::Max(kMinBuckets, math::GetNextPowerOf2(expectedNumBodyPairs)), m_cachedSensorPairs.GetMaxBuckets()));
     }
 
     const ContactConstraintManager::MKeyValue* ContactConstraintManager::ManifoldCache::Find(const SubShapeIDPair& key, uint64 keyHash) const
@@ -230,6 +236,26 @@ namespace nes
         return pKeyValue;
     }
 
+    const ContactConstraintManager::SPKeyValue* ContactConstraintManager::ManifoldCache::FindSensorPair(const BodyPair& key, const uint64 keyHash) const
+    {
+        NES_ASSERT(m_isFinalized);
+        return m_cachedSensorPairs.Find(key, keyHash);
+    }
+
+    ContactConstraintManager::SPKeyValue* ContactConstraintManager::ManifoldCache::CreateSensorPair(ContactAllocator& contactAllocator, const BodyPair& key, uint64 keyHash)
+    {
+        NES_ASSERT(!m_isFinalized);
+        SPKeyValue* pKeyValue = m_cachedSensorPairs.Create(contactAllocator, key, keyHash, 0);
+        if (pKeyValue == nullptr)
+        {
+            contactAllocator.m_errors |= EPhysicsUpdateErrorCode::BodyPairCacheFull;
+            return nullptr;
+        }
+
+        ++contactAllocator.m_numBodyPairs;
+        return pKeyValue;
+    }
+
     void ContactConstraintManager::ManifoldCache::GetAllBodyPairsSorted(std::vector<const BPKeyValue*>& outAll) const
     {
         NES_ASSERT(m_isFinalized);
@@ -281,6 +307,18 @@ namespace nes
         });
     }
 
+    void ContactConstraintManager::ManifoldCache::GetAllSensorPairsSorted(std::vector<const SPKeyValue*>& outAll) const
+    {
+        NES_ASSERT(m_isFinalized);
+        m_cachedSensorPairs.GetAllKeyValuePairs(outAll);
+
+        // Sort by Key
+        QuickSort(outAll.begin(), outAll.end(), [](const SPKeyValue* pLeft, const SPKeyValue* pRight)
+        {
+            return pLeft->GetKey() < pRight->GetKey();
+        });
+    }
+
     void ContactConstraintManager::ManifoldCache::ContactPointRemovedCallbacks(ContactListener* pListener)
     {
         for (MKeyValue& keyValue : m_cachedManifolds)
@@ -290,6 +328,324 @@ namespace nes
                 pListener->OnContactRemoved(keyValue.GetKey());
             }
         }
+
+        for (SPKeyValue& keyValue : m_cachedSensorPairs)
+        {
+            const CachedSensorPair& sensorPair = keyValue.GetValue();
+            if ((sensorPair.m_flags & static_cast<uint16>(CachedSensorPair::EFlags::ContactPersisted)) == 0)
+            {
+                const BodyPair& key = keyValue.GetKey();
+                pListener->OnContactRemoved(SubShapeIDPair(key.m_bodyA, sensorPair.m_subShapeID1, key.m_bodyB, sensorPair.m_subShapeID2));
+            }
+        }
+    }
+
+    void ContactConstraintManager::ManifoldCache::CopyBodyPairsOfSkippedBodies(ContactAllocator& contactAllocator, const BodyManager& bodyManager, ManifoldCache& writeCache)
+    {
+        NES_ASSERT(m_isFinalized);
+
+        for (BPKeyValue& bodyPairKeyValue : m_cachedBodyPairs)
+        {
+            const BodyPair& bodyPairKey = bodyPairKeyValue.GetKey();
+            const Body* pBody1 = bodyManager.TryGetBody(bodyPairKey.m_bodyA);
+            const Body* pBody2 = bodyManager.TryGetBody(bodyPairKey.m_bodyB);
+            if (pBody1 == nullptr || pBody2 == nullptr || pBody1->Internal_IsInActiveBodies() || pBody2->Internal_IsInActiveBodies())
+                continue;
+
+            // Pairs between sleeping bodies are removed as usual.
+            const bool isSkipped1 = pBody1->GetMotionPropertiesUnchecked() != nullptr && pBody1->GetMotionPropertiesUnchecked()->Internal_IsSimulationSkipped();
+            const bool isSkipped2 = pBody2->GetMotionPropertiesUnchecked() != nullptr && pBody2->GetMotionPropertiesUnchecked()->Internal_IsSimulationSkipped();
+            if (!isSkipped1 && !isSkipped2)
+                continue;
+
+            // A body that skipped the update can be activated by a collision, in which case the pair was already found again.
+            const uint64 bodyPairHash = bodyPairKey.GetHash();
+            if (writeCache.m_cachedBodyPairs.Find(bodyPairKey, bodyPairHash) != nullptr)
+                continue;
+
+            const CachedBodyPair& inputCBP = bodyPairKeyValue.GetValue();
+            BPKeyValue* pOutputBPKeyValue = writeCache.Create(contactAllocator, bodyPairKey, bodyPairHash);
+            if (pOutputBPKeyValue == nullptr)
+                return; // Out of cache space
+            CachedBodyPair& outputCBP = pOutputBPKeyValue->GetValue();
+            memcpy(&outputCBP, &inputCBP, sizeof(CachedBodyPair));
+            outputCBP.m_firstCachedManifold = ManifoldMap::kInvalidHandle;
+
+            // Copy the manifolds and link them to the body pair.
+            for (uint32 handle = inputCBP.m_firstCachedManifold; handle != ManifoldMap::kInvalidHandle; handle = FromHandle(handle)->GetValue().m_nextWithSameBodyPair)
+            {
+                const MKeyValue* pInputKV = FromHandle(handle);
+                const SubShapeIDPair& inputKey = pInputKV->GetKey();
+                const CachedManifold& inputCM = pInputKV->GetValue();
+
+                // Skip manifolds that were reported by continuous collision detection in this update.
+                const uint64 inputHash = inputKey.GetHash();
+                if (writeCache.m_cachedManifolds.Find(inputKey, inputHash) != nullptr)
+                    continue;
+
+                MKeyValue* pOutputKV = writeCache.Create(contactAllocator, inputKey, inputHash, inputCM.m_numContactPoints);
+                if (pOutputKV == nullptr)
+                    return; // Out of cache space
+                CachedManifold& outputCM = pOutputKV->GetValue();
+                memcpy(&outputCM, &inputCM, CachedManifold::GetRequiredTotalSize(inputCM.m_numContactPoints));
+                outputCM.m_flags = 0;
+
+                outputCM.m_nextWithSameBodyPair = outputCBP.m_firstCachedManifold;
+                outputCBP.m_firstCachedManifold = writeCache.ToHandle(pOutputKV);
+
+                // Don't report the contact as removed.
+                inputCM.m_flags.fetch_or(static_cast<uint16>(CachedManifold::EFlags::ContactPersisted), std::memory_order_relaxed);
+            }
+        }
+
+        for (SPKeyValue& sensorPairKeyValue : m_cachedSensorPairs)
+        {
+            const BodyPair& bodyPairKey = sensorPairKeyValue.GetKey();
+            const Body* pBody1 = bodyManager.TryGetBody(bodyPairKey.m_bodyA);
+            const Body* pBody2 = bodyManager.TryGetBody(bodyPairKey.m_bodyB);
+            if (pBody1 == nullptr || pBody2 == nullptr || pBody1->Internal_IsInActiveBodies() || pBody2->Internal_IsInActiveBodies())
+                continue;
+
+            const bool isSkipped1 = pBody1->GetMotionPropertiesUnchecked() != nullptr && pBody1->GetMotionPropertiesUnchecked()->Internal_IsSimulationSkipped();
+            const bool isSkipped2 = pBody2->GetMotionPropertiesUnchecked() != nullptr && pBody2->GetMotionPropertiesUnchecked()->Internal_IsSimulationSkipped();
+            if (!isSkipped1 && !isSkipped2)
+                continue;
+
+            const uint64 bodyPairHash = bodyPairKey.GetHash();
+            if (writeCache.m_cachedSensorPairs.Find(bodyPairKey, bodyPairHash) != nullptr)
+                continue;
+
+            const CachedSensorPair& inputSP = sensorPairKeyValue.GetValue();
+            SPKeyValue* pOutputSPKeyValue = writeCache.CreateSensorPair(contactAllocator, bodyPairKey, bodyPairHash);
+            if (pOutputSPKeyValue == nullptr)
+                return; // Out of cache space
+            CachedSensorPair& outputSP = pOutputSPKeyValue->GetValue();
+            outputSP.m_subShapeID1 = inputSP.m_subShapeID1;
+            outputSP.m_subShapeID2 = inputSP.m_subShapeID2;
+
+            // Don't report the contact as removed.
+            inputSP.m_flags.fetch_or(static_cast<uint16>(CachedSensorPair::EFlags::ContactPersisted), std::memory_order_relaxed);
+        }
+    }
+
+    void ContactConstraintManager::ManifoldCache::SaveState(StateRecorder& stream, const StateRecorderFilter* pFilter) const
+    {
+        NES_ASSERT(m_isFinalized);
+
+        // Get all body pairs, sorted so that the stream is deterministic.
+        std::vector<const BPKeyValue*>& allBodyPairs = m_saveBodyPairs;
+        allBodyPairs.clear();
+        GetAllBodyPairsSorted(allBodyPairs);
+
+        if (pFilter != nullptr)
+        {
+            std::erase_if(allBodyPairs, [pFilter](const BPKeyValue* pKeyValue)
+            {
+                return !pFilter->ShouldSaveContact(pKeyValue->GetKey().m_bodyA, pKeyValue->GetKey().m_bodyB);
+            });
+        }
+
+        stream.Write(static_cast<uint32>(allBodyPairs.size()));
+
+        std::vector<const MKeyValue*>& allManifolds = m_saveManifolds;
+        for (const BPKeyValue* pBodyPairKeyValue : allBodyPairs)
+        {
+            const CachedBodyPair& bodyPair = pBodyPairKeyValue->GetValue();
+            stream.Write(pBodyPairKeyValue->GetKey());
+            stream.Write(bodyPair.m_deltaPosition);
+            stream.Write(bodyPair.m_deltaRotation);
+
+            allManifolds.clear();
+            GetAllManifoldsSorted(bodyPair, allManifolds);
+            stream.Write(static_cast<uint32>(allManifolds.size()));
+
+            for (const MKeyValue* pManifoldKeyValue : allManifolds)
+            {
+                const CachedManifold& manifold = pManifoldKeyValue->GetValue();
+                stream.Write(pManifoldKeyValue->GetKey());
+                stream.Write(manifold.m_numContactPoints);
+                stream.Write(manifold.m_contactNormal);
+                stream.WriteBytes(manifold.m_contactPoints, manifold.m_numContactPoints * sizeof(CachedContactPoint));
+            }
+        }
+
+        // CCD manifolds only store the key, they are used to prevent duplicate contact added callbacks.
+        allManifolds.clear();
+        GetAllCCDManifoldsSorted(allManifolds);
+
+        if (pFilter != nullptr)
+        {
+            std::erase_if(allManifolds, [pFilter](const MKeyValue* pKeyValue)
+            {
+                return !pFilter->ShouldSaveContact(pKeyValue->GetKey().GetBody1ID(), pKeyValue->GetKey().GetBody2ID());
+            });
+        }
+
+        stream.Write(static_cast<uint32>(allManifolds.size()));
+        for (const MKeyValue* pManifoldKeyValue : allManifolds)
+            stream.Write(pManifoldKeyValue->GetKey());
+
+        // Sensor pairs only store the key and the sub shapes, they are used to report persisted and removed contacts.
+        std::vector<const SPKeyValue*>& allSensorPairs = m_saveSensorPairs;
+        allSensorPairs.clear();
+        GetAllSensorPairsSorted(allSensorPairs);
+
+        if (pFilter != nullptr)
+        {
+            std::erase_if(allSensorPairs, [pFilter](const SPKeyValue* pKeyValue)
+            {
+                return !pFilter->ShouldSaveContact(pKeyValue->GetKey().m_bodyA, pKeyValue->GetKey().m_bodyB);
+            });
+        }
+
+        stream.Write(static_cast<uint32>(allSensorPairs.size()));
+        for (const SPKeyValue* pSensorPairKeyValue : allSensorPairs)
+        {
+            const CachedSensorPair& sensorPair = pSensorPairKeyValue->GetValue();
+            stream.Write(pSensorPairKeyValue->GetKey());
+            stream.Write(sensorPair.m_subShapeID1);
+            stream.Write(sensorPair.m_subShapeID2);
+        }
+    }
+
+    bool ContactConstraintManager::ManifoldCache::RestoreState(ContactAllocator& contactAllocator, StateRecorder& stream, const StateRecorderFilter* pFilter)
+    {
+        NES_ASSERT(!m_isFinalized);
+
+        bool success = true;
+
+        uint32 numBodyPairs = 0;
+        stream.Read(numBodyPairs);
+
+        for (uint32 i = 0; success && i < numBodyPairs && !stream.IsFailed(); ++i)
+        {
+            BodyPair bodyPairKey;
+            stream.Read(bodyPairKey);
+
+            CachedBodyPair bodyPair;
+            stream.Read(bodyPair.m_deltaPosition);
+            stream.Read(bodyPair.m_deltaRotation);
+            bodyPair.m_firstCachedManifold = ManifoldMap::kInvalidHandle;
+
+            // Contacts that are not restored still need to be read from the stream.
+            const bool restore = pFilter == nullptr || pFilter->ShouldRestoreContact(bodyPairKey.m_bodyA, bodyPairKey.m_bodyB);
+
+            BPKeyValue* pBodyPairKeyValue = nullptr;
+            if (restore)
+            {
+                pBodyPairKeyValue = Create(contactAllocator, bodyPairKey, bodyPairKey.GetHash());
+                if (pBodyPairKeyValue == nullptr)
+                {
+                    success = false;
+                    break;
+                }
+            }
+
+            uint32 numManifolds = 0;
+            stream.Read(numManifolds);
+
+            for (uint32 j = 0; j < numManifolds && !stream.IsFailed(); ++j)
+            {
+                SubShapeIDPair manifoldKey;
+                stream.Read(manifoldKey);
+
+                uint16 numContactPoints = 0;
+                stream.Read(numContactPoints);
+                if (numContactPoints > kMaxContactPoints)
+                {
+                    success = false;
+                    break;
+                }
+
+                Float3 contactNormal;
+                stream.Read(contactNormal);
+
+                if (restore)
+                {
+                    MKeyValue* pManifoldKeyValue = Create(contactAllocator, manifoldKey, manifoldKey.GetHash(), numContactPoints);
+                    if (pManifoldKeyValue == nullptr)
+                    {
+                        success = false;
+                        break;
+                    }
+
+                    CachedManifold& manifold = pManifoldKeyValue->GetValue();
+                    manifold.m_contactNormal = contactNormal;
+                    stream.ReadBytes(manifold.m_contactPoints, numContactPoints * sizeof(CachedContactPoint));
+
+                    // Link the manifold to the body pair.
+                    manifold.m_nextWithSameBodyPair = bodyPair.m_firstCachedManifold;
+                    bodyPair.m_firstCachedManifold = ToHandle(pManifoldKeyValue);
+                }
+                else
+                {
+                    CachedContactPoint contactPoints[kMaxContactPoints];
+                    stream.ReadBytes(contactPoints, numContactPoints * sizeof(CachedContactPoint));
+                }
+            }
+
+            if (pBodyPairKeyValue != nullptr)
+                pBodyPairKeyValue->GetValue() = bodyPair;
+        }
+
+        // CCD manifolds.
+        uint32 numCCDManifolds = 0;
+        if (success)
+            stream.Read(numCCDManifolds);
+
+        for (uint32 i = 0; success && i < numCCDManifolds && !stream.IsFailed(); ++i)
+        {
+            SubShapeIDPair manifoldKey;
+            stream.Read(manifoldKey);
+
+            if (pFilter != nullptr && !pFilter->ShouldRestoreContact(manifoldKey.GetBody1ID(), manifoldKey.GetBody2ID()))
+                continue;
+
+            MKeyValue* pManifoldKeyValue = Create(contactAllocator, manifoldKey, manifoldKey.GetHash(), 0);
+            if (pManifoldKeyValue == nullptr)
+            {
+                success = false;
+                break;
+            }
+
+            pManifoldKeyValue->GetValue().m_flags |= static_cast<uint16>(CachedManifold::EFlags::CCDContact);
+        }
+
+        // Sensor pairs.
+        uint32 numSensorPairs = 0;
+        if (success)
+            stream.Read(numSensorPairs);
+
+        for (uint32 i = 0; success && i < numSensorPairs && !stream.IsFailed(); ++i)
+        {
+            BodyPair bodyPairKey;
+            stream.Read(bodyPairKey);
+
+            SubShapeID subShapeID1;
+            SubShapeID subShapeID2;
+            stream.Read(subShapeID1);
+            stream.Read(subShapeID2);
+
+            if (pFilter != nullptr && !pFilter->ShouldRestoreContact(bodyPairKey.m_bodyA, bodyPairKey.m_bodyB))
+                continue;
+
+            SPKeyValue* pSensorPairKeyValue = CreateSensorPair(contactAllocator, bodyPairKey, bodyPairKey.GetHash());
+            if (pSensorPairKeyValue == nullptr)
+            {
+                success = false;
+                break;
+            }
+
+            CachedSensorPair& sensorPair = pSensorPairKeyValue->GetValue();
+            sensorPair.m_subShapeID1 = subShapeID1;
+            sensorPair.m_subShapeID2 = subShapeID2;
+        }
+
+    #ifdef NES_ASSERTS_ENABLED
+        Finalize();
+    #endif
+
+        return success && !stream.IsFailed();
     }
 
     #ifdef NES_ASSERTS_ENABLED
@@ -346,7 +702,7 @@ namespace nes
     }
 
     template <EBodyMotionType Type1, EBodyMotionType Type2>
-    NES_INLINE void ContactConstraintManager::TemplatedCalculateFrictionAndNonPenetrationConstraintProperties(ContactConstraint& constraint, const ContactSettings& settings, float deltaTime, const Vec3 gravityDeltaTime, const Mat44& transformBody1, const Mat44& transformBody2, const Body& body1, const Body& body2)
+    NES_INLINE void ContactConstraintManager::TemplatedCalculateFrictionAndNonPenetrationConstraintProperties(ContactConstraint& constraint, const ContactSettings& settings, float deltaTime, const Vec3 gravityDeltaTime, const RMat44& transformBody1, const RMat44& transformBody2, const Body& body1, const Body& body2)
     {
         // Calculate scaled mass and inertia
         Mat44 invI1;
@@ -390,7 +746,7 @@ namespace nes
         }
     }
 
-    inline void ContactConstraintManager::CalculateFrictionAndNonPenetrationConstraintProperties(ContactConstraint& constraint, const ContactSettings& settings, float deltaTime, const Vec3 gravityDeltaTime, const Mat44& transformBody1, const Mat44& transformBody2, const Body& body1, const Body& body2)
+    inline void ContactConstraintManager::CalculateFrictionAndNonPenetrationConstraintProperties(ContactConstraint& constraint, const ContactSettings& settings, float deltaTime, const Vec3 gravityDeltaTime, const RMat44& transformBody1, const RMat44& transformBody2, const Body& body1, const Body& body2)
     {
         // Dispatch to the correct templated form:
         switch (body1.GetMotionType())
@@ -517,8 +873,8 @@ namespace nes
             return;
 
         // Get the body transforms
-        Mat44 transformBody1 = pBody1->GetCenterOfMassTransform();
-        Mat44 transformBody2 = pBody2->GetCenterOfMassTransform();
+        RMat44 transformBody1 = pBody1->GetCenterOfMassTransform();
+        RMat44 transformBody2 = pBody2->GetCenterOfMassTransform();
 
         // Get the time step
         const float deltaTime = m_pUpdateContext->m_stepDeltaTime;
@@ -569,7 +925,7 @@ namespace nes
                 manifold.m_baseOffset = transformBody1.GetTranslation();
                 manifold.m_relativeContactPointsOn1.resize(pOutputCM->m_numContactPoints);
                 manifold.m_relativeContactPointsOn2.resize(pOutputCM->m_numContactPoints);
-                Mat44 localTransformBody2 = transformBody2.PostTranslated(-manifold.m_baseOffset);
+                Mat44 localTransformBody2 = transformBody2.PostTranslated(-manifold.m_baseOffset).ToMat44();
                 float penetrationDepth = -FLT_MAX;
                 for (uint32 i = 0; i < pOutputCM->m_numContactPoints; ++i)
                 {
@@ -704,7 +1060,7 @@ namespace nes
         CachedManifold* pNewManifold = &pNewManifoldKeyValue->GetValue();
 
         // Transform the world space normal to the space of body 2 (this is usually the static body).
-        const Mat44 invTransformBody2 = body2.GetInverseCenterOfMassTransform();
+        const RMat44 invTransformBody2 = body2.GetInverseCenterOfMassTransform();
         invTransformBody2.Multiply3x3(manifold.m_worldSpaceNormal).Normalized().StoreFloat3(&pNewManifold->m_contactNormal);
 
         // Settings object that gets passed to the callback.
@@ -743,7 +1099,7 @@ namespace nes
         }
 
         // Get the inverse transform for body 1
-        Mat44 invTransformBody1 = body1.GetInverseCenterOfMassTransform();
+        RMat44 invTransformBody1 = body1.GetInverseCenterOfMassTransform();
 
         bool contactConstraintCreated = false;
         
@@ -911,14 +1267,14 @@ namespace nes
         {
             pBody1 = &body1;
             pBody2 = &body2;
-            temp = manifold.SwapShapes();
-            pManifold = &temp;
+            pManifold = &manifold;
         }
         else
         {
             pBody1 = &body2;
             pBody2 = &body1;
-            pManifold = &manifold;
+            temp = manifold.SwapShapes();
+            pManifold = &temp;
         }
 
         // Dispatch to the correct templated form
@@ -999,6 +1355,77 @@ namespace nes
         return false;
     }
 
+    void ContactConstraintManager::AddSensorContact(ContactAllocator& contactAllocator, const Body& body1, const Body& body2, const RVec3 baseOffset, const CollideShapeResult& collisionResult)
+    {
+        NES_ASSERT(body1.IsSensor() || body2.IsSensor());
+
+        // Swap bodies so that body 1 id < body 2 id.
+        const Body* pBody1;
+        const Body* pBody2;
+        CollideShapeResult result;
+        if (body1.GetID() < body2.GetID())
+        {
+            pBody1 = &body1;
+            pBody2 = &body2;
+            result = collisionResult;
+        }
+        else
+        {
+            pBody1 = &body2;
+            pBody2 = &body1;
+            result = collisionResult.Reversed();
+        }
+
+        // Add an entry for the pair.
+        const BodyPair key(pBody1->GetID(), pBody2->GetID());
+        const uint64 keyHash = key.GetHash();
+        SPKeyValue* pNewSensorPairKeyValue = m_cache[m_cacheWriteIndex].CreateSensorPair(contactAllocator, key, keyHash);
+        if (pNewSensorPairKeyValue == nullptr)
+            return; // Out of cache space.
+        CachedSensorPair& newSensorPair = pNewSensorPairKeyValue->GetValue();
+
+        // Keep the sub shapes of the first overlap for as long as the bodies overlap.
+        const ManifoldCache& readCache = m_cache[m_cacheWriteIndex ^ 1];
+        const SPKeyValue* pOldSensorPairKeyValue = readCache.FindSensorPair(key, keyHash);
+        if (pOldSensorPairKeyValue != nullptr)
+        {
+            const CachedSensorPair& oldSensorPair = pOldSensorPairKeyValue->GetValue();
+            newSensorPair.m_subShapeID1 = oldSensorPair.m_subShapeID1;
+            newSensorPair.m_subShapeID2 = oldSensorPair.m_subShapeID2;
+            oldSensorPair.m_flags.fetch_or(static_cast<uint16>(CachedSensorPair::EFlags::ContactPersisted), std::memory_order_relaxed);
+        }
+        else
+        {
+            newSensorPair.m_subShapeID1 = result.m_subShapeID1;
+            newSensorPair.m_subShapeID2 = result.m_subShapeID2;
+        }
+
+        if (m_pContactListener == nullptr)
+            return;
+
+        // Describe the overlap with a single contact point.
+        ContactManifold manifold;
+        manifold.m_baseOffset = baseOffset;
+        manifold.m_worldSpaceNormal = result.m_penetrationAxis.NormalizedOr(Vec3::AxisY());
+        manifold.m_penetrationDepth = result.m_penetrationDepth;
+        manifold.m_subShapeID1 = newSensorPair.m_subShapeID1;
+        manifold.m_subShapeID2 = newSensorPair.m_subShapeID2;
+        manifold.m_relativeContactPointsOn1.push_back(result.m_contactPointOn1);
+        manifold.m_relativeContactPointsOn2.push_back(result.m_contactPointOn2);
+
+        ContactSettings settings;
+        settings.m_combinedFriction = m_combineFriction(*pBody1, manifold.m_subShapeID1, *pBody2, manifold.m_subShapeID2);
+        settings.m_combinedRestitution = m_combineRestitution(*pBody1, manifold.m_subShapeID1, *pBody2, manifold.m_subShapeID2);
+        settings.m_isSensor = true;
+
+        if (pOldSensorPairKeyValue != nullptr)
+            m_pContactListener->OnContactPersisted(*pBody1, *pBody2, manifold, settings);
+        else
+            m_pContactListener->OnContactAdded(*pBody1, *pBody2, manifold, settings);
+
+        NES_ASSERT(settings.m_isSensor, "Sensors cannot be converted into regular bodies by a contact callback!");
+    }
+
     void ContactConstraintManager::OnCCDContactAdded(ContactAllocator& contactAllocator, const Body& body1, const Body& body2, const ContactManifold& manifold, ContactSettings& outSettings)
     {
         NES_ASSERT(manifold.m_worldSpaceNormal.IsNormalized());
@@ -1020,14 +1447,14 @@ namespace nes
             {
                 pBody1 = &body1;
                 pBody2 = &body2;
-                temp = manifold.SwapShapes();
-                pManifold = &temp;
+                pManifold = &manifold;
             }
             else
             {
                 pBody1 = &body2;
                 pBody2 = &body1;
-                pManifold = &manifold;
+                temp = manifold.SwapShapes();
+                pManifold = &temp;
             }
 
             // Calculate hash
@@ -1138,6 +1565,13 @@ namespace nes
         oldReadCache.Prepare(expectedNumBodyPairs, expectedNumManifolds);
     }
 
+    void ContactConstraintManager::KeepContactsOfSkippedBodies(ContactAllocator& contactAllocator, const BodyManager& bodyManager)
+    {
+        ManifoldCache& readCache = m_cache[m_cacheWriteIndex ^ 1];
+        ManifoldCache& writeCache = m_cache[m_cacheWriteIndex];
+        readCache.CopyBodyPairsOfSkippedBodies(contactAllocator, bodyManager, writeCache);
+    }
+
     bool ContactConstraintManager::WereBodiesInContact(const BodyID& bodyID1, const BodyID& bodyID2) const
     {
         // The body pair needs to be in the cache, and it needs to have a manifold (otherwise it's just a record indicating that there are no collisions).
@@ -1150,7 +1584,35 @@ namespace nes
 
         const uint64 keyHash = key.GetHash();
         const BPKeyValue* pKeyValue = readCache.Find(key, keyHash);
-        return pKeyValue != nullptr && pKeyValue->GetValue().m_firstCachedManifold != ManifoldMap::kInvalidHandle;
+        if (pKeyValue != nullptr && pKeyValue->GetValue().m_firstCachedManifold != ManifoldMap::kInvalidHandle)
+            return true;
+
+        // Sensor pairs are only stored while the bodies overlap.
+        return readCache.FindSensorPair(key, keyHash) != nullptr;
+    }
+
+    void ContactConstraintManager::SaveState(StateRecorder& stream, const StateRecorderFilter* pFilter) const
+    {
+        m_cache[m_cacheWriteIndex ^ 1].SaveState(stream, pFilter);
+    }
+
+    bool ContactConstraintManager::RestoreState(StateRecorder& stream, const StateRecorderFilter* pFilter)
+    {
+        // Restore into the write cache, and then make it the read cache as if a simulation step created it.
+        ManifoldCache& writeCache = m_cache[m_cacheWriteIndex];
+        writeCache.Clear();
+        ContactAllocator contactAllocator = writeCache.GetContactAllocator();
+        const bool success = writeCache.RestoreState(contactAllocator, stream, pFilter);
+
+        // Swap the read and write caches.
+        m_cacheWriteIndex ^= 1;
+
+        // Prepare the new write cache for the next simulation step.
+        ManifoldCache& newWriteCache = m_cache[m_cacheWriteIndex];
+        newWriteCache.Clear();
+        newWriteCache.Prepare(contactAllocator.m_numBodyPairs, contactAllocator.m_numManifolds);
+
+        return success;
     }
 
     template <EBodyMotionType Type1, EBodyMotionType Type2>
@@ -1321,6 +1783,7 @@ namespace nes
                             break;
                         }
                     }
+                    break;
                 }
 
                 case EBodyMotionType::Kinematic:
@@ -1347,6 +1810,258 @@ namespace nes
         return anyImpulseApplied;
     }
 
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Up to 4 independent contact constraints, one per SIMD lane. Holds everything that is shared
+    ///     by the contact points of a constraint, the constraint parts are loaded per contact point.
+    //----------------------------------------------------------------------------------------------------
+    struct ContactConstraintManager::ContactConstraint4
+    {
+        /// Pointer to a constraint part of a WorldContactPoint.
+        using PartMember = AxisConstraintPart WorldContactPoint::*;
+
+        ContactConstraint*              m_pConstraints[4];          /// Constraint of each lane, nullptr for unused lanes.
+        MotionProperties*               m_pDynamic1[4];             /// Motion properties of body 1 when it is dynamic, nullptr otherwise.
+        MotionProperties*               m_pDynamic2[4];             /// Motion properties of body 2 when it is dynamic, nullptr otherwise.
+        UVec4Reg                        m_nonStatic1;
+        UVec4Reg                        m_dynamic1;
+        UVec4Reg                        m_nonStatic2;
+        UVec4Reg                        m_dynamic2;
+        Vec4Reg                         m_inverseMass1;             /// Zero for bodies that are not dynamic.
+        Vec4Reg                         m_inverseMass2;             /// Zero for bodies that are not dynamic.
+        Vec4Reg                         m_combinedFriction;
+        Vec3x4                          m_worldSpaceNormal;
+        Vec3x4                          m_tangent1;
+        Vec3x4                          m_tangent2;
+        BodyVelocity4                   m_velocity1;                /// Velocities of the bodies before solving.
+        BodyVelocity4                   m_velocity2;
+        uint                            m_maxNumContactPoints;      /// Largest number of contact points of the lanes.
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Load 'numLanes' (at most 4) constraints.
+        //----------------------------------------------------------------------------------------------------
+        void                            Load(ContactConstraint* pConstraints, const uint32* pConstraintIndices, const uint numLanes)
+        {
+            NES_ASSERT(numLanes > 0 && numLanes <= 4);
+
+            const MotionProperties* pNonStatic1[4];
+            const MotionProperties* pNonStatic2[4];
+            uint32 nonStatic1[4], dynamic1[4], nonStatic2[4], dynamic2[4];
+            float inverseMass1[4], inverseMass2[4], combinedFriction[4];
+            Vec4Reg normal[4], tangent1[4], tangent2[4];
+            m_maxNumContactPoints = 0;
+
+            for (uint i = 0; i < 4; ++i)
+            {
+                if (i < numLanes)
+                {
+                    ContactConstraint& constraint = pConstraints[pConstraintIndices[i]];
+                    m_pConstraints[i] = &constraint;
+
+                    // Fetch the bodies. Static bodies have no velocity, kinematic bodies have a velocity but it
+                    // is not changed by the constraint.
+                    Body& body1 = *constraint.m_pBody1;
+                    const EBodyMotionType motionType1 = body1.GetMotionType();
+                    MotionProperties* pMotionProps1 = body1.GetMotionPropertiesUnchecked();
+                    pNonStatic1[i] = motionType1 != EBodyMotionType::Static? pMotionProps1 : nullptr;
+                    m_pDynamic1[i] = motionType1 == EBodyMotionType::Dynamic? pMotionProps1 : nullptr;
+                    nonStatic1[i] = pNonStatic1[i] != nullptr? 0xffffffff : 0;
+                    dynamic1[i] = m_pDynamic1[i] != nullptr? 0xffffffff : 0;
+                    inverseMass1[i] = m_pDynamic1[i] != nullptr? constraint.m_inverseMass1 : 0.f;
+
+                    Body& body2 = *constraint.m_pBody2;
+                    const EBodyMotionType motionType2 = body2.GetMotionType();
+                    MotionProperties* pMotionProps2 = body2.GetMotionPropertiesUnchecked();
+                    pNonStatic2[i] = motionType2 != EBodyMotionType::Static? pMotionProps2 : nullptr;
+                    m_pDynamic2[i] = motionType2 == EBodyMotionType::Dynamic? pMotionProps2 : nullptr;
+                    nonStatic2[i] = pNonStatic2[i] != nullptr? 0xffffffff : 0;
+                    dynamic2[i] = m_pDynamic2[i] != nullptr? 0xffffffff : 0;
+                    inverseMass2[i] = m_pDynamic2[i] != nullptr? constraint.m_inverseMass2 : 0.f;
+
+                    NES_ASSERT(m_pDynamic1[i] != nullptr || m_pDynamic2[i] != nullptr);
+
+                    Vec3 t1, t2;
+                    constraint.GetTangents(t1, t2);
+                    normal[i] = Vec4Reg::LoadFloat3Unsafe(constraint.m_worldSpaceNormal);
+                    tangent1[i] = Vec4Reg(t1);
+                    tangent2[i] = Vec4Reg(t2);
+                    combinedFriction[i] = constraint.m_combinedFriction;
+
+                    m_maxNumContactPoints = math::Max(m_maxNumContactPoints, static_cast<uint>(constraint.m_contactPoints.size()));
+                }
+                else
+                {
+                    m_pConstraints[i] = nullptr;
+                    pNonStatic1[i] = pNonStatic2[i] = nullptr;
+                    m_pDynamic1[i] = m_pDynamic2[i] = nullptr;
+                    nonStatic1[i] = dynamic1[i] = nonStatic2[i] = dynamic2[i] = 0;
+                    inverseMass1[i] = inverseMass2[i] = combinedFriction[i] = 0.f;
+                    normal[i] = tangent1[i] = tangent2[i] = Vec4Reg::Zero();
+                }
+            }
+
+        #ifdef NES_ASSERTS_ENABLED
+            // The lanes write the velocities of their dynamic bodies, so they can't share one.
+            for (uint i = 0; i < numLanes; ++i)
+            {
+                for (uint j = 0; j < numLanes; ++j)
+                {
+                    NES_ASSERT(m_pDynamic1[i] == nullptr || (m_pDynamic1[i] != m_pDynamic2[j] && (i == j || m_pDynamic1[i] != m_pDynamic1[j])));
+                    NES_ASSERT(m_pDynamic2[i] == nullptr || i == j || m_pDynamic2[i] != m_pDynamic2[j]);
+                }
+            }
+        #endif
+
+            m_nonStatic1 = UVec4Reg(nonStatic1[0], nonStatic1[1], nonStatic1[2], nonStatic1[3]);
+            m_dynamic1 = UVec4Reg(dynamic1[0], dynamic1[1], dynamic1[2], dynamic1[3]);
+            m_nonStatic2 = UVec4Reg(nonStatic2[0], nonStatic2[1], nonStatic2[2], nonStatic2[3]);
+            m_dynamic2 = UVec4Reg(dynamic2[0], dynamic2[1], dynamic2[2], dynamic2[3]);
+            m_inverseMass1 = Vec4Reg(inverseMass1[0], inverseMass1[1], inverseMass1[2], inverseMass1[3]);
+            m_inverseMass2 = Vec4Reg(inverseMass2[0], inverseMass2[1], inverseMass2[2], inverseMass2[3]);
+            m_combinedFriction = Vec4Reg(combinedFriction[0], combinedFriction[1], combinedFriction[2], combinedFriction[3]);
+            m_worldSpaceNormal = Vec3x4::Transpose(normal[0], normal[1], normal[2], normal[3]);
+            m_tangent1 = Vec3x4::Transpose(tangent1[0], tangent1[1], tangent1[2], tangent1[3]);
+            m_tangent2 = Vec3x4::Transpose(tangent2[0], tangent2[1], tangent2[2], tangent2[3]);
+            m_velocity1.Load(pNonStatic1);
+            m_velocity2.Load(pNonStatic2);
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get a constraint part of the contact point at 'pointIndex' of each lane, nullptr for lanes
+        ///     that have fewer contact points.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void                 GetParts(const uint pointIndex, const PartMember part, AxisConstraintPart* (&outParts)[4]) const
+        {
+            for (uint i = 0; i < 4; ++i)
+            {
+                ContactConstraint* pConstraint = m_pConstraints[i];
+                outParts[i] = pConstraint != nullptr && pointIndex < pConstraint->m_contactPoints.size()? &(pConstraint->m_contactPoints[pointIndex].*part) : nullptr;
+            }
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Load a constraint part of the contact point at 'pointIndex' of each lane.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void                 LoadPart(const uint pointIndex, const PartMember part, AxisConstraintPart4& outPart) const
+        {
+            AxisConstraintPart* pParts[4];
+            GetParts(pointIndex, part, pParts);
+            const AxisConstraintPart* const pConstParts[4] = { pParts[0], pParts[1], pParts[2], pParts[3] };
+            outPart.Load(pConstParts, m_nonStatic1, m_dynamic1, m_nonStatic2, m_dynamic2);
+        }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Store the accumulated impulses of a constraint part of the contact point at 'pointIndex'.
+        //----------------------------------------------------------------------------------------------------
+        NES_INLINE void                 StorePart(const uint pointIndex, const PartMember part, const AxisConstraintPart4& constraintPart) const
+        {
+            AxisConstraintPart* pParts[4];
+            GetParts(pointIndex, part, pParts);
+            constraintPart.StoreTotalLambda(pParts);
+        }
+    };
+
+    void ContactConstraintManager::WarmStartIndependentVelocityConstraints(const uint32* constraintIndexBegin, const uint32* constraintIndexEnd, const float warmStartImpulseRatio)
+    {
+        const Vec4Reg warmStartImpulseRatio4 = Vec4Reg::Replicate(warmStartImpulseRatio);
+
+        for (const uint32* pConstraintIndex = constraintIndexBegin; pConstraintIndex < constraintIndexEnd; pConstraintIndex += 4)
+        {
+            ContactConstraint4 lanes;
+            lanes.Load(m_constraints, pConstraintIndex, math::Min(4U, static_cast<uint>(constraintIndexEnd - pConstraintIndex)));
+            BodyVelocity4 velocity1 = lanes.m_velocity1;
+            BodyVelocity4 velocity2 = lanes.m_velocity2;
+
+            for (uint i = 0; i < lanes.m_maxNumContactPoints; ++i)
+            {
+                // Warm starting: Apply impulse from last frame. Inactive friction parts have no impulse to apply.
+                AxisConstraintPart4 friction1, friction2, nonPenetration;
+                lanes.LoadPart(i, &WorldContactPoint::m_frictionConstraint1, friction1);
+                lanes.LoadPart(i, &WorldContactPoint::m_frictionConstraint2, friction2);
+                lanes.LoadPart(i, &WorldContactPoint::m_nonPenetrationConstraint, nonPenetration);
+
+                friction1.WarmStart(velocity1, lanes.m_inverseMass1, velocity2, lanes.m_inverseMass2, lanes.m_tangent1, warmStartImpulseRatio4);
+                friction2.WarmStart(velocity1, lanes.m_inverseMass1, velocity2, lanes.m_inverseMass2, lanes.m_tangent2, warmStartImpulseRatio4);
+                nonPenetration.WarmStart(velocity1, lanes.m_inverseMass1, velocity2, lanes.m_inverseMass2, lanes.m_worldSpaceNormal, warmStartImpulseRatio4);
+
+                lanes.StorePart(i, &WorldContactPoint::m_frictionConstraint1, friction1);
+                lanes.StorePart(i, &WorldContactPoint::m_frictionConstraint2, friction2);
+                lanes.StorePart(i, &WorldContactPoint::m_nonPenetrationConstraint, nonPenetration);
+            }
+
+            velocity1.StoreChange(lanes.m_velocity1, lanes.m_pDynamic1);
+            velocity2.StoreChange(lanes.m_velocity2, lanes.m_pDynamic2);
+        }
+    }
+
+    bool ContactConstraintManager::SolveIndependentVelocityConstraints(const uint32* constraintIndexBegin, const uint32* constraintIndexEnd)
+    {
+        UVec4Reg anyImpulseApplied = UVec4Reg::Zero();
+
+        for (const uint32* pConstraintIndex = constraintIndexBegin; pConstraintIndex < constraintIndexEnd; pConstraintIndex += 4)
+        {
+            ContactConstraint4 lanes;
+            lanes.Load(m_constraints, pConstraintIndex, math::Min(4U, static_cast<uint>(constraintIndexEnd - pConstraintIndex)));
+            BodyVelocity4 velocity1 = lanes.m_velocity1;
+            BodyVelocity4 velocity2 = lanes.m_velocity2;
+
+            // The friction limit of a point uses its non-penetration impulse, so load those first.
+            AxisConstraintPart4 nonPenetration[kMaxContactPoints];
+            for (uint i = 0; i < lanes.m_maxNumContactPoints; ++i)
+                lanes.LoadPart(i, &WorldContactPoint::m_nonPenetrationConstraint, nonPenetration[i]);
+
+            // First, apply all friction constraints (non-penetration is more important than friction).
+            for (uint i = 0; i < lanes.m_maxNumContactPoints; ++i)
+            {
+                AxisConstraintPart4 friction1, friction2;
+                lanes.LoadPart(i, &WorldContactPoint::m_frictionConstraint1, friction1);
+                lanes.LoadPart(i, &WorldContactPoint::m_frictionConstraint2, friction2);
+
+                // Check if friction is enabled for any lane
+                if (UVec4Reg::Or(friction1.IsActive(), friction2.IsActive()).GetTrues() == 0)
+                    continue;
+
+                // Calculate impulse to stop motion in tangential direction.
+                Vec4Reg lambda1 = friction1.SolveVelocityConstraintGetTotalLambda(velocity1, velocity2, lanes.m_tangent1);
+                Vec4Reg lambda2 = friction2.SolveVelocityConstraintGetTotalLambda(velocity1, velocity2, lanes.m_tangent2);
+                const Vec4Reg totalLambdaSqr = lambda1 * lambda1 + lambda2 * lambda2;
+
+                // Calculate max impulse that can be applied, using the non-penetration impulse from the previous iteration.
+                const Vec4Reg maxLambdaF = lanes.m_combinedFriction * nonPenetration[i].GetTotalLambda();
+
+                // If the total lambda that we will apply is too large, scale it back. The other lanes divide by 1
+                // so that they don't divide by zero.
+                const UVec4Reg tooLarge = Vec4Reg::Greater(totalLambdaSqr, maxLambdaF * maxLambdaF);
+                if (tooLarge.GetTrues() != 0)
+                {
+                    const Vec4Reg scale = maxLambdaF / Vec4Reg::Select(Vec4Reg::One(), totalLambdaSqr, tooLarge).Sqrt();
+                    lambda1 = Vec4Reg::Select(lambda1, lambda1 * scale, tooLarge);
+                    lambda2 = Vec4Reg::Select(lambda2, lambda2 * scale, tooLarge);
+                }
+
+                // Apply the friction impulse.
+                anyImpulseApplied = UVec4Reg::Or(anyImpulseApplied, friction1.SolveVelocityConstraintApplyLambda(velocity1, lanes.m_inverseMass1, velocity2, lanes.m_inverseMass2, lanes.m_tangent1, lambda1));
+                anyImpulseApplied = UVec4Reg::Or(anyImpulseApplied, friction2.SolveVelocityConstraintApplyLambda(velocity1, lanes.m_inverseMass1, velocity2, lanes.m_inverseMass2, lanes.m_tangent2, lambda2));
+
+                lanes.StorePart(i, &WorldContactPoint::m_frictionConstraint1, friction1);
+                lanes.StorePart(i, &WorldContactPoint::m_frictionConstraint2, friction2);
+            }
+
+            // Then apply all non-penetration constraints
+            const Vec4Reg minLambda = Vec4Reg::Zero();
+            const Vec4Reg maxLambda = Vec4Reg::Replicate(FLT_MAX);
+            for (uint i = 0; i < lanes.m_maxNumContactPoints; ++i)
+            {
+                anyImpulseApplied = UVec4Reg::Or(anyImpulseApplied, nonPenetration[i].SolveVelocityConstraint(velocity1, lanes.m_inverseMass1, velocity2, lanes.m_inverseMass2, lanes.m_worldSpaceNormal, minLambda, maxLambda));
+                lanes.StorePart(i, &WorldContactPoint::m_nonPenetrationConstraint, nonPenetration[i]);
+            }
+
+            velocity1.StoreChange(lanes.m_velocity1, lanes.m_pDynamic1);
+            velocity2.StoreChange(lanes.m_velocity2, lanes.m_pDynamic2);
+        }
+
+        return anyImpulseApplied.GetTrues() != 0;
+    }
+
     void ContactConstraintManager::StoreAppliedImpulses(const uint32* constraintIndexBegin, const uint32* constraintIndexEnd) const
     {
         // Copy back total applied impulse to the cache for the next frame.
@@ -1376,8 +2091,8 @@ namespace nes
             Body& body2 = *constraint.m_pBody2;
 
             // Get the transforms
-            Mat44 transform1 = body1.GetCenterOfMassTransform();
-            Mat44 transform2 = body2.GetCenterOfMassTransform();
+            RMat44 transform1 = body1.GetCenterOfMassTransform();
+            RMat44 transform2 = body2.GetCenterOfMassTransform();
 
             const Vec3 worldSpaceNormal = constraint.GetWorldSpaceNormal();
 
@@ -4,6 +4,7 @@
 #include "Nessie/Core/StaticArray.h"
 #include "Nessie/Core/Thread/Containers/LockFreeHashMap.h"
 #include "Nessie/Physics/PhysicsUpdateErrorCodes.h"
+#include "Nessie/Physics/StateRecorder.h"
 #include "Nessie/Physics/Body/BodyPair.h"
 #include "Nessie/Physics/Collision/ManifoldBetweenTwoFaces.h"
 #include "Nessie/Physics/Collision/Shapes/SubShapeIDPair.h"
@@ -14,6 +15,7 @@ namespace nes
 {
     struct PhysicsSettings;
     struct PhysicsUpdateContext;
+    class BodyManager;
 
     //----------------------------------------------------------------------------------------------------
     /// @brief : Class that manages constraints between two bodies in contact with each other. 
@@ -31,8 +33,10 @@ namespace nes
         {
             using LFHMAllocatorContext::LFHMAllocatorContext;
 
-            uint					    m_numBodyPairs = 0;									/// Total number of body pairs added using this allocator.
+            uint					    m_numBodyPairs = 0;									/// Total number of body pairs (including sensor pairs) added using this allocator.
             uint					    m_numManifolds = 0;                                 /// Total number of manifolds added using this allocator.
+            uint                        m_numBodyPairCacheHits = 0;                         /// Number of body pairs for which the contacts were copied from the contact cache.
+            uint                        m_numBodyPairCacheMisses = 0;                       /// Number of body pairs that were looked up in the contact cache, but were not found or could not be reused.
             EPhysicsUpdateErrorCode	    m_errors = EPhysicsUpdateErrorCode::None;			/// Errors reported on this allocator.
         };
         
@@ -177,6 +181,20 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         bool                            AddContactConstraint(ContactAllocator& contactAllocator, BodyPairHandle bodyPairHandle, Body& body1, Body& body2, const ContactManifold& manifold);
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Add an overlap between a sensor and another body this frame. Sensor pairs skip the body pair
+        ///     cache, manifold generation and contact constraint setup: a single entry per body pair is stored,
+        ///     which is used to call OnContactAdded or OnContactPersisted now, and OnContactRemoved once the
+        ///     bodies stop overlapping. The sub shape IDs of the first overlap are kept for as long as the
+        ///     bodies keep overlapping, so that the added, persisted and removed callbacks use the same key.
+        ///	@param contactAllocator : The allocator that reserves memory for the sensor pair.
+        ///	@param body1 : The first body that is overlapping.
+        ///	@param body2 : The second body that is overlapping.
+        ///	@param baseOffset : Offset that the collision result is relative to.
+        ///	@param collisionResult : The first overlap that was found between the two bodies.
+        //----------------------------------------------------------------------------------------------------
+        void                            AddSensorContact(ContactAllocator& contactAllocator, const Body& body1, const Body& body2, const RVec3 baseOffset, const CollideShapeResult& collisionResult);
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Finalizes the contact cache - the contact cache that was generated during the calls to
         ///     AddContactConstraints in this update will be used from now on to read from. After finalizing the
@@ -188,6 +206,19 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         void                            FinalizeContactCacheAndCallContactPointRemovedCallback(const uint expectedNumBodyPairs, const uint expectedNumManifolds);
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Copy the cached contacts of bodies that skipped this update because of their simulation
+        ///     region to the contact cache of this update, so that they are not removed and can be used to warm
+        ///     start the update in which the bodies are simulated again. A body pair is copied when neither body
+        ///     is active and at least one of them skipped the update. Must be called before
+        ///     FinalizeContactCacheAndCallContactPointRemovedCallback().
+        ///	@param contactAllocator : Allocator that is used to create the contacts. The number of body pairs and
+        ///     manifolds that it created must be added to the expected numbers passed to
+        ///     FinalizeContactCacheAndCallContactPointRemovedCallback().
+        ///	@param bodyManager : Body manager that contains the bodies.
+        //----------------------------------------------------------------------------------------------------
+        void                            KeepContactsOfSkippedBodies(ContactAllocator& contactAllocator, const BodyManager& bodyManager);
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Check if two bodies were in contact during the last simulation step. Since contacts are
         ///     only created between active bodies, at least one of the bodies must be active.
@@ -195,6 +226,22 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         bool                            WereBodiesInContact(const BodyID& bodyID1, const BodyID& bodyID2) const;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the contact cache that is used to warm start the next simulation step.
+        ///	@param stream : Stream to write to.
+        ///	@param pFilter : Optional filter to select which contacts to save.
+        //----------------------------------------------------------------------------------------------------
+        void                            SaveState(StateRecorder& stream, const StateRecorderFilter* pFilter) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the contact cache from a stream that was written with SaveState(). The restored
+        ///     cache replaces the current one. No contact listener callbacks are made.
+        ///	@param stream : Stream to read from.
+        ///	@param pFilter : Optional filter to select which contacts to restore.
+        /// @returns : False if the stream is malformed or the contact cache is full.
+        //----------------------------------------------------------------------------------------------------
+        bool                            RestoreState(StateRecorder& stream, const StateRecorderFilter* pFilter);
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the number of contact constraints that were found.  
         //----------------------------------------------------------------------------------------------------
@@ -255,6 +302,22 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         bool                            SolveVelocityConstraints(const uint32* constraintIndexBegin, const uint32* constraintIndexEnd);
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Same as WarmStartVelocityConstraints(), for contact constraints that are independent: no two
+        ///     of them can act on the same dynamic body, like the contacts in a parallel split of the
+        ///     LargeIslandSplitter. The constraints are warm started 4 at a time with SIMD.
+        //----------------------------------------------------------------------------------------------------
+        void                            WarmStartIndependentVelocityConstraints(const uint32* constraintIndexBegin, const uint32* constraintIndexEnd, const float warmStartImpulseRatio);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Same as SolveVelocityConstraints(), for contact constraints that are independent: no two
+        ///     of them can act on the same dynamic body, like the contacts in a parallel split of the
+        ///     LargeIslandSplitter. The constraints are loaded as a structure of arrays and solved 4 at a
+        ///     time with SIMD, keeping the velocities of the bodies in registers until all contact points are
+        ///     solved. Gives the same result as SolveVelocityConstraints() up to floating point rounding.
+        //----------------------------------------------------------------------------------------------------
+        bool                            SolveIndependentVelocityConstraints(const uint32* constraintIndexBegin, const uint32* constraintIndexEnd);
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Save back the lambdas to the contact cache for the next warm start.
         //----------------------------------------------------------------------------------------------------
@@ -389,6 +452,33 @@ namespace nes
         using BodyPairMap = LockFreeHashMap<BodyPair, CachedBodyPair>;
         using BPKeyValue = BodyPairMap::KeyValuePair;
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Overlap between a sensor and another body. Only stores what is needed to report the contact
+        ///     as persisted or removed in the next simulation update.
+        //----------------------------------------------------------------------------------------------------
+        struct CachedSensorPair
+        {
+            enum class EFlags : uint16
+            {
+                ContactPersisted    = 1,    /// If this cache entry was reused in the next simulation update.
+            };
+
+            /// Sub shapes of the first overlap between the bodies.
+            SubShapeID                  m_subShapeID1;
+            SubShapeID                  m_subShapeID2;
+
+            /// @see EFlags
+            mutable std::atomic<uint16> m_flags { 0 };
+        };
+
+        static_assert(alignof(CachedSensorPair) == 4, "Assuming 4 byte aligned");
+
+        using SensorPairMap = LockFreeHashMap<BodyPair, CachedSensorPair>;
+        using SPKeyValue = SensorPairMap::KeyValuePair;
+
+        // Sensor pairs are allocated from the budget of the body pairs they replace.
+        static_assert(sizeof(SPKeyValue) <= sizeof(BPKeyValue));
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Holds all caches that are need to quickly find cached body pairs / manifolds. 
         //----------------------------------------------------------------------------------------------------
@@ -455,6 +545,16 @@ namespace nes
             //----------------------------------------------------------------------------------------------------
             BPKeyValue*                 Create(ContactAllocator& contactAllocator, const BodyPair& key, uint64 keyHash);
 
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Find a CachedSensorPair from a BodyPair.
+            //----------------------------------------------------------------------------------------------------
+            const SPKeyValue*           FindSensorPair(const BodyPair& key, uint64 keyHash) const;
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Create a CachedSensorPair from a BodyPair.
+            //----------------------------------------------------------------------------------------------------
+            SPKeyValue*                 CreateSensorPair(ContactAllocator& contactAllocator, const BodyPair& key, uint64 keyHash);
+
             //----------------------------------------------------------------------------------------------------
             /// @brief : Get all cached body pairs, sorted by key value.
             //----------------------------------------------------------------------------------------------------
@@ -471,10 +571,33 @@ namespace nes
             void                        GetAllCCDManifoldsSorted(std::vector<const MKeyValue*>& outAll) const;
 
             //----------------------------------------------------------------------------------------------------
-            /// @brief : Call pListener->OnContactRemoved() for all non-persisting contacts. 
+            /// @brief : Get all cached sensor pairs, sorted by key value.
+            //----------------------------------------------------------------------------------------------------
+            void                        GetAllSensorPairsSorted(std::vector<const SPKeyValue*>& outAll) const;
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Call pListener->OnContactRemoved() for all non-persisting contacts and sensor pairs. 
             //----------------------------------------------------------------------------------------------------
             void                        ContactPointRemovedCallbacks(ContactListener* pListener);
 
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Copy the body pairs and their manifolds to writeCache for which neither body is active and
+            ///     at least one body skipped the update. The copied manifolds are marked as persisted. Sensor pairs
+            ///     are copied in the same way.
+            //----------------------------------------------------------------------------------------------------
+            void                        CopyBodyPairsOfSkippedBodies(ContactAllocator& contactAllocator, const BodyManager& bodyManager, ManifoldCache& writeCache);
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Write all body pairs, manifolds and sensor pairs to the stream, sorted by key. The cache must be finalized.
+            //----------------------------------------------------------------------------------------------------
+            void                        SaveState(StateRecorder& stream, const StateRecorderFilter* pFilter) const;
+
+            //----------------------------------------------------------------------------------------------------
+            /// @brief : Create the body pairs, manifolds and sensor pairs that were written with SaveState(). The cache must be
+            ///     empty, and is finalized afterward.
+            //----------------------------------------------------------------------------------------------------
+            bool                        RestoreState(ContactAllocator& contactAllocator, StateRecorder& stream, const StateRecorderFilter* pFilter);
+
         #ifdef NES_ASSERTS_ENABLED
             //----------------------------------------------------------------------------------------------------
             /// @brief : Get the number of manifolds in the cache.
@@ -482,9 +605,9 @@ namespace nes
             uint                        GetNumManifolds() const             { return m_cachedManifolds.GetNumKeyValues(); }
 
             //----------------------------------------------------------------------------------------------------
-            /// @brief : Get the number of body pairs in the cache. 
+            /// @brief : Get the number of body pairs in the cache, including sensor pairs.
             //----------------------------------------------------------------------------------------------------
-            uint                        GetNumBodyPairs() const             { return m_cachedBodyPairs.GetNumKeyValues(); }
+            uint                        GetNumBodyPairs() const             { return m_cachedBodyPairs.GetNumKeyValues() + m_cachedSensorPairs.GetNumKeyValues(); }
 
             //----------------------------------------------------------------------------------------------------
             /// @brief : Before a cache is finalized, you can only do Create(). After, only Find() and Clear().
@@ -506,6 +629,14 @@ namespace nes
             /// Simple hash map for BodyPair -> CachedBodyPair
             BodyPairMap                 m_cachedBodyPairs { m_allocator };
 
+            /// Simple hash map for BodyPair -> CachedSensorPair
+            SensorPairMap               m_cachedSensorPairs { m_allocator };
+
+            /// Sorted key values that SaveState() writes. Kept to prevent allocations when saving every frame.
+            mutable std::vector<const BPKeyValue*> m_saveBodyPairs;
+            mutable std::vector<const MKeyValue*> m_saveManifolds;
+            mutable std::vector<const SPKeyValue*> m_saveSensorPairs;
+
         #ifdef NES_ASSERTS_ENABLED
             bool                        m_isFinalized = false;      /// Marks if the buffer is complete.
         #endif
@@ -537,6 +668,9 @@ namespace nes
         };
         
         using WorldContactPoints = StaticArray<WorldContactPoint, kMaxContactPoints>;
+
+        /// Up to 4 independent contact constraints, loaded into SIMD lanes. Defined in the cpp file.
+        struct ContactConstraint4;
         
         //----------------------------------------------------------------------------------------------------
         /// @brief : Contact constraints are used for solving penetrations between bodies. 
@@ -583,12 +717,12 @@ namespace nes
         ///     Templated to the motion type to reduce the number of branches and calculations.
         //----------------------------------------------------------------------------------------------------
         template <EBodyMotionType Type1, EBodyMotionType Type2>
-        NES_INLINE void                 TemplatedCalculateFrictionAndNonPenetrationConstraintProperties(ContactConstraint& constraint, const ContactSettings& settings, float deltaTime, const Vec3 gravityDeltaTime, const Mat44& transformBody1, const Mat44& transformBody2, const Body& body1, const Body& body2);
+        NES_INLINE void                 TemplatedCalculateFrictionAndNonPenetrationConstraintProperties(ContactConstraint& constraint, const ContactSettings& settings, float deltaTime, const Vec3 gravityDeltaTime, const RMat44& transformBody1, const RMat44& transformBody2, const Body& body1, const Body& body2);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Internal helper function to calculate the friction and non-penetration constraint properties.
         //----------------------------------------------------------------------------------------------------
-        inline void                     CalculateFrictionAndNonPenetrationConstraintProperties(ContactConstraint& constraint, const ContactSettings& settings, float deltaTime, const Vec3 gravityDeltaTime, const Mat44& transformBody1, const Mat44& transformBody2, const Body& body1, const Body& body2);
+        inline void                     CalculateFrictionAndNonPenetrationConstraintProperties(ContactConstraint& constraint, const ContactSettings& settings, float deltaTime, const Vec3 gravityDeltaTime, const RMat44& transformBody1, const RMat44& transformBody2, const Body& body1, const Body& body2);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Internal helper function to add a contact constraint.
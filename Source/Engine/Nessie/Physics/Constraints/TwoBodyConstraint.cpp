@@ -14,7 +14,7 @@ namespace nes
     bool TwoBodyConstraint::Internal_IsActive() const
     {
         return Constraint::Internal_IsActive()
-            && (m_pBodyA->IsActive() || m_pBodyB->IsActive())
+            && (m_pBodyA->Internal_IsInActiveBodies() || m_pBodyB->Internal_IsInActiveBodies())
             && (m_pBodyA->IsDynamic() || m_pBodyB->IsDynamic());
     }
 
@@ -105,17 +105,17 @@ namespace nes
                     if (!m_bodyLinks[firstLinkTo].m_linkedTo.compare_exchange_weak(firstLinkTo, secondLinkTo, std::memory_order_relaxed))
                         continue;
                 }
-
-                // Linking succeeded!
-                // Chains of bodies can become really long, resulting in an O(N) loop to find the lowest body index.
-                // To prevent this, we attempt to update the link of the bodies that were passed in to directly point
-                // to the lowest index that we found. If the value became lower than our lowest link, some other
-                // thread must have relinked these bodies in the meantime, so we won't update the value.
-                const uint32 lowestLinkTo = math::Min(firstLinkTo, secondLinkTo);
-                AtomicMin(m_bodyLinks[first].m_linkedTo, lowestLinkTo, std::memory_order_relaxed);
-                AtomicMin(m_bodyLinks[second].m_linkedTo, lowestLinkTo, std::memory_order_relaxed);
-                break;
             }
+
+            // Linking succeeded, or the bodies were already in the same island.
+            // Chains of bodies can become really long, resulting in an O(N) loop to find the lowest body index.
+            // To prevent this, we attempt to update the link of the bodies that were passed in to directly point
+            // to the lowest index that we found. If the value became lower than our lowest link, some other
+            // thread must have relinked these bodies in the meantime, so we won't update the value.
+            const uint32 lowestLinkTo = math::Min(firstLinkTo, secondLinkTo);
+            AtomicMin(m_bodyLinks[first].m_linkedTo, lowestLinkTo, std::memory_order_relaxed);
+            AtomicMin(m_bodyLinks[second].m_linkedTo, lowestLinkTo, std::memory_order_relaxed);
+            break;
         }
     }
 
@@ -32,7 +32,7 @@ namespace nes
         m_status.store(static_cast<uint64>(splitIndex) << StatusSplitShift, std::memory_order_release);
     }
 
-    LargeIslandSplitter::EStatus LargeIslandSplitter::Splits::FetchNextBatch(uint32& outConstraintsBegin, uint32& outConstraintsEnd, uint32& outContactsBegin, uint32& outContactsEnd, bool& outFirstIteration)
+    LargeIslandSplitter::EStatus LargeIslandSplitter::Splits::FetchNextBatch(uint32& outConstraintsBegin, uint32& outConstraintsEnd, uint32& outContactsBegin, uint32& outContactsEnd, bool& outFirstIteration, bool& outIsParallel)
     {
         // First check if we can get a new batch (doing a read to avoid hammering an atomic with an atomic subtraction).
         // Note this also avoids overflowing the status counter if we're done, but there is still one thread processing the items.
@@ -87,6 +87,7 @@ namespace nes
                 outContactsBegin = split.m_contactBufferBegin;
                 outContactsEnd = split.m_contactBufferEnd;
                 outFirstIteration = iteration == 0;
+                outIsParallel = false;
                 return EStatus::BatchRetrieved;
             }
             
@@ -118,19 +119,20 @@ namespace nes
             }
 
             outContactsBegin = split.m_contactBufferBegin + (math::Max(itemBegin, numConstraints) - numConstraints);
-            outContactsEnd = split.m_constraintBufferEnd + (itemEnd - numConstraints);
+            outContactsEnd = split.m_contactBufferBegin + (itemEnd - numConstraints);
         }
         else
         {
             // Only constraints
             outConstraintsBegin = split.m_constraintBufferBegin + itemBegin;
-            outConstraintsEnd = split.m_constraintBufferEnd + itemEnd;
+            outConstraintsEnd = split.m_constraintBufferBegin + itemEnd;
 
             outContactsBegin = 0;
             outContactsEnd = 0;
         }
 
         outFirstIteration = iteration == 0;
+        outIsParallel = true;
         return EStatus::BatchRetrieved;
     }
 
@@ -502,7 +504,7 @@ namespace nes
         return true;
     }
 
-    LargeIslandSplitter::EStatus LargeIslandSplitter::FetchNextBatch(uint& outSplitIslandIndex, uint32*& outConstraintsBegin, uint32*& outConstraintsEnd, uint32*& outContactsBegin, uint32*& outContactsEnd, bool& outFirstIteration)
+    LargeIslandSplitter::EStatus LargeIslandSplitter::FetchNextBatch(uint& outSplitIslandIndex, uint32*& outConstraintsBegin, uint32*& outConstraintsEnd, uint32*& outContactsBegin, uint32*& outContactsEnd, bool& outFirstIteration, bool& outIsParallel)
     {
         // We can't be done when all islands haven't been submitted yet.
         const uint numSplitsCreated = m_nextSplitIslandIndex.load(std::memory_order::acquire);
@@ -515,7 +517,7 @@ namespace nes
         uint32 contactsEnd;
         for (Splits* pSplits = m_splitIslands; pSplits < m_splitIslands + numSplitsCreated; ++pSplits)
         {
-            switch (pSplits->FetchNextBatch(constraintsBegin, constraintsEnd, contactsBegin, contactsEnd, outFirstIteration))
+            switch (pSplits->FetchNextBatch(constraintsBegin, constraintsEnd, contactsBegin, contactsEnd, outFirstIteration, outIsParallel))
             {
                 case EStatus::AllBatchesDone: break;
                     
@@ -104,7 +104,7 @@ namespace nes
             //----------------------------------------------------------------------------------------------------
             /// @brief : Get the next batch to process. 
             //----------------------------------------------------------------------------------------------------
-            EStatus             FetchNextBatch(uint32& outConstraintsBegin, uint32& outConstraintsEnd, uint32& outContactsBegin, uint32& outContactsEnd, bool& outFirstIteration);
+            EStatus             FetchNextBatch(uint32& outConstraintsBegin, uint32& outConstraintsEnd, uint32& outContactsBegin, uint32& outContactsEnd, bool& outFirstIteration, bool& outIsParallel);
 
             //----------------------------------------------------------------------------------------------------
             /// @brief : Mark a batch as processed. 
@@ -157,9 +157,11 @@ namespace nes
         bool                    SplitIsland(const uint32 islandIndex, const IslandBuilder& builder, const BodyManager& bodyManager, const ContactConstraintManager& contactManager, Constraint** activeConstraints, CalculateSolverSteps& stepsCalculator);
 
         //----------------------------------------------------------------------------------------------------
-        /// @brief : Fetch the next batch to process, returns a handle in outSplitIslandIndex that must be provided to MarkBatchProcessed when complete
+        /// @brief : Fetch the next batch to process, returns a handle in outSplitIslandIndex that must be provided to MarkBatchProcessed when complete.
+        ///     outIsParallel is set to true when the batch comes from a parallel split, which means that no two
+        ///     constraints or contacts in the batch act on the same dynamic body.
         //----------------------------------------------------------------------------------------------------
-        EStatus                 FetchNextBatch(uint& outSplitIslandIndex, uint32*& outConstraintsBegin, uint32*& outConstraintsEnd, uint32*& outContactsBegin, uint32*& outContactsEnd, bool& outFirstIteration);
+        EStatus                 FetchNextBatch(uint& outSplitIslandIndex, uint32*& outConstraintsBegin, uint32*& outConstraintsEnd, uint32*& outContactsBegin, uint32*& outContactsEnd, bool& outFirstIteration, bool& outIsParallel);
 
         //----------------------------------------------------------------------------------------------------
         /// @brief : Mark a batch as processed. Should be called after FetchNextBatch().
@@ -171,6 +173,16 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         inline uint32           GetIslandIndex(const uint splitIslandIndex) const { NES_ASSERT(splitIslandIndex < m_numSplitIslands); return m_splitIslands[splitIslandIndex].m_IslandIndex; }
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of islands that required splitting.
+        //----------------------------------------------------------------------------------------------------
+        inline uint             GetNumSplitIslands() const                      { return m_numSplitIslands; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of parallel splits that a split island was divided into (excluding the non-parallel split).
+        //----------------------------------------------------------------------------------------------------
+        inline uint             GetNumSplits(const uint splitIslandIndex) const { NES_ASSERT(splitIslandIndex < m_numSplitIslands); return m_splitIslands[splitIslandIndex].GetNumSplits(); }
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Prepare the island splitter for iterating over the split islands again for position solving.
         ///     Marks all batches as startable.
@@ -2,6 +2,7 @@
 #include "PhysicsScene.h"
 #include "PhysicsStepListener.h"
 #include "Nessie/Physics/Collision/BroadPhase/BroadPhaseQuadTree.h"
+#include "Nessie/Physics/Collision/BroadPhase/BroadPhaseSweepAndPrune.h"
 #include "Nessie/Physics/Collision/CollisionSolver.h"
 #include "Nessie/Physics/Collision/AABoxCast.h"
 #include "Nessie/Physics/Collision/ShapeCast.h"
@@ -30,6 +31,8 @@ namespace nes
         // Atomically accumulate the number of found manifolds and body pairs.
         step.m_numBodyPairs.fetch_add(allocator.m_numBodyPairs, std::memory_order_relaxed);
         step.m_numManifolds.fetch_add(allocator.m_numManifolds, std::memory_order_relaxed);
+        step.m_numBodyPairCacheHits.fetch_add(allocator.m_numBodyPairCacheHits, std::memory_order_relaxed);
+        step.m_numBodyPairCacheMisses.fetch_add(allocator.m_numBodyPairCacheMisses, std::memory_order_relaxed);
 
         // Combine update errors
         step.m_pContext->m_errors.fetch_or(static_cast<uint32>(allocator.m_errors), std::memory_order_relaxed);
@@ -77,6 +80,19 @@ namespace nes
         NES_ASSERT(pCCDBody->m_bodyID1 == body.GetID(), "We found the wrong CCD body!");
         return pCCDBody;
     }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Helper function that spreads the lower 10 bits of a value, so that there are 2 zero bits
+    ///     between each bit. Used to interleave 3 coordinates into a morton code.
+    //----------------------------------------------------------------------------------------------------
+    inline static uint32 ExpandBitsForMortonCode(uint32 value)
+    {
+        value = (value * 0x00010001u) & 0xFF0000FFu;
+        value = (value * 0x00000101u) & 0x0F00F00Fu;
+        value = (value * 0x00000011u) & 0xC30C30C3u;
+        value = (value * 0x00000005u) & 0x49249249u;
+        return value;
+    }
     
     PhysicsScene::PhysicsScene()
         : m_contactManager(m_physicsSettings)
@@ -102,9 +118,21 @@ namespace nes
         m_bodyManager.Init(maxBodies, createInfo.m_numBodyMutexes, *createInfo.m_pLayerInterface);
         
         // Create the Broadphase.
-        // [LATER]: The idea is that the Broadphase class can be modified in the future, but for now,
-        // I am going to force the use of the QuadTree version.
-        m_pBroadphase = NES_NEW(BroadPhaseQuadTree());
+        switch (createInfo.m_broadPhaseType)
+        {
+            case EBroadPhaseType::OctTree:
+                m_pBroadphase = NES_NEW(BroadPhaseOctTree());
+                break;
+
+            case EBroadPhaseType::SweepAndPrune:
+                m_pBroadphase = NES_NEW(BroadPhaseSweepAndPrune());
+                break;
+            
+            case EBroadPhaseType::QuadTree:
+            default:
+                m_pBroadphase = NES_NEW(BroadPhaseQuadTree());
+                break;
+        }
         m_pBroadphase->Init(&m_bodyManager, *createInfo.m_pLayerInterface);
 
         // Init Contact Constraint Manager:
@@ -112,6 +140,9 @@ namespace nes
         
         // Init Islands Builder
         m_islandBuilder.Init(maxBodies);
+
+        // Reserve the scratch buffer of RestoreState().
+        m_restoredBodies.reserve(maxBodies);
         
         // Init the Body Interface
         m_bodyInterfaceLocking.Internal_Init(m_bodyLockInterfaceLocking, m_bodyManager, *m_pBroadphase);
@@ -148,11 +179,89 @@ namespace nes
         m_pBroadphase->Optimize();
     }
 
+    void PhysicsScene::SaveState(StateRecorder& stream, const EStateRecorderState state, const StateRecorderFilter* pFilter) const
+    {
+        stream.Write(state);
+
+        if ((state & EStateRecorderState::Global) != 0)
+        {
+            stream.Write(m_previousStepDeltaTime);
+            stream.Write(m_gravity);
+            stream.Write(m_simulationUpdateCount);
+            stream.Write(m_simulationRegionSkippedTime);
+        }
+
+        if ((state & EStateRecorderState::Bodies) != 0)
+            m_bodyManager.SaveState(stream, pFilter);
+
+        if ((state & EStateRecorderState::Contacts) != 0)
+            m_contactManager.SaveState(stream, pFilter);
+
+        if ((state & EStateRecorderState::Constraints) != 0)
+            m_constraintManager.SaveState(stream, pFilter);
+    }
+
+    bool PhysicsScene::RestoreState(StateRecorder& stream, const StateRecorderFilter* pFilter)
+    {
+        EStateRecorderState state = EStateRecorderState::All;
+        stream.Read(state);
+
+        // The global state is applied after the bodies have been validated, so that a stream that doesn't
+        // match the scene leaves the scene untouched.
+        float previousStepDeltaTime = m_previousStepDeltaTime;
+        Vec3 gravity = m_gravity;
+        uint32 simulationUpdateCount = m_simulationUpdateCount;
+        float simulationRegionSkippedTime[kMaxSimulationRegions];
+        std::copy(std::begin(m_simulationRegionSkippedTime), std::end(m_simulationRegionSkippedTime), simulationRegionSkippedTime);
+
+        if ((state & EStateRecorderState::Global) != 0)
+        {
+            stream.Read(previousStepDeltaTime);
+            stream.Read(gravity);
+            stream.Read(simulationUpdateCount);
+            stream.Read(simulationRegionSkippedTime);
+            if (stream.IsFailed())
+                return false;
+        }
+
+        if ((state & EStateRecorderState::Bodies) != 0)
+        {
+            if (!m_bodyManager.RestoreState(stream, m_restoredBodies))
+                return false;
+
+            // Restored bodies can have skipped time of their simulation region.
+            m_hasSimulationSkippedTime = true;
+
+            // Update the bounds of the bodies that moved in the broadphase.
+            if (!m_restoredBodies.empty())
+                m_pBroadphase->NotifyBodiesAABBChanged(m_restoredBodies.data(), static_cast<int>(m_restoredBodies.size()));
+        }
+
+        m_previousStepDeltaTime = previousStepDeltaTime;
+        m_gravity = gravity;
+        m_simulationUpdateCount = simulationUpdateCount;
+        std::copy(std::begin(simulationRegionSkippedTime), std::end(simulationRegionSkippedTime), m_simulationRegionSkippedTime);
+
+        if ((state & EStateRecorderState::Contacts) != 0)
+        {
+            if (!m_contactManager.RestoreState(stream, pFilter))
+                return false;
+        }
+
+        if ((state & EStateRecorderState::Constraints) != 0)
+        {
+            if (!m_constraintManager.RestoreState(stream))
+                return false;
+        }
+
+        return !stream.IsFailed();
+    }
+
     void PhysicsScene::AddStepListener(PhysicsStepListener* pListener)
     {
         std::lock_guard lock(m_stepListenersMutex);
 
-        NES_ASSERT(std::ranges::find(m_stepListeners.begin(), m_stepListeners.end(), pListener) != m_stepListeners.end());
+        NES_ASSERT(std::ranges::find(m_stepListeners.begin(), m_stepListeners.end(), pListener) == m_stepListeners.end(), "Step listener was already added!");
         m_stepListeners.push_back(pListener);
     }
 
@@ -166,6 +275,14 @@ namespace nes
         m_stepListeners.pop_back();
     }
 
+    void PhysicsScene::SetSimulationRegionSettings(const uint32 region, const SimulationRegionSettings& settings)
+    {
+        NES_ASSERT(region < kMaxSimulationRegions);
+        NES_ASSERT(settings.m_stepInterval > 0);
+        NES_ASSERT(settings.m_numVelocityStepsOverride < 256 && settings.m_numPositionStepsOverride < 256);
+        m_simulationRegionSettings[region] = settings;
+    }
+
     EPhysicsUpdateErrorCode PhysicsScene::Update(const float deltaTime, const int collisionSteps, StackAllocator* pAllocator, JobSystem* pJobSystem)
     {
         NES_ASSERT(m_pBroadphase != nullptr);
@@ -174,6 +291,16 @@ namespace nes
 
         // Sync point for the Broadphase. This will allow it to do clean up operations without having any mutexes locked yet.
         m_pBroadphase->FrameSync();
+
+        // Reset the CCD statistics, they are accumulated over the collision steps of this update.
+        m_ccdStats = CCDStats();
+
+        // Reset the step statistics, and start measuring the stack allocator usage of this update.
+        if (m_stepStatsEnabled)
+        {
+            m_stepStats.Internal_BeginUpdate();
+            pAllocator->ResetHighWaterMark();
+        }
         
         // If there are no active bodies (and no step listener to wake them up) or there's no time delta
         const uint32_t numActiveRigidBodies = m_bodyManager.GetNumActiveBodies();
@@ -192,6 +319,9 @@ namespace nes
               m_contactManager.FinalizeContactCacheAndCallContactPointRemovedCallback(0, 0);
         
             m_bodyManager.UnlockAllBodies();
+
+            if (m_stepStatsEnabled)
+                m_stepStats.Internal_EndUpdate(*pAllocator);
             return EPhysicsUpdateErrorCode::None;
         }
         
@@ -206,6 +336,7 @@ namespace nes
         context.m_pJobSystem = pJobSystem;
         context.m_pBarrier = pJobSystem->CreateBarrier();
         context.m_pIslandBuilder = &m_islandBuilder;
+        context.m_pStepStats = m_stepStatsEnabled? &m_stepStats : nullptr;
         context.m_stepDeltaTime = stepDeltaTime;
         context.m_warmStartImpulseRatio = warmStartImpulseRatio;
         context.m_steps.resize(collisionSteps);
@@ -219,6 +350,10 @@ namespace nes
         m_bodyManager.LockAllBodies();
         m_pBroadphase->LockModifications();
 
+        // Remove the bodies of the simulation regions that are not simulated in this update from the active bodies.
+        PrepareSimulationRegions(deltaTime);
+        const uint32 numSimulatedBodies = m_bodyManager.GetNumActiveBodies();
+
         // Get the max number of concurrent jobs
         const int maxConcurrency = context.GetMaxConcurrency();
         
@@ -228,7 +363,7 @@ namespace nes
         // The number of gravity jobs depends on the number of active bodies.
         // Launch max 1 job per batch of active bodies.
         // Leave 1 thread for update broadphase prepare and 1 for determine active constraints.
-        const int numApplyGravityJobs = math::Max(1, math::Min((static_cast<int>(numActiveRigidBodies) + kApplyGravityBatchSize - 1) / kApplyGravityBatchSize, maxConcurrency - 2));
+        const int numApplyGravityJobs = math::Max(1, math::Min((static_cast<int>(numSimulatedBodies) + kApplyGravityBatchSize - 1) / kApplyGravityBatchSize, maxConcurrency - 2));
 
         // The number of determine active constraints jobs to run depends on the number of constraints.
         // Leave 1 thread for update broadphase prepare and 1 thread for apply gravity.
@@ -240,10 +375,10 @@ namespace nes
         // The number of find collisions jobs to run depends on the number of active bodies.
         // Note that when we have more than 1 thread, we always spawn at least 2 find collisions jobs so that the first job can wait for build islands from
         // constraints (Which may activate additional bodies that need to be processed) while the second job can start processing the collision work.
-        const int numFindCollisionsJobs = math::Max(maxConcurrency == 1? 1 : 2, math::Min((static_cast<int>(numActiveRigidBodies) + kActiveBodiesBatchSize - 1) / kActiveBodiesBatchSize, maxConcurrency));
+        const int numFindCollisionsJobs = math::Max(maxConcurrency == 1? 1 : 2, math::Min((static_cast<int>(numSimulatedBodies) + kActiveBodiesBatchSize - 1) / kActiveBodiesBatchSize, maxConcurrency));
 
         // The number of integrate velocities jobs depends on the number of active bodies.
-        const int numIntegrateVelocityJobs = math::Max(1, math::Min((static_cast<int>(numActiveRigidBodies) + kIntegrateVelocityBatchSize - 1) / kIntegrateVelocityBatchSize, maxConcurrency));
+        const int numIntegrateVelocityJobs = math::Max(1, math::Min((static_cast<int>(numSimulatedBodies) + kIntegrateVelocityBatchSize - 1) / kIntegrateVelocityBatchSize, maxConcurrency));
         
         // Build and Run Jobs:
         {
@@ -257,6 +392,7 @@ namespace nes
                 step.m_pContext = &context;
                 step.m_isFirst = isFirstStep;
                 step.m_isLast = isLastStep;
+                step.m_stepIndex = static_cast<uint32>(stepIndex);
         
                 // Create a Job to do the broadphase finalization.
                 // This job must finish before integrating velocities. Until then, the positions will not be updated, nor will
@@ -264,6 +400,8 @@ namespace nes
                 // Dependencies: All Find Collision Jobs, Broadphase Prepare, Finish Building Jobs 
                 step.m_broadPhaseFinalize = pJobSystem->CreateJob("Update Broadphase Finalize", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::BroadPhaseFinalize, step.m_stepIndex);
+
                     // Validate that all find collision jobs have stopped.
                     NES_ASSERT(step.m_activeFindCollisionJobs.load(std::memory_order_relaxed) == 0);
         
@@ -283,6 +421,8 @@ namespace nes
                 // If this is turned around, the RemoveBody call will hang since it locks in that order
                 step.m_broadPhasePrepare = pJobSystem->CreateJob("UpdateBroadphasePrepare", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::BroadPhasePrepare, step.m_stepIndex);
+
                     // Prepare the broadphase update
                     step.m_broadPhaseUpdateState = context.m_pPhysicsScene->m_pBroadphase->UpdatePrepare();
         
@@ -303,6 +443,8 @@ namespace nes
                     const int numDepBuildIslandsFromConstraints = i == 0? 1 : 0;
                     step.m_findCollisions[i] = pJobSystem->CreateJob("Find Collisions", [&step, i]()
                     {
+                        ScopedPhysicsJobTimer timer(step.m_pContext->m_pStepStats, EPhysicsJobType::FindCollisions, step.m_stepIndex);
+
                         step.m_pContext->m_pPhysicsScene->JobFindCollisions(&step, i);
                     }, numApplyGravityJobs + numDetermineActiveConstraintsJobs + 1 + numDepBuildIslandsFromConstraints);
                 }
@@ -338,6 +480,8 @@ namespace nes
                 {
                     step.m_applyGravity[i] = pJobSystem->CreateJob("Apply Gravity", [&context, &step]()
                     {
+                        ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::ApplyGravity, step.m_stepIndex);
+
                         context.m_pPhysicsScene->JobApplyGravity(&context, &step);
                         JobHandle::RemovedDependencies(step.m_findCollisions);
                         
@@ -351,6 +495,8 @@ namespace nes
                 {
                     step.m_setupVelocityConstraints[i] = pJobSystem->CreateJob("Setup Velocity Constraints", [&context, &step]()
                     {
+                        ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::SetupVelocityConstraints, step.m_stepIndex);
+
                         context.m_pPhysicsScene->JobSetupVelocityConstraints(context.m_stepDeltaTime, &step);
                         JobHandle::RemovedDependencies(step.m_solveVelocityConstraints);
                         
@@ -361,6 +507,8 @@ namespace nes
                 // Dependencies: determine active constraints, finishing building jobs.
                 step.m_buildIslandsFromConstraints = pJobSystem->CreateJob("Build Islands From Constraints", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::BuildIslandsFromConstraints, step.m_stepIndex);
+
                     context.m_pPhysicsScene->JobBuildIslandsFromConstraints(&context, &step);
 
                     step.m_findCollisions[0].RemoveDependency(); // The first collisions job cannot start running until we've finished building islands and activated all bodies.
@@ -375,6 +523,8 @@ namespace nes
                 {
                     step.m_determineActiveConstraints[i] = pJobSystem->CreateJob("Determine Active Constraints", [&context, &step]()
                     {
+                        ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::DetermineActiveConstraints, step.m_stepIndex);
+
                         context.m_pPhysicsScene->JobDetermineActiveConstraints(&step);
                         step.m_buildIslandsFromConstraints.RemoveDependency();
 
@@ -392,6 +542,8 @@ namespace nes
                 {
                     step.m_stepListeners[i] = pJobSystem->CreateJob("Step Listeners", [&context, &step]()
                     {
+                        ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::StepListeners, step.m_stepIndex);
+
                         // Call the step listeners
                         context.m_pPhysicsScene->JobStepListeners(&step);
 
@@ -410,6 +562,8 @@ namespace nes
                 // Dependencies: find Collisions, build islands from constraints, finish building jobs. 
                 step.m_finalizeIslands = pJobSystem->CreateJob("Finalize Islands", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::FinalizeIslands, step.m_stepIndex);
+
                     // Validate that all find collision jobs have stopped.
                     NES_ASSERT(step.m_activeFindCollisionJobs.load(std::memory_order_relaxed) == 0);
 
@@ -428,6 +582,8 @@ namespace nes
                 // Dependencies: find CCD contacts.
                 step.m_contactRemovedCallbacks = pJobSystem->CreateJob("Contact Removed Callbacks", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::ContactRemovedCallbacks, step.m_stepIndex);
+
                     context.m_pPhysicsScene->JobContactRemovedCallbacks(&step);
 
                     if (step.m_startNextStep.IsValid())
@@ -439,18 +595,23 @@ namespace nes
                 // Dependencies: finalize islands, finish building jobs.
                 step.m_bodySetIslandIndex = pJobSystem->CreateJob("Body Set Island Index", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::BodySetIslandIndex, step.m_stepIndex);
+
                     context.m_pPhysicsScene->JobBodySetIslandIndex();
 
                     JobHandle::RemovedDependencies(step.m_solvePositionConstraints);
                 }, 2);
 
                 // StartNextStep Job: kicks of the next collision step
-                // Dependencies: update soft bodies [TODO], contact removed callbacks, finish building the previous setp 
+                // Dependencies: solve position constraints, contact removed callbacks, finish building the previous step.
+                // [TODO]: Depend on the update soft bodies job instead of solve position constraints once soft bodies are supported.
                 if (!isLastStep)
                 {
                     PhysicsUpdateContext::Step* pNextStep = &context.m_steps[stepIndex + 1];
                     step.m_startNextStep = pJobSystem->CreateJob("Start Next Step", [this, pNextStep]()
                     {
+                        ScopedPhysicsJobTimer timer(pNextStep->m_pContext->m_pStepStats, EPhysicsJobType::StartNextStep, pNextStep->m_stepIndex - 1);
+
                     #ifdef NES_DEBUG
                         // Validate that the cached bounds are correct
                         m_bodyManager.Internal_ValidateActiveBodyBounds();
@@ -485,7 +646,7 @@ namespace nes
                             // Kick the step listeners job first
                             JobHandle::RemovedDependencies(pNextStep->m_stepListeners);
                         }
-                    }, 3);
+                    }, maxConcurrency + 2);
                 }
 
                 // Solve Velocity Constraints Job
@@ -495,6 +656,8 @@ namespace nes
                 {
                     step.m_solveVelocityConstraints[i] = pJobSystem->CreateJob("Solve Velocity Constraints", [&context, &step]()
                     {
+                        ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::SolveVelocityConstraints, step.m_stepIndex);
+
                         context.m_pPhysicsScene->JobSolveVelocityConstraints(&context, &step);
 
                         step.m_preIntegrateVelocity.RemoveDependency();
@@ -512,6 +675,8 @@ namespace nes
                 // Dependencies: broadphase update finalize, solve velocity constraints, finish building jobs.
                 step.m_preIntegrateVelocity = pJobSystem->CreateJob("Pre Integrate Velocity", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::PreIntegrateVelocity, step.m_stepIndex);
+
                     context.m_pPhysicsScene->JobPreIntegrateVelocity(&context, &step);
                     
                     JobHandle::RemovedDependencies(step.m_integrateVelocity);
@@ -528,6 +693,8 @@ namespace nes
                 {
                     step.m_integrateVelocity[i] = pJobSystem->CreateJob("Integrate Velocity", [&context, &step]()
                     {
+                        ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::IntegrateVelocity, step.m_stepIndex);
+
                         context.m_pPhysicsScene->JobIntegrateVelocity(&context, &step);
                         step.m_postIntegrateVelocity.RemoveDependency();
                     }, 2);
@@ -540,6 +707,8 @@ namespace nes
                 // Dependencies: integrate velocity, finish building jobs.
                 step.m_postIntegrateVelocity = pJobSystem->CreateJob("Post Integrate Velocity", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::PostIntegrateVelocity, step.m_stepIndex);
+
                     context.m_pPhysicsScene->JobPostIntegrateVelocity(&context, &step);
                     step.m_resolveCCDContacts.RemoveDependency();
                 }, numIntegrateVelocityJobs + 1);
@@ -551,6 +720,8 @@ namespace nes
                 // Dependencies: integrate velocities, detect CCD contacts (added dynamically), finish building jobs.
                 step.m_resolveCCDContacts = pJobSystem->CreateJob("Resolve CCD Contacts", [&context, &step]()
                 {
+                    ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::ResolveCCDContacts, step.m_stepIndex);
+
                     context.m_pPhysicsScene->JobResolveCCDContacts(&context, &step);
                     JobHandle::RemovedDependencies(step.m_solvePositionConstraints);
                 }, 2);
@@ -565,12 +736,14 @@ namespace nes
                 {
                     step.m_solvePositionConstraints[i] = pJobSystem->CreateJob("Solve Position Constraints", [&context, &step]()
                     {
+                        ScopedPhysicsJobTimer timer(context.m_pStepStats, EPhysicsJobType::SolvePositionConstraints, step.m_stepIndex);
+
                         context.m_pPhysicsScene->JobSolvePositionConstraints(&context, &step);
 
-                        // [TODO]: Soft Body:
+                        // [TODO]: Soft Body: kick the soft body prepare job instead.
                         // Start the next step
-                        //if (step.m_softBodyPrepare.IsValid()
-                        //  step.m_softBodyPrepare.RemoveDependency();
+                        if (step.m_startNextStep.IsValid())
+                            step.m_startNextStep.RemoveDependency();
                     }, 3);
                 }
 
@@ -696,11 +869,22 @@ namespace nes
         m_bodyManager.Internal_SetActiveBodiesLocked(false);
     #endif
 
+        // Add the bodies that skipped this update back to the active bodies.
+        FinalizeSimulationRegions(deltaTime);
+
         // Unlock all bodies
         m_bodyManager.UnlockAllBodies();
 
         // Unlock step listeners
         m_stepListenersMutex.unlock();
+
+        // Record the totals of this update.
+        if (m_stepStatsEnabled)
+        {
+            m_stepStats.m_numCollisionSteps = static_cast<uint32>(collisionSteps);
+            m_stepStats.Internal_EndUpdate(*pAllocator);
+            RecordSimulationRegionWallTimes();
+        }
         
         // Report any accumulated errors:
         const auto errors = static_cast<EPhysicsUpdateErrorCode>(context.m_errors.load(std::memory_order_acquire));
@@ -708,6 +892,99 @@ namespace nes
         return errors;
     }
 
+    void PhysicsScene::PrepareSimulationRegions(const float deltaTime)
+    {
+        NES_ASSERT(m_skippedBodies.empty() && m_timeScaledBodies.empty());
+        const uint32 updateIndex = m_simulationUpdateCount++;
+
+        // Determine which regions are simulated in this update. The regions are offset by their index, so that
+        // regions with the same interval are not all simulated in the same update.
+        bool isRegionSimulated[kMaxSimulationRegions];
+        bool isAnyRegionSkipped = false;
+        for (uint32 region = 0; region < kMaxSimulationRegions; ++region)
+        {
+            const uint32 interval = math::Max(1U, m_simulationRegionSettings[region].m_stepInterval);
+            isRegionSimulated[region] = (updateIndex + region) % interval == 0;
+            isAnyRegionSkipped |= !isRegionSimulated[region];
+
+            SimulationRegionStats& stats = m_simulationRegionStats[region];
+            stats = SimulationRegionStats();
+            if (isRegionSimulated[region])
+            {
+                stats.m_simulatedDeltaTime = deltaTime + m_simulationRegionSkippedTime[region];
+                m_simulationRegionSkippedTime[region] = 0.f;
+            }
+            else
+            {
+                m_simulationRegionSkippedTime[region] += deltaTime;
+            }
+        }
+
+        // When all regions are simulated every update, the active bodies only need to be visited to count them.
+        if (!isAnyRegionSkipped && !m_hasSimulationSkippedTime && !m_stepStatsEnabled)
+            return;
+
+        const BodyID* pActiveBodies = m_bodyManager.GetActiveBodiesUnsafe();
+        const uint32 numActiveBodies = m_bodyManager.GetNumActiveBodies();
+        for (uint32 i = 0; i < numActiveBodies; ++i)
+        {
+            Body& body = m_bodyManager.GetBody(pActiveBodies[i]);
+            MotionProperties* pMotionProps = body.GetMotionPropertiesUnchecked();
+            const uint32 region = pMotionProps->GetSimulationRegion();
+            SimulationRegionStats& stats = m_simulationRegionStats[region];
+
+            if (!isRegionSimulated[region])
+            {
+                m_skippedBodies.push_back(body.GetID());
+                ++stats.m_numSkippedBodies;
+                continue;
+            }
+
+            ++stats.m_numSimulatedBodies;
+
+            // Catch up on the updates that the body skipped by taking a larger step.
+            const float skippedTime = pMotionProps->Internal_GetSimulationSkippedTime();
+            if (skippedTime > 0.f)
+            {
+                pMotionProps->Internal_SetSimulationTimeScale(1.f + skippedTime / deltaTime);
+                pMotionProps->Internal_SetSimulationSkippedTime(0.f);
+                m_timeScaledBodies.push_back(body.GetID());
+            }
+        }
+
+        m_bodyManager.Internal_SkipBodiesSimulation(m_skippedBodies.data(), static_cast<int>(m_skippedBodies.size()));
+    }
+
+    void PhysicsScene::FinalizeSimulationRegions(const float deltaTime)
+    {
+        m_bodyManager.Internal_ResumeSkippedBodies(m_skippedBodies.data(), static_cast<int>(m_skippedBodies.size()), deltaTime);
+
+        for (const BodyID& bodyID : m_timeScaledBodies)
+            m_bodyManager.GetBody(bodyID).GetMotionPropertiesUnchecked()->Internal_SetSimulationTimeScale(1.f);
+
+        m_hasSimulationSkippedTime = !m_skippedBodies.empty();
+        m_skippedBodies.clear();
+        m_timeScaledBodies.clear();
+    }
+
+    void PhysicsScene::RecordSimulationRegionWallTimes()
+    {
+        uint32 numSimulatedBodies = 0;
+        for (const SimulationRegionStats& stats : m_simulationRegionStats)
+            numSimulatedBodies += stats.m_numSimulatedBodies;
+
+        const uint64 updateWallTime = m_stepStats.m_updateWallTime;
+        for (SimulationRegionStats& stats : m_simulationRegionStats)
+        {
+            if (stats.m_simulatedDeltaTime <= 0.f)
+                continue;
+
+            stats.m_stepWallTime = updateWallTime;
+            if (numSimulatedBodies > 0)
+                stats.m_wallTime = updateWallTime * stats.m_numSimulatedBodies / numSimulatedBodies;
+        }
+    }
+
     void PhysicsScene::JobStepListeners(PhysicsUpdateContext::Step* pStep)
     {
     #if NES_ASSERTS_ENABLED
@@ -802,6 +1079,12 @@ namespace nes
             // Calculate the end of the batch
             const uint32 activeBodyIndexEnd = math::Min(numActiveBodiesAtStepStart, activeBodyIndex + kApplyGravityBatchSize);
 
+            // Bodies that can move freely are updated 4 at a time.
+            MotionProperties* motionProps4[4];
+            Quat rotations4[4];
+            float deltaTimes4[4];
+            uint32 numBodies4 = 0;
+
             // Process the batch
             while (activeBodyIndex < activeBodyIndexEnd)
             {
@@ -811,14 +1094,34 @@ namespace nes
                     MotionProperties* pMotionProps = body.GetMotionPropertiesUnchecked();
                     const Quat rotation = body.GetRotation();
 
-                    if (body.GetApplyGyroscopicForce())
-                        pMotionProps->Internal_ApplyGyroscopicForce(rotation, deltaTime);
+                    // Bodies that catch up on skipped updates of their simulation region take a larger step.
+                    const float bodyDeltaTime = deltaTime * pMotionProps->Internal_GetSimulationTimeScale();
+
+                    if (body.GetApplyGyroscopicForce() || pMotionProps->GetAllowedDOFs() != EAllowedDOFs::All)
+                    {
+                        if (body.GetApplyGyroscopicForce())
+                            pMotionProps->Internal_ApplyGyroscopicForce(rotation, bodyDeltaTime);
 
-                    pMotionProps->Internal_ApplyForceTorqueAndDrag(rotation, m_gravity, deltaTime);
+                        pMotionProps->Internal_ApplyForceTorqueAndDrag(rotation, m_gravity, bodyDeltaTime);
+                    }
+                    else
+                    {
+                        motionProps4[numBodies4] = pMotionProps;
+                        rotations4[numBodies4] = rotation;
+                        deltaTimes4[numBodies4] = bodyDeltaTime;
+                        if (++numBodies4 == 4)
+                        {
+                            MotionProperties::Internal_ApplyForceTorqueAndDrag4(motionProps4, rotations4, deltaTimes4, numBodies4, m_gravity);
+                            numBodies4 = 0;
+                        }
+                    }
                 }
 
                 ++activeBodyIndex;
             }
+
+            if (numBodies4 > 0)
+                MotionProperties::Internal_ApplyForceTorqueAndDrag4(motionProps4, rotations4, deltaTimes4, numBodies4, m_gravity);
         }
     }
 
@@ -896,6 +1199,12 @@ namespace nes
                 const uint32 activeBodiesReadIndexEnd = math::Min(numActiveBodies, activeBodiesReadIndex + kActiveBodiesBatchSize);
                 if (pStep->m_activeBodyReadIndex.compare_exchange_strong(activeBodiesReadIndex, activeBodiesReadIndexEnd))
                 {
+                    // If there are more batches waiting, let other jobs claim them while we run this one through the broadphase.
+                    // Bodies can be activated during the step (e.g. a sleeping pile that is hit), and without this they would only
+                    // be picked up by the jobs that are already running until enough body pairs are queued to spawn new ones.
+                    if (numActiveBodies - activeBodiesReadIndexEnd >= static_cast<uint32>(kActiveBodiesBatchSize))
+                        TrySpawnJobFindCollisions(pStep);
+
                     // Callback when a new body pair is found
                     class MyBodyPairCallback : public BodyPairCollector
                     {
@@ -1059,27 +1368,36 @@ namespace nes
             if (checkSplitIslands)
             {
                 bool firstIteration;
+                bool isParallel;
                 uint splitIslandIndex;
                 uint32* pConstraintsBegin;
                 uint32* pConstraintsEnd;
                 uint32* pContactsBegin;
                 uint32* pContactsEnd;
-                switch (m_largeIslandSplitter.FetchNextBatch(splitIslandIndex, pConstraintsBegin, pConstraintsEnd, pContactsBegin, pContactsEnd, firstIteration))
+                switch (m_largeIslandSplitter.FetchNextBatch(splitIslandIndex, pConstraintsBegin, pConstraintsEnd, pContactsBegin, pContactsEnd, firstIteration, isParallel))
                 {
                     case LargeIslandSplitter::EStatus::BatchRetrieved:
                     {
+                        // The contacts of a parallel batch don't share dynamic bodies, so they can be solved 4 at a time.
+                        const bool solveIndependent = isParallel && m_physicsSettings.m_useSIMDContactSolver;
                         if (firstIteration)
                         {
                             // Iteration 0 is used to warm start the batch (we added 1 to the number of iterations in LargeIslandSplitter::SplitIsland()).
                             DummyCalculateSolverSteps dummy;
                             ConstraintManager::WarmStartVelocityConstraints(pActiveConstraints, pConstraintsBegin, pConstraintsEnd, warmStartImpulseRatio, dummy);
-                            m_contactManager.WarmStartVelocityConstraints(pContactsBegin, pContactsEnd, warmStartImpulseRatio, dummy);
+                            if (solveIndependent)
+                                m_contactManager.WarmStartIndependentVelocityConstraints(pContactsBegin, pContactsEnd, warmStartImpulseRatio);
+                            else
+                                m_contactManager.WarmStartVelocityConstraints(pContactsBegin, pContactsEnd, warmStartImpulseRatio, dummy);
                         }
                         else
                         {
                             // Solve velocity constraints
                             ConstraintManager::SolveVelocityConstraints(pActiveConstraints, pConstraintsBegin, pConstraintsEnd, deltaTime);
-                            m_contactManager.SolveVelocityConstraints(pContactsBegin, pContactsEnd);
+                            if (solveIndependent)
+                                m_contactManager.SolveIndependentVelocityConstraints(pContactsBegin, pContactsEnd);
+                            else
+                                m_contactManager.SolveVelocityConstraints(pContactsBegin, pContactsEnd);
                         }
 
                         // Mark this batch as processed
@@ -1154,7 +1472,7 @@ namespace nes
                 }
 
                 // Split up the large islands
-                CalculateSolverSteps stepsCalculator(m_physicsSettings);
+                CalculateSolverSteps stepsCalculator(m_physicsSettings, m_simulationRegionSettings);
                 if (m_physicsSettings.m_useLargeIslandSplitter
                     && m_largeIslandSplitter.SplitIsland(islandIndex, m_islandBuilder, m_bodyManager, m_contactManager, pActiveConstraints, stepsCalculator))
                     continue; // If this is split, loop again to fetch the newly split island.
@@ -1217,6 +1535,36 @@ namespace nes
 
         // Prepare the split island build for solving the position constraints.
         m_largeIslandSplitter.PrepareForSolverPositions();
+
+        // Record the island counters of this step. The islands and splits are final at this point.
+        if (PhysicsStepStats* pStats = pContext->m_pStepStats)
+        {
+            const uint32 numIslands = m_islandBuilder.GetNumIslands();
+            pStats->m_numIslands += numIslands;
+            for (uint32 islandIndex = 0; islandIndex < numIslands; ++islandIndex)
+            {
+                BodyID* pBodiesBegin;
+                BodyID* pBodiesEnd;
+                m_islandBuilder.GetBodiesInIsland(islandIndex, pBodiesBegin, pBodiesEnd);
+                pStats->m_maxBodiesInIsland = math::Max(pStats->m_maxBodiesInIsland, static_cast<uint32>(pBodiesEnd - pBodiesBegin));
+
+                uint32 numConstraints = 0;
+                uint32* pBegin;
+                uint32* pEnd;
+                if (m_islandBuilder.GetConstraintsInIsland(islandIndex, pBegin, pEnd))
+                    numConstraints += static_cast<uint32>(pEnd - pBegin);
+                if (m_islandBuilder.GetContactsInIsland(islandIndex, pBegin, pEnd))
+                    numConstraints += static_cast<uint32>(pEnd - pBegin);
+                pStats->m_maxConstraintsInIsland = math::Max(pStats->m_maxConstraintsInIsland, numConstraints);
+            }
+
+            const uint numSplitIslands = m_largeIslandSplitter.GetNumSplitIslands();
+            pStats->m_numSplitIslands += numSplitIslands;
+            for (uint splitIslandIndex = 0; splitIslandIndex < numSplitIslands; ++splitIslandIndex)
+            {
+                pStats->m_numSplits += m_largeIslandSplitter.GetNumSplits(splitIslandIndex);
+            }
+        }
     }
 
     void PhysicsScene::JobIntegrateVelocity(const PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep)
@@ -1246,15 +1594,15 @@ namespace nes
             // Calculate the end of the batch
             const uint32 activeBodyIndexEnd = math::Min(numActiveBodies, activeBodyIndex + kIntegrateVelocityBatchSize);
 
-            // Process the batch
-            while (activeBodyIndex < activeBodyIndexEnd)
+            // Clamp the velocities and update the rotations first, the rotations 4 bodies at a time. The rotation
+            // is integrated before the position, see the comment below.
+            Body* bodies[kIntegrateVelocityBatchSize];
+            Vec3 rotationSteps[kIntegrateVelocityBatchSize];
+            const uint32 batchStart = activeBodyIndex;
+            const uint32 numBodies = activeBodyIndexEnd - batchStart;
+            for (uint32 i = 0; i < numBodies; ++i)
             {
-                // Update the positions using a Symplectic Euler step (which integrates using the updated velocity v1' rather
-                // than the original velocity v1):
-                // x1' = x1 + h * v1'
-                // At this point the active bodies array does not change, so it is safe to access the array.
-                BodyID bodyID = pActiveBodies[activeBodyIndex];
-                Body& body = m_bodyManager.GetBody(bodyID);
+                Body& body = m_bodyManager.GetBody(pActiveBodies[batchStart + i]);
                 MotionProperties* pMotionProps = body.GetMotionProperties();
 
                 // Clamp velocities (not for kinematic bodies).
@@ -1264,7 +1612,24 @@ namespace nes
                     pMotionProps->ClampAngularVelocity();
                 }
 
-                // Update the rotation of the body according to the angular velocity.
+                bodies[i] = &body;
+                rotationSteps[i] = body.GetAngularVelocity() * (deltaTime * pMotionProps->Internal_GetSimulationTimeScale());
+            }
+            for (uint32 i = 0; i < numBodies; i += 4)
+                Body::Internal_AddRotationStep4(bodies + i, rotationSteps + i, math::Min(4u, numBodies - i));
+
+            // Process the batch
+            while (activeBodyIndex < activeBodyIndexEnd)
+            {
+                // Update the positions using a Symplectic Euler step (which integrates using the updated velocity v1' rather
+                // than the original velocity v1):
+                // x1' = x1 + h * v1'
+                // At this point the active bodies array does not change, so it is safe to access the array.
+                BodyID bodyID = pActiveBodies[activeBodyIndex];
+                Body& body = *bodies[activeBodyIndex - batchStart];
+                MotionProperties* pMotionProps = body.GetMotionProperties();
+
+                // The rotation of the body has already been updated according to the angular velocity.
                 // For motion type discrete we need to do this anyway, for motion type linear cast we have multiple options:
                 // 1. Rotate the body first, then sweep.
                 // 2. First sweep and then rotation the body at the end.
@@ -1278,10 +1643,10 @@ namespace nes
                 // negative side effects too as simulating the rotation first may cause it to tunnel through a small object that the linear cast might
                 // have otherwise detected. In any case, a linear cast is not good for detecting tunneling due to angular rotation, so we don't care
                 // about that too much (you'd need a full cast to take angular effects into account).
-                body.Internal_AddRotationStep(body.GetAngularVelocity() * deltaTime);
+                const float bodyDeltaTime = deltaTime * pMotionProps->Internal_GetSimulationTimeScale();
 
                 // Get the delta position
-                Vec3 deltaPos = body.GetLinearVelocity() * deltaTime;
+                Vec3 deltaPos = body.GetLinearVelocity() * bodyDeltaTime;
 
                 // If the position should be updated (or if it is delayed because of CCD).
                 bool updatePosition = true;
@@ -1367,14 +1732,65 @@ namespace nes
         }
         else
         {
+            // Sort the CCD bodies on collision layer and position, so that the bodies in a batch of a find CCD
+            // contacts job are likely to be close together and can share a single broadphase query.
+            // The bodies are stored in the order in which they were integrated, which is not deterministic, so
+            // the body ID is used to break ties.
+            const uint32 numCCDBodies = pStep->m_numCCDBodies;
+            const CCDBody* pCCDBodies = pStep->m_pCCDBodies;
+            StackAllocator* pAllocator = pContext->m_pAllocator;
+            NES_ASSERT(pStep->m_pCCDBodyOrder == nullptr);
+            pStep->m_pCCDBodyOrder = static_cast<uint32*>(pAllocator->Allocate(numCCDBodies * sizeof(uint32)));
+            {
+            #if NES_ASSERTS_ENABLED
+                // We only read positions. The grant must end before the jobs are created, they can run on this thread.
+                BodyAccess::GrantScope grant(BodyAccess::EAccess::None, BodyAccess::EAccess::Read);
+            #endif
+
+                // Calculate the bounds of the start positions, relative to the first body so that we don't lose precision.
+                const RVec3 baseOffset = m_bodyManager.GetBody(pCCDBodies[0].m_bodyID1).GetCenterOfMassPosition();
+                AABox positionBounds;
+                for (uint32 i = 0; i < numCCDBodies; ++i)
+                {
+                    positionBounds.Encapsulate(Vec3(m_bodyManager.GetBody(pCCDBodies[i].m_bodyID1).GetCenterOfMassPosition() - baseOffset));
+                }
+
+                // The sort key has the collision layer in the high bits (bodies in a batch need to use the same layer filters),
+                // and a morton code of the position quantized to 10 bits per axis in the low bits.
+                const Vec3 scale = Vec3::Replicate(1023.f) / Vec3::Max(positionBounds.Size(), Vec3::Replicate(1.0e-6f));
+                uint64* pKeys = static_cast<uint64*>(pAllocator->Allocate(numCCDBodies * sizeof(uint64)));
+                for (uint32 i = 0; i < numCCDBodies; ++i)
+                {
+                    const Body& body = m_bodyManager.GetBody(pCCDBodies[i].m_bodyID1);
+                    const Vec3 quantized = (Vec3(body.GetCenterOfMassPosition() - baseOffset) - positionBounds.m_min) * scale;
+                    const uint32 mortonCode = (ExpandBitsForMortonCode(math::Min(static_cast<uint32>(quantized.x), 1023U)) << 2)
+                        | (ExpandBitsForMortonCode(math::Min(static_cast<uint32>(quantized.y), 1023U)) << 1)
+                        | ExpandBitsForMortonCode(math::Min(static_cast<uint32>(quantized.z), 1023U));
+                    pKeys[i] = (static_cast<uint64>(body.GetCollisionLayer()) << 32) | mortonCode;
+                    pStep->m_pCCDBodyOrder[i] = i;
+                }
+
+                QuickSort(pStep->m_pCCDBodyOrder, pStep->m_pCCDBodyOrder + numCCDBodies, [pKeys, pCCDBodies](const uint32 left, const uint32 right)
+                {
+                    if (pKeys[left] != pKeys[right])
+                        return pKeys[left] < pKeys[right];
+
+                    return pCCDBodies[left].m_bodyID1 < pCCDBodies[right].m_bodyID1;
+                });
+
+                pAllocator->Free(pKeys, numCCDBodies * sizeof(uint64));
+            }
+            
             // Run the continuous collision detection jobs
-            const int numCCDJobs = math::Min(static_cast<int>(pStep->m_numCCDBodies + kNumCCDBodiesPerJob - 1) / kNumCCDBodiesPerJob, pContext->GetMaxConcurrency());
+            const int numCCDJobs = math::Min(static_cast<int>((numCCDBodies + kNumCCDBodiesPerBatch - 1) / kNumCCDBodiesPerBatch), pContext->GetMaxConcurrency());
             pStep->m_resolveCCDContacts.AddDependency(numCCDJobs);
             pStep->m_contactRemovedCallbacks.AddDependency(numCCDJobs - 1); // Already had 1 dependency.
             for (int i = 0; i < numCCDJobs; ++i)
             {
                 JobHandle job = pContext->m_pJobSystem->CreateJob("Find CCD Contacts", [pContext, pStep]
                 {
+                    ScopedPhysicsJobTimer timer(pContext->m_pStepStats, EPhysicsJobType::FindCCDContacts, pStep->m_stepIndex);
+
                     pContext->m_pPhysicsScene->JobFindCCDContacts(pContext, pStep);
                     
                     pStep->m_resolveCCDContacts.RemoveDependency();
@@ -1405,337 +1821,529 @@ namespace nes
         settings.m_collectFacesMode = ECollectFacesMode::CollectFaces;
         settings.m_activeEdgeMode = m_physicsSettings.m_checkActiveEdges? EActiveEdgeMode::CollideOnlyWithActive : EActiveEdgeMode::CollideWithAll;
 
-        for (;;)
+        // Create a collector that will find the maximum distance allowed to travel while not penetrating more than 'max penetration'.
+        class CCDNarrowPhaseCollector : public CastShapeCollector
         {
-            // Fetch the next body to cast
-            uint32 index = pStep->m_nextCCDBody++;
-            if (index >= pStep->m_numCCDBodies)
-                break;
-
-            CCDBody& ccdBody = pStep->m_pCCDBodies[index];
-            const Body& body = m_bodyManager.GetBody(ccdBody.m_bodyID1);
-
-            // Filter out layers
-            DefaultBroadPhaseLayerFilter broadPhaseFilter = GetDefaultBroadPhaseFilter(body.GetCollisionLayer());
-            DefaultCollisionLayerFilter collisionLayerFilter = GetDefaultCollisionLayerFilter(body.GetCollisionLayer());
-
-            // Create a collector that will find the maximum distance allowed to travel while not penetrating more than 'max penetration'.
-            class CCDNarrowPhaseCollector : public CastShapeCollector
+        public:
+            CCDNarrowPhaseCollector(const BodyManager& bodyManager, ContactConstraintManager& contactConstraintManager, CCDBody& ccdBody, ShapeCastResult& result, const float deltaTime)
+                : m_bodyManager(bodyManager)
+                , m_contactConstraintManager(contactConstraintManager)
+                , m_ccdBody(ccdBody)
+                , m_result(result)
+                , m_deltaTime(deltaTime)
             {
-            public:
-                CCDNarrowPhaseCollector(const BodyManager& bodyManager, ContactConstraintManager& contactConstraintManager, CCDBody& ccdBody, ShapeCastResult& result, const float deltaTime)
-                    : m_bodyManager(bodyManager)
-                    , m_contactConstraintManager(contactConstraintManager)
-                    , m_ccdBody(ccdBody)
-                    , m_result(result)
-                    , m_deltaTime(deltaTime)
-                {
-                    //
-                }
+                //
+            }
 
-                virtual void AddHit(const ShapeCastResult& result) override
+            virtual void AddHit(const ShapeCastResult& result) override
+            {
+                // Check if this is a possible earlier hit than the one before
+                const float fraction = result.m_fraction;
+                if (fraction < m_ccdBody.m_hitFractionPlusSlop)
                 {
-                    // Check if this is a possible earlier hit than the one before
-                    const float fraction = result.m_fraction;
-                    if (fraction < m_ccdBody.m_hitFractionPlusSlop)
+                    // Normalize the normal
+                    Vec3 normal = result.m_penetrationAxis.Normalized();
+
+                    // Calculate how much we can add to the fraction to penetrate the collision point by m_maxPenetration.
+                    // Note that the normal is pointing to Body 2!
+                    // Let the extra distance that we can travel along deltaPos be 'dist' : m_maxPenetration / dist = cos(angle between normal and deltaPos) = normal . deltaPos / |deltaPos|
+                    // <=> dist = m_maxPenetration * |deltaPos| / normal . deltaPos
+                    // Converting to a fraction: deltaFraction = dist / |deltaPos| = m_linearCastThreshold / normal . delatPos
+                    const float denominator = normal.Dot(m_ccdBody.m_deltaPosition);
+                    if (denominator > m_ccdBody.m_maxPenetration) // avoid dividing by zero, if extra hit fraction > 1 there's also no point in continuing.
                     {
-                        // Normalize the normal
-                        Vec3 normal = result.m_penetrationAxis.Normalized();
-
-                        // Calculate how much we can add to the fraction to penetrate the collision point by m_maxPenetration.
-                        // Note that the normal is pointing to Body 2!
-                        // Let the extra distance that we can travel along deltaPos be 'dist' : m_maxPenetration / dist = cos(angle between normal and deltaPos) = normal . deltaPos / |deltaPos|
-                        // <=> dist = m_maxPenetration * |deltaPos| / normal . deltaPos
-                        // Converting to a fraction: deltaFraction = dist / |deltaPos| = m_linearCastThreshold / normal . delatPos
-                        const float denominator = normal.Dot(m_ccdBody.m_deltaPosition);
-                        if (denominator > m_ccdBody.m_maxPenetration) // avoid dividing by zero, if extra hit fraction > 1 there's also no point in continuing.
+                        const float fractionPlusSlop = fraction + m_ccdBody.m_maxPenetration / denominator;
+                        if (fractionPlusSlop < m_ccdBody.m_hitFractionPlusSlop)
                         {
-                            const float fractionPlusSlop = fraction + m_ccdBody.m_maxPenetration / denominator;
-                            if (fractionPlusSlop < m_ccdBody.m_hitFractionPlusSlop)
-                            {
-                                const Body& body2 = m_bodyManager.GetBody(result.m_bodyID2);
+                            const Body& body2 = m_bodyManager.GetBody(result.m_bodyID2);
 
-                                // Check if we've already accepted all hits from this body
-                                if (m_validateBodyPair)
+                            // Check if we've already accepted all hits from this body
+                            if (m_validateBodyPair)
+                            {
+                                // Validate the contact result
+                                const Body& body1 = m_bodyManager.GetBody(m_ccdBody.m_bodyID1);
+                                // Note that the center of mass of body 1 is the start of the sweep and is used as the base offset below.
+                                const EValidateContactResult validateResult = m_contactConstraintManager.ValidateContactPoint(body1, body2, body1.GetCenterOfMassPosition(), result);
+                                switch (validateResult)
                                 {
-                                    // Validate the contact result
-                                    const Body& body1 = m_bodyManager.GetBody(m_ccdBody.m_bodyID1);
-                                    // Note that the center of mass of body 1 is the start of the sweep and is used as the base offset below.
-                                    const EValidateContactResult validateResult = m_contactConstraintManager.ValidateContactPoint(body1, body2, body1.GetCenterOfMassPosition(), result);
-                                    switch (validateResult)
+                                    case EValidateContactResult::AcceptContact:
                                     {
-                                        case EValidateContactResult::AcceptContact:
-                                        {
-                                            // Continue
-                                            break;
-                                        }
-
-                                        case EValidateContactResult::AcceptAllContactsForThisBodyPair:
-                                        {
-                                            // Accept this and all following contacts from this body
-                                            m_validateBodyPair = true;
-                                            break;
-                                        }
-
-                                        case EValidateContactResult::RejectContact:
-                                            return;
-
-                                        case EValidateContactResult::RejectAllContactsForThisBodyPair:
-                                        {
-                                            // Reject this an all following contacts from this body.
-                                            m_rejectAll = true;
-                                            ForceEarlyOut();
-                                            return;
-                                        }
+                                        // Continue
+                                        break;
                                     }
-                                }
 
-                                // This is the earliest hit so far, store it.
-                                m_ccdBody.m_contactNormal = normal;
-                                m_ccdBody.m_bodyID2 = result.m_bodyID2;
-                                m_ccdBody.m_subShapeID2 = result.m_subShapeID2;
-                                m_ccdBody.m_hitFraction = fraction;
-                                m_ccdBody.m_hitFractionPlusSlop = fractionPlusSlop;
-                                m_result = result;
-
-                                // Result was assuming that body 2 is not moving, but it is, so we need to correct for it.
-                                Vec3 movement2 = fraction * CalculateBodyMotion(body2, m_deltaTime);
-                                if (!movement2.IsNearZero())
-                                {
-                                    m_result.m_contactPointOn1 += movement2;
-                                    m_result.m_contactPointOn2 += movement2;
-                                    for (Vec3& v : m_result.m_shape1Face)
+                                    case EValidateContactResult::AcceptAllContactsForThisBodyPair:
                                     {
-                                        v += movement2;
+                                        // Accept this and all following contacts from this body
+                                        m_validateBodyPair = true;
+                                        break;
                                     }
-                                    for (Vec3& v : m_result.m_shape2Face)
+
+                                    case EValidateContactResult::RejectContact:
+                                        return;
+
+                                    case EValidateContactResult::RejectAllContactsForThisBodyPair:
                                     {
-                                        v += movement2;
+                                        // Reject this an all following contacts from this body.
+                                        m_rejectAll = true;
+                                        ForceEarlyOut();
+                                        return;
                                     }
                                 }
+                            }
 
-                                // Update the early out fraction
-                                UpdateEarlyOutFraction(fractionPlusSlop);
+                            // This is the earliest hit so far, store it.
+                            m_ccdBody.m_contactNormal = normal;
+                            m_ccdBody.m_bodyID2 = result.m_bodyID2;
+                            m_ccdBody.m_subShapeID2 = result.m_subShapeID2;
+                            m_ccdBody.m_hitFraction = fraction;
+                            m_ccdBody.m_hitFractionPlusSlop = fractionPlusSlop;
+                            m_result = result;
+
+                            // Result was assuming that body 2 is not moving, but it is, so we need to correct for it.
+                            Vec3 movement2 = fraction * CalculateBodyMotion(body2, m_deltaTime);
+                            if (!movement2.IsNearZero())
+                            {
+                                m_result.m_contactPointOn1 += movement2;
+                                m_result.m_contactPointOn2 += movement2;
+                                for (Vec3& v : m_result.m_shape1Face)
+                                {
+                                    v += movement2;
+                                }
+                                for (Vec3& v : m_result.m_shape2Face)
+                                {
+                                    v += movement2;
+                                }
                             }
+
+                            // Update the early out fraction
+                            UpdateEarlyOutFraction(fractionPlusSlop);
                         }
                     }
                 }
+            }
 
-                bool                        m_validateBodyPair; /// If we still have to call the ValidateContactPoint for this body pair.
-                bool                        m_rejectAll;        /// Reject all further contacts between this body pair.
-                
-            private:
-                const BodyManager&          m_bodyManager;
-                ContactConstraintManager&   m_contactConstraintManager;
-                CCDBody&                    m_ccdBody;
-                ShapeCastResult&            m_result;
-                float                       m_deltaTime;
-                BodyID                      m_acceptedBodyID;
-            };
-
-            // Narrow phase collector
-            ShapeCastResult castShapeResult;
-            CCDNarrowPhaseCollector npCollector(m_bodyManager, m_contactManager, ccdBody, castShapeResult, pContext->m_stepDeltaTime);
-
-            // This collector wraps the narrow phase collector and collects the closest hit.
-            class CCDBroadPhaseCollector : public CastShapeBodyCollector
+            bool                        m_validateBodyPair; /// If we still have to call the ValidateContactPoint for this body pair.
+            bool                        m_rejectAll;        /// Reject all further contacts between this body pair.
+            
+        private:
+            const BodyManager&          m_bodyManager;
+            ContactConstraintManager&   m_contactConstraintManager;
+            CCDBody&                    m_ccdBody;
+            ShapeCastResult&            m_result;
+            float                       m_deltaTime;
+            BodyID                      m_acceptedBodyID;
+        };
+
+        // This collector wraps the narrow phase collector and collects the closest hit.
+        class CCDBroadPhaseCollector : public CastShapeBodyCollector
+        {
+        public:
+            CCDBroadPhaseCollector(const CCDBody& ccdBody, const Body& body1, const RShapeCast& shapeCast, ShapeCastSettings& shapeCastSettings, Internal_SimShapeFilterWrapper& shapeFilter, CCDNarrowPhaseCollector& collector, const BodyManager& bodyManager, PhysicsUpdateContext::Step* pStep, float deltaTime)
+                : m_ccdBody(ccdBody)
+                , m_body1(body1)
+                , m_body1Extent(shapeCast.m_shapeWorldBounds.Extent())
+                , m_shapeCast(shapeCast)
+                , m_shapeCastSettings(shapeCastSettings)
+                , m_shapeFilter(shapeFilter)
+                , m_collector(collector)
+                , m_bodyManager(bodyManager)
+                , m_pStep(pStep)
+                , m_deltaTime(deltaTime)
             {
-            public:
-                CCDBroadPhaseCollector(const CCDBody& ccdBody, const Body& body1, const RShapeCast& shapeCast, ShapeCastSettings& shapeCastSettings, Internal_SimShapeFilterWrapper& shapeFilter, CCDNarrowPhaseCollector& collector, const BodyManager& bodyManager, PhysicsUpdateContext::Step* pStep, float deltaTime)
-                    : m_ccdBody(ccdBody)
-                    , m_body1(body1)
-                    , m_shapeCast(shapeCast)
-                    , m_shapeCastSettings(shapeCastSettings)
-                    , m_shapeFilter(shapeFilter)
-                    , m_collector(collector)
-                    , m_bodyManager(bodyManager)
-                    , m_pStep(pStep)
-                    , m_deltaTime(deltaTime)
+                //
+            }
+
+            virtual void AddHit(const BroadPhaseCastResult& result) override
+            {
+                NES_ASSERT(result.m_fraction <= GetEarlyOutFraction(), "This hit should not have been passed on to the collector!");
+                ++m_numCandidatesTested;
+
+                // Test if we're colliding with ourselves
+                if (m_body1.GetID() == result.m_bodyID)
+                    return;
+
+                // Avoid treating duplicates, if both bodies are doing CCD then only consider collision detection if bodyID < other bodyID.
+                const Body& body2 = m_bodyManager.GetBody(result.m_bodyID);
+                const CCDBody* pCCDBody2 = GetCCDBody(body2, m_pStep);
+                if (pCCDBody2 != nullptr && m_ccdBody.m_bodyID1 > pCCDBody2->m_bodyID1)
+                    return;
+
+                // Test group filter
+                if (!m_body1.GetCollisionGroup().CanCollide(body2.GetCollisionGroup()))
+                    return;
+
+                // TODO: For now, we ignore sensors.
+                if (body2.IsSensor())
+                    return;
+
+                // Get relative movement of these two bodies
+                Vec3 direction = m_shapeCast.m_direction - CalculateBodyMotion(body2, m_deltaTime);
+
+                // Test if the remaining movement is less than our movement threshold
+                if (direction.LengthSqr() < m_ccdBody.m_linearCastThresholdSqr)
+                    return;
+
+                // Get the bounds of 2, widen it by the extent of 1 and test a ray to see if it hits earlier than the current early out fraction.
+                AABox bounds = body2.GetWorldSpaceBounds();
+                bounds.m_min -= m_body1Extent;
+                bounds.m_max += m_body1Extent;
+                const float hitFraction = RayAABox(Vec3(m_shapeCast.m_centerOfMassStart.GetTranslation()), RayInvDirection(direction), bounds.m_min, bounds.m_max);
+                if (hitFraction > GetPositiveEarlyOutFraction()) // If the early out fraction was <= 0, we have the possibility of finding a deeper hit so we need to clamp the early out fraction
+                    return;
+
+                // Reset the collector (this is a new body pair).
+                m_collector.ResetEarlyOutFraction(GetEarlyOutFraction());
+                m_collector.m_validateBodyPair = true;
+                m_collector.m_rejectAll = false;
+
+                // Set the body ID on the shape filter
+                m_shapeFilter.SetBody2(&body2);
+
+                // Provide the direction as a hint for the active-edges algorithm.
+                m_shapeCastSettings.m_activeEdgeMovementDirection = direction;
+
+                // Do the narrow phase collision check:
+                RShapeCast relativeCast(m_shapeCast.m_pShape, m_shapeCast.m_scale, m_shapeCast.m_centerOfMassStart, direction, m_shapeCast.m_shapeWorldBounds);
+                body2.GetTransformedShape().CastShape(relativeCast, m_shapeCastSettings, m_shapeCast.m_centerOfMassStart.GetTranslation(), m_collector, m_shapeFilter.GetFilter());
+
+                // Update the early out fraction
+                if (!m_collector.m_rejectAll)
+                    UpdateEarlyOutFraction(m_collector.GetEarlyOutFraction());
+            }
+            
+            const CCDBody&                  m_ccdBody;
+            const Body&                     m_body1;
+            Vec3                            m_body1Extent;
+            RShapeCast                      m_shapeCast;
+            ShapeCastSettings&              m_shapeCastSettings;
+            Internal_SimShapeFilterWrapper& m_shapeFilter;
+            CCDNarrowPhaseCollector&        m_collector;
+            const BodyManager&              m_bodyManager;
+            PhysicsUpdateContext::Step*     m_pStep;
+            float                           m_deltaTime;
+            uint32                          m_numCandidatesTested = 0;
+        };
+
+        // This collector collects the bodies that the bodies of a batch can hit, so that they can share a single broadphase query.
+        class CCDBatchCollector : public CollideShapeBodyCollector
+        {
+        public:
+            explicit CCDBatchCollector(BroadPhaseCastResult* pCandidates)
+                : m_pCandidates(pCandidates)
+            {
+                //
+            }
+
+            virtual void AddHit(const BodyID& bodyID) override
+            {
+                if (m_numCandidates < kMaxCCDBatchCandidates)
                 {
-                    //
+                    m_pCandidates[m_numCandidates++].m_bodyID = bodyID;
                 }
-
-                virtual void AddHit(const BroadPhaseCastResult& result) override
+                else
                 {
-                    NES_ASSERT(result.m_fraction <= GetEarlyOutFraction(), "This hit should not have been passed on to the collector!");
-
-                    // Test if we're colliding with ourselves
-                    if (m_body1.GetID() == result.m_bodyID)
-                        return;
-
-                    // Avoid treating duplicates, if both bodies are doing CCD then only consider collision detection if bodyID < other bodyID.
-                    const Body& body2 = m_bodyManager.GetBody(result.m_bodyID);
-                    const CCDBody* pCCDBody2 = GetCCDBody(body2, m_pStep);
-                    if (pCCDBody2 != nullptr && m_ccdBody.m_bodyID1 > pCCDBody2->m_bodyID1)
-                        return;
-
-                    // Test group filter
-                    if (!m_body1.GetCollisionGroup().CanCollide(body2.GetCollisionGroup()))
-                        return;
-
-                    // TODO: For now, we ignore sensors.
-                    if (body2.IsSensor())
-                        return;
-
-                    // Get relative movement of these two bodies
-                    Vec3 direction = m_shapeCast.m_direction - CalculateBodyMotion(body2, m_deltaTime);
-
-                    // Test if the remaining movement is less than our movement threshold
-                    if (direction.LengthSqr() < m_ccdBody.m_linearCastThresholdSqr)
-                        return;
-
-                    // Get the bounds of 2, widen it by the extent of 1 and test a ray to see if it hits earlier than the current early out fraction.
-                    AABox bounds = body2.GetWorldSpaceBounds();
-                    bounds.m_min -= m_body1Extent;
-                    bounds.m_max += m_body1Extent;
-                    const float hitFraction = RayAABox(Vec3(m_shapeCast.m_centerOfMassStart.GetTranslation()), RayInvDirection(direction), bounds.m_min, bounds.m_max);
-                    if (hitFraction > GetPositiveEarlyOutFraction()) // If the early out fraction was <= 0, we have the possibility of finding a deeper hit so we need to clamp the early out fraction
-                        return;
-
-                    // Reset the collector (this is a new body pair).
-                    m_collector.ResetEarlyOutFraction(GetEarlyOutFraction());
-                    m_collector.m_validateBodyPair = true;
-                    m_collector.m_rejectAll = false;
-
-                    // Set the body ID on the shape filter
-                    m_shapeFilter.SetBody2(&body2);
-
-                    // Provide the direction as a hint for the active-edges algorithm.
-                    m_shapeCastSettings.m_activeEdgeMovementDirection = direction;
-
-                    // Do the narrow phase collision check:
-                    RShapeCast relativeCast(m_shapeCast.m_pShape, m_shapeCast.m_scale, m_shapeCast.m_centerOfMassStart, direction, m_shapeCast.m_shapeWorldBounds);
-                    body2.GetTransformedShape().CastShape(relativeCast, m_shapeCastSettings, m_shapeCast.m_centerOfMassStart.GetTranslation(), m_collector, m_shapeFilter.GetFilter());
-
-                    // Update the early out fraction
-                    if (!m_collector.m_rejectAll)
-                        UpdateEarlyOutFraction(m_collector.GetEarlyOutFraction());
+                    // Too many candidates, the bodies of the batch will be cast separately.
+                    m_hasOverflowed = true;
+                    ForceEarlyOut();
                 }
-                
-                const CCDBody&                  m_ccdBody;
-                const Body&                     m_body1;
-                Vec3                            m_body1Extent;
-                RShapeCast                      m_shapeCast;
-                ShapeCastSettings&              m_shapeCastSettings;
-                Internal_SimShapeFilterWrapper& m_shapeFilter;
-                CCDNarrowPhaseCollector&        m_collector;
-                const BodyManager&              m_bodyManager;
-                PhysicsUpdateContext::Step*     m_pStep;
-                float                           m_deltaTime;
-            };
+            }
 
-            // Create the shape filter
-            Internal_SimShapeFilterWrapper shapeFilter(m_pSimShapeFilter, &body);
+            BroadPhaseCastResult*           m_pCandidates;
+            uint32                          m_numCandidates = 0;
+            bool                            m_hasOverflowed = false;
+        };
+
+        const uint32 numCCDBodies = pStep->m_numCCDBodies;
+        uint32 numBroadPhaseQueries = 0;
+        uint32 numCandidatesTested = 0;
 
-            // Check if we collide with any other body. Note that we use the non-locking interface as we know the broadphase cannot be modified at this point.
-            RShapeCast shapeCast(body.GetShape(), Vec3::One(), body.GetCenterOfMassTransform(), ccdBody.m_deltaPosition);
-            CCDBroadPhaseCollector bpCollector(ccdBody, body, shapeCast, settings, shapeFilter, npCollector, m_bodyManager, pStep, pContext->m_stepDeltaTime);
-            m_pBroadphase->CastAABoxNoLock({ shapeCast.m_shapeWorldBounds, shapeCast.m_direction }, bpCollector, broadPhaseFilter, collisionLayerFilter);
+        // Bounds of the bodies in the current batch at the start of the cast, and the bounds of the entire cast.
+        AABox shapeWorldBounds[kNumCCDBodiesPerBatch];
+        AABox sweptBounds[kNumCCDBodiesPerBatch];
+
+        // Candidates shared by a group of bodies, and the candidates of one body of the group with the fraction at which its bounds hit them.
+        BroadPhaseCastResult groupCandidates[kMaxCCDBatchCandidates];
+        BroadPhaseCastResult bodyCandidates[kMaxCCDBatchCandidates];
+        
+        for (;;)
+        {
+            // Fetch the next batch of bodies to cast. The bodies were sorted by locality in JobPostIntegrateVelocity().
+            const uint32 batchStart = pStep->m_nextCCDBody.fetch_add(kNumCCDBodiesPerBatch);
+            if (batchStart >= numCCDBodies)
+                break;
+            const uint32 batchEnd = math::Min(batchStart + kNumCCDBodiesPerBatch, numCCDBodies);
 
-            // Check if there was a hit.
-            if (ccdBody.m_hitFractionPlusSlop < 1.f)
+            // Calculate the bounds of the casts.
+            for (uint32 i = batchStart; i < batchEnd; ++i)
             {
-                const Body& body2 = m_bodyManager.GetBody(ccdBody.m_bodyID2);
+                const CCDBody& ccdBody = pStep->m_pCCDBodies[pStep->m_pCCDBodyOrder[i]];
+                const Body& body = m_bodyManager.GetBody(ccdBody.m_bodyID1);
+                const AABox& bounds = shapeWorldBounds[i - batchStart] = body.GetShape()->GetWorldBounds(body.GetCenterOfMassTransform(), Vec3::One());
+                AABox& swept = sweptBounds[i - batchStart] = bounds;
+                swept.Encapsulate(AABox(bounds.m_min + ccdBody.m_deltaPosition, bounds.m_max + ccdBody.m_deltaPosition));
+            }
+
+            // Split the batch into groups of bodies in the same collision layer that are close enough together to share a broadphase query.
+            // A body is added to the group as long as the bounds of the group don't get much larger than the bounds of the individual casts.
+            uint32 groupStart = batchStart;
+            while (groupStart < batchEnd)
+            {
+                const CollisionLayer layer = m_bodyManager.GetBody(pStep->m_pCCDBodies[pStep->m_pCCDBodyOrder[groupStart]].m_bodyID1).GetCollisionLayer();
+                AABox groupBounds = sweptBounds[groupStart - batchStart];
+                float sumSurfaceArea = groupBounds.SurfaceArea();
+                uint32 groupEnd = groupStart + 1;
+                for (; groupEnd < batchEnd; ++groupEnd)
+                {
+                    if (m_bodyManager.GetBody(pStep->m_pCCDBodies[pStep->m_pCCDBodyOrder[groupEnd]].m_bodyID1).GetCollisionLayer() != layer)
+                        break;
+
+                    const AABox& bounds = sweptBounds[groupEnd - batchStart];
+                    AABox newGroupBounds = groupBounds;
+                    newGroupBounds.Encapsulate(bounds);
+                    const float newSumSurfaceArea = sumSurfaceArea + bounds.SurfaceArea();
+                    if (newGroupBounds.SurfaceArea() > kCCDBatchMaxAreaRatio * newSumSurfaceArea)
+                        break;
 
-                // Determine the contact manifold
-                ContactManifold manifold;
-                manifold.m_baseOffset = shapeCast.m_centerOfMassStart.GetTranslation();
-                ManifoldBetweenTwoFaces(castShapeResult.m_contactPointOn1, castShapeResult.m_contactPointOn2, castShapeResult.m_penetrationAxis, m_physicsSettings.m_manifoldTolerance, castShapeResult.m_shape1Face, castShapeResult.m_shape2Face, manifold.m_relativeContactPointsOn1, manifold.m_relativeContactPointsOn2);
-                manifold.m_subShapeID1 = castShapeResult.m_subShapeID1;
-                manifold.m_subShapeID2 = castShapeResult.m_subShapeID2;
-                manifold.m_penetrationDepth = castShapeResult.m_penetrationDepth;
-                manifold.m_worldSpaceNormal = ccdBody.m_contactNormal;
+                    groupBounds = newGroupBounds;
+                    sumSurfaceArea = newSumSurfaceArea;
+                }
 
-                // Call contact point callbacks
-                m_contactManager.OnCCDContactAdded(contactAllocator, body, body2, manifold, ccdBody.m_contactSettings);
+                // Filter out layers
+                DefaultBroadPhaseLayerFilter broadPhaseFilter = GetDefaultBroadPhaseFilter(layer);
+                DefaultCollisionLayerFilter collisionLayerFilter = GetDefaultCollisionLayerFilter(layer);
 
-                if (ccdBody.m_contactSettings.m_isSensor)
+                // If there are multiple bodies in the group, collect the candidates for all of them with a single query.
+                // Note that we use the non-locking interface as we know the broadphase cannot be modified at this point.
+                CCDBatchCollector batchCollector(groupCandidates);
+                if (groupEnd - groupStart > 1)
                 {
-                    // If this is a sensor, we don't want to solve the contact.
-                    ccdBody.m_hitFractionPlusSlop = 1.f;
-                    ccdBody.m_bodyID2 = BodyID();
+                    m_pBroadphase->CollideAABoxNoLock(groupBounds, batchCollector, broadPhaseFilter, collisionLayerFilter);
+                    ++numBroadPhaseQueries;
                 }
-                else
+                const bool useGroupCandidates = groupEnd - groupStart > 1 && !batchCollector.m_hasOverflowed;
+
+                for (uint32 i = groupStart; i < groupEnd; ++i)
                 {
-                    // Calculate the average position from the manifold (this will result in the same impulse applied as when we apply impulses to all contact points).
-                    if (manifold.m_relativeContactPointsOn2.size() > 1)
+                    CCDBody& ccdBody = pStep->m_pCCDBodies[pStep->m_pCCDBodyOrder[i]];
+                    const Body& body = m_bodyManager.GetBody(ccdBody.m_bodyID1);
+
+                    // Narrow phase collector
+                    ShapeCastResult castShapeResult;
+                    CCDNarrowPhaseCollector npCollector(m_bodyManager, m_contactManager, ccdBody, castShapeResult, pContext->m_stepDeltaTime);
+
+                    // Create the shape filter
+                    Internal_SimShapeFilterWrapper shapeFilter(m_pSimShapeFilter, &body);
+
+                    // Check if we collide with any other body.
+                    RShapeCast shapeCast(body.GetShape(), Vec3::One(), body.GetCenterOfMassTransform(), ccdBody.m_deltaPosition, shapeWorldBounds[i - batchStart]);
+                    CCDBroadPhaseCollector bpCollector(ccdBody, body, shapeCast, settings, shapeFilter, npCollector, m_bodyManager, pStep, pContext->m_stepDeltaTime);
+                    if (useGroupCandidates)
                     {
-                        Vec3 averageContactPoint = Vec3::Zero();
-                        for (const Vec3& v : manifold.m_relativeContactPointsOn2)
+                        // Do the same test that the broadphase does for an AABox cast: a ray from the center of the bounds against
+                        // the bounds of the candidate, widened by the extent of our bounds.
+                        const Vec3 origin = shapeCast.m_shapeWorldBounds.Center();
+                        const Vec3 extent = shapeCast.m_shapeWorldBounds.Extent();
+                        const RayInvDirection invDirection(shapeCast.m_direction);
+                        uint32 numBodyCandidates = 0;
+                        for (uint32 c = 0; c < batchCollector.m_numCandidates; ++c)
+                        {
+                            AABox bounds = m_bodyManager.GetBody(groupCandidates[c].m_bodyID).GetWorldSpaceBounds();
+                            bounds.ExpandBy(extent);
+                            const float fraction = RayAABox(origin, invDirection, bounds.m_min, bounds.m_max);
+                            if (fraction <= bpCollector.GetEarlyOutFraction())
+                            {
+                                BroadPhaseCastResult& candidate = bodyCandidates[numBodyCandidates++];
+                                candidate.m_bodyID = groupCandidates[c].m_bodyID;
+                                candidate.m_fraction = fraction;
+                            }
+                        }
+
+                        // Test the candidates from near to far. Once a candidate is further away than the closest hit so far,
+                        // none of the remaining candidates can be hit earlier.
+                        QuickSort(bodyCandidates, bodyCandidates + numBodyCandidates, [](const BroadPhaseCastResult& left, const BroadPhaseCastResult& right)
+                        {
+                            if (left.m_fraction != right.m_fraction)
+                                return left.m_fraction < right.m_fraction;
+
+                            return left.m_bodyID < right.m_bodyID;
+                        });
+
+                        for (uint32 c = 0; c < numBodyCandidates && bodyCandidates[c].m_fraction <= bpCollector.GetEarlyOutFraction(); ++c)
                         {
-                            averageContactPoint += v;
+                            bpCollector.AddHit(bodyCandidates[c]);
                         }
-                        averageContactPoint /= static_cast<float>(manifold.m_relativeContactPointsOn2.size());
-                        ccdBody.m_contactPointOn2 = manifold.m_baseOffset + averageContactPoint;
                     }
                     else
                     {
-                        ccdBody.m_contactPointOn2 = manifold.m_baseOffset + castShapeResult.m_contactPointOn2;
+                        m_pBroadphase->CastAABoxNoLock({ shapeCast.m_shapeWorldBounds, shapeCast.m_direction }, bpCollector, broadPhaseFilter, collisionLayerFilter);
+                        ++numBroadPhaseQueries;
+                    }
+                    numCandidatesTested += bpCollector.m_numCandidatesTested;
+
+                    // Check if there was a hit.
+                    if (ccdBody.m_hitFractionPlusSlop < 1.f)
+                    {
+                        const Body& body2 = m_bodyManager.GetBody(ccdBody.m_bodyID2);
+
+                        // Determine the contact manifold
+                        ContactManifold manifold;
+                        manifold.m_baseOffset = shapeCast.m_centerOfMassStart.GetTranslation();
+                        ManifoldBetweenTwoFaces(castShapeResult.m_contactPointOn1, castShapeResult.m_contactPointOn2, castShapeResult.m_penetrationAxis, m_physicsSettings.m_manifoldTolerance, castShapeResult.m_shape1Face, castShapeResult.m_shape2Face, manifold.m_relativeContactPointsOn1, manifold.m_relativeContactPointsOn2);
+                        manifold.m_subShapeID1 = castShapeResult.m_subShapeID1;
+                        manifold.m_subShapeID2 = castShapeResult.m_subShapeID2;
+                        manifold.m_penetrationDepth = castShapeResult.m_penetrationDepth;
+                        manifold.m_worldSpaceNormal = ccdBody.m_contactNormal;
+
+                        // Call contact point callbacks
+                        m_contactManager.OnCCDContactAdded(contactAllocator, body, body2, manifold, ccdBody.m_contactSettings);
+
+                        if (ccdBody.m_contactSettings.m_isSensor)
+                        {
+                            // If this is a sensor, we don't want to solve the contact.
+                            ccdBody.m_hitFractionPlusSlop = 1.f;
+                            ccdBody.m_bodyID2 = BodyID();
+                        }
+                        else
+                        {
+                            // Calculate the average position from the manifold (this will result in the same impulse applied as when we apply impulses to all contact points).
+                            if (manifold.m_relativeContactPointsOn2.size() > 1)
+                            {
+                                Vec3 averageContactPoint = Vec3::Zero();
+                                for (const Vec3& v : manifold.m_relativeContactPointsOn2)
+                                {
+                                    averageContactPoint += v;
+                                }
+                                averageContactPoint /= static_cast<float>(manifold.m_relativeContactPointsOn2.size());
+                                ccdBody.m_contactPointOn2 = manifold.m_baseOffset + averageContactPoint;
+                            }
+                            else
+                            {
+                                ccdBody.m_contactPointOn2 = manifold.m_baseOffset + castShapeResult.m_contactPointOn2;
+                            }
+                        }
                     }
                 }
+
+                groupStart = groupEnd;
             }
         }
 
         // Collect information from the contact allocator and accumulate it in the step.
         FinalizeContactAllocator(*pStep, contactAllocator);
+        pStep->m_numCCDBroadPhaseQueries.fetch_add(numBroadPhaseQueries, std::memory_order_relaxed);
+        pStep->m_numCCDCandidatesTested.fetch_add(numCandidatesTested, std::memory_order_relaxed);
     }
 
     void PhysicsScene::JobResolveCCDContacts(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep)
     {
-    #if NES_ASSERTS_ENABLED
-        // Read/write body access.
-        BodyAccess::GrantScope grant(BodyAccess::EAccess::ReadWrite, BodyAccess::EAccess::ReadWrite);
-
-        // We activate bodies that we collide with.
-        BodyManager::Internal_GrantActiveBodiesAccess grantActive(true, false);
-    #endif
+        // Check if there is anything to do.
+        const uint32 numCCDBodies = pStep->m_numCCDBodies;
+        if (numCCDBodies == 0)
+        {
+            FinalizeCCDContacts(pContext, pStep);
+            return;
+        }
 
-        const uint32 numActiveBodiesAfterFindCollisions = pStep->m_activeBodyReadIndex;
+        // Sort on fraction so that we process the earliest collisions first.
+        // This is needed to make the simulation deterministic and also to be able to stop contact processing
+        // between body pairs if an earlier hit was found involving the body by another CCD body
+        // (if it's a body ID < this CCD body's body ID - see filtering logic in CCDBroadPhaseCollector).
         StackAllocator* pAllocator = pContext->m_pAllocator;
+        NES_ASSERT(pStep->m_pSortedCCDBodies == nullptr);
+        CCDBody** pSortedCCDBodies = static_cast<CCDBody**>(pAllocator->Allocate(numCCDBodies * sizeof(CCDBody*)));
+        pStep->m_pSortedCCDBodies = pSortedCCDBodies;
+        {
+            // We don't to copy the entire struct (it's quite big), so we create a pointer array first.
+            CCDBody* pSrcCCDBodies = pStep->m_pCCDBodies;
+            CCDBody** pDstCCDBodies = pSortedCCDBodies;
+            CCDBody** pDstCCDBodiesEnd = pDstCCDBodies + numCCDBodies;
+            while (pDstCCDBodies < pDstCCDBodiesEnd)
+            {
+                *(pDstCCDBodies++) = pSrcCCDBodies++;
+            }
 
-        // Check if there is anything to do.
-        const uint numCCDBodies = pStep->m_numCCDBodies;
-        if (numCCDBodies > 0)
+            // Which we then sort
+            QuickSort(pSortedCCDBodies, pSortedCCDBodies + numCCDBodies, [](const CCDBody* pBody1, const CCDBody* pBody2)
+            {
+               if (pBody1->m_hitFractionPlusSlop != pBody2->m_hitFractionPlusSlop)
+                   return pBody1->m_hitFractionPlusSlop < pBody2->m_hitFractionPlusSlop;
+
+                return pBody1->m_bodyID1 < pBody2->m_bodyID1;
+            });
+        }
+
+        // Split the bodies into islands that can be resolved in parallel. When there aren't enough bodies
+        // to keep multiple jobs busy, all bodies are resolved as a single island.
+        const int maxConcurrency = pContext->GetMaxConcurrency();
+        BuildCCDIslands(pContext, pStep, maxConcurrency > 1 && numCCDBodies > kNumCCDIslandsPerBatch);
+
+        const uint32 numResolveJobs = math::Min((pStep->m_numCCDIslands + kNumCCDIslandsPerBatch - 1) / kNumCCDIslandsPerBatch, static_cast<uint32>(maxConcurrency));
+        if (numResolveJobs <= 1)
         {
-            // Sort on fraction so that we process the earliest collisions first.
-            // This is needed to make the simulation deterministic and also to be able to stop contact processing
-            // between body pairs if an earlier hit was found involving the body by another CCD body
-            // (if it's a body ID < this CCD body's body ID - see filtering logic in CCDBroadPhaseCollector).
-            CCDBody** pSortedCCDBodies = static_cast<CCDBody**>(pAllocator->Allocate(numCCDBodies * sizeof(CCDBody*)));
-            NES_ON_SCOPE_EXIT([pAllocator, pSortedCCDBodies, numCCDBodies]() { pAllocator->Free(static_cast<void*>(pSortedCCDBodies), numCCDBodies * sizeof(CCDBody*)); });
+            JobResolveCCDIslands(pContext, pStep);
+            FinalizeCCDContacts(pContext, pStep);
+            return;
+        }
+
+        // The solve position constraints jobs need to wait until all islands are resolved. The dependency
+        // on this job is removed when we return; the last resolve job removes the dependency that we add here.
+        for (const JobHandle& handle : pStep->m_solvePositionConstraints)
+        {
+            handle.AddDependency();
+        }
+
+        pStep->m_numCCDResolveJobsLeft = numResolveJobs;
+        for (uint32 i = 0; i < numResolveJobs; ++i)
+        {
+            JobHandle job = pContext->m_pJobSystem->CreateJob("Resolve CCD Islands", [pContext, pStep]
             {
-                // We don't to copy the entire struct (it's quite big), so we create a pointer array first.
-                CCDBody* pSrcCCDBodies = pStep->m_pCCDBodies;
-                CCDBody** pDstCCDBodies = pSortedCCDBodies;
-                CCDBody** pDstCCDBodiesEnd = pDstCCDBodies + numCCDBodies;
-                while (pDstCCDBodies < pDstCCDBodiesEnd)
+                ScopedPhysicsJobTimer timer(pContext->m_pStepStats, EPhysicsJobType::ResolveCCDContacts, pStep->m_stepIndex);
+
+                pContext->m_pPhysicsScene->JobResolveCCDIslands(pContext, pStep);
+
+                // The last job to finish activates the bodies that were hit and frees the CCD data.
+                if (pStep->m_numCCDResolveJobsLeft.fetch_sub(1, std::memory_order_acq_rel) == 1)
                 {
-                    *(pDstCCDBodies++) = pSrcCCDBodies++;
+                    pContext->m_pPhysicsScene->FinalizeCCDContacts(pContext, pStep);
+                    JobHandle::RemovedDependencies(pStep->m_solvePositionConstraints);
                 }
+            });
+            pContext->m_pBarrier->AddJob(job);
+        }
+    }
 
-                // Which we then sort
-                QuickSort(pSortedCCDBodies, pSortedCCDBodies + numCCDBodies, [](const CCDBody* pBody1, const CCDBody* pBody2)
-                {
-                   if (pBody1->m_hitFractionPlusSlop != pBody2->m_hitFractionPlusSlop)
-                       return pBody1->m_hitFractionPlusSlop < pBody2->m_hitFractionPlusSlop;
+    void PhysicsScene::JobResolveCCDIslands(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep)
+    {
+    #if NES_ASSERTS_ENABLED
+        // Read/write body access.
+        BodyAccess::GrantScope grant(BodyAccess::EAccess::ReadWrite, BodyAccess::EAccess::ReadWrite);
+    #endif
 
-                    return pBody1->m_bodyID1 < pBody2->m_bodyID1;
-                });
-            }
+        const uint32 numActiveBodiesAfterFindCollisions = pStep->m_activeBodyReadIndex;
 
-            // We can collide with bodies that are not active; we track them here so we can activate them in one go at the end.
-            // This is also needed because we can't modify the active body array while we iterate it.
-            static constexpr int kBodiesBatchSize = 64;
-            BodyID* pBodiesToActivate = static_cast<BodyID*>(NES_STACK_ALLOCATE(kBodiesBatchSize * sizeof(BodyID)));
-            int numBodiesToActivate = 0;
+        // We can move bodies that are not part of an island. In this case, we need to notify the broadphase of the movement.
+        static constexpr int kBodiesBatchSize = 64;
+        BodyID* pBodiesToUpdateBounds = static_cast<BodyID*>(NES_STACK_ALLOCATE(kBodiesBatchSize * sizeof(BodyID)));
+        int numBodiesToUpdateBounds = 0;
 
-            // We can move bodies that are not part of an island. In this case, we need to notify the broadphase of the movement.
-            BodyID* pBodiesToUpdateBounds = static_cast<BodyID*>(NES_STACK_ALLOCATE(kBodiesBatchSize * sizeof(BodyID)));
-            int numBodiesToUpdateBounds = 0;
+        for (;;)
+        {
+            // Fetch the next batch of islands
+            const uint32 firstIsland = pStep->m_nextCCDIsland.fetch_add(kNumCCDIslandsPerBatch);
+            if (firstIsland >= pStep->m_numCCDIslands)
+                break;
+            const uint32 lastIsland = math::Min(firstIsland + kNumCCDIslandsPerBatch, pStep->m_numCCDIslands);
 
-            for (uint i = 0; i < numCCDBodies; ++i)
+            // The bodies of consecutive islands are stored consecutively, each island in the order of its hit fractions.
+            // Islands don't modify any body that another island uses, so they can be resolved in parallel.
+            const uint32 end = pStep->m_pCCDIslandStarts[lastIsland];
+            for (uint32 index = pStep->m_pCCDIslandStarts[firstIsland]; index < end; ++index)
             {
-                const CCDBody* pCCDBody = pSortedCCDBodies[i];
+                const uint32 sortedIndex = pStep->m_pCCDIslandBodies[index];
+                const CCDBody* pCCDBody = pStep->m_pSortedCCDBodies[sortedIndex];
+                BodyID& bodyToActivate = pStep->m_pCCDBodiesToActivate[sortedIndex];
+                bodyToActivate = BodyID();
                 Body& body1 = m_bodyManager.GetBody(pCCDBody->m_bodyID1);
                 MotionProperties* pMotionProps = body1.GetMotionProperties();
 
@@ -1837,17 +2445,10 @@ namespace nes
                         pMotionProps->ClampLinearVelocity();
                         pMotionProps->ClampAngularVelocity();
 
-                        // Activate the 2nd body if it is not already active
-                        if (body2.IsDynamic() && !body2.IsActive())
-                        {
-                            pBodiesToActivate[numBodiesToActivate++] = pCCDBody->m_bodyID2;
-                            if (numBodiesToActivate == kBodiesBatchSize)
-                            {
-                                // Batch is full, activate now:
-                                m_bodyManager.ActivateBodies(pBodiesToActivate, numBodiesToActivate);
-                                numBodiesToActivate = 0;
-                            }
-                        }
+                        // Activate the 2nd body if it is not already active. This is done once all islands have been resolved,
+                        // as we can't modify the active body array while other jobs are reading it.
+                        if (body2.IsDynamic() && !body2.Internal_IsInActiveBodies())
+                            bodyToActivate = pCCDBody->m_bodyID2;
                     }
                 }
 
@@ -1870,14 +2471,200 @@ namespace nes
                     }
                 }
             }
+        }
+
+        // Notify the changed bounds on requested bodies
+        if (numBodiesToUpdateBounds > 0)
+            m_pBroadphase->NotifyBodiesAABBChanged(pBodiesToUpdateBounds, numBodiesToUpdateBounds, false);
+    }
+
+    void PhysicsScene::BuildCCDIslands(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep, const bool splitIslands)
+    {
+        StackAllocator* pAllocator = pContext->m_pAllocator;
+        const uint32 numCCDBodies = pStep->m_numCCDBodies;
+
+        // Bodies that need to be activated are stored per sorted CCD body, so that they can be activated in a deterministic order.
+        pStep->m_pCCDBodiesToActivate = static_cast<BodyID*>(pAllocator->Allocate(numCCDBodies * sizeof(BodyID)));
+        pStep->m_pCCDIslandBodies = static_cast<uint32*>(pAllocator->Allocate(numCCDBodies * sizeof(uint32)));
+        pStep->m_pCCDIslandStarts = static_cast<uint32*>(pAllocator->Allocate((numCCDBodies + 1) * sizeof(uint32)));
+        uint32* pIslandBodies = pStep->m_pCCDIslandBodies;
+        uint32* pIslandStarts = pStep->m_pCCDIslandStarts;
+
+        if (!splitIslands)
+        {
+            // All bodies are in a single island, in sorted order.
+            for (uint32 i = 0; i < numCCDBodies; ++i)
+            {
+                pIslandBodies[i] = i;
+            }
+            pIslandStarts[0] = 0;
+            pIslandStarts[1] = numCCDBodies;
+            pStep->m_numCCDIslands = 1;
+            return;
+        }
+
+        // Merge the CCD bodies that affect each other, using the index in m_pCCDBodies.
+        uint32* pParents = static_cast<uint32*>(pAllocator->Allocate(numCCDBodies * sizeof(uint32)));
+        for (uint32 i = 0; i < numCCDBodies; ++i)
+        {
+            pParents[i] = i;
+        }
+
+        auto findRoot = [pParents](uint32 index)
+        {
+            while (pParents[index] != index)
+            {
+                pParents[index] = pParents[pParents[index]];
+                index = pParents[index];
+            }
+            return index;
+        };
+
+        auto merge = [pParents, &findRoot](const uint32 index1, const uint32 index2)
+        {
+            const uint32 root1 = findRoot(index1);
+            const uint32 root2 = findRoot(index2);
+            if (root1 != root2)
+                pParents[math::Max(root1, root2)] = math::Min(root1, root2);
+        };
+
+        // When a CCD body hits another CCD body, both are modified. When it hits a dynamic body, the velocity of the dynamic body
+        // is modified, so all CCD bodies that hit the same dynamic body need to be in the same island. Static and kinematic bodies
+        // are only read.
+        struct HitBody
+        {
+            BodyID          m_bodyID;
+            uint32          m_ccdIndex;
+        };
+        HitBody* pHitBodies = static_cast<HitBody*>(pAllocator->Allocate(numCCDBodies * sizeof(HitBody)));
+        uint32 numHitBodies = 0;
+        for (uint32 i = 0; i < numCCDBodies; ++i)
+        {
+            const CCDBody& ccdBody = pStep->m_pCCDBodies[i];
+            if (!ccdBody.m_bodyID2.IsValid())
+                continue;
+
+            const Body& body2 = m_bodyManager.GetBody(ccdBody.m_bodyID2);
+            const CCDBody* pCCDBody2 = GetCCDBody(body2, pStep);
+            if (pCCDBody2 != nullptr)
+                merge(i, static_cast<uint32>(pCCDBody2 - pStep->m_pCCDBodies));
+            else if (body2.IsDynamic())
+                pHitBodies[numHitBodies++] = { ccdBody.m_bodyID2, i };
+        }
+
+        QuickSort(pHitBodies, pHitBodies + numHitBodies, [](const HitBody& left, const HitBody& right)
+        {
+            return left.m_bodyID < right.m_bodyID;
+        });
+
+        for (uint32 i = 1; i < numHitBodies; ++i)
+        {
+            if (pHitBodies[i].m_bodyID == pHitBodies[i - 1].m_bodyID)
+                merge(pHitBodies[i].m_ccdIndex, pHitBodies[i - 1].m_ccdIndex);
+        }
+
+        // Number the islands in the order in which their first body is resolved, and count the bodies in each island.
+        static constexpr uint32 kInvalidIsland = ~static_cast<uint32>(0);
+        uint32* pRootToIsland = static_cast<uint32*>(pAllocator->Allocate(numCCDBodies * sizeof(uint32)));
+        uint32* pBodyIslands = static_cast<uint32*>(pAllocator->Allocate(numCCDBodies * sizeof(uint32)));
+        std::fill(pRootToIsland, pRootToIsland + numCCDBodies, kInvalidIsland);
+        std::fill(pIslandStarts, pIslandStarts + numCCDBodies + 1, 0U);
+        uint32 numIslands = 0;
+        for (uint32 i = 0; i < numCCDBodies; ++i)
+        {
+            uint32& island = pRootToIsland[findRoot(static_cast<uint32>(pStep->m_pSortedCCDBodies[i] - pStep->m_pCCDBodies))];
+            if (island == kInvalidIsland)
+                island = numIslands++;
+
+            pBodyIslands[i] = island;
+            ++pIslandStarts[island + 1];
+        }
+
+        // Calculate the start of each island.
+        for (uint32 island = 1; island <= numIslands; ++island)
+        {
+            pIslandStarts[island] += pIslandStarts[island - 1];
+        }
+
+        // Store the bodies per island, using the start of each island as write position. This moves each start
+        // to the start of the next island, so we shift them back afterward.
+        for (uint32 i = 0; i < numCCDBodies; ++i)
+        {
+            pIslandBodies[pIslandStarts[pBodyIslands[i]]++] = i;
+        }
+        for (uint32 island = numIslands; island > 0; --island)
+        {
+            pIslandStarts[island] = pIslandStarts[island - 1];
+        }
+        pIslandStarts[0] = 0;
+        pStep->m_numCCDIslands = numIslands;
+
+        pAllocator->Free(pBodyIslands, numCCDBodies * sizeof(uint32));
+        pAllocator->Free(pRootToIsland, numCCDBodies * sizeof(uint32));
+        pAllocator->Free(pHitBodies, numCCDBodies * sizeof(HitBody));
+        pAllocator->Free(pParents, numCCDBodies * sizeof(uint32));
+    }
+
+    void PhysicsScene::FinalizeCCDContacts(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep)
+    {
+        StackAllocator* pAllocator = pContext->m_pAllocator;
+
+        const uint32 numCCDBodies = pStep->m_numCCDBodies;
+        if (numCCDBodies > 0)
+        {
+        #if NES_ASSERTS_ENABLED
+            // Read/write body access.
+            BodyAccess::GrantScope grant(BodyAccess::EAccess::ReadWrite, BodyAccess::EAccess::ReadWrite);
+
+            // We activate bodies that we collide with.
+            BodyManager::Internal_GrantActiveBodiesAccess grantActive(true, false);
+        #endif
+
+            // Activate the bodies that were hit, in the order in which they were resolved.
+            static constexpr int kBodiesBatchSize = 64;
+            BodyID* pBodiesToActivate = static_cast<BodyID*>(NES_STACK_ALLOCATE(kBodiesBatchSize * sizeof(BodyID)));
+            int numBodiesToActivate = 0;
+            uint32 numHits = 0;
+            for (uint32 i = 0; i < numCCDBodies; ++i)
+            {
+                if (pStep->m_pSortedCCDBodies[i]->m_bodyID2.IsValid())
+                    ++numHits;
+
+                const BodyID& bodyID = pStep->m_pCCDBodiesToActivate[i];
+                if (bodyID.IsValid())
+                {
+                    pBodiesToActivate[numBodiesToActivate++] = bodyID;
+                    if (numBodiesToActivate == kBodiesBatchSize)
+                    {
+                        // Batch is full, activate now:
+                        m_bodyManager.ActivateBodies(pBodiesToActivate, numBodiesToActivate);
+                        numBodiesToActivate = 0;
+                    }
+                }
+            }
 
-            // Activate the requested bodies
             if (numBodiesToActivate > 0)
                 m_bodyManager.ActivateBodies(pBodiesToActivate, numBodiesToActivate);
-            
-            // Notify the changed bounds on requested bodies
-            if (numBodiesToUpdateBounds > 0)
-                m_pBroadphase->NotifyBodiesAABBChanged(pBodiesToUpdateBounds, numBodiesToUpdateBounds, false);
+
+            // Accumulate the statistics. The collision steps run one after the other, so this is never done concurrently.
+            m_ccdStats.m_numCCDBodies += numCCDBodies;
+            m_ccdStats.m_numBroadPhaseQueries += pStep->m_numCCDBroadPhaseQueries;
+            m_ccdStats.m_numCandidatesTested += pStep->m_numCCDCandidatesTested;
+            m_ccdStats.m_numHits += numHits;
+            m_ccdStats.m_numIslands += pStep->m_numCCDIslands;
+
+            // Free the data used to find and resolve the CCD contacts, in reverse order of allocation.
+            pAllocator->Free(pStep->m_pCCDIslandStarts, (numCCDBodies + 1) * sizeof(uint32));
+            pStep->m_pCCDIslandStarts = nullptr;
+            pAllocator->Free(pStep->m_pCCDIslandBodies, numCCDBodies * sizeof(uint32));
+            pStep->m_pCCDIslandBodies = nullptr;
+            pAllocator->Free(pStep->m_pCCDBodiesToActivate, numCCDBodies * sizeof(BodyID));
+            pStep->m_pCCDBodiesToActivate = nullptr;
+            pAllocator->Free(pStep->m_pSortedCCDBodies, numCCDBodies * sizeof(CCDBody*));
+            pStep->m_pSortedCCDBodies = nullptr;
+            pAllocator->Free(pStep->m_pCCDBodyOrder, numCCDBodies * sizeof(uint32));
+            pStep->m_pCCDBodyOrder = nullptr;
+            pStep->m_numCCDIslands = 0;
         }
 
         // Ensure we free the CCD bodies array now, will not call the destructor!
@@ -1900,9 +2687,30 @@ namespace nes
         // Reset the Body::EFlags::InvalidateContactCache flag for all bodies.
         m_bodyManager.ValidateContactCacheForAllBodies();
 
+        // Keep the contacts of the bodies that skipped this update, they weren't tested for collision.
+        uint numBodyPairs = pStep->m_numBodyPairs;
+        uint numManifolds = pStep->m_numManifolds;
+        if (!m_skippedBodies.empty())
+        {
+            ContactAllocator contactAllocator = m_contactManager.GetContactAllocator();
+            m_contactManager.KeepContactsOfSkippedBodies(contactAllocator, m_bodyManager);
+            numBodyPairs += contactAllocator.m_numBodyPairs;
+            numManifolds += contactAllocator.m_numManifolds;
+            pStep->m_pContext->m_errors.fetch_or(static_cast<uint32>(contactAllocator.m_errors), std::memory_order_relaxed);
+        }
+
         // Finalize the contact cache (this swaps the read and write versions of the contact cache).
         // Trigger all contact removed callbacks by looking at the last step contact points that have not been flagged as reused.
-        m_contactManager.FinalizeContactCacheAndCallContactPointRemovedCallback(pStep->m_numBodyPairs, pStep->m_numManifolds);
+        m_contactManager.FinalizeContactCacheAndCallContactPointRemovedCallback(numBodyPairs, numManifolds);
+
+        // Record the collision counters of this step.
+        if (PhysicsStepStats* pStats = pStep->m_pContext->m_pStepStats)
+        {
+            pStats->m_numBodyPairs += pStep->m_numBodyPairs;
+            pStats->m_numManifolds += pStep->m_numManifolds;
+            pStats->m_numBodyPairCacheHits += pStep->m_numBodyPairCacheHits;
+            pStats->m_numBodyPairCacheMisses += pStep->m_numBodyPairCacheMisses;
+        }
     }
 
     class PhysicsScene::BodiesToSleep
@@ -1977,12 +2785,13 @@ namespace nes
             if (checkSplitIslands)
             {
                 bool firstIteration;
+                bool isParallel;
                 uint splitIslandIndex;
                 uint32* pConstraintsBegin;
                 uint32* pConstraintsEnd;
                 uint32* pContactsBegin;
                 uint32* pContactsEnd;
-                switch (m_largeIslandSplitter.FetchNextBatch(splitIslandIndex, pConstraintsBegin, pConstraintsEnd, pContactsBegin, pContactsEnd, firstIteration))
+                switch (m_largeIslandSplitter.FetchNextBatch(splitIslandIndex, pConstraintsBegin, pConstraintsEnd, pContactsBegin, pContactsEnd, firstIteration, isParallel))
                 {
                     case LargeIslandSplitter::EStatus::BatchRetrieved:
                     {
@@ -2120,6 +2929,8 @@ namespace nes
                 // Start the job
                 JobHandle job = pStep->m_pContext->m_pJobSystem->CreateJob("Find Collisions", [step = pStep, jobIndex]()
                 {
+                    ScopedPhysicsJobTimer timer(step->m_pContext->m_pStepStats, EPhysicsJobType::FindCollisions, step->m_stepIndex);
+
                     step->m_pContext->m_pPhysicsScene->JobFindCollisions(step, static_cast<int>(jobIndex));   
                 });
 
@@ -2139,7 +2950,7 @@ namespace nes
         // Fetch the body pair
         Body* pBody1 = &m_bodyManager.GetBody(bodyPair.m_bodyA);
         Body* pBody2 = &m_bodyManager.GetBody(bodyPair.m_bodyB);
-        NES_ASSERT(pBody1->IsActive());
+        NES_ASSERT(pBody1->Internal_IsInActiveBodies());
 
         // [TODO]: Check for soft bodies
 
@@ -2152,12 +2963,23 @@ namespace nes
             std::swap(pBody1, pBody2);
         }
 
+        // Sensors only need to know if the bodies overlap, so they skip the body pair cache, the contact manifolds and the contact constraints.
+        if (pBody1->IsSensor() || pBody2->IsSensor())
+        {
+            ProcessSensorPair(contactAllocator, *pBody1, *pBody2);
+            return;
+        }
+
         // Check if the contact points from the previous frame are reusable and if so, copy them.
         bool pairHandled = false;
         bool constraintCreated = false;
         if (m_physicsSettings.m_useBodyPairContactCache && !(pBody1->IsCollisionCacheInvalid() || pBody2->IsCollisionCacheInvalid()))
         {
             m_contactManager.GetContactsFromCache(contactAllocator, *pBody1, *pBody2, pairHandled, constraintCreated);
+            if (pairHandled)
+                ++contactAllocator.m_numBodyPairCacheHits;
+            else
+                ++contactAllocator.m_numBodyPairCacheMisses;
         }
 
         // If the cache hasn't handled this body pair, do the actual collision detection
@@ -2183,7 +3005,7 @@ namespace nes
             // Get transforms relative to Body 1
             const RVec3 offset = pBody1->GetCenterOfMassPosition();
             const Mat44 transform1 = Mat44::MakeRotation(pBody1->GetRotation());
-            const Mat44 transform2 = pBody2->GetCenterOfMassTransform().PostTranslated(-offset); // .ToMat44() - for when we have DMat44 as an option.
+            const Mat44 transform2 = pBody2->GetCenterOfMassTransform().PostTranslated(-offset).ToMat44();
 
             if (m_physicsSettings.m_useManifoldReduction                // Check the global flag.
                 && pBody1->GetUseManifoldReductionWithBody(*pBody2))    // Check the body flag.
@@ -2432,9 +3254,9 @@ namespace nes
             // Wake up the sleeping bodies.
             BodyID bodyIDs[2];
             int numBodies = 0;
-            if (pBody1->IsDynamic() && !pBody1->IsActive())
+            if (pBody1->IsDynamic() && !pBody1->Internal_IsInActiveBodies())
                 bodyIDs[numBodies++] = pBody1->GetID();
-            if (pBody2->IsDynamic() && !pBody2->IsActive())
+            if (pBody2->IsDynamic() && !pBody2->Internal_IsInActiveBodies())
                 bodyIDs[numBodies++] = pBody2->GetID();
 
             if (numBodies > 0)
@@ -2445,6 +3267,79 @@ namespace nes
         }
     }
 
+    void PhysicsScene::ProcessSensorPair(ContactAllocator& contactAllocator, const Body& body1, const Body& body2)
+    {
+        // Create the query settings. Faces are not needed as no contact manifold is built.
+        CollideShapeSettings settings;
+        settings.m_collectFacesMode = ECollectFacesMode::NoFaces;
+        settings.m_activeEdgeMode = EActiveEdgeMode::CollideWithAll;
+        settings.m_maxSeparationDistance = 0.f;
+
+        // Create the shape filter
+        Internal_SimShapeFilterWrapper shapeFilter(m_pSimShapeFilter, &body1);
+        shapeFilter.SetBody2(&body2);
+
+        // Get transforms relative to Body 1
+        const RVec3 offset = body1.GetCenterOfMassPosition();
+        const Mat44 transform1 = Mat44::MakeRotation(body1.GetRotation());
+        const Mat44 transform2 = body2.GetCenterOfMassTransform().PostTranslated(-offset).ToMat44();
+
+        // Collector that stops at the first accepted overlap.
+        struct SensorCollideShapeCollector : public CollideShapeCollector
+        {
+            const ContactConstraintManager& m_contactManager;
+            const Body&                     m_body1;
+            const Body&                     m_body2;
+            RVec3                           m_baseOffset;
+            CollideShapeResult              m_hit;
+            bool                            m_hasHit = false;
+
+            SensorCollideShapeCollector(const ContactConstraintManager& contactManager, const Body& body1, const Body& body2, const RVec3 baseOffset)
+                : m_contactManager(contactManager)
+                , m_body1(body1)
+                , m_body2(body2)
+                , m_baseOffset(baseOffset)
+            {
+                //
+            }
+
+            virtual void AddHit(const CollideShapeResult& result) override
+            {
+                switch (m_contactManager.ValidateContactPoint(m_body1, m_body2, m_baseOffset, result))
+                {
+                    case EValidateContactResult::AcceptContact:
+                    case EValidateContactResult::AcceptAllContactsForThisBodyPair:
+                    {
+                        // One overlap is all we need.
+                        m_hit = result;
+                        m_hasHit = true;
+                        ForceEarlyOut();
+                        break;
+                    }
+
+                    case EValidateContactResult::RejectContact:
+                    {
+                        // Skip this contact
+                        break;
+                    }
+
+                    case EValidateContactResult::RejectAllContactsForThisBodyPair:
+                    {
+                        // Skip this and early out.
+                        ForceEarlyOut();
+                        break;
+                    }
+                }
+            }
+        };
+
+        SensorCollideShapeCollector collector(m_contactManager, body1, body2, offset);
+        m_simCollideBodyVsBody(body1, body2, transform1, transform2, settings, collector, shapeFilter.GetFilter());
+
+        if (collector.m_hasHit)
+            m_contactManager.AddSensorContact(contactAllocator, body1, body2, offset, collector.m_hit);
+    }
+
     void PhysicsScene::CheckSleepAndUpdateBounds(const uint32 islandIndex, const PhysicsUpdateContext* pContext, const PhysicsUpdateContext::Step* pStep, BodiesToSleep& bodiesToSleep)
     {
         // Get the bodies that belong to this island.
@@ -2469,7 +3364,8 @@ namespace nes
                 body.Internal_CalculateWorldSpaceBounds();
 
                 // Update Sleeping
-                allCanSleep &= static_cast<int>(body.Internal_UpdateSleepState(pContext->m_stepDeltaTime, maxMovement, timeBeforeSleep));
+                const float bodyDeltaTime = pContext->m_stepDeltaTime * body.GetMotionPropertiesUnchecked()->Internal_GetSimulationTimeScale();
+                allCanSleep &= static_cast<int>(body.Internal_UpdateSleepState(bodyDeltaTime, maxMovement, timeBeforeSleep));
 
                 // Reset force and torque
                 MotionProperties* pMotionProps = body.GetMotionProperties();
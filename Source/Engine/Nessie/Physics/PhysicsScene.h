@@ -3,7 +3,10 @@
 #include "IslandBuilder.h"
 #include "LargeIslandSplitter.h"
 #include "PhysicsSettings.h"
+#include "PhysicsStepStats.h"
 #include "PhysicsUpdateContext.h"
+#include "SimulationRegion.h"
+#include "StateRecorder.h"
 #include "Body/BodyInterface.h"
 #include "Collision/ContactListener.h"
 #include "Collision/NarrowPhaseQuery.h"
@@ -18,6 +21,19 @@ namespace nes
     class StackAllocator;
     class SimShapeFilter;
     
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Statistics of the continuous collision detection for the last PhysicsScene::Update(), summed
+    ///     over all collision steps. Only bodies with EBodyMotionQuality::LinearCast are counted.
+    //----------------------------------------------------------------------------------------------------
+    struct CCDStats
+    {
+        uint32              m_numCCDBodies = 0;             /// Number of bodies that were cast through the scene.
+        uint32              m_numBroadPhaseQueries = 0;     /// Number of broadphase queries. A batch of bodies that shares its candidates counts as 1 query.
+        uint32              m_numCandidatesTested = 0;      /// Number of bodies returned by the broadphase that were tested against a CCD body.
+        uint32              m_numHits = 0;                  /// Number of CCD bodies that hit another body.
+        uint32              m_numIslands = 0;               /// Number of groups of CCD bodies that were resolved independently of each other.
+    };
+    
     //----------------------------------------------------------------------------------------------------
     ///	@brief : Class that runs physics simulation for all registered Bodies.   
     //----------------------------------------------------------------------------------------------------
@@ -62,6 +78,9 @@ namespace nes
 
             /// Maximum number of contact constraints to process (anything else will fall through the world).
             uint32                                  m_maxNumContactConstraints;
+
+            /// Broadphase implementation to use.
+            EBroadPhaseType                         m_broadPhaseType = EBroadPhaseType::QuadTree;
         };
 
         /// Combine function used to combine friction and restitution between bodies.
@@ -116,6 +135,7 @@ namespace nes
         /// @brief : Set the listener which is notified whenever a contact point between two bodies is
         ///     added/updated/removed. You can't change the contact listener during a PhysicsScene::Update,
         ///     but it can be changed at any other time.
+        ///     Use a DeferredContactListener to receive the contacts after the update instead of during it.
         //----------------------------------------------------------------------------------------------------
         void                            SetContactListener(ContactListener* pListener)                  { m_contactManager.SetContactListener(pListener); }
 
@@ -274,6 +294,42 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         Vec3                            GetGravity() const                                              { return m_gravity; }
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set how often the bodies in a simulation region are simulated and how many solver iterations
+        ///     they use. Bodies are assigned to a region with BodyInterface::SetSimulationRegion(). By default,
+        ///     all regions are simulated every update.
+        ///	@param region : Index of the region, must be less than kMaxSimulationRegions.
+        //----------------------------------------------------------------------------------------------------
+        void                            SetSimulationRegionSettings(const uint32 region, const SimulationRegionSettings& settings);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the settings of a simulation region.
+        //----------------------------------------------------------------------------------------------------
+        const SimulationRegionSettings& GetSimulationRegionSettings(const uint32 region) const          { NES_ASSERT(region < kMaxSimulationRegions); return m_simulationRegionSettings[region]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the statistics of a simulation region for the last PhysicsScene::Update().
+        //----------------------------------------------------------------------------------------------------
+        const SimulationRegionStats&    GetSimulationRegionStats(const uint32 region) const             { NES_ASSERT(region < kMaxSimulationRegions); return m_simulationRegionStats[region]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the statistics of the continuous collision detection for the last PhysicsScene::Update().
+        //----------------------------------------------------------------------------------------------------
+        const CCDStats&                 GetCCDStats() const                                             { return m_ccdStats; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Enable or disable collecting the job timings and counters of each PhysicsScene::Update().
+        ///     Disabled by default.
+        //----------------------------------------------------------------------------------------------------
+        void                            SetStepStatsEnabled(const bool enabled)                         { m_stepStatsEnabled = enabled; }
+        bool                            IsStepStatsEnabled() const                                      { return m_stepStatsEnabled; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the job timings and counters of the last PhysicsScene::Update(). Only filled when
+        ///     enabled with SetStepStatsEnabled().
+        //----------------------------------------------------------------------------------------------------
+        const PhysicsStepStats&         GetStepStats() const                                            { return m_stepStats; }
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Returns the locking interface that won't actually lock the body.
         /// @note : Use with great care!
@@ -359,6 +415,37 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         bool                            WereBodiesInContact(const BodyID& bodyID1, const BodyID& bodyID2) const { return m_contactManager.WereBodiesInContact(bodyID1, bodyID2); }
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Save the state of the simulation: the bodies, the contact cache and the constraints. This
+        ///     can be used to roll back the simulation for networking: save the state every frame into a
+        ///     StateRecorderImpl that is reused, and to correct a mispredicted frame, call RestoreState() with
+        ///     the snapshot of that frame and call Update() again for every frame up to the present with the
+        ///     same inputs. The result is only identical to the original simulation if
+        ///     PhysicsSettings::m_simulationIsDeterministic is true and the state was saved without a filter.
+        ///
+        ///     This function cannot be called while PhysicsScene::Update() is running.
+        ///	@param stream : Stream to write the state to.
+        ///	@param state : Which parts of the state to save.
+        ///	@param pFilter : Optional filter that selects which bodies, contacts and constraints are saved.
+        //----------------------------------------------------------------------------------------------------
+        void                            SaveState(StateRecorder& stream, EStateRecorderState state = EStateRecorderState::All, const StateRecorderFilter* pFilter = nullptr) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Restore the state that was saved with SaveState(). The bodies, constraints and their IDs
+        ///     must be the same as when the state was saved. No contact or activation listener callbacks
+        ///     are made. This function cannot be called while PhysicsScene::Update() is running.
+        ///
+        ///     The global state and the bodies are validated before they are modified: if they don't match
+        ///     the scene, the scene is left untouched. The contacts and constraints are restored after the
+        ///     bodies, so if those fail, the bodies and global state have already been restored.
+        ///     Once its buffers have grown, restoring doesn't allocate, and only the bodies that moved
+        ///     update their bounds in the broadphase.
+        ///	@param stream : Stream to read the state from.
+        ///	@param pFilter : Optional filter that selects which contacts are restored.
+        /// @returns : False if the stream doesn't match the scene.
+        //----------------------------------------------------------------------------------------------------
+        bool                            RestoreState(StateRecorder& stream, const StateRecorderFilter* pFilter = nullptr);
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Get the bounding box of all bodies in the physics system. 
         //----------------------------------------------------------------------------------------------------
@@ -405,6 +492,7 @@ namespace nes
         void                            JobPostIntegrateVelocity(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep) const;
         void                            JobFindCCDContacts(const PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep);
         void                            JobResolveCCDContacts(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep);
+        void                            JobResolveCCDIslands(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep);
         void                            JobContactRemovedCallbacks(const PhysicsUpdateContext::Step* pStep);
         void                            JobSolvePositionConstraints(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep);
         // Ignoring Soft Body for now.
@@ -423,11 +511,48 @@ namespace nes
         //----------------------------------------------------------------------------------------------------
         void                            ProcessBodyPair(ContactAllocator& contactAllocator, const BodyPair& bodyPair);
 
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Process narrow phase for a body pair where at least one of the bodies is a sensor. Only
+        ///     tests if the bodies overlap: no contact manifold or contact constraint is created.
+        //----------------------------------------------------------------------------------------------------
+        void                            ProcessSensorPair(ContactAllocator& contactAllocator, const Body& body1, const Body& body2);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Splits the sorted CCD bodies into islands of bodies that can't affect each other. Two CCD bodies
+        ///     are in the same island when one hit the other, or when they both hit the same dynamic body.
+        //----------------------------------------------------------------------------------------------------
+        void                            BuildCCDIslands(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep, const bool splitIslands);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Called after all CCD islands have been resolved. Activates the bodies that were hit, updates
+        ///     the CCD statistics and frees the CCD data of the step.
+        //----------------------------------------------------------------------------------------------------
+        void                            FinalizeCCDContacts(PhysicsUpdateContext* pContext, PhysicsUpdateContext::Step* pStep);
+
         //----------------------------------------------------------------------------------------------------
         /// @brief : Called at the end of JobSolveVelocityConstraints() to check if bodies need to go to sleep
         ///     and to update their bounding box in the broadphase.
         //----------------------------------------------------------------------------------------------------
         void                            CheckSleepAndUpdateBounds(const uint32 islandIndex, const PhysicsUpdateContext* pContext, const PhysicsUpdateContext::Step* pStep, BodiesToSleep& bodiesToSleep);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Called at the start of an Update() to freeze the active bodies of the simulation regions that
+        ///     are not simulated in this update, and to let the bodies of the other regions catch up on the
+        ///     time that they skipped.
+        //----------------------------------------------------------------------------------------------------
+        void                            PrepareSimulationRegions(const float deltaTime);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Called at the end of an Update() to unfreeze the bodies that were frozen by
+        ///     PrepareSimulationRegions().
+        //----------------------------------------------------------------------------------------------------
+        void                            FinalizeSimulationRegions(const float deltaTime);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Called after the step stats of an Update() are recorded, to divide the wall time of the
+        ///     update over the simulation regions that were simulated in it.
+        //----------------------------------------------------------------------------------------------------
+        void                            RecordSimulationRegionWallTimes();
         
     private:
         /// Number of constraints to process at once in JobDetermineActiveConstraints().
@@ -449,8 +574,20 @@ namespace nes
         /// Number of contacts that need to queued before another narrow phase job is started.
         static constexpr int            kNarrowPhaseBatchSize = 16;
 
-        /// Number of continuous collision shape casts that need to be queued before another job is started.
-        static constexpr int            kNumCCDBodiesPerJob = 4;
+        /// Number of CCD bodies that a find CCD contacts job takes at once. A job is started for each batch (up to the max concurrency).
+        /// The bodies are sorted by locality, and the bodies in a batch that are close together share a single broadphase query.
+        static constexpr uint32         kNumCCDBodiesPerBatch = 16;
+
+        /// Maximum number of broadphase candidates that a batch of CCD bodies can share. If the query returns more,
+        /// the bodies of the batch are cast separately.
+        static constexpr uint32         kMaxCCDBatchCandidates = 256;
+
+        /// A CCD body is only added to a batch if the surface area of the bounds of the batch stays below this
+        /// factor times the summed surface area of the swept bounds of the bodies in the batch.
+        static constexpr float          kCCDBatchMaxAreaRatio = 2.f;
+
+        /// Number of CCD islands that a resolve CCD contacts job takes at once.
+        static constexpr uint32         kNumCCDIslandsPerBatch = 16;
 
         /// Broadphase layer filter that decides if two objects can collide.
         const CollisionVsBroadPhaseLayerFilter* m_pCollisionVsBroadPhaseLayerFilter = nullptr;
@@ -508,5 +645,33 @@ namespace nes
 
         /// Previous frame's delta time of one sub step to allow scaling previous frame's constraint impulses.
         float                           m_previousStepDeltaTime = 0.0f;
+
+        /// Settings and statistics of the simulation regions.
+        SimulationRegionSettings        m_simulationRegionSettings[kMaxSimulationRegions];
+        SimulationRegionStats           m_simulationRegionStats[kMaxSimulationRegions];
+
+        /// Statistics of the continuous collision detection.
+        CCDStats                        m_ccdStats;
+
+        /// Job timings and counters of the last update, and if they should be collected.
+        PhysicsStepStats                m_stepStats;
+        bool                            m_stepStatsEnabled = false;
+
+        /// Time that each simulation region skipped since it was last simulated.
+        float                           m_simulationRegionSkippedTime[kMaxSimulationRegions] = {};
+
+        /// Number of updates that were run, used to determine which simulation regions are simulated.
+        uint32                          m_simulationUpdateCount = 0;
+
+        /// If bodies may have skipped time that they need to catch up on.
+        bool                            m_hasSimulationSkippedTime = false;
+
+        /// Bodies that were frozen in this update, and the bodies that catch up on skipped time in this update.
+        /// Only used during Update(), kept to prevent allocations.
+        BodyIDVector                    m_skippedBodies;
+        BodyIDVector                    m_timeScaledBodies;
+
+        /// Bodies that moved in RestoreState(). Kept to prevent allocations.
+        BodyIDVector                    m_restoredBodies;
     };
 }
\ No newline at end of file
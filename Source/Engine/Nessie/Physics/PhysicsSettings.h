@@ -128,6 +128,10 @@ namespace nes
         /// Whether to split up large islands into smaller parallel batches of work (to improve performance).
         bool        m_useLargeIslandSplitter = true;
 
+        /// Whether to solve the contacts of parallel batches of a split island 4 at a time with SIMD. When false, they
+        /// are solved one at a time like the contacts of an island that is not split.
+        bool        m_useSIMDContactSolver = true;
+
         /// Whether objects can go to sleep or not.
         bool        m_allowSleeping = true;
 
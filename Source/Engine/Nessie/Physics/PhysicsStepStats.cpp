@@ -0,0 +1,276 @@
+// PhysicsStepStats.cpp
+#include "PhysicsStepStats.h"
+#include "Nessie/Application/Windows/WindowsInclude.h"
+#include "Nessie/Core/Memory/StackAllocator.h"
+#include "Nessie/Debug/Log.h"
+#include "Nessie/Jobs/JobSystem.h"
+#include <fstream>
+
+#ifdef NES_PLATFORM_WINDOWS
+#include <intrin.h>
+#else
+#include <ctime>
+#endif
+
+namespace nes
+{
+#ifdef NES_PLATFORM_WINDOWS
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the number of nanoseconds per cycle of the time stamp counter. QueryThreadCycleTime counts
+    ///     these cycles. The frequency is measured once against the performance counter, which takes about
+    ///     a millisecond, so this is first called when the stats are created instead of inside a job.
+    //----------------------------------------------------------------------------------------------------
+    static double GetNanosecondsPerCycle()
+    {
+        static const double nanosecondsPerCycle = []()
+        {
+            LARGE_INTEGER frequency, begin, end;
+            QueryPerformanceFrequency(&frequency);
+            QueryPerformanceCounter(&begin);
+            const uint64 beginCycles = __rdtsc();
+
+            const LONGLONG measureTicks = frequency.QuadPart / 1000;
+            do
+            {
+                QueryPerformanceCounter(&end);
+            } while (end.QuadPart - begin.QuadPart < measureTicks);
+            const uint64 endCycles = __rdtsc();
+
+            const double elapsedNs = static_cast<double>(end.QuadPart - begin.QuadPart) * 1.0e9 / static_cast<double>(frequency.QuadPart);
+            return elapsedNs / static_cast<double>(endCycles - beginCycles);
+        }();
+        return nanosecondsPerCycle;
+    }
+#endif
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the CPU time that the calling thread has used, in nanoseconds.
+    //----------------------------------------------------------------------------------------------------
+    static uint64 GetThreadCPUTime()
+    {
+    #ifdef NES_PLATFORM_WINDOWS
+        // GetThreadTimes() only advances on the scheduler tick (~15.6ms), which is longer than most jobs. The
+        // cycle time is exact, but has to be converted to time.
+        ULONG64 cycles;
+        if (!QueryThreadCycleTime(GetCurrentThread(), &cycles))
+            return 0;
+
+        return static_cast<uint64>(static_cast<double>(cycles) * GetNanosecondsPerCycle());
+    #else
+        timespec time;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+            return 0;
+
+        return static_cast<uint64>(time.tv_sec) * 1000000000ULL + static_cast<uint64>(time.tv_nsec);
+    #endif
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the index of the calling thread in the stats: 0 for a thread that is not a worker of the
+    ///     Job System, and the worker index + 1 for a worker thread.
+    //----------------------------------------------------------------------------------------------------
+    static uint32 GetThreadIndex()
+    {
+        return static_cast<uint32>(JobSystem::GetCurrentWorkerIndex() + 1);
+    }
+
+    const char* ToString(const EPhysicsJobType type)
+    {
+        switch (type)
+        {
+            case EPhysicsJobType::BroadPhasePrepare:            return "Update Broadphase Prepare";
+            case EPhysicsJobType::StepListeners:                return "Step Listeners";
+            case EPhysicsJobType::ApplyGravity:                 return "Apply Gravity";
+            case EPhysicsJobType::DetermineActiveConstraints:   return "Determine Active Constraints";
+            case EPhysicsJobType::BuildIslandsFromConstraints:  return "Build Islands From Constraints";
+            case EPhysicsJobType::SetupVelocityConstraints:     return "Setup Velocity Constraints";
+            case EPhysicsJobType::FindCollisions:               return "Find Collisions";
+            case EPhysicsJobType::BroadPhaseFinalize:           return "Update Broadphase Finalize";
+            case EPhysicsJobType::FinalizeIslands:              return "Finalize Islands";
+            case EPhysicsJobType::BodySetIslandIndex:           return "Body Set Island Index";
+            case EPhysicsJobType::SolveVelocityConstraints:     return "Solve Velocity Constraints";
+            case EPhysicsJobType::PreIntegrateVelocity:         return "Pre Integrate Velocity";
+            case EPhysicsJobType::IntegrateVelocity:            return "Integrate Velocity";
+            case EPhysicsJobType::PostIntegrateVelocity:        return "Post Integrate Velocity";
+            case EPhysicsJobType::FindCCDContacts:              return "Find CCD Contacts";
+            case EPhysicsJobType::ResolveCCDContacts:           return "Resolve CCD Contacts";
+            case EPhysicsJobType::SolvePositionConstraints:     return "Solve Position Constraints";
+            case EPhysicsJobType::ContactRemovedCallbacks:      return "Contact Removed Callbacks";
+            case EPhysicsJobType::StartNextStep:                return "Start Next Step";
+
+            default:
+                NES_ASSERT(false);
+                return "Unknown";
+        }
+    }
+
+    PhysicsStepStats::PhysicsStepStats()
+    {
+        m_jobTimings.resize(kMaxJobTimings);
+
+    #ifdef NES_PLATFORM_WINDOWS
+        // Measure the cycle frequency now, so that the first timed job doesn't.
+        GetNanosecondsPerCycle();
+    #endif
+    }
+
+    float PhysicsStepStats::GetBodyPairCacheHitRate() const
+    {
+        const uint32 numLookups = m_numBodyPairCacheHits + m_numBodyPairCacheMisses;
+        if (numLookups == 0)
+            return 0.f;
+
+        return static_cast<float>(m_numBodyPairCacheHits) / static_cast<float>(numLookups);
+    }
+
+    uint32 PhysicsStepStats::GetNumThreads() const
+    {
+        uint32 numThreads = 0;
+        const uint32 numTimings = GetNumJobTimings();
+        for (uint32 i = 0; i < numTimings; ++i)
+        {
+            numThreads = std::max(numThreads, m_jobTimings[i].m_threadIndex + 1);
+        }
+        return numThreads;
+    }
+
+    PhysicsJobTypeStats PhysicsStepStats::GetJobTypeStats(const EPhysicsJobType type) const
+    {
+        PhysicsJobTypeStats result;
+        const uint32 numTimings = GetNumJobTimings();
+        for (uint32 i = 0; i < numTimings; ++i)
+        {
+            const PhysicsJobTiming& timing = m_jobTimings[i];
+            if (timing.m_type != type)
+                continue;
+
+            ++result.m_numRuns;
+            result.m_wallTime += timing.m_wallTime;
+            result.m_cpuTime += timing.m_cpuTime;
+            result.m_maxWallTime = std::max(result.m_maxWallTime, timing.m_wallTime);
+        }
+        return result;
+    }
+
+    PhysicsJobTypeStats PhysicsStepStats::GetJobTypeStats(const EPhysicsJobType type, const uint32 threadIndex) const
+    {
+        PhysicsJobTypeStats result;
+        const uint32 numTimings = GetNumJobTimings();
+        for (uint32 i = 0; i < numTimings; ++i)
+        {
+            const PhysicsJobTiming& timing = m_jobTimings[i];
+            if (timing.m_type != type || timing.m_threadIndex != threadIndex)
+                continue;
+
+            ++result.m_numRuns;
+            result.m_wallTime += timing.m_wallTime;
+            result.m_cpuTime += timing.m_cpuTime;
+            result.m_maxWallTime = std::max(result.m_maxWallTime, timing.m_wallTime);
+        }
+        return result;
+    }
+
+    bool PhysicsStepStats::WriteTraceFile(const std::filesystem::path& path) const
+    {
+        std::ofstream stream(path);
+        if (!stream.is_open())
+        {
+            NES_ERROR("Failed to write physics trace file! Failed to open filepath: {}", path.string());
+            return false;
+        }
+
+        // Timestamps and durations in the trace event format are in microseconds.
+        stream << "{\"traceEvents\":[\n";
+        const uint32 numTimings = GetNumJobTimings();
+        for (uint32 i = 0; i < numTimings; ++i)
+        {
+            const PhysicsJobTiming& timing = m_jobTimings[i];
+            stream << "{\"name\":\"" << ToString(timing.m_type) << "\",\"cat\":\"Physics\",\"ph\":\"X\",\"pid\":0"
+                << ",\"tid\":" << timing.m_threadIndex
+                << ",\"ts\":" << static_cast<double>(timing.m_startTime) / 1000.0
+                << ",\"dur\":" << static_cast<double>(timing.m_wallTime) / 1000.0
+                << ",\"args\":{\"step\":" << static_cast<uint32>(timing.m_stepIndex)
+                << ",\"cpuTimeUs\":" << static_cast<double>(timing.m_cpuTime) / 1000.0 << "}},\n";
+        }
+
+        // Add the counters as a metadata event on the process.
+        stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"PhysicsScene::Update\""
+            << ",\"numCollisionSteps\":" << m_numCollisionSteps
+            << ",\"updateWallTimeUs\":" << static_cast<double>(m_updateWallTime) / 1000.0
+            << ",\"numBodyPairs\":" << m_numBodyPairs
+            << ",\"numManifolds\":" << m_numManifolds
+            << ",\"bodyPairCacheHitRate\":" << GetBodyPairCacheHitRate()
+            << ",\"numIslands\":" << m_numIslands
+            << ",\"maxBodiesInIsland\":" << m_maxBodiesInIsland
+            << ",\"maxConstraintsInIsland\":" << m_maxConstraintsInIsland
+            << ",\"numSplitIslands\":" << m_numSplitIslands
+            << ",\"numSplits\":" << m_numSplits
+            << ",\"stackAllocatorHighWaterMark\":" << m_stackAllocatorHighWaterMark
+            << ",\"stackAllocatorCapacity\":" << m_stackAllocatorCapacity
+            << ",\"numDroppedJobTimings\":" << GetNumDroppedJobTimings()
+            << "}}\n]}\n";
+
+        return true;
+    }
+
+    void PhysicsStepStats::Internal_BeginUpdate()
+    {
+        m_numCollisionSteps = 0;
+        m_updateWallTime = 0;
+        m_numBodyPairs = 0;
+        m_numManifolds = 0;
+        m_numBodyPairCacheHits = 0;
+        m_numBodyPairCacheMisses = 0;
+        m_numIslands = 0;
+        m_maxBodiesInIsland = 0;
+        m_maxConstraintsInIsland = 0;
+        m_numSplitIslands = 0;
+        m_numSplits = 0;
+        m_stackAllocatorHighWaterMark = 0;
+        m_stackAllocatorCapacity = 0;
+        m_numJobTimings.store(0, std::memory_order_relaxed);
+        m_beginUpdateTime = Clock::now();
+    }
+
+    void PhysicsStepStats::Internal_EndUpdate(const StackAllocator& allocator)
+    {
+        m_updateWallTime = Internal_GetTimeSinceBeginUpdate();
+        m_stackAllocatorHighWaterMark = allocator.HighWaterMark();
+        m_stackAllocatorCapacity = allocator.Capacity();
+    }
+
+    void PhysicsStepStats::Internal_AddJobTiming(const PhysicsJobTiming& timing)
+    {
+        const uint32 index = m_numJobTimings.fetch_add(1, std::memory_order_relaxed);
+        if (index < kMaxJobTimings)
+            m_jobTimings[index] = timing;
+    }
+
+    uint64 PhysicsStepStats::Internal_GetTimeSinceBeginUpdate() const
+    {
+        return static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_beginUpdateTime).count());
+    }
+
+    ScopedPhysicsJobTimer::ScopedPhysicsJobTimer(PhysicsStepStats* pStats, const EPhysicsJobType type, const uint32 stepIndex)
+        : m_pStats(pStats)
+    {
+        if (m_pStats == nullptr)
+            return;
+
+        m_timing.m_type = type;
+        m_timing.m_stepIndex = static_cast<uint8>(stepIndex);
+        m_timing.m_threadIndex = GetThreadIndex();
+        m_timing.m_cpuTime = GetThreadCPUTime();
+        m_timing.m_startTime = m_pStats->Internal_GetTimeSinceBeginUpdate();
+    }
+
+    ScopedPhysicsJobTimer::~ScopedPhysicsJobTimer()
+    {
+        if (m_pStats == nullptr)
+            return;
+
+        m_timing.m_wallTime = m_pStats->Internal_GetTimeSinceBeginUpdate() - m_timing.m_startTime;
+        m_timing.m_cpuTime = GetThreadCPUTime() - m_timing.m_cpuTime;
+        m_pStats->Internal_AddJobTiming(m_timing);
+    }
+}
@@ -0,0 +1,191 @@
+// PhysicsStepStats.h
+#pragma once
+#include "Nessie/Debug/Assert.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+namespace nes
+{
+    class StackAllocator;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : The types of jobs that PhysicsScene::Update() runs for each collision step.
+    //----------------------------------------------------------------------------------------------------
+    enum class EPhysicsJobType : uint8
+    {
+        BroadPhasePrepare,
+        StepListeners,
+        ApplyGravity,
+        DetermineActiveConstraints,
+        BuildIslandsFromConstraints,
+        SetupVelocityConstraints,
+        FindCollisions,
+        BroadPhaseFinalize,
+        FinalizeIslands,
+        BodySetIslandIndex,
+        SolveVelocityConstraints,
+        PreIntegrateVelocity,
+        IntegrateVelocity,
+        PostIntegrateVelocity,
+        FindCCDContacts,
+        ResolveCCDContacts,
+        SolvePositionConstraints,
+        ContactRemovedCallbacks,
+        StartNextStep,
+        Num,
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the name of a physics job type.
+    //----------------------------------------------------------------------------------------------------
+    const char* ToString(const EPhysicsJobType type);
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Timing of a single run of a physics job.
+    //----------------------------------------------------------------------------------------------------
+    struct PhysicsJobTiming
+    {
+        uint64                  m_startTime = 0;                        /// Start of the job in nanoseconds, relative to the start of the update.
+        uint64                  m_wallTime = 0;                         /// Time between the start and end of the job, in nanoseconds.
+        uint64                  m_cpuTime = 0;                          /// Time that the thread spent executing the job, in nanoseconds.
+        uint32                  m_threadIndex = 0;                      /// Index of the thread that ran the job: 0 for the thread that called PhysicsScene::Update() (or any other thread that is not a worker of the JobSystem), and worker index + 1 for the workers of the JobSystem.
+        uint8                   m_stepIndex = 0;                        /// Index of the collision step that the job belongs to.
+        EPhysicsJobType         m_type = EPhysicsJobType::Num;          /// Type of the job.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Accumulated timings of all runs of a type of job.
+    //----------------------------------------------------------------------------------------------------
+    struct PhysicsJobTypeStats
+    {
+        uint32                  m_numRuns = 0;                          /// Number of times that a job of the type ran.
+        uint64                  m_wallTime = 0;                         /// Summed wall time of the runs, in nanoseconds.
+        uint64                  m_cpuTime = 0;                          /// Summed CPU time of the runs, in nanoseconds.
+        uint64                  m_maxWallTime = 0;                      /// Longest wall time of a single run, in nanoseconds.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Profiling information of the last PhysicsScene::Update(). The counters are summed over all
+    ///     collision steps of the update. The stats are only collected when enabled with
+    ///     PhysicsScene::SetStepStatsEnabled(), as timing every job adds a small cost to each job.
+    //----------------------------------------------------------------------------------------------------
+    class PhysicsStepStats
+    {
+    public:
+        /// Maximum number of job runs that are recorded in a single update. Runs past this number are only counted.
+        static constexpr uint32 kMaxJobTimings = 4096;
+
+    public:
+        PhysicsStepStats();
+        PhysicsStepStats(const PhysicsStepStats&) = delete;
+        PhysicsStepStats& operator=(const PhysicsStepStats&) = delete;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the fraction of body pairs for which the contacts could be taken from the contact cache
+        ///     of the previous update (see PhysicsSettings::m_useBodyPairContactCache). Returns 0 if the cache
+        ///     was not used.
+        //----------------------------------------------------------------------------------------------------
+        float                   GetBodyPairCacheHitRate() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of job runs that were recorded.
+        //----------------------------------------------------------------------------------------------------
+        uint32                  GetNumJobTimings() const                { return std::min(m_numJobTimings.load(std::memory_order_relaxed), kMaxJobTimings); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of job runs that didn't fit in the recorded timings.
+        //----------------------------------------------------------------------------------------------------
+        uint32                  GetNumDroppedJobTimings() const         { return m_numJobTimings.load(std::memory_order_relaxed) - GetNumJobTimings(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get a recorded job run, in the order in which the jobs finished.
+        //----------------------------------------------------------------------------------------------------
+        const PhysicsJobTiming& GetJobTiming(const uint32 index) const  { NES_ASSERT(index < GetNumJobTimings()); return m_jobTimings[index]; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of threads that ran jobs. Thread indices in the timings are less than this
+        ///     number. See PhysicsJobTiming::m_threadIndex for how indices map to the workers of the JobSystem.
+        //----------------------------------------------------------------------------------------------------
+        uint32                  GetNumThreads() const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the accumulated timings of a type of job, over all threads.
+        //----------------------------------------------------------------------------------------------------
+        PhysicsJobTypeStats     GetJobTypeStats(const EPhysicsJobType type) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the accumulated timings of a type of job, for a single thread.
+        //----------------------------------------------------------------------------------------------------
+        PhysicsJobTypeStats     GetJobTypeStats(const EPhysicsJobType type, const uint32 threadIndex) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write the recorded job runs to a file in the Chrome trace event format, which can be opened
+        ///     in chrome://tracing or https://ui.perfetto.dev. The counters are added as metadata.
+        ///	@returns : False if the file could not be opened.
+        //----------------------------------------------------------------------------------------------------
+        bool                    WriteTraceFile(const std::filesystem::path& path) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Reset the stats at the start of an update.
+        //----------------------------------------------------------------------------------------------------
+        void                    Internal_BeginUpdate();
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Record the totals at the end of an update.
+        //----------------------------------------------------------------------------------------------------
+        void                    Internal_EndUpdate(const StackAllocator& allocator);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Record a job run. Can be called from multiple threads at the same time.
+        //----------------------------------------------------------------------------------------------------
+        void                    Internal_AddJobTiming(const PhysicsJobTiming& timing);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of nanoseconds since the start of the update.
+        //----------------------------------------------------------------------------------------------------
+        uint64                  Internal_GetTimeSinceBeginUpdate() const;
+
+    public:
+        uint32                  m_numCollisionSteps = 0;                /// Number of collision steps that were simulated.
+        uint64                  m_updateWallTime = 0;                   /// Time spent in PhysicsScene::Update(), in nanoseconds.
+        uint32                  m_numBodyPairs = 0;                     /// Number of body pairs found by the broadphase.
+        uint32                  m_numManifolds = 0;                     /// Number of contact manifolds found by the narrow phase.
+        uint32                  m_numBodyPairCacheHits = 0;             /// Number of body pairs for which the contacts of the previous update were reused.
+        uint32                  m_numBodyPairCacheMisses = 0;           /// Number of body pairs that were looked up in the contact cache, but needed to do collision detection.
+        uint32                  m_numIslands = 0;                       /// Number of simulation islands.
+        uint32                  m_maxBodiesInIsland = 0;                /// Number of bodies in the largest island.
+        uint32                  m_maxConstraintsInIsland = 0;           /// Number of constraints and contacts in the largest island.
+        uint32                  m_numSplitIslands = 0;                  /// Number of islands that were split by the LargeIslandSplitter.
+        uint32                  m_numSplits = 0;                        /// Total number of splits that the split islands were divided into.
+        size_t                  m_stackAllocatorHighWaterMark = 0;      /// Highest number of bytes used in the temporary allocator during the update.
+        size_t                  m_stackAllocatorCapacity = 0;           /// Capacity of the temporary allocator, in bytes.
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        std::vector<PhysicsJobTiming> m_jobTimings;                     /// Recorded job runs. Sized to kMaxJobTimings.
+        std::atomic<uint32>     m_numJobTimings = 0;                    /// Number of job runs that were added, including those that didn't fit.
+        Clock::time_point       m_beginUpdateTime;                      /// Time at the start of the update.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : On construction, stores the current time. On destruction, adds the timing of the job to the
+    ///     stats. Does nothing if the stats are null, which is the case when collecting stats is disabled.
+    //----------------------------------------------------------------------------------------------------
+    class ScopedPhysicsJobTimer
+    {
+    public:
+        ScopedPhysicsJobTimer(PhysicsStepStats* pStats, const EPhysicsJobType type, const uint32 stepIndex);
+        ~ScopedPhysicsJobTimer();
+
+        ScopedPhysicsJobTimer(const ScopedPhysicsJobTimer&) = delete;
+        ScopedPhysicsJobTimer& operator=(const ScopedPhysicsJobTimer&) = delete;
+
+    private:
+        PhysicsStepStats*       m_pStats;
+        PhysicsJobTiming        m_timing;
+    };
+}
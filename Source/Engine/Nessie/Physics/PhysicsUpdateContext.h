@@ -14,6 +14,7 @@ namespace nes
     class PhysicsScene;
     class Constraint;
     class IslandBuilder;
+    class PhysicsStepStats;
 
     //----------------------------------------------------------------------------------------------------
     /// @brief : Information maintained during the PhysicsScene::Update(). 
@@ -73,7 +74,7 @@ namespace nes
 
                 Vec3            m_deltaPosition;
                 Vec3            m_contactNormal;
-                Vec3            m_contactPointOn2;
+                RVec3           m_contactPointOn2;
                 BodyID          m_bodyID1;
                 BodyID          m_bodyID2;
                 SubShapeID      m_subShapeID2;
@@ -90,6 +91,7 @@ namespace nes
             PhysicsUpdateContext* m_pContext = nullptr;                                 /// The Physics Update Context associated with this Step.
             bool                m_isFirst;                                              /// If this is the first step.
             bool                m_isLast;                                               /// If this is the last step.
+            uint32              m_stepIndex = 0;                                        /// Index of this step in the update.
             
             BroadPhase::UpdateState m_broadPhaseUpdateState;                            /// Handle returned by BroadPhase::UpdatePrepare().
             uint32              m_numActiveBodiesAtStepStart;                           /// Number of bodies that were active at the start of the Step. Only these bodies will receive Gravity. They are the first N in the active Body List.
@@ -119,6 +121,8 @@ namespace nes
 
             std::atomic<uint>   m_numBodyPairs { 0 };                             /// The number of Body Pairs found during this Step. This is used to size the Contact Cache in the next step. 
             std::atomic<uint>   m_numManifolds { 0 };                             /// The number of Manifolds found during this Step. This is used to size the Contact Cache in the next step.
+            std::atomic<uint>   m_numBodyPairCacheHits { 0 };                     /// The number of Body Pairs whose contacts were taken from the Contact Cache during this Step.
+            std::atomic<uint>   m_numBodyPairCacheMisses { 0 };                   /// The number of Body Pairs that missed the Contact Cache during this Step.
 
             std::atomic<uint32> m_solveVelocityConstraintsNextIsland { 0 };       /// Next Island that needs to be processed for the velocity constraints step. (Doesn't need its own cache line as position jobs won't run at the same time).
             std::atomic<uint32> m_solvePositionConstraintsNextIsland { 0 };       /// Next Island that needs to be processed for the velocity constraints step. (Doesn't need its own cache line as position jobs won't run at the same time).
@@ -131,6 +135,16 @@ namespace nes
             std::atomic<uint32> m_nextCCDBody = 0;                                      /// Next unprocessed body index in m_pCCDBodies;
             int*                m_pActiveBodyToCCDBody = nullptr;                        /// Mappings between an index in BodyManager::m_activeBodies and the index in m_pCCDBodies.
             uint32              m_numActiveBodyToCCDBodies = 0;                         /// Number of indices in m_activeBodyToCCDBody.
+            uint32*             m_pCCDBodyOrder = nullptr;                              /// Indices in m_pCCDBodies, sorted by collision layer and position so that bodies that are close together are cast in the same batch.
+            CCDBody**           m_pSortedCCDBodies = nullptr;                           /// CCD Bodies sorted by hit fraction, in the order in which they are resolved.
+            uint32*             m_pCCDIslandBodies = nullptr;                           /// Indices in m_pSortedCCDBodies, grouped by CCD island. Within an island, the sorted order is kept.
+            uint32*             m_pCCDIslandStarts = nullptr;                           /// Start of each CCD island in m_pCCDIslandBodies, with an extra entry for the end of the last island.
+            uint32              m_numCCDIslands = 0;                                    /// Number of groups of CCD bodies that don't interact with each other and can be resolved in parallel.
+            BodyID*             m_pCCDBodiesToActivate = nullptr;                       /// For each sorted CCD body, the body that it hit and needs to be activated (or an invalid ID).
+            std::atomic<uint32> m_nextCCDIsland = 0;                                    /// Next unprocessed island index in m_pCCDIslandStarts.
+            std::atomic<uint32> m_numCCDResolveJobsLeft = 0;                            /// Number of resolve jobs that still need to finish. The last one frees the CCD data.
+            std::atomic<uint32> m_numCCDBroadPhaseQueries = 0;                          /// Number of broadphase queries done to find CCD contacts.
+            std::atomic<uint32> m_numCCDCandidatesTested = 0;                           /// Number of bodies returned by the broadphase that were tested against a CCD body.
 
             // Jobs in Order of Execution. Some run in parallel.
             // BROADPHASE
@@ -182,6 +196,7 @@ namespace nes
         Constraint**            m_pActiveConstraints = nullptr;
         BodyPair*               m_pBodyPairs = nullptr;
         IslandBuilder*          m_pIslandBuilder;
+        PhysicsStepStats*       m_pStepStats = nullptr;                         /// Stats to record the job timings in. Null if collecting stats is disabled.
         Steps                   m_steps;
         //unsigned int            m_numSoftBodies;
         //SoftBodyUpdateContext*  m_softBodyUpdateContexts = nullptr;
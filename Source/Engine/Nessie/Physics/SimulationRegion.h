@@ -0,0 +1,56 @@
+// SimulationRegion.h
+#pragma once
+#include "Nessie/Core/Config.h"
+
+namespace nes
+{
+    /// Maximum number of simulation regions. Region 0 is the default region of all bodies.
+    static constexpr uint32 kMaxSimulationRegions = 4;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Settings for a group of bodies that can be simulated at a lower rate than the rest of the
+    ///     scene. Typically used to simulate bodies that are far away from the camera more coarsely:
+    ///     for example, region 0 at the full rate, region 1 every 2nd update and region 2 every 4th update
+    ///     with fewer solver iterations.
+    ///
+    ///     A body that is in a region that is not simulated in an update is frozen: it is removed from the
+    ///     active bodies for that update, and its velocity and contacts are kept. A frozen body is still
+    ///     active (Body::IsActive()), Body::IsSimulationSkipped() tells it apart. The time that it skipped
+    ///     is added to the next update in which its region is simulated, so that the body still moves at
+    ///     the correct speed. When a simulated body touches a frozen body, or the two are connected by a
+    ///     constraint, the frozen body is woken up and is simulated at the full rate for that update.
+    /// @see : PhysicsScene::SetSimulationRegionSettings(), BodyInterface::SetSimulationRegion().
+    //----------------------------------------------------------------------------------------------------
+    struct SimulationRegionSettings
+    {
+        /// The region is simulated once every 'm_stepInterval' updates. 1 means that it is simulated every update.
+        /// The regions are staggered, so that two regions with the same interval aren't simulated in the same update.
+        uint32              m_stepInterval = 1;
+
+        /// Number of solver velocity iterations for the bodies in this region that don't have their own override,
+        /// and for the constraints connected to them. Applies to split and regular islands alike.
+        /// 0 means use the default in PhysicsSettings::m_numVelocitySteps.
+        uint32              m_numVelocityStepsOverride = 0;
+
+        /// Number of solver position iterations for the bodies in this region that don't have their own override,
+        /// and for the constraints connected to them.
+        /// 0 means use the default in PhysicsSettings::m_numPositionSteps.
+        uint32              m_numPositionStepsOverride = 0;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Statistics of a simulation region, for the last PhysicsScene::Update(). The number of bodies
+    ///     is only counted in updates in which a region is skipped or in which step stats are enabled, otherwise
+    ///     the active bodies are not visited. The wall times are only measured when step stats are enabled,
+    ///     see PhysicsScene::SetStepStatsEnabled().
+    //----------------------------------------------------------------------------------------------------
+    struct SimulationRegionStats
+    {
+        uint32              m_numSimulatedBodies = 0;       /// Number of active bodies of the region that were simulated.
+        uint32              m_numSkippedBodies = 0;         /// Number of active bodies of the region that were frozen for the update.
+        float               m_simulatedDeltaTime = 0.f;     /// Delta time that the region was advanced by, including the time of skipped updates. 0 if it was skipped.
+        uint64              m_stepWallTime = 0;             /// Wall time of the update that advanced the region, in nanoseconds. 0 if it was skipped.
+        uint64              m_wallTime = 0;                 /// Part of m_stepWallTime spent on the region, in nanoseconds. All regions are solved together, so this is
+                                                            /// the wall time of the update divided over the regions by their share of the simulated bodies.
+    };
+}
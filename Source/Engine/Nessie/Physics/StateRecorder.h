@@ -0,0 +1,135 @@
+// StateRecorder.h
+#pragma once
+#include <type_traits>
+#include "Nessie/Core/Macro.h"
+#include "Nessie/Math/Math.h"
+
+namespace nes
+{
+    class Body;
+    class BodyID;
+    class Constraint;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Which parts of the PhysicsScene state to save.
+    //----------------------------------------------------------------------------------------------------
+    enum class EStateRecorderState : uint8
+    {
+        None        = 0,                                    /// Save nothing.
+        Global      = NES_BIT(0),                           /// Save the global physics scene state (gravity and the delta time of the previous step).
+        Bodies      = NES_BIT(1),                           /// Save the state of the bodies.
+        Contacts    = NES_BIT(2),                           /// Save the state of the contact cache.
+        Constraints = NES_BIT(3),                           /// Save the state of the constraints.
+        All         = Global | Bodies | Contacts | Constraints, /// Save everything.
+    };
+    NES_DEFINE_BIT_OPERATIONS_FOR_ENUM(EStateRecorderState);
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Filter that selects which bodies, constraints and contacts are saved or restored. The
+    ///     default implementation accepts everything.
+    //----------------------------------------------------------------------------------------------------
+    class StateRecorderFilter
+    {
+    public:
+        virtual ~StateRecorderFilter() = default;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : If the state of this body should be saved.
+        //----------------------------------------------------------------------------------------------------
+        virtual bool    ShouldSaveBody([[maybe_unused]] const Body& body) const                                             { return true; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : If the state of this constraint should be saved.
+        //----------------------------------------------------------------------------------------------------
+        virtual bool    ShouldSaveConstraint([[maybe_unused]] const Constraint& constraint) const                           { return true; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : If the cached contacts between these two bodies should be saved.
+        //----------------------------------------------------------------------------------------------------
+        virtual bool    ShouldSaveContact([[maybe_unused]] const BodyID& body1, [[maybe_unused]] const BodyID& body2) const     { return true; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : If the cached contacts between these two bodies should be restored.
+        //----------------------------------------------------------------------------------------------------
+        virtual bool    ShouldRestoreContact([[maybe_unused]] const BodyID& body1, [[maybe_unused]] const BodyID& body2) const  { return true; }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Binary stream that the state of a PhysicsScene is written to and read from. Values are
+    ///     stored as raw bytes without any type information, so the state must be read back in the same
+    ///     order with the same types and on a machine with the same endianness.
+    /// @see : StateRecorderImpl for an implementation that stores the state in memory.
+    //----------------------------------------------------------------------------------------------------
+    class StateRecorder
+    {
+    public:
+        StateRecorder() = default;
+        StateRecorder(const StateRecorder&) = delete;
+        StateRecorder& operator=(const StateRecorder&) = delete;
+        virtual ~StateRecorder() = default;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write 'numBytes' bytes to the stream.
+        //----------------------------------------------------------------------------------------------------
+        virtual void    WriteBytes(const void* pData, const size_t numBytes) = 0;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Read 'numBytes' bytes from the stream. If there are not enough bytes left, the stream is
+        ///     marked as failed.
+        //----------------------------------------------------------------------------------------------------
+        virtual void    ReadBytes(void* pOutData, const size_t numBytes) = 0;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true when all data has been read.
+        //----------------------------------------------------------------------------------------------------
+        virtual bool    IsEOF() const = 0;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true if reading from the stream failed.
+        //----------------------------------------------------------------------------------------------------
+        virtual bool    IsFailed() const = 0;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write a trivially copyable value.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Type> requires std::is_trivially_copyable_v<Type>
+        void            Write(const Type& value)                                { WriteBytes(&value, sizeof(Type)); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write a Vec3. Only the 3 components are written, not the padding.
+        //----------------------------------------------------------------------------------------------------
+        void            Write(const Vec3& value)                                { WriteBytes(&value, 3 * sizeof(float)); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Read a trivially copyable value.
+        //----------------------------------------------------------------------------------------------------
+        template <typename Type> requires std::is_trivially_copyable_v<Type>
+        void            Read(Type& outValue)                                    { ReadBytes(&outValue, sizeof(Type)); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Read a Vec3 that was written with Write(const Vec3&).
+        //----------------------------------------------------------------------------------------------------
+        void            Read(Vec3& outValue)                                    { ReadBytes(&outValue, 3 * sizeof(float)); }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : StateRecorder that doesn't store anything, it only counts the number of bytes that are
+    ///     written. Used to find the size of a piece of state before reading it.
+    //----------------------------------------------------------------------------------------------------
+    class StateRecorderSizeCounter final : public StateRecorder
+    {
+    public:
+        virtual void    WriteBytes(const void*, const size_t numBytes) override  { m_size += numBytes; }
+        virtual void    ReadBytes(void*, const size_t) override                 { NES_ASSERT(false, "Cannot read from a StateRecorderSizeCounter!"); }
+        virtual bool    IsEOF() const override                                  { return true; }
+        virtual bool    IsFailed() const override                               { return false; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the number of bytes that were written.
+        //----------------------------------------------------------------------------------------------------
+        size_t          GetSize() const                                         { return m_size; }
+
+    private:
+        size_t          m_size = 0;
+    };
+}
@@ -0,0 +1,191 @@
+// StateRecorderImpl.cpp
+#include "StateRecorderImpl.h"
+#include <cstring>
+
+namespace nes
+{
+    namespace internal
+    {
+        /// Size of the blocks of bytes that are compared when writing a delta.
+        static constexpr size_t kDeltaBlockSize = sizeof(uint64);
+
+        /// Size of the header of a range of changed bytes in a delta (the number of equal bytes before the range and the
+        /// number of changed bytes). A gap of equal bytes that is not larger than this is cheaper to store as changed bytes.
+        static constexpr size_t kDeltaRangeHeaderSize = 2 * sizeof(uint32);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true if the block of bytes starting at 'position' is the same in both buffers.
+        ///     A block that extends past the end of the base buffer is never equal.
+        //----------------------------------------------------------------------------------------------------
+        static bool IsEqualDeltaBlock(const uint8* pData, const size_t dataSize, const uint8* pBase, const size_t baseSize, const size_t position)
+        {
+            if (position + kDeltaBlockSize <= dataSize && position + kDeltaBlockSize <= baseSize)
+            {
+                uint64 dataBlock, baseBlock;
+                std::memcpy(&dataBlock, pData + position, kDeltaBlockSize);
+                std::memcpy(&baseBlock, pBase + position, kDeltaBlockSize);
+                return dataBlock == baseBlock;
+            }
+
+            // Last block, which is smaller than the block size.
+            const size_t blockSize = dataSize - position;
+            return position + blockSize <= baseSize && std::memcmp(pData + position, pBase + position, blockSize) == 0;
+        }
+    }
+
+    StateRecorderImpl::StateRecorderImpl(StateRecorderImpl&& other) noexcept
+        : m_data(std::move(other.m_data))
+        , m_dataSize(other.m_dataSize)
+        , m_readPosition(other.m_readPosition)
+        , m_failed(other.m_failed)
+    {
+        other.Clear();
+    }
+
+    StateRecorderImpl& StateRecorderImpl::operator=(StateRecorderImpl&& other) noexcept
+    {
+        if (this != &other)
+        {
+            m_data = std::move(other.m_data);
+            m_dataSize = other.m_dataSize;
+            m_readPosition = other.m_readPosition;
+            m_failed = other.m_failed;
+            other.Clear();
+        }
+
+        return *this;
+    }
+
+    void StateRecorderImpl::WriteBytes(const void* pData, const size_t numBytes)
+    {
+        // Grow geometrically. The buffer is never shrunk, so a recorder that is reused doesn't allocate.
+        if (m_dataSize + numBytes > m_data.size())
+            m_data.resize(math::Max(m_data.size() * 2, m_dataSize + numBytes));
+
+        std::memcpy(m_data.data() + m_dataSize, pData, numBytes);
+        m_dataSize += numBytes;
+    }
+
+    void StateRecorderImpl::WriteBytesFrom(StateRecorder& source, const size_t numBytes)
+    {
+        if (m_dataSize + numBytes > m_data.size())
+            m_data.resize(math::Max(m_data.size() * 2, m_dataSize + numBytes));
+
+        source.ReadBytes(m_data.data() + m_dataSize, numBytes);
+        m_dataSize += numBytes;
+    }
+
+    void StateRecorderImpl::ReadBytes(void* pOutData, const size_t numBytes)
+    {
+        if (m_failed || numBytes > m_dataSize - m_readPosition)
+        {
+            m_failed = true;
+            std::memset(pOutData, 0, numBytes);
+            return;
+        }
+
+        std::memcpy(pOutData, m_data.data() + m_readPosition, numBytes);
+        m_readPosition += numBytes;
+    }
+
+    void StateRecorderImpl::Resize(const size_t numBytes)
+    {
+        if (numBytes > m_data.size())
+            m_data.resize(numBytes);
+
+        m_dataSize = numBytes;
+        Rewind();
+    }
+
+    void StateRecorderImpl::SetData(const void* pData, const size_t numBytes)
+    {
+        Resize(numBytes);
+        std::memcpy(m_data.data(), pData, numBytes);
+    }
+
+    bool StateRecorderImpl::IsEqual(const StateRecorderImpl& other) const
+    {
+        return m_dataSize == other.m_dataSize
+            && std::memcmp(m_data.data(), other.m_data.data(), m_dataSize) == 0;
+    }
+
+    void StateRecorderImpl::WriteDelta(const StateRecorderImpl& base, StateRecorder& outDelta) const
+    {
+        const size_t size = m_dataSize;
+        outDelta.Write(static_cast<uint64>(size));
+
+        size_t position = 0;
+        for (;;)
+        {
+            // Skip the blocks that didn't change.
+            size_t changedBegin = position;
+            while (changedBegin < size && internal::IsEqualDeltaBlock(m_data.data(), size, base.m_data.data(), base.m_dataSize, changedBegin))
+                changedBegin += internal::kDeltaBlockSize;
+
+            if (changedBegin >= size)
+                break;
+
+            // Find the end of the changed range. Small gaps of equal bytes are included in the range, as they take
+            // less space than the header of a new range.
+            size_t changedEnd = changedBegin;
+            for (size_t blockBegin = changedBegin; blockBegin < size; blockBegin += internal::kDeltaBlockSize)
+            {
+                if (!internal::IsEqualDeltaBlock(m_data.data(), size, base.m_data.data(), base.m_dataSize, blockBegin))
+                    changedEnd = math::Min(blockBegin + internal::kDeltaBlockSize, size);
+                else if (blockBegin + internal::kDeltaBlockSize - changedEnd > internal::kDeltaRangeHeaderSize)
+                    break;
+            }
+
+            // Write the range.
+            outDelta.Write(static_cast<uint32>(changedBegin - position));
+            outDelta.Write(static_cast<uint32>(changedEnd - changedBegin));
+            outDelta.WriteBytes(m_data.data() + changedBegin, changedEnd - changedBegin);
+            position = changedEnd;
+        }
+
+        // Terminate with an empty range. The remaining bytes are equal to the base.
+        outDelta.Write(static_cast<uint32>(0));
+        outDelta.Write(static_cast<uint32>(0));
+    }
+
+    bool StateRecorderImpl::ReadDelta(const StateRecorderImpl& base, StateRecorder& delta)
+    {
+        uint64 size = 0;
+        delta.Read(size);
+        if (delta.IsFailed())
+            return false;
+
+        Resize(static_cast<size_t>(size));
+
+        size_t position = 0;
+        for (;;)
+        {
+            uint32 numEqualBytes = 0;
+            uint32 numChangedBytes = 0;
+            delta.Read(numEqualBytes);
+            delta.Read(numChangedBytes);
+            if (delta.IsFailed())
+                return false;
+
+            // Check for the terminating range.
+            if (numEqualBytes == 0 && numChangedBytes == 0)
+                break;
+
+            if (position + numEqualBytes > base.m_dataSize || position + numEqualBytes + numChangedBytes > m_dataSize)
+                return false;
+
+            std::memcpy(m_data.data() + position, base.m_data.data() + position, numEqualBytes);
+            position += numEqualBytes;
+
+            delta.ReadBytes(m_data.data() + position, numChangedBytes);
+            position += numChangedBytes;
+        }
+
+        // The remaining bytes are equal to the base.
+        if (m_dataSize > base.m_dataSize && position < m_dataSize)
+            return false;
+
+        std::memcpy(m_data.data() + position, base.m_data.data() + position, m_dataSize - position);
+        return !delta.IsFailed();
+    }
+}
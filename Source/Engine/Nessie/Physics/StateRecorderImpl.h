@@ -0,0 +1,95 @@
+// StateRecorderImpl.h
+#pragma once
+#include <vector>
+#include "StateRecorder.h"
+
+namespace nes
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : StateRecorder that stores the state in a block of memory. Clearing the recorder keeps the
+    ///     memory, so a recorder that is reused for every snapshot doesn't allocate once it has grown to
+    ///     the size of the state.
+    ///
+    /// A snapshot can be compressed against a previous snapshot with WriteDelta(), which only stores the
+    /// bytes that changed. This works best when the same bodies, contacts and constraints are saved in
+    /// both snapshots, which is the case for consecutive frames.
+    //----------------------------------------------------------------------------------------------------
+    class StateRecorderImpl final : public StateRecorder
+    {
+    public:
+        StateRecorderImpl() = default;
+        StateRecorderImpl(StateRecorderImpl&& other) noexcept;
+        StateRecorderImpl& operator=(StateRecorderImpl&& other) noexcept;
+
+        virtual void        WriteBytes(const void* pData, const size_t numBytes) override;
+        virtual void        ReadBytes(void* pOutData, const size_t numBytes) override;
+        virtual bool        IsEOF() const override                      { return m_readPosition >= m_dataSize; }
+        virtual bool        IsFailed() const override                   { return m_failed; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write 'numBytes' bytes that are read from another stream, without an intermediate copy.
+        //----------------------------------------------------------------------------------------------------
+        void                WriteBytesFrom(StateRecorder& source, const size_t numBytes);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Start reading from the beginning of the stream again, and reset the failed state.
+        //----------------------------------------------------------------------------------------------------
+        void                Rewind()                                    { m_readPosition = 0; m_failed = false; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Remove all data. The memory is kept for the next snapshot.
+        //----------------------------------------------------------------------------------------------------
+        void                Clear()                                     { m_dataSize = 0; Rewind(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Reserve memory for 'numBytes' bytes of state.
+        //----------------------------------------------------------------------------------------------------
+        void                Reserve(const size_t numBytes)              { if (numBytes > m_data.size()) m_data.resize(numBytes); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the recorded data, for example to send it over the network.
+        //----------------------------------------------------------------------------------------------------
+        const uint8*        GetData() const                             { return m_data.data(); }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the size of the recorded data in bytes.
+        //----------------------------------------------------------------------------------------------------
+        size_t              GetDataSize() const                         { return m_dataSize; }
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Replace the data with a copy of 'numBytes' bytes of data, and rewind the stream.
+        //----------------------------------------------------------------------------------------------------
+        void                SetData(const void* pData, const size_t numBytes);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Returns true if both recorders contain the same data. Can be used to check that a
+        ///     re-simulation after a rollback ends in the same state.
+        //----------------------------------------------------------------------------------------------------
+        bool                IsEqual(const StateRecorderImpl& other) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Write the difference between this snapshot and 'base' to 'outDelta'. Only the ranges of
+        ///     bytes that differ are written.
+        //----------------------------------------------------------------------------------------------------
+        void                WriteDelta(const StateRecorderImpl& base, StateRecorder& outDelta) const;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Replace the data with the snapshot that is reconstructed from 'base' and a delta that was
+        ///     written with WriteDelta() against the same base, and rewind the stream.
+        /// @returns : False if the delta is malformed, in which case the data is undefined.
+        //----------------------------------------------------------------------------------------------------
+        bool                ReadDelta(const StateRecorderImpl& base, StateRecorder& delta);
+
+    private:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Set the size of the data to 'numBytes', growing the buffer if needed, and rewind the stream.
+        //----------------------------------------------------------------------------------------------------
+        void                Resize(const size_t numBytes);
+
+    private:
+        std::vector<uint8>  m_data;                 /// Buffer, of which the first m_dataSize bytes are in use.
+        size_t              m_dataSize = 0;
+        size_t              m_readPosition = 0;
+        bool                m_failed = false;
+    };
+}
@@ -0,0 +1,52 @@
+-- EngineBenchmarks Project Configuration.
+-- Premake Documentation: https://premake.github.io/docs/
+
+local projectCore = require("ProjectCore");
+
+local p = {};
+p.Name = "EngineBenchmarks";
+
+function p.ConfigureProject(dependencyInjector)
+    local projectDir = p.BuildDirectory .. "/EngineBenchmarks/";
+    local testsDir = p.BuildDirectory .. "/EngineTests/";
+
+    projectCore.SetProjectDefaults();
+    kind "ConsoleApp"
+    
+    dependencyInjector.Link("Nessie");
+    dependencyInjector.Link("Assimp");
+    dependencyInjector.Link("Vulkan");
+
+    filter {}
+
+    -- The benchmarks set up their scenes with the helpers of the EngineTests project.
+    includedirs
+    {
+        projectDir,
+        testsDir,
+    }
+
+    disablewarnings
+    {
+        "4324", -- "'X' : structure was padded due to alignment specifier"
+    }
+
+    files
+    {
+        projectDir .. "**.h",
+        projectDir .. "**.hpp",
+        projectDir .. "**.cpp",
+        projectDir .. "**.ixx",
+        projectDir .. "**.inl",
+        testsDir .. "Physics/PhysicsTestContext.h",
+        testsDir .. "Physics/PhysicsTestContext.cpp",
+    }
+
+    vpaths
+    {
+        ["Source/*"] = { p.BuildDirectory .. "/EngineBenchmarks/**.*"},
+        ["Source/EngineTests/*"] = { testsDir .. "**.*"},
+    }
+end
+
+return p;
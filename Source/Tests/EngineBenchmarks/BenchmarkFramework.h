@@ -0,0 +1,86 @@
+// BenchmarkFramework.h
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "Nessie/Core/Config.h"
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : A registered benchmark. Benchmarks are registered with the NES_BENCHMARK() macro, and run by
+///     main() in EngineBenchmarks.cpp.
+//----------------------------------------------------------------------------------------------------
+struct BenchmarkCase
+{
+    using Function = void(*)();
+
+    const char*                 m_pName = nullptr;
+    const char*                 m_pFile = nullptr;
+    Function                    m_function = nullptr;
+};
+
+namespace benchmark
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Timings of a number of iterations of the same work.
+    //----------------------------------------------------------------------------------------------------
+    struct BenchmarkResult
+    {
+        uint32                  m_numIterations = 0;
+        double                  m_averageMs = 0.0;      /// Average time of an iteration, in milliseconds.
+        double                  m_minMs = 0.0;          /// Fastest iteration, in milliseconds.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get all benchmarks that have been registered.
+    //----------------------------------------------------------------------------------------------------
+    std::vector<BenchmarkCase>& GetBenchmarkCases();
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Print a result on a single line. If numItemsPerIteration is not 0, the throughput in items
+    ///     per second is printed as well, based on the average time.
+    //----------------------------------------------------------------------------------------------------
+    void                        Report(const char* pLabel, const BenchmarkResult& result, const uint64 numItemsPerIteration = 0);
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Call the function numIterations times, and time each call.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Function>
+    BenchmarkResult             Measure(const uint32 numIterations, Function&& function)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        BenchmarkResult result;
+        result.m_numIterations = numIterations;
+        result.m_minMs = 1.0e30;
+
+        double totalMs = 0.0;
+        for (uint32 i = 0; i < numIterations; ++i)
+        {
+            const Clock::time_point start = Clock::now();
+            function();
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            totalMs += ms;
+            result.m_minMs = std::min(result.m_minMs, ms);
+        }
+
+        result.m_averageMs = numIterations > 0? totalMs / static_cast<double>(numIterations) : 0.0;
+        return result;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Helper to register a benchmark before main() is run.
+    //----------------------------------------------------------------------------------------------------
+    struct BenchmarkRegistrar
+    {
+        BenchmarkRegistrar(const char* pName, const char* pFile, BenchmarkCase::Function function) { GetBenchmarkCases().push_back({ pName, pFile, function }); }
+    };
+}
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Define a benchmark function that is run by the EngineBenchmarks executable.
+//----------------------------------------------------------------------------------------------------
+#define NES_BENCHMARK(benchmarkName)                                                                        \
+    static void benchmarkName();                                                                            \
+    static const ::benchmark::BenchmarkRegistrar NES_MERGE_TOKENS(s_registrar_, benchmarkName)(#benchmarkName, __FILE__, &benchmarkName); \
+    static void benchmarkName()
@@ -0,0 +1,67 @@
+// EngineBenchmarks.cpp
+#include <cstdio>
+#include <cstring>
+#include "BenchmarkFramework.h"
+#include "Nessie/Core/Memory/Memory.h"
+#include "Nessie/Debug/Log.h"
+#include "Nessie/Math/MathConfig.h"
+
+namespace benchmark
+{
+    std::vector<BenchmarkCase>& GetBenchmarkCases()
+    {
+        static std::vector<BenchmarkCase> s_benchmarkCases;
+        return s_benchmarkCases;
+    }
+
+    void Report(const char* pLabel, const BenchmarkResult& result, const uint64 numItemsPerIteration)
+    {
+        std::printf("    %-40s avg %9.3f ms  min %9.3f ms", pLabel, result.m_averageMs, result.m_minMs);
+        if (numItemsPerIteration > 0 && result.m_averageMs > 0.0)
+            std::printf("  %12.0f items/s", static_cast<double>(numItemsPerIteration) * 1000.0 / result.m_averageMs);
+        std::printf("\n");
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+// Description of the configuration that the engine was compiled with, so that the results of different
+// builds can be told apart.
+//----------------------------------------------------------------------------------------------------
+#if defined(NES_USE_AVX2)
+    #define NES_BENCHMARK_SIMD_TIER "AVX2"
+#elif defined(NES_USE_SSE4_2)
+    #define NES_BENCHMARK_SIMD_TIER "SSE4.2"
+#elif defined(NES_USE_SSE)
+    #define NES_BENCHMARK_SIMD_TIER "SSE2"
+#else
+    #define NES_BENCHMARK_SIMD_TIER "Scalar"
+#endif
+
+static constexpr const char* kBuildDescription = NES_BENCHMARK_SIMD_TIER ", " NES_IF_SINGLE_PRECISION_ELSE("single", "double") " precision" NES_IF_DEBUG(", debug");
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Runs every registered benchmark, or only those whose name contains the first argument.
+//----------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    NES_INIT_LEAK_DETECTOR();
+    nes::LoggerRegistry::Instance().Internal_Init();
+
+    const char* pFilter = argc > 1? argv[1] : nullptr;
+    std::printf("EngineBenchmarks (%s)\n", kBuildDescription);
+
+    for (const BenchmarkCase& benchmarkCase : benchmark::GetBenchmarkCases())
+    {
+        if (pFilter != nullptr && std::strstr(benchmarkCase.m_pName, pFilter) == nullptr)
+            continue;
+
+        std::printf("[ RUN  ] %s\n", benchmarkCase.m_pName);
+        benchmarkCase.m_function();
+        std::printf("[ DONE ] %s\n", benchmarkCase.m_pName);
+    }
+
+    nes::LoggerRegistry::Instance().Internal_Shutdown();
+    NES_DUMP_AND_DESTROY_LEAK_DETECTOR();
+
+    return 0;
+}
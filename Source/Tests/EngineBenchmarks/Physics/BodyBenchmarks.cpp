@@ -0,0 +1,72 @@
+// BodyBenchmarks.cpp
+#include <cstdio>
+#include "BenchmarkFramework.h"
+#include "Physics/PhysicsTestContext.h"
+#include "Nessie/Random/Rng.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Print the average time per update that was spent in a type of job, and its share of the update.
+    //----------------------------------------------------------------------------------------------------
+    static void ReportJobShare(const char* pLabel, const uint64 jobNs, const uint64 updateNs, const uint32 numUpdates)
+    {
+        std::printf("    %-40s avg %9.3f ms  %5.1f %%\n", pLabel, static_cast<double>(jobNs) / (1.0e6 * static_cast<double>(numUpdates)), 100.0 * static_cast<double>(jobNs) / static_cast<double>(updateNs));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The per body jobs of an update (applying gravity and integrating the velocities), on a cloud of
+    // bodies that fall without touching each other. Without contacts, these jobs are as large a part of
+    // the update as they can get.
+    //----------------------------------------------------------------------------------------------------
+    NES_BENCHMARK(BodyUpdateJobs)
+    {
+        static constexpr uint32 kNumBodies = 20000;
+        static constexpr uint32 kGridSize = 28;
+        static constexpr uint32 kNumWarmUpUpdates = 10;
+        static constexpr uint32 kNumMeasuredUpdates = 60;
+
+        PhysicsTestContext::CreateInfo createInfo;
+        createInfo.m_maxBodies = kNumBodies;
+        PhysicsTestContext context(createInfo);
+        PhysicsScene& scene = context.GetScene();
+
+        // Keep the bodies awake, they would not fall asleep anyway.
+        PhysicsSettings settings = scene.GetSettings();
+        settings.m_allowSleeping = false;
+        scene.SetSettings(settings);
+
+        // Bodies 3 m apart, falling and tumbling, so that every body has a linear and angular velocity.
+        RandomNumberGenerator rng(3579);
+        for (uint32 i = 0; i < kNumBodies; ++i)
+        {
+            const RVec3 position(3.f * static_cast<float>(i % kGridSize), 3.f * static_cast<float>(i / (kGridSize * kGridSize)), 3.f * static_cast<float>((i / kGridSize) % kGridSize));
+            const BodyID bodyID = i % 2 == 0? context.CreateBox(position, Vec3::Replicate(0.5f)) : context.CreateSphere(position, 0.5f);
+            context.GetBodyInterface().SetAngularVelocity(bodyID, Vec3(rng.RandRange(-2.f, 2.f), rng.RandRange(-2.f, 2.f), rng.RandRange(-2.f, 2.f)));
+        }
+        scene.OptimizeBroadPhase();
+        context.Simulate(kNumWarmUpUpdates);
+
+        scene.SetStepStatsEnabled(true);
+        uint64 updateNs = 0;
+        uint64 applyGravityNs = 0;
+        uint64 integrateVelocityNs = 0;
+        uint64 findCollisionsNs = 0;
+        const benchmark::BenchmarkResult update = benchmark::Measure(kNumMeasuredUpdates, [&]()
+        {
+            context.Simulate();
+            const PhysicsStepStats& stats = scene.GetStepStats();
+            updateNs += stats.m_updateWallTime;
+            applyGravityNs += stats.GetJobTypeStats(EPhysicsJobType::ApplyGravity).m_wallTime;
+            integrateVelocityNs += stats.GetJobTypeStats(EPhysicsJobType::IntegrateVelocity).m_wallTime;
+            findCollisionsNs += stats.GetJobTypeStats(EPhysicsJobType::FindCollisions).m_wallTime;
+        });
+        scene.SetStepStatsEnabled(false);
+
+        benchmark::Report("Update", update);
+        ReportJobShare("ApplyGravity", applyGravityNs, updateNs, kNumMeasuredUpdates);
+        ReportJobShare("IntegrateVelocity", integrateVelocityNs, updateNs, kNumMeasuredUpdates);
+        ReportJobShare("FindCollisions", findCollisionsNs, updateNs, kNumMeasuredUpdates);
+        std::printf("    %-40s %u\n", "Active bodies", scene.GetNumActiveBodies());
+    }
+}
@@ -0,0 +1,389 @@
+// BroadPhaseBenchmarks.cpp
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include "BenchmarkFramework.h"
+#include "Physics/PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/AABoxCast.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/CollisionCollector.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Random/Rng.h"
+
+namespace nes::test
+{
+    static constexpr int        kNumQueries = 10000;
+    static constexpr uint32     kNumQueryIterations = 10;
+    static constexpr uint32     kNumWarmUpUpdates = 10;
+    static constexpr uint32     kNumMeasuredUpdates = 60;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Queries that are cast against each broadphase. They are generated once, so that every
+    ///     broadphase answers the same queries.
+    //----------------------------------------------------------------------------------------------------
+    struct BroadPhaseQueries
+    {
+        std::vector<RayCast>    m_rays;
+        std::vector<AABoxCast>  m_boxCasts;
+        std::vector<AABox>      m_boxes;
+    };
+
+    static Vec3 RandomVec3(RandomNumberGenerator& rng, const float halfExtent)
+    {
+        return Vec3(rng.RandRange(-halfExtent, halfExtent), rng.RandRange(-halfExtent, halfExtent), rng.RandRange(-halfExtent, halfExtent));
+    }
+
+    static void CreateQueries(const float worldHalfExtent, BroadPhaseQueries& outQueries)
+    {
+        RandomNumberGenerator rng(1234);
+        for (int i = 0; i < kNumQueries; ++i)
+        {
+            outQueries.m_rays.emplace_back(RandomVec3(rng, worldHalfExtent), RandomVec3(rng, 50.f));
+            outQueries.m_boxCasts.push_back({ AABox(RandomVec3(rng, worldHalfExtent), 0.5f), RandomVec3(rng, 20.f) });
+            outQueries.m_boxes.push_back(AABox(RandomVec3(rng, worldHalfExtent), 2.f));
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Scatter boxes through a cube without gravity. One in four bodies is dynamic and moves in a
+    ///     random direction, so that the broadphase has to update its bounds every step.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateScatteredBodies(PhysicsTestContext& context, const uint32 numBodies, const float worldHalfExtent)
+    {
+        context.GetScene().SetGravity(Vec3::Zero());
+
+        RandomNumberGenerator rng(5678);
+        for (uint32 i = 0; i < numBodies; ++i)
+        {
+            const RVec3 position(RandomVec3(rng, worldHalfExtent));
+            const Vec3 halfExtent(rng.RandRange(0.2f, 1.f), rng.RandRange(0.2f, 1.f), rng.RandRange(0.2f, 1.f));
+            if (i % 4 == 0)
+            {
+                const BodyID bodyID = context.CreateBox(position, halfExtent);
+                context.GetBodyInterface().SetLinearVelocity(bodyID, RandomVec3(rng, 2.f));
+            }
+            else
+            {
+                context.CreateBox(position, halfExtent, EBodyMotionType::Static);
+            }
+        }
+
+        context.GetScene().OptimizeBroadPhase();
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create a grid of small spheres on a floor, all walking in a random direction.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateCrowd(PhysicsTestContext& context, const uint32 numBodies, const float worldHalfExtent)
+    {
+        context.CreateFloor(worldHalfExtent + 10.f);
+
+        const uint32 numPerRow = static_cast<uint32>(std::ceil(std::sqrt(static_cast<float>(numBodies))));
+        const float spacing = 2.f * worldHalfExtent / static_cast<float>(numPerRow);
+
+        RandomNumberGenerator rng(9012);
+        for (uint32 i = 0; i < numBodies; ++i)
+        {
+            const float x = -worldHalfExtent + spacing * static_cast<float>(i % numPerRow);
+            const float z = -worldHalfExtent + spacing * static_cast<float>(i / numPerRow);
+            const BodyID bodyID = context.CreateSphere(RVec3(x, 0.3f, z), 0.3f);
+            context.GetBodyInterface().SetLinearVelocity(bodyID, Vec3(rng.RandRange(-3.f, 3.f), 0.f, rng.RandRange(-3.f, 3.f)));
+        }
+
+        context.GetScene().OptimizeBroadPhase();
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Print the average time per update that was spent in a type of job.
+    //----------------------------------------------------------------------------------------------------
+    static void ReportJobTime(const char* pLabel, const uint64 totalNs, const uint32 numUpdates)
+    {
+        std::printf("    %-40s avg %9.3f ms\n", pLabel, static_cast<double>(totalNs) / (1.0e6 * static_cast<double>(numUpdates)));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Time the updates of the scene, and the broadphase queries against it.
+    //----------------------------------------------------------------------------------------------------
+    static void MeasureBroadPhase(PhysicsTestContext& context, const char* pName, const BroadPhaseQueries& queries)
+    {
+        char label[64];
+        PhysicsScene& scene = context.GetScene();
+
+        // Updates. Finding collisions includes the narrow phase of the pairs that were found.
+        context.Simulate(kNumWarmUpUpdates);
+        scene.SetStepStatsEnabled(true);
+
+        uint64 prepareNs = 0;
+        uint64 findCollisionsNs = 0;
+        uint64 numBodyPairs = 0;
+        const benchmark::BenchmarkResult update = benchmark::Measure(kNumMeasuredUpdates, [&]()
+        {
+            context.Simulate();
+            prepareNs += scene.GetStepStats().GetJobTypeStats(EPhysicsJobType::BroadPhasePrepare).m_wallTime;
+            findCollisionsNs += scene.GetStepStats().GetJobTypeStats(EPhysicsJobType::FindCollisions).m_wallTime;
+            numBodyPairs += scene.GetStepStats().m_numBodyPairs;
+        });
+        scene.SetStepStatsEnabled(false);
+
+        std::snprintf(label, sizeof(label), "%s Update", pName);
+        benchmark::Report(label, update);
+        std::snprintf(label, sizeof(label), "%s BroadPhasePrepare", pName);
+        ReportJobTime(label, prepareNs, kNumMeasuredUpdates);
+        std::snprintf(label, sizeof(label), "%s FindCollisions", pName);
+        ReportJobTime(label, findCollisionsNs, kNumMeasuredUpdates);
+        std::printf("    %-40s %llu\n", "Body pairs per update", static_cast<unsigned long long>(numBodyPairs / kNumMeasuredUpdates));
+
+        // Queries.
+        const BroadPhaseQuery& query = scene.GetBroadPhaseQuery();
+        uint64 numHits = 0;
+
+        AllHitCollisionCollector<RayCastBodyCollector> rayCollector;
+        const benchmark::BenchmarkResult rays = benchmark::Measure(kNumQueryIterations, [&]()
+        {
+            for (const RayCast& ray : queries.m_rays)
+            {
+                rayCollector.Reset();
+                query.CastRay(ray, rayCollector);
+                numHits += rayCollector.m_hits.size();
+            }
+        });
+        std::snprintf(label, sizeof(label), "%s CastRay", pName);
+        benchmark::Report(label, rays, kNumQueries);
+
+        AllHitCollisionCollector<CastShapeBodyCollector> castCollector;
+        const benchmark::BenchmarkResult boxCasts = benchmark::Measure(kNumQueryIterations, [&]()
+        {
+            for (const AABoxCast& boxCast : queries.m_boxCasts)
+            {
+                castCollector.Reset();
+                query.CastAABox(boxCast, castCollector);
+                numHits += castCollector.m_hits.size();
+            }
+        });
+        std::snprintf(label, sizeof(label), "%s CastAABox", pName);
+        benchmark::Report(label, boxCasts, kNumQueries);
+
+        AllHitCollisionCollector<CollideShapeBodyCollector> collideCollector;
+        const benchmark::BenchmarkResult boxes = benchmark::Measure(kNumQueryIterations, [&]()
+        {
+            for (const AABox& box : queries.m_boxes)
+            {
+                collideCollector.Reset();
+                query.CollideAABox(box, collideCollector);
+                numHits += collideCollector.m_hits.size();
+            }
+        });
+        std::snprintf(label, sizeof(label), "%s CollideAABox", pName);
+        benchmark::Report(label, boxes, kNumQueries);
+
+        // Printing the hits keeps the queries from being optimized away. When no bodies collide, the simulation doesn't
+        // depend on the broadphase, so all broadphases must report the same number.
+        std::printf("    %-40s %llu\n", "Query hits", static_cast<unsigned long long>(numHits));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A broadphase to run a benchmark with, and the name that its results are printed with.
+    //----------------------------------------------------------------------------------------------------
+    struct BroadPhaseType
+    {
+        EBroadPhaseType         m_type;
+        const char*             m_pName;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // 4 wide (QuadTree) vs 8 wide (OctTree) tree nodes, on the same bodies and queries.
+    //----------------------------------------------------------------------------------------------------
+    NES_BENCHMARK(BroadPhaseTreeLayouts)
+    {
+        static constexpr uint32 kNumBodies = 100000;
+        static constexpr float kWorldHalfExtent = 500.f;
+
+        BroadPhaseQueries queries;
+        CreateQueries(kWorldHalfExtent, queries);
+
+        for (const BroadPhaseType& layout : { BroadPhaseType { EBroadPhaseType::QuadTree, "QuadTree" }, BroadPhaseType { EBroadPhaseType::OctTree, "OctTree" } })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_broadPhaseType = layout.m_type;
+            createInfo.m_maxBodies = kNumBodies;
+            PhysicsTestContext context(createInfo);
+            CreateScatteredBodies(context, kNumBodies, kWorldHalfExtent);
+
+            MeasureBroadPhase(context, layout.m_pName, queries);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Every broadphase on a crowd of small, similar sized bodies that all move every step.
+    //----------------------------------------------------------------------------------------------------
+    NES_BENCHMARK(BroadPhaseCrowd)
+    {
+        static constexpr uint32 kNumBodies = 30000;
+        static constexpr float kWorldHalfExtent = 100.f;
+
+        BroadPhaseQueries queries;
+        CreateQueries(kWorldHalfExtent, queries);
+
+        for (const BroadPhaseType& broadPhase : { BroadPhaseType { EBroadPhaseType::QuadTree, "QuadTree" }, BroadPhaseType { EBroadPhaseType::OctTree, "OctTree" }, BroadPhaseType { EBroadPhaseType::SweepAndPrune, "SweepAndPrune" } })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_broadPhaseType = broadPhase.m_type;
+            createInfo.m_maxBodies = kNumBodies + 1;
+            PhysicsTestContext context(createInfo);
+            CreateCrowd(context, kNumBodies, kWorldHalfExtent);
+
+            MeasureBroadPhase(context, broadPhase.m_pName, queries);
+        }
+    }
+
+    static constexpr int        kMaxWorkerThreads = 3;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Accumulates how the FindCollisions jobs of a number of updates were spread over the threads.
+    ///     The CPU time of the jobs includes the broadphase pair search and the narrow phase of the pairs.
+    //----------------------------------------------------------------------------------------------------
+    struct FindCollisionsThreadTimes
+    {
+        uint64                  m_threadCpuNs[kMaxWorkerThreads + 1] = {};
+        uint32                  m_threadNumRuns[kMaxWorkerThreads + 1] = {};
+        uint64                  m_wallNs = 0;
+
+        void                    Add(const PhysicsStepStats& stats, const int numWorkerThreads)
+        {
+            for (uint32 i = 0; i < math::Min(stats.GetNumThreads(), static_cast<uint32>(numWorkerThreads + 1)); ++i)
+            {
+                const PhysicsJobTypeStats threadStats = stats.GetJobTypeStats(EPhysicsJobType::FindCollisions, i);
+                m_threadCpuNs[i] += threadStats.m_cpuTime;
+                m_threadNumRuns[i] += threadStats.m_numRuns;
+            }
+
+            // Time from the start of the first FindCollisions job to the end of the last one.
+            uint64 firstStart = std::numeric_limits<uint64>::max();
+            uint64 lastEnd = 0;
+            for (uint32 i = 0; i < stats.GetNumJobTimings(); ++i)
+            {
+                const PhysicsJobTiming& timing = stats.GetJobTiming(i);
+                if (timing.m_type != EPhysicsJobType::FindCollisions)
+                    continue;
+                firstStart = math::Min(firstStart, timing.m_startTime);
+                lastEnd = math::Max(lastEnd, timing.m_startTime + timing.m_wallTime);
+            }
+            if (lastEnd > firstStart)
+                m_wallNs += lastEnd - firstStart;
+        }
+
+        void                    Report(const int numWorkerThreads, const uint32 numUpdates) const
+        {
+            char label[64];
+            std::snprintf(label, sizeof(label), "%d workers FindCollisions (wall)", numWorkerThreads);
+            ReportJobTime(label, m_wallNs, numUpdates);
+
+            uint64 totalCpuNs = 0;
+            for (int i = 0; i <= numWorkerThreads; ++i)
+                totalCpuNs += m_threadCpuNs[i];
+            for (int i = 0; i <= numWorkerThreads; ++i)
+            {
+                std::snprintf(label, sizeof(label), "%d workers thread %d FindCollisions", numWorkerThreads, i);
+                std::printf("    %-40s avg %9.3f ms  %5.1f %%  %5.1f jobs\n", label
+                    , static_cast<double>(m_threadCpuNs[i]) / (1.0e6 * numUpdates)
+                    , totalCpuNs > 0? 100.0 * static_cast<double>(m_threadCpuNs[i]) / static_cast<double>(totalCpuNs) : 0.0
+                    , static_cast<double>(m_threadNumRuns[i]) / numUpdates);
+            }
+        }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // How the work of finding collisions is spread over the threads when a single collision layer holds all
+    // active bodies.
+    //----------------------------------------------------------------------------------------------------
+    NES_BENCHMARK(FindCollisionsThreads)
+    {
+        static constexpr uint32 kNumBodies = 30000;
+        static constexpr float kWorldHalfExtent = 100.f;
+
+        for (const int numWorkerThreads : { 0, kMaxWorkerThreads })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_maxBodies = kNumBodies + 1;
+            createInfo.m_maxBodyPairs = 4 * kNumBodies;
+            createInfo.m_maxContactConstraints = 4 * kNumBodies;
+            createInfo.m_stackAllocatorSize = 256 * 1024 * 1024;
+            createInfo.m_numThreads = numWorkerThreads;
+            PhysicsTestContext context(createInfo);
+            CreateCrowd(context, kNumBodies, kWorldHalfExtent);
+            PhysicsScene& scene = context.GetScene();
+
+            context.Simulate(kNumWarmUpUpdates);
+            scene.SetStepStatsEnabled(true);
+
+            FindCollisionsThreadTimes times;
+            const benchmark::BenchmarkResult update = benchmark::Measure(kNumMeasuredUpdates, [&]()
+            {
+                context.Simulate();
+                times.Add(scene.GetStepStats(), numWorkerThreads);
+            });
+            scene.SetStepStatsEnabled(false);
+
+            char label[64];
+            std::snprintf(label, sizeof(label), "%d workers Update", numWorkerThreads);
+            benchmark::Report(label, update);
+            times.Report(numWorkerThreads, kNumMeasuredUpdates);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A sleeping pile of touching spheres, all in one collision layer, is woken by a single body. The update
+    // starts with one active body and one FindCollisions job; the rest of the pile is activated during the
+    // step, as the contacts are found. Prints how the work of finding collisions is spread over the threads.
+    //----------------------------------------------------------------------------------------------------
+    NES_BENCHMARK(FindCollisionsWakeUp)
+    {
+        static constexpr uint32 kNumPerRow = 100;
+        static constexpr uint32 kNumBodies = kNumPerRow * kNumPerRow;
+        static constexpr float kRadius = 0.3f;
+
+        for (const int numWorkerThreads : { 0, kMaxWorkerThreads })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_maxBodies = kNumBodies + 1;
+            createInfo.m_maxBodyPairs = 4 * kNumBodies;
+            createInfo.m_maxContactConstraints = 4 * kNumBodies;
+            createInfo.m_stackAllocatorSize = 256 * 1024 * 1024;
+            createInfo.m_numThreads = numWorkerThreads;
+            PhysicsTestContext context(createInfo);
+            context.CreateFloor();
+
+            std::vector<BodyID> bodies;
+            for (uint32 i = 0; i < kNumBodies; ++i)
+            {
+                const float x = 2.f * kRadius * static_cast<float>(i % kNumPerRow);
+                const float z = 2.f * kRadius * static_cast<float>(i / kNumPerRow);
+                bodies.push_back(context.CreateSphere(RVec3(x, kRadius, z), kRadius));
+            }
+            context.GetScene().OptimizeBroadPhase();
+
+            PhysicsScene& scene = context.GetScene();
+            BodyInterface& bodyInterface = context.GetBodyInterface();
+            scene.SetStepStatsEnabled(true);
+
+            FindCollisionsThreadTimes times;
+            uint64 numActiveBodies = 0;
+            const benchmark::BenchmarkResult update = benchmark::Measure(kNumMeasuredUpdates, [&]()
+            {
+                bodyInterface.DeactivateBodies(bodies.data(), static_cast<int>(bodies.size()));
+                bodyInterface.ActivateBody(bodies.front());
+                context.Simulate();
+                times.Add(scene.GetStepStats(), numWorkerThreads);
+                numActiveBodies += scene.GetNumActiveBodies();
+            });
+            scene.SetStepStatsEnabled(false);
+
+            // The update time includes putting the pile back to sleep.
+            char label[64];
+            std::snprintf(label, sizeof(label), "%d workers Update", numWorkerThreads);
+            benchmark::Report(label, update);
+            times.Report(numWorkerThreads, kNumMeasuredUpdates);
+            std::printf("    %-40s %llu\n", "Active bodies after update", static_cast<unsigned long long>(numActiveBodies / kNumMeasuredUpdates));
+        }
+    }
+}
@@ -0,0 +1,81 @@
+// ContactSolverBenchmarks.cpp
+#include <cstdio>
+#include "BenchmarkFramework.h"
+#include "Physics/PhysicsTestContext.h"
+
+namespace nes::test
+{
+    /// The pile is kPileDepth pyramids deep, each with kPyramidBase boxes in its bottom row.
+    static constexpr uint32 kPyramidBase = 30;
+    static constexpr uint32 kPileDepth = 4;
+    static constexpr uint32 kNumWarmUpUpdates = 30;
+    static constexpr uint32 kNumMeasuredUpdates = 60;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create a pile of unit boxes: rows of touching pyramids, so that the whole pile is a single
+    ///     island that the LargeIslandSplitter splits into parallel batches.
+    //----------------------------------------------------------------------------------------------------
+    static void CreatePile(PhysicsTestContext& context)
+    {
+        context.CreateFloor();
+        for (uint32 z = 0; z < kPileDepth; ++z)
+        {
+            for (uint32 row = 0; row < kPyramidBase; ++row)
+            {
+                for (uint32 i = 0; i < kPyramidBase - row; ++i)
+                {
+                    const RVec3 position(static_cast<float>(i) + 0.5f * static_cast<float>(row) - 0.5f * static_cast<float>(kPyramidBase), 0.5f + static_cast<float>(row), static_cast<float>(z));
+                    context.CreateBox(position, Vec3::Replicate(0.5f));
+                }
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Time the updates of a settled pile, with the parallel batches solved 4 contacts at a time or
+    ///     one at a time.
+    //----------------------------------------------------------------------------------------------------
+    static void MeasurePile(const bool useSIMD)
+    {
+        PhysicsTestContext context;
+        PhysicsScene& scene = context.GetScene();
+
+        // Keep the pile awake, so that every measured update solves all of its contacts.
+        PhysicsSettings settings = scene.GetSettings();
+        settings.m_allowSleeping = false;
+        settings.m_useSIMDContactSolver = useSIMD;
+        scene.SetSettings(settings);
+
+        CreatePile(context);
+        scene.OptimizeBroadPhase();
+        context.Simulate(kNumWarmUpUpdates);
+
+        scene.SetStepStatsEnabled(true);
+        uint64 solveVelocityNs = 0;
+        uint32 numSplitIslands = 0;
+        const benchmark::BenchmarkResult update = benchmark::Measure(kNumMeasuredUpdates, [&]()
+        {
+            context.Simulate();
+            const PhysicsStepStats& stats = scene.GetStepStats();
+            solveVelocityNs += stats.GetJobTypeStats(EPhysicsJobType::SolveVelocityConstraints).m_wallTime;
+            numSplitIslands += stats.m_numSplitIslands;
+        });
+        scene.SetStepStatsEnabled(false);
+
+        std::printf("  %s\n", useSIMD? "SIMD (4 contacts at a time)" : "Scalar (1 contact at a time)");
+        benchmark::Report("Update", update);
+        std::printf("    %-40s avg %9.3f ms\n", "SolveVelocityConstraints", static_cast<double>(solveVelocityNs) / (1.0e6 * kNumMeasuredUpdates));
+        std::printf("    %-40s %u\n", "Split islands per update", numSplitIslands / kNumMeasuredUpdates);
+        std::printf("    %-40s %u\n", "Active bodies", scene.GetNumActiveBodies());
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A settled pile of 1860 boxes. The velocity solve of its parallel batches runs with the SIMD contact
+    // solver and with the scalar one (PhysicsSettings::m_useSIMDContactSolver), on the same scene.
+    //----------------------------------------------------------------------------------------------------
+    NES_BENCHMARK(ContactSolverPile)
+    {
+        MeasurePile(true);
+        MeasurePile(false);
+    }
+}
@@ -0,0 +1,78 @@
+// PrecisionBenchmarks.cpp
+#include <cstdio>
+#include "BenchmarkFramework.h"
+#include "Physics/PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/NarrowPhaseQuery.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Random/Rng.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    // The cost of the build's precision. Run this benchmark in a float build and in a build with
+    // NES_DOUBLE_PRECISION and compare the results; the header of the output names the precision. The scene
+    // is at the origin, so that both builds simulate the same thing.
+    //----------------------------------------------------------------------------------------------------
+    NES_BENCHMARK(PrecisionCost)
+    {
+        static constexpr int kGridSize = 20;
+        static constexpr int kNumLayers = 5;
+        static constexpr uint32 kNumWarmUpUpdates = 60;
+        static constexpr uint32 kNumMeasuredUpdates = 120;
+        static constexpr int kNumRays = 10000;
+        static constexpr uint32 kNumRayIterations = 10;
+
+        PhysicsTestContext context;
+        context.CreateFloor();
+
+        // Keep the bodies awake, so that every update does the same amount of work.
+        PhysicsSettings settings = context.GetScene().GetSettings();
+        settings.m_allowSleeping = false;
+        context.GetScene().SetSettings(settings);
+
+        // Layers of boxes and spheres that fall onto each other.
+        for (int y = 0; y < kNumLayers; ++y)
+        {
+            for (int x = 0; x < kGridSize; ++x)
+            {
+                for (int z = 0; z < kGridSize; ++z)
+                {
+                    const RVec3 position(1.1f * static_cast<float>(x - kGridSize / 2), 0.5f + 1.5f * static_cast<float>(y), 1.1f * static_cast<float>(z - kGridSize / 2));
+                    if ((x + y + z) % 2 == 0)
+                        context.CreateBox(position, Vec3::Replicate(0.5f));
+                    else
+                        context.CreateSphere(position, 0.5f);
+                }
+            }
+        }
+        context.GetScene().OptimizeBroadPhase();
+        context.Simulate(kNumWarmUpUpdates);
+
+        const benchmark::BenchmarkResult update = benchmark::Measure(kNumMeasuredUpdates, [&context]()
+        {
+            context.Simulate();
+        });
+        benchmark::Report("Update", update);
+
+        // Rays down onto the piles, through the narrow phase.
+        std::vector<RRayCast> rays;
+        RandomNumberGenerator rng(4321);
+        for (int i = 0; i < kNumRays; ++i)
+            rays.emplace_back(RVec3(rng.RandRange(-12.f, 12.f), 10.f, rng.RandRange(-12.f, 12.f)), Vec3(rng.RandRange(-2.f, 2.f), -12.f, rng.RandRange(-2.f, 2.f)));
+
+        const NarrowPhaseQuery& query = context.GetScene().GetNarrowPhaseQuery();
+        uint64 numHits = 0;
+        const benchmark::BenchmarkResult rayCasts = benchmark::Measure(kNumRayIterations, [&]()
+        {
+            for (const RRayCast& ray : rays)
+            {
+                RayCastResult hit;
+                if (query.CastRay(ray, hit))
+                    ++numHits;
+            }
+        });
+        benchmark::Report("CastRay", rayCasts, kNumRays);
+        std::printf("    %-40s %llu\n", "Hits per iteration", static_cast<unsigned long long>(numHits / kNumRayIterations));
+    }
+}
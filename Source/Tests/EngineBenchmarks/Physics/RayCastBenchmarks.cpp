@@ -0,0 +1,131 @@
+// RayCastBenchmarks.cpp
+#include <cstdio>
+#include <thread>
+#include "BenchmarkFramework.h"
+#include "Physics/PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/NarrowPhaseQuery.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Random/Rng.h"
+
+namespace nes::test
+{
+    static constexpr int        kNumRays = 10000;
+    static constexpr int        kRaysPerFan = 32;
+    static constexpr uint32     kNumRayIterations = 20;
+
+    static Vec3 RandomVec3(RandomNumberGenerator& rng, const float halfExtent)
+    {
+        return Vec3(rng.RandRange(-halfExtent, halfExtent), rng.RandRange(-halfExtent, halfExtent), rng.RandRange(-halfExtent, halfExtent));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Scatter static boxes and spheres through a cube.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateStaticBodies(PhysicsTestContext& context, const uint32 numBodies, const float worldHalfExtent)
+    {
+        RandomNumberGenerator rng(2468);
+        for (uint32 i = 0; i < numBodies; ++i)
+        {
+            const RVec3 position(RandomVec3(rng, worldHalfExtent));
+            if (i % 2 == 0)
+                context.CreateBox(position, Vec3(rng.RandRange(0.2f, 1.f), rng.RandRange(0.2f, 1.f), rng.RandRange(0.2f, 1.f)), EBodyMotionType::Static);
+            else
+                context.CreateSphere(position, rng.RandRange(0.2f, 1.f), EBodyMotionType::Static);
+        }
+
+        context.GetScene().OptimizeBroadPhase();
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create fans of rays that start at the same point, like the visibility checks of an AI agent,
+    ///     or rays with a random origin when raysPerFan is 1.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateRays(const float worldHalfExtent, const int raysPerFan, std::vector<RRayCast>& outRays)
+    {
+        RandomNumberGenerator rng(1357);
+        RVec3 origin = RVec3::Zero();
+        for (int i = 0; i < kNumRays; ++i)
+        {
+            if (i % raysPerFan == 0)
+                origin = RVec3(RandomVec3(rng, worldHalfExtent));
+            outRays.emplace_back(origin, RandomVec3(rng, 30.f));
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Time the rays cast one by one, batched on the calling thread, and batched on the job system.
+    //----------------------------------------------------------------------------------------------------
+    static void MeasureRays(PhysicsTestContext& context, const char* pName, const std::vector<RRayCast>& rays)
+    {
+        char label[64];
+        const NarrowPhaseQuery& query = context.GetScene().GetNarrowPhaseQuery();
+        std::vector<RayCastResult> hits(rays.size());
+        uint64 numHits = 0;
+
+        const benchmark::BenchmarkResult single = benchmark::Measure(kNumRayIterations, [&]()
+        {
+            for (size_t i = 0; i < rays.size(); ++i)
+            {
+                hits[i] = RayCastResult();
+                if (query.CastRay(rays[i], hits[i]))
+                    ++numHits;
+            }
+        });
+        std::snprintf(label, sizeof(label), "%s CastRay", pName);
+        benchmark::Report(label, single, rays.size());
+
+        const benchmark::BenchmarkResult batched = benchmark::Measure(kNumRayIterations, [&]()
+        {
+            hits.assign(rays.size(), RayCastResult());
+            numHits += query.CastRays(rays, hits);
+        });
+        std::snprintf(label, sizeof(label), "%s CastRays", pName);
+        benchmark::Report(label, batched, rays.size());
+
+        const benchmark::BenchmarkResult jobs = benchmark::Measure(kNumRayIterations, [&]()
+        {
+            hits.assign(rays.size(), RayCastResult());
+            numHits += query.CastRays(context.GetJobSystem(), rays, hits);
+        });
+        std::snprintf(label, sizeof(label), "%s CastRays (jobs)", pName);
+        benchmark::Report(label, jobs, rays.size());
+
+        // All three must hit the same number of rays.
+        std::printf("    %-40s %llu\n", "Hits per iteration", static_cast<unsigned long long>(numHits / (3 * kNumRayIterations)));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // 10k rays against a static scene, cast one by one vs batched with CastRays(), for each broadphase.
+    //----------------------------------------------------------------------------------------------------
+    NES_BENCHMARK(RayCastBatches)
+    {
+        static constexpr uint32 kNumBodies = 20000;
+        static constexpr float kWorldHalfExtent = 150.f;
+
+        std::vector<RRayCast> fanRays;
+        CreateRays(kWorldHalfExtent, kRaysPerFan, fanRays);
+        std::vector<RRayCast> randomRays;
+        CreateRays(kWorldHalfExtent, 1, randomRays);
+
+        const int numThreads = static_cast<int>(math::Max(std::thread::hardware_concurrency(), 2u)) - 1;
+        std::printf("    %-40s %d\n", "Worker threads", numThreads);
+
+        for (const EBroadPhaseType broadPhaseType : { EBroadPhaseType::QuadTree, EBroadPhaseType::OctTree, EBroadPhaseType::SweepAndPrune })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_broadPhaseType = broadPhaseType;
+            createInfo.m_maxBodies = kNumBodies;
+            createInfo.m_numThreads = numThreads;
+            PhysicsTestContext context(createInfo);
+            CreateStaticBodies(context, kNumBodies, kWorldHalfExtent);
+
+            const char* pBroadPhaseName = broadPhaseType == EBroadPhaseType::QuadTree? "QuadTree" : broadPhaseType == EBroadPhaseType::OctTree? "OctTree" : "SweepAndPrune";
+            char name[64];
+            std::snprintf(name, sizeof(name), "%s fans", pBroadPhaseName);
+            MeasureRays(context, name, fanRays);
+            std::snprintf(name, sizeof(name), "%s random", pBroadPhaseName);
+            MeasureRays(context, name, randomRays);
+        }
+    }
+}
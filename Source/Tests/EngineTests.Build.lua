@@ -0,0 +1,46 @@
+-- EngineTests Project Configuration.
+-- Premake Documentation: https://premake.github.io/docs/
+
+local projectCore = require("ProjectCore");
+
+local p = {};
+p.Name = "EngineTests";
+
+function p.ConfigureProject(dependencyInjector)
+    local projectDir = p.BuildDirectory .. "/EngineTests/";
+
+    projectCore.SetProjectDefaults();
+    kind "ConsoleApp"
+    
+    dependencyInjector.Link("Nessie");
+    dependencyInjector.Link("Assimp");
+    dependencyInjector.Link("Vulkan");
+
+    filter {}
+
+    includedirs
+    {
+        projectDir,
+    }
+
+    disablewarnings
+    {
+        "4324", -- "'X' : structure was padded due to alignment specifier"
+    }
+
+    files
+    {
+        projectDir .. "**.h",
+        projectDir .. "**.hpp",
+        projectDir .. "**.cpp",
+        projectDir .. "**.ixx",
+        projectDir .. "**.inl",
+    }
+
+    vpaths
+    {
+        ["Source/*"] = { p.BuildDirectory .. "/EngineTests/**.*"}
+    }
+end
+
+return p;
\ No newline at end of file
@@ -0,0 +1,37 @@
+// AllocationCounter.cpp
+#include "AllocationCounter.h"
+#include <atomic>
+#include <new>
+#include "Nessie/Core/Memory/Memory.h"
+
+static std::atomic<uint64_t> s_numAllocations = 0;
+
+namespace test
+{
+    uint64_t GetNumAllocations()
+    {
+        return s_numAllocations.load(std::memory_order_relaxed);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+// Replacements of the global operator new that count the allocations. The array and nothrow versions
+// call these. The memory is allocated without the leak detector records, which themselves allocate.
+//----------------------------------------------------------------------------------------------------
+void* operator new(const size_t size)
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* pMemory = nes::memory::internal::Allocate(size > 0? size : 1);
+    if (pMemory == nullptr)
+        throw std::bad_alloc();
+    return pMemory;
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment)
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* pMemory = nes::memory::internal::AlignedAllocate(size > 0? size : 1, static_cast<size_t>(alignment));
+    if (pMemory == nullptr)
+        throw std::bad_alloc();
+    return pMemory;
+}
@@ -0,0 +1,14 @@
+// AllocationCounter.h
+#pragma once
+#include <cstdint>
+
+namespace test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get the number of times that the global operator new has been called by any thread since
+    ///     the start of the program. EngineTests replaces the global operator new to count them.
+    /// @note : Allocations that go directly through NES_ALLOC, or through NES_NEW in debug builds, are not
+    ///     counted.
+    //----------------------------------------------------------------------------------------------------
+    uint64_t                    GetNumAllocations();
+}
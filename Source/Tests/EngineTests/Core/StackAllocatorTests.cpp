@@ -0,0 +1,52 @@
+// StackAllocatorTests.cpp
+#include "TestFramework.h"
+#include "Nessie/Core/Memory/StackAllocator.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    // The high water mark is the most memory that was allocated at the same time. It must not go down when
+    // memory is freed, and must not go up for allocations that stay below it. Resetting it sets it to the
+    // memory that is allocated at that moment.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(StackAllocatorHighWaterMark)
+    {
+        StackAllocator allocator(64 * 1024);
+        NES_CHECK(allocator.HighWaterMark() == 0);
+
+        void* pFirst = allocator.Allocate(1000);
+        void* pSecond = allocator.Allocate(3000);
+        const size_t peak = allocator.Size();
+        NES_CHECK(peak >= 4000);
+        NES_CHECK(allocator.HighWaterMark() == peak);
+
+        // Freeing and allocating less than was freed keeps the peak.
+        allocator.Free(pSecond, 3000);
+        void* pThird = allocator.Allocate(500);
+        NES_CHECK(allocator.Size() < peak);
+        NES_CHECK(allocator.HighWaterMark() == peak);
+
+        // Empty allocations don't use any memory.
+        NES_CHECK(allocator.Allocate(0) == nullptr);
+        NES_CHECK(allocator.HighWaterMark() == peak);
+
+        // After a reset, only the memory that is still allocated counts.
+        allocator.ResetHighWaterMark();
+        const size_t afterReset = allocator.Size();
+        NES_CHECK(afterReset >= 1500 && afterReset < peak);
+        NES_CHECK(allocator.HighWaterMark() == afterReset);
+
+        void* pFourth = allocator.Allocate(100);
+        NES_CHECK(allocator.HighWaterMark() == allocator.Size());
+        NES_CHECK(allocator.HighWaterMark() > afterReset);
+
+        allocator.Free(pFourth, 100);
+        allocator.Free(pThird, 500);
+        allocator.Free(pFirst, 1000);
+        NES_CHECK(allocator.IsEmpty());
+        NES_CHECK(allocator.HighWaterMark() > 0);
+
+        allocator.ResetHighWaterMark();
+        NES_CHECK(allocator.HighWaterMark() == 0);
+    }
+}
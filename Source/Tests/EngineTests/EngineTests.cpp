@@ -0,0 +1,63 @@
+// EngineTests.cpp
+#include <cstdio>
+#include "TestFramework.h"
+#include "Nessie/Core/Memory/Memory.h"
+#include "Nessie/Debug/Log.h"
+
+//----------------------------------------------------------------------------------------------------
+// Number of failed checks in the currently running test.
+//----------------------------------------------------------------------------------------------------
+static int s_currentTestFailures = 0;
+
+namespace test
+{
+    std::vector<TestCase>& GetTestCases()
+    {
+        static std::vector<TestCase> s_testCases;
+        return s_testCases;
+    }
+
+    void ReportFailure(const char* pFile, const int line, const char* pExpression)
+    {
+        std::printf("    %s(%d): Check failed: %s\n", pFile, line, pExpression);
+        ++s_currentTestFailures;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Runs every registered test. Returns the number of tests that failed, so that it can be used
+///     as a build step or by a CI job.
+//----------------------------------------------------------------------------------------------------
+int main(int, char**)
+{
+    NES_INIT_LEAK_DETECTOR();
+    nes::LoggerRegistry::Instance().Internal_Init();
+
+    int numFailedTests = 0;
+    const std::vector<TestCase>& testCases = test::GetTestCases();
+
+    for (const TestCase& testCase : testCases)
+    {
+        s_currentTestFailures = 0;
+        std::printf("[ RUN  ] %s\n", testCase.m_pName);
+
+        testCase.m_function();
+
+        if (s_currentTestFailures > 0)
+        {
+            std::printf("[ FAIL ] %s (%d failed checks)\n", testCase.m_pName, s_currentTestFailures);
+            ++numFailedTests;
+        }
+        else
+        {
+            std::printf("[  OK  ] %s\n", testCase.m_pName);
+        }
+    }
+
+    std::printf("%d of %d tests passed.\n", static_cast<int>(testCases.size()) - numFailedTests, static_cast<int>(testCases.size()));
+
+    nes::LoggerRegistry::Instance().Internal_Shutdown();
+    NES_DUMP_AND_DESTROY_LEAK_DETECTOR();
+
+    return numFailedTests;
+}
@@ -0,0 +1,49 @@
+// ClosestPointTests.cpp
+#include <cmath>
+#include "TestFramework.h"
+#include "Nessie/Geometry/ClosestPoint.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    // The barycentric coordinates of a triangle must describe the point of its plane that is closest to
+    // the origin. The triangles have their shortest edge in each position, so that both ways of solving
+    // for the coordinates are used.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(TriangleBaryCentricCoordinatesOfOrigin)
+    {
+        struct TestTriangle
+        {
+            Vec3            m_a;
+            Vec3            m_b;
+            Vec3            m_c;
+            Vec3            m_closest;  // Point on the plane of the triangle that is closest to the origin.
+        };
+
+        const TestTriangle triangles[] =
+        {
+            // Shortest edge a-b.
+            { Vec3(-1.f, -1.f, 1.f), Vec3(0.f, -1.f, 1.f), Vec3(1.f, 3.f, 1.f), Vec3(0.f, 0.f, 1.f) },
+
+            // Shortest edge b-c.
+            { Vec3(-4.f, -1.f, 1.f), Vec3(2.f, -1.f, 1.f), Vec3(1.f, 1.f, 1.f), Vec3(0.f, 0.f, 1.f) },
+
+            // Shortest edge c-a, in the plane x + y + z = 3.
+            { Vec3(3.f, 0.f, 0.f), Vec3(-2.f, 4.f, 1.f), Vec3(3.f, 1.f, -1.f), Vec3(1.f, 1.f, 1.f) },
+        };
+
+        for (const TestTriangle& triangle : triangles)
+        {
+            // The expected point is where the normal of the plane through the origin meets the plane.
+            NES_CHECK(std::abs(triangle.m_closest.Dot(triangle.m_b - triangle.m_a)) < 1.0e-6f);
+            NES_CHECK(std::abs(triangle.m_closest.Dot(triangle.m_c - triangle.m_a)) < 1.0e-6f);
+
+            float u, v, w;
+            NES_CHECK(ClosestPoint::GetBaryCentricCoordinates(triangle.m_a, triangle.m_b, triangle.m_c, u, v, w));
+            NES_CHECK(std::abs(u + v + w - 1.f) < 1.0e-6f);
+
+            const Vec3 closest = (triangle.m_a * u) + (triangle.m_b * v) + (triangle.m_c * w);
+            NES_CHECK(closest.IsClose(triangle.m_closest, 1.0e-10f));
+        }
+    }
+}
@@ -0,0 +1,84 @@
+// GJKClosestPointTests.cpp
+#include <cmath>
+#include "TestFramework.h"
+#include "Nessie/Geometry/AABox.h"
+#include "Nessie/Geometry/GJKClosestPoint.h"
+
+namespace nes::test
+{
+    static constexpr float kTolerance = 1.0e-4f;
+    static constexpr float kMaxError = 1.0e-3f;
+
+    //----------------------------------------------------------------------------------------------------
+    // A ray that passes through a unit box must hit it where it enters the box, and a ray that passes
+    // beside it must miss it. GJK starts from the support point of the box in the zero direction, which is
+    // its max corner, so the rays that start next to that corner must give the same answer.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(GJKCastRayAgainstBox)
+    {
+        const AABox box(Vec3::Replicate(-0.5f), Vec3::Replicate(0.5f));
+        GJKClosestPoint gjk;
+
+        // Enters the box at x = -0.5.
+        float lambda = 1.f;
+        NES_CHECK(gjk.CastRay(Vec3(-5.f, 0.2f, 0.3f), Vec3(10.f, 0.f, 0.f), kTolerance, box, lambda));
+        NES_CHECK(std::abs(lambda - 0.45f) < kMaxError);
+
+        // Enters the box at y = 0.5, at an angle.
+        lambda = 1.f;
+        NES_CHECK(gjk.CastRay(Vec3(0.f, 4.f, 0.f), Vec3(1.f, -8.f, -1.f), kTolerance, box, lambda));
+        NES_CHECK(std::abs(lambda - 0.4375f) < kMaxError);
+
+        lambda = 1.f;
+        NES_CHECK(!gjk.CastRay(Vec3(-5.f, 0.7f, 0.f), Vec3(10.f, 0.f, 0.f), kTolerance, box, lambda));
+
+        // Starts 0.1m from the face at x = 0.5, next to the max corner.
+        const Vec3 nearCorner(0.6f, 0.45f, 0.4f);
+        lambda = 1.f;
+        NES_CHECK(gjk.CastRay(nearCorner, Vec3(-2.f, 0.f, 0.f), kTolerance, box, lambda));
+        NES_CHECK(std::abs(lambda - 0.05f) < kMaxError);
+
+        lambda = 1.f;
+        NES_CHECK(!gjk.CastRay(nearCorner, Vec3(2.f, 0.f, 0.f), kTolerance, box, lambda));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A box swept into a unit box must stop when their faces touch, with the contact points on the touching
+    // faces and a separating axis that points from the swept box towards the other one.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(GJKCastShapeAgainstBox)
+    {
+        const AABox box(Vec3::Replicate(-0.5f), Vec3::Replicate(0.5f));
+        const Vec3 direction(10.f, 0.f, 0.f);
+        GJKClosestPoint gjk;
+        Vec3 pointA;
+        Vec3 pointB;
+        Vec3 separatingAxis;
+
+        // The faces touch when the swept box is centered at x = -1.
+        float lambda = 1.f;
+        NES_CHECK(gjk.CastShape(Mat44::MakeTranslation(Vec3(-5.f, 0.2f, 0.f)), direction, kTolerance, box, box, 0.f, 0.f, lambda, pointA, pointB, separatingAxis));
+        NES_CHECK(std::abs(lambda - 0.4f) < kMaxError);
+        NES_CHECK(std::abs(pointA.x + 0.5f) < kMaxError);
+        NES_CHECK(std::abs(pointB.x + 0.5f) < kMaxError);
+        NES_CHECK(separatingAxis.x > 0.f);
+
+        // A sweep that passes above the box must miss it.
+        lambda = 1.f;
+        NES_CHECK(!gjk.CastShape(Mat44::MakeTranslation(Vec3(-5.f, 1.2f, 0.f)), direction, kTolerance, box, box, 0.f, 0.f, lambda, pointA, pointB, separatingAxis));
+
+        // A smaller box that starts 0.1m from the face at x = 0.5. In the Minkowski difference of the boxes,
+        // the start lies next to the first support point, like the rays that start next to the corner above.
+        const AABox smallBox(Vec3::Replicate(-0.25f), Vec3::Replicate(0.25f));
+        const Mat44 nearCorner = Mat44::MakeTranslation(Vec3(0.85f, 0.2f, 0.2f));
+        lambda = 1.f;
+        NES_CHECK(gjk.CastShape(nearCorner, -direction, kTolerance, smallBox, box, 0.f, 0.f, lambda, pointA, pointB, separatingAxis));
+        NES_CHECK(std::abs(lambda - 0.01f) < kMaxError);
+        NES_CHECK(std::abs(pointA.x - 0.5f) < kMaxError);
+        NES_CHECK(std::abs(pointB.x - 0.5f) < kMaxError);
+        NES_CHECK(separatingAxis.x < 0.f);
+
+        lambda = 1.f;
+        NES_CHECK(!gjk.CastShape(nearCorner, direction, kTolerance, smallBox, box, 0.f, 0.f, lambda, pointA, pointB, separatingAxis));
+    }
+}
@@ -0,0 +1,128 @@
+// JobGraphTests.cpp
+#include <atomic>
+#include <string>
+#include <vector>
+#include "TestFramework.h"
+#include "Nessie/Jobs/JobGraph.h"
+#include "Nessie/Jobs/JobSystemThreadPool.h"
+
+namespace nes::test
+{
+    static constexpr uint32 kMaxJobs = 2048;
+    static constexpr uint32 kMaxBarriers = 4;
+    static constexpr int kNumThreads = 7;
+    static constexpr uint32 kNumRuns = 100;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Records the order in which the nodes of a graph finish within a run.
+    //----------------------------------------------------------------------------------------------------
+    struct RunRecorder
+    {
+        explicit RunRecorder(const uint32 numNodes) : m_finishOrder(numNodes), m_numRuns(numNodes) {}
+
+        void                Record(const JobGraph::NodeID node)
+        {
+            m_finishOrder[node] = m_numFinished.fetch_add(1);
+            m_numRuns[node].fetch_add(1);
+        }
+
+        std::vector<std::atomic<uint32>> m_finishOrder;     /// Index in the order of finished nodes, for each node.
+        std::vector<std::atomic<uint32>> m_numRuns;         /// Number of times that each node was executed.
+        std::atomic<uint32> m_numFinished = 0;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // A -> B, A -> C, B -> D, C -> D. Every run must execute each node once, after its dependencies.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(JobGraphRunsDiamondRepeatedly)
+    {
+        RunRecorder recorder(4);
+        JobGraph graph;
+        const JobGraph::NodeID a = graph.AddNode("A", [&recorder]() { recorder.Record(0); });
+        const JobGraph::NodeID b = graph.AddNode("B", [&recorder]() { recorder.Record(1); });
+        const JobGraph::NodeID c = graph.AddNode("C", [&recorder]() { recorder.Record(2); });
+        const JobGraph::NodeID d = graph.AddNode("D", [&recorder]() { recorder.Record(3); });
+        graph.AddDependency(a, b);
+        graph.AddDependency(a, c);
+        graph.AddDependency(b, d);
+        graph.AddDependency(c, d);
+        NES_CHECK(graph.Compile());
+        NES_CHECK(graph.GetMaxParallelism() == 2);
+
+        JobSystemThreadPool jobSystem(kMaxJobs, kMaxBarriers, kNumThreads);
+        bool isOrderValid = true;
+        bool allRanOnce = true;
+        for (uint32 run = 0; run < kNumRuns; ++run)
+        {
+            recorder.m_numFinished = 0;
+            graph.Run(jobSystem);
+
+            isOrderValid &= recorder.m_finishOrder[a] < recorder.m_finishOrder[b];
+            isOrderValid &= recorder.m_finishOrder[a] < recorder.m_finishOrder[c];
+            isOrderValid &= recorder.m_finishOrder[b] < recorder.m_finishOrder[d];
+            isOrderValid &= recorder.m_finishOrder[c] < recorder.m_finishOrder[d];
+            for (const std::atomic<uint32>& numRuns : recorder.m_numRuns)
+                allRanOnce &= numRuns == run + 1;
+        }
+        NES_CHECK(isOrderValid);
+        NES_CHECK(allRanOnce);
+
+        const std::string dot = graph.ToDot();
+        NES_CHECK(dot.find("node0 -> node1;") != std::string::npos);
+        NES_CHECK(dot.find("node2 -> node3;") != std::string::npos);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A node that releases many nodes at once launches helpers. The last node must only run after all of them,
+    // on every run.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(JobGraphRunsFanOutRepeatedly)
+    {
+        static constexpr uint32 kNumMiddleNodes = 32;
+
+        struct Context
+        {
+            std::atomic<uint32> m_numMiddleDone = 0;
+            std::atomic<uint32> m_numLastRuns = 0;
+            bool                m_isLastAfterMiddle = true;
+        };
+
+        Context context;
+        JobGraph graph;
+        const JobGraph::NodeID first = graph.AddNode("First", []() {});
+        const JobGraph::NodeID last = graph.AddNode("Last", [&context]()
+        {
+            context.m_isLastAfterMiddle &= context.m_numMiddleDone == kNumMiddleNodes * (context.m_numLastRuns + 1);
+            ++context.m_numLastRuns;
+        });
+        for (uint32 i = 0; i < kNumMiddleNodes; ++i)
+        {
+            const JobGraph::NodeID middle = graph.AddNode("Middle", [&context]() { context.m_numMiddleDone.fetch_add(1); });
+            graph.AddDependency(first, middle);
+            graph.AddDependency(middle, last);
+        }
+        NES_CHECK(graph.Compile());
+        NES_CHECK(graph.GetMaxParallelism() == kNumMiddleNodes);
+
+        JobSystemThreadPool jobSystem(kMaxJobs, kMaxBarriers, kNumThreads);
+        for (uint32 run = 0; run < kNumRuns; ++run)
+            graph.Run(jobSystem);
+
+        NES_CHECK(context.m_isLastAfterMiddle);
+        NES_CHECK(context.m_numLastRuns == kNumRuns);
+        NES_CHECK(context.m_numMiddleDone == kNumMiddleNodes * kNumRuns);
+    }
+
+    NES_TEST(JobGraphRejectsCycles)
+    {
+        JobGraph graph;
+        const JobGraph::NodeID a = graph.AddNode("A", []() {});
+        const JobGraph::NodeID b = graph.AddNode("B", []() {});
+        const JobGraph::NodeID c = graph.AddNode("C", []() {});
+        graph.AddDependency(a, b);
+        graph.AddDependency(b, c);
+        graph.AddDependency(c, a);
+        NES_CHECK(!graph.Compile());
+        NES_CHECK(!graph.IsCompiled());
+    }
+}
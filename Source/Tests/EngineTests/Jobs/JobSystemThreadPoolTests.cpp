@@ -0,0 +1,152 @@
+// JobSystemThreadPoolTests.cpp
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TestFramework.h"
+#include "Nessie/Jobs/JobSystemThreadPool.h"
+
+namespace nes::test
+{
+    static constexpr uint32 kMaxJobs = 64;
+    static constexpr uint32 kMaxBarriers = 4;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Wait until a condition is true, or until a second has passed.
+    /// @returns : The final value of the condition.
+    //----------------------------------------------------------------------------------------------------
+    template <typename Condition>
+    static bool WaitUntil(const Condition& condition)
+    {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!condition() && std::chrono::steady_clock::now() < end)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        return condition();
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Normal priority Job that occupies a worker thread until it is released.
+    //----------------------------------------------------------------------------------------------------
+    class BlockingJob
+    {
+    public:
+        explicit BlockingJob(JobSystem& jobSystem)
+        {
+            m_handle = jobSystem.CreateJob("Blocking Job", [this]()
+            {
+                m_isStarted = true;
+                while (!m_isReleased)
+                    std::this_thread::yield();
+            });
+        }
+
+        ~BlockingJob()
+        {
+            Release();
+            WaitUntil([this]() { return m_handle.IsDone(); });
+        }
+
+        bool            WaitUntilStarted() const    { return WaitUntil([this]() { return m_isStarted.load(); }); }
+        void            Release()                   { m_isReleased = true; }
+
+    private:
+        JobSystem::JobHandle    m_handle;
+        std::atomic<bool>       m_isStarted = false;
+        std::atomic<bool>       m_isReleased = false;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // Once a worker is free, it must take a queued critical Job before the normal Jobs that were queued first.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(ThreadPoolRunsCriticalJobsFirst)
+    {
+        JobSystemThreadPool jobSystem(kMaxJobs, kMaxBarriers, 1);
+        BlockingJob blockingJob(jobSystem);
+        NES_CHECK(blockingJob.WaitUntilStarted());
+
+        std::mutex mutex;
+        std::vector<EJobPriority> order;
+        std::vector<JobSystem::JobHandle> handles;
+        const auto queueJob = [&](const EJobPriority priority)
+        {
+            handles.push_back(jobSystem.CreateJob("Record Job", [&mutex, &order, priority]()
+            {
+                std::lock_guard lock(mutex);
+                order.push_back(priority);
+            }, 0, priority));
+        };
+
+        for (int i = 0; i < 4; ++i)
+            queueJob(EJobPriority::Normal);
+        queueJob(EJobPriority::Critical);
+
+        blockingJob.Release();
+        NES_CHECK(WaitUntil([&handles]() { return std::ranges::all_of(handles, [](const JobSystem::JobHandle& handle) { return handle.IsDone(); }); }));
+        NES_CHECK(order.size() == 5);
+        NES_CHECK(!order.empty() && order.front() == EJobPriority::Critical);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A reserved critical worker must run critical Jobs while the other worker is busy, and must not pick up
+    // normal Jobs.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(ThreadPoolReservesCriticalWorkers)
+    {
+        JobSystemThreadPool jobSystem(kMaxJobs, kMaxBarriers, 2, 1);
+        BlockingJob blockingJob(jobSystem);
+        NES_CHECK(blockingJob.WaitUntilStarted());
+
+        JobSystem::JobHandle normalJob = jobSystem.CreateJob("Normal Job", []() {});
+        JobSystem::JobHandle criticalJob = jobSystem.CreateJob("Critical Job", []() {}, 0, EJobPriority::Critical);
+        NES_CHECK(WaitUntil([&criticalJob]() { return criticalJob.IsDone(); }));
+        NES_CHECK(!normalJob.IsDone());
+
+        const JobSystemThreadPool::PriorityStats criticalStats = jobSystem.GetPriorityStats(EJobPriority::Critical);
+        NES_CHECK(criticalStats.m_numJobsStarted == 1);
+
+        blockingJob.Release();
+        NES_CHECK(WaitUntil([&normalJob]() { return normalJob.IsDone(); }));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A thread that waits on a Barrier helps by executing the Jobs of the Barrier that can be executed. A Job
+    // that still has dependencies must be skipped, so that the waiting thread can execute a Job behind it
+    // instead of waiting for a worker.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(BarrierWaitExecutesJobsBehindBlockedJobs)
+    {
+        JobSystemThreadPool jobSystem(kMaxJobs, kMaxBarriers, 1);
+        BlockingJob blockingJob(jobSystem);
+        NES_CHECK(blockingJob.WaitUntilStarted());
+
+        // The only worker is busy, so only the waiting thread can execute the Jobs. The blocked Job is added
+        // first, the Job that releases it second.
+        std::thread::id releasingThread;
+        JobSystem::JobHandle blockedJob = jobSystem.CreateJob("Blocked Job", []() {}, 1);
+        JobSystem::JobHandle releasingJob = jobSystem.CreateJob("Releasing Job", [&releasingThread, blockedJob]()
+        {
+            releasingThread = std::this_thread::get_id();
+            blockedJob.RemoveDependency();
+        });
+
+        // Release the worker after a while, so that the test doesn't hang if the waiting thread doesn't help.
+        std::thread watchdog([&blockingJob]()
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            blockingJob.Release();
+        });
+
+        JobSystem::Barrier* pBarrier = jobSystem.CreateBarrier();
+        pBarrier->AddJob(blockedJob);
+        pBarrier->AddJob(releasingJob);
+        jobSystem.WaitForJobs(pBarrier);
+        jobSystem.DestroyBarrier(pBarrier);
+        watchdog.join();
+
+        NES_CHECK(blockedJob.IsDone());
+        NES_CHECK(releasingThread == std::this_thread::get_id());
+    }
+}
+
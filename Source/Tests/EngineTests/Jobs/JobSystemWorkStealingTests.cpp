@@ -0,0 +1,130 @@
+// JobSystemWorkStealingTests.cpp
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "TestFramework.h"
+#include "Nessie/Core/Thread/Containers/WorkStealingDeque.h"
+#include "Nessie/Jobs/JobSystemWorkStealing.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    // While the owner pushes and pops, other threads steal. Every element must be taken exactly once, also
+    // when the buffer grows while it is being stolen from.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(WorkStealingDequeTakesEachElementOnce)
+    {
+        static constexpr int kNumElements = 100000;
+        static constexpr int kNumThieves = 3;
+
+        std::vector<int> elements(kNumElements);
+        std::vector<std::atomic<int>> numTaken(kNumElements);
+        std::atomic<int> numRemaining = kNumElements;
+        std::atomic<bool> isDone = false;
+
+        // Start small, so the deque has to grow.
+        WorkStealingDeque<int> deque(4);
+        const auto take = [&](const int* pElement)
+        {
+            numTaken[pElement - elements.data()].fetch_add(1);
+            numRemaining.fetch_sub(1);
+        };
+
+        std::vector<std::thread> thieves;
+        for (int i = 0; i < kNumThieves; ++i)
+        {
+            thieves.emplace_back([&]()
+            {
+                while (!isDone)
+                {
+                    if (const int* pElement = deque.Steal())
+                        take(pElement);
+                }
+            });
+        }
+
+        // Push in bursts, and pop a few after each burst.
+        for (int i = 0; i < kNumElements; ++i)
+        {
+            deque.Push(&elements[i]);
+            if (i % 16 == 15)
+            {
+                for (int j = 0; j < 4; ++j)
+                {
+                    if (const int* pElement = deque.Pop())
+                        take(pElement);
+                }
+            }
+        }
+
+        while (const int* pElement = deque.Pop())
+            take(pElement);
+
+        // Thieves may still hold the last elements.
+        while (numRemaining > 0)
+            std::this_thread::yield();
+        isDone = true;
+        for (std::thread& thief : thieves)
+            thief.join();
+
+        NES_CHECK(deque.IsEmpty());
+        bool allTakenOnce = true;
+        for (const std::atomic<int>& count : numTaken)
+            allTakenOnce &= count == 1;
+        NES_CHECK(allTakenOnce);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Jobs that queue more Jobs from inside a worker put them on the local deque, where idle workers steal
+    // them. There is no queue length limit, so a single Job can queue more Jobs than the JobSystemThreadPool's
+    // queue can hold.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(WorkStealingRunsJobsQueuedFromJobs)
+    {
+        static constexpr uint32 kNumRootJobs = 4;
+        static constexpr uint32 kNumChildJobs = 2048;
+        static constexpr uint32 kNumIterations = 10;
+        static constexpr uint32 kMaxJobs = 16384;
+        static_assert(kMaxJobs > kNumRootJobs * (kNumChildJobs + 1));
+
+        struct Context
+        {
+            JobSystem*              m_pJobSystem = nullptr;
+            JobSystem::JobHandle    m_finishJob;
+            std::atomic<uint32>     m_numChildrenDone = 0;
+        };
+
+        JobSystemWorkStealing jobSystem(kMaxJobs, 1, 4);
+        for (uint32 iteration = 0; iteration < kNumIterations; ++iteration)
+        {
+            Context context;
+            context.m_pJobSystem = &jobSystem;
+            context.m_finishJob = jobSystem.CreateJob("Finish", []() {}, kNumRootJobs * kNumChildJobs + kNumRootJobs);
+
+            // Each root Job queues its children, and releases its own dependency on the finish Job when it is done.
+            for (uint32 i = 0; i < kNumRootJobs; ++i)
+            {
+                jobSystem.CreateJob("Root", [&context]()
+                {
+                    for (uint32 j = 0; j < kNumChildJobs; ++j)
+                    {
+                        context.m_pJobSystem->CreateJob("Child", [&context]()
+                        {
+                            context.m_numChildrenDone.fetch_add(1);
+                            context.m_finishJob.RemoveDependency();
+                        });
+                    }
+                    context.m_finishJob.RemoveDependency();
+                });
+            }
+
+            JobSystem::Barrier* pBarrier = jobSystem.CreateBarrier();
+            pBarrier->AddJob(context.m_finishJob);
+            jobSystem.WaitForJobs(pBarrier);
+            jobSystem.DestroyBarrier(pBarrier);
+
+            NES_CHECK(context.m_finishJob.IsDone());
+            NES_CHECK(context.m_numChildrenDone == kNumRootJobs * kNumChildJobs);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+// ParallelForTests.cpp
+#include <atomic>
+#include <vector>
+#include "TestFramework.h"
+#include "Nessie/Jobs/JobSystemSingleThreaded.h"
+#include "Nessie/Jobs/JobSystemThreadPool.h"
+#include "Nessie/Jobs/JobSystemWorkStealing.h"
+#include "Nessie/Jobs/ParallelFor.h"
+
+namespace nes::test
+{
+    static constexpr uint32 kMaxJobs = 256;
+    static constexpr uint32 kMaxBarriers = 4;
+    static constexpr int kNumThreads = 7;
+
+    /// Not a multiple of any grain size, so the last chunk is smaller.
+    static constexpr uint32 kNumIterations = 10007;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Sum of values that span many orders of magnitude, so the result depends on the order in which
+    ///     they are added.
+    //----------------------------------------------------------------------------------------------------
+    static float SumInChunks(JobSystem& jobSystem, const ParallelForSettings& settings)
+    {
+        return ParallelReduce(jobSystem, 0, kNumIterations, 0.f, [](const uint32 begin, const uint32 end)
+        {
+            float sum = 0.f;
+            for (uint32 i = begin; i < end; ++i)
+                sum += 1.f / static_cast<float>((i % 97) * (i % 97) + 1);
+            return sum;
+        },
+        [](const float a, const float b) { return a + b; }, settings);
+    }
+
+    NES_TEST(ParallelForVisitsEachIterationOnce)
+    {
+        JobSystemThreadPool jobSystem(kMaxJobs, kMaxBarriers, kNumThreads);
+        for (const uint32 grainSize : { 0u, 1u, 100u })
+        {
+            ParallelForSettings settings;
+            settings.m_grainSize = grainSize;
+
+            std::vector<std::atomic<int>> numVisits(kNumIterations);
+            ParallelFor(jobSystem, 0, kNumIterations, [&numVisits](const uint32 begin, const uint32 end)
+            {
+                for (uint32 i = begin; i < end; ++i)
+                    numVisits[i].fetch_add(1);
+            }, settings);
+
+            bool allVisitedOnce = true;
+            for (const std::atomic<int>& count : numVisits)
+                allVisitedOnce &= count == 1;
+            NES_CHECK(allVisitedOnce);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // In deterministic mode, a reduction that is not associative must give exactly the same result on a single
+    // thread as on multiple threads, on every run.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(ParallelReduceIsDeterministic)
+    {
+        JobSystemSingleThreaded singleThreaded(kMaxJobs);
+        JobSystemThreadPool threadPool(kMaxJobs, kMaxBarriers, kNumThreads);
+        JobSystemWorkStealing workStealing(kMaxJobs, kMaxBarriers, kNumThreads);
+
+        for (const uint32 grainSize : { 0u, 100u })
+        {
+            ParallelForSettings settings;
+            settings.m_grainSize = grainSize;
+            settings.m_deterministic = true;
+
+            const float expected = SumInChunks(singleThreaded, settings);
+            for (int run = 0; run < 10; ++run)
+            {
+                NES_CHECK(SumInChunks(threadPool, settings) == expected);
+                NES_CHECK(SumInChunks(workStealing, settings) == expected);
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Without deterministic mode, an associative reduction must still give the same result for any number of threads.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(ParallelReduceSumsAllChunks)
+    {
+        JobSystemSingleThreaded singleThreaded(kMaxJobs);
+        JobSystemThreadPool threadPool(kMaxJobs, kMaxBarriers, kNumThreads);
+
+        const auto sum = [](JobSystem& jobSystem)
+        {
+            return ParallelReduce(jobSystem, 0, kNumIterations, uint64(0), [](const uint32 begin, const uint32 end)
+            {
+                uint64 chunkSum = 0;
+                for (uint32 i = begin; i < end; ++i)
+                    chunkSum += i;
+                return chunkSum;
+            },
+            [](const uint64 a, const uint64 b) { return a + b; });
+        };
+
+        static constexpr uint64 kExpected = static_cast<uint64>(kNumIterations) * (kNumIterations - 1) / 2;
+        NES_CHECK(sum(singleThreaded) == kExpected);
+        NES_CHECK(sum(threadPool) == kExpected);
+    }
+}
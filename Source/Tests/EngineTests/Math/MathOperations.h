@@ -0,0 +1,27 @@
+// MathOperations.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// This header is shared between the SIMD and the scalar (NES_NO_SSE) translation units, so it must not
+// reference anything from the engine namespace.
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Result of a single math operation, stored as the raw bits of each float or integer
+///     so that the SIMD and scalar implementations can be compared bit for bit.
+//----------------------------------------------------------------------------------------------------
+struct MathOperationResult
+{
+    const char*     m_pOperation = nullptr;
+    uint32_t        m_bits = 0;
+};
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Run every operation in MathOperations.inl with the SIMD implementation of the math types.
+//----------------------------------------------------------------------------------------------------
+void EvaluateSIMDMathOperations(std::vector<MathOperationResult>& outResults);
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Run every operation in MathOperations.inl with the scalar implementation of the math types.
+//----------------------------------------------------------------------------------------------------
+void EvaluateScalarMathOperations(std::vector<MathOperationResult>& outResults);
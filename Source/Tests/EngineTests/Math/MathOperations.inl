@@ -0,0 +1,244 @@
+// MathOperations.inl
+// List of math operations that is compiled twice: once with the SIMD implementation of the math types
+// (MathSIMDTests.cpp) and once with the scalar implementation (ScalarMathOperations.cpp). Both translation
+// units record the raw bits of every result so that the two implementations can be compared bit for bit.
+#pragma once
+#include <bit>
+#include "MathOperations.h"
+#include "Nessie/Math/Math.h"
+
+namespace nes::test
+{
+    namespace
+    {
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Appends the bits of each result to the results array, tagged with the operation's name.
+        //----------------------------------------------------------------------------------------------------
+        class MathResultRecorder
+        {
+        public:
+            explicit        MathResultRecorder(std::vector<MathOperationResult>& outResults) : m_results(outResults) {}
+
+            void            Record(const char* pOperation, const float value)           { m_results.push_back({ pOperation, std::bit_cast<uint32>(value) }); }
+            void            Record(const char* pOperation, const uint32 value)          { m_results.push_back({ pOperation, value }); }
+            void            Record(const char* pOperation, const int value)             { Record(pOperation, static_cast<uint32>(value)); }
+            void            Record(const char* pOperation, const bool value)            { Record(pOperation, static_cast<uint32>(value)); }
+            void            Record(const char* pOperation, const Vec3& value)           { for (size_t i = 0; i < 3; ++i) Record(pOperation, value[i]); }
+            void            Record(const char* pOperation, const Vec4& value)           { for (size_t i = 0; i < 4; ++i) Record(pOperation, value[i]); }
+            void            Record(const char* pOperation, const Vec4Reg& value)        { for (size_t i = 0; i < 4; ++i) Record(pOperation, value[i]); }
+            void            Record(const char* pOperation, const UVec4Reg& value)       { for (size_t i = 0; i < 4; ++i) Record(pOperation, value[i]); }
+            void            Record(const char* pOperation, const Quat& value)           { Record(pOperation, value.GetXYZW()); }
+            void            Record(const char* pOperation, const Mat33& value)          { for (uint i = 0; i < 3; ++i) Record(pOperation, value.GetColumn3(i)); }
+            void            Record(const char* pOperation, const Mat44& value)          { for (uint i = 0; i < 4; ++i) Record(pOperation, value.GetColumn4(i)); }
+
+        private:
+            std::vector<MathOperationResult>& m_results;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Deterministic pseudo-random floats in the range [-range, range].
+        //----------------------------------------------------------------------------------------------------
+        class InputGenerator
+        {
+        public:
+            uint32          NextUInt()                                                  { m_state = m_state * 1664525u + 1013904223u; return m_state; }
+            float           NextFloat(const float range)                                { return range * (static_cast<float>(NextUInt() >> 8) / static_cast<float>(1u << 23) - 1.f); }
+
+        private:
+            uint32          m_state = 0x4e657373;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Evaluate all operations. FusedMultiplyAdd is not included because it is only a single
+        ///     rounding step when NES_USE_FMADD is defined.
+        //----------------------------------------------------------------------------------------------------
+        void EvaluateMathOperations(std::vector<MathOperationResult>& outResults)
+        {
+            MathResultRecorder recorder(outResults);
+            InputGenerator generator;
+
+            // Values that are handled differently by some instructions.
+            const float specialValues[] = { 0.f, -0.f, 1.f, -1.f, 0.5f, -2.f, 1.0e-6f, -1.0e6f };
+            constexpr int kNumSpecialValues = static_cast<int>(std::size(specialValues));
+
+            constexpr int kNumIterations = 256;
+            for (int i = 0; i < kNumIterations; ++i)
+            {
+                // The first iterations mix in the special values.
+                auto nextFloat = [&](const float range, const int component)
+                {
+                    const int specialIndex = i * 4 + component;
+                    if (specialIndex < kNumSpecialValues * 4 && (specialIndex % 3) == 0)
+                        return specialValues[(specialIndex / 3) % kNumSpecialValues];
+                    return generator.NextFloat(range);
+                };
+
+                const Vec4Reg a(nextFloat(10.f, 0), nextFloat(10.f, 1), nextFloat(10.f, 2), nextFloat(10.f, 3));
+                const Vec4Reg b(nextFloat(10.f, 3), nextFloat(10.f, 2), nextFloat(10.f, 1), nextFloat(10.f, 0));
+                const Vec4Reg c(generator.NextFloat(1.f), generator.NextFloat(1.f), generator.NextFloat(1.f), generator.NextFloat(1.f));
+                const Vec4Reg d(generator.NextFloat(100.f), generator.NextFloat(100.f), generator.NextFloat(100.f), generator.NextFloat(100.f));
+                const UVec4Reg ua(generator.NextUInt(), generator.NextUInt(), generator.NextUInt(), generator.NextUInt());
+                const UVec4Reg ub(generator.NextUInt(), generator.NextUInt(), ua.GetZ(), generator.NextUInt());
+                const float angle = generator.NextFloat(math::Pi<float>());
+
+                // Vec4Reg arithmetic
+                recorder.Record("Vec4Reg::operator+", a + b);
+                recorder.Record("Vec4Reg::operator-", a - b);
+                recorder.Record("Vec4Reg::operator*", a * b);
+                recorder.Record("Vec4Reg::operator*(float)", a * angle);
+                recorder.Record("Vec4Reg::operator/", a / d);
+                recorder.Record("Vec4Reg::operator/(float)", a / angle);
+                recorder.Record("Vec4Reg::operator-()", -a);
+                recorder.Record("Vec4Reg::Reciprocal", d.Reciprocal());
+                recorder.Record("Vec4Reg::Abs", a.Abs());
+                recorder.Record("Vec4Reg::Sqrt", a.Abs().Sqrt());
+                recorder.Record("Vec4Reg::GetSign", a.GetSign());
+                recorder.Record("Vec4Reg::operator==", a == b);
+
+                // Vec4Reg component access
+                recorder.Record("Vec4Reg::SplatX", a.SplatX());
+                recorder.Record("Vec4Reg::SplatY", a.SplatY());
+                recorder.Record("Vec4Reg::SplatZ", a.SplatZ());
+                recorder.Record("Vec4Reg::SplatW", a.SplatW());
+                recorder.Record("Vec4Reg::Swizzle<3, 2, 1, 0>", a.Swizzle<3, 2, 1, 0>());
+                recorder.Record("Vec4Reg::Swizzle<1, 1, 0, 2>", a.Swizzle<1, 1, 0, 2>());
+                recorder.Record("Vec4Reg::ToVec3", a.ToVec3());
+                recorder.Record("Vec4Reg::ToVec4", a.ToVec4());
+                recorder.Record("Vec4Reg::GetSignBits", a.GetSignBits());
+                recorder.Record("Vec4Reg::MinComponent", a.MinComponent());
+                recorder.Record("Vec4Reg::MaxComponent", a.MaxComponent());
+                recorder.Record("Vec4Reg::ToInt", a.ToInt());
+                recorder.Record("Vec4Reg::ReinterpretAsInt", a.ReinterpretAsInt());
+
+                // Vec4Reg geometric
+                recorder.Record("Vec4Reg::DotV", a.DotV(b));
+                recorder.Record("Vec4Reg::Dot", a.Dot(b));
+                recorder.Record("Vec4Reg::LengthSqr", a.LengthSqr());
+                recorder.Record("Vec4Reg::Length", a.Length());
+                recorder.Record("Vec4Reg::Normalized", d.Normalized());
+                recorder.Record("Vec4Reg::Length3", Vec4Reg::Length3(a.ToVec3()));
+                recorder.Record("Vec4Reg::LengthSqr3", Vec4Reg::LengthSqr3(a.ToVec3()));
+                recorder.Record("Vec4Reg::Cross3", Vec4Reg::Cross3(a.ToVec3(), b.ToVec3()));
+                recorder.Record("Vec4Reg::NormalizedOr3", Vec4Reg::NormalizedOr3(a.ToVec3(), Vec3(0.f, 1.f, 0.f)));
+
+                // Vec4Reg comparisons and selection
+                recorder.Record("Vec4Reg::Min", Vec4Reg::Min(a, b));
+                recorder.Record("Vec4Reg::Max", Vec4Reg::Max(a, b));
+                recorder.Record("Vec4Reg::Equals", Vec4Reg::Equals(a, b));
+                recorder.Record("Vec4Reg::Less", Vec4Reg::Less(a, b));
+                recorder.Record("Vec4Reg::LessOrEqual", Vec4Reg::LessOrEqual(a, b));
+                recorder.Record("Vec4Reg::Greater", Vec4Reg::Greater(a, b));
+                recorder.Record("Vec4Reg::GreaterOrEqual", Vec4Reg::GreaterOrEqual(a, b));
+                recorder.Record("Vec4Reg::Select", Vec4Reg::Select(a, b, Vec4Reg::Less(a, d)));
+                recorder.Record("Vec4Reg::Or", Vec4Reg::Or(a, b));
+                recorder.Record("Vec4Reg::Xor", Vec4Reg::Xor(a, b));
+                recorder.Record("Vec4Reg::And", Vec4Reg::And(a, b));
+
+                Vec4Reg sortedValue = d;
+                UVec4Reg sortedIndex(0, 1, 2, 3);
+                Vec4Reg::Sort4(sortedValue, sortedIndex);
+                recorder.Record("Vec4Reg::Sort4", sortedValue);
+                recorder.Record("Vec4Reg::Sort4", sortedIndex);
+
+                sortedValue = d;
+                sortedIndex = UVec4Reg(0, 1, 2, 3);
+                Vec4Reg::Sort4Reverse(sortedValue, sortedIndex);
+                recorder.Record("Vec4Reg::Sort4Reverse", sortedValue);
+                recorder.Record("Vec4Reg::Sort4Reverse", sortedIndex);
+
+                // Vec4Reg trigonometry
+                Vec4Reg sin, cos;
+                (a * 0.5f).SinCos(sin, cos);
+                recorder.Record("Vec4Reg::SinCos", sin);
+                recorder.Record("Vec4Reg::SinCos", cos);
+                recorder.Record("Vec4Reg::Tan", c.Tan());
+                recorder.Record("Vec4Reg::ASin", c.ASin());
+                recorder.Record("Vec4Reg::ACos", c.ACos());
+                recorder.Record("Vec4Reg::ATan", a.ATan());
+                recorder.Record("Vec4Reg::ATan2", Vec4Reg::ATan2(a, b));
+
+                // UVec4Reg
+                recorder.Record("UVec4Reg::operator+", ua + ub);
+                recorder.Record("UVec4Reg::operator*", ua * ub);
+                recorder.Record("UVec4Reg::SplatX", ua.SplatX());
+                recorder.Record("UVec4Reg::SplatW", ua.SplatW());
+                recorder.Record("UVec4Reg::Swizzle<2, 0, 3, 1>", ua.Swizzle<2, 0, 3, 1>());
+                recorder.Record("UVec4Reg::ToFloat", ua.ToFloat());
+                recorder.Record("UVec4Reg::ReinterpretAsFloat", UVec4Reg::And(ua, UVec4Reg::Replicate(0x3fffffff)).ReinterpretAsFloat());
+                recorder.Record("UVec4Reg::LogicalShiftLeft<3>", ua.LogicalShiftLeft<3>());
+                recorder.Record("UVec4Reg::LogicalShiftRight<5>", ua.LogicalShiftRight<5>());
+                recorder.Record("UVec4Reg::ArithmeticShiftRight<7>", ua.ArithmeticShiftRight<7>());
+                recorder.Record("UVec4Reg::ShiftComponents4Minus", ua.ShiftComponents4Minus(i % 5));
+                recorder.Record("UVec4Reg::Min", UVec4Reg::Min(ua, ub));
+                recorder.Record("UVec4Reg::Max", UVec4Reg::Max(ua, ub));
+                recorder.Record("UVec4Reg::Or", UVec4Reg::Or(ua, ub));
+                recorder.Record("UVec4Reg::And", UVec4Reg::And(ua, ub));
+                recorder.Record("UVec4Reg::Xor", UVec4Reg::Xor(ua, ub));
+                recorder.Record("UVec4Reg::Not", UVec4Reg::Not(ua));
+
+                const UVec4Reg mask = Vec4Reg::Less(a, b);
+                recorder.Record("UVec4Reg::Equals", UVec4Reg::Equals(ua, ub));
+                recorder.Record("UVec4Reg::Select", UVec4Reg::Select(ua, ub, mask));
+                recorder.Record("UVec4Reg::CountTrues", mask.CountTrues());
+                recorder.Record("UVec4Reg::GetTrues", mask.GetTrues());
+                recorder.Record("UVec4Reg::Sort4True", UVec4Reg::Sort4True(mask, UVec4Reg(1, 2, 3, 4)));
+
+                UVec4Reg identifiers(10, 11, 12, 13);
+                recorder.Record("UVec4Reg::CountAndSortTrues", UVec4Reg::CountAndSortTrues(mask, identifiers));
+                recorder.Record("UVec4Reg::CountAndSortTrues", identifiers);
+
+                // Quat
+                const Quat q1 = Quat(c.ToVec4()).Normalized();
+                const Quat q2 = Quat::FromAxisAngle(Vec3(d.ToVec3()).Normalized(), angle);
+                recorder.Record("Quat::Normalized", q1);
+                recorder.Record("Quat::operator*", q1 * q2);
+                recorder.Record("Quat::FromAxisAngle", q2);
+
+                // Mat44
+                const Mat44 m1(a, b, c, d);
+                const Mat44 m2(d, c, a, b);
+                const Mat44 m1x3(Vec4Reg(a.ToVec3(), 0.f), Vec4Reg(b.ToVec3(), 0.f), Vec4Reg(c.ToVec3(), 0.f), d);
+                const Mat44 rotationTranslation = Mat44::MakeRotationTranslation(q1, a.ToVec3());
+                recorder.Record("Mat44::operator*", m1 * m2);
+                recorder.Record("Mat44::operator*(Vec3)", m1 * b.ToVec3());
+                recorder.Record("Mat44::operator*(Vec4)", m1 * b.ToVec4());
+                recorder.Record("Mat44::operator*(Vec4Reg)", m1 * b);
+                recorder.Record("Mat44::operator*(float)", m1 * angle);
+                recorder.Record("Mat44::operator+", m1 + m2);
+                recorder.Record("Mat44::operator-", m1 - m2);
+                recorder.Record("Mat44::operator-()", -m1);
+                recorder.Record("Mat44::Multiply3x3(Vec3)", m1.Multiply3x3(b.ToVec3()));
+                recorder.Record("Mat44::Multiply3x3Transposed", m1.Multiply3x3Transposed(b.ToVec3()));
+                recorder.Record("Mat44::Multiply3x3(Mat44)", m1x3.Multiply3x3(m2));
+                recorder.Record("Mat44::Multiply3x3LeftTransposed", m1.Multiply3x3LeftTransposed(m2));
+                recorder.Record("Mat44::Multiply3x3RightTransposed", m1x3.Multiply3x3RightTransposed(m2));
+                recorder.Record("Mat44::TransformPoint", m1.TransformPoint(b.ToVec3()));
+                recorder.Record("Mat44::Transposed", m1.Transposed());
+                recorder.Record("Mat44::Transposed3x3", m1.Transposed3x3());
+                recorder.Record("Mat44::Inversed", m1.Inversed());
+                recorder.Record("Mat44::InversedRotationTranslation", rotationTranslation.InversedRotationTranslation());
+                recorder.Record("Mat44::Determinant3x3", m1.Determinant3x3());
+                recorder.Record("Mat44::Determinant", m1.Determinant());
+                recorder.Record("Mat44::Adjoint3x3", m1.Adjoint3x3());
+                recorder.Record("Mat44::Inversed3x3", m1.Inversed3x3());
+                recorder.Record("Mat44::MakeRotationX", Mat44::MakeRotationX(angle));
+                recorder.Record("Mat44::MakeRotationY", Mat44::MakeRotationY(angle));
+                recorder.Record("Mat44::MakeRotationZ", Mat44::MakeRotationZ(angle));
+                recorder.Record("Mat44::MakeRotation(Quat)", Mat44::MakeRotation(q1));
+                recorder.Record("Mat44::MakeScale", Mat44::MakeScale(d.ToVec3()));
+                recorder.Record("Mat44::ComposeTransform", Mat44::ComposeTransform(a.ToVec3(), q1, d.ToVec3()));
+                recorder.Record("Mat44::OuterProduct", Mat44::OuterProduct(a.ToVec3(), b.ToVec3()));
+                recorder.Record("Mat44::CrossProduct", Mat44::CrossProduct(a.ToVec3()));
+                recorder.Record("Mat44::QuatLeftMultiply", Mat44::QuatLeftMultiply(q1));
+                recorder.Record("Mat44::QuatRightMultiply", Mat44::QuatRightMultiply(q1));
+                recorder.Record("Mat44::ToQuaternion", rotationTranslation.ToQuaternion());
+
+                // Mat33
+                const Mat33 m3(a.ToVec3(), b.ToVec3(), d.ToVec3());
+                const Mat33 m4(d.ToVec3(), c.ToVec3(), a.ToVec3());
+                recorder.Record("Mat33::operator*", m3 * m4);
+                recorder.Record("Mat33::operator*(Vec3)", m3 * b.ToVec3());
+            }
+        }
+    }
+}
@@ -0,0 +1,40 @@
+// MathSIMDTests.cpp
+#include <cstdio>
+#include "MathOperations.inl"
+#include "TestFramework.h"
+
+void EvaluateSIMDMathOperations(std::vector<MathOperationResult>& outResults)
+{
+    nes::test::EvaluateMathOperations(outResults);
+}
+
+//----------------------------------------------------------------------------------------------------
+// The SIMD and scalar implementations of Vec4Reg, UVec4Reg, Quat, Mat33 and Mat44 must produce the
+// exact same bits for every operation. 
+//----------------------------------------------------------------------------------------------------
+NES_TEST(MathSIMDMatchesScalar)
+{
+    std::vector<MathOperationResult> simdResults;
+    std::vector<MathOperationResult> scalarResults;
+    EvaluateSIMDMathOperations(simdResults);
+    EvaluateScalarMathOperations(scalarResults);
+
+    NES_CHECK(simdResults.size() == scalarResults.size());
+    if (simdResults.size() != scalarResults.size())
+        return;
+
+    // Report the first mismatch of each operation.
+    const char* pLastMismatch = nullptr;
+    for (size_t i = 0; i < simdResults.size(); ++i)
+    {
+        const MathOperationResult& simd = simdResults[i];
+        const MathOperationResult& scalar = scalarResults[i];
+        
+        if (simd.m_bits != scalar.m_bits && simd.m_pOperation != pLastMismatch)
+        {
+            std::printf("    %s: SIMD = 0x%08x, Scalar = 0x%08x (result %zu)\n", simd.m_pOperation, simd.m_bits, scalar.m_bits, i);
+            NES_CHECK(simd.m_bits == scalar.m_bits);
+            pLastMismatch = simd.m_pOperation;
+        }
+    }
+}
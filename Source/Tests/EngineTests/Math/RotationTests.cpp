@@ -0,0 +1,57 @@
+// RotationTests.cpp
+#include <cmath>
+#include "TestFramework.h"
+#include "Nessie/Math/Math.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    // Mat44::ToQuaternion() must return the rotation that the matrix was made from, for rotations that
+    // take each branch of the conversion.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(Mat44ToQuaternionRoundTrips)
+    {
+        for (const Vec3& axis : { Vec3::AxisX(), Vec3::AxisY(), Vec3::AxisZ(), Vec3(1.f, 2.f, 3.f).Normalized(), Vec3(-2.f, 1.f, 0.5f).Normalized() })
+        {
+            for (const float angle : { 0.f, 0.5f, 2.f, 3.f, -2.5f })
+            {
+                const Quat quat = Quat::FromAxisAngle(axis, angle);
+                const Quat result = Mat44::MakeRotation(quat).ToQuaternion();
+
+                // q and -q are the same rotation.
+                NES_CHECK(result.IsNormalized());
+                NES_CHECK(result.IsClose(quat, 1.0e-10f) || result.IsClose(-quat, 1.0e-10f));
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Mat44::ToQuaternion() of rotation matrices that are written out by hand, so that the result doesn't
+    // depend on Mat44::MakeRotation(). The trace of the first two is positive, the last one takes the
+    // branch for the largest diagonal element.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(Mat44ToQuaternionOfKnownMatrices)
+    {
+        struct KnownRotation
+        {
+            Mat44           m_matrix;
+            Quat            m_quat;
+        };
+
+        // 60 degrees around X, 90 degrees around Z and 180 degrees around Y.
+        const float halfSqrt3 = 0.5f * std::sqrt(3.f);
+        const float halfSqrt2 = 0.5f * std::sqrt(2.f);
+        const KnownRotation rotations[] =
+        {
+            { Mat44(Vec4(1.f, 0.f, 0.f, 0.f), Vec4(0.f, 0.5f, halfSqrt3, 0.f), Vec4(0.f, -halfSqrt3, 0.5f, 0.f), Vec4(0.f, 0.f, 0.f, 1.f)), Quat(0.5f, 0.f, 0.f, halfSqrt3) },
+            { Mat44(Vec4(0.f, 1.f, 0.f, 0.f), Vec4(-1.f, 0.f, 0.f, 0.f), Vec4(0.f, 0.f, 1.f, 0.f), Vec4(0.f, 0.f, 0.f, 1.f)), Quat(0.f, 0.f, halfSqrt2, halfSqrt2) },
+            { Mat44(Vec4(-1.f, 0.f, 0.f, 0.f), Vec4(0.f, 1.f, 0.f, 0.f), Vec4(0.f, 0.f, -1.f, 0.f), Vec4(0.f, 0.f, 0.f, 1.f)), Quat(0.f, 1.f, 0.f, 0.f) },
+        };
+
+        for (const KnownRotation& rotation : rotations)
+        {
+            const Quat result = rotation.m_matrix.ToQuaternion();
+            NES_CHECK(result.IsClose(rotation.m_quat, 1.0e-10f) || result.IsClose(-rotation.m_quat, 1.0e-10f));
+        }
+    }
+}
@@ -0,0 +1,29 @@
+// ScalarMathOperations.cpp
+// Compiles MathOperations.inl with the scalar implementation of the math types. The engine namespace is
+// renamed for the math headers of this translation unit, so that the scalar types don't conflict with the
+// SIMD types that the rest of the executable uses. The engine doesn't know about any of this.
+#define NES_NO_SSE
+
+// Asserts log through the LoggerRegistry, which is only defined in the engine's namespace. Include the assert
+// headers (which don't use the math types) before the rename, so they are declared in the engine's namespace,
+// and make their symbols visible from the renamed one.
+#include "Nessie/Debug/Assert.h"
+namespace nes_engine = nes;
+
+#define nes nes_scalar
+namespace nes
+{
+    using namespace nes_engine;
+
+    namespace internal
+    {
+        using namespace nes_engine::internal;
+    }
+}
+
+#include "MathOperations.inl"
+
+void EvaluateScalarMathOperations(std::vector<MathOperationResult>& outResults)
+{
+    nes::test::EvaluateMathOperations(outResults);
+}
@@ -0,0 +1,254 @@
+// BodyIntegrationTests.cpp
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/Body/MassProperties.h"
+#include "Nessie/Physics/Body/MotionProperties.h"
+#include "Nessie/Physics/Collision/Shapes/BoxShape.h"
+
+namespace nes::test
+{
+    /// A group of 4 bodies and a partial group of 2.
+    static constexpr uint32 kNumBodies = 6;
+
+    /// Maximum difference between the 4 wide and the single body results.
+    static constexpr float kMaxError = 1.0e-5f;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Creates bodies that differ in every input of the gravity and integration steps: rotation,
+    ///     inertia, velocity, damping and accumulated forces. The first body goes over its max linear and
+    ///     angular velocity, the last one doesn't rotate.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateBodies(PhysicsTestContext& context, BodyIDVector& outBodies)
+    {
+        for (uint32 i = 0; i < kNumBodies; ++i)
+        {
+            const float value = static_cast<float>(i);
+            const Quat rotation = Quat::FromAxisAngle(Vec3(1.f, 2.f, 3.f).Normalized(), 0.4f * value + 0.1f);
+            const Quat inertiaRotation = Quat::FromAxisAngle(Vec3(-2.f, 1.f, 0.5f).Normalized(), 0.3f * value + 0.2f);
+            const Mat44 inertiaRotationMatrix = Mat44::MakeRotation(inertiaRotation);
+
+            BodyCreateInfo info(NES_NEW(BoxShape(Vec3(0.5f, 0.3f + 0.1f * value, 0.8f))), Vec3(3.f * value, 0.f, 0.f), rotation, EBodyMotionType::Dynamic, layers::kMoving);
+            info.m_overrideMassProperties = EOverrideMassProperties::MassAndInertiaProvided;
+            info.m_massPropertiesOverride.m_mass = 1.f + value;
+            info.m_massPropertiesOverride.m_inertia = inertiaRotationMatrix.PreScaled(Vec3(1.f, 2.f + value, 3.f)).Multiply3x3RightTransposed(inertiaRotationMatrix);
+            info.m_linearVelocity = Vec3(1.f - value, 0.5f * value, 2.f);
+            info.m_angularVelocity = i == kNumBodies - 1? Vec3::Zero() : Vec3(0.3f * value, -1.f, 0.7f);
+            info.m_linearDamping = 0.1f * value;
+            info.m_angularDamping = 0.05f * value;
+            info.m_gravityScale = 1.f - 0.25f * value;
+            if (i == 0)
+            {
+                info.m_maxLinearVelocity = 2.f;
+                info.m_maxAngularVelocity = 1.f;
+            }
+
+            const BodyID bodyID = context.CreateBody(info);
+            context.GetBodyInterface().AddForceAndTorque(bodyID, Vec3(10.f * value, 40.f, -5.f), Vec3(2.f, -3.f * value, 20.f));
+            outBodies.push_back(bodyID);
+        }
+    }
+
+    static Body& GetBody(PhysicsTestContext& context, const BodyID& bodyID)
+    {
+        return *context.GetScene().GetBodyLockInterfaceNoLock().TryGetBody(bodyID);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // An inertia tensor that is not aligned with the axes must decompose into a rotation (not a reflection)
+    // and a diagonal that rebuild the tensor.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(DecomposeRotatedInertia)
+    {
+        const Mat44 rotation = Mat44::MakeRotation(Quat::FromAxisAngle(Vec3(-2.f, 1.f, 0.5f).Normalized(), 0.8f));
+        MassProperties massProperties;
+        massProperties.m_mass = 1.f;
+        massProperties.m_inertia = rotation.PreScaled(Vec3(1.f, 4.f, 3.f)).Multiply3x3RightTransposed(rotation);
+
+        Mat44 principalAxes;
+        Vec3 diagonal;
+        NES_CHECK(massProperties.DecomposePrincipalMomentsOfInertia(principalAxes, diagonal));
+        NES_CHECK(!Vec3::IsLeftHanded(principalAxes.GetAxisX(), principalAxes.GetAxisY(), principalAxes.GetAxisZ()));
+
+        const Quat principalRotation = principalAxes.ToQuaternion();
+        NES_CHECK(principalRotation.IsNormalized());
+
+        const Mat44 principalRotationMatrix = Mat44::MakeRotation(principalRotation);
+        const Mat44 inertia = principalRotationMatrix.PreScaled(diagonal).Multiply3x3RightTransposed(principalRotationMatrix);
+        for (int i = 0; i < 3; ++i)
+            NES_CHECK(inertia.GetColumn3(i).IsClose(massProperties.m_inertia.GetColumn3(i), 1.0e-8f));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The inverse inertia of a body is stored as a diagonal and a rotation. Together they must give the
+    // inverse of the inertia tensor that the body was created with, whether the eigenvectors of the tensor
+    // come out as a right-handed or a left-handed basis.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(InverseInertiaMatchesInertia)
+    {
+        const Mat44 rotation1 = Mat44::MakeRotation(Quat::FromAxisAngle(Vec3(-2.f, 1.f, 0.5f).Normalized(), 0.8f));
+        const Mat44 rotation2 = Mat44::MakeRotation(Quat::FromAxisAngle(Vec3(1.f, 2.f, 3.f).Normalized(), 2.5f));
+        const Mat44 inertias[] =
+        {
+            Mat44(Vec3(1.f, 4.f, 3.f)),                                                     // Sorted to Y, Z, X: right-handed.
+            Mat44(Vec3(3.f, 1.f, 2.f)),                                                     // Sorted to X, Z, Y: left-handed.
+            rotation1.PreScaled(Vec3(1.f, 4.f, 3.f)).Multiply3x3RightTransposed(rotation1),
+            rotation2.PreScaled(Vec3(3.f, 1.f, 2.f)).Multiply3x3RightTransposed(rotation2),
+        };
+
+        for (const Mat44& inertia : inertias)
+        {
+            MassProperties massProperties;
+            massProperties.m_mass = 1.f;
+            massProperties.m_inertia = inertia;
+
+            MotionProperties motionProps;
+            motionProps.SetMassProperties(EAllowedDOFs::All, massProperties);
+            NES_CHECK(motionProps.GetInertiaRotation().IsNormalized());
+
+            const Mat44 product = motionProps.GetLocalSpaceInverseInertiaUnchecked() * inertia;
+            for (int i = 0; i < 3; ++i)
+                NES_CHECK(product.GetColumn3(i).IsClose(Mat44::Identity().GetColumn3(i), kMaxError * kMaxError));
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The world space inverse inertia of a body is its local space inverse inertia rotated by the body
+    // rotation: R * invI * R^T. The contact and constraint solvers use GetInverseInertiaForRotation(), and
+    // the integration uses MultiplyWorldSpaceInverseInertiaByVector(), so both must give this tensor, also
+    // for bodies whose principal axes of inertia are not their local axes.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(WorldSpaceInverseInertiaMatchesLocal)
+    {
+        PhysicsTestContext context;
+        BodyIDVector bodies;
+        CreateBodies(context, bodies);
+
+        for (const BodyID& bodyID : bodies)
+        {
+            const Body& body = GetBody(context, bodyID);
+            const MotionProperties& motionProps = *body.GetMotionProperties();
+            const Mat44 rotation = Mat44::MakeRotation(body.GetRotation());
+            const Mat44 expected = rotation * motionProps.GetLocalSpaceInverseInertia() * rotation.Transposed3x3();
+
+            const Mat44 inverseInertia = motionProps.GetInverseInertiaForRotation(rotation);
+            for (int i = 0; i < 3; ++i)
+            {
+                NES_CHECK(inverseInertia.GetColumn3(i).IsClose(expected.GetColumn3(i), kMaxError * kMaxError));
+                NES_CHECK(motionProps.MultiplyWorldSpaceInverseInertiaByVector(body.GetRotation(), Mat44::Identity().GetColumn3(i)).IsClose(expected.GetColumn3(i), kMaxError * kMaxError));
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // MotionProperties::Internal_ApplyForceTorqueAndDrag4() must match Internal_ApplyForceTorqueAndDrag()
+    // for every body, in full and partial groups.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(ApplyForceTorqueAndDrag4MatchesSingleBody)
+    {
+        PhysicsTestContext context;
+        BodyIDVector bodies;
+        CreateBodies(context, bodies);
+
+        const Vec3 gravity(0.5f, -9.81f, 0.2f);
+        MotionProperties expected[kNumBodies];
+        MotionProperties* motionProps[kNumBodies];
+        Quat rotations[kNumBodies];
+        float deltaTimes[kNumBodies];
+        for (uint32 i = 0; i < kNumBodies; ++i)
+        {
+            Body& body = GetBody(context, bodies[i]);
+            motionProps[i] = body.GetMotionProperties();
+            rotations[i] = body.GetRotation();
+            deltaTimes[i] = (1.f + static_cast<float>(i % 3)) / 60.f;
+
+            expected[i] = *motionProps[i];
+            expected[i].Internal_ApplyForceTorqueAndDrag(rotations[i], gravity, deltaTimes[i]);
+        }
+
+        MotionProperties::Internal_ApplyForceTorqueAndDrag4(motionProps, rotations, deltaTimes, 4, gravity);
+        MotionProperties::Internal_ApplyForceTorqueAndDrag4(motionProps + 4, rotations + 4, deltaTimes + 4, kNumBodies - 4, gravity);
+
+        for (uint32 i = 0; i < kNumBodies; ++i)
+        {
+            NES_CHECK(motionProps[i]->GetLinearVelocity().IsClose(expected[i].GetLinearVelocity(), kMaxError * kMaxError));
+            NES_CHECK(motionProps[i]->GetAngularVelocity().IsClose(expected[i].GetAngularVelocity(), kMaxError * kMaxError));
+        }
+
+        // The first body must have been clamped.
+        NES_CHECK(motionProps[0]->GetLinearVelocity().Length() <= 2.f + kMaxError);
+        NES_CHECK(motionProps[0]->GetAngularVelocity().Length() <= 1.f + kMaxError);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Body::Internal_AddRotationStep4() must match Internal_AddRotationStep() for every body, in full and
+    // partial groups, including a body that doesn't rotate.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(AddRotationStep4MatchesSingleBody)
+    {
+        PhysicsTestContext context;
+        BodyIDVector expectedBodies;
+        CreateBodies(context, expectedBodies);
+        BodyIDVector bodies;
+        CreateBodies(context, bodies);
+
+        Body* bodies4[kNumBodies];
+        Vec3 steps[kNumBodies];
+        for (uint32 i = 0; i < kNumBodies; ++i)
+        {
+            bodies4[i] = &GetBody(context, bodies[i]);
+            steps[i] = bodies4[i]->GetAngularVelocity() * (1.f + static_cast<float>(i % 3)) / 60.f;
+            GetBody(context, expectedBodies[i]).Internal_AddRotationStep(steps[i]);
+        }
+
+        Body::Internal_AddRotationStep4(bodies4, steps, 4);
+        Body::Internal_AddRotationStep4(bodies4 + 4, steps + 4, kNumBodies - 4);
+
+        for (uint32 i = 0; i < kNumBodies; ++i)
+        {
+            const Quat expected = GetBody(context, expectedBodies[i]).GetRotation();
+            NES_CHECK(bodies4[i]->GetRotation().IsClose(expected, kMaxError * kMaxError));
+            NES_CHECK(bodies4[i]->GetRotation().IsNormalized());
+        }
+
+        // The last body must not have rotated.
+        NES_CHECK(bodies4[kNumBodies - 1]->GetRotation() == GetBody(context, expectedBodies[kNumBodies - 1]).GetRotation());
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A body must start with the velocities of its BodyCreateInfo, limited by its max velocities and its
+    // allowed degrees of freedom.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(BodyStartsWithInitialVelocities)
+    {
+        PhysicsTestContext context;
+        BodyInterface& bodyInterface = context.GetBodyInterface();
+
+        BodyCreateInfo info(NES_NEW(BoxShape(Vec3::Replicate(0.5f))), Vec3::Zero(), Quat::Identity(), EBodyMotionType::Dynamic, layers::kMoving);
+        info.m_linearVelocity = Vec3(1.f, 2.f, 3.f);
+        info.m_angularVelocity = Vec3(0.5f, -1.f, 2.f);
+        const BodyID free = context.CreateBody(info);
+        NES_CHECK(bodyInterface.GetLinearVelocity(free) == info.m_linearVelocity);
+        NES_CHECK(bodyInterface.GetAngularVelocity(free) == info.m_angularVelocity);
+
+        // Velocities above the max are scaled down to it.
+        info.m_position = RVec3(3.f, 0.f, 0.f);
+        info.m_linearVelocity = Vec3(30.f, 40.f, 0.f);
+        info.m_angularVelocity = Vec3(0.f, 0.f, -8.f);
+        info.m_maxLinearVelocity = 5.f;
+        info.m_maxAngularVelocity = 2.f;
+        const BodyID clamped = context.CreateBody(info);
+        NES_CHECK(bodyInterface.GetLinearVelocity(clamped).IsClose(Vec3(3.f, 4.f, 0.f), kMaxError * kMaxError));
+        NES_CHECK(bodyInterface.GetAngularVelocity(clamped).IsClose(Vec3(0.f, 0.f, -2.f), kMaxError * kMaxError));
+
+        // A 2D body only keeps the velocities in the XY plane and around the Z axis.
+        info.m_position = RVec3(6.f, 0.f, 0.f);
+        info.m_linearVelocity = Vec3(1.f, 2.f, 3.f);
+        info.m_angularVelocity = Vec3(0.5f, -1.f, 2.f);
+        info.m_maxLinearVelocity = 500.f;
+        info.m_maxAngularVelocity = 10.f;
+        info.m_allowedDOFs = EAllowedDOFs::Plane2D;
+        const BodyID plane2D = context.CreateBody(info);
+        NES_CHECK(bodyInterface.GetLinearVelocity(plane2D) == Vec3(1.f, 2.f, 0.f));
+        NES_CHECK(bodyInterface.GetAngularVelocity(plane2D) == Vec3(0.f, 0.f, 2.f));
+    }
+}
@@ -0,0 +1,129 @@
+// CCDTests.cpp
+#include <vector>
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/Shapes/SphereShape.h"
+
+namespace nes::test
+{
+    static constexpr float kRadius = 0.1f;
+
+    /// The wall is centered at x = kWallX and is thinner than the distance a sphere moves in one step.
+    static constexpr float kWallX = 5.f;
+    static constexpr float kWallHalfThickness = 0.05f;
+
+    /// Moves 3.33m per step at 60Hz.
+    static constexpr float kSpeed = 200.f;
+
+    static constexpr int kNumThreads[] = { 0, 3 };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : The result of shooting LinearCast spheres at a thin static wall.
+    //----------------------------------------------------------------------------------------------------
+    struct ShotResult
+    {
+        std::vector<RVec3>  m_positions;    /// Position of each sphere after all updates.
+        CCDStats            m_hitStats;     /// CCD stats of the update in which the spheres reach the wall.
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Shoot a LinearCast sphere from each start position along the X axis, towards the wall.
+    //----------------------------------------------------------------------------------------------------
+    static ShotResult ShootAtWall(const int numThreads, const std::vector<RVec3>& startPositions)
+    {
+        PhysicsTestContext::CreateInfo createInfo;
+        createInfo.m_numThreads = numThreads;
+        PhysicsTestContext context(createInfo);
+
+        context.CreateBox(RVec3(kWallX, 0.f, 0.f), Vec3(kWallHalfThickness, 50.f, 50.f), EBodyMotionType::Static);
+
+        std::vector<BodyID> sphereIDs;
+        for (const RVec3& position : startPositions)
+        {
+            BodyCreateInfo info(NES_NEW(SphereShape(kRadius)), Vec3::Zero(), Quat::Identity(), EBodyMotionType::Dynamic, layers::kMoving);
+            info.m_position = position;
+            info.m_linearVelocity = Vec3(position.x < kWallX? kSpeed : -kSpeed, 0.f, 0.f);
+            info.m_motionQuality = EBodyMotionQuality::LinearCast;
+            sphereIDs.push_back(context.CreateBody(info));
+        }
+
+        // The first update moves the spheres up to the wall, the second one would move them through it.
+        ShotResult result;
+        context.Simulate(1);
+        context.Simulate(1);
+        result.m_hitStats = context.GetScene().GetCCDStats();
+        context.Simulate(10);
+
+        for (const BodyID& sphereID : sphereIDs)
+            result.m_positions.push_back(context.GetBodyInterface().GetPosition(sphereID));
+        return result;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Check that each sphere stayed on the side of the wall that it started on.
+    //----------------------------------------------------------------------------------------------------
+    static void CheckStoppedAtWall(const std::vector<RVec3>& startPositions, const ShotResult& result)
+    {
+        // A sphere may end up penetrating the wall by up to the penetration slop.
+        static constexpr float kMaxDistance = kWallHalfThickness + kRadius - 0.02f - 1.0e-3f;
+
+        NES_CHECK(result.m_positions.size() == startPositions.size());
+        for (size_t i = 0; i < result.m_positions.size(); ++i)
+        {
+            const float x = static_cast<float>(result.m_positions[i].x);
+            if (startPositions[i].x < kWallX)
+                NES_CHECK(x < kWallX - kMaxDistance);
+            else
+                NES_CHECK(x > kWallX + kMaxDistance);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Check that a scene gives the same result for every thread count.
+    //----------------------------------------------------------------------------------------------------
+    static void CheckShotsAtWall(const std::vector<RVec3>& startPositions)
+    {
+        const ShotResult expected = ShootAtWall(kNumThreads[0], startPositions);
+        for (const int numThreads : kNumThreads)
+        {
+            const ShotResult result = ShootAtWall(numThreads, startPositions);
+            CheckStoppedAtWall(startPositions, result);
+            NES_CHECK(result.m_hitStats.m_numCCDBodies == static_cast<uint32>(startPositions.size()));
+            NES_CHECK(result.m_hitStats.m_numHits == static_cast<uint32>(startPositions.size()));
+            NES_CHECK(result.m_positions == expected.m_positions);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A single LinearCast body must not tunnel through a wall that is thinner than its step.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(CCDSingleBodyDoesNotTunnel)
+    {
+        CheckShotsAtWall({ RVec3(0.f, 0.f, 0.f) });
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A group of nearby LinearCast bodies shares its broadphase queries and must not tunnel through the wall.
+    // There are enough bodies to resolve them as separate islands when there are multiple threads.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(CCDBatchedBodiesDoNotTunnel)
+    {
+        std::vector<RVec3> startPositions;
+        for (int i = 0; i < 64; ++i)
+            startPositions.emplace_back(0.f, 0.3f * static_cast<float>(i % 8), 0.3f * static_cast<float>(i / 8));
+
+        CheckShotsAtWall(startPositions);
+
+        const ShotResult result = ShootAtWall(kNumThreads[1], startPositions);
+        NES_CHECK(result.m_hitStats.m_numBroadPhaseQueries < result.m_hitStats.m_numCCDBodies);
+        NES_CHECK(result.m_hitStats.m_numIslands > 1);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Two LinearCast bodies that hit the same static body from opposite sides must both be stopped.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(CCDBodiesHitSameStaticBody)
+    {
+        CheckShotsAtWall({ RVec3(0.f, 0.f, 0.f), RVec3(2.f * kWallX, 0.f, 0.f) });
+    }
+}
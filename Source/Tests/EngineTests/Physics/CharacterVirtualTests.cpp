@@ -0,0 +1,135 @@
+// CharacterVirtualTests.cpp
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/Character/CharacterVirtual.h"
+#include "Nessie/Physics/Collision/Shapes/BoxShape.h"
+#include "Nessie/Physics/Collision/Shapes/CapsuleShape.h"
+
+namespace nes::test
+{
+    static constexpr float kDeltaTime = 1.f / 60.f;
+
+    /// Height of the character position when the capsule rests on the floor: half height + radius + the default
+    /// character padding.
+    static constexpr float kStandingHeight = 0.5f + 0.3f + 0.02f;
+
+    static const Vec3 kGravity(0.f, -9.81f, 0.f);
+
+    static CharacterVirtual CreateCharacter(PhysicsTestContext& context, const RVec3& position)
+    {
+        CharacterVirtualSettings settings;
+        settings.m_pShape = static_cast<const Shape*>(NES_NEW(CapsuleShape(0.5f, 0.3f)));
+        return CharacterVirtual(settings, position, Quat::Identity(), &context.GetScene());
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Moves the character with a horizontal velocity, adding gravity while it is not on the ground.
+    //----------------------------------------------------------------------------------------------------
+    static void UpdateCharacter(CharacterVirtual& character, const Vec3& horizontalVelocity, const int numUpdates)
+    {
+        const CharacterVirtualUpdateSettings updateSettings;
+        for (int i = 0; i < numUpdates; ++i)
+        {
+            Vec3 velocity = horizontalVelocity;
+            if (character.GetGroundState() != CharacterVirtual::EGroundState::OnGround)
+                velocity.y = character.GetLinearVelocity().y + kGravity.y * kDeltaTime;
+            character.SetLinearVelocity(velocity);
+            character.ExtendedUpdate(kDeltaTime, kGravity, updateSettings);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create a static slope that rises along the X axis and meets the floor at x = 1.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateSlope(PhysicsTestContext& context, const float angle)
+    {
+        const Vec3 halfExtent(5.f, 0.5f, 5.f);
+        const Quat rotation = Quat::FromAxisAngle(Vec3::AxisZ(), angle);
+        const Vec3 topLeftCorner(-halfExtent.x, halfExtent.y, 0.f);
+        const RVec3 position = RVec3(1.f, 0.f, 0.f) - RVec3(rotation * topLeftCorner);
+
+        BodyCreateInfo info(NES_NEW(BoxShape(halfExtent)), position, rotation, EBodyMotionType::Static, layers::kNonMoving);
+        context.CreateBody(info);
+    }
+
+    NES_TEST(CharacterLandsOnFloor)
+    {
+        PhysicsTestContext context;
+        context.CreateFloor();
+
+        CharacterVirtual character = CreateCharacter(context, RVec3(0.f, 3.f, 0.f));
+        NES_CHECK(character.GetGroundState() == CharacterVirtual::EGroundState::InAir);
+
+        UpdateCharacter(character, Vec3::Zero(), 120);
+        NES_CHECK(character.GetGroundState() == CharacterVirtual::EGroundState::OnGround);
+        NES_CHECK(std::abs(static_cast<float>(character.GetPosition().y) - kStandingHeight) < 1.0e-3f);
+        NES_CHECK(character.GetGroundNormal().IsClose(Vec3::AxisY(), 1.0e-4f));
+    }
+
+    NES_TEST(CharacterMovesHorizontally)
+    {
+        PhysicsTestContext context;
+        context.CreateFloor();
+
+        CharacterVirtual character = CreateCharacter(context, RVec3(0.f, kStandingHeight, 0.f));
+        UpdateCharacter(character, Vec3::Zero(), 10);
+        NES_CHECK(character.GetGroundState() == CharacterVirtual::EGroundState::OnGround);
+
+        // 2 m/s for 1 second
+        UpdateCharacter(character, Vec3(2.f, 0.f, 0.f), 60);
+        const RVec3 position = character.GetPosition();
+        NES_CHECK(character.GetGroundState() == CharacterVirtual::EGroundState::OnGround);
+        NES_CHECK(std::abs(static_cast<float>(position.x) - 2.f) < 1.0e-3f);
+        NES_CHECK(std::abs(static_cast<float>(position.y) - kStandingHeight) < 1.0e-3f);
+        NES_CHECK(std::abs(static_cast<float>(position.z)) < 1.0e-3f);
+    }
+
+    NES_TEST(CharacterRespectsSlopeLimit)
+    {
+        const CharacterVirtualSettings settings;
+
+        // A slope below the max slope angle can be walked up.
+        {
+            PhysicsTestContext context;
+            context.CreateFloor();
+            CreateSlope(context, settings.m_maxSlopeAngle - math::ToRadians(20.f));
+
+            CharacterVirtual character = CreateCharacter(context, RVec3(-1.f, kStandingHeight, 0.f));
+            UpdateCharacter(character, Vec3(2.f, 0.f, 0.f), 120);
+            const RVec3 position = character.GetPosition();
+            NES_CHECK(character.GetGroundState() == CharacterVirtual::EGroundState::OnGround);
+            NES_CHECK(position.x > 2.f);
+            NES_CHECK(position.y > kStandingHeight + 0.5f);
+        }
+
+        // A slope above the max slope angle blocks the character.
+        {
+            PhysicsTestContext context;
+            context.CreateFloor();
+            CreateSlope(context, settings.m_maxSlopeAngle + math::ToRadians(20.f));
+
+            CharacterVirtual character = CreateCharacter(context, RVec3(-1.f, kStandingHeight, 0.f));
+            UpdateCharacter(character, Vec3(2.f, 0.f, 0.f), 120);
+            const RVec3 position = character.GetPosition();
+            NES_CHECK(position.x < 1.f);
+            NES_CHECK(position.y < kStandingHeight + 0.5f);
+        }
+    }
+
+    NES_TEST(CharacterWalksUpStairs)
+    {
+        PhysicsTestContext context;
+        context.CreateFloor();
+
+        // Two steps of 0.3m, which is below the default step up of 0.4m.
+        context.CreateBox(RVec3(3.f, 0.15f, 0.f), Vec3(1.f, 0.15f, 2.f), EBodyMotionType::Static);
+        context.CreateBox(RVec3(4.f, 0.3f, 0.f), Vec3(1.f, 0.3f, 2.f), EBodyMotionType::Static);
+
+        CharacterVirtual character = CreateCharacter(context, RVec3(0.f, kStandingHeight, 0.f));
+        UpdateCharacter(character, Vec3(2.f, 0.f, 0.f), 150);
+        const RVec3 position = character.GetPosition();
+        NES_CHECK(character.GetGroundState() == CharacterVirtual::EGroundState::OnGround);
+        NES_CHECK(position.x > 4.5f);
+        NES_CHECK(std::abs(static_cast<float>(position.y) - (kStandingHeight + 0.6f)) < 1.0e-3f);
+    }
+}
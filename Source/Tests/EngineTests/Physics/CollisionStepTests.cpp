@@ -0,0 +1,124 @@
+// CollisionStepTests.cpp
+#include <vector>
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/PhysicsStepListener.h"
+
+namespace nes::test
+{
+    static constexpr int kNumCollisionSteps = 4;
+    static constexpr int kNumUpdates = 60;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Drop a loose stack of boxes and spheres on a floor, with kNumCollisionSteps collision steps
+    ///     per update, and return the final positions of the bodies.
+    ///	@param outAllStepsRan : False if an update didn't run the jobs of every collision step.
+    //----------------------------------------------------------------------------------------------------
+    static void SimulateWithCollisionSteps(const int numThreads, std::vector<RVec3>& outPositions, bool& outAllStepsRan)
+    {
+        PhysicsTestContext::CreateInfo createInfo;
+        createInfo.m_numThreads = numThreads;
+        PhysicsTestContext context(createInfo);
+
+        context.CreateFloor();
+        std::vector<BodyID> bodies;
+        for (int i = 0; i < 32; ++i)
+        {
+            const RVec3 position(1.1f * static_cast<float>(i % 4) + 0.05f * static_cast<float>(i / 8), 0.6f + 1.1f * static_cast<float>(i / 8), 1.1f * static_cast<float>((i / 4) % 2));
+            bodies.push_back(i % 2 == 0? context.CreateBox(position, Vec3::Replicate(0.5f)) : context.CreateSphere(position, 0.5f));
+        }
+
+        PhysicsScene& scene = context.GetScene();
+        scene.SetStepStatsEnabled(true);
+        outAllStepsRan = true;
+        for (int update = 0; update < kNumUpdates; ++update)
+        {
+            outAllStepsRan &= context.Simulate(1, 1.f / 60.f, kNumCollisionSteps) == EPhysicsUpdateErrorCode::None;
+
+            // Each step finalizes its islands once, and every step but the last starts the next one.
+            const PhysicsStepStats& stats = scene.GetStepStats();
+            outAllStepsRan &= stats.GetJobTypeStats(EPhysicsJobType::FinalizeIslands).m_numRuns == kNumCollisionSteps;
+            outAllStepsRan &= stats.GetJobTypeStats(EPhysicsJobType::StartNextStep).m_numRuns == kNumCollisionSteps - 1;
+        }
+
+        for (const BodyID& body : bodies)
+            outPositions.push_back(context.GetBodyInterface().GetPosition(body));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // An update with several collision steps starts each step once the previous one is done. The next
+    // step resets the islands, so it must wait for all solve position jobs of the previous step, which use
+    // them. The steps must complete on any number of threads, and give the same result.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(MultipleCollisionStepsPerUpdate)
+    {
+        std::vector<RVec3> singleThreaded;
+        bool singleThreadedStepsRan = false;
+        SimulateWithCollisionSteps(0, singleThreaded, singleThreadedStepsRan);
+        NES_CHECK(singleThreadedStepsRan);
+
+        std::vector<RVec3> multiThreaded;
+        bool multiThreadedStepsRan = false;
+        SimulateWithCollisionSteps(3, multiThreaded, multiThreadedStepsRan);
+        NES_CHECK(multiThreadedStepsRan);
+
+        // The stack must have collapsed onto the floor, and not through it.
+        bool isOnFloor = true;
+        bool isSame = true;
+        for (size_t i = 0; i < singleThreaded.size(); ++i)
+        {
+            isOnFloor &= singleThreaded[i].y > 0.4f && singleThreaded[i].y < 4.f;
+            isSame &= singleThreaded[i] == multiThreaded[i];
+        }
+        NES_CHECK(isOnFloor);
+        NES_CHECK(isSame);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Counts the steps that it is called for, and checks the context of each call.
+    //----------------------------------------------------------------------------------------------------
+    class CountingStepListener final : public PhysicsStepListener
+    {
+    public:
+        virtual void OnStep(const PhysicsStepListenerContext& context) override
+        {
+            const int stepInUpdate = m_numSteps % kNumCollisionSteps;
+            m_isContextValid &= context.m_isFirstStep == (stepInUpdate == 0);
+            m_isContextValid &= context.m_isLastStep == (stepInUpdate == kNumCollisionSteps - 1);
+            m_isContextValid &= context.m_deltaTime == 1.f / (60.f * kNumCollisionSteps);
+            ++m_numSteps;
+        }
+
+        int     m_numSteps = 0;
+        bool    m_isContextValid = true;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // Each step listener that was added must be called once before every collision step, until it is removed.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(StepListenersRunBeforeEveryCollisionStep)
+    {
+        PhysicsTestContext context;
+        context.CreateFloor();
+        context.CreateBox(RVec3(0.f, 2.f, 0.f), Vec3::Replicate(0.5f));
+
+        CountingStepListener listener1;
+        CountingStepListener listener2;
+        PhysicsScene& scene = context.GetScene();
+        scene.AddStepListener(&listener1);
+        scene.AddStepListener(&listener2);
+
+        context.Simulate(10, 1.f / 60.f, kNumCollisionSteps);
+        NES_CHECK(listener1.m_numSteps == 10 * kNumCollisionSteps);
+        NES_CHECK(listener2.m_numSteps == 10 * kNumCollisionSteps);
+
+        scene.RemoveStepListener(&listener1);
+        context.Simulate(10, 1.f / 60.f, kNumCollisionSteps);
+        NES_CHECK(listener1.m_numSteps == 10 * kNumCollisionSteps);
+        NES_CHECK(listener2.m_numSteps == 20 * kNumCollisionSteps);
+
+        NES_CHECK(listener1.m_isContextValid);
+        NES_CHECK(listener2.m_isContextValid);
+        scene.RemoveStepListener(&listener2);
+    }
+}
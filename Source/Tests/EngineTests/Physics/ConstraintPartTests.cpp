@@ -0,0 +1,71 @@
+// ConstraintPartTests.cpp
+#include <cfloat>
+#include <cmath>
+#include "TestFramework.h"
+#include "Nessie/Physics/Body/MotionProperties.h"
+#include "Nessie/Physics/Constraints/ConstraintPart/AxisConstraintPart.h"
+
+namespace nes::test
+{
+    /// Maximum difference between the solved and the expected velocities and impulses.
+    static constexpr float kMaxError = 1.0e-5f;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Motion properties of a dynamic body with unit mass and inertia.
+    //----------------------------------------------------------------------------------------------------
+    static void InitUnitBody(MotionProperties& motionProps, const Vec3& linearVelocity, const Vec3& angularVelocity)
+    {
+        motionProps.SetMaxLinearVelocity(100.f);
+        motionProps.SetMaxAngularVelocity(100.f);
+        motionProps.SetInverseMass(1.f);
+        motionProps.SetInverseInertia(Vec3::Replicate(1.f), Quat::Identity());
+        motionProps.SetLinearVelocity(linearVelocity);
+        motionProps.SetAngularVelocity(angularVelocity);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A body that moves into a static body along the axis is stopped by the first iteration. Further
+    // iterations find no velocity to remove, so the accumulated impulse must stay the same instead of
+    // being added to itself.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(AxisConstraintPartStoresTotalLambda)
+    {
+        MotionProperties body1;
+        InitUnitBody(body1, Vec3(2.f, 0.f, 0.f), Vec3::Zero());
+
+        const Vec3 axis = Vec3::AxisX();
+        AxisConstraintPart part;
+        part.TemplatedCalculateConstraintProperties<EBodyMotionType::Dynamic, EBodyMotionType::Static>(1.f, Mat44::Identity(), Vec3::Zero(), 0.f, Mat44::Identity(), Vec3::Zero(), axis);
+
+        for (int iteration = 0; iteration < 4; ++iteration)
+        {
+            part.TemplatedSolveVelocityConstraint<EBodyMotionType::Dynamic, EBodyMotionType::Static>(&body1, 1.f, nullptr, 0.f, axis, 0.f, FLT_MAX);
+            NES_CHECK(std::abs(part.GetTotalLambda() - 2.f) < kMaxError);
+            NES_CHECK(body1.GetLinearVelocity().IsClose(Vec3::Zero(), kMaxError * kMaxError));
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // An impulse at an offset from the center of mass changes the linear velocity along the axis and the
+    // angular velocity around the axis perpendicular to the offset. After one iteration, the velocity of
+    // the contact point along the axis must be zero.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(AxisConstraintPartAppliesAngularImpulse)
+    {
+        MotionProperties body1;
+        InitUnitBody(body1, Vec3(1.f, 0.f, 0.f), Vec3::Zero());
+
+        // Contact point 1 m above the center of mass: r x axis = (0, 0, -1), so the inverse effective mass
+        // is 1 (linear) + 1 (angular) and the impulse is 0.5.
+        const Vec3 axis = Vec3::AxisX();
+        const Vec3 r1 = Vec3::AxisY();
+        AxisConstraintPart part;
+        part.TemplatedCalculateConstraintProperties<EBodyMotionType::Dynamic, EBodyMotionType::Static>(1.f, Mat44::Identity(), r1, 0.f, Mat44::Identity(), Vec3::Zero(), axis);
+        part.TemplatedSolveVelocityConstraint<EBodyMotionType::Dynamic, EBodyMotionType::Static>(&body1, 1.f, nullptr, 0.f, axis, 0.f, FLT_MAX);
+
+        NES_CHECK(std::abs(part.GetTotalLambda() - 0.5f) < kMaxError);
+        NES_CHECK(body1.GetLinearVelocity().IsClose(Vec3(0.5f, 0.f, 0.f), kMaxError * kMaxError));
+        NES_CHECK(body1.GetAngularVelocity().IsClose(Vec3(0.f, 0.f, 0.5f), kMaxError * kMaxError));
+        NES_CHECK(std::abs(body1.GetPointVelocityCOM(r1).Dot(axis)) < kMaxError);
+    }
+}
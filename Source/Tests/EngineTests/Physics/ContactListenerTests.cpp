@@ -0,0 +1,384 @@
+// ContactListenerTests.cpp
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/DeferredContactListener.h"
+#include "Nessie/Physics/Collision/Shapes/BoxShape.h"
+#include "Nessie/Physics/Collision/Shapes/SphereShape.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Records the bodies and normal of the first contact that is added.
+    //----------------------------------------------------------------------------------------------------
+    class FirstContactListener final : public ContactListener
+    {
+    public:
+        virtual void OnContactAdded(const Body& body1, const Body& body2, const ContactManifold& manifold, [[maybe_unused]] ContactSettings& ioSettings) override
+        {
+            if (m_numContactsAdded++ > 0)
+                return;
+
+            m_body1ID = body1.GetID();
+            m_body2ID = body2.GetID();
+            m_normal = manifold.m_worldSpaceNormal;
+        }
+
+        uint32  m_numContactsAdded = 0;
+        BodyID  m_body1ID;
+        BodyID  m_body2ID;
+        Vec3    m_normal = Vec3::Zero();
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Drop a sphere on a static box whose top face is at y = 0, and check that the contact normal
+    ///     points from body 1 to body 2 (the body with the higher ID) and that the sphere comes to rest on top.
+    ///	@param createBoxFirst : If the box gets the lower body ID.
+    ///	@param fast : If the sphere falls fast enough through the thin box that only CCD can catch it.
+    ///	@param collisionSteps : Number of collision steps per update.
+    //----------------------------------------------------------------------------------------------------
+    static void CheckSphereLandsOnBox(const bool createBoxFirst, const bool fast, const int collisionSteps)
+    {
+        static constexpr float kRadius = 0.2f;
+        static constexpr float kBoxHalfHeight = 0.05f;
+
+        PhysicsTestContext context;
+        FirstContactListener listener;
+        context.GetScene().SetContactListener(&listener);
+
+        const auto createBox = [&context]()
+        {
+            return context.CreateBox(RVec3(0.f, -kBoxHalfHeight, 0.f), Vec3(10.f, kBoxHalfHeight, 10.f), EBodyMotionType::Static);
+        };
+        const auto createSphere = [&context, fast]()
+        {
+            BodyCreateInfo info(NES_NEW(SphereShape(kRadius)), Vec3::Zero(), Quat::Identity(), EBodyMotionType::Dynamic, layers::kMoving);
+            info.m_position = RVec3(0.f, 1.f, 0.f);
+            if (fast)
+            {
+                info.m_linearVelocity = Vec3(0.f, -100.f, 0.f);
+                info.m_motionQuality = EBodyMotionQuality::LinearCast;
+            }
+            return context.CreateBody(info);
+        };
+
+        BodyID boxID;
+        BodyID sphereID;
+        if (createBoxFirst)
+        {
+            boxID = createBox();
+            sphereID = createSphere();
+        }
+        else
+        {
+            sphereID = createSphere();
+            boxID = createBox();
+        }
+
+        context.Simulate(120, 1.f / 60.f, collisionSteps);
+
+        // The normal is the direction along which to move body 2 out of collision.
+        NES_CHECK(listener.m_numContactsAdded > 0);
+        NES_CHECK(listener.m_body1ID < listener.m_body2ID);
+        const Vec3 expectedNormal = listener.m_body2ID == sphereID? Vec3::AxisY() : -Vec3::AxisY();
+        NES_CHECK(listener.m_normal.IsClose(expectedNormal, 1.0e-4f));
+
+        // A resting body may sink into the box by up to the penetration slop.
+        const float penetrationSlop = context.GetScene().GetSettings().m_penetrationSlop;
+        const float height = static_cast<float>(context.GetBodyInterface().GetPosition(sphereID).y);
+        NES_CHECK(height > kRadius - penetrationSlop - 1.0e-3f);
+        NES_CHECK(height < kRadius + 1.0e-3f);
+
+        context.GetScene().SetContactListener(nullptr);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The manifold of a discrete contact must be swapped along with the bodies, for either order of the
+    // body IDs and with any number of collision steps per update.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(ContactManifoldMatchesBodyOrder)
+    {
+        for (const int collisionSteps : { 1, 3 })
+        {
+            CheckSphereLandsOnBox(true, false, collisionSteps);
+            CheckSphereLandsOnBox(false, false, collisionSteps);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The manifold of a CCD contact must be swapped along with the bodies, for either order of the body IDs
+    // and with any number of collision steps per update.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(CCDContactManifoldMatchesBodyOrder)
+    {
+        for (const int collisionSteps : { 1, 3 })
+        {
+            CheckSphereLandsOnBox(true, true, collisionSteps);
+            CheckSphereLandsOnBox(false, true, collisionSteps);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Counts the callbacks of the contacts between a sensor and other bodies.
+    //----------------------------------------------------------------------------------------------------
+    class SensorContactListener final : public ContactListener
+    {
+    public:
+        virtual void OnContactAdded(const Body& body1, const Body& body2, [[maybe_unused]] const ContactManifold& manifold, [[maybe_unused]] ContactSettings& ioSettings) override
+        {
+            m_onlySensorContacts &= body1.IsSensor() || body2.IsSensor();
+            ++m_numAdded;
+        }
+
+        virtual void OnContactPersisted(const Body& body1, const Body& body2, [[maybe_unused]] const ContactManifold& manifold, [[maybe_unused]] ContactSettings& ioSettings) override
+        {
+            m_onlySensorContacts &= body1.IsSensor() || body2.IsSensor();
+            ++m_numPersisted;
+        }
+
+        virtual void OnContactRemoved([[maybe_unused]] const SubShapeIDPair& subShapePair) override
+        {
+            ++m_numRemoved;
+        }
+
+        uint32  m_numAdded = 0;
+        uint32  m_numPersisted = 0;
+        uint32  m_numRemoved = 0;
+        bool    m_onlySensorContacts = true;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // A body that moves through a sensor must get an added callback when it enters, persisted callbacks
+    // while it stays, and a removed callback when it leaves. The pair must never create a contact
+    // constraint, so the body is not slowed down.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(SensorReportsEnterStayAndExit)
+    {
+        PhysicsTestContext context;
+        context.GetScene().SetStepStatsEnabled(true);
+        SensorContactListener listener;
+        context.GetScene().SetContactListener(&listener);
+
+        BodyCreateInfo sensorInfo(NES_NEW(BoxShape(Vec3::Replicate(1.f))), Vec3::Zero(), Quat::Identity(), EBodyMotionType::Static, layers::kNonMoving);
+        sensorInfo.m_isSensor = true;
+        context.CreateBody(sensorInfo);
+
+        // Moves down at a constant speed, from above the sensor to below it.
+        static constexpr float kSpeed = 2.f;
+        BodyCreateInfo sphereInfo(NES_NEW(SphereShape(0.2f)), Vec3::Zero(), Quat::Identity(), EBodyMotionType::Dynamic, layers::kMoving);
+        sphereInfo.m_position = RVec3(0.f, 2.f, 0.f);
+        sphereInfo.m_linearVelocity = Vec3(0.f, -kSpeed, 0.f);
+        sphereInfo.m_gravityScale = 0.f;
+        sphereInfo.m_linearDamping = 0.f;
+        const BodyID sphereID = context.CreateBody(sphereInfo);
+
+        // Enter
+        bool hasManifolds = false;
+        const auto simulate = [&context, &hasManifolds](const int numUpdates)
+        {
+            for (int i = 0; i < numUpdates; ++i)
+            {
+                context.Simulate();
+                hasManifolds |= context.GetScene().GetStepStats().m_numManifolds > 0;
+            }
+        };
+        simulate(30);
+        NES_CHECK(listener.m_numAdded == 1);
+        NES_CHECK(listener.m_numRemoved == 0);
+
+        // Stay
+        const uint32 numPersisted = listener.m_numPersisted;
+        simulate(30);
+        NES_CHECK(listener.m_numAdded == 1);
+        NES_CHECK(listener.m_numPersisted > numPersisted);
+        NES_CHECK(listener.m_numRemoved == 0);
+
+        // Exit
+        simulate(60);
+        NES_CHECK(listener.m_numAdded == 1);
+        NES_CHECK(listener.m_numRemoved == 1);
+
+        NES_CHECK(listener.m_onlySensorContacts);
+        NES_CHECK(!hasManifolds);
+        NES_CHECK(context.GetBodyInterface().GetLinearVelocity(sphereID).IsClose(Vec3(0.f, -kSpeed, 0.f), 1.0e-6f));
+        NES_CHECK(context.GetBodyInterface().GetPosition(sphereID).y < -1.2f);
+
+        context.GetScene().SetContactListener(nullptr);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Appends the delivered events to a single list.
+    //----------------------------------------------------------------------------------------------------
+    class RecordingEventHandler final : public ContactEventHandler
+    {
+    public:
+        enum class EEventType : uint8
+        {
+            Added,
+            Persisted,
+            Removed,
+        };
+
+        struct Record
+        {
+            EEventType      m_type;
+            ContactEvent    m_event;
+        };
+
+        virtual void OnContactsAdded(std::span<const ContactEvent> events) override         { Append(EEventType::Added, events); }
+        virtual void OnContactsPersisted(std::span<const ContactEvent> events) override     { Append(EEventType::Persisted, events); }
+
+        virtual void OnContactsRemoved(std::span<const SubShapeIDPair> subShapePairs) override
+        {
+            for (const SubShapeIDPair& pair : subShapePairs)
+            {
+                ContactEvent event {};
+                event.m_subShapePair = pair;
+                m_records.push_back({ EEventType::Removed, event });
+            }
+        }
+
+        std::vector<Record> m_records;
+
+    private:
+        void Append(const EEventType type, std::span<const ContactEvent> events)
+        {
+            for (const ContactEvent& event : events)
+                m_records.push_back({ type, event });
+        }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Check if two records describe the same event. The sequence numbers are not compared, they
+    ///     depend on the order in which the threads recorded the events.
+    //----------------------------------------------------------------------------------------------------
+    static bool IsSameEvent(const RecordingEventHandler::Record& left, const RecordingEventHandler::Record& right)
+    {
+        const ContactEvent& a = left.m_event;
+        const ContactEvent& b = right.m_event;
+        return left.m_type == right.m_type
+            && a.m_subShapePair == b.m_subShapePair
+            && a.m_step == b.m_step
+            && a.m_position == b.m_position
+            && a.m_worldSpaceNormal == b.m_worldSpaceNormal
+            && a.m_penetrationDepth == b.m_penetrationDepth
+            && a.m_normalSpeed == b.m_normalSpeed
+            && a.m_numContactPoints == b.m_numContactPoints
+            && a.m_isSensor == b.m_isSensor;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Topple a grid of boxes onto a floor and record the events of every update.
+    //----------------------------------------------------------------------------------------------------
+    static void RecordContactEvents(const int numThreads, std::vector<RecordingEventHandler::Record>& outRecords)
+    {
+        PhysicsTestContext::CreateInfo createInfo;
+        createInfo.m_numThreads = numThreads;
+        PhysicsTestContext context(createInfo);
+
+        DeferredContactListener listener;
+        context.GetScene().SetContactListener(&listener);
+
+        context.CreateFloor();
+        for (int i = 0; i < 64; ++i)
+        {
+            const RVec3 position(1.1f * static_cast<float>(i % 4) + 0.05f * static_cast<float>(i / 16), 0.6f + 1.1f * static_cast<float>(i / 16), 1.1f * static_cast<float>((i / 4) % 4));
+            if (i % 2 == 0)
+                context.CreateBox(position, Vec3::Replicate(0.5f));
+            else
+                context.CreateSphere(position, 0.5f);
+        }
+
+        RecordingEventHandler handler;
+        for (int i = 0; i < 90; ++i)
+        {
+            context.Simulate(1, 1.f / 60.f, 2);
+            listener.DeliverEvents(handler);
+        }
+        outRecords = std::move(handler.m_records);
+
+        context.GetScene().SetContactListener(nullptr);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The events delivered by a DeferredContactListener must not depend on the number of threads that
+    // simulated the scene.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(DeferredContactEventsDoNotDependOnThreadCount)
+    {
+        std::vector<RecordingEventHandler::Record> singleThreaded;
+        RecordContactEvents(0, singleThreaded);
+
+        std::vector<RecordingEventHandler::Record> multiThreaded;
+        RecordContactEvents(3, multiThreaded);
+
+        NES_CHECK(!singleThreaded.empty());
+        NES_CHECK(singleThreaded.size() == multiThreaded.size());
+        if (singleThreaded.size() == multiThreaded.size())
+            NES_CHECK(std::equal(singleThreaded.begin(), singleThreaded.end(), multiThreaded.begin(), IsSameEvent));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Record one removed contact on each of numThreads new threads, starting at body index firstBody.
+    //----------------------------------------------------------------------------------------------------
+    static void RecordOnNewThreads(DeferredContactListener& listener, const uint32 numThreads, const uint32 firstBody)
+    {
+        std::vector<std::thread> threads;
+        for (uint32 i = 0; i < numThreads; ++i)
+        {
+            threads.emplace_back([&listener, body = firstBody + i]()
+            {
+                listener.OnContactRemoved(SubShapeIDPair(BodyID(body), SubShapeID(), BodyID(body + 1000), SubShapeID()));
+            });
+        }
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The threads that record events can change between updates, for example when a job system is recreated.
+    // DeliverEvents and ClearEvents must release the buffers of the threads, so that more than kMaxThreadBuffers
+    // threads over the lifetime of the listener don't all end up in the locked overflow buffer.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(DeferredContactListenerReleasesThreadBuffers)
+    {
+        static constexpr uint32 kNumThreads = DeferredContactListener::kMaxThreadBuffers + 16;
+        DeferredContactListener listener;
+
+        // More threads than buffers: the last ones share the overflow buffer, but all events are delivered.
+        RecordOnNewThreads(listener, kNumThreads, 0);
+        NES_CHECK(listener.GetNumRecordingThreads() == kNumThreads);
+
+        RecordingEventHandler handler;
+        listener.DeliverEvents(handler);
+        NES_CHECK(handler.m_records.size() == kNumThreads);
+        NES_CHECK(listener.GetNumRecordingThreads() == 0);
+
+        // The threads of the first round are gone. New threads must get buffers of their own again.
+        RecordOnNewThreads(listener, 8, kNumThreads);
+        NES_CHECK(listener.GetNumRecordingThreads() == 8);
+
+        handler.m_records.clear();
+        listener.DeliverEvents(handler);
+        NES_CHECK(handler.m_records.size() == 8);
+        bool isSecondRound = true;
+        for (const RecordingEventHandler::Record& record : handler.m_records)
+            isSecondRound &= record.m_event.m_subShapePair.GetBody1ID().GetIndex() >= kNumThreads;
+        NES_CHECK(isSecondRound);
+
+        // The calling thread caches its buffer. Clearing must release it as well, and discard its events.
+        listener.OnContactRemoved(SubShapeIDPair(BodyID(0), SubShapeID(), BodyID(1), SubShapeID()));
+        NES_CHECK(listener.GetNumRecordingThreads() == 1);
+        listener.ClearEvents();
+        NES_CHECK(listener.GetNumRecordingThreads() == 0);
+
+        listener.OnContactRemoved(SubShapeIDPair(BodyID(0), SubShapeID(), BodyID(1), SubShapeID()));
+        NES_CHECK(listener.GetNumRecordingThreads() == 1);
+        handler.m_records.clear();
+        listener.DeliverEvents(handler);
+        NES_CHECK(handler.m_records.size() == 1);
+    }
+}
@@ -0,0 +1,175 @@
+// ContactSolverTests.cpp
+#include <cmath>
+#include <vector>
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/Shapes/BoxShape.h"
+
+namespace nes::test
+{
+    /// Number of boxes along the bottom row of the pyramid, which has kPyramidBase * (kPyramidBase + 1) / 2 boxes.
+    /// All boxes touch, so the pyramid is a single island that is large enough to be split.
+    static constexpr uint32 kPyramidBase = 16;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create a 2D pyramid of unit boxes on a floor. Each box rests on the 2 boxes below it and touches
+    ///     its neighbors in the same row.
+    ///	@param oddAllowedDOFs : Degrees of freedom of every second box, so that bodies with and without restricted
+    ///     DOFs are solved together.
+    //----------------------------------------------------------------------------------------------------
+    static void CreatePyramid(PhysicsTestContext& context, const EAllowedDOFs oddAllowedDOFs, std::vector<BodyID>& outBoxes, std::vector<RVec3>& outPositions)
+    {
+        context.CreateFloor();
+        for (uint32 row = 0; row < kPyramidBase; ++row)
+        {
+            for (uint32 i = 0; i < kPyramidBase - row; ++i)
+            {
+                const RVec3 position(static_cast<float>(i) + 0.5f * static_cast<float>(row) - 0.5f * static_cast<float>(kPyramidBase), 0.5f + static_cast<float>(row), 0.f);
+                BodyCreateInfo info(NES_NEW(BoxShape(Vec3::Replicate(0.5f))), Vec3::Zero(), Quat::Identity(), EBodyMotionType::Dynamic, layers::kMoving);
+                info.m_position = position;
+                info.m_allowedDOFs = outBoxes.size() % 2 == 1? oddAllowedDOFs : EAllowedDOFs::All;
+                outBoxes.push_back(context.CreateBody(info));
+                outPositions.push_back(position);
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create a dynamic unit box without damping, so that only contacts change its velocity.
+    //----------------------------------------------------------------------------------------------------
+    static BodyID CreateUndampedBox(PhysicsTestContext& context, const RVec3& position, const Quat& rotation, const Vec3& linearVelocity)
+    {
+        BodyCreateInfo info(NES_NEW(BoxShape(Vec3::Replicate(0.5f))), Vec3::Zero(), rotation, EBodyMotionType::Dynamic, layers::kMoving);
+        info.m_position = position;
+        info.m_linearVelocity = linearVelocity;
+        info.m_linearDamping = 0.f;
+        info.m_angularDamping = 0.f;
+        return context.CreateBody(info);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Contact impulses between two dynamic bodies are equal and opposite, so without gravity the total
+    // linear momentum of two boxes of equal mass must be the same before and after they collide.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(DynamicBoxesConserveMomentum)
+    {
+        static constexpr float kSpeed = 3.f;
+
+        PhysicsTestContext context;
+        context.GetScene().SetGravity(Vec3::Zero());
+        BodyInterface& bodyInterface = context.GetBodyInterface();
+
+        // Box 2 is turned a little, so that the contact points are not symmetric.
+        const BodyID box1 = CreateUndampedBox(context, RVec3(-1.5f, 0.f, 0.f), Quat::Identity(), Vec3(kSpeed, 0.f, 0.f));
+        const BodyID box2 = CreateUndampedBox(context, RVec3::Zero(), Quat::FromAxisAngle(Vec3::AxisY(), 0.2f), Vec3::Zero());
+
+        context.Simulate(30);
+
+        // The boxes must have touched.
+        const Vec3 velocity1 = bodyInterface.GetLinearVelocity(box1);
+        const Vec3 velocity2 = bodyInterface.GetLinearVelocity(box2);
+        NES_CHECK(velocity2.x > 0.5f);
+        NES_CHECK((velocity1 + velocity2).IsClose(Vec3(kSpeed, 0.f, 0.f), 1.0e-6f));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The pyramid is one large island, which the LargeIslandSplitter splits into parallel batches. Each batch
+    // must solve exactly the contacts of its own split, so the pyramid must stay standing.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(SplitPyramidStaysStacked)
+    {
+        for (const int numThreads : { 0, 3 })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_numThreads = numThreads;
+            PhysicsTestContext context(createInfo);
+
+            std::vector<BodyID> boxes;
+            std::vector<RVec3> startPositions;
+            CreatePyramid(context, EAllowedDOFs::All, boxes, startPositions);
+
+            PhysicsScene& scene = context.GetScene();
+            scene.SetStepStatsEnabled(true);
+            context.Simulate();
+            NES_CHECK(scene.GetStepStats().m_numSplitIslands == 1);
+            scene.SetStepStatsEnabled(false);
+
+            context.Simulate(119);
+
+            bool allInPlace = true;
+            for (size_t i = 0; i < boxes.size(); ++i)
+                allInPlace &= Vec3(context.GetBodyInterface().GetPosition(boxes[i]) - startPositions[i]).Length() < 0.05f;
+            NES_CHECK(allInPlace);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The parallel batches of a split island are solved 4 contacts at a time with SIMD, unless
+    // PhysicsSettings::m_useSIMDContactSolver is false. Both paths solve the same contacts in the same order,
+    // so they must give the same velocities up to rounding, also for bodies that can't rotate around every axis.
+    // The rounding differences grow as the pyramid settles, so only the first updates are compared.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(SIMDContactSolverMatchesScalar)
+    {
+        static constexpr int kNumUpdates = 3;
+        static constexpr float kMaxError = 1.0e-4f;
+
+        struct BoxVelocity
+        {
+            Vec3            m_linear;
+            Vec3            m_angular;
+        };
+
+        const auto simulate = [](const bool useSIMD, std::vector<BoxVelocity>& outVelocities, int& outNumSplitUpdates)
+        {
+            PhysicsTestContext context;
+            PhysicsSettings settings = context.GetScene().GetSettings();
+            settings.m_useSIMDContactSolver = useSIMD;
+            context.GetScene().SetSettings(settings);
+
+            // Every second box can only move in the XY plane and rotate around Z.
+            std::vector<BodyID> boxes;
+            std::vector<RVec3> startPositions;
+            CreatePyramid(context, EAllowedDOFs::Plane2D, boxes, startPositions);
+
+            // Count the updates in which the pyramid was split, so that the SIMD path is known to be used.
+            PhysicsScene& scene = context.GetScene();
+            scene.SetStepStatsEnabled(true);
+            for (int update = 0; update < kNumUpdates; ++update)
+            {
+                context.Simulate();
+                outNumSplitUpdates += scene.GetStepStats().m_numSplitIslands > 0? 1 : 0;
+            }
+
+            for (const BodyID& box : boxes)
+                outVelocities.push_back({ context.GetBodyInterface().GetLinearVelocity(box), context.GetBodyInterface().GetAngularVelocity(box) });
+        };
+
+        std::vector<BoxVelocity> simdVelocities;
+        std::vector<BoxVelocity> scalarVelocities;
+        int numSplitUpdates = 0;
+        simulate(true, simdVelocities, numSplitUpdates);
+        simulate(false, scalarVelocities, numSplitUpdates);
+        NES_CHECK(numSplitUpdates == 2 * kNumUpdates);
+
+        bool isClose = true;
+        bool isLocked = true;
+        bool isRotating = false;        // Some contacts must have made the boxes rotate, so that the angular terms are compared.
+        for (size_t i = 0; i < simdVelocities.size(); ++i)
+        {
+            isClose &= simdVelocities[i].m_linear.IsClose(scalarVelocities[i].m_linear, kMaxError * kMaxError);
+            isClose &= simdVelocities[i].m_angular.IsClose(scalarVelocities[i].m_angular, kMaxError * kMaxError);
+            isRotating |= std::abs(simdVelocities[i].m_angular.z) > 1.0e-3f;
+
+            // The locked axes of the odd boxes must not pick up any velocity.
+            if (i % 2 == 1)
+            {
+                isLocked &= simdVelocities[i].m_linear.z == 0.f;
+                isLocked &= simdVelocities[i].m_angular.x == 0.f && simdVelocities[i].m_angular.y == 0.f;
+            }
+        }
+        NES_CHECK(isClose);
+        NES_CHECK(isLocked);
+        NES_CHECK(isRotating);
+    }
+}
@@ -0,0 +1,70 @@
+// IslandBuilderTests.cpp
+#include <algorithm>
+#include <vector>
+#include "TestFramework.h"
+#include "Nessie/Core/Memory/StackAllocator.h"
+#include "Nessie/Physics/IslandBuilder.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    // Bodies 0, 1 and 2 touch in a cycle, and bodies 3 and 4 have two contacts. The last link of the cycle
+    // and the second contact of 3 and 4 connect bodies that are already in the same island. Linking them
+    // again must leave the islands unchanged.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(IslandBuilderLinksBodiesInSameIsland)
+    {
+        static constexpr uint32 kNumBodies = 5;
+        static constexpr uint32 kContacts[][2] = { { 0, 1 }, { 1, 2 }, { 2, 0 }, { 3, 4 }, { 4, 3 } };
+        static constexpr uint32 kNumContacts = static_cast<uint32>(std::size(kContacts));
+
+        StackAllocator allocator(1024 * 1024);
+        IslandBuilder builder;
+        builder.Init(kNumBodies);
+        builder.PrepareContactConstraints(kNumContacts, &allocator);
+        builder.PrepareNonContactConstraints(0, &allocator);
+
+        for (uint32 i = 0; i < kNumContacts; ++i)
+        {
+            builder.LinkBodies(kContacts[i][0], kContacts[i][1]);
+            builder.LinkContact(i, kContacts[i][0], kContacts[i][1]);
+        }
+
+        BodyID activeBodies[kNumBodies];
+        for (uint32 i = 0; i < kNumBodies; ++i)
+            activeBodies[i] = BodyID(i);
+        builder.Finalize(activeBodies, kNumBodies, kNumContacts, &allocator);
+
+        // The islands are sorted by size, so look them up by their first body.
+        NES_CHECK(builder.GetNumIslands() == 2);
+        for (uint32 island = 0; island < builder.GetNumIslands(); ++island)
+        {
+            BodyID* pBodiesBegin;
+            BodyID* pBodiesEnd;
+            builder.GetBodiesInIsland(island, pBodiesBegin, pBodiesEnd);
+            std::vector<uint32> bodies;
+            for (const BodyID* pBody = pBodiesBegin; pBody < pBodiesEnd; ++pBody)
+                bodies.push_back(pBody->GetIndex());
+            std::ranges::sort(bodies);
+
+            uint32* pContactsBegin;
+            uint32* pContactsEnd;
+            NES_CHECK(builder.GetContactsInIsland(island, pContactsBegin, pContactsEnd));
+            std::vector<uint32> contacts(pContactsBegin, pContactsEnd);
+            std::ranges::sort(contacts);
+
+            if (!bodies.empty() && bodies.front() == 0)
+            {
+                NES_CHECK(bodies == std::vector<uint32>({ 0, 1, 2 }));
+                NES_CHECK(contacts == std::vector<uint32>({ 0, 1, 2 }));
+            }
+            else
+            {
+                NES_CHECK(bodies == std::vector<uint32>({ 3, 4 }));
+                NES_CHECK(contacts == std::vector<uint32>({ 3, 4 }));
+            }
+        }
+
+        builder.ResetIslands(&allocator);
+    }
+}
@@ -0,0 +1,79 @@
+// LargeWorldTests.cpp
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/NarrowPhaseQuery.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+
+// Float positions can only be accurate to a few centimeters this far from the origin, so these tests
+// only apply to double precision builds.
+#ifdef NES_DOUBLE_PRECISION
+
+namespace nes::test
+{
+    /// Offset of the scene from the origin, 1000 km away.
+    static const RVec3 kFarOffset(1.0e6, 0.0, -1.0e6);
+
+    /// Maximum difference between the scene at the origin and the scene far away.
+    static constexpr double kMaxError = 1.0e-4;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Creates a floor with a stack of boxes and a rolling sphere on it, around offset.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateScene(PhysicsTestContext& context, const RVec3& offset, BodyIDVector& outBodies)
+    {
+        context.CreateBox(offset + Vec3(0.f, -1.f, 0.f), Vec3(50.f, 1.f, 50.f), EBodyMotionType::Static);
+        for (int i = 0; i < 4; ++i)
+            outBodies.push_back(context.CreateBox(offset + Vec3(0.05f * static_cast<float>(i), 0.5f + 1.05f * static_cast<float>(i), 0.f), Vec3::Replicate(0.5f)));
+
+        const BodyID sphereID = context.CreateSphere(offset + Vec3(-5.f, 0.5f, 2.f), 0.5f);
+        context.GetBodyInterface().SetLinearVelocity(sphereID, Vec3(2.f, 0.f, -1.f));
+        outBodies.push_back(sphereID);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Bodies far from the origin must move the same as bodies at the origin, to well below a millimeter.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(FarFromOriginMatchesOrigin)
+    {
+        PhysicsTestContext origin;
+        BodyIDVector originBodies;
+        CreateScene(origin, RVec3::Zero(), originBodies);
+
+        PhysicsTestContext far;
+        BodyIDVector farBodies;
+        CreateScene(far, kFarOffset, farBodies);
+
+        origin.Simulate(120);
+        far.Simulate(120);
+
+        for (size_t i = 0; i < originBodies.size(); ++i)
+        {
+            const RVec3 originPosition = origin.GetBodyInterface().GetPosition(originBodies[i]);
+            const RVec3 farPosition = far.GetBodyInterface().GetPosition(farBodies[i]) - kFarOffset;
+            NES_CHECK(farPosition.IsClose(originPosition, kMaxError * kMaxError));
+        }
+
+        // The sphere must actually have rolled.
+        const RVec3 spherePosition = far.GetBodyInterface().GetPosition(farBodies.back()) - kFarOffset;
+        NES_CHECK(spherePosition.x > -4.f);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A ray cast far from the origin must find the surface that it hits to well below a millimeter.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(FarFromOriginRayCast)
+    {
+        PhysicsTestContext context;
+        context.CreateBox(kFarOffset + Vec3(0.f, -1.f, 0.f), Vec3(50.f, 1.f, 50.f), EBodyMotionType::Static);
+
+        const RRayCast ray(kFarOffset + Vec3(0.3f, 10.f, -0.7f), Vec3(0.f, -20.f, 0.f));
+        RayCastResult hit;
+        NES_CHECK(context.GetScene().GetNarrowPhaseQuery().CastRay(ray, hit));
+
+        const RVec3 hitPoint = ray.GetPointAlongRay(hit.m_fraction) - kFarOffset;
+        NES_CHECK(hitPoint.IsClose(RVec3(0.3, 0.0, -0.7), kMaxError * kMaxError));
+    }
+}
+
+#endif
@@ -0,0 +1,92 @@
+// PhysicsAllocationTests.cpp
+#include <cstdio>
+#include "AllocationCounter.h"
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/StateRecorderImpl.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Creates a grid of boxes and spheres that fall on the floor and on each other.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateFallingBodies(PhysicsTestContext& context)
+    {
+        context.CreateFloor();
+        for (int y = 0; y < 4; ++y)
+        {
+            for (int x = 0; x < 8; ++x)
+            {
+                for (int z = 0; z < 8; ++z)
+                {
+                    const RVec3 position(1.1f * static_cast<float>(x), 0.5f + 1.1f * static_cast<float>(y), 1.1f * static_cast<float>(z));
+                    if ((x + y + z) % 2 == 0)
+                        context.CreateBox(position, Vec3::Replicate(0.5f));
+                    else
+                        context.CreateSphere(position, 0.5f);
+                }
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Once the scene has warmed up, PhysicsScene::Update() must not allocate, with or without worker threads.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(PhysicsUpdateDoesNotAllocate)
+    {
+        for (const int numThreads : { 0, 3 })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_numThreads = numThreads;
+            PhysicsTestContext context(createInfo);
+            CreateFallingBodies(context);
+            context.GetScene().OptimizeBroadPhase();
+
+            // The bodies settle within a second, keep them awake so that every update solves their contacts.
+            PhysicsSettings settings = context.GetScene().GetSettings();
+            settings.m_allowSleeping = false;
+            context.GetScene().SetSettings(settings);
+
+            // Warm up, so that the bodies are in contact.
+            context.Simulate(30);
+
+            const uint64_t numAllocations = ::test::GetNumAllocations();
+            context.Simulate(30);
+            const uint64_t numUpdateAllocations = ::test::GetNumAllocations() - numAllocations;
+
+            if (numUpdateAllocations != 0)
+                std::printf("    %d threads: %llu allocations in 30 updates\n", numThreads, static_cast<unsigned long long>(numUpdateAllocations));
+            NES_CHECK(numUpdateAllocations == 0);
+            NES_CHECK(context.GetScene().GetNumActiveBodies() > 0);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Saving into and restoring from a reused recorder must not allocate once the buffers have grown. The
+    // updates in between move the bodies, so the broadphase is updated as well.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(PhysicsRestoreStateDoesNotAllocate)
+    {
+        PhysicsTestContext context;
+        CreateFallingBodies(context);
+        context.Simulate(30);
+
+        // Save from both contact caches once, so that all scratch buffers have grown.
+        StateRecorderImpl snapshot;
+        context.GetScene().SaveState(snapshot);
+        context.Simulate(1);
+        snapshot.Clear();
+        context.GetScene().SaveState(snapshot);
+        NES_CHECK(context.GetScene().RestoreState(snapshot));
+
+        const uint64_t numAllocations = ::test::GetNumAllocations();
+        for (int i = 0; i < 4; ++i)
+        {
+            snapshot.Clear();
+            context.GetScene().SaveState(snapshot);
+            context.Simulate(1);
+            NES_CHECK(context.GetScene().RestoreState(snapshot));
+        }
+        NES_CHECK(::test::GetNumAllocations() == numAllocations);
+    }
+}
@@ -0,0 +1,434 @@
+// PhysicsStepStatsTests.cpp
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/PhysicsStepStats.h"
+
+namespace nes::test
+{
+    static constexpr int kNumCollisionSteps = 2;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : A parsed JSON value, with just enough of the format to check a trace file.
+    //----------------------------------------------------------------------------------------------------
+    struct JsonValue
+    {
+        enum class EType
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object,
+        };
+
+        EType                   m_type = EType::Null;
+        double                  m_number = 0.0;
+        std::string             m_string;
+        std::vector<JsonValue>  m_array;
+        std::vector<std::pair<std::string, JsonValue>> m_object;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Get the member of an object with the key, or nullptr if there is none.
+        //----------------------------------------------------------------------------------------------------
+        const JsonValue*        Find(const std::string& key) const
+        {
+            for (const auto& [memberKey, value] : m_object)
+            {
+                if (memberKey == key)
+                    return &value;
+            }
+            return nullptr;
+        }
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Strict recursive descent parser for a JSON document. Parse() fails on anything that is not
+    ///     well-formed JSON, including trailing commas and trailing characters.
+    //----------------------------------------------------------------------------------------------------
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(const std::string& text) : m_text(text) {}
+
+        bool Parse(JsonValue& outValue)
+        {
+            return ParseValue(outValue) && (SkipWhitespace(), m_pos == m_text.size());
+        }
+
+    private:
+        void SkipWhitespace()
+        {
+            while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+                ++m_pos;
+        }
+
+        bool Consume(const char c)
+        {
+            SkipWhitespace();
+            if (m_pos >= m_text.size() || m_text[m_pos] != c)
+                return false;
+
+            ++m_pos;
+            return true;
+        }
+
+        bool ConsumeWord(const char* pWord)
+        {
+            const std::string word(pWord);
+            if (m_text.compare(m_pos, word.size(), word) != 0)
+                return false;
+
+            m_pos += word.size();
+            return true;
+        }
+
+        bool ParseString(std::string& outString)
+        {
+            if (!Consume('"'))
+                return false;
+
+            while (m_pos < m_text.size())
+            {
+                const char c = m_text[m_pos++];
+                if (c == '"')
+                    return true;
+
+                if (static_cast<unsigned char>(c) < 0x20)
+                    return false;
+
+                if (c == '\\')
+                {
+                    if (m_pos >= m_text.size())
+                        return false;
+
+                    const char escaped = m_text[m_pos++];
+                    switch (escaped)
+                    {
+                        case '"': case '\\': case '/': outString += escaped; break;
+                        case 'b': outString += '\b'; break;
+                        case 'f': outString += '\f'; break;
+                        case 'n': outString += '\n'; break;
+                        case 'r': outString += '\r'; break;
+                        case 't': outString += '\t'; break;
+                        default: return false;
+                    }
+                    continue;
+                }
+
+                outString += c;
+            }
+            return false;
+        }
+
+        bool ParseNumber(double& outNumber)
+        {
+            // Check the JSON number grammar, which is stricter than strtod(): -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+            const size_t start = m_pos;
+            const auto isDigit = [this]() { return m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos])); };
+            const auto skipDigits = [this, &isDigit]() { const size_t begin = m_pos; while (isDigit()) ++m_pos; return m_pos > begin; };
+
+            if (m_pos < m_text.size() && m_text[m_pos] == '-')
+                ++m_pos;
+
+            if (m_pos < m_text.size() && m_text[m_pos] == '0')
+                ++m_pos;
+            else if (!skipDigits())
+                return false;
+
+            if (m_pos < m_text.size() && m_text[m_pos] == '.')
+            {
+                ++m_pos;
+                if (!skipDigits())
+                    return false;
+            }
+
+            if (m_pos < m_text.size() && (m_text[m_pos] == 'e' || m_text[m_pos] == 'E'))
+            {
+                ++m_pos;
+                if (m_pos < m_text.size() && (m_text[m_pos] == '+' || m_text[m_pos] == '-'))
+                    ++m_pos;
+                if (!skipDigits())
+                    return false;
+            }
+
+            outNumber = std::strtod(m_text.substr(start, m_pos - start).c_str(), nullptr);
+            return true;
+        }
+
+        bool ParseValue(JsonValue& outValue)
+        {
+            SkipWhitespace();
+            if (m_pos >= m_text.size())
+                return false;
+
+            switch (m_text[m_pos])
+            {
+                case '{':
+                {
+                    ++m_pos;
+                    outValue.m_type = JsonValue::EType::Object;
+                    if (Consume('}'))
+                        return true;
+
+                    do
+                    {
+                        std::string key;
+                        JsonValue value;
+                        if (!ParseString(key) || !Consume(':') || !ParseValue(value))
+                            return false;
+
+                        outValue.m_object.emplace_back(std::move(key), std::move(value));
+                    } while (Consume(','));
+
+                    return Consume('}');
+                }
+
+                case '[':
+                {
+                    ++m_pos;
+                    outValue.m_type = JsonValue::EType::Array;
+                    if (Consume(']'))
+                        return true;
+
+                    do
+                    {
+                        JsonValue value;
+                        if (!ParseValue(value))
+                            return false;
+
+                        outValue.m_array.push_back(std::move(value));
+                    } while (Consume(','));
+
+                    return Consume(']');
+                }
+
+                case '"':
+                    outValue.m_type = JsonValue::EType::String;
+                    return ParseString(outValue.m_string);
+
+                case 't':
+                    outValue.m_type = JsonValue::EType::Bool;
+                    outValue.m_number = 1.0;
+                    return ConsumeWord("true");
+
+                case 'f':
+                    outValue.m_type = JsonValue::EType::Bool;
+                    return ConsumeWord("false");
+
+                case 'n':
+                    return ConsumeWord("null");
+
+                default:
+                    outValue.m_type = JsonValue::EType::Number;
+                    return ParseNumber(outValue.m_number);
+            }
+        }
+
+    private:
+        const std::string&      m_text;
+        size_t                  m_pos = 0;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create a floor with a few layers of boxes and spheres on it, and simulate until they are
+    ///     in contact, so that the update runs every job and finds contacts.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateSettlingBodies(PhysicsTestContext& context)
+    {
+        context.CreateFloor();
+        for (int i = 0; i < 48; ++i)
+        {
+            const RVec3 position(1.05f * static_cast<float>(i % 4), 0.5f + 1.05f * static_cast<float>(i / 16), 1.05f * static_cast<float>((i / 4) % 4));
+            if (i % 2 == 0)
+                context.CreateBox(position, Vec3::Replicate(0.5f));
+            else
+                context.CreateSphere(position, 0.5f);
+        }
+
+        context.Simulate(10);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // With the stats enabled, an update must fill in its counters, the high water mark of its temporary
+    // allocator and a timing for every job that it ran. Each collision step finalizes its islands once.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(StepStatsAreFilledInAfterUpdate)
+    {
+        for (const int numThreads : { 0, 3 })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_numThreads = numThreads;
+            PhysicsTestContext context(createInfo);
+            CreateSettlingBodies(context);
+
+            PhysicsScene& scene = context.GetScene();
+            scene.SetStepStatsEnabled(true);
+            context.Simulate(1, 1.f / 60.f, kNumCollisionSteps);
+
+            const PhysicsStepStats& stats = scene.GetStepStats();
+            NES_CHECK(stats.m_numCollisionSteps == kNumCollisionSteps);
+            NES_CHECK(stats.m_updateWallTime > 0);
+            NES_CHECK(stats.m_numBodyPairs > 0);
+            NES_CHECK(stats.m_numManifolds > 0);
+            NES_CHECK(stats.m_numIslands > 0);
+            NES_CHECK(stats.m_maxBodiesInIsland > 1);
+            NES_CHECK(stats.m_maxConstraintsInIsland > 0);
+
+            const StackAllocator& allocator = context.GetStackAllocator();
+            NES_CHECK(stats.m_stackAllocatorCapacity == allocator.Capacity());
+            NES_CHECK(stats.m_stackAllocatorHighWaterMark > 0);
+            NES_CHECK(stats.m_stackAllocatorHighWaterMark == allocator.HighWaterMark());
+            NES_CHECK(stats.m_stackAllocatorHighWaterMark <= stats.m_stackAllocatorCapacity);
+
+            NES_CHECK(stats.GetNumJobTimings() > 0);
+            NES_CHECK(stats.GetNumDroppedJobTimings() == 0);
+            NES_CHECK(stats.GetJobTypeStats(EPhysicsJobType::FinalizeIslands).m_numRuns == kNumCollisionSteps);
+            NES_CHECK(stats.GetJobTypeStats(EPhysicsJobType::StartNextStep).m_numRuns == kNumCollisionSteps - 1);
+            NES_CHECK(stats.GetJobTypeStats(EPhysicsJobType::FindCollisions).m_numRuns >= kNumCollisionSteps);
+            NES_CHECK(stats.GetJobTypeStats(EPhysicsJobType::SolveVelocityConstraints).m_numRuns >= kNumCollisionSteps);
+
+            // Every job ran inside the update, in one of its steps, on one of the threads.
+            bool isInUpdate = true;
+            const uint32 numStatsThreads = stats.GetNumThreads();
+            NES_CHECK(numStatsThreads >= 1 && numStatsThreads <= static_cast<uint32>(numThreads) + 1);
+            for (uint32 i = 0; i < stats.GetNumJobTimings(); ++i)
+            {
+                const PhysicsJobTiming& timing = stats.GetJobTiming(i);
+                isInUpdate &= timing.m_startTime + timing.m_wallTime <= stats.m_updateWallTime;
+                isInUpdate &= timing.m_stepIndex < kNumCollisionSteps;
+                isInUpdate &= timing.m_threadIndex < numStatsThreads;
+                isInUpdate &= timing.m_type < EPhysicsJobType::Num;
+            }
+            NES_CHECK(isInUpdate);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The high water mark of an update only counts the memory that the update used: memory that was
+    // allocated and freed before the update must not show up in the stats.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(StepStatsHighWaterMarkResetsEachUpdate)
+    {
+        PhysicsTestContext context;
+        CreateSettlingBodies(context);
+
+        PhysicsScene& scene = context.GetScene();
+        scene.SetStepStatsEnabled(true);
+        context.Simulate();
+        const size_t updateHighWaterMark = scene.GetStepStats().m_stackAllocatorHighWaterMark;
+        StackAllocator& allocator = context.GetStackAllocator();
+        NES_CHECK(updateHighWaterMark > 0 && updateHighWaterMark < allocator.Capacity());
+
+        // Use more of the allocator than the update does, then run the same update again.
+        const size_t largeSize = updateHighWaterMark + (allocator.Capacity() - updateHighWaterMark) / 2;
+        void* pLarge = allocator.Allocate(largeSize);
+        allocator.Free(pLarge, largeSize);
+        NES_CHECK(allocator.HighWaterMark() >= largeSize);
+
+        context.Simulate();
+        NES_CHECK(scene.GetStepStats().m_stackAllocatorHighWaterMark > 0);
+        NES_CHECK(scene.GetStepStats().m_stackAllocatorHighWaterMark < largeSize);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The trace file must be well-formed JSON in the Chrome trace event format: a complete ("X") event
+    // for every recorded job, named after its type, and a metadata event with the counters of the update.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(StepStatsTraceFileIsValidJson)
+    {
+        PhysicsTestContext::CreateInfo createInfo;
+        createInfo.m_numThreads = 3;
+        PhysicsTestContext context(createInfo);
+        CreateSettlingBodies(context);
+
+        PhysicsScene& scene = context.GetScene();
+        scene.SetStepStatsEnabled(true);
+        context.Simulate(1, 1.f / 60.f, kNumCollisionSteps);
+        const PhysicsStepStats& stats = scene.GetStepStats();
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "NessiePhysicsStepStatsTrace.json";
+        NES_CHECK(stats.WriteTraceFile(path));
+
+        std::stringstream text;
+        {
+            std::ifstream stream(path);
+            text << stream.rdbuf();
+        }
+        std::filesystem::remove(path);
+
+        JsonValue root;
+        NES_CHECK(JsonParser(text.str()).Parse(root));
+        const JsonValue* pEvents = root.Find("traceEvents");
+        NES_CHECK(pEvents != nullptr && pEvents->m_type == JsonValue::EType::Array);
+        if (pEvents == nullptr)
+            return;
+
+        uint32 jobEventsPerType[static_cast<size_t>(EPhysicsJobType::Num)] = {};
+        uint32 numJobEvents = 0;
+        uint32 numMetadataEvents = 0;
+        bool isValidEvent = true;
+        for (const JsonValue& event : pEvents->m_array)
+        {
+            const JsonValue* pName = event.Find("name");
+            const JsonValue* pPhase = event.Find("ph");
+            isValidEvent &= pName != nullptr && pName->m_type == JsonValue::EType::String;
+            isValidEvent &= pPhase != nullptr && pPhase->m_type == JsonValue::EType::String;
+            if (pName == nullptr || pPhase == nullptr)
+                continue;
+
+            if (pPhase->m_string == "X")
+            {
+                ++numJobEvents;
+                for (const char* pField : { "pid", "tid", "ts", "dur" })
+                {
+                    const JsonValue* pValue = event.Find(pField);
+                    isValidEvent &= pValue != nullptr && pValue->m_type == JsonValue::EType::Number && pValue->m_number >= 0.0;
+                }
+
+                const JsonValue* pArgs = event.Find("args");
+                const JsonValue* pStep = pArgs != nullptr? pArgs->Find("step") : nullptr;
+                isValidEvent &= pStep != nullptr && pStep->m_number < kNumCollisionSteps;
+
+                for (size_t type = 0; type < static_cast<size_t>(EPhysicsJobType::Num); ++type)
+                {
+                    if (pName->m_string == ToString(static_cast<EPhysicsJobType>(type)))
+                        ++jobEventsPerType[type];
+                }
+            }
+            else if (pPhase->m_string == "M" && pName->m_string == "process_name")
+            {
+                ++numMetadataEvents;
+                const JsonValue* pArgs = event.Find("args");
+                const JsonValue* pSteps = pArgs != nullptr? pArgs->Find("numCollisionSteps") : nullptr;
+                const JsonValue* pManifolds = pArgs != nullptr? pArgs->Find("numManifolds") : nullptr;
+                const JsonValue* pHighWaterMark = pArgs != nullptr? pArgs->Find("stackAllocatorHighWaterMark") : nullptr;
+                isValidEvent &= pSteps != nullptr && pSteps->m_number == static_cast<double>(stats.m_numCollisionSteps);
+                isValidEvent &= pManifolds != nullptr && pManifolds->m_number == static_cast<double>(stats.m_numManifolds);
+                isValidEvent &= pHighWaterMark != nullptr && pHighWaterMark->m_number == static_cast<double>(stats.m_stackAllocatorHighWaterMark);
+            }
+            else
+            {
+                isValidEvent = false;
+            }
+        }
+
+        NES_CHECK(isValidEvent);
+        NES_CHECK(numMetadataEvents == 1);
+        NES_CHECK(numJobEvents == stats.GetNumJobTimings());
+
+        bool matchesStats = true;
+        for (size_t type = 0; type < static_cast<size_t>(EPhysicsJobType::Num); ++type)
+            matchesStats &= jobEventsPerType[type] == stats.GetJobTypeStats(static_cast<EPhysicsJobType>(type)).m_numRuns;
+        NES_CHECK(matchesStats);
+        NES_CHECK(jobEventsPerType[static_cast<size_t>(EPhysicsJobType::FinalizeIslands)] == kNumCollisionSteps);
+    }
+}
@@ -0,0 +1,137 @@
+// PhysicsTestContext.cpp
+#include "PhysicsTestContext.h"
+#include "Nessie/Jobs/JobSystemSingleThreaded.h"
+#include "Nessie/Jobs/JobSystemThreadPool.h"
+#include "Nessie/Physics/Collision/Shapes/BoxShape.h"
+#include "Nessie/Physics/Collision/Shapes/CapsuleShape.h"
+#include "Nessie/Physics/Collision/Shapes/ConvexHullShape.h"
+#include "Nessie/Physics/Collision/Shapes/EmptyShape.h"
+#include "Nessie/Physics/Collision/Shapes/HeightFieldShape.h"
+#include "Nessie/Physics/Collision/Shapes/MeshShape.h"
+#include "Nessie/Physics/Collision/Shapes/MutableCompoundShape.h"
+#include "Nessie/Physics/Collision/Shapes/SphereShape.h"
+#include "Nessie/Physics/Collision/Shapes/StaticCompoundShape.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Each collision layer has its own broadphase layer.
+    //----------------------------------------------------------------------------------------------------
+    class PhysicsTestContext::BroadPhaseLayers final : public BroadPhaseLayerInterface
+    {
+    public:
+        virtual unsigned int    GetNumBroadPhaseLayers() const override                 { return layers::kNumLayers; }
+        virtual BroadPhaseLayer GetBroadPhaseLayer(const CollisionLayer layer) const override { return BroadPhaseLayer(static_cast<BroadPhaseLayer::Type>(layer)); }
+    };
+
+    class PhysicsTestContext::CollisionVsBroadPhaseFilter final : public CollisionVsBroadPhaseLayerFilter
+    {
+    public:
+        virtual bool            ShouldCollide(const CollisionLayer collisionLayer, const BroadPhaseLayer broadPhaseLayer) const override
+        {
+            return collisionLayer == layers::kMoving || broadPhaseLayer.GetValue() == layers::kMoving;
+        }
+    };
+
+    class PhysicsTestContext::LayerPairFilter final : public CollisionLayerPairFilter
+    {
+    public:
+        virtual bool            ShouldCollide(const CollisionLayer layer1, const CollisionLayer layer2) const override
+        {
+            return layer1 == layers::kMoving || layer2 == layers::kMoving;
+        }
+    };
+
+    void RegisterPhysicsTypes()
+    {
+        static bool s_registered = false;
+        if (s_registered)
+            return;
+        s_registered = true;
+
+        // The generic convex functions must be registered first, the specific shapes override them.
+        ConvexShape::Register();
+        CompoundShape::Register();
+        BoxShape::Register();
+        SphereShape::Register();
+        CapsuleShape::Register();
+        ConvexHullShape::Register();
+        StaticCompoundShape::Register();
+        MutableCompoundShape::Register();
+        MeshShape::Register();
+        HeightFieldShape::Register();
+        EmptyShape::Register();
+    }
+
+    PhysicsTestContext::PhysicsTestContext(const CreateInfo& createInfo)
+        : m_pBroadPhaseLayers(std::make_unique<BroadPhaseLayers>())
+        , m_pCollisionVsBroadPhaseFilter(std::make_unique<CollisionVsBroadPhaseFilter>())
+        , m_pLayerPairFilter(std::make_unique<LayerPairFilter>())
+        , m_pStackAllocator(std::make_unique<StackAllocator>(createInfo.m_stackAllocatorSize))
+    {
+        RegisterPhysicsTypes();
+
+        if (createInfo.m_numThreads > 0)
+            m_pJobSystem = std::make_unique<JobSystemThreadPool>(physics::kMaxPhysicsJobs, physics::kMaxPhysicsBarriers, createInfo.m_numThreads);
+        else
+            m_pJobSystem = std::make_unique<JobSystemSingleThreaded>(physics::kMaxPhysicsJobs);
+
+        PhysicsScene::CreateInfo sceneInfo;
+        sceneInfo.m_pLayerInterface = m_pBroadPhaseLayers.get();
+        sceneInfo.m_pCollisionVsBroadPhaseLayerFilter = m_pCollisionVsBroadPhaseFilter.get();
+        sceneInfo.m_pCollisionLayerPairFilter = m_pLayerPairFilter.get();
+        sceneInfo.m_maxBodies = createInfo.m_maxBodies;
+        sceneInfo.m_maxNumBodyPairs = createInfo.m_maxBodyPairs;
+        sceneInfo.m_maxNumContactConstraints = createInfo.m_maxContactConstraints;
+        sceneInfo.m_broadPhaseType = createInfo.m_broadPhaseType;
+        m_scene.Init(sceneInfo);
+    }
+
+    PhysicsTestContext::~PhysicsTestContext()
+    {
+        // Remove the bodies while the scene is still complete.
+        BodyIDVector bodyIDs;
+        m_scene.GetBodies(bodyIDs);
+        if (!bodyIDs.empty())
+        {
+            BodyInterface& bodyInterface = m_scene.GetBodyInterface();
+            bodyInterface.RemoveBodies(bodyIDs.data(), static_cast<int>(bodyIDs.size()));
+            bodyInterface.DestroyBodies(bodyIDs.data(), static_cast<int>(bodyIDs.size()));
+        }
+    }
+
+    EPhysicsUpdateErrorCode PhysicsTestContext::Simulate(const int numUpdates, const float deltaTime, const int collisionSteps)
+    {
+        EPhysicsUpdateErrorCode errors = EPhysicsUpdateErrorCode::None;
+        for (int i = 0; i < numUpdates; ++i)
+            errors |= m_scene.Update(deltaTime, collisionSteps, m_pStackAllocator.get(), m_pJobSystem.get());
+        return errors;
+    }
+
+    BodyID PhysicsTestContext::CreateFloor(const float halfExtent)
+    {
+        return CreateBox(RVec3(0.f, -1.f, 0.f), Vec3(halfExtent, 1.f, halfExtent), EBodyMotionType::Static);
+    }
+
+    BodyID PhysicsTestContext::CreateBox(const RVec3& position, const Vec3& halfExtent, const EBodyMotionType motionType)
+    {
+        const CollisionLayer layer = motionType == EBodyMotionType::Static? layers::kNonMoving : layers::kMoving;
+        BodyCreateInfo info(NES_NEW(BoxShape(halfExtent)), Vec3::Zero(), Quat::Identity(), motionType, layer);
+        info.m_position = position;
+        return CreateBody(info);
+    }
+
+    BodyID PhysicsTestContext::CreateSphere(const RVec3& position, const float radius, const EBodyMotionType motionType)
+    {
+        const CollisionLayer layer = motionType == EBodyMotionType::Static? layers::kNonMoving : layers::kMoving;
+        BodyCreateInfo info(NES_NEW(SphereShape(radius)), Vec3::Zero(), Quat::Identity(), motionType, layer);
+        info.m_position = position;
+        return CreateBody(info);
+    }
+
+    BodyID PhysicsTestContext::CreateBody(const BodyCreateInfo& createInfo)
+    {
+        const EBodyActivationMode activation = createInfo.m_motionType == EBodyMotionType::Static? EBodyActivationMode::DontActivate : EBodyActivationMode::Activate;
+        return m_scene.GetBodyInterface().CreateAndAddBody(createInfo, activation);
+    }
+}
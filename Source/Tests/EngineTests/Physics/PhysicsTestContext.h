@@ -0,0 +1,100 @@
+// PhysicsTestContext.h
+#pragma once
+#include <memory>
+#include "Nessie/Core/Memory/StackAllocator.h"
+#include "Nessie/Jobs/JobSystem.h"
+#include "Nessie/Physics/PhysicsScene.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Collision layers used by the physics tests. Non-moving bodies only collide with moving
+    ///     bodies, moving bodies collide with everything.
+    //----------------------------------------------------------------------------------------------------
+    namespace layers
+    {
+        static constexpr CollisionLayer kNonMoving = 0;
+        static constexpr CollisionLayer kMoving = 1;
+        static constexpr CollisionLayer kNumLayers = 2;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Register the collision functions of all shapes with the CollisionSolver. Safe to call
+    ///     more than once.
+    //----------------------------------------------------------------------------------------------------
+    void                        RegisterPhysicsTypes();
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Owns a PhysicsScene along with the layer interfaces, job system and stack allocator that
+    ///     it needs, so that a test or benchmark can set up a scene in a couple of lines.
+    //----------------------------------------------------------------------------------------------------
+    class PhysicsTestContext
+    {
+    public:
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Settings for the scene and job system of the context.
+        //----------------------------------------------------------------------------------------------------
+        struct CreateInfo
+        {
+            EBroadPhaseType         m_broadPhaseType = EBroadPhaseType::QuadTree;
+            uint32                  m_maxBodies = 10240;
+            uint32                  m_maxBodyPairs = 65536;
+            uint32                  m_maxContactConstraints = 20480;
+            int                     m_numThreads = 0;           /// Number of worker threads. 0 runs all jobs on the calling thread.
+            size_t                  m_stackAllocatorSize = 64 * 1024 * 1024;
+        };
+
+    public:
+                                    PhysicsTestContext() : PhysicsTestContext(CreateInfo()) {}
+        explicit                    PhysicsTestContext(const CreateInfo& createInfo);
+                                    ~PhysicsTestContext();
+                                    PhysicsTestContext(const PhysicsTestContext&) = delete;
+        PhysicsTestContext&         operator=(const PhysicsTestContext&) = delete;
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Run numUpdates updates of deltaTime seconds, each with collisionSteps collision steps.
+        /// @returns : The error codes of all updates combined.
+        //----------------------------------------------------------------------------------------------------
+        EPhysicsUpdateErrorCode     Simulate(const int numUpdates = 1, const float deltaTime = 1.f / 60.f, const int collisionSteps = 1);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a static box with its top face at y = 0.
+        //----------------------------------------------------------------------------------------------------
+        BodyID                      CreateFloor(const float halfExtent = 100.f);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a body with a box shape and add it to the scene. Dynamic and kinematic bodies are
+        ///     activated and put in the moving layer.
+        //----------------------------------------------------------------------------------------------------
+        BodyID                      CreateBox(const RVec3& position, const Vec3& halfExtent, const EBodyMotionType motionType = EBodyMotionType::Dynamic);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a body with a sphere shape and add it to the scene. Dynamic and kinematic bodies
+        ///     are activated and put in the moving layer.
+        //----------------------------------------------------------------------------------------------------
+        BodyID                      CreateSphere(const RVec3& position, const float radius, const EBodyMotionType motionType = EBodyMotionType::Dynamic);
+
+        //----------------------------------------------------------------------------------------------------
+        /// @brief : Create a body from create info and add it to the scene, activating it when it can move.
+        //----------------------------------------------------------------------------------------------------
+        BodyID                      CreateBody(const BodyCreateInfo& createInfo);
+
+        PhysicsScene&               GetScene()                  { return m_scene; }
+        BodyInterface&              GetBodyInterface()          { return m_scene.GetBodyInterface(); }
+        JobSystem&                  GetJobSystem()              { return *m_pJobSystem; }
+        StackAllocator&             GetStackAllocator()         { return *m_pStackAllocator; }
+
+    private:
+        class BroadPhaseLayers;
+        class CollisionVsBroadPhaseFilter;
+        class LayerPairFilter;
+
+    private:
+        std::unique_ptr<BroadPhaseLayers>           m_pBroadPhaseLayers;
+        std::unique_ptr<CollisionVsBroadPhaseFilter> m_pCollisionVsBroadPhaseFilter;
+        std::unique_ptr<LayerPairFilter>            m_pLayerPairFilter;
+        std::unique_ptr<StackAllocator>             m_pStackAllocator;
+        std::unique_ptr<JobSystem>                  m_pJobSystem;
+        PhysicsScene                                m_scene;
+    };
+}
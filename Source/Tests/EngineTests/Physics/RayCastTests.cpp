@@ -0,0 +1,150 @@
+// RayCastTests.cpp
+#include <algorithm>
+#include <deque>
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/NarrowPhaseQuery.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Random/Rng.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Scatter static boxes and spheres through a cube of 40m.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateScatteredBodies(PhysicsTestContext& context)
+    {
+        RandomNumberGenerator rng(42);
+        for (int i = 0; i < 500; ++i)
+        {
+            const RVec3 position(rng.RandRange(-20.f, 20.f), rng.RandRange(-20.f, 20.f), rng.RandRange(-20.f, 20.f));
+            if (i % 2 == 0)
+                context.CreateBox(position, Vec3(rng.RandRange(0.2f, 1.f), rng.RandRange(0.2f, 1.f), rng.RandRange(0.2f, 1.f)), EBodyMotionType::Static);
+            else
+                context.CreateSphere(position, rng.RandRange(0.2f, 1.f), EBodyMotionType::Static);
+        }
+
+        context.GetScene().OptimizeBroadPhase();
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create fans of 32 rays that start at the same point, which share most of the nodes that they
+    ///     visit, followed by rays with a random origin.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateRays(std::vector<RRayCast>& outRays)
+    {
+        RandomNumberGenerator rng(7);
+        const auto randomVec3 = [&rng](const float halfExtent)
+        {
+            return Vec3(rng.RandRange(-halfExtent, halfExtent), rng.RandRange(-halfExtent, halfExtent), rng.RandRange(-halfExtent, halfExtent));
+        };
+
+        for (int fan = 0; fan < 32; ++fan)
+        {
+            const RVec3 origin(randomVec3(20.f));
+            for (int i = 0; i < 32; ++i)
+                outRays.emplace_back(origin, randomVec3(30.f));
+        }
+
+        for (int i = 0; i < 1024; ++i)
+            outRays.emplace_back(RVec3(randomVec3(20.f)), randomVec3(30.f));
+    }
+
+    static bool IsSameHit(const RayCastResult& left, const RayCastResult& right)
+    {
+        return left.m_bodyID == right.m_bodyID && left.m_subShapeID2 == right.m_subShapeID2 && left.m_fraction == right.m_fraction;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Cast each ray with CastRay().
+    /// @returns : The number of rays that hit something.
+    //----------------------------------------------------------------------------------------------------
+    static uint CastEachRay(const NarrowPhaseQuery& query, const std::vector<RRayCast>& rays, std::vector<RayCastResult>& outHits, const std::vector<const BodyFilter*>* pRayBodyFilters = nullptr)
+    {
+        uint numHits = 0;
+        outHits.assign(rays.size(), RayCastResult());
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            const BodyFilter defaultFilter;
+            const BodyFilter* pFilter = pRayBodyFilters != nullptr && (*pRayBodyFilters)[i] != nullptr? (*pRayBodyFilters)[i] : &defaultFilter;
+            if (query.CastRay(rays[i], outHits[i], {}, {}, *pFilter))
+                ++numHits;
+        }
+        return numHits;
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The batched CastRays() must find the same closest hit as casting each ray on its own, for each
+    // broadphase, and for both the single-threaded and the job system version.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(CastRaysMatchesCastRay)
+    {
+        std::vector<RRayCast> rays;
+        CreateRays(rays);
+
+        for (const EBroadPhaseType broadPhaseType : { EBroadPhaseType::QuadTree, EBroadPhaseType::OctTree, EBroadPhaseType::SweepAndPrune })
+        {
+            PhysicsTestContext::CreateInfo createInfo;
+            createInfo.m_broadPhaseType = broadPhaseType;
+            createInfo.m_numThreads = 3;
+            PhysicsTestContext context(createInfo);
+            CreateScatteredBodies(context);
+
+            const NarrowPhaseQuery& query = context.GetScene().GetNarrowPhaseQuery();
+
+            std::vector<RayCastResult> expected;
+            const uint expectedNumHits = CastEachRay(query, rays, expected);
+            NES_CHECK(expectedNumHits > 0 && expectedNumHits < rays.size());
+
+            std::vector<RayCastResult> hits(rays.size());
+            NES_CHECK(query.CastRays(rays, hits) == expectedNumHits);
+            NES_CHECK(std::ranges::equal(hits, expected, IsSameHit));
+
+            std::vector<RayCastResult> jobHits(rays.size());
+            NES_CHECK(query.CastRays(context.GetJobSystem(), rays, jobHits) == expectedNumHits);
+            NES_CHECK(std::ranges::equal(jobHits, expected, IsSameHit));
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A per-ray body filter must be used instead of the shared filter for its ray only.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(CastRaysUsesPerRayBodyFilters)
+    {
+        std::vector<RRayCast> rays;
+        CreateRays(rays);
+
+        PhysicsTestContext context;
+        CreateScatteredBodies(context);
+        const NarrowPhaseQuery& query = context.GetScene().GetNarrowPhaseQuery();
+
+        std::vector<RayCastResult> unfiltered;
+        CastEachRay(query, rays, unfiltered);
+
+        // Ignore the closest body of every other ray that hit something.
+        std::deque<IgnoreSingleBodyFilter> ignoreFilters;
+        std::vector<const BodyFilter*> rayBodyFilters(rays.size(), nullptr);
+        for (size_t i = 0; i < rays.size(); i += 2)
+        {
+            if (unfiltered[i].m_fraction <= 1.f)
+                rayBodyFilters[i] = &ignoreFilters.emplace_back(unfiltered[i].m_bodyID);
+        }
+        NES_CHECK(!ignoreFilters.empty());
+
+        std::vector<RayCastResult> expected;
+        const uint expectedNumHits = CastEachRay(query, rays, expected, &rayBodyFilters);
+
+        std::vector<RayCastResult> hits(rays.size());
+        NES_CHECK(query.CastRays(rays, hits, {}, {}, {}, rayBodyFilters) == expectedNumHits);
+        NES_CHECK(std::ranges::equal(hits, expected, IsSameHit));
+
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            if (rayBodyFilters[i] != nullptr)
+                NES_CHECK(hits[i].m_bodyID != unfiltered[i].m_bodyID);
+            else
+                NES_CHECK(IsSameHit(hits[i], unfiltered[i]));
+        }
+    }
+}
@@ -0,0 +1,368 @@
+// ShapeTests.cpp
+#include <cmath>
+#include <vector>
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/Collision/CastResult.h"
+#include "Nessie/Physics/Collision/CollideShape.h"
+#include "Nessie/Physics/Collision/CollisionCollector.h"
+#include "Nessie/Physics/Collision/NarrowPhaseQuery.h"
+#include "Nessie/Physics/Collision/RayCast.h"
+#include "Nessie/Physics/Collision/ShapeFilter.h"
+#include "Nessie/Physics/Collision/Shapes/BoxShape.h"
+#include "Nessie/Physics/Collision/Shapes/CapsuleShape.h"
+#include "Nessie/Physics/Collision/Shapes/ConvexHullShape.h"
+#include "Nessie/Physics/Collision/Shapes/HeightFieldShape.h"
+#include "Nessie/Physics/Collision/Shapes/MeshShape.h"
+#include "Nessie/Physics/Collision/Shapes/MutableCompoundShape.h"
+#include "Nessie/Physics/Collision/Shapes/SphereShape.h"
+#include "Nessie/Physics/Collision/Shapes/StaticCompoundShape.h"
+#include "Nessie/Physics/StateRecorderImpl.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Check that a body came to rest with its center at the expected height. A resting body may
+    ///     sink into the surface by up to the penetration slop.
+    //----------------------------------------------------------------------------------------------------
+    static void CheckRestsAtHeight(PhysicsTestContext& context, const BodyID& bodyID, const float expectedHeight)
+    {
+        const float penetrationSlop = context.GetScene().GetSettings().m_penetrationSlop;
+        const float height = static_cast<float>(context.GetBodyInterface().GetPosition(bodyID).y);
+        NES_CHECK(height > expectedHeight - penetrationSlop - 1.0e-3f);
+        NES_CHECK(height < expectedHeight + 1.0e-3f);
+        NES_CHECK(context.GetBodyInterface().GetLinearVelocity(bodyID).Length() < 1.0e-2f);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Cast a ray straight down from 10m above (x, z).
+    /// @returns : The height of the closest hit, or -FLT_MAX if the ray didn't hit anything.
+    //----------------------------------------------------------------------------------------------------
+    static float CastRayDown(PhysicsTestContext& context, const float x, const float z)
+    {
+        const RRayCast ray(RVec3(x, 10.f, z), Vec3(0.f, -20.f, 0.f));
+        RayCastResult hit;
+        if (!context.GetScene().GetNarrowPhaseQuery().CastRay(ray, hit))
+            return -FLT_MAX;
+
+        return static_cast<float>(ray.GetPointAlongRay(hit.m_fraction).y);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Drop a dynamic body with the shape on the floor, and cast a ray down onto it once it rests.
+    ///	@param pShape : Shape of the body.
+    ///	@param rotation : Rotation of the body.
+    ///	@param halfHeight : Distance from the center of the body to its lowest and highest point when rotated.
+    //----------------------------------------------------------------------------------------------------
+    static void CheckShapeRestsOnFloor(const Shape* pShape, const Quat& rotation, const float halfHeight)
+    {
+        PhysicsTestContext context;
+        context.CreateFloor();
+
+        BodyCreateInfo info(pShape, Vec3::Zero(), rotation, EBodyMotionType::Dynamic, layers::kMoving);
+        info.m_position = RVec3(0.f, halfHeight + 0.5f, 0.f);
+        const BodyID bodyID = context.CreateBody(info);
+
+        context.Simulate(120);
+        CheckRestsAtHeight(context, bodyID, halfHeight);
+
+        const RVec3 position = context.GetBodyInterface().GetPosition(bodyID);
+        const float topHeight = static_cast<float>(position.y) + halfHeight;
+        NES_CHECK(std::abs(CastRayDown(context, static_cast<float>(position.x), static_cast<float>(position.z)) - topHeight) < 1.0e-3f);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Drop a dynamic box on a static body with the shape, and cast rays down onto the shape and
+    ///     the box once it rests.
+    ///	@param pShape : Shape of the static body. It must have a flat surface at surfaceHeight around the origin
+    ///     that extends to at least (2, 2).
+    ///	@param surfaceHeight : Height of the surface.
+    //----------------------------------------------------------------------------------------------------
+    static void CheckBoxRestsOnShape(const Shape* pShape, const float surfaceHeight)
+    {
+        PhysicsTestContext context;
+        context.CreateBody(BodyCreateInfo(pShape, Vec3::Zero(), Quat::Identity(), EBodyMotionType::Static, layers::kNonMoving));
+
+        static constexpr float kHalfExtent = 0.25f;
+        const BodyID boxID = context.CreateBox(RVec3(0.f, surfaceHeight + kHalfExtent + 0.5f, 0.f), Vec3::Replicate(kHalfExtent));
+
+        context.Simulate(120);
+        CheckRestsAtHeight(context, boxID, surfaceHeight + kHalfExtent);
+
+        const RVec3 position = context.GetBodyInterface().GetPosition(boxID);
+        const float topHeight = static_cast<float>(position.y) + kHalfExtent;
+        NES_CHECK(std::abs(CastRayDown(context, static_cast<float>(position.x), static_cast<float>(position.z)) - topHeight) < 1.0e-3f);
+        NES_CHECK(std::abs(CastRayDown(context, 2.f, 2.f) - surfaceHeight) < 1.0e-3f);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Check a compound of box shapes as a static body that a box rests on, and as a dynamic body
+    ///     that rests on the floor.
+    //----------------------------------------------------------------------------------------------------
+    template <typename CompoundSettingsType>
+    static void CheckCompoundShape()
+    {
+        // 2 x 2 boxes with the top at y = 0. The box is dropped on the corner where all four meet.
+        {
+            CompoundSettingsType settings;
+            for (const float x : { -1.5f, 1.5f })
+            {
+                for (const float z : { -1.5f, 1.5f })
+                    settings.AddShape(Vec3(x, -0.5f, z), Quat::Identity(), NES_NEW(BoxShape(Vec3(1.5f, 0.5f, 1.5f))));
+            }
+
+            const ShapeSettings::ShapeResult result = settings.Create();
+            NES_CHECK(result.IsValid());
+            if (result.IsValid())
+                CheckBoxRestsOnShape(result.Get(), 0.f);
+        }
+
+        // Two boxes next to each other, with a height of 0.5m.
+        {
+            CompoundSettingsType settings;
+            settings.AddShape(Vec3(-0.5f, 0.f, 0.f), Quat::Identity(), NES_NEW(BoxShape(Vec3(0.5f, 0.25f, 0.5f))));
+            settings.AddShape(Vec3(0.5f, 0.f, 0.f), Quat::Identity(), NES_NEW(BoxShape(Vec3(0.5f, 0.25f, 0.5f))));
+
+            const ShapeSettings::ShapeResult result = settings.Create();
+            NES_CHECK(result.IsValid());
+            if (result.IsValid())
+                CheckShapeRestsOnFloor(result.Get(), Quat::Identity(), 0.25f);
+        }
+    }
+
+    NES_TEST(SphereRestsOnFloor)
+    {
+        CheckShapeRestsOnFloor(NES_NEW(SphereShape(0.3f)), Quat::Identity(), 0.3f);
+    }
+
+    NES_TEST(CapsuleRestsOnFloor)
+    {
+        // Standing upright, and lying on its side.
+        CheckShapeRestsOnFloor(NES_NEW(CapsuleShape(0.4f, 0.2f)), Quat::Identity(), 0.6f);
+        CheckShapeRestsOnFloor(NES_NEW(CapsuleShape(0.4f, 0.2f)), Quat::FromAxisAngle(Vec3::AxisZ(), 0.5f * math::Pi<float>()), 0.2f);
+    }
+
+    NES_TEST(ConvexHullRestsOnFloor)
+    {
+        // Octagonal prism with a height of 0.6m.
+        std::vector<Vec3> points;
+        for (int i = 0; i < 8; ++i)
+        {
+            const float angle = static_cast<float>(i) * 0.25f * math::Pi<float>();
+            points.emplace_back(0.5f * std::cos(angle), -0.3f, 0.5f * std::sin(angle));
+            points.emplace_back(0.5f * std::cos(angle), 0.3f, 0.5f * std::sin(angle));
+        }
+
+        const ShapeSettings::ShapeResult result = ConvexHullShapeSettings(points).Create();
+        NES_CHECK(result.IsValid());
+        if (!result.IsValid())
+            return;
+        CheckShapeRestsOnFloor(result.Get(), Quat::Identity(), 0.3f);
+
+        // A hull that is restored from its binary state must behave the same.
+        const ConvexHullShape* pHull = static_cast<const ConvexHullShape*>(result.Get().Get());
+        StateRecorderImpl stream;
+        pHull->SaveBinaryState(stream);
+        stream.Rewind();
+
+        const ShapeSettings::ShapeResult restored = ConvexHullShape::RestoreFromBinaryState(stream);
+        NES_CHECK(restored.IsValid());
+        if (!restored.IsValid())
+            return;
+        const ConvexHullShape* pRestoredHull = static_cast<const ConvexHullShape*>(restored.Get().Get());
+        NES_CHECK(pRestoredHull->GetNumPoints() == pHull->GetNumPoints());
+        NES_CHECK(pRestoredHull->GetNumFaces() == pHull->GetNumFaces());
+        CheckShapeRestsOnFloor(pRestoredHull, Quat::Identity(), 0.3f);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A box dropped on a flat mesh at y = 0 must come to rest with its center kHalfExtent above the mesh,
+    // less at most the penetration slop. A ray cast down onto the box must hit its top face, and a ray at
+    // (2, 2), beside the box, must hit the mesh at y = 0. The triangles are wound so that they face up, so
+    // the box and the rays hit their front faces.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(BoxRestsOnMesh)
+    {
+        // Flat grid of 8 x 8 quads in the XZ plane, with the triangles facing up.
+        static constexpr uint32 kNumQuads = 8;
+        std::vector<Float3> vertices;
+        for (uint32 x = 0; x <= kNumQuads; ++x)
+        {
+            for (uint32 z = 0; z <= kNumQuads; ++z)
+                vertices.emplace_back(static_cast<float>(x) - 4.f, 0.f, static_cast<float>(z) - 4.f);
+        }
+
+        std::vector<IndexedTriangle> triangles;
+        for (uint32 x = 0; x < kNumQuads; ++x)
+        {
+            for (uint32 z = 0; z < kNumQuads; ++z)
+            {
+                const uint32 index = x * (kNumQuads + 1) + z;
+                triangles.emplace_back(index, index + 1, index + kNumQuads + 1);
+                triangles.emplace_back(index + kNumQuads + 1, index + 1, index + kNumQuads + 2);
+            }
+        }
+
+        const ShapeSettings::ShapeResult result = MeshShapeSettings(vertices, triangles).Create();
+        NES_CHECK(result.IsValid());
+        if (result.IsValid())
+            CheckBoxRestsOnShape(result.Get(), 0.f);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The same checks as BoxRestsOnMesh, on a height field. The samples are 0 within 2m of the center, where
+    // the box lands and the ray at (2, 2) hits. 0 is the lowest sample of every block that it is in, so it is
+    // stored exactly by the quantization. The rising sides give the blocks different height ranges.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(BoxRestsOnHeightField)
+    {
+        // 8m x 8m terrain that is flat within 2m of the center, and rises towards the sides.
+        static constexpr int kSampleCount = 9;
+        std::vector<float> samples;
+        for (int y = 0; y < kSampleCount; ++y)
+        {
+            for (int x = 0; x < kSampleCount; ++x)
+                samples.push_back(0.5f * static_cast<float>(math::Max(0, std::abs(x - 4) - 2, std::abs(y - 4) - 2)));
+        }
+
+        const ShapeSettings::ShapeResult result = HeightFieldShapeSettings(samples.data(), Vec3(-4.f, 0.f, -4.f), Vec3::One(), kSampleCount).Create();
+        NES_CHECK(result.IsValid());
+        if (result.IsValid())
+            CheckBoxRestsOnShape(result.Get(), 0.f);
+    }
+
+    NES_TEST(StaticCompoundRestsOnFloor)
+    {
+        CheckCompoundShape<StaticCompoundShapeSettings>();
+    }
+
+    NES_TEST(MutableCompoundRestsOnFloor)
+    {
+        CheckCompoundShape<MutableCompoundShapeSettings>();
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Shape filter that only accepts shapes of a single sub type.
+    //----------------------------------------------------------------------------------------------------
+    class ShapeSubTypeFilter final : public ShapeFilter
+    {
+    public:
+        explicit ShapeSubTypeFilter(const EShapeSubType subType) : m_subType(subType) {}
+
+        virtual bool ShouldCollide(const Shape* pShape2, const SubShapeID&) const override
+        {
+            return pShape2->GetSubType() == m_subType;
+        }
+
+    private:
+        EShapeSubType m_subType;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // Collecting the shapes in a region must return the convex shapes that the shape filter accepts, and
+    // skip the ones that it rejects.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(CollectTransformedShapesAppliesShapeFilter)
+    {
+        PhysicsTestContext context;
+        const BodyID box = context.CreateBox(RVec3(0.f, 0.5f, 0.f), Vec3::Replicate(0.5f), EBodyMotionType::Static);
+        const BodyID sphere = context.CreateSphere(RVec3(3.f, 0.5f, 0.f), 0.5f, EBodyMotionType::Static);
+
+        const AABox region(Vec3(-1.f, -1.f, -1.f), Vec3(4.f, 2.f, 1.f));
+        const NarrowPhaseQuery& query = context.GetScene().GetNarrowPhaseQuery();
+
+        AllHitCollisionCollector<TransformedShapeCollector> all;
+        query.CollectTransformedShapes(region, all);
+        NES_CHECK(all.m_hits.size() == 2);
+
+        AllHitCollisionCollector<TransformedShapeCollector> spheres;
+        query.CollectTransformedShapes(region, spheres, {}, {}, {}, ShapeSubTypeFilter(EShapeSubType::Sphere));
+        NES_CHECK(spheres.m_hits.size() == 1);
+        NES_CHECK(spheres.HadHit() && spheres.m_hits.front().m_bodyID == sphere);
+
+        AllHitCollisionCollector<TransformedShapeCollector> boxes;
+        query.CollectTransformedShapes(region, boxes, {}, {}, {}, ShapeSubTypeFilter(EShapeSubType::Box));
+        NES_CHECK(boxes.m_hits.size() == 1);
+        NES_CHECK(boxes.HadHit() && boxes.m_hits.front().m_bodyID == box);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Each support mode of a box describes the same box: the full box without a convex radius, or the box
+    // shrunk by its convex radius, with the radius returned separately.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(BoxSupportFunctionModes)
+    {
+        static constexpr float kConvexRadius = physics::kDefaultConvexRadius;
+        const BoxShape box(Vec3(1.f, 2.f, 3.f), kConvexRadius);
+        const Vec3 direction(1.f, -1.f, 1.f);
+
+        ConvexShape::SupportBuffer buffer;
+        for (const ConvexShape::ESupportMode mode : { ConvexShape::ESupportMode::IncludeConvexRadius, ConvexShape::ESupportMode::Default })
+        {
+            const ConvexShape::Support* pSupport = box.GetSupportFunction(mode, buffer, Vec3::One());
+            NES_CHECK(pSupport->GetConvexRadius() == 0.f);
+            NES_CHECK(pSupport->GetSupport(direction).IsClose(Vec3(1.f, -2.f, 3.f), 1.0e-12f));
+        }
+
+        const ConvexShape::Support* pSupport = box.GetSupportFunction(ConvexShape::ESupportMode::ExcludeConvexRadius, buffer, Vec3::One());
+        NES_CHECK(pSupport->GetConvexRadius() == kConvexRadius);
+        NES_CHECK(pSupport->GetSupport(direction).IsClose(Vec3(1.f - kConvexRadius, -2.f + kConvexRadius, 3.f - kConvexRadius), 1.0e-12f));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Two unit boxes that overlap by 0.05m must report a penetration depth of 0.05m, and boxes that are 0.02m
+    // apart must not collide. The convex radius must not be added to the boxes twice.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(BoxesCollideAtTheirSurface)
+    {
+        PhysicsTestContext context;
+        context.CreateBox(RVec3::Zero(), Vec3::Replicate(0.5f), EBodyMotionType::Static);
+
+        const BoxShape box(Vec3::Replicate(0.5f));
+        const auto collide = [&context, &box](const float x, AllHitCollisionCollector<CollideShapeCollector>& collector)
+        {
+            context.GetScene().GetNarrowPhaseQuery().CollideShape(&box, Vec3::One(), RMat44::MakeTranslation(RVec3(x, 0.f, 0.f)), CollideShapeSettings(), RVec3::Zero(), collector);
+        };
+
+        AllHitCollisionCollector<CollideShapeCollector> overlapping;
+        collide(0.95f, overlapping);
+        NES_CHECK(overlapping.m_hits.size() == 1);
+        if (overlapping.m_hits.size() == 1)
+        {
+            const CollideShapeResult& hit = overlapping.m_hits.front();
+            NES_CHECK(std::abs(hit.m_penetrationDepth - 0.05f) < 1.0e-3f);
+            NES_CHECK(hit.m_penetrationAxis.Normalized().IsClose(-Vec3::AxisX(), 1.0e-6f));
+        }
+
+        AllHitCollisionCollector<CollideShapeCollector> separated;
+        collide(1.02f, separated);
+        NES_CHECK(!separated.HadHit());
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // The contact points of two convex shapes are reported in world space. A box that overlaps another box
+    // by 0.05m, both away from the origin, must report its contact points on the overlapping faces.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(ConvexContactPointsAreInWorldSpace)
+    {
+        PhysicsTestContext context;
+        context.CreateBox(RVec3(2.f, 1.f, 0.f), Vec3::Replicate(0.5f), EBodyMotionType::Static);
+
+        const BoxShape box(Vec3::Replicate(0.5f));
+        AllHitCollisionCollector<CollideShapeCollector> collector;
+        context.GetScene().GetNarrowPhaseQuery().CollideShape(&box, Vec3::One(), RMat44::MakeTranslation(RVec3(2.95f, 1.f, 0.f)), CollideShapeSettings(), RVec3::Zero(), collector);
+        NES_CHECK(collector.m_hits.size() == 1);
+        if (collector.m_hits.size() == 1)
+        {
+            // The faces overlap between x = 2.45 and x = 2.5, and both contact points must lie on them.
+            const CollideShapeResult& hit = collector.m_hits.front();
+            for (const Vec3& point : { hit.m_contactPointOn1, hit.m_contactPointOn2 })
+            {
+                NES_CHECK(point.x > 2.45f - 1.0e-3f && point.x < 2.5f + 1.0e-3f);
+                NES_CHECK(point.y > 0.5f - 1.0e-3f && point.y < 1.5f + 1.0e-3f);
+                NES_CHECK(std::abs(point.z) < 0.5f + 1.0e-3f);
+            }
+            NES_CHECK(std::abs(hit.m_contactPointOn2.x - hit.m_contactPointOn1.x - 0.05f) < 1.0e-3f);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+// SimulationRegionTests.cpp
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/PhysicsStepListener.h"
+#include "Nessie/Physics/Collision/Shapes/SphereShape.h"
+
+namespace nes::test
+{
+    /// Region that is simulated every 2nd update, starting with the 2nd update.
+    static constexpr uint32 kHalfRateRegion = 1;
+
+    static constexpr float kDeltaTime = 1.f / 60.f;
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Sets up a scene without gravity, in which region kHalfRateRegion is simulated every 2nd update.
+    //----------------------------------------------------------------------------------------------------
+    static void SetUpHalfRateRegion(PhysicsTestContext& context)
+    {
+        PhysicsScene& scene = context.GetScene();
+        scene.SetGravity(Vec3::Zero());
+
+        SimulationRegionSettings settings;
+        settings.m_stepInterval = 2;
+        scene.SetSimulationRegionSettings(kHalfRateRegion, settings);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Create a sphere that moves along the x axis at 1 m/s, without damping.
+    //----------------------------------------------------------------------------------------------------
+    static BodyID CreateMovingSphere(PhysicsTestContext& context, const RVec3& position, const uint32 region)
+    {
+        BodyCreateInfo info(NES_NEW(SphereShape(0.5f)), Vec3::Zero(), Quat::Identity(), EBodyMotionType::Dynamic, layers::kMoving);
+        info.m_position = position;
+        info.m_linearVelocity = Vec3::AxisX();
+        info.m_linearDamping = 0.f;
+        info.m_simulationRegion = region;
+        return context.CreateBody(info);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Records the state of a body in each step.
+    //----------------------------------------------------------------------------------------------------
+    class BodyStateListener final : public PhysicsStepListener
+    {
+    public:
+        explicit BodyStateListener(const BodyID& bodyID) : m_bodyID(bodyID) {}
+
+        virtual void OnStep(const PhysicsStepListenerContext& context) override
+        {
+            const Body* pBody = context.m_pPhysicsScene->GetBodyLockInterfaceNoLock().TryGetBody(m_bodyID);
+            m_isActive = pBody->IsActive();
+            m_isSimulationSkipped = pBody->IsSimulationSkipped();
+        }
+
+        BodyID  m_bodyID;
+        bool    m_isActive = false;
+        bool    m_isSimulationSkipped = false;
+    };
+
+    //----------------------------------------------------------------------------------------------------
+    // A body that is frozen by its simulation region must still report that it is active during the update,
+    // and only report that it skipped the simulation while its region is skipped.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(FrozenBodiesStayActive)
+    {
+        PhysicsTestContext context;
+        SetUpHalfRateRegion(context);
+        const BodyID bodyID = CreateMovingSphere(context, RVec3::Zero(), kHalfRateRegion);
+
+        BodyStateListener listener(bodyID);
+        context.GetScene().AddStepListener(&listener);
+
+        // Update 0 skips the region.
+        context.Simulate(1, kDeltaTime);
+        NES_CHECK(listener.m_isActive);
+        NES_CHECK(listener.m_isSimulationSkipped);
+        NES_CHECK(context.GetBodyInterface().IsBodyActive(bodyID));
+
+        const Body* pBody = context.GetScene().GetBodyLockInterfaceNoLock().TryGetBody(bodyID);
+        NES_CHECK(!pBody->IsSimulationSkipped());
+
+        // Update 1 simulates the region.
+        context.Simulate(1, kDeltaTime);
+        NES_CHECK(listener.m_isActive);
+        NES_CHECK(!listener.m_isSimulationSkipped);
+
+        context.GetScene().RemoveStepListener(&listener);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A body catches up on the updates that its region skipped, unless it was deactivated in the meantime.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(SkippedTimeIsClearedOnReactivation)
+    {
+        PhysicsTestContext context;
+        SetUpHalfRateRegion(context);
+        const BodyID caughtUpID = CreateMovingSphere(context, RVec3::Zero(), kHalfRateRegion);
+        const BodyID reactivatedID = CreateMovingSphere(context, RVec3(0.f, 0.f, 10.f), kHalfRateRegion);
+        BodyInterface& bodyInterface = context.GetBodyInterface();
+
+        // Update 0 skips the region, both bodies skip a delta time.
+        context.Simulate(1, kDeltaTime);
+        const Real caughtUpStart = bodyInterface.GetPosition(caughtUpID).x;
+        const Real reactivatedStart = bodyInterface.GetPosition(reactivatedID).x;
+        NES_CHECK(caughtUpStart == 0.f);
+
+        bodyInterface.DeactivateBody(reactivatedID);
+        bodyInterface.ActivateBody(reactivatedID);
+        bodyInterface.SetLinearVelocity(reactivatedID, Vec3::AxisX());
+
+        // Update 1 simulates the region.
+        context.Simulate(1, kDeltaTime);
+        const float caughtUpDistance = static_cast<float>(bodyInterface.GetPosition(caughtUpID).x - caughtUpStart);
+        const float reactivatedDistance = static_cast<float>(bodyInterface.GetPosition(reactivatedID).x - reactivatedStart);
+        NES_CHECK(math::Abs(caughtUpDistance - 2.f * kDeltaTime) < 1.0e-5f);
+        NES_CHECK(math::Abs(reactivatedDistance - kDeltaTime) < 1.0e-5f);
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // With step stats enabled, the wall time of an update is divided over the regions that it simulated.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(RegionStatsReportWallTime)
+    {
+        PhysicsTestContext context;
+        SetUpHalfRateRegion(context);
+        CreateMovingSphere(context, RVec3::Zero(), 0);
+        CreateMovingSphere(context, RVec3(0.f, 0.f, 10.f), kHalfRateRegion);
+
+        PhysicsScene& scene = context.GetScene();
+        scene.SetStepStatsEnabled(true);
+
+        // Update 0 only simulates region 0.
+        context.Simulate(1, kDeltaTime);
+        const uint64 skippingUpdateWallTime = scene.GetStepStats().m_updateWallTime;
+        NES_CHECK(skippingUpdateWallTime > 0);
+        NES_CHECK(scene.GetSimulationRegionStats(0).m_numSimulatedBodies == 1);
+        NES_CHECK(scene.GetSimulationRegionStats(0).m_stepWallTime == skippingUpdateWallTime);
+        NES_CHECK(scene.GetSimulationRegionStats(0).m_wallTime == skippingUpdateWallTime);
+        NES_CHECK(scene.GetSimulationRegionStats(kHalfRateRegion).m_numSkippedBodies == 1);
+        NES_CHECK(scene.GetSimulationRegionStats(kHalfRateRegion).m_stepWallTime == 0);
+        NES_CHECK(scene.GetSimulationRegionStats(kHalfRateRegion).m_wallTime == 0);
+
+        // Update 1 simulates both regions, which each have half of the bodies.
+        context.Simulate(1, kDeltaTime);
+        const uint64 updateWallTime = scene.GetStepStats().m_updateWallTime;
+        for (const uint32 region : { 0u, kHalfRateRegion })
+        {
+            const SimulationRegionStats& stats = scene.GetSimulationRegionStats(region);
+            NES_CHECK(stats.m_numSimulatedBodies == 1);
+            NES_CHECK(stats.m_stepWallTime == updateWallTime);
+            NES_CHECK(stats.m_wallTime == updateWallTime / 2);
+        }
+
+        scene.SetStepStatsEnabled(false);
+    }
+}
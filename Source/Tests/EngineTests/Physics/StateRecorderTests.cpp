@@ -0,0 +1,87 @@
+// StateRecorderTests.cpp
+#include "TestFramework.h"
+#include "PhysicsTestContext.h"
+#include "Nessie/Physics/StateRecorderImpl.h"
+
+namespace nes::test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Creates a stack of boxes that keeps moving for a while, so that a snapshot has contacts
+    ///     and active bodies.
+    //----------------------------------------------------------------------------------------------------
+    static void CreateBoxStack(PhysicsTestContext& context, BodyIDVector& outBodies)
+    {
+        context.CreateFloor();
+        for (int i = 0; i < 8; ++i)
+            outBodies.push_back(context.CreateBox(RVec3(0.1f * static_cast<float>(i), 0.5f + 1.2f * static_cast<float>(i), 0.f), Vec3::Replicate(0.5f)));
+    }
+
+    static void GetPositions(PhysicsTestContext& context, const BodyIDVector& bodies, std::vector<RVec3>& outPositions)
+    {
+        outPositions.clear();
+        for (const BodyID& bodyID : bodies)
+            outPositions.push_back(context.GetBodyInterface().GetPosition(bodyID));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // Restoring a snapshot and simulating the same frames again must end in the same state.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(RestoreStateResimulatesIdentically)
+    {
+        PhysicsTestContext context;
+        BodyIDVector bodies;
+        CreateBoxStack(context, bodies);
+        context.Simulate(10);
+
+        StateRecorderImpl snapshot;
+        context.GetScene().SaveState(snapshot);
+
+        context.Simulate(20);
+        StateRecorderImpl expected;
+        context.GetScene().SaveState(expected);
+
+        NES_CHECK(context.GetScene().RestoreState(snapshot));
+        context.Simulate(20);
+        StateRecorderImpl actual;
+        context.GetScene().SaveState(actual);
+
+        NES_CHECK(actual.IsEqual(expected));
+    }
+
+    //----------------------------------------------------------------------------------------------------
+    // A stream that doesn't match the scene must be rejected before any body is modified.
+    //----------------------------------------------------------------------------------------------------
+    NES_TEST(RestoreStateRejectsMismatchedStream)
+    {
+        PhysicsTestContext context;
+        BodyIDVector bodies;
+        CreateBoxStack(context, bodies);
+
+        StateRecorderImpl snapshot;
+        context.GetScene().SaveState(snapshot);
+        context.Simulate(10);
+
+        std::vector<RVec3> positionsBefore;
+        std::vector<RVec3> positionsAfter;
+        GetPositions(context, bodies, positionsBefore);
+
+        // Truncated in the middle of the body section.
+        StateRecorderImpl truncated;
+        truncated.SetData(snapshot.GetData(), snapshot.GetDataSize() / 2);
+        NES_CHECK(!context.GetScene().RestoreState(truncated));
+        GetPositions(context, bodies, positionsAfter);
+        NES_CHECK(positionsAfter == positionsBefore);
+
+        // The last body of the snapshot doesn't exist anymore.
+        const BodyID removedBody = bodies.back();
+        bodies.pop_back();
+        positionsBefore.pop_back();
+        context.GetBodyInterface().RemoveBody(removedBody);
+        context.GetBodyInterface().DestroyBody(removedBody);
+
+        snapshot.Rewind();
+        NES_CHECK(!context.GetScene().RestoreState(snapshot));
+        GetPositions(context, bodies, positionsAfter);
+        NES_CHECK(positionsAfter == positionsBefore);
+    }
+}
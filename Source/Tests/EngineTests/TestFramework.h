@@ -0,0 +1,57 @@
+// TestFramework.h
+#pragma once
+#include <vector>
+#include "Nessie/Core/Config.h"
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : A registered test. Tests are registered with the NES_TEST() macro, and run by main() in
+///     EngineTests.cpp.
+//----------------------------------------------------------------------------------------------------
+struct TestCase
+{
+    using Function = void(*)();
+
+    const char*                 m_pName = nullptr;
+    const char*                 m_pFile = nullptr;
+    Function                    m_function = nullptr;
+};
+
+namespace test
+{
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Get all tests that have been registered.
+    //----------------------------------------------------------------------------------------------------
+    std::vector<TestCase>&      GetTestCases();
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Report that a check in the currently running test has failed.
+    //----------------------------------------------------------------------------------------------------
+    void                        ReportFailure(const char* pFile, const int line, const char* pExpression);
+
+    //----------------------------------------------------------------------------------------------------
+    /// @brief : Helper to register a test before main() is run.
+    //----------------------------------------------------------------------------------------------------
+    struct TestRegistrar
+    {
+        TestRegistrar(const char* pName, const char* pFile, TestCase::Function function) { GetTestCases().push_back({ pName, pFile, function }); }
+    };
+}
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Define a test function that is run by the EngineTests executable.
+//----------------------------------------------------------------------------------------------------
+#define NES_TEST(testName)                                                                                  \
+    static void testName();                                                                                 \
+    static const ::test::TestRegistrar NES_MERGE_TOKENS(s_registrar_, testName)(#testName, __FILE__, &testName); \
+    static void testName()
+
+//----------------------------------------------------------------------------------------------------
+/// @brief : Check that the expression is true. On failure, the test is marked as failed and continues
+///     running.
+//----------------------------------------------------------------------------------------------------
+#define NES_CHECK(expression)                                                                               \
+do                                                                                                          \
+{                                                                                                           \
+    if (!(expression))                                                                                      \
+        ::test::ReportFailure(__FILE__, __LINE__, #expression);                                               \
+} while (false)
@@ -82,19 +82,9 @@ function m.EnableInstructionSets()
             "_WINDOWS",
             "WIN32_LEAN_AND_MEAN",
             "NOMINMAX",
-
-            "NES_USE_SSE",
-            "NES_USE_SSE4_1",
-            "NES_USE_SSE4_2",
-
-            "NES_USE_AVX",
-            "NES_USE_AVX2",
-            "NES_USE_FMADD",
-
-            "NES_USE_LZCNT",
-            "NES_USE_TZCNT",
         }
     
+        -- The NES_USE_* instruction set macros are derived from the compiler target in Nessie/Core/Config.h.
         vectorextensions "SSE2"; -- Minimum
         vectorextensions "SSE4.1";
         vectorextensions "SSE4.2";